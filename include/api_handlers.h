@@ -251,6 +251,8 @@ esp_err_t api_handler_ir_bulk_read(httpd_req_t *req);
 esp_err_t api_handler_coils_bulk_read(httpd_req_t *req);
 esp_err_t api_handler_coils_bulk_write(httpd_req_t *req);
 esp_err_t api_handler_di_bulk_read(httpd_req_t *req);
+/** FEAT-152: GET /api/registers/multi — HR/IR/coils/DI ranges in one snapshot */
+esp_err_t api_handler_registers_multi(httpd_req_t *req);
 
 /** FEAT-020: ST Logic Debug API */
 esp_err_t api_handler_logic_debug(httpd_req_t *req);
@@ -282,6 +284,11 @@ esp_err_t api_handler_ntp_post(httpd_req_t *req);
 esp_err_t api_handler_alarms_get(httpd_req_t *req);
 esp_err_t api_handler_alarms_ack(httpd_req_t *req);
 
+/** FEAT-173: Historian API (v7.9.10.4) */
+esp_err_t api_handler_history_get(httpd_req_t *req);
+esp_err_t api_handler_history_point_get(httpd_req_t *req);
+esp_err_t api_handler_history_post(httpd_req_t *req);
+
 /** FEAT-022: Persistence Group Management API */
 esp_err_t api_handler_persist_groups_list(httpd_req_t *req);
 esp_err_t api_handler_persist_group_single(httpd_req_t *req);
@@ -0,0 +1,80 @@
+/**
+ * @file api_router.h
+ * @brief Segment trie router for the /api/v1 dispatcher (v7.9.8.2)
+ *
+ * Routes are added once as "/api/counters" (exact) or "/api/counters/"
+ * (catch-all for everything below). Lookup walks the URI one path segment
+ * at a time through a hash table keyed on (parent node, segment), so the
+ * cost depends on path depth only — not on the number of routes or their
+ * order. The most specific match always wins: an exact node beats a
+ * catch-all on one of its ancestors, regardless of table order.
+ *
+ * Pure C, no ESP-IDF dependencies — compiled on the host by
+ * tests/host/api_router_bench.cpp.
+ *
+ * Memory: ~1.1 KB per ApiRouter (static, no heap)
+ */
+
+#ifndef API_ROUTER_H
+#define API_ROUTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define API_ROUTER_MAX_NODES    64    // Distinct path segments (v1 table uses 55)
+#define API_ROUTER_MAX_ROUTES   96    // Route ids 0..95
+#define API_ROUTER_HASH_SLOTS   128   // Power of two, >= 2x MAX_NODES
+#define API_ROUTER_NONE         0xFF
+
+#define API_ROUTER_METHOD_ANY   (-1)
+
+typedef struct {
+  const char *seg;          // Points into the route path passed to add (must outlive router)
+  uint16_t    seg_hash;
+  uint8_t     seg_len;
+  uint8_t     parent;       // Parent node index (root = 0)
+  uint8_t     exact_head;   // First route on this exact path (API_ROUTER_NONE = none)
+  uint8_t     rest_head;    // First catch-all route below this node
+} ApiRouterNode;
+
+typedef struct {
+  int8_t  method;           // HTTP method enum value, or API_ROUTER_METHOD_ANY
+  uint8_t next;             // Next route on the same node list
+} ApiRouterRoute;
+
+typedef struct {
+  ApiRouterNode  nodes[API_ROUTER_MAX_NODES];
+  ApiRouterRoute routes[API_ROUTER_MAX_ROUTES];
+  uint8_t        slots[API_ROUTER_HASH_SLOTS];   // Node index + 1 (0 = empty)
+  uint8_t        node_count;
+} ApiRouter;
+
+typedef struct {
+  int         route_id;     // -1 = no match
+  const char *rest;         // Catch-all: URI remainder after the matched prefix; NULL for exact
+} ApiRouteMatch;
+
+/**
+ * @brief Reset router to an empty tree
+ */
+void api_router_init(ApiRouter *r);
+
+/**
+ * @brief Add a route
+ * @param path   "/a/b" = exact match, "/a/b/" = catch-all below /a/b
+ * @param method HTTP method enum value, or API_ROUTER_METHOD_ANY
+ * @param route_id Caller's index (< API_ROUTER_MAX_ROUTES), returned on match
+ * @return false if the node or route capacity is exhausted
+ */
+bool api_router_add(ApiRouter *r, const char *path, int method, uint8_t route_id);
+
+/**
+ * @brief Match a request URI (query string is ignored)
+ *
+ * An exact route on the full path with a matching method wins. Otherwise
+ * the deepest catch-all with a matching method is returned. Earlier adds
+ * take precedence between routes on the same node and method.
+ */
+ApiRouteMatch api_router_match(const ApiRouter *r, const char *uri, int method);
+
+#endif // API_ROUTER_H
@@ -0,0 +1,106 @@
+/**
+ * @file api_v1_routes.h
+ * @brief /api/v1 routing table (FEAT-151)
+ *
+ * One list, expanded twice: into v1_routes[] in api_handlers.cpp (path,
+ * method, handler) and into the route table of
+ * tests/host/api_router_bench.cpp (path, method), so the bench always
+ * builds the trie the firmware builds.
+ *
+ * The includer defines API_V1_ROUTE(path, method, handler) before use.
+ * "/api/x" = exact, "/api/x/" = catch-all below /api/x (after the v1
+ * rewrite). Order does not matter: the most specific path always wins.
+ */
+
+#ifndef API_V1_ROUTES_H
+#define API_V1_ROUTES_H
+
+#define API_V1_ROUTES \
+  /* Exact matches */ \
+  API_V1_ROUTE("/api/status",              HTTP_GET,    api_handler_status) \
+  API_V1_ROUTE("/api/config",              HTTP_GET,    api_handler_config_get) \
+  API_V1_ROUTE("/api/counters",            HTTP_GET,    api_handler_counters) \
+  API_V1_ROUTE("/api/timers",              HTTP_GET,    api_handler_timers) \
+  API_V1_ROUTE("/api/logic",               HTTP_GET,    api_handler_logic) \
+  API_V1_ROUTE("/api/gpio",                HTTP_GET,    api_handler_gpio) \
+  API_V1_ROUTE("/api/wifi",                HTTP_GET,    api_handler_wifi_get) \
+  API_V1_ROUTE("/api/wifi",                HTTP_POST,   api_handler_wifi_post) \
+  API_V1_ROUTE("/api/ethernet",            HTTP_GET,    api_handler_ethernet_get) \
+  API_V1_ROUTE("/api/ethernet",            HTTP_POST,   api_handler_ethernet_post) \
+  API_V1_ROUTE("/api/debug",               HTTP_GET,    api_handler_debug_get) \
+  API_V1_ROUTE("/api/debug",               HTTP_POST,   api_handler_debug_set) \
+  API_V1_ROUTE("/api/modules",             HTTP_GET,    api_handler_modules_get) \
+  API_V1_ROUTE("/api/modules",             HTTP_POST,   api_handler_modules_post) \
+  API_V1_ROUTE("/api/hostname",            HTTP_GET,    api_handler_hostname_get) \
+  API_V1_ROUTE("/api/hostname",            HTTP_POST,   api_handler_hostname_post) \
+  API_V1_ROUTE("/api/telnet",              HTTP_GET,    api_handler_telnet_get) \
+  API_V1_ROUTE("/api/telnet",              HTTP_POST,   api_handler_telnet_post) \
+  API_V1_ROUTE("/api/system/reboot",       HTTP_POST,   api_handler_system_reboot) \
+  API_V1_ROUTE("/api/system/save",         HTTP_POST,   api_handler_system_save) \
+  API_V1_ROUTE("/api/system/load",         HTTP_POST,   api_handler_system_load) \
+  API_V1_ROUTE("/api/system/defaults",     HTTP_POST,   api_handler_system_defaults) \
+  API_V1_ROUTE("/api/system/watchdog",     HTTP_GET,    api_handler_system_watchdog) \
+  API_V1_ROUTE("/api/system/backup",       HTTP_GET,    api_handler_system_backup) \
+  API_V1_ROUTE("/api/system/restore",      HTTP_POST,   api_handler_system_restore) \
+  API_V1_ROUTE("/api/http",                HTTP_POST,   api_handler_http_config_post) \
+  API_V1_ROUTE("/api/logic/settings",      HTTP_POST,   api_handler_logic_settings_post) \
+  API_V1_ROUTE("/api/dashboard/layout",    HTTP_GET,    api_handler_dashboard_layout_get) \
+  API_V1_ROUTE("/api/dashboard/layout",    HTTP_POST,   api_handler_dashboard_layout_post) \
+  API_V1_ROUTE("/api/events/status",       HTTP_GET,    api_handler_sse_status) \
+  API_V1_ROUTE("/api/events/clients",      HTTP_GET,    api_handler_sse_clients) \
+  API_V1_ROUTE("/api/events/disconnect",   HTTP_POST,   api_handler_sse_disconnect) \
+  API_V1_ROUTE("/api/version",             HTTP_GET,    api_handler_api_version) \
+  API_V1_ROUTE("/api/metrics",             HTTP_GET,    api_handler_metrics) \
+  API_V1_ROUTE("/api/persist/groups",      HTTP_GET,    api_handler_persist_groups_list) \
+  API_V1_ROUTE("/api/persist/save",        HTTP_POST,   api_handler_persist_save) \
+  API_V1_ROUTE("/api/persist/restore",     HTTP_POST,   api_handler_persist_restore) \
+  API_V1_ROUTE("/api/user/me",             HTTP_GET,    api_handler_user_me) \
+  API_V1_ROUTE("/api/auth/login",          HTTP_POST,   api_handler_auth_login) \
+  API_V1_ROUTE("/api/auth/logout",         HTTP_POST,   api_handler_auth_logout) \
+  API_V1_ROUTE("/api/cli",                 HTTP_POST,   api_handler_cli_exec) \
+  API_V1_ROUTE("/api/bindings",            HTTP_GET,    api_handler_bindings_list) \
+  API_V1_ROUTE("/api/history",             HTTP_GET,    api_handler_history_get) \
+  API_V1_ROUTE("/api/history",             HTTP_POST,   api_handler_history_post) \
+  \
+  /* Bulk register operations (query string is ignored by the router) */ \
+  API_V1_ROUTE("/api/registers/hr",        HTTP_GET,    api_handler_hr_bulk_read) \
+  API_V1_ROUTE("/api/registers/ir",        HTTP_GET,    api_handler_ir_bulk_read) \
+  API_V1_ROUTE("/api/registers/coils",     HTTP_GET,    api_handler_coils_bulk_read) \
+  API_V1_ROUTE("/api/registers/di",        HTTP_GET,    api_handler_di_bulk_read) \
+  API_V1_ROUTE("/api/registers/multi",     HTTP_GET,    api_handler_registers_multi) \
+  API_V1_ROUTE("/api/registers/hr/bulk",   HTTP_POST,   api_handler_hr_bulk_write) \
+  API_V1_ROUTE("/api/registers/coils/bulk", HTTP_POST,  api_handler_coils_bulk_write) \
+  \
+  /* Heartbeat (exact path beats the /api/gpio/ catch-all) */ \
+  API_V1_ROUTE("/api/gpio/2/heartbeat",    HTTP_GET,    api_handler_heartbeat) \
+  API_V1_ROUTE("/api/gpio/2/heartbeat",    HTTP_POST,   api_handler_heartbeat) \
+  \
+  /* Catch-all prefix matches (trailing slash) */ \
+  API_V1_ROUTE("/api/history/",            HTTP_GET,    api_handler_history_point_get) \
+  API_V1_ROUTE("/api/counters/",           HTTP_GET,    api_handler_counter_single) \
+  API_V1_ROUTE("/api/counters/",           HTTP_POST,   api_handler_counter_single) \
+  API_V1_ROUTE("/api/counters/",           HTTP_DELETE, api_handler_counter_delete) \
+  API_V1_ROUTE("/api/timers/",             HTTP_GET,    api_handler_timer_single) \
+  API_V1_ROUTE("/api/timers/",             HTTP_POST,   api_handler_timer_config_post) \
+  API_V1_ROUTE("/api/timers/",             HTTP_DELETE, api_handler_timer_delete) \
+  API_V1_ROUTE("/api/registers/hr/",       HTTP_GET,    api_handler_hr_read) \
+  API_V1_ROUTE("/api/registers/hr/",       HTTP_POST,   api_handler_hr_write) \
+  API_V1_ROUTE("/api/registers/ir/",       HTTP_GET,    api_handler_ir_read) \
+  API_V1_ROUTE("/api/registers/coils/",    HTTP_GET,    api_handler_coil_read) \
+  API_V1_ROUTE("/api/registers/coils/",    HTTP_POST,   api_handler_coil_write) \
+  API_V1_ROUTE("/api/registers/di/",       HTTP_GET,    api_handler_di_read) \
+  API_V1_ROUTE("/api/gpio/",               HTTP_GET,    api_handler_gpio_single) \
+  API_V1_ROUTE("/api/gpio/",               HTTP_POST,   api_handler_gpio_write) \
+  API_V1_ROUTE("/api/gpio/",               HTTP_DELETE, api_handler_gpio_config_delete) \
+  API_V1_ROUTE("/api/logic/",              HTTP_GET,    api_handler_logic_single) \
+  API_V1_ROUTE("/api/logic/",              HTTP_POST,   api_handler_logic_single) \
+  API_V1_ROUTE("/api/logic/",              HTTP_DELETE, api_handler_logic_delete) \
+  API_V1_ROUTE("/api/modbus/",             HTTP_GET,    api_handler_modbus_get) \
+  API_V1_ROUTE("/api/modbus/",             HTTP_POST,   api_handler_modbus_post) \
+  API_V1_ROUTE("/api/wifi/",               HTTP_POST,   api_handler_wifi_post) \
+  API_V1_ROUTE("/api/persist/groups/",     HTTP_GET,    api_handler_persist_group_single) \
+  API_V1_ROUTE("/api/persist/groups/",     HTTP_POST,   api_handler_persist_group_post) \
+  API_V1_ROUTE("/api/persist/groups/",     HTTP_DELETE, api_handler_persist_group_delete) \
+  API_V1_ROUTE("/api/bindings/",           HTTP_DELETE, api_handler_bindings_delete)
+
+#endif // API_V1_ROUTES_H
@@ -0,0 +1,189 @@
+/**
+ * @file backup_format.h
+ * @brief Binary config backup container (v7.9.10.1)
+ *
+ * LAYER 6: Persistence - Backup format (pure, no ESP-IDF)
+ * Responsibility: write and parse the binary backup stream in chunks of any
+ * size, so neither side needs the whole backup (or a JSON document of it)
+ * in RAM.
+ *
+ * Layout (little endian):
+ *   file header   BkFileHeader (magic "MBKP", format version, flags)
+ *   records       BkRecordHeader | payload[len] | crc32
+ *   end record    type BK_REC_END, payload BkEnd (record count, file header CRC)
+ *
+ * The record CRC (CRC-32, zlib polynomial) covers header and payload, so
+ * a payload can be streamed before its CRC is known. A backup is only
+ * complete with its end record; readers must not apply anything before
+ * that. Unknown record types are skipped (after their CRC is checked).
+ *
+ * scripts/backup_tool.py converts a backup to JSON and back.
+ */
+
+#ifndef BACKUP_FORMAT_H
+#define BACKUP_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BK_MAGIC              0x504B424Du   // "MBKP"
+#define BK_FORMAT_VERSION     1
+#define BK_WRITE_BUF          512           // Writer output chunk
+
+// File header flags: optional content
+#define BK_FLAG_SOURCES       0x0001        // ST program records
+#define BK_FLAG_BYTECODE      0x0002        // ST bytecode images
+
+typedef enum {
+  BK_REC_INFO     = 1,    // BkInfo
+  BK_REC_SECTION  = 2,    // id = ConfigSectionId, version = section version, raw section bytes
+  BK_REC_PROGRAM  = 3,    // id = program slot, BkProgramHeader + source text
+  BK_REC_BYTECODE = 4,    // id = program slot, version = ST_BYTECODE_VERSION, XIP image
+  BK_REC_END      = 0xFF
+} BkRecordType;
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;         // BK_MAGIC
+  uint16_t format;        // BK_FORMAT_VERSION
+  uint16_t flags;         // BK_FLAG_*
+} BkFileHeader;
+
+typedef struct __attribute__((packed)) {
+  uint8_t  type;          // BkRecordType
+  uint8_t  id;
+  uint8_t  version;
+  uint8_t  reserved;
+  uint32_t len;           // Payload bytes
+} BkRecordHeader;
+
+typedef struct __attribute__((packed)) {
+  char     firmware[16];  // PROJECT_VERSION of the writer
+  uint32_t build;
+  uint16_t schema_version;
+  uint16_t config_size;   // sizeof(PersistConfig) of the writer
+} BkInfo;
+
+typedef struct __attribute__((packed)) {
+  uint8_t  enabled;
+  char     name[32];
+} BkProgramHeader;        // Source text follows (no terminator)
+
+typedef struct __attribute__((packed)) {
+  uint32_t records;       // Records before the end record
+  uint32_t header_crc;    // CRC-32 of the file header
+} BkEnd;
+
+typedef enum {
+  BK_OK = 0,
+  BK_ERR_MAGIC,           // Not a backup
+  BK_ERR_FORMAT,          // Newer container format
+  BK_ERR_CRC,             // Record CRC mismatch
+  BK_ERR_SIZE,            // Payload larger than the reader accepts
+  BK_ERR_HANDLER,         // Consumer rejected a record (out of memory, bad content)
+  BK_ERR_TRUNCATED,       // Stream ended before the end record / records missing
+  BK_ERR_TRAILING,        // Data after the end record
+  BK_ERR_SINK             // Writer output failed
+} BkError;
+
+/* ============================================================================
+ * WRITER
+ * ============================================================================ */
+
+typedef struct {
+  void *ctx;
+  bool (*write)(void *ctx, const void *buf, uint32_t len);
+} BkSink;
+
+typedef struct {
+  const BkSink *sink;
+  uint32_t crc;           // Running CRC of the open record
+  uint32_t remaining;     // Payload bytes still expected for the open record
+  uint32_t records;
+  uint32_t header_crc;
+  bool     open;
+  BkError  err;
+  uint32_t pos;
+  uint8_t  buf[BK_WRITE_BUF];
+} BkWriter;
+
+/**
+ * @brief Start a backup: writes the file header
+ */
+void bk_writer_init(BkWriter *w, const BkSink *sink, uint16_t flags);
+
+/**
+ * @brief Open a record of exactly len payload bytes (streamed with bk_data)
+ */
+bool bk_begin(BkWriter *w, uint8_t type, uint8_t id, uint8_t version, uint32_t len);
+bool bk_data(BkWriter *w, const void *data, uint32_t len);
+
+/**
+ * @brief Close the open record (all announced bytes written): appends its CRC
+ */
+bool bk_end(BkWriter *w);
+
+/**
+ * @brief Whole record in one call
+ */
+bool bk_record(BkWriter *w, uint8_t type, uint8_t id, uint8_t version,
+               const void *data, uint32_t len);
+
+/**
+ * @brief Write the end record and flush
+ * @return BK_OK if everything reached the sink
+ */
+BkError bk_finish(BkWriter *w);
+
+/* ============================================================================
+ * READER
+ * ============================================================================ */
+
+typedef struct {
+  void *ctx;
+  // Record header parsed: return a buffer for rec->len bytes, NULL to skip
+  // the payload (CRC is still checked)
+  uint8_t *(*begin)(void *ctx, const BkRecordHeader *rec);
+  // Record complete with valid CRC (payload NULL if skipped); false aborts
+  bool (*record)(void *ctx, const BkRecordHeader *rec, uint8_t *payload);
+} BkHandler;
+
+typedef struct {
+  const BkHandler *h;
+  uint32_t max_payload;
+  uint8_t  state;
+  uint8_t  hdr[sizeof(BkFileHeader) > sizeof(BkRecordHeader) ?
+               sizeof(BkFileHeader) : sizeof(BkRecordHeader)];
+  uint32_t got;           // Bytes of the current field
+  BkRecordHeader rec;
+  uint8_t *dst;
+  uint32_t crc;
+  uint8_t  crc_buf[4];
+  uint8_t  end_buf[sizeof(BkEnd)];
+  uint32_t header_crc;
+  uint16_t flags;         // From the file header
+  uint32_t records;       // Valid records before the end record
+  BkError  err;
+} BkReader;
+
+void bk_reader_init(BkReader *r, const BkHandler *h, uint32_t max_payload);
+
+/**
+ * @brief Feed the next chunk of the stream (any size)
+ * @return First error; once set, later calls return it unchanged
+ */
+BkError bk_reader_feed(BkReader *r, const void *data, uint32_t len);
+
+/**
+ * @brief Stream ended: BK_OK only if the end record was seen
+ */
+BkError bk_reader_finish(BkReader *r);
+
+/**
+ * @brief CRC-32 (poly 0xEDB88320, init/xorout 0xFFFFFFFF), incremental
+ * @param crc 0 to start
+ */
+uint32_t bk_crc32(uint32_t crc, const void *data, uint32_t len);
+
+const char *bk_error_name(BkError e);
+
+#endif // BACKUP_FORMAT_H
@@ -0,0 +1,79 @@
+/**
+ * @file boot_trace.h
+ * @brief Boot timeline profiler (v7.9.10.0)
+ *
+ * LAYER 8: System - Boot diagnostics
+ * Responsibility: record a timestamp at the end of every setup() phase and
+ * when the Modbus slave starts serving ("ready"), so restart-to-service
+ * time can be measured per phase.
+ *
+ * The timeline lives in RTC no-init memory: it survives software, panic
+ * and watchdog resets (not power-on/brownout), so after a reset the
+ * previous boot is still readable - including how far it got if it never
+ * reached ready. Timestamps are micros() since app start.
+ *
+ * Exposed by "show boot", /api/metrics (boot_*) and the watchdog record
+ * (boot_ready_us).
+ */
+
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOT_TRACE_MAGIC        0x54425442u   // "BTBT"
+#define BOOT_TRACE_MAX_PHASES   16
+#define BOOT_TRACE_NAME_LEN     12
+
+typedef struct {
+  char     name[BOOT_TRACE_NAME_LEN];   // Phase name (truncated)
+  uint32_t end_us;                      // micros() when the phase finished
+} BootTracePhase;
+
+typedef struct {
+  uint32_t magic;                       // BOOT_TRACE_MAGIC
+  uint32_t boot_count;                  // Boots since RTC memory was last lost
+  uint8_t  reset_reason;                // esp_reset_reason() of this boot
+  uint8_t  phase_count;
+  uint8_t  ready;                       // Modbus slave serving
+  uint8_t  reserved;
+  uint32_t ready_us;                    // micros() at ready
+  BootTracePhase phases[BOOT_TRACE_MAX_PHASES];
+  uint32_t crc32;                       // Over everything above
+} BootTrace;
+
+/**
+ * @brief Start a new timeline (first call in setup())
+ *
+ * Keeps a valid timeline from before the reset as the previous boot.
+ */
+void boot_trace_begin(void);
+
+/**
+ * @brief Record the end of a setup() phase
+ * @return Phase duration in µs (since the previous mark or app start)
+ */
+uint32_t boot_trace_mark(const char *phase);
+
+/**
+ * @brief Ready milestone: Modbus slave loop running (no-op after the first call)
+ */
+void boot_trace_ready(void);
+
+/**
+ * @brief Timeline of this boot
+ */
+const BootTrace *boot_trace_current(void);
+
+/**
+ * @brief Timeline of the boot before the last reset, NULL if RTC memory was lost
+ */
+const BootTrace *boot_trace_previous(void);
+
+/**
+ * @brief Duration of phase i in µs
+ */
+uint32_t boot_trace_phase_us(const BootTrace *t, uint8_t i);
+
+#endif // BOOT_TRACE_H
@@ -323,6 +323,16 @@ void cli_cmd_set_sse(uint8_t argc, char* argv[]);
  */
 void cli_cmd_set_ntp(uint8_t argc, char* argv[]);
 
+/**
+ * @brief Handle "set history" command — historian points and spill (v7.9.10.4)
+ *
+ * Examples:
+ *   set history point 1 hr 100 1000
+ *   set history point 2 off
+ *   set history spill 64
+ */
+void cli_cmd_set_history(uint8_t argc, char* argv[]);
+
 /**
  * @brief Handle "ping" command (ICMP ping to remote host)
  * @param argc Argument count
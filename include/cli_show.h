@@ -131,6 +131,11 @@ void cli_cmd_show_sse(void);
  */
 void cli_cmd_show_ntp(void);
 
+/**
+ * @brief Handle "show history" command — historian points, tiers and spill (v7.9.10.4)
+ */
+void cli_cmd_show_history(void);
+
 /**
  * @brief Handle "show debug" command (Debug flags status)
  */
@@ -146,6 +151,11 @@ void cli_cmd_show_persist(void);
  */
 void cli_cmd_show_watchdog(void);
 
+/**
+ * @brief Handle "show boot" command (Boot timeline, v7.9.10.0)
+ */
+void cli_cmd_show_boot(void);
+
 /**
  * @brief Handle "show backup" command (Backup/restore URL)
  */
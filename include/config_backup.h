@@ -0,0 +1,70 @@
+/**
+ * @file config_backup.h
+ * @brief Binary config backup and restore (v7.9.10.1)
+ *
+ * LAYER 6: Persistence - Backup/restore
+ * Responsibility: produce and consume the binary backup (backup_format.h)
+ * behind GET /api/system/backup and POST /api/system/restore when the
+ * client asks for application/octet-stream. The JSON format stays the
+ * default for browsers and old scripts.
+ *
+ * Config sections are the NVS section payloads (config_sections.h) with
+ * their section version, so a backup is just what the device stores and a
+ * restore applies them with the same resize/version rules as a boot load.
+ *
+ * A restore is staged: sections go into a private copy of the config and
+ * programs into heap buffers while the body streams in. Nothing touches
+ * the running config before the end record has been verified, so a
+ * truncated or corrupt upload changes nothing.
+ */
+
+#ifndef CONFIG_BACKUP_H
+#define CONFIG_BACKUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "backup_format.h"
+
+typedef struct {
+  char     firmware[16];        // Firmware that wrote the backup
+  uint8_t  sections;            // Sections applied
+  uint8_t  sections_skipped;    // Other section version or unknown section
+  uint8_t  programs;            // Programs restored (incl. empty slots)
+  uint8_t  cached;              // Programs started from a backup bytecode image
+  uint8_t  compiled;            // Programs compiled from source
+  uint8_t  errors;              // Upload/compile failures
+} ConfigRestoreResult;
+
+typedef struct ConfigRestore ConfigRestore;
+
+/**
+ * @brief Stream a backup of the running config into sink
+ * @param flags BK_FLAG_SOURCES and/or BK_FLAG_BYTECODE
+ */
+BkError config_backup_write(const BkSink *sink, uint16_t flags);
+
+/**
+ * @brief Start a restore session (loads lazy config sections first)
+ * @return NULL if out of memory
+ */
+ConfigRestore *config_restore_begin(void);
+
+/**
+ * @brief Feed the next chunk of the uploaded backup
+ */
+BkError config_restore_feed(ConfigRestore *r, const void *data, uint32_t len);
+
+/**
+ * @brief Upload complete: verify the end record, then apply programs and sections
+ *
+ * On success g_persist_config holds the restored config (sanitized, not yet
+ * saved or applied). On error nothing has been changed.
+ */
+BkError config_restore_commit(ConfigRestore *r, ConfigRestoreResult *res);
+
+/**
+ * @brief Release the session (after commit or to abort)
+ */
+void config_restore_free(ConfigRestore *r);
+
+#endif // CONFIG_BACKUP_H
@@ -11,4 +11,15 @@
 
 bool config_load_from_nvs(PersistConfig* out);
 
+/**
+ * @brief Fill a config with factory defaults
+ */
+void config_init_defaults(PersistConfig* cfg);
+
+/**
+ * @brief Clamp count fields to their array sizes (config from flash or a backup)
+ * @return true if anything was clamped
+ */
+bool config_sanitize(PersistConfig* cfg);
+
 #endif // config_load_H
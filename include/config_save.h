@@ -29,10 +29,25 @@
 uint16_t config_calculate_crc16(const PersistConfig* cfg);
 
 /**
- * @brief Save configuration to NVS
- * @param cfg Configuration to save
- * @return true if successful, false on error
+ * @brief Save configuration to NVS (asynchronous, v7.9.9.6)
+ * @param cfg Configuration to save (copied before returning)
+ * @return true if the write was queued, false if it could not be
+ *
+ * The NVS write runs in the persist writer task (persist_writer.h); a save
+ * that is still pending is replaced by the newer snapshot. Write errors
+ * are logged and counted by the writer. Before the writer is started the
+ * write happens synchronously.
  */
 bool config_save_to_nvs(const PersistConfig* cfg);
 
+/**
+ * @brief Save configuration to NVS and wait for the result
+ * @param cfg Configuration to save (copied before returning)
+ * @param timeout_ms Max wait (PW_WAIT_TIMEOUT_MS)
+ * @return true if written, false on NVS error or timeout
+ *
+ * For HTTP handlers that report the outcome. Not for the main loop.
+ */
+bool config_save_to_nvs_wait(const PersistConfig* cfg, uint32_t timeout_ms);
+
 #endif // config_save_H
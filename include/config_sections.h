@@ -0,0 +1,167 @@
+/**
+ * @file config_sections.h
+ * @brief Sectioned PersistConfig storage (v7.9.9.7)
+ *
+ * LAYER 6: Persistence - Config layout (pure, no NVS)
+ * Responsibility: split PersistConfig into independently stored sections
+ * (network, modbus, counters, mappings, persist, rbac, ui, system). Each
+ * section is a list of byte ranges of the packed struct, stored as one
+ * blob under its own key with its own version and CRC. A save only writes
+ * sections whose CRC differs from what is stored, so changing the hostname
+ * writes ~50 bytes instead of the whole config.
+ *
+ * Layout changes:
+ *  - New fields are appended to the struct (before crc16) AND to the end
+ *    of their section's range list. A stored section that is shorter than
+ *    the current one keeps its bytes; the new tail gets defaults.
+ *  - Any other change to a section bumps its version: that section (only)
+ *    is reset to defaults on load.
+ *
+ * The system section is last in the table and therefore written last: its
+ * presence marks a complete sectioned layout (see cs_present()).
+ *
+ * Storage is reached through CsStoreOps (NVS on target, a map in
+ * tests/host/config_sections_test.cpp).
+ */
+
+#ifndef CONFIG_SECTIONS_H
+#define CONFIG_SECTIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+
+#define CS_MAGIC              0x4353   // "CS"
+#define CS_MAX_RANGES         6
+#define CS_MAX_SECTION_SIZE   1024     // Largest section payload (mappings ~800)
+
+typedef enum {
+  CFG_SEC_NETWORK = 0,                 // Network + NTP
+  CFG_SEC_MODBUS,                      // Slave, master, mode, UART routing
+  CFG_SEC_COUNTERS,                    // Counters, timers, quadrature
+  CFG_SEC_MAPPINGS,                    // Static/dynamic regs+coils, var maps, IRQ pins
+  CFG_SEC_PERSIST,                     // Persist register groups
+  CFG_SEC_RBAC,                        // Users and roles
+  CFG_SEC_UI,                          // Dashboard layout
+  CFG_SEC_SYSTEM,                      // Hostname, flags, ST interval (written last)
+  CFG_SEC_COUNT
+} ConfigSectionId;
+
+#define CS_BIT(id)            (1UL << (id))
+#define CS_ALL                ((1UL << CFG_SEC_COUNT) - 1)
+
+typedef struct {
+  uint16_t offset;
+  uint16_t len;
+} CsRange;
+
+typedef struct {
+  const char *name;
+  const char *key;                     // NVS key (max 15 chars)
+  uint8_t     version;
+  uint8_t     range_count;
+  CsRange     ranges[CS_MAX_RANGES];
+} ConfigSection;
+
+// Stored blob: header + section bytes (ranges concatenated)
+typedef struct __attribute__((packed)) {
+  uint16_t magic;
+  uint8_t  id;
+  uint8_t  version;
+  uint16_t size;                       // Payload bytes
+  uint16_t crc;                        // CRC16 of the payload
+} CsHeader;
+
+typedef struct {
+  void *ctx;
+  // *len: buffer size in, stored size out; false if missing or too large
+  bool (*read)(void *ctx, const char *key, void *buf, uint32_t *len);
+  bool (*write)(void *ctx, const char *key, const void *buf, uint32_t len);
+  bool (*commit)(void *ctx);
+} CsStoreOps;
+
+typedef enum {
+  CS_LOADED = 0,                       // Stored section used as is
+  CS_RESIZED,                          // Shorter/longer: common prefix kept
+  CS_MISSING,                          // Not stored: defaults
+  CS_CORRUPT,                          // Bad magic/CRC: defaults
+  CS_VERSION                           // Other version: defaults
+} CsLoadResult;
+
+typedef struct {
+  uint32_t saves;                      // cs_save() calls
+  uint32_t written;                    // Sections written
+  uint32_t skipped;                    // Sections unchanged (not written)
+  uint32_t bytes;                      // Bytes written incl. headers
+  uint32_t errors;                     // Failed section writes
+  uint32_t loads;                      // Sections loaded
+} CsStats;
+
+typedef struct {
+  const CsStoreOps *ops;
+  uint32_t loaded;                     // RAM holds the section (stored or default)
+  uint32_t crc_valid;                  // saved_crc[] matches flash
+  uint16_t saved_crc[CFG_SEC_COUNT];
+  uint8_t  last_result[CFG_SEC_COUNT]; // CsLoadResult of the last load
+  CsStats  stats;
+} ConfigStore;
+
+extern const ConfigSection cs_sections[CFG_SEC_COUNT];
+
+void cs_init(ConfigStore *s, const CsStoreOps *ops);
+
+/**
+ * @brief Payload size of a section (sum of its ranges)
+ */
+uint32_t cs_section_size(ConfigSectionId id);
+
+/**
+ * @brief CRC16 of a section's bytes in cfg
+ */
+uint16_t cs_section_crc(const PersistConfig *cfg, ConfigSectionId id);
+
+/**
+ * @brief Copy a section's bytes out of cfg (cs_section_size() bytes)
+ */
+void cs_gather(const PersistConfig *cfg, ConfigSectionId id, uint8_t *out);
+
+/**
+ * @brief Apply a section payload stored elsewhere (e.g. a backup) to cfg
+ *
+ * Same rules as cs_load(): a shorter payload gets the tail from defaults.
+ * @return CS_LOADED/CS_RESIZED, CS_VERSION (cfg untouched) if version differs
+ */
+CsLoadResult cs_apply(PersistConfig *cfg, ConfigSectionId id, uint8_t version,
+                      const uint8_t *payload, uint32_t size, const PersistConfig *defaults);
+
+/**
+ * @brief Copy the sections in mask from src to dst
+ */
+void cs_copy(PersistConfig *dst, const PersistConfig *src, uint32_t mask);
+
+/**
+ * @brief Check if the store holds a complete sectioned layout
+ */
+bool cs_present(ConfigStore *s);
+
+/**
+ * @brief Load one section into cfg
+ * @param defaults Source for missing/reset bytes
+ */
+CsLoadResult cs_load(ConfigStore *s, PersistConfig *cfg, ConfigSectionId id,
+                     const PersistConfig *defaults);
+
+/**
+ * @brief Write the sections in mask whose bytes differ from flash
+ * @return Sections written, -1 if a write or the commit failed
+ */
+int cs_save(ConfigStore *s, const PersistConfig *cfg, uint32_t mask);
+
+/**
+ * @brief Forget what is stored: the next save writes every section
+ */
+void cs_invalidate(ConfigStore *s);
+
+const char *cs_result_name(CsLoadResult r);
+
+#endif // CONFIG_SECTIONS_H
@@ -0,0 +1,66 @@
+/**
+ * @file config_store.h
+ * @brief NVS backend for sectioned config storage (v7.9.9.7)
+ *
+ * LAYER 6: Persistence - Config storage
+ * Responsibility: own the ConfigStore (config_sections.h) for
+ * g_persist_config: boot load, lazy sections, delta saves from the persist
+ * writer task and the one-time conversion from the monolithic "modbus_cfg"
+ * blob (kept until a complete sectioned save has succeeded).
+ *
+ * Lazy sections (CONFIG_STORE_LAZY) are not read at boot; code that uses
+ * their fields calls config_store_ensure() first. Until then a save skips
+ * them, so the defaults in RAM never overwrite what is stored.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+#include "config_sections.h"
+
+// Sections loaded on first use (dashboard layout: web UI only)
+#define CONFIG_STORE_LAZY      CS_BIT(CFG_SEC_UI)
+
+/**
+ * @brief Load the sectioned layout (all but the lazy sections)
+ * @param defaults Factory defaults for missing or reset sections
+ * @return false if NVS holds no complete sectioned layout (use the legacy blob)
+ */
+bool config_store_load(PersistConfig *out, const PersistConfig *defaults);
+
+/**
+ * @brief Config came from the legacy blob or defaults: every section is
+ *        loaded and dirty, the next save writes all and drops the blob
+ */
+void config_store_adopt_legacy(void);
+
+/**
+ * @brief Load a lazy section into g_persist_config if not done yet
+ */
+void config_store_ensure(ConfigSectionId id);
+
+/**
+ * @brief Load all lazy sections (before replacing the whole config)
+ */
+void config_store_ensure_all(void);
+
+/**
+ * @brief Sections currently held in RAM (snapshot this with the config)
+ */
+uint32_t config_store_loaded_mask(void);
+
+/**
+ * @brief Write the changed sections of a snapshot (persist writer task)
+ * @param mask config_store_loaded_mask() taken before the snapshot
+ */
+bool config_store_save(const PersistConfig *cfg, uint32_t mask);
+
+/**
+ * @brief Statistics and per-section state for CLI/API
+ */
+void config_store_get_info(CsStats *stats, uint32_t *loaded, uint8_t last_result[CFG_SEC_COUNT]);
+
+#endif // CONFIG_STORE_H
@@ -130,6 +130,18 @@ typedef enum {
   COUNTER_DIR_DOWN = 1
 } CounterDirection;
 
+typedef enum {
+  COUNTER_FREQ_GATE = 0,       // Count delta over 1-2 s window (integer Hz)
+  COUNTER_FREQ_RECIPROCAL = 1  // Period between edges (mHz resolution, v7.9.8.5)
+} CounterFreqMode;
+
+typedef enum {
+  COUNTER_QUAD_OFF = 0,        // Single input (edge_type/direction apply)
+  COUNTER_QUAD_X1 = 1,         // A/B encoder, 1 count per cycle (PCNT only, v7.9.8.8)
+  COUNTER_QUAD_X2 = 2,         // 2 counts per cycle (A edges)
+  COUNTER_QUAD_X4 = 4          // 4 counts per cycle (A and B edges)
+} CounterQuadMode;
+
 #define COUNTER_PRESCALER_VALUES {1, 4, 8, 16, 64, 256, 1024}  // Supported prescalers
 
 /* ============================================================================
@@ -146,6 +158,14 @@ typedef enum {
   TIMER_MODE_4_INPUT_TRIGGERED = 4
 } TimerMode;
 
+// v7.9.8.9: Unit of the TimerConfig duration fields
+typedef enum {
+  TIMER_TIME_BASE_MS = 0,       // Milliseconds (default)
+  TIMER_TIME_BASE_US = 1        // Microseconds
+} TimerTimeBase;
+
+#define TIMER_HRT_MIN_US    50          // Shortest astable phase (bounds esp_timer callback rate)
+
 /* ============================================================================
  * MODBUS VALUE TYPES (for multi-register support)
  * ============================================================================ */
@@ -197,7 +217,7 @@ typedef enum {
  * EEPROM / NVS CONFIGURATION
  * ============================================================================ */
 
-#define CONFIG_SCHEMA_VERSION   19      // Current config schema version (v7.9.7.2: cache/queue size)
+#define CONFIG_SCHEMA_VERSION   21      // Current config schema version (v7.9.9.4: input interrupt mode)
 // NOTE: v7.9.7.3 ændrer kun platformio.ini (PSRAM enable på ES32D26/WROVER) — ingen schema-ændring.
 
 /* ============================================================================
@@ -353,6 +373,15 @@ typedef enum {
   #define VGPIO_SR_OUTPUT_COUNT (SR_OUT_COUNT * 8)
   // Shift register feature flag
   #define SHIFT_REGISTER_ENABLED
+  // Shift register SPI driver (v7.9.9.1): begge kæder på én SPI host med DMA.
+  // 595 bruger bussens MOSI/SCLK, 165 QH er MISO, og SCLK spejles til GPIO2 via GPIO-matrix
+  #define SR_SPI_HOST           SPI2_HOST   // HSPI (VSPI bruges af W5500)
+  #ifndef SR_SPI_CLOCK_HZ
+  #define SR_SPI_CLOCK_HZ       (1 * 1000 * 1000)   // 1 MHz (lange spor til optokoblere)
+  #endif
+  #ifndef SR_SAMPLE_PERIOD_US
+  #define SR_SAMPLE_PERIOD_US   1000        // Fast input-sampling (og maks. output-latens)
+  #endif
 
 #elif defined(BOARD_ESP32_30PIN)
   // ESP32-WROOM-32 30-pin DevKit (DEFAULT)
@@ -394,6 +423,9 @@ typedef enum {
 #define HEARTBEAT_INTERVAL_MS   500     // LED blink interval
 #define FREQUENCY_MEAS_WINDOW_MS 1000   // Frequency measurement window (1-2 sec)
 #define COUNTER_DEBOUNCE_MS     10      // Default debounce filter
+#define COUNTER_EDGE_RING_SIZE  256     // Edge timestamps per counter ring (power of 2, v7.9.8.7)
+#define COUNTER_VEL_SAMPLE_MS   10      // Default quadrature velocity sample interval (v7.9.8.8)
+#define COUNTER_VEL_FILTER_MS   100     // Default quadrature velocity low-pass time constant
 
 /* ============================================================================
  * DEBUG FLAGS (runtime controllable)
@@ -401,6 +433,7 @@ typedef enum {
 
 #define DEBUG_CONFIG_SAVE       1       // Show debug when saving config to NVS
 #define DEBUG_CONFIG_LOAD       1       // Show debug when loading config from NVS
+#define DEBUG_BOOT_ALLOCATOR_DUMP 0     // Dump register allocation map in setup() (~30 serial lines)
 
 /* ============================================================================
  * NETWORK CONFIGURATION (Wi-Fi, Telnet)
@@ -500,10 +533,132 @@ typedef enum {
  * ============================================================================ */
 
 #define PROJECT_NAME        "Modbus RTU Server (ESP32)"
-#define PROJECT_VERSION     "7.9.7.6"
+#define PROJECT_VERSION     "7.9.10.4"
 // BUILD_DATE and BUILD_NUMBER now in build_version.h (auto-generated)
 
 /* Version history:
+ * v7.9.10.4 (2026-10-18): FEAT-173: On-device historian med downsampling
+ *                    - HR/IR/counter-punkter i delta-kodet ring med min/max/avg tiers
+ *                    - Range query som CSV/binaer, valgfri spill til LittleFS
+ * v7.9.10.3 (2026-10-18): FEAT-172: LittleFS med atomisk fil-erstatning
+ *                    - ST-kilder (/logic_N.dat) og .bc-fallback skrives til temp-fil + rename: gammel eller ny fil efter reset, aldrig halv
+ *                    - SPIFFS-indhold migreres en gang ved foerste mount; fs_store kan testes paa Linux mod en mappe
+ * v7.9.10.2 (2026-10-18): FEAT-171: Warm-restart retention i no-init RAM
+ *                    - Registre, coils, counters, ST-variabler og stateful instanser spejles hver 100 ms
+ *                    - Genskabes foer Modbus slaven gaar i luften, uden flash; show boot + warm_retain_* metrics
+ * v7.9.10.1 (2026-10-18): FEAT-170: Binaert config backup/restore format
+ *                    - GET /api/system/backup og POST /api/system/restore streamer et binaert format ved application/octet-stream (JSON er stadig default)
+ *                    - Sektioner = NVS-sektionernes bytes med version og CRC, ST source og bytecode valgfrit; restore aendrer intet foer hele filen er verificeret
+ * v7.9.10.0 (2026-10-18): FEAT-169: Boot timeline profiler (boot_trace)
+ *                    - Fase-tidsstempler + ready-milepæl i RTC no-init RAM, forrige opstart bevares efter reset
+ *                    - CLI: show boot, Prometheus boot_phase_duration_us / boot_time_to_ready_us / boot_previous_*
+ *                    - Watchdog-record: boot_ready_us (NVS, API /api/system/watchdog)
+ *                    - Efter WDT/panic reset: ingen 1 s serial-ventetid og ingen 5 s RS485-prompt
+ *                    - register_allocator_debug_dump() kun med DEBUG_BOOT_ALLOCATOR_DUMP
+ * v7.9.9.9 (2026-10-18): FEAT-168: Boot fast path for ST Logic
+ *                    - NVS-manifest (st_logic/boot) med kilde-størrelse og CRC32 pr. program
+ *                    - Cache-hit: bytecode fra XIP-slot, SPIFFS monteres ikke, kilde indlæses lazy
+ *                    - Cache-miss: kompilering som før
+ *                    - Boot-tider pr. fase ([boot] ...) og ST cache/compile-tællere
+ * v7.9.9.8 (2026-10-18): FEAT-167: Execute-in-place ST bytecode (FEAT-167)
+ *                    - Partition 'stxip' (64 KB, 4 × 16 KB slots) skåret fra SPIFFS (192 → 128 KB)
+ *                    - Bytecode-cache skrives som position-uafhængigt image (offsets, ingen pointere) via persist writer
+ *                    - Ved boot mappes partitionen én gang; instruktioner kører direkte fra flash, ingen heap-kopi
+ *                    - Variabeltabel og funktionsregister kopieres til RAM (FB-instanser er mutable)
+ *                    - Slot skrives body først, header sidst: strømsvigt giver tomt slot → recompile
+ *                    - Status i show persist, Prometheus st_logic_xip_programs/st_logic_xip_bytes
+ * v7.9.9.7 (2026-10-18): FEAT-166: Sektionsopdelt config-lagring (FEAT-166)
+ *                    - PersistConfig gemmes som 8 sektioner (network, modbus, counters, mappings, persist, rbac, ui, system)
+ *                    - Hver sektion har egen NVS-nøgle, version og CRC16; kun ændrede sektioner skrives
+ *                    - Hostname-ændring skriver ~50 bytes i stedet for ~3.6 KB
+ *                    - Dashboard-sektionen (ui) indlæses først ved brug
+ *                    - Legacy 'modbus_cfg' blob læses indtil første komplette save, derefter slettes den
+ * v7.9.9.6 (2026-10-18): FEAT-165: Persist writer task (FEAT-165)
+ *                    - Config-, ST-program-, bytecode- og journal-saves køres i writer-task på core 0
+ *                    - Snapshot kopieres ved submit; ventende save med samme nøgle erstattes (sammenlægges)
+ *                    - HTTP-handlere venter på resultatet; reboot/OTA flusher køen først
+ *                    - Writer-statistik i show persist og /api/metrics (persist_writer_*)
+ * v7.9.9.5 (2026-10-18): FEAT-164: Append-only journal for persist-grupper
+ *                    - SAVE() skriver én record (≤44 bytes) i partition 'pjournal' i stedet for hele PersistConfig til NVS
+ *                    - Seneste record pr. gruppe vinder ved boot, layout-tag afviser records for ændrede grupper
+ *                    - Kompaktering: reserve-sektor altid slettet, levende records kopieres, afbrudt kompaktering genoptages ved mount
+ *                    - SPIFFS 256 → 192 KB (partitions.csv)
+ * v7.9.9.4 (2026-10-18): FEAT-163: Interrupt-driven digital inputs with timestamped edge events
+ *                    - GPIO-inputs kan markeres 'irq': CHANGE-ISR skriver DI straks og udelades af gpio_plan polling
+ *                    - Caught-latch pr. pin (ST DI_CAUGHT, read-and-clear) fanger pulser kortere end loop-cyklussen
+ *                    - Høj-pulsbredde i µs pr. pin (ST DI_PULSE, REST GET /api/gpio/{pin})
+ *                    - Lock-free di_event ring (127 events) med cursor pr. forbruger → SSE topic 'inputs'
+ *                    - DI-bytes opdateres med CAS på 32-bit ord, så ISR og polling ikke overskriver hinanden
+ *                    - Schema 21: PersistConfig.gpio_irq_pins (migration 20→21, backup/restore)
+ * v7.9.9.3 (2026-10-18): FEAT-162: Precompiled copy list for ST variable bindings
+ *                    - ST-bindings kompileres til st_binding_plan (én liste pr. retning)
+ *                    - Opslag, typevalg og grænsetjek flyttet fra hver cyklus til build
+ *                    - Side-effekt-registre (HR 200-237) og coils skrives stadig via setter
+ *                    - Invalideres fra config_apply, st_logic_compile/upload/delete og binding-ændringer
+ * v7.9.9.2 (2026-10-18): FEAT-161: Batched GPIO mapping via port registers
+ *                    - GPIO-mappings kompileres til en plan (gpio_plan) når mappings ændres
+ *                    - Inputs: GPIO.in/in1 + shift register-byte → DI-bytes med maskerede runs
+ *                    - Outputs: coil-bytes → GPIO out_w1ts/out_w1tc og SR-cache i én operation
+ *                    - Timer-ejede pins udelades via timer_engine_owned_pin_mask()
+ * v7.9.9.1 (2026-10-18): FEAT-160: SPI/DMA driver for ES32D26 shift registers
+ *                    - 595 og 165 på én SPI host med DMA, SCLK spejlet til GPIO2 via GPIO-matrix
+ *                    - Inputs samples af periodisk esp_timer i dobbeltbuffer, loop tager kun snapshot
+ *                    - Outputs sendes kun når sr_output_cache er dirty (LATCH i post_cb)
+ *                    - Bit-bang fallback hvis SPI host ikke kan tages, status i show config
+ * v7.9.9.0 (2026-10-18): FEAT-159: Timer wheel for ST timers and configurable instance pools
+ *                    - Hierarkisk timer-hjul (8 niveauer x 16 slots) pr. ST-program
+ *                    - TON/TOF/TP/BLINK planlægger deadline ved start og tjekker kun node-state
+ *                    - Hjulet avanceres én gang pr. cyklus med fælles tidsstempel
+ *                    - Stateful storage dimensioneres efter faktisk brug, lofter som -D build-flags
+ *                    - Fix: latch/hysteresis/blink/filter-instanser fik aldrig count
+ *                    - Fix: cachet bytecode og recompile lækkede/manglede stateful storage
+ * v7.9.8.9 (2026-10-18): FEAT-158: µs timer outputs on esp_timer deadlines
+ *                    - Faseskift i esp_timer callback ved absolut deadline (timer_sched), loop kun kontrol/Mode 4
+ *                    - Callback skriver coil + GPIO-mappet pin direkte, astable periode uden drift
+ *                    - time-base:ms|us (TimerConfig reserved[0], intet schema-bump), mindste astable fase 50 µs
+ * v7.9.8.8 (2026-10-18): FEAT-157: Quadrature encoder mode for PCNT counters
+ *                    - quad:x1|x2|x4 quad-b:<gpio> på PCNT counters (hw-gpio = A)
+ *                    - signed position, hastighed i counts/s (vel-filter/vel-sample) i HR base+15
+ *                    - ST: CNT_POS(id), CNT_VEL(id) - schema 20
+ * v7.9.8.7 (2026-10-18): FEAT-156: Flanke-tidsstempel ring for SW-ISR counters
+ *                    - Lock-free ring (256 tidsstempler) pr. counter, allokeres først ved brug
+ *                    - Én tabel-drevet ISR for alle counters (counter_isr + CounterIsrCtx)
+ *                    - ST: CNT_EDGES(id) giver næste flanke-interval i µs (-1 = ingen)
+ *                    - REST: GET /api/counters/{id}/edges?since= (JSON eller octet-stream)
+ * v7.9.8.6 (2026-10-18): FEAT-155: Event-drevet PCNT overflow-udvidelse
+ *                    - pcnt_poll_task (10 ms) erstattet af high/low-limit ISR med 64-bit akkumulator
+ *                    - Lock-free seqlock-læsning af 64-bit værdi (pcnt_unit_get_total)
+ *                    - Compare via PCNT threshold-event → counter_engine_compare_event()
+ *                    - DOWN-wrap i HW-mode følger nu SW-ISR (0 → start_value på én flanke)
+ * v7.9.8.5 (2026-10-18): FEAT-154: Reciprocal frekvensmåling for counters
+ *                    - Ny freq_mode pr. counter: gate (standard) eller reciprocal
+ *                    - Reciprocal: periode mellem flanker, mHz opløsning, automatisk periode/gate-skift efter rate
+ *                    - ISR-mode: µs-tidsstempel pr. flanke fra interruptet
+ *                    - freq_reg+1 = mHz-brøkdel, REST frequency_mhz, CLI freq-mode:reciprocal
+ *                    - Host-test tests/host/freq_estimator_test.cpp
+ * v7.9.8.4 (2026-10-18): FEAT-153: Session tokens til HTTP auth
+ *                    - Ny session_token.cpp: fast slot-tabel, konstant-tids compare, idle + absolut udløb
+ *                    - POST /api/auth/login (Basic → Bearer token) og /api/auth/logout
+ *                    - rbac_check_http: Bearer token = O(1) slot-opslag i stedet for Base64 + brugertabel-scan
+ *                    - Web-sider bruger token efter login; 401 på udløbet token sender WWW-Authenticate: Bearer
+ * v7.9.8.3 (2026-10-18): FEAT-152: Binært bulk register-API
+ *                    - Bulk-endpoints: content negotiation på application/octet-stream
+ *                    - Binær blok: 16-byte header (seq-nummer + tidsstempel) + big-endian data
+ *                    - registers.cpp: skrive-sekvens + seq_read_begin/retry for konsistente snapshots
+ *                    - Ny GET /api/registers/multi?hr=&ir=&coils=&di= (JSON eller binær, ét snapshot)
+ * v7.9.8.2 (2026-10-18): FEAT-151: Trie router til /api/v1
+ *                    - v1_dispatch: lineær strcmp-scan erstattet af segment-trie (api_router.cpp)
+ *                    - Mest specifikke route vinder uanset tabelrækkefølge; query-string ignoreres
+ *                    - FIX: /api/v1/registers/hr?start=&count= gav 404
+ *                    - Host benchmark: tests/host/api_router_bench (5.2× hurtigere)
+ * v7.9.8.1 (2026-10-18): FEAT-150: Precompressed web assets
+ *                    - Build-step gzipper embedded HTML sider til flash-arrays med længde + ETag
+ *                    - Content-Encoding: gzip, stærk ETag, 304 Not Modified ved revalidering
+ *                    - 210 KB → 57 KB transfer; rå literals fjernes af --gc-sections
+ * v7.9.8.0 (2026-10-18): FEAT-149: Streamet Prometheus metrics
+ *                    - /api/metrics: 12 KB heap-buffer erstattet af chunked streaming (1 KB stack)
+ *                    - Nyt ?families= filter (modbus,st,registers,...) til høj-frekvens scrapes
+ *                    - Ukendt family → 400, alarm threshold check kører uanset filter
  * v7.9.7.6 (2026-04-20): FEAT-148: ST program pool 8× forstørret via PSRAM
  *                    - ST_LOGIC_POOL_SIZE: 8 KB → 64 KB (#ifdef BOARD_HAS_PSRAM)
  *                    - source_pool: static DRAM array → dynamisk heap_caps_malloc(SPIRAM)
@@ -79,4 +79,33 @@ bool counter_config_set(uint8_t id, const CounterConfig* cfg);
  */
 CounterConfig* counter_config_get_all(void);
 
+/**
+ * @brief Default quadrature configuration (off, velocity at base + 15)
+ * @param id Counter ID (1-4)
+ */
+CounterQuadConfig counter_config_quad_defaults(uint8_t id);
+
+/**
+ * @brief Get quadrature configuration by ID (FEAT-157)
+ * @param id Counter ID (1-4)
+ * @param out Output configuration
+ * @return true if found, false otherwise
+ */
+bool counter_config_get_quad(uint8_t id, CounterQuadConfig* out);
+
+/**
+ * @brief Set quadrature configuration by ID (sanitized, applied on next
+ *        counter_engine_configure)
+ * @param id Counter ID (1-4)
+ * @param q Configuration to set
+ * @return true if successful, false otherwise
+ */
+bool counter_config_set_quad(uint8_t id, const CounterQuadConfig* q);
+
+/**
+ * @brief Counter runs as quadrature decoder (PCNT mode, quad on, B pin set)
+ * @param id Counter ID (1-4)
+ */
+bool counter_config_is_quad(uint8_t id);
+
 #endif // COUNTER_CONFIG_H
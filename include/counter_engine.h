@@ -101,6 +101,20 @@ bool counter_engine_get_config(uint8_t id, CounterConfig* out);
  */
 uint64_t counter_engine_get_value(uint8_t id);
 
+/**
+ * @brief Signed position (FEAT-157)
+ * @param id Counter ID (1-4)
+ * @return Quadrature position in counts, otherwise the counter value
+ */
+int64_t counter_engine_get_position(uint8_t id);
+
+/**
+ * @brief Velocity (FEAT-157)
+ * @param id Counter ID (1-4)
+ * @return Signed counts/s in quadrature mode, otherwise measured Hz
+ */
+int32_t counter_engine_get_velocity(uint8_t id);
+
 /**
  * @brief Set counter value (for testing/initialization)
  * @param id Counter ID (1-4)
@@ -116,5 +130,22 @@ void counter_engine_set_value(uint8_t id, uint64_t value);
  */
 uint8_t counter_engine_is_write_locked(uint8_t id);
 
+/**
+ * @brief Raw counter value at which the compare condition is reached (FEAT-155)
+ * Translates compare value/mode/source back to the counter domain so a
+ * hardware threshold can be armed. Approximate for scaled source; the
+ * compare check itself stays authoritative.
+ * @param id Counter ID (1-4)
+ * @param out_raw Output: raw counter value to reach
+ * @return false if compare is disabled or not reachable by counting (DOWN)
+ */
+bool counter_engine_compare_target(uint8_t id, uint64_t* out_raw);
+
+/**
+ * @brief Run the compare check now (FEAT-155, called from PCNT event task)
+ * @param id Counter ID (1-4)
+ */
+void counter_engine_compare_event(uint8_t id);
+
 #endif // COUNTER_ENGINE_H
 
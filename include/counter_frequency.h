@@ -20,6 +20,9 @@
  * Context: Frequency measurement works identically across all counter modes
  * Delta-based approach: Hz = (count_delta) / (time_delta_seconds)
  * Updated: ~1 second timing windows for stability
+ *
+ * Reciprocal mode (FEAT-154): Hz = edges / time between first and last edge,
+ * see freq_estimator.h. Selected per counter via CounterConfig.freq_mode.
  */
 
 #ifndef COUNTER_FREQUENCY_H
@@ -49,6 +52,14 @@ uint16_t counter_frequency_update(uint8_t id, uint64_t current_value);
  */
 uint16_t counter_frequency_get(uint8_t id);
 
+/**
+ * @brief Get last measured frequency in milli-Hz (FEAT-154)
+ * @param id Counter ID (1-4)
+ * @return Frequency in mHz (reciprocal mode: sub-Hz resolution,
+ *         gate mode: Hz * 1000)
+ */
+uint32_t counter_frequency_get_mhz(uint8_t id);
+
 /**
  * @brief Reset frequency measurement (when counter resets)
  * @param id Counter ID (1-4)
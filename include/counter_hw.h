@@ -34,6 +34,11 @@
 #include <stdint.h>
 #include "types.h"
 
+/**
+ * @brief Create the module lock (once, from setup() before any task runs)
+ */
+void counter_hw_module_init(void);
+
 /**
  * @brief Initialize hardware PCNT counter mode
  * @param id Counter ID (1-4)
@@ -67,6 +72,26 @@ void counter_hw_reset(uint8_t id);
  */
 uint64_t counter_hw_get_value(uint8_t id);
 
+/**
+ * @brief Signed position (FEAT-157)
+ * @param id Counter ID (1-4)
+ * @return Quadrature position in counts, or the counter value in single-input mode
+ */
+int64_t counter_hw_get_position(uint8_t id);
+
+/**
+ * @brief Filtered velocity of a quadrature counter (FEAT-157)
+ * @param id Counter ID (1-4)
+ * @return Counts per second, signed (0 when not in quadrature mode)
+ */
+int32_t counter_hw_get_velocity(uint8_t id);
+
+/**
+ * @brief Counter is running as quadrature decoder
+ * @param id Counter ID (1-4)
+ */
+bool counter_hw_is_quadrature(uint8_t id);
+
 /**
  * @brief Set counter value (initialize PCNT to value)
  * @param id Counter ID (1-4)
@@ -10,6 +10,7 @@
  * - ISR event counting (triggered by GPIO edge)
  * - Debounce filtering at interrupt level
  * - Value counting and overflow detection
+ * - Optional per-counter edge timestamp ring (FEAT-156)
  *
  * Does NOT handle:
  * - Polling-based counting (→ counter_sw.h)
@@ -46,6 +47,11 @@ void counter_sw_isr_attach(uint8_t id, uint8_t gpio_pin);
  */
 void counter_sw_isr_detach(uint8_t id);
 
+/**
+ * @brief GPIO pins with a counter interrupt attached (bit n = GPIO n, FEAT-163)
+ */
+uint64_t counter_sw_isr_attached_pins(void);
+
 /**
  * @brief Process any pending debounce timers (call from main loop)
  * @param id Counter ID (1-4)
@@ -72,6 +78,53 @@ uint64_t counter_sw_isr_get_value(uint8_t id);
  */
 void counter_sw_isr_set_value(uint8_t id, uint64_t value);
 
+/**
+ * @brief Get edge count and timestamp of the latest accepted edge (FEAT-154)
+ * @param id Counter ID (1-4)
+ * @param edge_count Output: running count of accepted edges (wraps at 2^32,
+ *                   independent of direction, start value and resets)
+ * @param edge_us Output: micros() of the edge that produced edge_count
+ * @return false if no interrupt is attached
+ */
+bool counter_sw_isr_get_edge_sample(uint8_t id, uint32_t* edge_count, uint32_t* edge_us);
+
+/**
+ * @brief Enable edge timestamp capture for a counter (FEAT-156)
+ *
+ * Allocates a COUNTER_EDGE_RING_SIZE ring on first call; from then on the
+ * ISR pushes micros() of every accepted edge. Idempotent.
+ * @param id Counter ID (1-4)
+ * @return true if capture is on (false: invalid id or out of memory)
+ */
+bool counter_sw_isr_edges_enable(uint8_t id);
+
+/**
+ * @brief Check whether edge capture is on
+ * @param id Counter ID (1-4)
+ */
+bool counter_sw_isr_edges_enabled(uint8_t id);
+
+/**
+ * @brief Get the range of edge numbers currently held in the ring
+ * @param id Counter ID (1-4)
+ * @param tail Output: oldest edge number still readable (may be NULL)
+ * @param head Output: edge number the next edge will get (may be NULL)
+ * @return false if capture is off
+ */
+bool counter_sw_isr_edges_window(uint8_t id, uint32_t* tail, uint32_t* head);
+
+/**
+ * @brief Read captured edge timestamps after a consumer cursor
+ * @param id Counter ID (1-4)
+ * @param cursor In/out: consumer's next edge number (see edge_ring_read)
+ * @param out Destination for micros() timestamps, oldest first
+ * @param max Capacity of out
+ * @param lost Optional: incremented by edges overwritten before being read
+ * @return Number of timestamps written (0 if capture is off)
+ */
+uint32_t counter_sw_isr_edges_read(uint8_t id, uint32_t* cursor, uint32_t* out,
+                                   uint32_t max, uint32_t* lost);
+
 /**
  * @brief Get overflow flag
  * @param id Counter ID (1-4)
@@ -0,0 +1,84 @@
+/**
+ * @file di_event.h
+ * @brief Lock-free digital input event ring (v7.9.9.4)
+ *
+ * LAYER 4: Register/Coil Storage - Interrupt-driven inputs (pure data structure)
+ * Same scheme as edge_ring, with a slot per input change instead of a
+ * bare timestamp: the GPIO ISR records {µs timestamp, pin, new level} and
+ * any number of consumers (ST, SSE clients) drain it with their own cursor.
+ *
+ * Single producer: every input interrupt is dispatched by the one GPIO ISR
+ * service, so pushes never overlap. The producer never waits; it overwrites
+ * the oldest slot. Because a slot spans several words, the slot the next
+ * push will rewrite is never handed out: a ring of size N holds the latest
+ * N - 1 events. A consumer that falls behind skips to the oldest valid slot
+ * and is told how many events it lost; slots rewritten while being copied
+ * are dropped (counted as lost), never returned torn.
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/di_event_test.cpp.
+ */
+
+#ifndef DI_EVENT_H
+#define DI_EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+  uint32_t t_us;          // micros() when the ISR ran
+  uint8_t  pin;           // GPIO 0-39
+  uint8_t  level;         // Level read in the ISR (0/1)
+  uint16_t reserved;
+} DiEvent;
+
+typedef struct {
+  DiEvent *buf;           // size slots (power of two), NULL = not initialized
+  uint32_t mask;          // size - 1
+  volatile uint32_t head; // Events pushed since init (next slot = head & mask)
+} DiEventRing;
+
+/**
+ * @brief Attach storage to a ring (size must be a power of two)
+ * @return false if size is not a power of two or buf is NULL
+ */
+bool di_event_ring_init(DiEventRing *r, DiEvent *buf, uint32_t size);
+
+/**
+ * @brief Record one input change (producer side, ISR-safe, no locks)
+ *
+ * Inline so the call is compiled into the IRAM interrupt handler.
+ * The slot is written before head is published (release).
+ */
+static inline void di_event_push(DiEventRing *r, uint32_t t_us, uint8_t pin, uint8_t level)
+{
+  uint32_t h = r->head;
+  DiEvent *e = &r->buf[h & r->mask];
+  e->t_us = t_us;
+  e->pin = pin;
+  e->level = level;
+  __atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Current head (event number the next push will get)
+ */
+static inline uint32_t di_event_head(const DiEventRing *r)
+{
+  return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Copy unread events after *cursor (consumer side)
+ * @param cursor In: next event number to read. Out: advanced past the events
+ *               returned and past any events lost
+ * @param out    Destination (oldest first)
+ * @param max    Capacity of out
+ * @param lost   Optional: incremented by events overwritten before they
+ *               could be read
+ * @return Number of events written to out
+ */
+uint32_t di_event_read(const DiEventRing *r, uint32_t *cursor,
+                       DiEvent *out, uint32_t max, uint32_t *lost);
+
+#endif // DI_EVENT_H
@@ -0,0 +1,87 @@
+/**
+ * @file di_irq.h
+ * @brief Interrupt-driven digital inputs (v7.9.9.4)
+ *
+ * LAYER 4: Register/Coil Storage - GPIO input change detection
+ * Responsibility: per-pin CHANGE interrupts for GPIO input mappings marked
+ * "irq" (PersistConfig.gpio_irq_pins)
+ *
+ * On every edge the ISR:
+ * - stores the pin level in the mapped discrete input(s) right away
+ *   (the polled GPIO plan no longer touches those bits)
+ * - sets the pin's "caught" latch (kept until read and cleared, so pulses
+ *   shorter than a loop cycle are not missed)
+ * - measures high pulse widths (rising → falling)
+ * - pushes {µs timestamp, pin, level} into one shared di_event ring that
+ *   ST and SSE clients drain with their own cursors
+ *
+ * Only real pins 0-39 can be interrupt driven; shift register inputs and
+ * pins already used by an SW-ISR counter stay polled.
+ */
+
+#ifndef DI_IRQ_H
+#define DI_IRQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "di_event.h"
+#include "gpio_plan.h"
+
+#define DI_IRQ_PIN_COUNT      40    // Real GPIO 0-39
+#define DI_IRQ_EVENT_RING     128   // Event slots (power of two, holds 127)
+#define DI_IRQ_DI_PER_PIN     4     // Discrete input bytes one pin can feed
+
+/**
+ * @brief Pins of a requested mask that can be interrupt driven right now
+ * @param requested Bit n = GPIO n (PersistConfig.gpio_irq_pins)
+ * @return requested limited to GPIO 0-39, minus SW-ISR counter pins
+ */
+uint64_t di_irq_usable_pins(uint64_t requested);
+
+/**
+ * @brief Attach/detach pin interrupts to match plan->irq_inputs
+ *
+ * Called by gpio_mapping after each plan rebuild. Newly attached pins have
+ * their discrete inputs synced to the current level first.
+ */
+void di_irq_apply(const gpio_plan_t *plan);
+
+/**
+ * @brief Pins with an attached input interrupt
+ */
+uint64_t di_irq_active_pins(void);
+
+/**
+ * @brief Edges seen on a pin since boot (0 if not interrupt driven)
+ */
+uint32_t di_irq_edge_count(uint8_t pin);
+
+/**
+ * @brief Read the "caught" latch of a pin
+ * @param clear true: clear the latch (read-and-clear is atomic vs. the ISR)
+ * @return true if an edge was seen since the latch was last cleared
+ */
+bool di_irq_caught(uint8_t pin, bool clear);
+
+/**
+ * @brief Latest completed high pulse on a pin
+ * @param count Output: pulses completed since boot (changes per new pulse)
+ * @param width_us Output: width of the latest pulse in µs
+ * @return false if the pin is not interrupt driven
+ */
+bool di_irq_get_pulse(uint8_t pin, uint32_t *count, uint32_t *width_us);
+
+/**
+ * @brief Event number the next input change will get (start cursor)
+ */
+uint32_t di_irq_events_head(void);
+
+/**
+ * @brief Read input change events after a consumer cursor
+ * @param cursor In/out: consumer's next event number (see di_event_read)
+ * @param lost Optional: incremented by events overwritten before being read
+ * @return Number of events written to out
+ */
+uint32_t di_irq_events_read(uint32_t *cursor, DiEvent *out, uint32_t max, uint32_t *lost);
+
+#endif // DI_IRQ_H
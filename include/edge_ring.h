@@ -0,0 +1,78 @@
+/**
+ * @file edge_ring.h
+ * @brief Lock-free edge timestamp ring (v7.9.8.7)
+ *
+ * LAYER 5: Feature Engines - Counter edge capture (pure data structure)
+ * Single producer (GPIO ISR) / any number of consumers. The producer never
+ * waits: it overwrites the oldest slot and advances a free-running head.
+ * Each consumer keeps its own cursor (absolute edge number), so ST and any
+ * number of API clients can drain the same ring independently.
+ *
+ * A consumer that falls more than one ring behind is moved forward to the
+ * oldest slot still valid and told how many edges it lost. Slots that the
+ * producer overwrote while they were being copied are detected by re-reading
+ * head afterwards and are dropped (counted as lost), never returned torn.
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/edge_ring_test.cpp.
+ */
+
+#ifndef EDGE_RING_H
+#define EDGE_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+  uint32_t *buf;          // size slots (power of two), NULL = capture off
+  uint32_t mask;          // size - 1
+  volatile uint32_t head; // Edges pushed since init (next slot = head & mask)
+} EdgeRing;
+
+/**
+ * @brief Attach storage to a ring (size must be a power of two)
+ * @return false if size is not a power of two or buf is NULL
+ */
+bool edge_ring_init(EdgeRing *r, uint32_t *buf, uint32_t size);
+
+/**
+ * @brief Record one edge (producer side, ISR-safe, no locks)
+ *
+ * Inline so the call is compiled into the IRAM interrupt handler.
+ * The slot is written before head is published (release), so a consumer
+ * that sees the new head also sees the timestamp.
+ */
+static inline void edge_ring_push(EdgeRing *r, uint32_t stamp_us)
+{
+  uint32_t h = r->head;
+  r->buf[h & r->mask] = stamp_us;
+  __atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Current head (edge number the next push will get)
+ */
+static inline uint32_t edge_ring_head(const EdgeRing *r)
+{
+  return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Oldest edge number still held in the ring
+ */
+uint32_t edge_ring_tail(const EdgeRing *r);
+
+/**
+ * @brief Copy unread edges after *cursor (consumer side)
+ * @param cursor In: next edge number to read. Out: advanced past the edges
+ *               returned and past any edges lost
+ * @param out    Destination for timestamps (oldest first)
+ * @param max    Capacity of out
+ * @param lost   Optional: incremented by edges overwritten before they
+ *               could be read
+ * @return Number of timestamps written to out
+ */
+uint32_t edge_ring_read(const EdgeRing *r, uint32_t *cursor,
+                        uint32_t *out, uint32_t max, uint32_t *lost);
+
+#endif // EDGE_RING_H
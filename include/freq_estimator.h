@@ -0,0 +1,64 @@
+/**
+ * @file freq_estimator.h
+ * @brief Reciprocal (period-based) frequency estimator (v7.9.8.5)
+ *
+ * LAYER 5: Feature Engines - Frequency Measurement (pure math)
+ * Input is a pair (edge_count, edge_us): a running edge counter and the
+ * timestamp of the edge that produced it. Frequency is measured over a whole
+ * number of periods between two edges, so resolution is set by the
+ * microsecond timestamp, not by a gate window.
+ *
+ * Method is chosen automatically by rate:
+ * - Below 1/min_gate: every edge closes a measurement (single period)
+ * - Above 1/min_gate: edges are accumulated until min_gate has elapsed
+ *   (multi-period gate, still aligned on edges)
+ * Without new edges the estimate decays as 1/time-since-last-edge (the true
+ * period must be at least that long) and drops to 0 after timeout_us.
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/freq_estimator_test.cpp.
+ */
+
+#ifndef FREQ_ESTIMATOR_H
+#define FREQ_ESTIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  FREQ_EST_NONE   = 0,    // No estimate (no edges or timed out)
+  FREQ_EST_PERIOD = 1,    // Last estimate spans a single period
+  FREQ_EST_GATE   = 2,    // Last estimate spans several periods
+  FREQ_EST_DECAY  = 3     // No edge for longer than the last period: upper bound
+} FreqEstMethod;
+
+typedef struct {
+  uint32_t min_gate_us;   // Minimum span per measurement (update interval at high rates)
+  uint32_t timeout_us;    // No edge for this long = 0 Hz (sets the lowest measurable rate)
+} FreqEstConfig;
+
+typedef struct {
+  uint32_t ref_count;     // Edge count at measurement reference edge
+  uint32_t ref_us;        // Timestamp of reference edge
+  uint32_t freq_mhz;      // Current estimate in milli-Hz
+  uint32_t periods;       // Periods spanned by the last measurement
+  uint8_t  have_ref;      // Reference edge captured
+  uint8_t  method;        // FreqEstMethod
+} FreqEstimator;
+
+/**
+ * @brief Reset estimator; the next edge after edge_count becomes the reference
+ */
+void freq_est_reset(FreqEstimator *st, uint32_t edge_count);
+
+/**
+ * @brief Feed the latest edge sample
+ * @param edge_count Running edge counter (wraps at 2^32)
+ * @param edge_us    Timestamp of the edge that made edge_count (wraps at 2^32)
+ * @param now_us     Current time
+ * @return true if a new measurement closed in this call
+ */
+bool freq_est_update(FreqEstimator *st, const FreqEstConfig *cfg,
+                     uint32_t edge_count, uint32_t edge_us, uint32_t now_us);
+
+#endif // FREQ_ESTIMATOR_H
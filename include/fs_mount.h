@@ -0,0 +1,52 @@
+/**
+ * @file fs_mount.h
+ * @brief LittleFS mount and one-time SPIFFS migration (v7.9.10.3)
+ *
+ * LAYER 6: Persistence - File storage
+ * Responsibility: mount the "spiffs" data partition as LittleFS and point
+ * fs_store at it. Firmware before v7.9.10.3 used SPIFFS on the same
+ * partition; the first mount after the update finds SPIFFS there, reads
+ * its files into RAM, formats the partition as LittleFS and writes them
+ * back. Later mounts are plain LittleFS mounts.
+ *
+ * The files are only in RAM between the format and the last write (tens of
+ * ms for the ST sources). If SPIFFS cannot be read completely the partition
+ * is not formatted and the mount fails; a later fs_mount() tries again.
+ */
+
+#ifndef FS_MOUNT_H
+#define FS_MOUNT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FS_MOUNT_POINT        "/littlefs"
+#define FS_SPIFFS_MOUNT_POINT "/spiffs"
+#define FS_PARTITION_LABEL    "spiffs"
+
+typedef struct {
+  bool     mounted;
+  bool     formatted;         // Partition was blank/corrupt and formatted this boot
+  uint8_t  migrated_files;    // Files moved from SPIFFS this boot
+  uint32_t migrated_bytes;
+  uint32_t migrate_us;        // SPIFFS read + format + LittleFS write
+  uint32_t mount_us;
+  uint32_t total_bytes;
+  uint32_t used_bytes;
+} FsMountInfo;
+
+/**
+ * @brief Create the mount lock (once, from setup() before any task runs)
+ */
+void fs_mount_init(void);
+
+/**
+ * @brief Mount on first call (idempotent); a failed mount is retried
+ *        at most every 10 s
+ * @return true if fs_store is usable
+ */
+bool fs_mount(void);
+
+void fs_mount_info(FsMountInfo *info);
+
+#endif // FS_MOUNT_H
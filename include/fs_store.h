@@ -0,0 +1,149 @@
+/**
+ * @file fs_store.h
+ * @brief File storage with atomic replace for ST sources and bytecode (v7.9.10.3)
+ *
+ * LAYER 6: Persistence - File storage (pure, no ESP-IDF)
+ * Responsibility: read and write the files under one root directory, so
+ * that a file is either the old or the new version after a reset, never a
+ * mix or missing.
+ *
+ * A write goes to "<name>.tmp", is flushed and fsync'ed, then renamed over
+ * the target. LittleFS (and any POSIX filesystem) replaces the target in
+ * one step. A reset before the rename leaves the old file and a stale
+ * .tmp, which fs_store_recover() removes at mount.
+ *
+ * Plain C stdio + rename(): on the device the root is the LittleFS VFS
+ * mount (fs_mount.h), on Linux any directory (tests/host/fs_store_test.cpp).
+ * Reads and writes are timed with the clock passed to fs_store_init() for
+ * the throughput figures in "show persist" and /api/metrics.
+ */
+
+#ifndef FS_STORE_H
+#define FS_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define FS_ROOT_MAX           24    // Root path incl. terminator
+#define FS_NAME_MAX           32    // File name ("/logic_0.dat") incl. terminator
+#define FS_PATH_MAX           (FS_ROOT_MAX + FS_NAME_MAX + 4)
+#define FS_TMP_SUFFIX         ".tmp"
+#define FS_IMPORT_MAX_FILES   16
+
+typedef uint32_t (*fs_clock_fn)(void);  // Monotonic µs
+
+typedef struct {
+  uint32_t reads;             // Files read (closed readers)
+  uint32_t read_bytes;
+  uint32_t read_us;           // Open to close
+  uint32_t commits;           // Files written and renamed into place
+  uint32_t write_bytes;
+  uint32_t write_us;          // Open to rename, incl. fsync
+  uint32_t aborts;            // Writes dropped, target untouched
+  uint32_t errors;            // Open/write/rename failures
+  uint32_t stale_tmp;         // Interrupted writes cleaned up at mount
+} FsStats;
+
+typedef struct {
+  FILE     *f;
+  uint32_t  t0;
+  uint32_t  bytes;
+} FsReader;
+
+typedef struct {
+  FILE     *f;
+  char      path[FS_PATH_MAX];
+  char      tmp[FS_PATH_MAX + sizeof(FS_TMP_SUFFIX)];
+  uint32_t  t0;
+  uint32_t  bytes;
+  bool      err;
+} FsWriter;
+
+// Files collected from another filesystem, written into the store in one go
+typedef struct {
+  char     name[FS_NAME_MAX];
+  uint8_t *data;
+  uint32_t len;
+} FsImportFile;
+
+typedef struct {
+  FsImportFile files[FS_IMPORT_MAX_FILES];
+  uint8_t      count;
+  uint32_t     bytes;
+} FsImport;
+
+/**
+ * @brief Use dir as the store root (no trailing slash)
+ * @return false if dir is too long or not a directory
+ */
+bool fs_store_init(const char *root, fs_clock_fn now_us);
+
+bool fs_store_ready(void);
+
+/**
+ * @brief Remove .tmp files left by interrupted writes (call once after mount)
+ * @return Files removed
+ */
+uint32_t fs_store_recover(void);
+
+bool fs_exists(const char *name);
+
+/**
+ * @return File size, -1 if missing
+ */
+int32_t fs_size(const char *name);
+
+/**
+ * @brief Delete a file
+ * @return true if the file is gone (also when it never existed)
+ */
+bool fs_remove(const char *name);
+
+/* Streamed read */
+bool fs_read_open(FsReader *r, const char *name);
+uint32_t fs_read(FsReader *r, void *buf, uint32_t len);
+void fs_read_close(FsReader *r);
+
+/* Streamed atomic write: nothing is visible before fs_write_commit() */
+bool fs_write_open(FsWriter *w, const char *name);
+bool fs_write(FsWriter *w, const void *data, uint32_t len);
+
+/**
+ * @brief Flush, fsync and rename the temp file over the target
+ * @return false on any earlier write error (target untouched)
+ */
+bool fs_write_commit(FsWriter *w);
+
+/**
+ * @brief Drop the temp file; the target keeps its old content
+ */
+void fs_write_abort(FsWriter *w);
+
+/**
+ * @brief Atomically replace a whole file
+ */
+bool fs_write_file(const char *name, const void *data, uint32_t len);
+
+const FsStats *fs_store_stats(void);
+
+/**
+ * @brief Throughput in KB/s (0 if nothing measured)
+ */
+uint32_t fs_kb_per_s(uint32_t bytes, uint32_t us);
+
+/**
+ * @brief Read every regular file of dir (not .tmp) into heap buffers
+ * @return false if a file could not be read or did not fit; nothing is kept then
+ */
+bool fs_import_collect(FsImport *imp, const char *dir);
+
+/**
+ * @brief Write the collected files into the store (atomic per file)
+ * @return Files written
+ */
+uint8_t fs_import_write(const FsImport *imp);
+
+void fs_import_free(FsImport *imp);
+
+#endif // FS_STORE_H
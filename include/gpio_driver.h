@@ -27,6 +27,15 @@ typedef enum {
 /* ISR handler type */
 typedef void (*gpio_isr_handler_t)(void* arg);
 
+/* Shift register driver statistics (v7.9.9.1) */
+typedef struct {
+  uint8_t  spi_active;   // 1 = SPI/DMA sampler, 0 = bit-bang fallback
+  uint32_t period_us;    // Input sampling period
+  uint32_t samples;      // Input frames published
+  uint32_t flushes;      // Output frames latched
+  uint32_t overruns;     // Ticks skipped because a frame was still running
+} gpio_sr_stats_t;
+
 /**
  * @brief Initialize GPIO
  */
@@ -47,6 +56,35 @@ uint8_t gpio_read(uint8_t pin);
  */
 void gpio_write(uint8_t pin, uint8_t level);
 
+/**
+ * @brief Read all real GPIO levels (v7.9.9.2)
+ * @return Bit n = level of GPIO n (0-39), from two port register reads
+ */
+uint64_t gpio_driver_read_port(void);
+
+/**
+ * @brief Drive several real GPIO outputs at once (v7.9.9.2)
+ * @param set_mask GPIOs (0-39) to drive high
+ * @param clear_mask GPIOs (0-39) to drive low
+ */
+void gpio_driver_write_port(uint64_t set_mask, uint64_t clear_mask);
+
+/**
+ * @brief Cached shift register inputs, bit i = virtual GPIO VGPIO_SR_INPUT_BASE + i
+ */
+uint32_t gpio_driver_sr_input_bits(void);
+
+/**
+ * @brief Current shift register outputs, bit i = virtual GPIO VGPIO_SR_OUTPUT_BASE + i
+ */
+uint32_t gpio_driver_sr_output_bits(void);
+
+/**
+ * @brief Update masked shift register outputs in the cache
+ * Marks the cache dirty only if a bit changed; sent by gpio_driver_flush_outputs().
+ */
+void gpio_driver_sr_write_outputs(uint32_t mask, uint32_t bits);
+
 /**
  * @brief Poll shift register I/O (call from main loop)
  *
@@ -58,15 +96,23 @@ void gpio_driver_poll(void);
 /**
  * @brief Read shift register inputs only (SN74HC165)
  * Call BEFORE reading input mappings.
+ * With the SPI driver this only snapshots the latest timer-driven sample.
  */
 void gpio_driver_poll_inputs(void);
 
 /**
  * @brief Flush shift register outputs only (SN74HC595)
  * Call AFTER writing output mappings.
+ * No-op unless an output changed; with the SPI driver the frame is sent by
+ * the sampler within SR_SAMPLE_PERIOD_US.
  */
 void gpio_driver_flush_outputs(void);
 
+/**
+ * @brief Get shift register driver statistics (zeros without shift registers)
+ */
+void gpio_driver_get_sr_stats(gpio_sr_stats_t *out);
+
 /**
  * @brief Test shift register outputs (toggle all relays ON then OFF)
  * For hardware debugging. Prints pin states to serial.
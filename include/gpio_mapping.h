@@ -45,4 +45,18 @@ void gpio_mapping_read_before_st_logic(void);
  */
 void gpio_mapping_write_after_st_logic(void);
 
+/**
+ * @brief Recompile the GPIO and ST binding plans before the next cycle
+ *
+ * Call after any change to g_persist_config.var_maps[] (CLI, REST, config
+ * load/restore) and whenever an ST program is compiled, uploaded or deleted.
+ * Cheap: the plans are rebuilt lazily by the next read/write pass.
+ */
+void gpio_mapping_invalidate(void);
+
+/**
+ * @brief Number of discrete inputs and pins served by the current GPIO plan
+ */
+void gpio_mapping_get_plan_stats(uint8_t *inputs, uint8_t *outputs);
+
 #endif // gpio_mapping_H
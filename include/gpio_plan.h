@@ -0,0 +1,114 @@
+/**
+ * @file gpio_plan.h
+ * @brief Precomputed GPIO mapping plan (v7.9.9.2)
+ *
+ * LAYER 4: Register/Coil Storage (pure logic)
+ * gpio_mapping compiles the GPIO entries of var_maps[] into a plan once and
+ * then runs every loop cycle on whole words instead of one pin at a time:
+ * inputs are captured into a 64-bit pin image (two port register reads plus
+ * the shift register byte) and scattered into the discrete input bytes as
+ * masked runs; outputs are gathered from the coil bytes into the same image
+ * layout and applied with set/clear masks.
+ *
+ * Pin image layout:
+ *   bits 0-39                  real GPIO 0-39
+ *   bits 40 + i                shift register input i  (virtual GPIO 101 + i)
+ *   bits 40 + SR_IN + i        shift register output i (virtual GPIO 201 + i)
+ *   bit 63                     always 0 (source for unreadable pins)
+ *
+ * v7.9.9.4: discrete inputs fed by a pin in interrupt mode are listed in
+ * irq_inputs instead of the input runs. The ISR owns those bits; polling
+ * them as well could write back a level sampled just before an edge.
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/gpio_plan_test.cpp.
+ */
+
+#ifndef GPIO_PLAN_H
+#define GPIO_PLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+
+#ifdef SHIFT_REGISTER_ENABLED
+#define GPIO_PLAN_SR_IN_COUNT   VGPIO_SR_INPUT_COUNT
+#define GPIO_PLAN_SR_OUT_COUNT  VGPIO_SR_OUTPUT_COUNT
+#else
+#define GPIO_PLAN_SR_IN_COUNT   0
+#define GPIO_PLAN_SR_OUT_COUNT  0
+#endif
+
+#define GPIO_PLAN_PORT_BITS     40                                          // Real GPIO 0-39
+#define GPIO_PLAN_SR_IN_BIT     GPIO_PLAN_PORT_BITS                         // First SR input bit
+#define GPIO_PLAN_SR_OUT_BIT    (GPIO_PLAN_SR_IN_BIT + GPIO_PLAN_SR_IN_COUNT)  // First SR output bit
+#define GPIO_PLAN_ZERO_BIT      63                                          // Never set
+#define GPIO_PLAN_PORT_MASK     ((1ULL << GPIO_PLAN_PORT_BITS) - 1)
+#define GPIO_PLAN_MAX_RUNS      32                                          // One per mapping worst case
+
+/* A run of consecutive bits copied between a register byte and the image:
+ *   input:  di[byte]  bits mask  <- image bits from img_bit
+ *   output: image bits from img_bit <- coils[byte] bits mask
+ * reg_bit is the lowest bit of mask. */
+typedef struct {
+  uint8_t byte;       // Register byte index
+  uint8_t reg_bit;    // First bit within the byte (0-7)
+  uint8_t img_bit;    // First bit in the pin image
+  uint8_t mask;       // Bits covered within the byte
+} gpio_plan_run_t;
+
+/* A discrete input written by the pin's interrupt handler */
+typedef struct {
+  uint8_t pin;        // GPIO 0-39
+  uint8_t byte;       // Discrete input byte index
+  uint8_t mask;       // Single bit within the byte
+} gpio_plan_irq_t;
+
+typedef struct {
+  uint64_t in_mask;                           // Image bits sampled by input runs
+  uint64_t out_mask;                          // Image bits driven every cycle
+  uint8_t  in_run_count;
+  uint8_t  out_run_count;
+  gpio_plan_run_t in_runs[GPIO_PLAN_MAX_RUNS];   // Sorted by byte
+  gpio_plan_run_t out_runs[GPIO_PLAN_MAX_RUNS];
+  uint64_t irq_mask;                          // Pins feeding irq_inputs
+  uint8_t  irq_input_count;
+  gpio_plan_irq_t irq_inputs[GPIO_PLAN_MAX_RUNS];  // Sorted by discrete input
+  uint8_t  gpio_inputs;                       // Mapped inputs after de-duplication (incl. irq)
+  uint8_t  gpio_outputs;
+} gpio_plan_t;
+
+/**
+ * @brief Image bit for a pin number (real or virtual)
+ * @param for_output true: pins that can be driven, false: pins that can be read
+ * @return Bit index, or 0xFF if the pin has no bit in that direction
+ */
+uint8_t gpio_plan_pin_bit(uint8_t pin, bool for_output);
+
+/**
+ * @brief Compile the GPIO mappings of a var_maps[] table
+ *
+ * Mirrors the per-pin loop it replaces: mappings owned by a counter/timer
+ * and unset registers are skipped, and when two mappings target the same
+ * discrete input (input) or the same pin (output) the later one wins.
+ * Unreadable pins feed a constant 0; coils past the coil table drive 0.
+ * @param irq_pins Real pins (bits 0-39) in interrupt mode: their discrete
+ *                 inputs go to irq_inputs instead of the input runs
+ */
+void gpio_plan_build(gpio_plan_t *plan, const VariableMapping *maps, uint8_t count,
+                     uint64_t irq_pins);
+
+/**
+ * @brief Scatter an input image into discrete input bytes
+ *
+ * Calls store(byte, mask, bits) once per discrete input byte the plan covers.
+ */
+void gpio_plan_scatter_inputs(const gpio_plan_t *plan, uint64_t image,
+                              void (*store)(uint8_t byte, uint8_t mask, uint8_t bits));
+
+/**
+ * @brief Gather the output image from the coil bytes (only out_mask bits are meaningful)
+ */
+uint64_t gpio_plan_gather_outputs(const gpio_plan_t *plan, const uint8_t *coils);
+
+#endif // GPIO_PLAN_H
@@ -0,0 +1,162 @@
+/**
+ * @file hist_ring.h
+ * @brief Delta-encoded time-series ring with min/max/avg tiers (v7.9.10.4)
+ *
+ * LAYER 5: Feature Engines - Historian storage (pure data structure)
+ * Responsibility: store the samples of one historian point in a fixed
+ * amount of memory, newest data replacing the oldest, plus downsampled
+ * tiers (1 min, 10 min, 1 h buckets of min/max/avg) that reach further back.
+ *
+ * A series is a ring of HIST_BLOCK_SIZE byte blocks. A block holds the time
+ * of its first record and a run of records at the series period; record i is
+ * at t0 + i * period. Each record is one zigzag LEB128 varint per field: the
+ * first record of a block holds the values, the next ones the difference to
+ * the previous record. A register that changes slowly costs ~1 byte/sample.
+ *
+ * A record whose time is not within half a period of the next slot (missed
+ * samples, clock step at NTP sync) starts a new block, so the implicit times
+ * are never off by more than period/2. When the ring is full the oldest
+ * block is dropped. Blocks are addressed by a sequence number (seq) that
+ * only grows, so a reader can walk them without holding a pointer.
+ *
+ * The block layout is also the wire format of GET /api/history/{n} (binary)
+ * and of the flash spill files (historian.cpp), all integers big-endian:
+ *   [0..7]   t0 (ms)       [8..11] seq
+ *   [12..13] record count  [14..15] payload bytes used
+ *   [16..]   records
+ *
+ * Pure C, no ESP-IDF dependencies - tested on the host by
+ * tests/host/hist_ring_test.cpp.
+ */
+
+#ifndef HIST_RING_H
+#define HIST_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HIST_BLOCK_SIZE       128
+#define HIST_BLOCK_HDR_SIZE   16
+#define HIST_BLOCK_PAYLOAD    (HIST_BLOCK_SIZE - HIST_BLOCK_HDR_SIZE)
+#define HIST_FIELDS_MAX       3     // Tier records: min, max, avg
+#define HIST_TIER_COUNT       4     // Raw + 3 downsampled
+
+typedef enum {
+  HIST_TIER_RAW = 0,                // One record per sample
+  HIST_TIER_1M,                     // 1 minute buckets
+  HIST_TIER_10M,                    // 10 minute buckets
+  HIST_TIER_1H                      // 1 hour buckets
+} HistTier;
+
+// Bucket length per tier (raw: the point's sample interval)
+extern const uint32_t hist_tier_period_ms[HIST_TIER_COUNT];
+
+typedef struct {
+  uint8_t  *mem;                    // nblocks * HIST_BLOCK_SIZE, NULL = tier off
+  uint16_t  nblocks;
+  uint8_t   fields;                 // 1 (raw) or 3 (min, max, avg)
+  uint32_t  period_ms;
+  uint32_t  next_seq;               // Seq the next block gets
+  uint32_t  blocks;                 // Blocks in use (<= nblocks)
+  bool      open;                   // Newest block accepts more records
+  uint64_t  next_t;                 // Slot time of the next record in the open block
+  int64_t   last[HIST_FIELDS_MAX];  // Previous record (delta base)
+  uint32_t  records;                // Records appended since init
+  uint32_t  evicted;                // Blocks dropped to make room
+} HistSeries;
+
+typedef struct {
+  uint64_t bucket;                  // Bucket start, UINT64_MAX = no samples yet
+  int64_t  min;
+  int64_t  max;
+  int64_t  sum;
+  uint32_t n;
+} HistAgg;
+
+typedef struct {
+  HistSeries tier[HIST_TIER_COUNT];
+  HistAgg    agg[HIST_TIER_COUNT];  // [HIST_TIER_RAW] unused
+} HistPoint;
+
+typedef struct {
+  uint64_t t0;
+  uint32_t seq;
+  uint16_t count;
+  uint16_t used;
+} HistBlockInfo;
+
+/**
+ * @brief Called per decoded record; return false to stop
+ * @param v fields values (raw: value, tiers: min, max, avg)
+ */
+typedef bool (*hist_record_fn)(void *ctx, uint64_t t_ms, const int64_t *v);
+
+/**
+ * @brief Attach storage to a series (size is rounded down to whole blocks)
+ * @return false if fewer than 2 blocks fit (series stays off)
+ */
+bool hist_series_init(HistSeries *s, uint8_t *mem, uint32_t size, uint8_t fields, uint32_t period_ms);
+
+/**
+ * @brief Append one record at t_ms (fields values)
+ */
+void hist_series_append(HistSeries *s, uint64_t t_ms, const int64_t *v);
+
+/**
+ * @brief Oldest seq still held (== next_seq when empty)
+ */
+uint32_t hist_series_tail(const HistSeries *s);
+
+/**
+ * @brief Block with the given seq, NULL if dropped or not written yet
+ *
+ * The newest block may still grow; copy it under the caller's lock.
+ */
+const uint8_t *hist_series_block(const HistSeries *s, uint32_t seq);
+
+/**
+ * @brief Split a point's memory over its tiers and start empty
+ *
+ * Raw gets half, each tier a sixth. Tiers whose bucket is not longer than
+ * the sample interval are left off and their share goes to raw.
+ * @return false if the raw series got less than 2 blocks
+ */
+bool hist_point_init(HistPoint *p, uint8_t *mem, uint32_t size, uint32_t interval_ms);
+
+/**
+ * @brief Record one sample: raw record + bucket update of every tier
+ *
+ * A tier record (bucket start, min, max, avg) is written when a sample
+ * falls into the next bucket, i.e. the running bucket is not in the tier yet.
+ */
+void hist_point_sample(HistPoint *p, uint64_t t_ms, int64_t v);
+
+/**
+ * @brief Parse a block header (also for blocks read back from flash)
+ * @return false if the header is inconsistent
+ */
+bool hist_block_info(const uint8_t *block, HistBlockInfo *info);
+
+/**
+ * @brief Time of the last record of a block
+ */
+uint64_t hist_block_end(const HistBlockInfo *info, uint32_t period_ms);
+
+/**
+ * @brief Decode the records of a block that lie in [from, to]
+ * @return Records passed to fn, -1 if the block is corrupt
+ */
+int32_t hist_block_decode(const uint8_t *block, uint8_t fields, uint32_t period_ms,
+                          uint64_t from, uint64_t to, hist_record_fn fn, void *ctx);
+
+/**
+ * @brief Big-endian helpers shared with the spill/REST framing
+ */
+void hist_put_be16(uint8_t *p, uint16_t v);
+void hist_put_be32(uint8_t *p, uint32_t v);
+void hist_put_be64(uint8_t *p, uint64_t v);
+uint16_t hist_get_be16(const uint8_t *p);
+uint32_t hist_get_be32(const uint8_t *p);
+uint64_t hist_get_be64(const uint8_t *p);
+
+#endif // HIST_RING_H
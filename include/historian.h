@@ -0,0 +1,134 @@
+/**
+ * @file historian.h
+ * @brief On-device historian for registers and counters (v7.9.10.4)
+ *
+ * LAYER 5: Feature Engines - Historian
+ * Responsibility: sample the configured points (holding/input registers,
+ * counter values) at their fixed interval from loop() into hist_ring
+ * series, so trend data survives a network outage without an external
+ * server. Read back through GET /api/history/{n} as CSV or binary blocks.
+ *
+ * Memory: one pool, split evenly over the points and per point over raw and
+ * the 1 min / 10 min / 1 h tiers (hist_point_init()). PSRAM when the board
+ * has it (HISTORIAN_POOL_PSRAM), otherwise a small DRAM pool.
+ *
+ * Flash spill (spill_kb > 0, at most the partition minus
+ * HISTORIAN_SPILL_RESERVE): every HISTORIAN_SPILL_BLOCKS sealed raw
+ * blocks are written as one file "/hist_<point>_<slot>.bin" on LittleFS
+ * through the persist writer task, so the loop never waits for flash. Each
+ * point has a ring of file slots; the oldest file is overwritten. Files
+ * carry the source/address/interval they were sampled with and survive a
+ * reboot; a query returns matching files first, then what is in RAM.
+ *
+ * Time stamps are Unix ms once NTP has synced, uptime ms before that. The
+ * step at sync starts a new block (see hist_ring.h).
+ *
+ * Changing the configuration clears the RAM history (the pool is split
+ * again); spill files of unchanged points stay readable.
+ */
+
+#ifndef HISTORIAN_H
+#define HISTORIAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+#include "hist_ring.h"
+#include "st_logic_config.h"
+
+#define HISTORIAN_POOL_PSRAM        (256 * 1024)
+#define HISTORIAN_POOL_DRAM         (16 * 1024)
+#define HISTORIAN_SPILL_BLOCKS      16      // Raw blocks per spill file (2 KB)
+#define HISTORIAN_SPILL_HDR_SIZE    24
+#define HISTORIAN_SPILL_MAX_FILES   16      // File slots per point
+// LittleFS space the spill never uses: a full ST pool twice (old and new copy
+// during the atomic replace) plus a .bc fallback. spill_kb is clamped to the
+// partition minus this when the config is applied.
+#define HISTORIAN_SPILL_BC_RESERVE  (16 * 1024)
+#define HISTORIAN_SPILL_RESERVE     (2 * ST_LOGIC_POOL_SIZE + HISTORIAN_SPILL_BC_RESERVE)
+
+typedef struct {
+  bool     active;            // Pool allocated, points sampling
+  bool     psram;             // Pool is in PSRAM
+  uint32_t pool_bytes;
+  uint8_t  points;            // Points sampling
+  uint32_t samples;           // Samples taken since the last apply
+  uint32_t late;              // Samples skipped because loop() was late
+  uint32_t spill_quota;       // Effective spill budget in bytes (spill_kb, clamped)
+  uint32_t spill_files;       // Spill files written this boot
+  uint32_t spill_bytes;
+  uint32_t spill_errors;      // Failed spill writes (spill stops for that point)
+  uint32_t spill_dropped;     // Raw blocks overwritten before they were spilled
+  uint32_t queries;           // REST range queries
+  uint32_t query_blocks;      // Blocks returned by queries
+} HistorianStats;
+
+typedef struct {
+  HistPointConfig cfg;
+  bool     sampling;
+  int64_t  last_value;
+  uint32_t capacity[HIST_TIER_COUNT];  // Blocks, 0 = tier off
+  uint32_t blocks[HIST_TIER_COUNT];
+  uint32_t records[HIST_TIER_COUNT];
+  uint64_t oldest_ms[HIST_TIER_COUNT]; // In RAM (0 = empty)
+  uint64_t newest_ms[HIST_TIER_COUNT];
+  uint8_t  spill_slots;                // File slots (0 = spill off)
+  uint8_t  spill_files;                // Files holding data for this point
+} HistorianPointStatus;
+
+/**
+ * @brief Called per block of a query; return false to stop (client gone)
+ */
+typedef bool (*historian_block_fn)(void *ctx, const uint8_t *block);
+
+/**
+ * @brief Create the lock and start sampling with the stored configuration
+ *        (from setup(), after config_apply() and before the network starts)
+ */
+void historian_init(void);
+
+/**
+ * @brief (Re)start with cfg; clears the RAM history
+ * @return true if at least one point is sampling
+ */
+bool historian_apply(const HistorianConfig *cfg);
+
+/**
+ * @brief Take the samples that are due (call from loop() after the ST cycle)
+ */
+void historian_loop(void);
+
+/**
+ * @brief Check a point configuration (source, address, interval)
+ * @return NULL if valid, else a reason
+ */
+const char *historian_point_check(const HistPointConfig *pc);
+
+/**
+ * @brief Current time stamp (Unix ms when NTP synced, else uptime ms)
+ */
+uint64_t historian_now_ms(void);
+
+const char *historian_source_name(uint8_t source);
+
+/**
+ * @brief Source from its name ("off", "hr", "ir", "counter")
+ * @return false if unknown (out unchanged)
+ */
+bool historian_source_parse(const char *name, uint8_t *out);
+
+bool historian_point_status(uint8_t point, HistorianPointStatus *out);
+
+/**
+ * @brief Walk the blocks of a point/tier that overlap [from, to], oldest first
+ *
+ * Spill files (raw tier) first, then RAM. RAM blocks are copied under the
+ * historian lock, fn runs without it. HTTP task only.
+ * @return Blocks passed to fn
+ */
+uint32_t historian_query(uint8_t point, uint8_t tier, uint64_t from, uint64_t to,
+                         historian_block_fn fn, void *ctx);
+
+const HistorianStats *historian_get_stats(void);
+
+#endif // HISTORIAN_H
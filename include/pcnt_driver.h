@@ -4,12 +4,34 @@
  *
  * LAYER 0: Hardware Abstraction Driver
  * ESP32-specific pulse counter (PCNT) support
+ *
+ * FEAT-155: Counts are extended to 64 bits by the high/low-limit event ISR
+ * (pcnt_unit_get_total), and threshold 0 can be armed to get an event at an
+ * exact count. Single-channel units count up only (direction is applied by
+ * counter_hw); quadrature units (FEAT-157) count both ways and the high and
+ * low limit are handled alike, from the event status, never by comparing
+ * consecutive reads.
  */
 
 #ifndef PCNT_DRIVER_H
 #define PCNT_DRIVER_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#define PCNT_UNIT_H_LIM   32767     // Unit resets to 0 here (high-limit event)
+#define PCNT_UNIT_L_LIM   (-32768)  // Low-limit event (not reached when counting up)
+
+/* Event bits passed to pcnt_event_cb_t */
+#define PCNT_UNIT_EVT_LIMIT      0x01  // High/low limit reached, total extended
+#define PCNT_UNIT_EVT_THRESHOLD  0x02  // Count reached the armed threshold
+
+/**
+ * @brief Event callback, called from ISR context (keep it short, IRAM)
+ * @param unit PCNT unit (0-3)
+ * @param events PCNT_UNIT_EVT_* bits
+ */
+typedef void (*pcnt_event_cb_t)(uint8_t unit, uint32_t events);
 
 /* PCNT edge modes */
 typedef enum {
@@ -34,6 +56,19 @@ void pcnt_unit_init(uint8_t unit);
 void pcnt_unit_configure(uint8_t unit, uint8_t gpio_pin,
                         pcnt_edge_mode_t pos_edge, pcnt_edge_mode_t neg_edge);
 
+/**
+ * @brief Configure PCNT unit as quadrature decoder (FEAT-157)
+ * @param unit PCNT unit (0-3)
+ * @param gpio_a Encoder channel A
+ * @param gpio_b Encoder channel B (PCNT control input)
+ * @param mode Decoding multiplier 1, 2 or 4 (see quad_decoder_rules)
+ * @param filter_ns Glitch filter, pulses shorter than this are ignored
+ *                  (0 = off, max ~12.7 us)
+ * @return false for an invalid unit or mode
+ */
+bool pcnt_unit_configure_quadrature(uint8_t unit, uint8_t gpio_a, uint8_t gpio_b,
+                                    uint8_t mode, uint16_t filter_ns);
+
 /**
  * @brief Get current PCNT count
  * @param unit PCNT unit (0-3)
@@ -49,11 +84,32 @@ void pcnt_unit_configure(uint8_t unit, uint8_t gpio_pin,
 uint32_t pcnt_unit_get_count(uint8_t unit);
 
 /**
- * @brief Clear PCNT counter
+ * @brief Clear PCNT counter and its 64-bit extension
  * @param unit PCNT unit (0-3)
  */
 void pcnt_unit_clear(uint8_t unit);
 
+/**
+ * @brief Get extended count since configure/clear (FEAT-155)
+ * @param unit PCNT unit (0-3)
+ * @return Limit events accumulated by the ISR + current hardware count
+ *         (+ a limit event latched but not yet handled by the ISR).
+ *         Lock-free, safe from any task: retries if an event lands during the read.
+ */
+int64_t pcnt_unit_get_total(uint8_t unit);
+
+/**
+ * @brief Arm threshold event at a hardware count
+ * @param unit PCNT unit (0-3)
+ * @param value Count 1..PCNT_UNIT_H_LIM-1, anything else disarms
+ */
+void pcnt_unit_set_threshold(uint8_t unit, int16_t value);
+
+/**
+ * @brief Register the event callback for all units (ISR context)
+ */
+void pcnt_unit_set_event_callback(pcnt_event_cb_t cb);
+
 /**
  * @brief Set PCNT counter value
  * @param unit PCNT unit (0-3)
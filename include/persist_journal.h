@@ -0,0 +1,145 @@
+/**
+ * @file persist_journal.h
+ * @brief Append-only, wear-leveled journal for persistent register groups (v7.9.9.5)
+ *
+ * LAYER 4: Register Persistence - Log-structured group store (pure data structure)
+ * Responsibility: small CRC-protected records {key, seq, tag, values} in a
+ * reserved flash area, latest-record-wins recovery on mount and compaction
+ * of the oldest sector.
+ *
+ * Layout: the area is split into erase sectors used in circular order. Each
+ * sector starts with a header {magic, sector seq, erase count}; records are
+ * appended behind it. A record is at most 12 + 2 * PJ_MAX_VALUES bytes
+ * (44 bytes for a full 16-register group) and is written with one program
+ * operation, so a power cut leaves at most one torn record (CRC fails, it is
+ * skipped).
+ *
+ * The sector after the active one is always erased. When the active sector
+ * fills up, the journal moves into that spare sector, copies the live
+ * records (latest per key) of the oldest sector in behind the header and
+ * erases it, which restores the spare. Every sector therefore gets erased
+ * once per lap: wear is spread evenly and a save costs one small program
+ * operation instead of a full PersistConfig NVS blob.
+ *
+ * Interrupted compaction is finished on the next mount. Copies keep their
+ * original seq; on equal seq the copy in the newer sector wins.
+ *
+ * Pure C, no ESP-IDF dependencies: flash access goes through PjFlashOps
+ * (esp_partition on the device, a file-backed NOR emulator on the host —
+ * tests/host/persist_journal_test.cpp). Not thread-safe: callers serialize.
+ */
+
+#ifndef PERSIST_JOURNAL_H
+#define PERSIST_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PJ_MAX_KEYS         16    // Distinct keys (group ids) tracked
+#define PJ_MAX_VALUES       16    // Values per record (PERSIST_GROUP_MAX_REGS)
+#define PJ_MAX_SECTORS      32    // Largest supported area, in sectors
+#define PJ_SECTOR_HDR_SIZE  16    // Sector header size (records start here)
+#define PJ_RECORD_HDR_SIZE  12    // Record header size (values follow)
+
+/**
+ * @brief Flash access for one journal area (addresses relative to its start)
+ *
+ * NOR semantics are assumed: erase sets a sector to 0xFF, write can only
+ * clear bits. The journal never writes a byte twice without an erase.
+ */
+typedef struct {
+  void *ctx;
+  uint32_t size;                  // Area size (multiple of sector_size)
+  uint32_t sector_size;           // Erase unit (4096 on ESP32)
+  bool (*read)(void *ctx, uint32_t addr, void *buf, uint32_t len);
+  bool (*write)(void *ctx, uint32_t addr, const void *buf, uint32_t len);
+  bool (*erase)(void *ctx, uint32_t addr);   // Erase the sector at addr
+} PjFlashOps;
+
+typedef struct {
+  uint32_t addr;                  // Record address, 0 = no record
+  uint32_t seq;
+  uint16_t tag;
+  uint8_t  count;
+} PjIndexEntry;
+
+typedef struct {
+  uint32_t appends;               // Records appended since mount
+  uint32_t relocated;             // Live records copied by compaction
+  uint32_t erases;                // Sector erases since mount
+  uint32_t torn;                  // Records with a bad CRC seen at mount
+  uint32_t bytes_written;         // Record bytes programmed since mount
+} PjStats;
+
+typedef struct {
+  const PjFlashOps *flash;
+  bool     mounted;
+  uint16_t sector_count;
+  uint16_t active;                // Sector being appended to
+  uint32_t write_off;             // Next record offset within active
+  uint32_t next_seq;              // Seq of the next record
+  uint32_t sector_seq;            // Seq of the active sector
+  uint32_t used_mask;             // Sectors holding a header (not erased)
+  uint32_t erase_count[PJ_MAX_SECTORS];
+  PjIndexEntry index[PJ_MAX_KEYS];
+  PjStats  stats;
+} PersistJournal;
+
+/**
+ * @brief Bytes one record with count values occupies in flash
+ */
+uint32_t pj_record_size(uint8_t count);
+
+/**
+ * @brief Scan the area, rebuild the index and finish interrupted compaction
+ *
+ * Sectors that are neither valid nor erased (interrupted erase or header
+ * write) are erased. An empty area is formatted.
+ * @return false on flash errors or an unusable geometry (< 2 sectors,
+ *         > PJ_MAX_SECTORS, sectors smaller than two full live sets or not
+ *         a multiple of 4)
+ */
+bool pj_mount(PersistJournal *j, const PjFlashOps *flash);
+
+/**
+ * @brief Append a record for key (latest record per key wins)
+ *
+ * May switch sectors and compact the oldest one (one sector erase).
+ * A flash error during compaction unmounts the journal; pj_mount repairs it.
+ * @param tag Caller-defined layout tag, returned unchanged by pj_read
+ * @return false if not mounted, key/count out of range or on flash errors
+ */
+bool pj_append(PersistJournal *j, uint8_t key, uint16_t tag,
+               const uint16_t *values, uint8_t count);
+
+/**
+ * @brief Latest record of a key from the index (no flash access)
+ * @return false if the key has no record
+ */
+bool pj_latest(const PersistJournal *j, uint8_t key, uint16_t *tag, uint32_t *seq);
+
+/**
+ * @brief Read the latest record of a key from flash (CRC verified)
+ * @param values Output, PJ_MAX_VALUES entries
+ * @param count Output: number of values in the record
+ * @return false if the key has no record or it fails verification
+ */
+bool pj_read(PersistJournal *j, uint8_t key, uint16_t *tag,
+             uint16_t *values, uint8_t *count);
+
+/**
+ * @brief Bytes still free in the active sector
+ */
+uint32_t pj_free_in_sector(const PersistJournal *j);
+
+/**
+ * @brief Lowest and highest sector erase count (wear spread)
+ */
+void pj_wear(const PersistJournal *j, uint32_t *min_erases, uint32_t *max_erases);
+
+/**
+ * @brief CRC-16/CCITT-FALSE used for headers, records and caller tags
+ */
+uint16_t pj_crc16(uint16_t crc, const void *data, uint32_t len);
+
+#endif // PERSIST_JOURNAL_H
@@ -0,0 +1,101 @@
+/**
+ * @file persist_queue.h
+ * @brief Coalescing job queue for the flash writer task (v7.9.9.6)
+ *
+ * LAYER 6: Persistence - Flash write scheduling (pure data structure)
+ * Responsibility: hold pending flash jobs in submission order, one job per
+ * key. Submitting a key that is already pending replaces its snapshot (the
+ * caller frees the old one) and adds the caller's callback to the job, so
+ * every caller learns the result of the write that carried its data. The
+ * job keeps its place in the queue, so a key saved continuously is still
+ * written in turn.
+ *
+ * pq_take() removes a job before it is executed: a submit for the same key
+ * while it is being written creates a new pending job that runs after it.
+ *
+ * Pure C, no FreeRTOS — the writer task serializes access with a mutex.
+ * Tested on the host by tests/host/persist_queue_test.cpp.
+ */
+
+#ifndef PERSIST_QUEUE_H
+#define PERSIST_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PQ_MAX_JOBS        16    // Distinct keys pending at once
+#define PQ_MAX_CALLBACKS   4     // Callers merged into one job
+
+/**
+ * @brief Completion callback (runs in the writer task)
+ * @param ok Result of the write that included the caller's snapshot
+ */
+typedef void (*pq_done_cb_t)(bool ok, void *ctx);
+
+/**
+ * @brief Executes one job (runs in the writer task)
+ * @param key Job key (identifies e.g. the program or group)
+ * @param data Snapshot, owned by the job (may be modified)
+ */
+typedef bool (*pq_exec_t)(uint16_t key, void *data, uint32_t len);
+
+typedef struct {
+  pq_done_cb_t fn;
+  void *ctx;
+} PqCallback;
+
+typedef struct {
+  uint16_t   key;
+  bool       pending;
+  uint8_t    cb_count;
+  uint32_t   order;          // Submission number of the first submit
+  uint32_t   submits;        // Submits carried by this job (1 + coalesced)
+  pq_exec_t  exec;
+  void      *data;
+  uint32_t   len;
+  PqCallback cbs[PQ_MAX_CALLBACKS];
+} PqJob;
+
+typedef struct {
+  PqJob    jobs[PQ_MAX_JOBS];
+  uint32_t next_order;
+  uint32_t submitted;        // Accepted submits
+  uint32_t coalesced;        // Submits merged into a pending job
+  uint32_t rejected;         // Queue or callback list full
+} PersistQueue;
+
+typedef enum {
+  PQ_QUEUED = 0,             // New pending job
+  PQ_COALESCED,              // Merged: *old_data must be freed by the caller
+  PQ_FULL                    // Not queued: the caller keeps ownership of data
+} PqSubmitResult;
+
+void pq_init(PersistQueue *q);
+
+/**
+ * @brief Queue a snapshot for key (or replace the pending one)
+ * @param cb Optional completion callback
+ * @param old_data Output for PQ_COALESCED: the replaced snapshot
+ */
+PqSubmitResult pq_submit(PersistQueue *q, uint16_t key, pq_exec_t exec,
+                         void *data, uint32_t len, pq_done_cb_t cb, void *ctx,
+                         void **old_data);
+
+/**
+ * @brief Remove the oldest pending job
+ * @param out Copy of the job (data ownership moves to the caller)
+ * @return false if nothing is pending
+ */
+bool pq_take(PersistQueue *q, PqJob *out);
+
+/**
+ * @brief Number of pending jobs
+ */
+uint32_t pq_pending(const PersistQueue *q);
+
+/**
+ * @brief Check if a key has a pending job
+ */
+bool pq_is_pending(const PersistQueue *q, uint16_t key);
+
+#endif // PERSIST_QUEUE_H
@@ -0,0 +1,114 @@
+/**
+ * @file persist_writer.h
+ * @brief Asynchronous flash writer task (v7.9.9.6)
+ *
+ * LAYER 6: Persistence - Flash write scheduling
+ * Responsibility: run every NVS/LittleFS/journal write in one low-priority
+ * task, so the main loop (Modbus slave, CLI, ST logic) never waits for a
+ * flash erase or commit.
+ *
+ * Callers submit a snapshot (copy-on-submit: the data is copied before
+ * persist_writer_submit returns, so the caller may keep modifying its
+ * state) together with an exec function that performs the write in the
+ * writer task. Jobs are keyed (PW_KEY_*): a key that is still pending is
+ * coalesced — only the newest snapshot is written and every caller's
+ * completion callback gets that write's result (see persist_queue.h).
+ *
+ * Before persist_writer_init() (early boot) and if the task could not be
+ * started, submits execute synchronously in the caller.
+ */
+
+#ifndef PERSIST_WRITER_H
+#define PERSIST_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "persist_queue.h"
+
+#define PW_TASK_STACK          8192  // NVS blob writes + LittleFS
+#define PW_TASK_PRIO           1     // Below everything but idle
+#define PW_TASK_CORE           0     // Main loop runs on core 1
+
+#define PW_FLUSH_TIMEOUT_MS    5000  // Default wait before a reboot
+#define PW_WAIT_TIMEOUT_MS     10000 // Default wait for HTTP handlers
+
+// Job keys (high byte = kind, low byte = instance)
+#define PW_KEY_CONFIG          0x0100              // PersistConfig → NVS
+#define PW_KEY_ST_PROGRAMS     0x0200              // ST sources → LittleFS
+#define PW_KEY_BYTECODE(id)    (0x0300 | (id))     // Bytecode cache → XIP slot / LittleFS
+#define PW_KEY_GROUP(id)       (0x0400 | (id))     // Persist group → journal
+#define PW_KEY_HISTORY(p, n)   (0x0500 | ((p) << 5) | ((n) & 0x1F))  // Historian spill file → LittleFS
+
+typedef struct {
+  bool     running;            // Task started
+  uint16_t busy_key;           // Key being written, 0 = idle
+  uint32_t pending;            // Jobs waiting
+  uint32_t submitted;          // Accepted submits (incl. coalesced)
+  uint32_t coalesced;          // Submits merged into a pending job
+  uint32_t rejected;           // Queue full / out of memory
+  uint32_t written;            // Jobs executed successfully
+  uint32_t failed;             // Jobs whose exec returned false
+  uint16_t last_fail_key;      // Key of the last failed job
+  uint32_t last_write_ms;      // Duration of the last job
+  uint32_t max_write_ms;       // Longest job since boot
+  uint32_t total_write_ms;     // Time spent writing since boot
+} PersistWriterStats;
+
+/**
+ * @brief Start the writer task
+ * @return true if the task runs (false: submits stay synchronous)
+ */
+bool persist_writer_init(void);
+
+/**
+ * @brief Queue a write (copy-on-submit)
+ * @param key Coalescing key (PW_KEY_*)
+ * @param exec Write function, called in the writer task with a private copy
+ * @param cb Optional completion callback (runs in the writer task)
+ * @return false if the queue is full or the copy could not be allocated
+ *         (cb is not called); synchronous mode: the exec result
+ */
+bool persist_writer_submit(uint16_t key, pq_exec_t exec, const void *data, uint32_t len,
+                           pq_done_cb_t cb, void *ctx);
+
+/**
+ * @brief Queue a write whose snapshot was built with persist_writer_alloc()
+ *
+ * For callers that serialize straight into the snapshot. Ownership of data
+ * moves to the writer, also when false is returned.
+ */
+bool persist_writer_submit_owned(uint16_t key, pq_exec_t exec, void *data, uint32_t len,
+                                 pq_done_cb_t cb, void *ctx);
+
+/**
+ * @brief Queue a write and wait for its result
+ *
+ * For contexts that may block and must report the outcome (HTTP
+ * handlers). Never call from the main loop.
+ * @return false on write failure or timeout (the write may still happen)
+ */
+bool persist_writer_submit_wait(uint16_t key, pq_exec_t exec, const void *data, uint32_t len,
+                                uint32_t timeout_ms);
+
+/**
+ * @brief Wait until all queued writes are done (e.g. before a reboot)
+ * @return false on timeout
+ */
+bool persist_writer_flush(uint32_t timeout_ms);
+
+/**
+ * @brief Snapshot buffer (PSRAM if available), freed by the writer
+ */
+void *persist_writer_alloc(uint32_t len);
+
+/**
+ * @brief Writer statistics for CLI/API
+ */
+void persist_writer_get_stats(PersistWriterStats *out);
+
+/**
+ * @brief Human readable name of a key kind ("config", "st-programs", ...)
+ */
+const char *persist_writer_key_name(uint16_t key);
+
+#endif // PERSIST_WRITER_H
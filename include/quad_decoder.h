@@ -0,0 +1,97 @@
+/**
+ * @file quad_decoder.h
+ * @brief Quadrature (A/B encoder) decoding rules and velocity estimator (v7.9.8.8)
+ *
+ * LAYER 5: Feature Engines - Counter quadrature mode (pure math)
+ * The PCNT unit does the decoding in hardware: channel 0 counts edges on A
+ * with B as control input, channel 1 (x4 only) counts edges on B with A as
+ * control input. quad_decoder_rules() is the single source of the channel
+ * configuration; pcnt_driver programs it into the unit and the host test
+ * runs the same rules through quad_decoder_step() with synthetic A/B
+ * sequences.
+ *
+ * Direction: A leading B (A rises while B is low) counts up.
+ *
+ * Velocity is the position delta over at least sample_us, smoothed with a
+ * first order low-pass (time constant tau_us, 0 = unfiltered).
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/quad_decoder_test.cpp.
+ */
+
+#ifndef QUAD_DECODER_H
+#define QUAD_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Edge action (PCNT pos_mode/neg_mode) */
+typedef enum {
+  QUAD_EDGE_DIS = 0,      // Ignore edge
+  QUAD_EDGE_INC = 1,      // Count +1
+  QUAD_EDGE_DEC = 2       // Count -1
+} QuadEdgeAction;
+
+/* Control input action (PCNT lctrl_mode/hctrl_mode) */
+typedef enum {
+  QUAD_CTRL_KEEP = 0,     // Edge action as configured
+  QUAD_CTRL_REVERSE = 1,  // INC and DEC swapped
+  QUAD_CTRL_DISABLE = 2   // Counting inhibited
+} QuadCtrlAction;
+
+typedef struct {
+  uint8_t pos;            // QuadEdgeAction on rising edge of the pulse input
+  uint8_t neg;            // QuadEdgeAction on falling edge of the pulse input
+  uint8_t lctrl;          // QuadCtrlAction while control input is low
+  uint8_t hctrl;          // QuadCtrlAction while control input is high
+} QuadChannelRule;
+
+/**
+ * @brief Channel rules for a decoding multiplier
+ * @param mode 1, 2 or 4 (CounterQuadMode)
+ * @param rules Output: rules[0] = pulse A / ctrl B, rules[1] = pulse B / ctrl A
+ * @return Channels used (1 for x1/x2, 2 for x4), 0 for an invalid mode
+ */
+uint8_t quad_decoder_rules(uint8_t mode, QuadChannelRule rules[2]);
+
+/**
+ * @brief Apply rules to one A/B transition (what the PCNT unit does)
+ * @param prev_ab Previous levels, bit 0 = A, bit 1 = B
+ * @param ab New levels
+ * @return Count change (0 if no rule fires, including illegal double steps)
+ */
+int8_t quad_decoder_step(const QuadChannelRule *rules, uint8_t channels,
+                         uint8_t prev_ab, uint8_t ab);
+
+typedef struct {
+  uint32_t sample_us;     // Minimum interval between velocity samples
+  uint32_t tau_us;        // Low-pass time constant (0 = no filter)
+} QuadVelocityConfig;
+
+typedef struct {
+  int64_t  last_pos;      // Position at last sample
+  uint32_t last_us;       // Time of last sample
+  float    cps;           // Filtered velocity (counts/s, signed)
+  uint8_t  have_ref;      // last_pos/last_us valid
+} QuadVelocity;
+
+/**
+ * @brief Reset velocity estimator (next update only takes a reference)
+ */
+void quad_velocity_reset(QuadVelocity *v);
+
+/**
+ * @brief Feed the current position
+ * @param pos    Signed position (counts)
+ * @param now_us Current time (wraps at 2^32)
+ * @return true if a new sample was taken in this call
+ */
+bool quad_velocity_update(QuadVelocity *v, const QuadVelocityConfig *cfg,
+                          int64_t pos, uint32_t now_us);
+
+/**
+ * @brief Velocity rounded to int32 counts/s (saturated)
+ */
+int32_t quad_velocity_get(const QuadVelocity *v);
+
+#endif // QUAD_DECODER_H
@@ -30,8 +30,9 @@
 int rbac_authenticate(const char *username, const char *password);
 
 /**
- * Authenticate from HTTP Basic Auth header (httpd_req_t).
- * Handles Base64 decoding and credential lookup.
+ * Authenticate from HTTP Authorization header (httpd_req_t).
+ * "Bearer <token>" is checked against the session token store;
+ * "Basic ..." is Base64 decoded and looked up in the user table.
  * @return User index (0-7) on success, -1 on failure.
  *         If RBAC disabled, returns 99 (virtual admin).
  */
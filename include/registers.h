@@ -42,6 +42,20 @@ void registers_set_holding_register(uint16_t addr, uint16_t value);
  */
 uint16_t* registers_get_holding_regs(void);
 
+/**
+ * @brief Check if a holding register write is only a store (v7.9.9.3)
+ * @return false for ST Logic control/interval/variable-input registers, whose
+ *         writes must go through registers_set_holding_register()
+ */
+bool registers_holding_is_plain(uint16_t addr);
+
+/**
+ * @brief Bracket direct stores through registers_get_*() pointers (v7.9.9.3)
+ * Snapshot readers see the batch like a single setter call.
+ */
+void registers_batch_begin(void);
+void registers_batch_end(void);
+
 /* ============================================================================
  * INPUT REGISTERS (Read-Only)
  * ============================================================================ */
@@ -108,6 +122,22 @@ uint8_t registers_get_discrete_input(uint16_t idx);
  */
 void registers_set_discrete_input(uint16_t idx, uint8_t value);
 
+/**
+ * @brief Set several discrete inputs of one byte in a single store (v7.9.9.2)
+ * @param byte_idx Byte index (inputs byte_idx*8 .. byte_idx*8+7)
+ * @param mask Bits to update
+ * @param bits New values for the masked bits
+ */
+void registers_set_discrete_input_bits(uint8_t byte_idx, uint8_t mask, uint8_t bits);
+
+/**
+ * @brief registers_set_discrete_input_bits() for input interrupts (IRAM, v7.9.9.4)
+ *
+ * All discrete input stores are a compare-and-swap on the containing word,
+ * so the ISR and the polled inputs can update bits of the same byte.
+ */
+void registers_set_discrete_input_isr(uint8_t byte_idx, uint8_t mask, uint8_t bits);
+
 /**
  * @brief Get all discrete inputs
  * @return Pointer to discrete inputs byte array
@@ -123,6 +153,37 @@ uint8_t* registers_get_discrete_inputs(void);
  */
 void registers_init(void);
 
+/* ============================================================================
+ * SNAPSHOT CONSISTENCY (v7.9.8.3)
+ * ============================================================================ */
+
+/**
+ * @brief Start a consistent multi-register read
+ *
+ * Usage (same pattern as a Linux read_seqbegin/read_seqretry pair), with a
+ * bounded number of attempts:
+ *   for (n = 0; n < MAX; n++) { seq = registers_seq_read_begin(); ...copy...;
+ *                               if (!registers_seq_read_retry(seq)) break; }
+ * Every register/coil setter bumps the sequence, so an unchanged sequence
+ * means no value changed while the copy was taken.
+ *
+ * Waits at most a couple of ticks for a store in flight (blocking, so a
+ * preempted lower-priority writer can finish). Task context only.
+ * @return Sequence number the copy will be consistent with
+ */
+uint32_t registers_seq_read_begin(void);
+
+/**
+ * @brief Check whether a copy started with registers_seq_read_begin() is torn
+ * @return true if a write happened during the copy (copy must be retaken)
+ */
+bool registers_seq_read_retry(uint32_t seq);
+
+/**
+ * @brief Current write sequence number (total setter calls since boot, wraps)
+ */
+uint32_t registers_get_write_seq(void);
+
 /**
  * @brief Get current millis() - for timing
  * @return Milliseconds since boot
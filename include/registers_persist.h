@@ -10,6 +10,12 @@
  * - Each group can contain up to 16 holding registers
  * - Save/restore specific groups or all groups
  * - Used by ST Logic SAVE()/LOAD() functions and CLI
+ *
+ * v7.9.9.5: every snapshot is also appended to the group journal
+ * (persist_journal, partition "pjournal"), so SAVE() no longer rewrites the
+ * whole PersistConfig in NVS. On boot the latest journal record of each
+ * group overrides the values stored in PersistConfig. Without the partition
+ * (old partition table) SAVE() falls back to the NVS write.
  */
 
 #ifndef REGISTERS_PERSIST_H
@@ -19,6 +25,24 @@
 #include <stdbool.h>
 #include "types.h"
 
+#define PERSIST_JOURNAL_LABEL    "pjournal"   // Partition label (partitions.csv)
+#define PERSIST_JOURNAL_SUBTYPE  0x40         // Custom data subtype
+
+typedef struct {
+  bool active;                // Partition found and journal mounted
+  uint32_t size;              // Partition size (bytes)
+  uint16_t sectors;
+  uint16_t active_sector;
+  uint32_t free_in_sector;    // Bytes left before the next sector switch
+  uint32_t appends;           // Records written since boot
+  uint32_t unchanged;         // Saves skipped: values already journaled
+  uint32_t relocated;         // Records copied by compaction since boot
+  uint32_t erases;            // Sector erases since boot
+  uint32_t torn;              // Bad records found at mount
+  uint32_t min_erases;        // Sector erase counts (wear spread)
+  uint32_t max_erases;
+} PersistJournalInfo;
+
 /* ============================================================================
  * INITIALIZATION
  * ============================================================================ */
@@ -29,6 +53,32 @@
  */
 void registers_persist_init(PersistentRegisterData* data);
 
+/**
+ * @brief Mount the group journal and apply its latest records (v7.9.9.5)
+ * @return true if the journal is usable
+ *
+ * Called at boot after config load, before auto-load. Records whose layout
+ * (name, register list) no longer matches the group are ignored.
+ */
+bool registers_persist_journal_init(void);
+
+/**
+ * @brief Check if saves go to the group journal
+ */
+bool registers_persist_journal_active(void);
+
+/**
+ * @brief Re-read group values from the journal into PersistConfig
+ * @param group_id Group ID (1-8), or 0 for all groups
+ * @return Number of groups updated from the journal
+ */
+uint8_t registers_persist_journal_load(uint8_t group_id);
+
+/**
+ * @brief Journal status for CLI/API
+ */
+void registers_persist_journal_info(PersistJournalInfo* out);
+
 /* ============================================================================
  * GROUP MANAGEMENT
  * ============================================================================ */
@@ -98,7 +148,9 @@ bool registers_persist_group_has_reg(const char* group_name, uint16_t reg_addr);
  * @return true if saved, false if group not found
  *
  * This function copies current holding register values into the group's
- * reg_values[] array. Call config_save_to_nvs() afterwards to persist to flash.
+ * reg_values[] array and appends them to the group journal (if active).
+ * Call config_save_to_nvs() afterwards to also store them in PersistConfig.
+ * @return false if the group is not found or the journal write fails
  */
 bool registers_persist_group_save(const char* group_name);
 
@@ -111,6 +163,16 @@ bool registers_persist_group_save(const char* group_name);
  */
 bool registers_persist_group_save_by_id(uint8_t group_id);
 
+/**
+ * @brief Snapshot group(s) and append them to the journal, without console output
+ * @param group_id Group ID (1-8), or 0 for all groups
+ * @return false if the group is not found or the journal write fails
+ *
+ * Used by ST Logic SAVE(id), which may run every cycle. Unchanged values
+ * that are already in the journal are not written again.
+ */
+bool registers_persist_group_commit(uint8_t group_id);
+
 /**
  * @brief Save all groups (snapshot current register values)
  * @return true if successful
@@ -0,0 +1,107 @@
+/**
+ * @file retain_store.h
+ * @brief Double-buffered snapshot area for warm-restart retention (v7.9.10.2)
+ *
+ * LAYER 4: Register Persistence - Retained RAM image (pure data structure)
+ * Responsibility: keep the latest complete snapshot of runtime state in a
+ * RAM area that survives a software/watchdog/panic reset (no-init memory),
+ * and find it again after the reset.
+ *
+ * The area is split into two slots. A snapshot is written into the slot
+ * that does not hold the newest valid one: its header is cleared first,
+ * then the sections are written, then the header {magic, layout, seq, len,
+ * crc} seals it. A reset in the middle leaves that slot invalid and the
+ * other one (previous snapshot) intact. After a power-on the memory holds
+ * garbage, which fails the magic/CRC check.
+ *
+ * A snapshot is a list of sections {type, id, len} + payload; what the
+ * types mean is up to the caller (warm_retain.cpp). layout is a caller
+ * chosen fingerprint of the section formats: a snapshot written by a
+ * firmware with another layout is ignored.
+ *
+ * Pure C, no ESP-IDF: the CRC function is passed in (esp_rom_crc32_le on
+ * the device, tests/host/retain_store_test.cpp on the host).
+ */
+
+#ifndef RETAIN_STORE_H
+#define RETAIN_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RS_MAGIC            0x4E544552u   // "RETN"
+
+typedef uint32_t (*rs_crc_fn)(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+typedef struct {
+  uint32_t magic;             // RS_MAGIC
+  uint32_t layout;            // Caller's section format fingerprint
+  uint32_t seq;               // Snapshot number, newest wins
+  uint32_t len;               // Section bytes after the header
+  uint32_t crc;               // Over the section bytes
+  uint32_t hdr_crc;           // Over the fields above
+} RsSlotHeader;
+
+typedef struct __attribute__((packed)) {
+  uint8_t  type;
+  uint8_t  id;
+  uint16_t len;               // Payload bytes
+} RsSection;
+
+typedef struct {
+  uint8_t  *mem;
+  uint32_t  slot_size;        // Bytes per slot incl. header
+  uint32_t  layout;
+  rs_crc_fn crc;
+  // Writer
+  uint8_t   slot;             // Slot being written
+  uint32_t  seq;              // Seq of the newest valid snapshot
+  uint32_t  pos;              // Write offset in the slot (after header)
+  uint32_t  dropped;          // Sections that did not fit (last snapshot)
+  bool      open;
+} RetainStore;
+
+/**
+ * @brief Attach to an area (contents are left alone)
+ * @param size Area bytes; each slot gets half (rounded down to 4)
+ */
+void rs_init(RetainStore *s, void *mem, uint32_t size, uint32_t layout, rs_crc_fn crc);
+
+/**
+ * @brief Newest valid snapshot in the area
+ * @param seq Optional: its sequence number
+ * @return Section bytes (iterate with rs_next), NULL if none is valid
+ */
+const uint8_t *rs_latest(RetainStore *s, uint32_t *len, uint32_t *seq);
+
+/**
+ * @brief Start a snapshot in the slot not holding the newest one
+ */
+void rs_begin(RetainStore *s);
+
+/**
+ * @brief Reserve a section of len bytes in the open snapshot
+ * @return Payload to fill, NULL if it does not fit (counted in dropped)
+ */
+uint8_t *rs_section(RetainStore *s, uint8_t type, uint8_t id, uint16_t len);
+
+/**
+ * @brief Seal the open snapshot: it becomes the newest
+ * @return Section bytes written
+ */
+uint32_t rs_commit(RetainStore *s);
+
+/**
+ * @brief Invalidate both slots (state must not come back, e.g. after a cold start)
+ */
+void rs_clear(RetainStore *s);
+
+/**
+ * @brief Iterate the sections of a snapshot
+ * @param pos Start with 0
+ * @return false at the end (or on a malformed section)
+ */
+bool rs_next(const uint8_t *data, uint32_t len, uint32_t *pos,
+             RsSection *sec, const uint8_t **payload);
+
+#endif // RETAIN_STORE_H
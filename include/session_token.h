@@ -0,0 +1,64 @@
+/**
+ * @file session_token.h
+ * @brief Short-lived HTTP session tokens (v7.9.8.4)
+ *
+ * LAYER 2: Security
+ * A client exchanges Basic credentials once at POST /api/auth/login and then
+ * sends "Authorization: Bearer <token>" on every request. The token carries
+ * its slot index, so verification is one constant-time compare against one
+ * slot instead of Base64 decoding and scanning the RBAC user table.
+ *
+ * Tokens expire after SESSION_TOKEN_IDLE_MS without use, and unconditionally
+ * after SESSION_TOKEN_MAX_AGE_MS. Deleting a user or changing its password
+ * revokes its tokens; changing the auth mode or legacy credentials revokes
+ * all of them. Bearer headers are ignored while no auth is enabled.
+ */
+
+#ifndef SESSION_TOKEN_H
+#define SESSION_TOKEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SESSION_TOKEN_SLOTS        16          // Max concurrent sessions (oldest idle is evicted)
+#define SESSION_TOKEN_SECRET_LEN   30          // Hex chars of secret (120 bits)
+#define SESSION_TOKEN_LEN          32          // 2 hex slot index + secret (excl. null)
+#define SESSION_TOKEN_IDLE_MS      900000UL    // 15 min without use
+#define SESSION_TOKEN_MAX_AGE_MS   43200000UL  // 12 h absolute lifetime
+
+/**
+ * Issue a token for an authenticated user (RBAC index or 99 = virtual admin).
+ * @param out Buffer of at least SESSION_TOKEN_LEN + 1 bytes
+ * @return true on success
+ */
+bool session_token_issue(int user_idx, char *out, size_t out_len);
+
+/**
+ * Validate a token and refresh its idle timer.
+ * @return User index on success, -1 if unknown/expired
+ */
+int session_token_check(const char *token);
+
+/**
+ * Revoke a single token (logout).
+ * @return true if the token was active
+ */
+bool session_token_revoke(const char *token);
+
+/**
+ * Revoke all tokens belonging to a user (user deleted / password changed).
+ */
+void session_token_revoke_user(int user_idx);
+
+/**
+ * Revoke every token (auth mode or legacy credentials changed).
+ */
+void session_token_revoke_all(void);
+
+/**
+ * Number of active (non-expired) sessions.
+ */
+int session_token_active_count(void);
+
+#endif // SESSION_TOKEN_H
@@ -35,7 +35,8 @@
 #define SSE_TOPIC_TIMERS        0x02
 #define SSE_TOPIC_REGISTERS     0x04
 #define SSE_TOPIC_SYSTEM        0x08
-#define SSE_TOPIC_ALL           0x0F
+#define SSE_TOPIC_INPUTS        0x10    // Interrupt-driven input edges (v7.9.9.4)
+#define SSE_TOPIC_ALL           0x1F
 
 /* ============================================================================
  * PUBLIC API
@@ -0,0 +1,102 @@
+/**
+ * @file st_binding_plan.h
+ * @brief Precompiled copy list for ST variable bindings (v7.9.9.3)
+ *
+ * LAYER 4: Register/Coil Storage (pure logic)
+ * The ST_VAR entries of var_maps[] are compiled into two flat lists of
+ * type-specialized copy operations — one per direction — when a binding,
+ * the config or a program changes. Program lookup, compiled/var_count
+ * checks, input/output type, word count and bounds are resolved at build
+ * time; per cycle gpio_mapping only runs the lists.
+ *
+ * Each entry holds direct pointers: the ST variable and either a register
+ * bit (DI/coil byte + mask) or up to two register words in LSW-first order
+ * (the only word order bindings use). Words past the register table point
+ * at a zero source (input) or a discard sink (output), which is what the
+ * bounds-checked getters/setters did. Holding registers with side effects
+ * (ST control/interval/var input) and coils are written through setters.
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/st_binding_plan_test.cpp.
+ */
+
+#ifndef ST_BINDING_PLAN_H
+#define ST_BINDING_PLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+#include "st_types.h"
+
+#define ST_BIND_MAX_ENTRIES  32     // var_maps[] capacity
+
+/* Copy operations */
+typedef enum {
+  // Inputs: register → ST variable
+  ST_BIND_IN_BIT_BOOL = 0,    // DI/coil bit → BOOL
+  ST_BIND_IN_REG_BOOL,        // HR != 0 → BOOL
+  ST_BIND_IN_REG16,           // HR → INT
+  ST_BIND_IN_REG32,           // HR pair (LSW, MSW) → DINT/DWORD/REAL bits
+  // Outputs: ST variable → register
+  ST_BIND_OUT_BOOL_COIL,      // BOOL → coil
+  ST_BIND_OUT_INT_COIL,       // INT != 0 → coil (non-BOOL variables)
+  ST_BIND_OUT_BOOL_REG,       // BOOL → HR (0/1)
+  ST_BIND_OUT_REG16,          // INT → HR
+  ST_BIND_OUT_REG32           // DINT/DWORD/REAL bits → HR pair (LSW, MSW)
+} st_bind_op_t;
+
+#define ST_BIND_VIA_SETTER   0x80   // Op flag: HR output goes through set_holding()
+
+typedef struct {
+  uint8_t     op;             // st_bind_op_t | ST_BIND_VIA_SETTER
+  uint8_t     mask;           // Bit in *bits (IN_BIT_BOOL)
+  uint16_t    addr;           // Coil index, or first HR for setter writes
+  st_value_t *var;            // ST variable
+  union {
+    uint8_t  *bits;           // DI/coil byte
+    uint16_t *reg[2];         // Register words, LSW first
+  };
+} st_bind_entry_t;
+
+typedef struct {
+  uint8_t in_count;
+  uint8_t out_count;
+  uint8_t setter_count;       // Output entries routed through set_holding()
+  st_bind_entry_t in[ST_BIND_MAX_ENTRIES];
+  st_bind_entry_t out[ST_BIND_MAX_ENTRIES];
+} st_binding_plan_t;
+
+/* Register storage and program lookup used while building */
+typedef struct {
+  uint16_t *holding;                              // HOLDING_REGS_SIZE words
+  uint8_t  *coils;                                // COILS_SIZE bytes
+  uint8_t  *discrete;                             // DISCRETE_INPUTS_SIZE bytes
+  // Variable of a compiled program, or NULL if the binding is not live
+  st_value_t *(*resolve_var)(uint8_t program_id, uint8_t var_index, st_datatype_t *type);
+  // true if writing the HR has no side effect beyond the store
+  bool (*holding_plain)(uint16_t addr);
+} st_bind_target_t;
+
+/* Setters for outputs that cannot be plain stores */
+typedef struct {
+  void (*set_coil)(uint16_t idx, uint8_t value);
+  void (*set_holding)(uint16_t addr, uint16_t value);
+} st_bind_io_t;
+
+/**
+ * @brief Compile the ST_VAR entries of a var_maps[] table (entry order kept)
+ */
+void st_binding_plan_build(st_binding_plan_t *plan, const VariableMapping *maps, uint8_t count,
+                           const st_bind_target_t *target);
+
+/**
+ * @brief Copy registers into ST variables (caller holds the variable lock)
+ */
+void st_binding_plan_run_inputs(const st_binding_plan_t *plan);
+
+/**
+ * @brief Copy ST variables into registers (caller holds the variable lock)
+ */
+void st_binding_plan_run_outputs(const st_binding_plan_t *plan, const st_bind_io_t *io);
+
+#endif // ST_BINDING_PLAN_H
@@ -23,10 +23,12 @@
  * @param group_id Group ID (0 = all, 1-8 = specific group)
  * @return 0 on success, -1 on failure, -2 if rate limited
  *
- * Rate limiting: Max 1 save per 5 seconds to protect flash wear.
+ * With the group journal (v7.9.9.5): snapshot group(s) and append one
+ * record per changed group (registers_persist_group_commit). No rate limit;
+ * unchanged groups cost no flash write.
  *
- * Steps:
- * 1. Check rate limit (max 1 save / 5 seconds)
+ * Without the journal (no "pjournal" partition):
+ * 1. Check rate limit (max 1 save / 5 seconds, protects flash wear)
  * 2. Snapshot group(s) register values (registers_persist_save_by_id)
  * 3. Write entire config to NVS (config_save_to_nvs)
  * 4. Return status
@@ -44,7 +46,8 @@ st_value_t st_builtin_persist_save(st_value_t group_id_arg);
  * @return 0 on success, -1 on failure
  *
  * Steps:
- * 1. Read config from NVS (config_load_from_nvs)
+ * 1. Read group values from the journal (registers_persist_journal_load),
+ *    or the config from NVS without it (config_load_from_nvs)
  * 2. Restore group(s) register values (registers_persist_restore_by_id)
  * 3. Return status
  *
@@ -98,6 +98,7 @@ st_value_t st_builtin_hysteresis(st_value_t in, st_value_t high, st_value_t low,
  * @param on_time ON duration in milliseconds (INT)
  * @param off_time OFF duration in milliseconds (INT)
  * @param instance Pointer to blink instance storage
+ * @param wheel Timer wheel of the instance's storage (phase deadlines, v7.9.9.0)
  * @return Q output (BOOL)
  *
  * @example
@@ -107,7 +108,7 @@ st_value_t st_builtin_hysteresis(st_value_t in, st_value_t high, st_value_t low,
  * @note Requires stateful storage for state machine
  */
 st_value_t st_builtin_blink(st_value_t enable, st_value_t on_time, st_value_t off_time,
-                             st_blink_instance_t* instance);
+                             st_blink_instance_t* instance, st_timer_wheel_t* wheel);
 
 /**
  * @brief First-order low-pass filter
@@ -19,6 +19,11 @@
  *   motor_running := TON(start_button, 5000);  (* 5 second delay *)
  *
  * Note: PT (Preset Time) is in milliseconds.
+ *
+ * v7.9.9.0: Timers no longer read millis() on every call. A running timer
+ * has its deadline on the program's timer wheel (st_timer_wheel.h), which
+ * the engine advances once per cycle; the call only checks whether the
+ * deadline fired. The cycle timestamp is wheel->now.
  */
 
 #ifndef ST_BUILTIN_TIMERS_H
@@ -26,7 +31,6 @@
 
 #include "st_types.h"
 #include "st_stateful.h"
-#include <Arduino.h>  // For millis()
 
 /* ============================================================================
  * TIMER FUNCTIONS
@@ -48,12 +52,14 @@
  * @param IN Input signal (BOOL)
  * @param PT Preset time in milliseconds (INT)
  * @param instance Pointer to timer instance storage
+ * @param wheel Timer wheel of the instance's storage
  * @return Q output (BOOL) - TRUE after delay, FALSE immediately
  *
  * @example
  *   motor := TON(start_button, 3000);  (* 3 second start delay *)
  */
-st_value_t st_builtin_ton(st_value_t IN, st_value_t PT, st_timer_instance_t* instance);
+st_value_t st_builtin_ton(st_value_t IN, st_value_t PT, st_timer_instance_t* instance,
+                          st_timer_wheel_t* wheel);
 
 /**
  * @brief Off-Delay Timer (TOF)
@@ -71,12 +77,14 @@ st_value_t st_builtin_ton(st_value_t IN, st_value_t PT, st_timer_instance_t* ins
  * @param IN Input signal (BOOL)
  * @param PT Preset time in milliseconds (INT)
  * @param instance Pointer to timer instance storage
+ * @param wheel Timer wheel of the instance's storage
  * @return Q output (BOOL) - TRUE immediately, FALSE after delay
  *
  * @example
  *   fan := TOF(motor_running, 60000);  (* Fan runs 1 min after motor stops *)
  */
-st_value_t st_builtin_tof(st_value_t IN, st_value_t PT, st_timer_instance_t* instance);
+st_value_t st_builtin_tof(st_value_t IN, st_value_t PT, st_timer_instance_t* instance,
+                          st_timer_wheel_t* wheel);
 
 /**
  * @brief Pulse Timer (TP)
@@ -94,21 +102,25 @@ st_value_t st_builtin_tof(st_value_t IN, st_value_t PT, st_timer_instance_t* ins
  * @param IN Input signal (BOOL)
  * @param PT Preset time in milliseconds (INT)
  * @param instance Pointer to timer instance storage
+ * @param wheel Timer wheel of the instance's storage
  * @return Q output (BOOL) - Pulse of PT duration
  *
  * @example
  *   valve_pulse := TP(trigger, 500);  (* 500ms valve pulse *)
  */
-st_value_t st_builtin_tp(st_value_t IN, st_value_t PT, st_timer_instance_t* instance);
+st_value_t st_builtin_tp(st_value_t IN, st_value_t PT, st_timer_instance_t* instance,
+                          st_timer_wheel_t* wheel);
 
 /**
  * @brief Get elapsed time from timer instance
  *
  * Returns ET (Elapsed Time) in milliseconds for display/monitoring.
+ * While the timer runs, ET is derived from the start time (capped at PT).
  *
  * @param instance Pointer to timer instance
+ * @param now_ms Current cycle timestamp (wheel->now)
  * @return Elapsed time in milliseconds
  */
-uint32_t st_timer_get_et(st_timer_instance_t* instance);
+uint32_t st_timer_get_et(const st_timer_instance_t* instance, uint32_t now_ms);
 
 #endif // ST_BUILTIN_TIMERS_H
@@ -121,6 +121,13 @@ typedef enum {
   ST_BUILTIN_CNT_RAW,        // CNT_RAW(id) → DINT (raw counter value)
   ST_BUILTIN_CNT_FREQ,       // CNT_FREQ(id) → INT (frequency in Hz)
   ST_BUILTIN_CNT_STATUS,     // CNT_STATUS(id) → INT (bitfield: bit0=running, bit1=overflow, bit2=compare_hit)
+  ST_BUILTIN_CNT_EDGES,      // CNT_EDGES(id) → DINT (next captured edge interval in µs, -1 = none, v7.9.8.7)
+  ST_BUILTIN_CNT_POS,        // CNT_POS(id) → DINT (signed quadrature position, clamped, v7.9.8.8)
+  ST_BUILTIN_CNT_VEL,        // CNT_VEL(id) → DINT (quadrature velocity counts/s, v7.9.8.8)
+
+  // Interrupt-driven inputs (v7.9.9.4)
+  ST_BUILTIN_DI_CAUGHT,      // DI_CAUGHT(pin) → BOOL (edge seen since last call, read-and-clear)
+  ST_BUILTIN_DI_PULSE,       // DI_PULSE(pin) → DINT (width of a new high pulse in µs, -1 = none)
 
   ST_BUILTIN_COUNT          // Total number of built-ins
 } st_builtin_func_t;
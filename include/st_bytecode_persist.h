@@ -1,12 +1,18 @@
 /**
  * @file st_bytecode_persist.h
- * @brief Bytecode persistence to SPIFFS
+ * @brief Bytecode persistence (XIP slots, LittleFS files as fallback)
  *
  * Saves compiled bytecode to /logic_N.bc files.
  * At boot, loads cached bytecode instead of recompiling from source.
  * Uses CRC32 of source code as invalidation key.
  *
  * Format: 16-byte header + 32-byte name + variable table + instructions + optional function registry
+ *
+ * v7.9.9.8: With an "stxip" partition the cache is an execute-in-place image
+ * (st_xip_image.h) in one slot per program instead. The partition is
+ * memory-mapped once; a loaded program runs its instructions straight from
+ * flash and only the variable tables live in RAM. Programs too large for a
+ * slot, and partition tables without "stxip", use the .bc file.
  */
 
 #ifndef ST_BYTECODE_PERSIST_H
@@ -15,11 +21,27 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "st_types.h"
+#include "st_xip_image.h"
 
 /* Magic number "STBC" */
 #define ST_BYTECODE_MAGIC   0x53544243
 #define ST_BYTECODE_VERSION 3  // v3: var_names reduced from 32 to 16 bytes
 
+/* XIP partition (partitions.csv): one slot per program */
+#define ST_XIP_LABEL        "stxip"
+#define ST_XIP_SUBTYPE      0x41        // Custom data subtype
+#define ST_XIP_SLOTS        4           // ST_LOGIC_MAX_PROGRAMS
+
+typedef struct {
+  bool     active;            // Partition found and mapped
+  uint32_t size;              // Partition bytes
+  uint32_t slot_size;
+  uint8_t  mapped;            // Programs running from flash
+  uint32_t flash_bytes;       // Instruction bytes executed in place (not in heap)
+  uint32_t writes;            // Images written
+  uint32_t fallbacks;         // Saves that used a .bc file (image larger than a slot)
+} StXipInfo;
+
 /* Bytecode file header (16 bytes) */
 typedef struct __attribute__((packed)) {
   uint32_t magic;             // 0x53544243 ("STBC")
@@ -33,7 +55,7 @@ typedef struct __attribute__((packed)) {
 } st_bc_header_t;
 
 /**
- * @brief Save compiled bytecode to SPIFFS
+ * @brief Save compiled bytecode (XIP slot, else /logic_N.bc)
  * @param program_id Program index (0-3)
  * @param bytecode Compiled bytecode program
  * @param source Source code (for CRC32 calculation)
@@ -44,9 +66,9 @@ bool st_bytecode_save(uint8_t program_id, const st_bytecode_program_t *bytecode,
                       const char *source, uint32_t source_size);
 
 /**
- * @brief Load cached bytecode from SPIFFS
+ * @brief Load cached bytecode (XIP slot, else /logic_N.bc)
  * @param program_id Program index (0-3)
- * @param bytecode Output: bytecode program (instructions will be malloc'd)
+ * @param bytecode Output: bytecode program (instructions malloc'd, or mapped flash)
  * @param source Source code (for CRC32 validation)
  * @param source_size Size of source code
  * @return true if loaded successfully (false = cache miss/invalid, must recompile)
@@ -55,17 +77,42 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
                       const char *source, uint32_t source_size);
 
 /**
- * @brief Delete cached bytecode file
- * @param program_id Program index (0-3)
+ * @brief Load cached bytecode by source CRC, without the source (boot fast path)
+ * @param source_crc32 st_crc32() of the source the cache must match
+ * @param use_file false = XIP slot only (filesystem not touched)
+ * @return true if loaded (false = cache miss/invalid)
  */
-void st_bytecode_invalidate(uint8_t program_id);
+bool st_bytecode_load_crc(uint8_t program_id, st_bytecode_program_t *bytecode,
+                          uint32_t source_crc32, bool use_file);
+
+/**
+ * @brief Write a bytecode image from a backup into the program's XIP slot
+ *
+ * Blocks until written (HTTP handlers only). The image must pass
+ * st_xip_check() for source_crc32 and this compiler version; a following
+ * st_bytecode_load() then maps it instead of recompiling.
+ * @return false if there is no partition, the slot is in use, or the image is stale
+ */
+bool st_bytecode_install_image(uint8_t program_id, const uint8_t *img, uint32_t len,
+                               uint32_t source_crc32);
 
 /**
- * @brief Calculate CRC32 of data
- * @param data Pointer to data
- * @param len Length of data
- * @return CRC32 value
+ * @brief Release bytecode->instructions (free heap, leave mapped flash alone)
  */
-uint32_t st_crc32(const uint8_t *data, uint32_t len);
+void st_bytecode_free_instructions(st_bytecode_program_t *bytecode);
+
+/**
+ * @brief XIP partition state for CLI/API
+ */
+void st_bytecode_xip_info(StXipInfo *info);
+
+/**
+ * @brief Delete cached bytecode file
+ * @param program_id Program index (0-3)
+ *
+ * An XIP slot is left as is: its source CRC no longer matches, and the
+ * program may still be running from it until it is recompiled.
+ */
+void st_bytecode_invalidate(uint8_t program_id);
 
 #endif // ST_BYTECODE_PERSIST_H
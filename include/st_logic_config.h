@@ -39,6 +39,12 @@
   #define ST_LOGIC_POOL_SIZE 8000   // 8 KB i DRAM (WROOM fallback)
 #endif
 
+// LittleFS-plads der holdes fri ved siden af en atomisk source-save:
+// blok-afrunding og directory-metadata for temp-filen (v7.9.10.3)
+#define ST_LOGIC_FS_SLACK  (8 * 1024)
+
+#define ST_DEFERRED_RETRY_MS  10000  // Nyt forsøg på at læse en deferred source
+
 typedef struct {
   // Program identification
   char name[32];              // "Logic1", "Logic2", etc.
@@ -47,6 +53,7 @@ typedef struct {
   // Source code storage (dynamic pool allocation)
   uint32_t source_offset;     // Offset in global pool (0xFFFFFFFF if not allocated)
   uint32_t source_size;       // Actual source code size
+  uint8_t source_deferred;    // v7.9.9.9: booted from cache, source read on first use
 
   // Compiled bytecode
   st_bytecode_program_t bytecode; // Compiled and ready to execute
@@ -102,6 +109,11 @@ typedef struct {
   // FEAT-008: Per-program debugger state
   st_debug_state_t debugger[ST_LOGIC_MAX_PROGRAMS];  // Debugger state for each program
 
+  // Boot load (v7.9.9.9)
+  uint8_t boot_cached;        // Programs loaded from the bytecode cache without source
+  uint8_t boot_compiled;      // Programs compiled at boot (cache miss)
+  uint32_t boot_load_us;      // st_logic_load_from_nvs() duration
+
 } st_logic_engine_state_t;
 
 /* ============================================================================
@@ -120,19 +132,42 @@ void st_logic_init(st_logic_engine_state_t *state);
  * @param program_id Program ID (0-3)
  * @param source ST source code
  * @param source_size Size of source code
- * @return true if successful (false if pool full)
+ * @return true if successful (false if pool full or too large to save)
  */
 bool st_logic_upload(st_logic_engine_state_t *state, uint8_t program_id,
                       const char *source, uint32_t source_size);
 
+/**
+ * @brief Largest source the filesystem can save for a program right now
+ *
+ * A save writes the new /logic_N.dat beside the old one and renames it on
+ * commit, so the new copy must fit in the free space together with a
+ * rewrite of the program's .bc fallback and ST_LOGIC_FS_SLACK.
+ * @return Byte limit, ST_LOGIC_POOL_SIZE if the filesystem is not mounted
+ */
+uint32_t st_logic_fs_source_limit(uint8_t program_id);
+
 /**
  * @brief Get pointer to source code from pool
  * @param state Logic engine state
  * @param program_id Program ID (0-3)
- * @return Pointer to source code (NULL if not allocated)
+ * @return Pointer to source code (NULL if not allocated or still deferred)
+ *
+ * A program booted from the bytecode cache has no source in the pool until
+ * st_logic_deferred_source_loop() has read it (v7.9.9.9).
  */
 const char* st_logic_get_source_code(st_logic_engine_state_t *state, uint8_t program_id);
 
+/**
+ * @brief Read deferred sources into the pool (main loop task only)
+ *
+ * The pool is only changed from the loop task, never from the httpd task
+ * that reads sources. A failed read (pool full, short read) keeps the
+ * program deferred and is retried after ST_DEFERRED_RETRY_MS; a save in
+ * the meantime leaves its /logic_N.dat untouched.
+ */
+void st_logic_deferred_source_loop(st_logic_engine_state_t *state);
+
 /**
  * @brief Get pool usage statistics
  * @param state Logic engine state
@@ -151,6 +186,12 @@ void st_logic_get_pool_stats(st_logic_engine_state_t *state,
  */
 bool st_logic_compile(st_logic_engine_state_t *state, uint8_t program_id);
 
+/**
+ * @brief Use the cached bytecode (XIP slot or .bc file) for the uploaded source
+ * @return false on cache miss (caller compiles)
+ */
+bool st_logic_load_cached(st_logic_engine_state_t *state, uint8_t program_id);
+
 /**
  * @brief Set variable binding (ST variable ↔ Modbus register)
  *
@@ -11,11 +11,12 @@
  * - Compiler allocates instance IDs at compile-time
  * - VM passes instance pointer to builtin functions
  *
- * Memory Usage:
- * - Max 16 timer instances per program (TON/TOF/TP)
- * - Max 16 edge instances per program (R_TRIG/F_TRIG)
- * - Max 16 counter instances per program (CTU/CTD/CTUD)
- * - Total: ~1-2 KB per ST program
+ * Memory Usage (v7.9.9.0):
+ * - The ST_MAX_*_INSTANCES limits are compile-time pool caps (override
+ *   with -D build flags); storage is sized to the instances a program
+ *   actually uses, found by scanning its bytecode
+ * - Programs with TON/TOF/TP or BLINK also get a timer wheel
+ *   (st_timer_wheel.h, ~300 bytes) that tracks their deadlines
  */
 
 #ifndef ST_STATEFUL_H
@@ -23,15 +24,26 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "st_types.h"
+#include "st_timer_wheel.h"
 
 /* ============================================================================
  * CONFIGURATION CONSTANTS
  * ============================================================================ */
 
-#define ST_MAX_TIMER_INSTANCES   8    // Max TON/TOF/TP instances per program
-#define ST_MAX_EDGE_INSTANCES    8    // Max R_TRIG/F_TRIG instances per program
-#define ST_MAX_COUNTER_INSTANCES 8    // Max CTU/CTD/CTUD instances per program
-#define ST_MAX_LATCH_INSTANCES   8    // Max SR/RS latch instances per program
+// Pool caps per program (instance IDs are 8-bit, so at most 255 each)
+#ifndef ST_MAX_TIMER_INSTANCES
+#define ST_MAX_TIMER_INSTANCES   64   // Max TON/TOF/TP instances per program
+#endif
+#ifndef ST_MAX_EDGE_INSTANCES
+#define ST_MAX_EDGE_INSTANCES    32   // Max R_TRIG/F_TRIG instances per program
+#endif
+#ifndef ST_MAX_COUNTER_INSTANCES
+#define ST_MAX_COUNTER_INSTANCES 32   // Max CTU/CTD/CTUD instances per program
+#endif
+#ifndef ST_MAX_LATCH_INSTANCES
+#define ST_MAX_LATCH_INSTANCES   32   // Max SR/RS latch instances per program
+#endif
 
 /* ============================================================================
  * TIMER INSTANCE (TON/TOF/TP)
@@ -61,10 +73,11 @@ typedef struct {
   st_timer_type_t type;  // Timer type (TON/TOF/TP)
   bool last_IN;          // Previous input state
   uint32_t start_time;   // Timer start timestamp (millis)
-  uint32_t PT;           // Preset time (milliseconds)
+  uint32_t PT;           // Preset time the deadline was scheduled with (ms)
   bool Q;                // Output state (timer active)
-  uint32_t ET;           // Elapsed time (milliseconds)
+  uint32_t ET;           // Elapsed time when stopped (running: see st_timer_get_et)
   bool running;          // Timer currently running
+  uint16_t wheel_node;   // Deadline node in the storage's timer wheel
 } st_timer_instance_t;
 
 /* ============================================================================
@@ -181,9 +194,11 @@ typedef struct {
  * Tracks state machine state and timing.
  */
 typedef struct {
-  bool Q;           // Current output state
-  uint8_t state;    // State machine state (0=IDLE, 1=ON, 2=OFF)
-  uint32_t timer;   // Timestamp in milliseconds
+  bool Q;               // Current output state
+  uint8_t state;        // State machine state (0=IDLE, 1=ON, 2=OFF)
+  uint32_t timer;       // Start of the current phase (ms)
+  uint32_t period;      // Duration the current phase was scheduled with (ms)
+  uint16_t wheel_node;  // Deadline node in the storage's timer wheel
 } st_blink_instance_t;
 
 /**
@@ -196,57 +211,74 @@ typedef struct {
   float out_prev;  // Previous output value
 } st_filter_instance_t;
 
-#define ST_MAX_HYSTERESIS_INSTANCES 8  // Max HYSTERESIS instances per program
-#define ST_MAX_BLINK_INSTANCES      8  // Max BLINK instances per program
-#define ST_MAX_FILTER_INSTANCES     8  // Max FILTER instances per program
+#ifndef ST_MAX_HYSTERESIS_INSTANCES
+#define ST_MAX_HYSTERESIS_INSTANCES 32  // Max HYSTERESIS instances per program
+#endif
+#ifndef ST_MAX_BLINK_INSTANCES
+#define ST_MAX_BLINK_INSTANCES      64  // Max BLINK instances per program
+#endif
+#ifndef ST_MAX_FILTER_INSTANCES
+#define ST_MAX_FILTER_INSTANCES     32  // Max FILTER instances per program
+#endif
 
 /* ============================================================================
  * STATEFUL STORAGE CONTAINER
  * ============================================================================ */
 
+/**
+ * @brief Instances used by one program (pool sizes for st_stateful_create)
+ */
+typedef struct {
+  uint8_t timers;
+  uint8_t edges;
+  uint8_t counters;
+  uint8_t latches;
+  uint8_t hysteresis;
+  uint8_t blinks;
+  uint8_t filters;
+} st_stateful_counts_t;
+
 /**
  * @brief Complete stateful storage for one ST program
  *
  * Holds all stateful instances (timers, edges, counters, latches, signal) for a single
  * ST Logic program. Allocated per-program and persists across cycles.
  *
- * Memory: ~540 bytes per program (v4.8+ with signal processing)
- * - Timers: 8 × ~24 bytes = 192 bytes
- * - Edges: 8 × 8 bytes = 64 bytes
- * - Counters: 8 × ~20 bytes = 160 bytes
- * - Latches: 8 × 4 bytes = 32 bytes (v4.7.3)
- * - Hysteresis: 8 × 1 byte = 8 bytes (v4.8)
- * - Blink: 8 × 6 bytes = 48 bytes (v4.8)
- * - Filter: 8 × 4 bytes = 32 bytes (v4.8)
- * - Total: ~540 bytes
+ * v7.9.9.0: One allocation holds this header followed by the instance
+ * arrays, each sized to the program's instance count (see
+ * st_stateful_create), plus one wheel node per timer and BLINK instance.
  */
-typedef struct {
+typedef struct st_stateful_storage {
   // Timer instances (TON/TOF/TP)
-  st_timer_instance_t timers[ST_MAX_TIMER_INSTANCES];
+  st_timer_instance_t* timers;
   uint8_t timer_count;  // Number of allocated timer instances
 
   // Edge detector instances (R_TRIG/F_TRIG)
-  st_edge_instance_t edges[ST_MAX_EDGE_INSTANCES];
+  st_edge_instance_t* edges;
   uint8_t edge_count;   // Number of allocated edge instances
 
   // Counter instances (CTU/CTD/CTUD)
-  st_counter_instance_t counters[ST_MAX_COUNTER_INSTANCES];
+  st_counter_instance_t* counters;
   uint8_t counter_count;  // Number of allocated counter instances
 
   // Latch instances (SR/RS) - v4.7.3
-  st_latch_instance_t latches[ST_MAX_LATCH_INSTANCES];
+  st_latch_instance_t* latches;
   uint8_t latch_count;  // Number of allocated latch instances
 
   // Signal processing instances - v4.8
-  st_hysteresis_instance_t hysteresis[ST_MAX_HYSTERESIS_INSTANCES];
+  st_hysteresis_instance_t* hysteresis;
   uint8_t hysteresis_count;
 
-  st_blink_instance_t blinks[ST_MAX_BLINK_INSTANCES];
+  st_blink_instance_t* blinks;
   uint8_t blink_count;
 
-  st_filter_instance_t filters[ST_MAX_FILTER_INSTANCES];
+  st_filter_instance_t* filters;
   uint8_t filter_count;
 
+  // Deadlines of running TON/TOF/TP and BLINK instances (v7.9.9.0)
+  st_timer_wheel_t wheel;
+  st_wheel_node_t* wheel_nodes;
+
   // Execution cycle time (v4.8.1 - BUG-153 fix)
   uint32_t cycle_time_ms;  // Actual execution interval from engine state
 
@@ -259,63 +291,73 @@ typedef struct {
  * ============================================================================ */
 
 /**
- * @brief Initialize stateful storage
+ * @brief Count the stateful instances a compiled program uses
  *
- * Clears all instances and resets counters to zero.
- * Must be called once when program is loaded.
+ * Scans CALL_BUILTIN instructions for the highest instance ID of each
+ * kind, so it works for freshly compiled and for cached bytecode alike.
  *
- * @param storage Pointer to storage structure
+ * @param instructions Bytecode
+ * @param instr_count Number of instructions
+ * @param out Instance counts
+ * @return true if the program uses any stateful instance
  */
-void st_stateful_init(st_stateful_storage_t* storage);
+bool st_stateful_scan(const st_bytecode_instr_t* instructions, uint16_t instr_count,
+                      st_stateful_counts_t* out);
 
 /**
- * @brief Reset all stateful instances
+ * @brief Allocate storage sized for the given instance counts
  *
- * Resets all timers, edges, and counters to initial state.
- * Used when program is stopped or reloaded.
+ * All instances start reset; the timer wheel starts empty.
  *
- * @param storage Pointer to storage structure
+ * @param counts Instances per kind
+ * @return Storage (free with st_stateful_destroy), or NULL if out of memory
  */
-void st_stateful_reset(st_stateful_storage_t* storage);
+st_stateful_storage_t* st_stateful_create(const st_stateful_counts_t* counts);
 
 /**
- * @brief Allocate a new timer instance
- *
- * Returns pointer to next available timer slot, or NULL if full.
+ * @brief Allocate storage for a compiled program (scan + create)
  *
- * @param storage Pointer to storage structure
- * @param type Timer type (TON/TOF/TP)
- * @return Pointer to allocated timer instance, or NULL if no slots available
+ * @param instructions Bytecode
+ * @param instr_count Number of instructions
+ * @return Storage, or NULL if the program has no stateful instances or
+ *         memory ran out (*out_of_memory tells which, may be NULL)
+ */
+st_stateful_storage_t* st_stateful_create_for(const st_bytecode_instr_t* instructions,
+                                              uint16_t instr_count, bool* out_of_memory);
+
+/**
+ * @brief Free storage from st_stateful_create (NULL is ignored)
  */
-st_timer_instance_t* st_stateful_alloc_timer(st_stateful_storage_t* storage, st_timer_type_t type);
+void st_stateful_destroy(st_stateful_storage_t* storage);
 
 /**
- * @brief Allocate a new edge detector instance
+ * @brief Start an execution cycle
  *
- * Returns pointer to next available edge slot, or NULL if full.
+ * Sets the cycle time and advances the timer wheel to now_ms, so every
+ * timer in this cycle sees the same timestamp and expired deadlines are
+ * marked before the program runs.
  *
  * @param storage Pointer to storage structure
- * @param type Edge type (rising/falling)
- * @return Pointer to allocated edge instance, or NULL if no slots available
+ * @param now_ms Cycle timestamp (millis)
+ * @param cycle_time_ms Execution interval
  */
-st_edge_instance_t* st_stateful_alloc_edge(st_stateful_storage_t* storage, st_edge_type_t type);
+void st_stateful_begin_cycle(st_stateful_storage_t* storage, uint32_t now_ms, uint32_t cycle_time_ms);
 
 /**
- * @brief Allocate a new counter instance
+ * @brief Reset all stateful instances
  *
- * Returns pointer to next available counter slot, or NULL if full.
+ * Resets all timers, edges, and counters to initial state.
+ * Used when program is stopped or reloaded.
  *
  * @param storage Pointer to storage structure
- * @param type Counter type (CTU/CTD/CTUD)
- * @return Pointer to allocated counter instance, or NULL if no slots available
  */
-st_counter_instance_t* st_stateful_alloc_counter(st_stateful_storage_t* storage, st_counter_type_t type);
+void st_stateful_reset(st_stateful_storage_t* storage);
 
 /**
  * @brief Get timer instance by ID
  *
  * @param storage Pointer to storage structure
- * @param instance_id Timer instance ID (0-15)
+ * @param instance_id Timer instance ID
  * @return Pointer to timer instance, or NULL if invalid ID
  */
 st_timer_instance_t* st_stateful_get_timer(st_stateful_storage_t* storage, uint8_t instance_id);
@@ -324,7 +366,7 @@ st_timer_instance_t* st_stateful_get_timer(st_stateful_storage_t* storage, uint8
  * @brief Get edge instance by ID
  *
  * @param storage Pointer to storage structure
- * @param instance_id Edge instance ID (0-15)
+ * @param instance_id Edge instance ID
  * @return Pointer to edge instance, or NULL if invalid ID
  */
 st_edge_instance_t* st_stateful_get_edge(st_stateful_storage_t* storage, uint8_t instance_id);
@@ -333,78 +375,43 @@ st_edge_instance_t* st_stateful_get_edge(st_stateful_storage_t* storage, uint8_t
  * @brief Get counter instance by ID
  *
  * @param storage Pointer to storage structure
- * @param instance_id Counter instance ID (0-15)
+ * @param instance_id Counter instance ID
  * @return Pointer to counter instance, or NULL if invalid ID
  */
 st_counter_instance_t* st_stateful_get_counter(st_stateful_storage_t* storage, uint8_t instance_id);
 
-/**
- * @brief Allocate a new latch instance
- *
- * Returns pointer to next available latch slot, or NULL if full.
- *
- * @param storage Pointer to storage structure
- * @param type Latch type (SR or RS)
- * @return Pointer to allocated latch instance, or NULL if no slots available
- */
-st_latch_instance_t* st_stateful_alloc_latch(st_stateful_storage_t* storage, st_latch_type_t type);
-
 /**
  * @brief Get latch instance by ID
  *
  * @param storage Pointer to storage structure
- * @param instance_id Latch instance ID (0-7)
+ * @param instance_id Latch instance ID
  * @return Pointer to latch instance, or NULL if invalid ID
  */
 st_latch_instance_t* st_stateful_get_latch(st_stateful_storage_t* storage, uint8_t instance_id);
 
-/**
- * @brief Allocate a new hysteresis instance (v4.8)
- *
- * @param storage Pointer to storage structure
- * @return Pointer to allocated hysteresis instance, or NULL if no slots available
- */
-st_hysteresis_instance_t* st_stateful_alloc_hysteresis(st_stateful_storage_t* storage);
-
 /**
  * @brief Get hysteresis instance by ID (v4.8)
  *
  * @param storage Pointer to storage structure
- * @param instance_id Hysteresis instance ID (0-7)
+ * @param instance_id Hysteresis instance ID
  * @return Pointer to hysteresis instance, or NULL if invalid ID
  */
 st_hysteresis_instance_t* st_stateful_get_hysteresis(st_stateful_storage_t* storage, uint8_t instance_id);
 
-/**
- * @brief Allocate a new blink instance (v4.8)
- *
- * @param storage Pointer to storage structure
- * @return Pointer to allocated blink instance, or NULL if no slots available
- */
-st_blink_instance_t* st_stateful_alloc_blink(st_stateful_storage_t* storage);
-
 /**
  * @brief Get blink instance by ID (v4.8)
  *
  * @param storage Pointer to storage structure
- * @param instance_id Blink instance ID (0-7)
+ * @param instance_id Blink instance ID
  * @return Pointer to blink instance, or NULL if invalid ID
  */
 st_blink_instance_t* st_stateful_get_blink(st_stateful_storage_t* storage, uint8_t instance_id);
 
-/**
- * @brief Allocate a new filter instance (v4.8)
- *
- * @param storage Pointer to storage structure
- * @return Pointer to allocated filter instance, or NULL if no slots available
- */
-st_filter_instance_t* st_stateful_alloc_filter(st_stateful_storage_t* storage);
-
 /**
  * @brief Get filter instance by ID (v4.8)
  *
  * @param storage Pointer to storage structure
- * @param instance_id Filter instance ID (0-7)
+ * @param instance_id Filter instance ID
  * @return Pointer to filter instance, or NULL if invalid ID
  */
 st_filter_instance_t* st_stateful_get_filter(st_stateful_storage_t* storage, uint8_t instance_id);
@@ -0,0 +1,89 @@
+/**
+ * @file st_timer_wheel.h
+ * @brief Hierarchical timer wheel for ST timer deadlines (v7.9.9.0)
+ *
+ * LAYER 5: Feature Engines - ST Logic (pure logic)
+ * Each ST program's stateful storage owns one wheel. TON/TOF/TP and BLINK
+ * instances schedule their deadline on a node when they start timing; once
+ * per cycle st_wheel_advance() moves the wheel to the cycle timestamp and
+ * marks the nodes that expired. A running timer then only checks its node
+ * state instead of comparing millis() every call, and advancing costs only
+ * the nodes that actually expire (plus an occasional cascade).
+ *
+ * Layout: 8 levels of 16 slots, 1 ms per level-0 slot; level n slots span
+ * 16^n ms, so the whole 32-bit millisecond range is covered. Empty levels
+ * are skipped, so a long gap between cycles is not stepped tick by tick.
+ *
+ * Nodes live in a caller-owned table and are linked by index, so the wheel
+ * is relocatable and costs 2 bytes per slot.
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/st_timer_wheel_test.cpp.
+ */
+
+#ifndef ST_TIMER_WHEEL_H
+#define ST_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ST_WHEEL_BITS     4
+#define ST_WHEEL_SLOTS    (1 << ST_WHEEL_BITS)      // Slots per level
+#define ST_WHEEL_LEVELS   8                         // 8 × 4 bits = 32-bit ms range
+#define ST_WHEEL_NONE     0xFFFF                    // End of slot list
+
+/* Node state */
+typedef enum {
+  ST_WHEEL_IDLE = 0,        // Not scheduled
+  ST_WHEEL_PENDING = 1,     // Linked, waiting for its deadline
+  ST_WHEEL_FIRED = 2        // Deadline reached, not yet taken by the owner
+} st_wheel_state_t;
+
+typedef struct {
+  uint32_t expires;         // Absolute deadline (ms, wraps with millis())
+  uint16_t next;            // Slot list links (node index)
+  uint16_t prev;
+  uint8_t  slot;            // level * ST_WHEEL_SLOTS + index while pending
+  uint8_t  state;           // st_wheel_state_t
+} st_wheel_node_t;
+
+typedef struct {
+  st_wheel_node_t *nodes;                               // Node table (caller-owned)
+  uint16_t node_count;
+  uint16_t pending;                                     // Nodes linked in the wheel
+  uint16_t level_pending[ST_WHEEL_LEVELS];              // Linked nodes per level
+  uint16_t head[ST_WHEEL_LEVELS * ST_WHEEL_SLOTS];      // First node per slot
+  uint32_t now;                                         // Last processed tick (ms)
+  uint32_t fired_total;                                 // Deadlines reached since init
+} st_timer_wheel_t;
+
+/**
+ * @brief Initialize an empty wheel over a node table (all nodes idle)
+ */
+void st_wheel_init(st_timer_wheel_t *w, st_wheel_node_t *nodes, uint16_t node_count,
+                   uint32_t now_ms);
+
+/**
+ * @brief Schedule (or reschedule) a node; a deadline at or before the
+ * current tick fires immediately
+ */
+void st_wheel_schedule(st_timer_wheel_t *w, uint16_t id, uint32_t expires);
+
+/**
+ * @brief Unschedule a node (pending or fired) — it becomes idle
+ */
+void st_wheel_cancel(st_timer_wheel_t *w, uint16_t id);
+
+/**
+ * @brief Advance the wheel to now_ms, firing every deadline passed
+ * @return Nodes fired in this call
+ */
+uint16_t st_wheel_advance(st_timer_wheel_t *w, uint32_t now_ms);
+
+/**
+ * @brief Consume a fired node (it becomes idle)
+ * @return true if the node had fired
+ */
+bool st_wheel_take_fired(st_timer_wheel_t *w, uint16_t id);
+
+#endif // ST_TIMER_WHEEL_H
@@ -562,7 +562,7 @@ typedef struct {
     uint16_t var_index;     // For LOAD_VAR, STORE_VAR
     struct {                // For CALL_BUILTIN with stateful functions
       uint8_t func_id_low;  // Lower byte of function ID
-      uint8_t instance_id;  // Instance storage index (0-7)
+      uint8_t instance_id;  // Instance storage index (< ST_MAX_*_INSTANCES)
       uint16_t padding;     // Padding to 4 bytes
     } builtin_call;
     struct {                // FEAT-003: For CALL_USER with instance tracking
@@ -578,7 +578,7 @@ typedef struct {
     } array_op;
     struct {                // FEAT-122: FB field access (timer/counter instance fields)
       uint8_t fb_type;      // 0=timer, 1=counter
-      uint8_t instance_id;  // Instance index (0-7)
+      uint8_t instance_id;  // Instance index (< ST_MAX_*_INSTANCES)
       uint8_t field_id;     // Field: timer(0=Q,1=ET), counter(0=Q/QU,1=QD,2=CV)
       uint8_t padding;
     } fb_field;
@@ -593,6 +593,7 @@ typedef struct {
   st_bytecode_instr_t *instructions;      // Dynamically allocated (exact instr_count size)
   uint16_t instr_count;
   uint16_t instr_capacity;                // Allocated size (== instr_count after compile)
+  uint8_t instr_in_flash;                 // 1 = instructions point into the mapped XIP partition (v7.9.9.8, never free)
 
   // Variable memory
   st_value_t variables[32];        // Max 32 variables (runtime values)
@@ -0,0 +1,118 @@
+/**
+ * @file st_xip_image.h
+ * @brief Execute-in-place bytecode images (v7.9.9.8)
+ *
+ * LAYER 5: ST Logic - Flash image format (pure, no ESP-IDF)
+ * Responsibility: serialize a compiled program into a position-independent
+ * image that the VM can run directly from memory-mapped flash, validate a
+ * mapped image and attach it to an st_bytecode_program_t.
+ *
+ * Layout (little endian, all references are offsets from the image start):
+ *   header      st_xip_header_t
+ *   instructions  instr_count * sizeof(st_bytecode_instr_t), 8-byte aligned
+ *   variables   names[n][16] | types u8[n] | export flags u8[n] |
+ *               initial st_value_t[n] (4-byte aligned)
+ *   functions   func_count * sizeof(st_function_entry_t) (4-byte aligned)
+ *
+ * Attaching points bytecode->instructions into the image (no copy); the
+ * small variable table is copied because the VM, CLI and compiler use the
+ * fixed arrays of st_bytecode_program_t, and the function registry is
+ * copied because it also holds FUNCTION_BLOCK instance state.
+ *
+ * Images are written to an erased slot body first and header last, so a
+ * power cut leaves either the old erased header (0xFF, no image) or a
+ * complete image. The image CRC catches anything else.
+ *
+ * Flash access goes through StxFlashOps (esp_partition on the device, the
+ * file-backed NOR emulator in tests/host/st_xip_image_test.cpp).
+ */
+
+#ifndef ST_XIP_IMAGE_H
+#define ST_XIP_IMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "st_types.h"
+
+#define ST_XIP_MAGIC        0x49585453u   // "STXI"
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;             // ST_XIP_MAGIC
+  uint16_t version;           // ST_BYTECODE_VERSION of the compiler
+  uint16_t header_size;       // sizeof(st_xip_header_t)
+  uint32_t image_size;        // Header + payload
+  uint32_t image_crc32;       // CRC32 of the payload (everything after the header)
+  uint32_t source_crc32;      // CRC32 of the source code (invalidation key)
+  uint16_t instr_count;
+  uint8_t  instr_size;        // sizeof(st_bytecode_instr_t) of the writer
+  uint8_t  func_entry_size;   // sizeof(st_function_entry_t) of the writer
+  uint8_t  var_count;
+  uint8_t  exported_var_count;
+  uint8_t  func_user_count;   // Registry present if user + builtin > 0
+  uint8_t  func_builtin_count;
+  uint32_t instr_offset;
+  uint32_t vars_offset;
+  uint32_t funcs_offset;
+  char     name[32];
+} st_xip_header_t;
+
+typedef enum {
+  ST_XIP_OK = 0,
+  ST_XIP_EMPTY,               // Erased slot / no image
+  ST_XIP_VERSION,             // Other compiler or struct layout: recompile
+  ST_XIP_SOURCE,              // Source changed: recompile
+  ST_XIP_CORRUPT              // Bad sizes or CRC
+} st_xip_result_t;
+
+typedef struct {
+  void *ctx;
+  uint32_t sector_size;
+  bool (*write)(void *ctx, uint32_t addr, const void *buf, uint32_t len);
+  bool (*erase)(void *ctx, uint32_t addr);  // One sector
+} StxFlashOps;
+
+/**
+ * @brief Size of the image for a compiled program
+ */
+uint32_t st_xip_image_size(const st_bytecode_program_t *bc);
+
+/**
+ * @brief Serialize a compiled program
+ * @return Image size, 0 if it does not fit in cap
+ */
+uint32_t st_xip_build(const st_bytecode_program_t *bc, uint32_t source_crc32,
+                      uint8_t *out, uint32_t cap);
+
+/**
+ * @brief Validate an image in (mapped) memory
+ * @param avail Bytes readable at img (slot size)
+ */
+st_xip_result_t st_xip_check(const uint8_t *img, uint32_t avail, uint32_t source_crc32);
+
+/**
+ * @brief Attach a checked image: instructions run from img, tables copied
+ * @param reg Registry to fill (NULL if the image has no functions)
+ *
+ * Sets bc->instr_in_flash; the caller must not free bc->instructions.
+ */
+void st_xip_attach(const uint8_t *img, st_bytecode_program_t *bc, st_function_registry_t *reg);
+
+/**
+ * @brief Number of registry entries in a checked image
+ */
+uint8_t st_xip_func_count(const uint8_t *img);
+
+/**
+ * @brief Erase a slot and write an image into it (header last)
+ */
+bool st_xip_write(const StxFlashOps *ops, uint32_t slot_addr, uint32_t slot_size,
+                  const uint8_t *img, uint32_t len);
+
+const char *st_xip_result_name(st_xip_result_t r);
+
+/**
+ * @brief Calculate CRC32 of data (standard polynomial 0xEDB88320)
+ */
+uint32_t st_crc32(const uint8_t *data, uint32_t len);
+
+#endif // ST_XIP_IMAGE_H
@@ -15,11 +15,13 @@
  * - Coil write callbacks (triggers monostable/astable)
  * - Alarm/timeout detection
  *
- * TIMING MODEL:
- * - Uses millis() for timing (same as Mega)
- * - Each timer tracks: phase, phase_start_ms, active flag
- * - Timeout = 5× (T1+T2+T3) for safety
- * - Alarm flag set on timeout
+ * TIMING MODEL (v7.9.8.9):
+ * - Durations in ms or µs (TimerConfig.time_base)
+ * - Phase deadlines run on a per-timer esp_timer (timer_sched.h); the
+ *   callback sets the output coil and a GPIO-mapped output pin directly
+ * - Deadlines advance by the phase duration, so loop and callback latency
+ *   do not accumulate (astable period is exact on average)
+ * - The loop handles control registers, Mode 4 input edges and idle levels
  *
  * Context: This is the "glue" between timers and Modbus coils
  */
@@ -68,6 +70,14 @@ void timer_engine_on_coil_write(uint16_t coil_idx, uint8_t value);
  */
 bool timer_engine_has_coil(uint16_t coil_idx);
 
+/**
+ * @brief GPIO pins (0-39) currently driven by a timer's deadline callback
+ * gpio_mapping leaves these pins out of its port write so it never writes a
+ * stale coil level over an edge the timer callback just set.
+ * @return Bit n set if the timer engine writes GPIO n itself
+ */
+uint64_t timer_engine_owned_pin_mask(void);
+
 /**
  * @brief Disable all timers
  */
@@ -95,5 +105,12 @@ bool timer_engine_get_config(uint8_t id, TimerConfig* out);
  */
 bool timer_engine_get_runtime(uint8_t id, uint8_t* out_phase, uint8_t* out_active);
 
+/**
+ * @brief Times an astable timer fell more than one period behind and
+ * skipped the missed cycles
+ * @param id Timer ID (1-4)
+ */
+uint32_t timer_engine_get_late_resyncs(uint8_t id);
+
 #endif // TIMER_ENGINE_H
 
@@ -0,0 +1,60 @@
+/**
+ * @file timer_sched.h
+ * @brief Deadline-based phase sequencer for timer outputs (v7.9.8.9)
+ *
+ * LAYER 5: Feature Engines - Timer scheduling (pure logic)
+ * timer_engine turns a TimerConfig into a TimerSchedPlan (up to 3 phases,
+ * each with an output level and a duration in µs) and calls
+ * timer_sched_expire() from an esp_timer callback at the phase deadline.
+ *
+ * Deadlines are absolute and advance by the phase duration, not from the
+ * time the callback actually ran, so callback latency never accumulates:
+ * an astable output keeps its period exactly on average and each edge is
+ * late by at most one callback latency.
+ *
+ * Pure C, no ESP-IDF dependencies — tested on the host by
+ * tests/host/timer_sched_test.cpp.
+ */
+
+#ifndef TIMER_SCHED_H
+#define TIMER_SCHED_H
+
+#include <stdint.h>
+
+#define TIMER_SCHED_MAX_PHASES  3
+#define TIMER_SCHED_LEAVE       0xFF    // Level: leave output unchanged
+
+typedef struct {
+  uint8_t  phases;                             // Phases used (1-3)
+  uint8_t  repeat;                             // Restart at phase 0 after the last (astable)
+  uint8_t  level[TIMER_SCHED_MAX_PHASES];      // Output level during each phase
+  uint8_t  end_level;                          // Output after the last phase
+  uint64_t dur_us[TIMER_SCHED_MAX_PHASES];     // Phase durations (0 = skip)
+} TimerSchedPlan;
+
+typedef struct {
+  int64_t  deadline_us;   // End of the current phase
+  uint8_t  phase;         // Current phase (phases = finished)
+  uint8_t  running;       // Waiting for deadline_us
+  uint8_t  level;         // Output level to drive (TIMER_SCHED_LEAVE = none yet)
+  uint32_t late_resyncs;  // Times the schedule fell a whole period behind
+} TimerSchedState;
+
+/**
+ * @brief Start the sequence at phase 0 (zero-duration phases are passed)
+ * @return Phases advanced past phase 0
+ */
+uint8_t timer_sched_start(const TimerSchedPlan *plan, TimerSchedState *s, int64_t now_us);
+
+/**
+ * @brief Advance every phase whose deadline has passed
+ * @return Phases advanced (0 = deadline not reached yet)
+ */
+uint8_t timer_sched_expire(const TimerSchedPlan *plan, TimerSchedState *s, int64_t now_us);
+
+/**
+ * @brief Stop without touching the output level
+ */
+void timer_sched_stop(TimerSchedState *s);
+
+#endif // TIMER_SCHED_H
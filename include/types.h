@@ -101,10 +101,23 @@ typedef struct __attribute__((packed)) {
 
   // Note: Compare status stored in ctrl_reg bit 4 (no separate fields needed)
 
-  // Reserved for alignment
-  uint8_t reserved[1];
+  // FEAT-154: Frequency method (CounterFreqMode, 0 = gate). Was reserved[1],
+  // so existing configs load as gate mode.
+  uint8_t freq_mode;
 } CounterConfig;
 
+/* Quadrature encoder extension of CounterConfig (v7.9.8.8, FEAT-157).
+ * Separate struct because CounterConfig has no reserved bytes left. PCNT
+ * mode only: hw_gpio is channel A, gpio_b is channel B. */
+typedef struct __attribute__((packed)) {
+  uint8_t mode;                 // CounterQuadMode (0 = off)
+  uint8_t gpio_b;               // GPIO for channel B
+  uint16_t glitch_ns;           // PCNT glitch filter (0 = off, max 12787)
+  uint16_t velocity_reg;        // Velocity counts/s, int32 in 2 words LSW first (0xFFFF = none)
+  uint16_t velocity_filter_ms;  // Low-pass time constant (0 = unfiltered)
+  uint16_t velocity_sample_ms;  // Velocity sample interval
+} CounterQuadConfig;
+
 typedef struct {
   uint64_t counter_value;      // Changed from uint32_t to match usage
   uint32_t last_level;
@@ -168,8 +181,12 @@ typedef struct __attribute__((packed)) {
   // Control register (Modbus holding register for start/stop/reset)
   uint16_t ctrl_reg;
 
+  // v7.9.8.9: Unit of all *_ms duration fields (TimerTimeBase). Was
+  // reserved[0], so existing configs load as milliseconds.
+  uint8_t time_base;
+
   // Reserved for alignment
-  uint8_t reserved[6];
+  uint8_t reserved[5];
 } TimerConfig;
 
 typedef struct {
@@ -281,7 +298,8 @@ typedef struct __attribute__((packed)) {
   uint32_t last_reset_reason;        // ESP_RST_REASON enum
   char last_error[128];              // Last error message
   uint32_t last_reboot_uptime_ms;    // Uptime before last reboot
-  uint8_t reserved[8];
+  uint32_t boot_ready_us;            // Time to Modbus ready, last boot that got there (v7.9.10.0)
+  uint8_t reserved[4];
 } WatchdogState;
 
 /* ============================================================================
@@ -470,6 +488,35 @@ typedef struct __attribute__((packed)) {
   uint16_t sync_interval_min;            // Re-sync interval in minutes (default: 60)
 } NtpConfig;                             // 100 bytes
 
+/* ============================================================================
+ * HISTORIAN (v7.9.10.4)
+ * ============================================================================ */
+
+#define HIST_MAX_POINTS       8     // Sampled points
+#define HIST_MIN_INTERVAL_MS  100
+#define HIST_MAX_INTERVAL_MS  3600000UL
+
+typedef enum {
+  HIST_SRC_OFF = 0,
+  HIST_SRC_HR,                       // Holding register
+  HIST_SRC_IR,                       // Input register
+  HIST_SRC_COUNTER                   // Counter value (address = counter id 1-4)
+} HistSource;
+
+typedef struct __attribute__((packed)) {
+  uint8_t  source;                   // HistSource
+  uint8_t  reserved;
+  uint16_t address;                  // Register address or counter id
+  uint32_t interval_ms;              // Raw sample interval (100 ms - 1 h)
+} HistPointConfig;                   // 8 bytes
+
+typedef struct __attribute__((packed)) {
+  uint8_t  enabled;                  // Sampling on (1) / off (0)
+  uint8_t  spill_kb;                 // LittleFS budget for raw spill (0 = RAM only)
+  uint16_t reserved;
+  HistPointConfig points[HIST_MAX_POINTS];
+} HistorianConfig;                   // 68 bytes
+
 /* ============================================================================
  * PERSISTENT CONFIGURATION (EEPROM/NVS)
  * ============================================================================ */
@@ -563,6 +610,19 @@ typedef struct __attribute__((packed)) {
   char dashboard_card_tabs[256];   // "id:tab,id:tab,..." e.g. "system:overview,counters:app"
   char dashboard_card_hidden[80];  // "id,id,..." hidden card IDs
 
+  // Counter quadrature mode per counter (v7.9.8.8, schema 20)
+  CounterQuadConfig counter_quad[COUNTER_COUNT];
+
+  // Digital inputs in interrupt mode (v7.9.9.4, schema 21): bit n = GPIO n
+  // input mappings are updated from a pin-change ISR instead of polling
+  uint64_t gpio_irq_pins;
+
+  // Historian sample points (v7.9.10.4, persist section)
+  HistorianConfig historian;
+
+  // New fields go here AND at the end of their section in
+  // config_sections.cpp (v7.9.9.7: stored per section, see config_sections.h)
+
   // CRC checksum (last)
   uint16_t crc16;
 } PersistConfig;
@@ -0,0 +1,80 @@
+/**
+ * @file warm_retain.h
+ * @brief Warm-restart retention of runtime state (v7.9.10.2)
+ *
+ * LAYER 4: Register Persistence - Warm restart retention
+ * Responsibility: mirror the live runtime state into no-init RAM and put
+ * it back after a software, OTA, panic or watchdog reset, before the
+ * Modbus slave starts serving - without a flash read or write.
+ *
+ * Retained: holding/input registers, coils, counter values 1-4, ST
+ * program variables, ST edge/counter/latch/hysteresis/filter instances
+ * and FUNCTION_BLOCK instance locals. Not retained: TON/TOF/TP timers and
+ * BLINK, since their millis() base does not survive the reset (they
+ * restart idle, as after a cold start).
+ *
+ * ST state is only restored into a program with the same variables and
+ * instance counts as the one that wrote it; a recompiled program with
+ * other variables starts from its initial values. Power-on and brownout
+ * clear the area, so NVS persistence (registers_persist) stays the source
+ * for cold starts.
+ *
+ * Crash-loop guard: if the retained state itself makes the firmware panic
+ * or hit a watchdog, restoring it again would repeat the crash forever.
+ * After WARM_RETAIN_CRASH_MAX panic/WDT resets in a row, each followed by
+ * a restore and none lasting WARM_RETAIN_STABLE_MS, the snapshot is
+ * dropped and the boot starts from NVS like a cold start.
+ */
+
+#ifndef WARM_RETAIN_H
+#define WARM_RETAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WARM_RETAIN_AREA_SIZE     8192    // No-init DRAM, two snapshot slots
+#define WARM_RETAIN_INTERVAL_MS   100     // Snapshot period from loop()
+#define WARM_RETAIN_CRASH_MAX     3       // Panic/WDT restores in a row before skipping
+#define WARM_RETAIN_STABLE_MS     60000   // Uptime that ends a crash streak
+
+typedef struct {
+  bool     warm;              // Reset kind keeps RAM (SW/OTA/panic/WDT)
+  bool     restored;          // A valid snapshot was applied this boot
+  uint8_t  programs;          // ST programs restored
+  uint8_t  programs_skipped;  // ST programs changed since the snapshot
+  uint32_t restore_us;        // Time to validate and apply the snapshot
+  uint32_t restore_bytes;     // Snapshot size applied
+  uint32_t snapshot_seq;      // Sequence number of the applied snapshot
+  uint8_t  crash_streak;      // Panic/WDT restores in a row, incl. this boot
+  bool     crash_skipped;     // Restore skipped: crash loop (WARM_RETAIN_CRASH_MAX)
+  // Writer
+  uint32_t snapshots;         // Snapshots written this boot
+  uint32_t snapshot_bytes;    // Size of the last snapshot
+  uint32_t snapshot_us;       // Time of the last snapshot
+  uint32_t snapshot_max_us;
+  uint32_t dropped;           // Sections that did not fit (last snapshot)
+} WarmRetainStats;
+
+/**
+ * @brief Restore the last snapshot after a warm reset, clear it after a cold one
+ *
+ * Call at the end of setup(), after ST programs are loaded and NVS register
+ * groups are applied (RAM state is newer than NVS), before loop() serves
+ * Modbus. Starts the snapshot writer.
+ * @return true if state was restored
+ */
+bool warm_retain_restore(void);
+
+/**
+ * @brief Write a snapshot every WARM_RETAIN_INTERVAL_MS (call from loop() after the ST cycle)
+ */
+void warm_retain_loop(void);
+
+/**
+ * @brief Write a snapshot now (main loop task only, e.g. right before esp_restart())
+ */
+void warm_retain_snapshot(void);
+
+const WarmRetainStats *warm_retain_get_stats(void);
+
+#endif // WARM_RETAIN_H
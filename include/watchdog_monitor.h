@@ -128,4 +128,12 @@ bool watchdog_load_state(void);
  */
 void watchdog_record_error(const char* error_msg);
 
+/**
+ * @brief Record the time to ready of this boot (boot_trace ready milestone)
+ * @param ready_us micros() when the Modbus slave started serving
+ *
+ * Stored in the NVS record, so it is kept across power-on resets too.
+ */
+void watchdog_record_boot_ready(uint32_t ready_us);
+
 #endif // WATCHDOG_MONITOR_H
@@ -0,0 +1,47 @@
+/**
+ * @file web_assets.h
+ * @brief Precompressed web pages served from flash (v7.9.8.1)
+ *
+ * The HTML pages embedded in web_*.cpp are gzipped at build time by
+ * scripts/generate_web_assets.py into src/web_assets_gz.cpp. Each asset
+ * carries its gzip length and a strong ETag (content hash), so pages are
+ * served without strlen() and revalidated with 304 Not Modified.
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_http_server.h>
+
+typedef struct {
+  const uint8_t *gz_data;   // gzip stream in flash
+  size_t         gz_len;    // gzip length (bytes)
+  size_t         raw_len;   // uncompressed length (informational)
+  const char    *etag;      // Strong ETag incl. quotes, e.g. "\"3f9a...\""
+} WebAsset;
+
+// Generated in src/web_assets_gz.cpp
+extern const WebAsset web_asset_dashboard;
+extern const WebAsset web_asset_editor;
+extern const WebAsset web_asset_system;
+extern const WebAsset web_asset_cli;
+extern const WebAsset web_asset_ota;
+
+/**
+ * Send a precompressed HTML page with Content-Encoding: gzip and ETag.
+ * Replies 304 if If-None-Match matches, 406 if the client explicitly
+ * refuses gzip.
+ */
+esp_err_t web_asset_send(httpd_req_t *req, const WebAsset *asset);
+
+/**
+ * Look for token (substring) in a request header; also used by the API
+ * for Accept/Content-Type selection.
+ * Returns 1 if found, 0 if the header is present without it,
+ * -1 if the header is absent or too long (>= 160 bytes) to inspect.
+ */
+int web_asset_header_match(httpd_req_t *req, const char *field, const char *token);
+
+#endif // WEB_ASSETS_H
@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""
+Convert binary config backups to JSON and back (v7.9.10.1)
+
+The device writes the binary format (include/backup_format.h) on
+GET /api/system/backup with "Accept: application/octet-stream" and reads it
+on POST /api/system/restore with "Content-Type: application/octet-stream".
+This tool makes such a backup readable and editable:
+
+    backup_tool.py to-json   backup.mbk  [-o backup.json]
+    backup_tool.py from-json backup.json [-o backup.mbk]
+    backup_tool.py info      backup.mbk
+
+Config sections stay raw bytes (hex), since their layout is PersistConfig
+of the firmware that wrote them; ST sources are plain text, bytecode
+images base64. Records of unknown type are kept as they are, so a
+to-json/from-json round trip reproduces the file byte for byte.
+"""
+
+import argparse
+import base64
+import json
+import struct
+import sys
+import zlib
+
+MAGIC = 0x504B424D          # "MBKP"
+FORMAT_VERSION = 1
+FLAG_SOURCES = 0x0001
+FLAG_BYTECODE = 0x0002
+
+REC_INFO = 1
+REC_SECTION = 2
+REC_PROGRAM = 3
+REC_BYTECODE = 4
+REC_END = 0xFF
+
+FILE_HDR = struct.Struct("<IHH")          # magic, format, flags
+REC_HDR = struct.Struct("<BBBBI")         # type, id, version, reserved, len
+INFO = struct.Struct("<16sIHH")           # firmware, build, schema_version, config_size
+PROGRAM_HDR = struct.Struct("<B32s")      # enabled, name
+END = struct.Struct("<II")                # records, header_crc
+
+# cs_sections[] order in src/config_sections.cpp
+SECTION_NAMES = ["network", "modbus", "counters", "mappings",
+                 "persist", "rbac", "ui", "system"]
+
+
+class BackupError(Exception):
+    pass
+
+
+def cstr(raw):
+    return raw.split(b"\0", 1)[0].decode("utf-8", "replace")
+
+
+# ---------------------------------------------------------------------------
+# Binary -> dict
+# ---------------------------------------------------------------------------
+
+def parse(data):
+    if len(data) < FILE_HDR.size:
+        raise BackupError("file too short")
+    magic, fmt, flags = FILE_HDR.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise BackupError("not a backup (bad magic)")
+    if fmt > FORMAT_VERSION:
+        raise BackupError("format version %d not supported" % fmt)
+    header_crc = zlib.crc32(data[:FILE_HDR.size])
+
+    doc = {
+        "format": fmt,
+        "flags": {"sources": bool(flags & FLAG_SOURCES),
+                  "bytecode": bool(flags & FLAG_BYTECODE)},
+        "records": [],
+    }
+    pos = FILE_HDR.size
+    count = 0
+    while True:
+        if pos + REC_HDR.size > len(data):
+            raise BackupError("truncated (no end record)")
+        rtype, rid, version, _, length = REC_HDR.unpack_from(data, pos)
+        end = pos + REC_HDR.size + length
+        if end + 4 > len(data):
+            raise BackupError("truncated record at offset %d" % pos)
+        payload = data[pos + REC_HDR.size:end]
+        (stored,) = struct.unpack_from("<I", data, end)
+        if zlib.crc32(data[pos:end]) != stored:
+            raise BackupError("CRC mismatch in record at offset %d" % pos)
+        pos = end + 4
+
+        if rtype == REC_END:
+            if length != END.size:
+                raise BackupError("bad end record")
+            records, end_crc = END.unpack(payload)
+            if end_crc != header_crc:
+                raise BackupError("file header CRC mismatch")
+            if records != count:
+                raise BackupError("%d records missing" % (records - count))
+            if pos != len(data):
+                raise BackupError("%d bytes after the end record" % (len(data) - pos))
+            return doc
+        doc["records"].append(record_to_json(rtype, rid, version, payload))
+        count += 1
+
+
+def record_to_json(rtype, rid, version, payload):
+    if rtype == REC_INFO and len(payload) == INFO.size:
+        fw, build, schema, size = INFO.unpack(payload)
+        return {"type": "info", "version": version, "firmware": cstr(fw),
+                "build": build, "schema_version": schema, "config_size": size}
+    if rtype == REC_SECTION:
+        name = SECTION_NAMES[rid] if rid < len(SECTION_NAMES) else None
+        return {"type": "section", "id": rid, "name": name, "version": version,
+                "hex": payload.hex()}
+    if rtype == REC_PROGRAM and len(payload) >= PROGRAM_HDR.size:
+        enabled, name = PROGRAM_HDR.unpack_from(payload, 0)
+        rec = {"type": "program", "id": rid, "version": version, "name": cstr(name),
+               "enabled": bool(enabled)}
+        source = payload[PROGRAM_HDR.size:]
+        try:
+            rec["source"] = source.decode("utf-8")
+        except UnicodeDecodeError:
+            rec["source_b64"] = base64.b64encode(source).decode("ascii")
+        return rec
+    if rtype == REC_BYTECODE:
+        return {"type": "bytecode", "id": rid, "version": version,
+                "b64": base64.b64encode(payload).decode("ascii")}
+    return {"type": rtype, "id": rid, "version": version,
+            "b64": base64.b64encode(payload).decode("ascii")}
+
+
+# ---------------------------------------------------------------------------
+# dict -> binary
+# ---------------------------------------------------------------------------
+
+def record_from_json(rec):
+    rtype = rec["type"]
+    rid = rec.get("id", 0)
+    version = rec.get("version", 1)
+    if rtype == "info":
+        payload = INFO.pack(rec["firmware"].encode("utf-8")[:15], rec["build"],
+                            rec["schema_version"], rec["config_size"])
+        return REC_INFO, 0, version, payload
+    if rtype == "section":
+        return REC_SECTION, rid, version, bytes.fromhex(rec["hex"])
+    if rtype == "program":
+        if "source_b64" in rec:
+            source = base64.b64decode(rec["source_b64"])
+        else:
+            source = rec.get("source", "").encode("utf-8")
+        name = rec.get("name", "Logic%d" % (rid + 1)).encode("utf-8")[:31]
+        return REC_PROGRAM, rid, version, PROGRAM_HDR.pack(1 if rec.get("enabled") else 0, name) + source
+    if rtype == "bytecode":
+        return REC_BYTECODE, rid, version, base64.b64decode(rec["b64"])
+    if isinstance(rtype, int):
+        return rtype, rid, version, base64.b64decode(rec["b64"])
+    raise BackupError("unknown record type %r" % rtype)
+
+
+def build(doc):
+    flags = 0
+    if doc.get("flags", {}).get("sources"):
+        flags |= FLAG_SOURCES
+    if doc.get("flags", {}).get("bytecode"):
+        flags |= FLAG_BYTECODE
+    header = FILE_HDR.pack(MAGIC, doc.get("format", FORMAT_VERSION), flags)
+    out = bytearray(header)
+
+    def put(rtype, rid, version, payload):
+        rec = REC_HDR.pack(rtype, rid, version, 0, len(payload)) + payload
+        out.extend(rec)
+        out.extend(struct.pack("<I", zlib.crc32(rec)))
+
+    records = doc.get("records", [])
+    for rec in records:
+        put(*record_from_json(rec))
+    put(REC_END, 0, 0, END.pack(len(records), zlib.crc32(header)))
+    return bytes(out)
+
+
+# ---------------------------------------------------------------------------
+# CLI
+# ---------------------------------------------------------------------------
+
+def write_out(path, data):
+    if path in (None, "-"):
+        if isinstance(data, bytes):
+            sys.stdout.buffer.write(data)
+        else:
+            sys.stdout.write(data)
+        return
+    with open(path, "wb" if isinstance(data, bytes) else "w") as f:
+        f.write(data)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Convert binary config backups (.mbk) to JSON and back")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    for name in ("to-json", "from-json", "info"):
+        p = sub.add_parser(name)
+        p.add_argument("input")
+        if name != "info":
+            p.add_argument("-o", "--output")
+    args = ap.parse_args()
+
+    try:
+        if args.cmd == "from-json":
+            with open(args.input) as f:
+                write_out(args.output, build(json.load(f)))
+            return 0
+
+        with open(args.input, "rb") as f:
+            doc = parse(f.read())
+        if args.cmd == "to-json":
+            write_out(args.output, json.dumps(doc, indent=2, ensure_ascii=False) + "\n")
+            return 0
+
+        print("format %d, sources %s, bytecode %s" %
+              (doc["format"], doc["flags"]["sources"], doc["flags"]["bytecode"]))
+        for rec in doc["records"]:
+            if rec["type"] == "info":
+                print("  info      firmware %s build %d schema %d" %
+                      (rec["firmware"], rec["build"], rec["schema_version"]))
+            elif rec["type"] == "section":
+                print("  section   %-9s v%d  %5d bytes" %
+                      (rec["name"], rec["version"], len(rec["hex"]) // 2))
+            elif rec["type"] == "program":
+                print("  program   %d %-20s %s  %d bytes source" %
+                      (rec["id"], rec["name"], "enabled " if rec["enabled"] else "disabled",
+                       len(rec.get("source", "").encode("utf-8"))))
+            else:
+                print("  %-9s %d  %d bytes" % (rec["type"], rec["id"], len(base64.b64decode(rec["b64"]))))
+        return 0
+    except (BackupError, OSError, ValueError, KeyError) as e:
+        print("ERROR: %s" % e, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+Generate precompressed web assets (FEAT-150)
+
+Extracts the R"rawhtml(...)rawhtml" page literal from each web_*.cpp file,
+gzips it and writes src/web_assets_gz.cpp with flash arrays, precomputed
+lengths and a strong ETag (content hash). The raw literals stay in the
+web_*.cpp files as the editable source of truth; only the gzip arrays end
+up in the firmware image (the unused raw arrays are dropped by --gc-sections).
+
+Runs as a PlatformIO pre-script and is skipped when the output is newer
+than all inputs.
+"""
+
+import os
+import re
+import gzip
+import hashlib
+
+# Import PlatformIO environment (if running as extra_script)
+try:
+    Import("env")
+    project_root = env.get("PROJECT_DIR")
+except:
+    # Fallback for standalone execution
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    project_root = os.path.dirname(script_dir)
+
+# (source file, symbol name in web_assets.h)
+ASSETS = [
+    ("src/web_dashboard.cpp", "web_asset_dashboard"),
+    ("src/web_editor.cpp",    "web_asset_editor"),
+    ("src/web_system.cpp",    "web_asset_system"),
+    ("src/web_cli.cpp",       "web_asset_cli"),
+    ("src/web_ota.cpp",       "web_asset_ota"),
+]
+
+output_file = os.path.join(project_root, "src", "web_assets_gz.cpp")
+this_script = os.path.abspath(__file__) if "__file__" in globals() else None
+
+RAW_RE = re.compile(r'R"rawhtml\((.*?)\)rawhtml"', re.S)
+
+
+def up_to_date():
+    if not os.path.exists(output_file):
+        return False
+    out_mtime = os.path.getmtime(output_file)
+    inputs = [os.path.join(project_root, src) for src, _ in ASSETS]
+    if this_script:
+        inputs.append(this_script)
+    return all(os.path.getmtime(p) <= out_mtime for p in inputs)
+
+
+def emit_array(name, data):
+    lines = [f"static const uint8_t {name}_gz[] PROGMEM = {{"]
+    for i in range(0, len(data), 16):
+        chunk = ", ".join(f"0x{b:02x}" for b in data[i:i + 16])
+        lines.append(f"  {chunk},")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    if up_to_date():
+        return
+
+    parts = []
+    table = []
+    total_raw = 0
+    total_gz = 0
+
+    for src, symbol in ASSETS:
+        with open(os.path.join(project_root, src), "r", encoding="utf-8") as f:
+            m = RAW_RE.search(f.read())
+        if not m:
+            raise SystemExit(f"generate_web_assets: no rawhtml literal in {src}")
+
+        raw = m.group(1).encode("utf-8")
+        # mtime=0 keeps the output byte-identical between builds
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        etag = hashlib.sha256(raw).hexdigest()[:16]
+
+        parts.append(emit_array(symbol, gz))
+        table.append(
+            f"const WebAsset {symbol} = {{ {symbol}_gz, {len(gz)}, {len(raw)}, \"\\\"{etag}\\\"\" }};"
+        )
+        total_raw += len(raw)
+        total_gz += len(gz)
+
+    content = f"""/**
+ * @file web_assets_gz.cpp
+ * @brief Auto-generated gzip web assets
+ *
+ * DO NOT EDIT MANUALLY - Generated by generate_web_assets.py
+ * Total: {total_raw} bytes raw -> {total_gz} bytes gzip
+ */
+
+#include <Arduino.h>
+#include "web_assets.h"
+
+{chr(10).join(parts)}
+
+{chr(10).join(table)}
+"""
+
+    with open(output_file, "w", encoding="utf-8") as f:
+        f.write(content)
+
+    print(f"Web assets generated: {len(ASSETS)} pages, {total_raw} -> {total_gz} bytes gzip")
+
+
+main()
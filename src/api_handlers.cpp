@@ -8,6 +8,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <Arduino.h>
 #include <ArduinoJson.h>
@@ -26,6 +27,8 @@
 #include "counter_engine.h"
 #include "counter_config.h"
 #include "counter_frequency.h"
+#include "counter_sw_isr.h"
+#include "counter_hw.h"
 #include "timer_engine.h"
 #include "timer_config.h"
 #include "st_logic_config.h"
@@ -38,18 +41,33 @@
 #include "config_load.h"
 #include "config_apply.h"
 #include "gpio_driver.h"
+#include "gpio_mapping.h"
+#include "di_irq.h"
 #include "network_manager.h"
 #include "modbus_master.h"
 #include "st_debug.h"
 #include "watchdog_monitor.h"
+#include "boot_trace.h"
+#include "warm_retain.h"
 #include "heartbeat.h"
 #include "registers_persist.h"
+#include "persist_writer.h"
+#include "fs_store.h"            // v7.9.10.3 - LittleFS file storage
+#include "fs_mount.h"
+#include "historian.h"          // v7.9.10.4 - on-device historian
+#include "st_bytecode_persist.h"
+#include "config_store.h"
+#include "config_backup.h"
 #include "sse_events.h"
 #include "cli_parser.h"
 #include "cli_shell.h"
 #include "rbac.h"
 #include "mb_async.h"
 #include "ntp_driver.h"
+#include "api_router.h"
+#include "api_v1_routes.h"
+#include "session_token.h"
+#include "web_assets.h"
 #include <esp_heap_caps.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -80,6 +98,7 @@ esp_err_t api_handler_counter_start(httpd_req_t *req);
 esp_err_t api_handler_counter_stop(httpd_req_t *req);
 static esp_err_t api_handler_counter_config_post(httpd_req_t *req);
 static esp_err_t api_handler_counter_control_post(httpd_req_t *req);
+static esp_err_t api_handler_counter_edges_get(httpd_req_t *req);
 
 /* ============================================================================
  * FEAT-085: ALARM HISTORY RINGBUFFER (v7.8.0)
@@ -278,18 +297,9 @@ void alarm_check_thresholds() {
  * UTILITY FUNCTIONS
  * ============================================================================ */
 
-int api_extract_id_from_uri(httpd_req_t *req, const char *prefix)
+// Parse numeric ID at start of a URI remainder ("12/source?x=1" -> 12), -1 if empty
+static int api_parse_uri_id(const char *id_str)
 {
-  const char *uri = req->uri;
-  size_t prefix_len = strlen(prefix);
-
-  // Check if URI starts with prefix
-  if (strncmp(uri, prefix, prefix_len) != 0) {
-    return -1;
-  }
-
-  // Extract ID after prefix
-  const char *id_str = uri + prefix_len;
   if (*id_str == '\0') {
     return -1;
   }
@@ -305,6 +315,32 @@ int api_extract_id_from_uri(httpd_req_t *req, const char *prefix)
   return atoi(id_buf);
 }
 
+// FEAT-151: ID already parsed by the v1 router for the request in flight
+static struct {
+  const httpd_req_t *req;
+  const char *rest;
+  int id;
+} api_route_id_ctx = { NULL, NULL, -1 };
+
+int api_extract_id_from_uri(httpd_req_t *req, const char *prefix)
+{
+  const char *uri = req->uri;
+  size_t prefix_len = strlen(prefix);
+
+  // Check if URI starts with prefix
+  if (strncmp(uri, prefix, prefix_len) != 0) {
+    return -1;
+  }
+
+  // Router already split the path at this prefix
+  if (api_route_id_ctx.req == req && api_route_id_ctx.rest == uri + prefix_len) {
+    return api_route_id_ctx.id;
+  }
+
+  // Extract ID after prefix
+  return api_parse_uri_id(uri + prefix_len);
+}
+
 esp_err_t api_send_error(httpd_req_t *req, int status, const char *error_msg)
 {
   DebugFlags* dbg = debug_flags_get();
@@ -324,14 +360,20 @@ esp_err_t api_send_error(httpd_req_t *req, int status, const char *error_msg)
                              status == 400 ? "400 Bad Request" :
                              status == 401 ? "401 Unauthorized" :
                              status == 403 ? "403 Forbidden" :
-                             status == 500 ? "500 Internal Server Error" : "400 Bad Request");
+                             status == 500 ? "500 Internal Server Error" :
+                             status == 503 ? "503 Service Unavailable" : "400 Bad Request");
 
   // For 401/403, capture client IP and username BEFORE sending response (socket may close after send)
   char fail_ip[16] = {0};
   char fail_user[32] = {0};
   if (status == 401 || status == 403) {
+    char auth_hdr[256] = {0};
+    bool have_auth = httpd_req_get_hdr_value_str(req, "Authorization", auth_hdr, sizeof(auth_hdr)) == ESP_OK;
     if (status == 401) {
-      httpd_resp_set_hdr(req, "WWW-Authenticate", "Basic realm=\"Modbus ESP32\"");
+      // Expired session token: ask for a new login, not a browser Basic prompt
+      bool bearer = have_auth && strncmp(auth_hdr, "Bearer ", 7) == 0;
+      httpd_resp_set_hdr(req, "WWW-Authenticate", bearer ?
+        "Bearer realm=\"Modbus ESP32\", error=\"invalid_token\"" : "Basic realm=\"Modbus ESP32\"");
     }
     // Get client IP while socket is still valid
     int sockfd = httpd_req_to_sockfd(req);
@@ -349,8 +391,7 @@ esp_err_t api_send_error(httpd_req_t *req, int status, const char *error_msg)
       }
     }
     // Extract username from Authorization header
-    char auth_hdr[256] = {0};
-    if (httpd_req_get_hdr_value_str(req, "Authorization", auth_hdr, sizeof(auth_hdr)) == ESP_OK) {
+    if (have_auth) {
       const char *b64 = strstr(auth_hdr, "Basic ");
       if (b64) {
         b64 += 6;
@@ -488,6 +529,7 @@ esp_err_t api_handler_endpoints(httpd_req_t *req)
     "{\"method\":\"POST\",\"path\":\"/api/counters/{1-4}/start\",\"desc\":\"Start counter\"},"
     "{\"method\":\"POST\",\"path\":\"/api/counters/{1-4}/stop\",\"desc\":\"Stop counter\"},"
     "{\"method\":\"POST\",\"path\":\"/api/counters/{1-4}/control\",\"desc\":\"Counter control\"},"
+    "{\"method\":\"GET\",\"path\":\"/api/counters/{1-4}/edges\",\"desc\":\"Edge timestamps (?since=)\"},"
     "{\"method\":\"DELETE\",\"path\":\"/api/counters/{1-4}\",\"desc\":\"Delete counter\"},"
     "{\"method\":\"GET\",\"path\":\"/api/timers\",\"desc\":\"All timers\"},"
     "{\"method\":\"GET\",\"path\":\"/api/timers/{1-4}\",\"desc\":\"Single timer\"},"
@@ -545,6 +587,7 @@ esp_err_t api_handler_endpoints(httpd_req_t *req)
     "{\"method\":\"GET\",\"path\":\"/api/registers/coils\",\"desc\":\"Bulk read coils (start,count)\"},"
     "{\"method\":\"POST\",\"path\":\"/api/registers/coils/bulk\",\"desc\":\"Bulk write coils\"},"
     "{\"method\":\"GET\",\"path\":\"/api/registers/di\",\"desc\":\"Bulk read DIs (start,count)\"},"
+    "{\"method\":\"GET\",\"path\":\"/api/registers/multi\",\"desc\":\"Read HR/IR/coils/DI ranges in one snapshot\"},"
     "{\"method\":\"POST\",\"path\":\"/api/logic/{1-4}/debug/pause\",\"desc\":\"Pause program\"},"
     "{\"method\":\"POST\",\"path\":\"/api/logic/{1-4}/debug/continue\",\"desc\":\"Continue program\"},"
     "{\"method\":\"POST\",\"path\":\"/api/logic/{1-4}/debug/step\",\"desc\":\"Step instruction\"},"
@@ -559,7 +602,9 @@ esp_err_t api_handler_endpoints(httpd_req_t *req)
     "{\"method\":\"GET\",\"path\":\"/api/v1/*\",\"desc\":\"API v1 versioned endpoint (FEAT-030)\"},"
     "{\"method\":\"POST\",\"path\":\"/api/system/ota\",\"desc\":\"Upload firmware (OTA, FEAT-031)\"},"
     "{\"method\":\"GET\",\"path\":\"/api/system/ota/status\",\"desc\":\"OTA progress status (FEAT-031)\"},"
-    "{\"method\":\"POST\",\"path\":\"/api/system/ota/rollback\",\"desc\":\"Rollback firmware (FEAT-031)\"}"
+    "{\"method\":\"POST\",\"path\":\"/api/system/ota/rollback\",\"desc\":\"Rollback firmware (FEAT-031)\"},"
+    "{\"method\":\"POST\",\"path\":\"/api/auth/login\",\"desc\":\"Exchange Basic credentials for a session token\"},"
+    "{\"method\":\"POST\",\"path\":\"/api/auth/logout\",\"desc\":\"Revoke session token\"}"
     "]"
     "}",
     PROJECT_VERSION, BUILD_NUMBER);
@@ -682,6 +727,14 @@ esp_err_t api_handler_counter_single(httpd_req_t *req)
     }
   }
 
+  if (req->method == HTTP_GET) {
+    // GET may carry a query string (?since=), match the suffix on the path only
+    size_t path_len = strcspn(uri, "?");
+    if (path_len >= 6 && strncmp(uri + path_len - 6, "/edges", 6) == 0) {
+      return api_handler_counter_edges_get(req);
+    }
+  }
+
   http_server_stat_request();
   CHECK_AUTH(req);
 
@@ -722,6 +775,17 @@ esp_err_t api_handler_counter_single(httpd_req_t *req)
     uint16_t freq = registers_get_holding_register(cfg.freq_reg);
     doc["frequency"] = freq;
   }
+  doc["freq_mode"] = (cfg.freq_mode == COUNTER_FREQ_RECIPROCAL) ? "reciprocal" : "gate";
+  doc["frequency_mhz"] = counter_frequency_get_mhz(id);
+
+  // FEAT-157: Quadrature position (signed) and velocity (counts/s)
+  if (counter_hw_is_quadrature(id)) {
+    CounterQuadConfig quad;
+    counter_config_get_quad(id, &quad);
+    doc["quadrature"] = quad.mode;
+    doc["position"] = counter_hw_get_position(id);
+    doc["velocity"] = counter_hw_get_velocity(id);
+  }
 
   // Control register flags
   if (cfg.ctrl_reg != 0xFFFF) {
@@ -840,6 +904,10 @@ esp_err_t api_handler_timer_single(httpd_req_t *req)
     default:
       break;
   }
+  doc["time_base"] = (cfg.time_base == TIMER_TIME_BASE_US) ? "us" : "ms";
+  if (cfg.mode == TIMER_MODE_3_ASTABLE) {
+    doc["late_resyncs"] = timer_engine_get_late_resyncs(id);
+  }
 
   char buf[HTTP_JSON_DOC_SIZE];
   serializeJson(doc, buf, sizeof(buf));
@@ -1326,6 +1394,9 @@ esp_err_t api_handler_logic_source_get(httpd_req_t *req)
   }
 
   st_logic_program_config_t *prog = &state->programs[id - 1];
+  if (prog->source_deferred) {
+    return api_send_error(req, 503, "Source not loaded yet - retry");
+  }
   const char *source = st_logic_get_source_code(state, id - 1);
   if (!source || prog->source_size == 0) {
     return api_send_error(req, 404, "No source code uploaded for this program");
@@ -1492,6 +1563,7 @@ esp_err_t api_handler_system_reboot(httpd_req_t *req)
 
   // Schedule reboot after response is sent
   delay(1000);
+  persist_writer_flush(PW_FLUSH_TIMEOUT_MS);
   ESP.restart();
 
   return ret;
@@ -1508,7 +1580,7 @@ esp_err_t api_handler_system_save(httpd_req_t *req)
   // Calculate CRC before saving
   g_persist_config.crc16 = config_calculate_crc16(&g_persist_config);
 
-  bool success = config_save_to_nvs(&g_persist_config);
+  bool success = config_save_to_nvs_wait(&g_persist_config, PW_WAIT_TIMEOUT_MS);
 
   if (!success) {
     return api_send_error(req, 500, "Failed to save configuration");
@@ -1700,6 +1772,10 @@ esp_err_t api_handler_gpio(httpd_req_t *req)
     if (m->input_reg != 0xFFFF) {
       gpio["register"] = m->input_reg;
     }
+    if (m->gpio_pin < 64 && (g_persist_config.gpio_irq_pins & (1ULL << m->gpio_pin))) {
+      gpio["irq"] = true;
+      gpio["caught"] = di_irq_caught(m->gpio_pin, false);
+    }
   }
 
   char buf[HTTP_JSON_DOC_SIZE];
@@ -1741,6 +1817,23 @@ esp_err_t api_handler_gpio_single(httpd_req_t *req)
     if (found->input_reg != 0xFFFF) {
       doc["register"] = found->input_reg;
     }
+    if (pin < 64 && (g_persist_config.gpio_irq_pins & (1ULL << pin))) {
+      // FEAT-163: interrupt mode; ?clear=1 reads and clears the caught latch
+      char query[32] = {0};
+      char val[4] = {0};
+      bool clear = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                   httpd_query_key_value(query, "clear", val, sizeof(val)) == ESP_OK &&
+                   val[0] == '1';
+      doc["irq"] = true;
+      doc["irq_active"] = (di_irq_active_pins() & (1ULL << pin)) != 0;
+      doc["edges"] = di_irq_edge_count(pin);
+      doc["caught"] = di_irq_caught(pin, clear);
+      uint32_t pulses, width_us;
+      if (di_irq_get_pulse(pin, &pulses, &width_us)) {
+        doc["pulses"] = pulses;
+        doc["last_pulse_us"] = width_us;
+      }
+    }
   } else {
     doc["configured"] = false;
   }
@@ -2130,6 +2223,13 @@ esp_err_t api_handler_config_get(httpd_req_t *req)
     else if (c->edge_type == COUNTER_EDGE_BOTH) edge = "both";
     co["edge"] = edge;
     co["direction"] = (c->direction == COUNTER_DIR_DOWN) ? "down" : "up";
+    co["freq_mode"] = (c->freq_mode == COUNTER_FREQ_RECIPROCAL) ? "reciprocal" : "gate";
+    const CounterQuadConfig *q = &g_persist_config.counter_quad[i];
+    if (q->mode != COUNTER_QUAD_OFF) {
+      co["quadrature"] = q->mode;
+      co["quad_gpio_b"] = q->gpio_b;
+      co["velocity_reg"] = q->velocity_reg;
+    }
     co["prescaler"] = c->prescaler;
     co["bit_width"] = c->bit_width;
     co["scale_factor"] = c->scale_factor;
@@ -2182,6 +2282,7 @@ esp_err_t api_handler_config_get(httpd_req_t *req)
         break;
       default: break;
     }
+    if (t->time_base == TIMER_TIME_BASE_US) ti["time_base"] = "us";
   }
 
   // ── GPIO MAPPINGS ──
@@ -2194,6 +2295,7 @@ esp_err_t api_handler_config_get(httpd_req_t *req)
     g["direction"] = m->is_input ? "input" : "output";
     if (m->is_input) {
       g["register"] = m->input_reg;
+      if (m->gpio_pin < 64 && (g_persist_config.gpio_irq_pins & (1ULL << m->gpio_pin))) g["irq"] = true;
     } else {
       g["coil"] = m->coil_reg;
     }
@@ -3025,6 +3127,12 @@ static esp_err_t api_handler_counter_config_post(httpd_req_t *req)
       cfg.direction = (strcmp(d, "down") == 0) ? COUNTER_DIR_DOWN : COUNTER_DIR_UP;
     }
   }
+  if (doc.containsKey("freq_mode")) {
+    const char *fm = doc["freq_mode"].as<const char*>();
+    if (fm) {
+      cfg.freq_mode = (strcmp(fm, "reciprocal") == 0) ? COUNTER_FREQ_RECIPROCAL : COUNTER_FREQ_GATE;
+    }
+  }
   if (doc.containsKey("prescaler")) cfg.prescaler = doc["prescaler"].as<uint16_t>();
   if (doc.containsKey("bit_width")) cfg.bit_width = doc["bit_width"].as<uint8_t>();
   if (doc.containsKey("scale_factor")) cfg.scale_factor = doc["scale_factor"].as<float>();
@@ -3044,7 +3152,17 @@ static esp_err_t api_handler_counter_config_post(httpd_req_t *req)
   if (doc.containsKey("compare_value")) cfg.compare_value = doc["compare_value"].as<uint64_t>();
   if (doc.containsKey("compare_mode")) cfg.compare_mode = doc["compare_mode"].as<uint8_t>();
 
+  // FEAT-157: Quadrature (quadrature = 0/1/2/4, quad_gpio_b = channel B)
+  CounterQuadConfig quad;
+  counter_config_get_quad(id, &quad);
+  if (doc.containsKey("quadrature")) quad.mode = doc["quadrature"].as<uint8_t>();
+  if (doc.containsKey("quad_gpio_b")) quad.gpio_b = doc["quad_gpio_b"].as<uint8_t>();
+  if (doc.containsKey("quad_filter_ns")) quad.glitch_ns = doc["quad_filter_ns"].as<uint16_t>();
+  if (doc.containsKey("velocity_filter_ms")) quad.velocity_filter_ms = doc["velocity_filter_ms"].as<uint16_t>();
+  if (doc.containsKey("velocity_sample_ms")) quad.velocity_sample_ms = doc["velocity_sample_ms"].as<uint16_t>();
+
   // Apply
+  counter_config_set_quad(id, &quad);
   counter_config_set(id, &cfg);
   counter_engine_configure(id, &cfg);
 
@@ -3215,6 +3333,10 @@ esp_err_t api_handler_timer_config_post(httpd_req_t *req)
   }
   if (doc.containsKey("input_dis")) cfg.input_dis = doc["input_dis"].as<uint8_t>();
   if (doc.containsKey("delay_ms")) cfg.delay_ms = doc["delay_ms"].as<uint32_t>();
+  if (doc.containsKey("time_base")) {
+    const char *tb = doc["time_base"].as<const char*>();
+    cfg.time_base = (tb && strcmp(tb, "us") == 0) ? TIMER_TIME_BASE_US : TIMER_TIME_BASE_MS;
+  }
 
   // Apply config
   memcpy(&g_persist_config.timers[id - 1], &cfg, sizeof(TimerConfig));
@@ -3290,6 +3412,8 @@ esp_err_t api_handler_gpio_config_delete(httpd_req_t *req)
         memcpy(&g_persist_config.var_maps[j], &g_persist_config.var_maps[j + 1], sizeof(VariableMapping));
       }
       g_persist_config.var_map_count--;
+      if (pin < 64) g_persist_config.gpio_irq_pins &= ~(1ULL << pin);
+      gpio_mapping_invalidate();
       found = true;
       break;
     }
@@ -3356,6 +3480,12 @@ esp_err_t api_handler_gpio_config_post(httpd_req_t *req)
 
   bool is_input = (strcmp(dir, "input") == 0);
 
+  // FEAT-163: optional interrupt mode for inputs on real pins
+  bool use_irq = doc["irq"] | false;
+  if (use_irq && (!is_input || pin > 39)) {
+    return api_send_error(req, 400, "irq requires direction 'input' on GPIO 0-39");
+  }
+
   // Get register/coil address
   uint16_t reg_addr = 0xFFFF;
   if (is_input) {
@@ -3417,6 +3547,11 @@ esp_err_t api_handler_gpio_config_post(httpd_req_t *req)
     existing->output_type = 1;  // Coil
   }
   existing->word_count = 1;
+  if (pin < 64) {
+    if (use_irq) g_persist_config.gpio_irq_pins |= 1ULL << pin;
+    else g_persist_config.gpio_irq_pins &= ~(1ULL << pin);
+  }
+  gpio_mapping_invalidate();
 
   // Configure GPIO direction
   gpio_set_direction(pin, is_input ? GPIO_INPUT : GPIO_OUTPUT);
@@ -3427,6 +3562,7 @@ esp_err_t api_handler_gpio_config_post(httpd_req_t *req)
   resp["direction"] = dir;
   if (is_input) {
     resp["register"] = reg_addr;
+    resp["irq"] = use_irq;
   } else {
     resp["coil"] = reg_addr;
   }
@@ -3575,6 +3711,7 @@ esp_err_t api_handler_logic_bind_post(httpd_req_t *req)
       i--;
     }
   }
+  gpio_mapping_invalidate();  // Removed bindings must leave the plan even if adding fails
 
   // Create new binding(s)
   int created = 0;
@@ -3735,6 +3872,72 @@ esp_err_t api_handler_user_me(httpd_req_t *req)
   return api_send_json(req, buf);
 }
 
+/* ============================================================================
+ * FEAT-153: Session tokens — POST /api/auth/login, POST /api/auth/logout
+ * ============================================================================ */
+
+// Read the Authorization header; true if it carries a Bearer token
+static bool api_auth_is_bearer(httpd_req_t *req, char *buf, size_t len)
+{
+  if (httpd_req_get_hdr_value_str(req, "Authorization", buf, len) != ESP_OK) return false;
+  return strncmp(buf, "Bearer ", 7) == 0;
+}
+
+esp_err_t api_handler_auth_login(httpd_req_t *req)
+{
+  http_server_stat_request();
+  CHECK_API_ENABLED(req);
+  if (!http_rate_limit_check(req)) {
+    return api_send_error(req, 429, "Too many requests");
+  }
+
+  // Tokens are only issued against real credentials, so a session cannot
+  // extend itself past SESSION_TOKEN_MAX_AGE_MS
+  char auth_hdr[256];
+  if (api_auth_is_bearer(req, auth_hdr, sizeof(auth_hdr))) {
+    return api_send_error(req, 400, "Login requires Basic credentials");
+  }
+
+  int uid = http_server_auth_user(req);
+  if (uid < 0) {
+    return api_send_error(req, 401, "Authentication required");
+  }
+
+  char token[SESSION_TOKEN_LEN + 1];
+  if (!session_token_issue(uid, token, sizeof(token))) {
+    return api_send_error(req, 500, "Token issue failed");
+  }
+
+  const RbacUser *u = (uid == 99) ? NULL : rbac_get_user(uid);
+  if (debug_flags_get()->http_api) {
+    debug_printf("[API] login: session for '%s' (%d active)\n",
+                 u ? u->username : "admin", session_token_active_count());
+  }
+
+  char buf[192];
+  snprintf(buf, sizeof(buf),
+    "{\"token\":\"%s\",\"token_type\":\"Bearer\",\"idle_timeout_ms\":%lu,\"max_age_ms\":%lu,\"username\":\"%s\"}",
+    token, (unsigned long)SESSION_TOKEN_IDLE_MS, (unsigned long)SESSION_TOKEN_MAX_AGE_MS,
+    u ? u->username : "admin");
+  return api_send_json(req, buf);
+}
+
+esp_err_t api_handler_auth_logout(httpd_req_t *req)
+{
+  http_server_stat_request();
+  CHECK_API_ENABLED(req);
+
+  char auth_hdr[256];
+  if (!api_auth_is_bearer(req, auth_hdr, sizeof(auth_hdr))) {
+    return api_send_error(req, 400, "No session token");
+  }
+  bool revoked = session_token_revoke(auth_hdr + 7);
+
+  char buf[64];
+  snprintf(buf, sizeof(buf), "{\"status\":200,\"revoked\":%s}", revoked ? "true" : "false");
+  return api_send_json(req, buf);
+}
+
 esp_err_t api_handler_cli_exec(httpd_req_t *req)
 {
   http_server_stat_request();
@@ -3910,6 +4113,7 @@ esp_err_t api_handler_bindings_delete(httpd_req_t *req)
     memcpy(&g_persist_config.var_maps[j], &g_persist_config.var_maps[j + 1], sizeof(VariableMapping));
   }
   g_persist_config.var_map_count--;
+  gpio_mapping_invalidate();
 
   // Update binding counts
   st_logic_engine_state_t *st = st_logic_get_state();
@@ -4052,11 +4256,114 @@ esp_err_t api_handler_modules_post(httpd_req_t *req)
  * BACKUP / RESTORE ENDPOINTS
  * ============================================================================ */
 
+static int api_parse_query_int(httpd_req_t *req, const char *key, int default_val);
+
+/* v7.9.10.1: Binary backup (config_backup.h), selected like FEAT-152 blocks
+ * with "Accept: application/octet-stream" on backup and
+ * "Content-Type: application/octet-stream" on restore. */
+#define BACKUP_MIME           "application/octet-stream"
+#define BACKUP_RECV_CHUNK     1024
+
+static bool backup_send_chunk(void *ctx, const void *buf, uint32_t len)
+{
+  return httpd_resp_send_chunk((httpd_req_t *)ctx, (const char *)buf, len) == ESP_OK;
+}
+
+static esp_err_t api_system_backup_binary(httpd_req_t *req)
+{
+  uint16_t flags = 0;
+  if (api_parse_query_int(req, "sources", 1)) flags |= BK_FLAG_SOURCES;
+  // Images are keyed to their source: only with sources
+  if ((flags & BK_FLAG_SOURCES) && api_parse_query_int(req, "bytecode", 0)) {
+    flags |= BK_FLAG_BYTECODE;
+  }
+
+  httpd_resp_set_type(req, BACKUP_MIME);
+  httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"backup.mbk\"");
+
+  BkSink sink = { req, backup_send_chunk };
+  BkError err = config_backup_write(&sink, flags);
+  if (err != BK_OK) {
+    // Headers are out: drop the connection, the client sees no end record
+    debug_printf("[BACKUP] Binary backup failed: %s\n", bk_error_name(err));
+    return ESP_FAIL;
+  }
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t api_system_restore_binary(httpd_req_t *req)
+{
+  int content_len = req->content_len;
+  if (content_len <= 0) {
+    return api_send_error(req, 400, "Empty body");
+  }
+
+  ConfigRestore *restore = config_restore_begin();
+  char *chunk = (char *)malloc(BACKUP_RECV_CHUNK);
+  if (!restore || !chunk) {
+    config_restore_free(restore);
+    free(chunk);
+    return api_send_error(req, 500, "Out of memory");
+  }
+
+  // Parsed while receiving: the body is never held in RAM as a whole
+  int received = 0;
+  BkError err = BK_OK;
+  while (received < content_len && err == BK_OK) {
+    int want = content_len - received;
+    if (want > BACKUP_RECV_CHUNK) want = BACKUP_RECV_CHUNK;
+    int ret = httpd_req_recv(req, chunk, want);
+    if (ret <= 0) {
+      config_restore_free(restore);
+      free(chunk);
+      return api_send_error(req, 400, "Failed to read body");
+    }
+    received += ret;
+    err = config_restore_feed(restore, chunk, (uint32_t)ret);
+  }
+  free(chunk);
+
+  ConfigRestoreResult res;
+  if (err == BK_OK) err = config_restore_commit(restore, &res);
+  config_restore_free(restore);
+  if (err != BK_OK) {
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Invalid backup: %s", bk_error_name(err));
+    return api_send_error(req, 400, msg);
+  }
+
+  bool save_ok = config_save_to_nvs_wait(&g_persist_config, PW_WAIT_TIMEOUT_MS);
+  if (!save_ok) {
+    return api_send_error(req, 500, "Config saved partially - NVS write failed");
+  }
+  config_apply(&g_persist_config);
+
+  JsonDocument resp;
+  resp["status"] = 200;
+  resp["message"] = "Configuration restored and applied";
+  resp["warning"] = "Full config replaced. Reboot recommended.";
+  resp["firmware_version"] = res.firmware;
+  resp["sections"] = res.sections;
+  resp["sections_skipped"] = res.sections_skipped;
+  resp["programs"] = res.programs;
+  resp["programs_cached"] = res.cached;
+  resp["programs_compiled"] = res.compiled;
+  resp["program_errors"] = res.errors;
+
+  char respbuf[384];
+  serializeJson(resp, respbuf, sizeof(respbuf));
+  return api_send_json(req, respbuf);
+}
+
 esp_err_t api_handler_system_backup(httpd_req_t *req)
 {
   http_server_stat_request();
   CHECK_AUTH(req);
 
+  if (web_asset_header_match(req, "Accept", BACKUP_MIME) == 1) {
+    return api_system_backup_binary(req);
+  }
+
   JsonDocument doc;
 
   // ── METADATA ──
@@ -4167,6 +4474,21 @@ esp_err_t api_handler_system_backup(httpd_req_t *req)
   ntp["timezone"] = g_persist_config.ntp.timezone;
   ntp["sync_interval_min"] = g_persist_config.ntp.sync_interval_min;
 
+  // ── HISTORIAN (v7.9.10.4) ──
+  JsonObject hist = doc["historian"].to<JsonObject>();
+  hist["enabled"] = g_persist_config.historian.enabled ? true : false;
+  hist["spill_kb"] = g_persist_config.historian.spill_kb;
+  JsonArray hist_points = hist["points"].to<JsonArray>();
+  for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+    const HistPointConfig *pc = &g_persist_config.historian.points[p];
+    if (pc->source == HIST_SRC_OFF) continue;
+    JsonObject po = hist_points.add<JsonObject>();
+    po["id"] = p + 1;
+    po["source"] = historian_source_name(pc->source);
+    po["address"] = pc->address;
+    po["interval_ms"] = pc->interval_ms;
+  }
+
   // ── MISC ──
   doc["remote_echo"] = g_persist_config.remote_echo ? true : false;
   doc["gpio2_user_mode"] = g_persist_config.gpio2_user_mode ? true : false;
@@ -4203,6 +4525,14 @@ esp_err_t api_handler_system_backup(httpd_req_t *req)
     co["compare_value"] = c->compare_value;
     co["reset_on_read"] = c->reset_on_read;
     co["compare_source"] = c->compare_source;
+    co["freq_mode"] = c->freq_mode;
+    const CounterQuadConfig *q = &g_persist_config.counter_quad[i];
+    co["quad_mode"] = q->mode;
+    co["quad_gpio_b"] = q->gpio_b;
+    co["quad_filter_ns"] = q->glitch_ns;
+    co["velocity_reg"] = q->velocity_reg;
+    co["velocity_filter_ms"] = q->velocity_filter_ms;
+    co["velocity_sample_ms"] = q->velocity_sample_ms;
   }
 
   // ── TIMERS ──
@@ -4228,6 +4558,7 @@ esp_err_t api_handler_system_backup(httpd_req_t *req)
     ti["trigger_edge"] = t->trigger_edge;
     ti["output_coil"] = t->output_coil;
     ti["ctrl_reg"] = t->ctrl_reg;
+    ti["time_base"] = t->time_base;
   }
 
   // ── STATIC REGISTERS ──
@@ -4291,6 +4622,10 @@ esp_err_t api_handler_system_backup(httpd_req_t *req)
     mo["coil_reg"] = m->coil_reg;
     mo["word_count"] = m->word_count;
   }
+  JsonArray irq_pins = doc["gpio_irq_pins"].to<JsonArray>();
+  for (uint8_t pin = 0; pin < 64; pin++) {
+    if (g_persist_config.gpio_irq_pins & (1ULL << pin)) irq_pins.add(pin);
+  }
 
   // ── PERSIST REGS ──
   JsonObject persist = doc["persist_regs"].to<JsonObject>();
@@ -4399,6 +4734,10 @@ esp_err_t api_handler_system_restore(httpd_req_t *req)
   http_server_stat_request();
   CHECK_AUTH_WRITE(req);
 
+  if (web_asset_header_match(req, "Content-Type", BACKUP_MIME) == 1) {
+    return api_system_restore_binary(req);
+  }
+
   // Read request body (up to 32KB)
   int content_len = req->content_len;
   if (content_len <= 0 || content_len > 32768) {
@@ -4584,6 +4923,23 @@ esp_err_t api_handler_system_restore(httpd_req_t *req)
     }
   }
 
+  // ── RESTORE HISTORIAN ──
+  if (doc.containsKey("historian")) {
+    JsonObject h = doc["historian"];
+    memset(&g_persist_config.historian, 0, sizeof(HistorianConfig));
+    g_persist_config.historian.enabled = h["enabled"].as<bool>() ? 1 : 0;
+    g_persist_config.historian.spill_kb = h["spill_kb"] | 0;
+    for (JsonObject po : h["points"].as<JsonArray>()) {
+      int id = po["id"] | 0;
+      HistPointConfig pc = {};
+      if (id < 1 || id > HIST_MAX_POINTS ||
+          !historian_source_parse(po["source"].as<const char*>(), &pc.source)) continue;
+      pc.address = po["address"] | 0;
+      pc.interval_ms = po["interval_ms"] | 0;
+      if (historian_point_check(&pc) == NULL) g_persist_config.historian.points[id - 1] = pc;
+    }
+  }
+
   // ── RESTORE MISC ──
   if (doc.containsKey("remote_echo")) g_persist_config.remote_echo = doc["remote_echo"];
   if (doc.containsKey("gpio2_user_mode")) g_persist_config.gpio2_user_mode = doc["gpio2_user_mode"];
@@ -4621,6 +4977,14 @@ esp_err_t api_handler_system_restore(httpd_req_t *req)
       if (co.containsKey("compare_value")) c->compare_value = co["compare_value"];
       if (co.containsKey("reset_on_read")) c->reset_on_read = co["reset_on_read"];
       if (co.containsKey("compare_source")) c->compare_source = co["compare_source"];
+      if (co.containsKey("freq_mode")) c->freq_mode = co["freq_mode"];
+      CounterQuadConfig *q = &g_persist_config.counter_quad[id];
+      if (co.containsKey("quad_mode")) q->mode = co["quad_mode"];
+      if (co.containsKey("quad_gpio_b")) q->gpio_b = co["quad_gpio_b"];
+      if (co.containsKey("quad_filter_ns")) q->glitch_ns = co["quad_filter_ns"];
+      if (co.containsKey("velocity_reg")) q->velocity_reg = co["velocity_reg"];
+      if (co.containsKey("velocity_filter_ms")) q->velocity_filter_ms = co["velocity_filter_ms"];
+      if (co.containsKey("velocity_sample_ms")) q->velocity_sample_ms = co["velocity_sample_ms"];
     }
   }
 
@@ -4648,6 +5012,7 @@ esp_err_t api_handler_system_restore(httpd_req_t *req)
       if (ti.containsKey("trigger_edge")) t->trigger_edge = ti["trigger_edge"];
       if (ti.containsKey("output_coil")) t->output_coil = ti["output_coil"];
       if (ti.containsKey("ctrl_reg")) t->ctrl_reg = ti["ctrl_reg"];
+      if (ti.containsKey("time_base")) t->time_base = ti["time_base"];
     }
   }
 
@@ -4783,7 +5148,7 @@ esp_err_t api_handler_system_restore(httpd_req_t *req)
         }
       }
 
-      // Save ST Logic to SPIFFS
+      // Save ST Logic sources (LittleFS)
       st_logic_save_to_persist_config(&g_persist_config);
     }
   }
@@ -4812,6 +5177,13 @@ esp_err_t api_handler_system_restore(httpd_req_t *req)
       g_persist_config.var_map_count++;
     }
   }
+  if (doc.containsKey("gpio_irq_pins")) {
+    g_persist_config.gpio_irq_pins = 0;
+    for (JsonVariant v : doc["gpio_irq_pins"].as<JsonArray>()) {
+      uint8_t pin = v | 0xFF;
+      if (pin < 40) g_persist_config.gpio_irq_pins |= 1ULL << pin;
+    }
+  }
 
   // ── RESTORE RBAC USERS ──
   if (doc.containsKey("rbac")) {
@@ -4838,9 +5210,10 @@ esp_err_t api_handler_system_restore(httpd_req_t *req)
       }
     }
   }
+  session_token_revoke_all();  // Users and credentials may have been replaced
 
   // Save PersistConfig to NVS
-  bool save_ok = config_save_to_nvs(&g_persist_config);
+  bool save_ok = config_save_to_nvs_wait(&g_persist_config, PW_WAIT_TIMEOUT_MS);
   if (!save_ok) {
     return api_send_error(req, 500, "Config saved partially - NVS write failed");
   }
@@ -5095,6 +5468,7 @@ esp_err_t api_handler_dashboard_layout_get(httpd_req_t *req)
   http_server_stat_request();
   // No auth required — layout is non-sensitive UI preference
   CHECK_API_ENABLED(req);
+  config_store_ensure(CFG_SEC_UI);  // Lazy section (v7.9.9.7)
 
   char buf[600];
   snprintf(buf, sizeof(buf),
@@ -5114,6 +5488,7 @@ esp_err_t api_handler_dashboard_layout_post(httpd_req_t *req)
   http_server_stat_request();
   CHECK_API_ENABLED(req);
   // Auth optional — layout is non-sensitive UI preference (matches GET handler)
+  config_store_ensure(CFG_SEC_UI);  // Load before editing, or a save would skip it
 
   char body[600];
   int len = httpd_req_recv(req, body, sizeof(body) - 1);
@@ -5182,6 +5557,7 @@ esp_err_t api_handler_system_watchdog(httpd_req_t *req)
   doc["last_reset_reason"] = wd->last_reset_reason;
   doc["last_error"] = wd->last_error;
   doc["last_reboot_uptime_ms"] = wd->last_reboot_uptime_ms;
+  doc["boot_ready_us"] = wd->boot_ready_us;
   doc["uptime_ms"] = millis();
   doc["heap_free"] = ESP.getFreeHeap();
   doc["heap_min_free"] = ESP.getMinFreeHeap();
@@ -5204,24 +5580,243 @@ static int api_parse_query_int(httpd_req_t *req, const char *key, int default_va
   return atoi(val);
 }
 
+/* ============================================================================
+ * FEAT-152: Binary register blocks (content negotiation on the bulk API)
+ *
+ * Selected with "Accept: application/octet-stream" on reads and
+ * "Content-Type: application/octet-stream" on bulk writes. One block is a
+ * 16 byte header followed by the data, everything big-endian:
+ *
+ *   [0..1]   magic 'R','B'
+ *   [2]      version (1)
+ *   [3]      type (1=HR, 2=IR, 3=coils, 4=DI)
+ *   [4..5]   start address
+ *   [6..7]   count (registers or bits)
+ *   [8..11]  write sequence number at snapshot (registers_get_write_seq)
+ *   [12..15] snapshot time (ms since boot)
+ *
+ * Registers follow as uint16 each; coils/DI as packed bits, LSB first
+ * (Modbus FC01/FC02 layout), ceil(count/8) bytes. All blocks in one
+ * response are taken under the same sequence number.
+ * ============================================================================ */
+
+#define REG_BLOCK_MAGIC0      'R'
+#define REG_BLOCK_MAGIC1      'B'
+#define REG_BLOCK_VERSION     1
+#define REG_BLOCK_HDR_SIZE    16
+#define REG_BLOCK_MAX_RANGES  4
+#define REG_BLOCK_MAX_RETRY   16
+#define REG_BLOCK_MIME        "application/octet-stream"
+
+enum {
+  REG_BLOCK_HR    = 1,
+  REG_BLOCK_IR    = 2,
+  REG_BLOCK_COILS = 3,
+  REG_BLOCK_DI    = 4
+};
+
+typedef struct {
+  uint8_t  type;
+  uint16_t start;
+  uint16_t count;
+} RegBlockRange;
+
+static uint16_t reg_block_capacity(uint8_t type)
+{
+  switch (type) {
+    case REG_BLOCK_HR:    return HOLDING_REGS_SIZE;
+    case REG_BLOCK_IR:    return INPUT_REGS_SIZE;
+    case REG_BLOCK_COILS: return COILS_SIZE * 8;
+    case REG_BLOCK_DI:    return DISCRETE_INPUTS_SIZE * 8;
+  }
+  return 0;
+}
+
+static size_t reg_block_data_len(uint8_t type, uint16_t count)
+{
+  if (type == REG_BLOCK_HR || type == REG_BLOCK_IR) return (size_t)count * 2;
+  return ((size_t)count + 7) / 8;
+}
+
+static inline void put_be16(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xFF; }
+static inline uint16_t get_be16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static inline void put_be32(uint8_t *p, uint32_t v) { put_be16(p, v >> 16); put_be16(p + 2, v & 0xFFFF); }
+static inline uint32_t get_be32(const uint8_t *p) { return ((uint32_t)get_be16(p) << 16) | get_be16(p + 2); }
+
+// Copy one range from live storage into out (header + data). Returns bytes written.
+static size_t reg_block_encode(uint8_t *out, const RegBlockRange *r, uint32_t seq, uint32_t ts)
+{
+  out[0] = REG_BLOCK_MAGIC0;
+  out[1] = REG_BLOCK_MAGIC1;
+  out[2] = REG_BLOCK_VERSION;
+  out[3] = r->type;
+  put_be16(out + 4, r->start);
+  put_be16(out + 6, r->count);
+  put_be32(out + 8, seq);
+  put_be32(out + 12, ts);
+
+  uint8_t *d = out + REG_BLOCK_HDR_SIZE;
+  size_t len = reg_block_data_len(r->type, r->count);
+
+  if (r->type == REG_BLOCK_HR || r->type == REG_BLOCK_IR) {
+    const uint16_t *src = (r->type == REG_BLOCK_HR) ? registers_get_holding_regs() : registers_get_input_regs();
+    for (uint16_t i = 0; i < r->count; i++) {
+      put_be16(d + i * 2, src[r->start + i]);
+    }
+  } else {
+    const uint8_t *src = (r->type == REG_BLOCK_COILS) ? registers_get_coils() : registers_get_discrete_inputs();
+    memset(d, 0, len);
+    for (uint16_t i = 0; i < r->count; i++) {
+      uint16_t bit = r->start + i;
+      if ((src[bit >> 3] >> (bit & 7)) & 1) d[i >> 3] |= (uint8_t)(1 << (i & 7));
+    }
+  }
+  return REG_BLOCK_HDR_SIZE + len;
+}
+
+// Snapshot all ranges under one sequence number.
+// Returns total length, or 0 if writers kept interfering.
+static size_t reg_block_snapshot(uint8_t *out, const RegBlockRange *ranges, int n)
+{
+  for (int attempt = 0; attempt < REG_BLOCK_MAX_RETRY; attempt++) {
+    uint32_t seq = registers_seq_read_begin();
+    uint32_t ts = millis();
+    size_t pos = 0;
+    for (int i = 0; i < n; i++) {
+      pos += reg_block_encode(out + pos, &ranges[i], seq, ts);
+    }
+    if (!registers_seq_read_retry(seq)) return pos;
+  }
+  return 0;
+}
+
+static bool api_wants_reg_block(httpd_req_t *req)
+{
+  return web_asset_header_match(req, "Accept", REG_BLOCK_MIME) == 1;
+}
+
+// Take a snapshot of n ranges into a heap buffer (caller frees). NULL on error (already replied).
+static uint8_t *reg_block_take(httpd_req_t *req, const RegBlockRange *ranges, int n, size_t *out_len)
+{
+  size_t total = 0;
+  for (int i = 0; i < n; i++) {
+    total += REG_BLOCK_HDR_SIZE + reg_block_data_len(ranges[i].type, ranges[i].count);
+  }
+
+  uint8_t *buf = (uint8_t *)malloc(total);
+  if (!buf) {
+    api_send_error(req, 500, "Out of memory");
+    return NULL;
+  }
+
+  *out_len = reg_block_snapshot(buf, ranges, n);
+  if (*out_len == 0) {
+    free(buf);
+    api_send_error(req, 503, "Register snapshot busy, retry");
+    return NULL;
+  }
+  return buf;
+}
+
+static esp_err_t api_send_reg_blocks(httpd_req_t *req, const RegBlockRange *ranges, int n)
+{
+  size_t len = 0;
+  uint8_t *buf = reg_block_take(req, ranges, n, &len);
+  if (!buf) return ESP_OK;
+
+  if (debug_flags_get()->http_api) {
+    debug_printf("[API] %s -> 200 OK (%u bytes binary)\n", req->uri, (unsigned)len);
+  }
+
+  httpd_resp_set_type(req, REG_BLOCK_MIME);
+  httpd_resp_set_hdr(req, "Cache-Control", "no-store, no-cache, must-revalidate");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  esp_err_t ret = httpd_resp_send(req, (const char *)buf, len);
+  free(buf);
+  http_server_stat_success();
+  return ret;
+}
+
+// Apply one binary block from the request body (same layout as a read block).
+// Header seq/timestamp are ignored; type must match the endpoint.
+static esp_err_t api_reg_block_write(httpd_req_t *req, uint8_t type)
+{
+  uint16_t cap = reg_block_capacity(type);
+  size_t max_len = REG_BLOCK_HDR_SIZE + reg_block_data_len(type, cap);
+  size_t content_len = req->content_len;
+  if (content_len < REG_BLOCK_HDR_SIZE || content_len > max_len) {
+    return api_send_error(req, 400, "Invalid block size");
+  }
+
+  uint8_t *buf = (uint8_t *)malloc(content_len);
+  if (!buf) {
+    return api_send_error(req, 500, "Out of memory");
+  }
+
+  size_t received = 0;
+  while (received < content_len) {
+    int ret = httpd_req_recv(req, (char *)buf + received, content_len - received);
+    if (ret <= 0) {
+      free(buf);
+      return api_send_error(req, 400, "Failed to read body");
+    }
+    received += ret;
+  }
+
+  uint16_t start = get_be16(buf + 4);
+  uint16_t count = get_be16(buf + 6);
+  if (buf[0] != REG_BLOCK_MAGIC0 || buf[1] != REG_BLOCK_MAGIC1 ||
+      buf[2] != REG_BLOCK_VERSION || buf[3] != type) {
+    free(buf);
+    return api_send_error(req, 400, "Invalid block header");
+  }
+  if (count == 0 || (uint32_t)start + count > cap ||
+      content_len != REG_BLOCK_HDR_SIZE + reg_block_data_len(type, count)) {
+    free(buf);
+    return api_send_error(req, 400, "Block range/length mismatch");
+  }
+
+  const uint8_t *d = buf + REG_BLOCK_HDR_SIZE;
+  for (uint16_t i = 0; i < count; i++) {
+    if (type == REG_BLOCK_HR) {
+      registers_set_holding_register(start + i, get_be16(d + i * 2));
+    } else {
+      registers_set_coil(start + i, (d[i >> 3] >> (i & 7)) & 1);
+    }
+  }
+  free(buf);
+
+  char resp[96];
+  snprintf(resp, sizeof(resp), "{\"status\":200,\"written\":%u,\"seq\":%lu}",
+           count, (unsigned long)registers_get_write_seq());
+  return api_send_json(req, resp);
+}
+
 esp_err_t api_handler_hr_bulk_read(httpd_req_t *req)
 {
   http_server_stat_request();
   CHECK_AUTH(req);
 
+  bool binary = api_wants_reg_block(req);
+
   int start = api_parse_query_int(req, "start", 0);
   int count = api_parse_query_int(req, "count", 10);
 
   if (start < 0 || start >= HOLDING_REGS_SIZE) {
     return api_send_error(req, 400, "Invalid start address");
   }
-  if (count < 1 || count > 200) {
+  if (count < 1 || (!binary && count > 200)) {
     return api_send_error(req, 400, "Count must be 1-200");
   }
   if (start + count > HOLDING_REGS_SIZE) {
     count = HOLDING_REGS_SIZE - start;
   }
 
+  if (binary) {
+    RegBlockRange r = { REG_BLOCK_HR, (uint16_t)start, (uint16_t)count };
+    return api_send_reg_blocks(req, &r, 1);
+  }
+
   // Allocate on heap: ~25 bytes per register entry in JSON
   size_t buf_size = (size_t)count * 30 + 128;
   char *buf = (char *)malloc(buf_size);
@@ -5251,6 +5846,10 @@ esp_err_t api_handler_hr_bulk_write(httpd_req_t *req)
   http_server_stat_request();
   CHECK_AUTH_WRITE(req);
 
+  if (web_asset_header_match(req, "Content-Type", REG_BLOCK_MIME) == 1) {
+    return api_reg_block_write(req, REG_BLOCK_HR);
+  }
+
   char *body = (char *)malloc(2048);
   if (!body) {
     return api_send_error(req, 500, "Out of memory");
@@ -5298,19 +5897,26 @@ esp_err_t api_handler_ir_bulk_read(httpd_req_t *req)
   http_server_stat_request();
   CHECK_AUTH(req);
 
+  bool binary = api_wants_reg_block(req);
+
   int start = api_parse_query_int(req, "start", 0);
   int count = api_parse_query_int(req, "count", 10);
 
   if (start < 0 || start >= INPUT_REGS_SIZE) {
     return api_send_error(req, 400, "Invalid start address");
   }
-  if (count < 1 || count > 200) {
+  if (count < 1 || (!binary && count > 200)) {
     return api_send_error(req, 400, "Count must be 1-200");
   }
   if (start + count > INPUT_REGS_SIZE) {
     count = INPUT_REGS_SIZE - start;
   }
 
+  if (binary) {
+    RegBlockRange r = { REG_BLOCK_IR, (uint16_t)start, (uint16_t)count };
+    return api_send_reg_blocks(req, &r, 1);
+  }
+
   size_t buf_size = (size_t)count * 30 + 128;
   char *buf = (char *)malloc(buf_size);
   if (!buf) {
@@ -5339,6 +5945,8 @@ esp_err_t api_handler_coils_bulk_read(httpd_req_t *req)
   http_server_stat_request();
   CHECK_AUTH(req);
 
+  bool binary = api_wants_reg_block(req);
+
   int start = api_parse_query_int(req, "start", 0);
   int count = api_parse_query_int(req, "count", 32);
 
@@ -5352,6 +5960,11 @@ esp_err_t api_handler_coils_bulk_read(httpd_req_t *req)
     count = 256 - start;
   }
 
+  if (binary) {
+    RegBlockRange r = { REG_BLOCK_COILS, (uint16_t)start, (uint16_t)count };
+    return api_send_reg_blocks(req, &r, 1);
+  }
+
   size_t buf_size = (size_t)count * 28 + 128;
   char *buf = (char *)malloc(buf_size);
   if (!buf) {
@@ -5380,6 +5993,10 @@ esp_err_t api_handler_coils_bulk_write(httpd_req_t *req)
   http_server_stat_request();
   CHECK_AUTH_WRITE(req);
 
+  if (web_asset_header_match(req, "Content-Type", REG_BLOCK_MIME) == 1) {
+    return api_reg_block_write(req, REG_BLOCK_COILS);
+  }
+
   char *body = (char *)malloc(2048);
   if (!body) {
     return api_send_error(req, 500, "Out of memory");
@@ -5427,6 +6044,8 @@ esp_err_t api_handler_di_bulk_read(httpd_req_t *req)
   http_server_stat_request();
   CHECK_AUTH(req);
 
+  bool binary = api_wants_reg_block(req);
+
   int start = api_parse_query_int(req, "start", 0);
   int count = api_parse_query_int(req, "count", 32);
 
@@ -5440,6 +6059,11 @@ esp_err_t api_handler_di_bulk_read(httpd_req_t *req)
     count = 256 - start;
   }
 
+  if (binary) {
+    RegBlockRange r = { REG_BLOCK_DI, (uint16_t)start, (uint16_t)count };
+    return api_send_reg_blocks(req, &r, 1);
+  }
+
   size_t buf_size = (size_t)count * 28 + 128;
   char *buf = (char *)malloc(buf_size);
   if (!buf) {
@@ -5460,34 +6084,254 @@ esp_err_t api_handler_di_bulk_read(httpd_req_t *req)
 }
 
 /* ============================================================================
- * FEAT-020: ST Logic Debug API — suffix routing via /api/logic/{id}/debug/*
+ * FEAT-152: Multi-range read — GET /api/registers/multi
+ *   ?hr=start:count&ir=start:count&coils=start:count&di=start:count
+ * Any subset of the four ranges; all are taken under one sequence number.
  * ============================================================================ */
 
-esp_err_t api_handler_logic_debug(httpd_req_t *req)
+esp_err_t api_handler_registers_multi(httpd_req_t *req)
 {
   http_server_stat_request();
   CHECK_AUTH(req);
 
-  // Parse: /api/logic/{id}/debug/{action}
-  const char *uri = req->uri;
-  int id = api_extract_id_from_uri(req, "/api/logic/");
-  if (id < 1 || id > ST_LOGIC_MAX_PROGRAMS) {
-    return api_send_error(req, 400, "Invalid program ID (must be 1-4)");
+  static const struct { const char *key; uint8_t type; } keys[REG_BLOCK_MAX_RANGES] = {
+    {"hr", REG_BLOCK_HR}, {"ir", REG_BLOCK_IR}, {"coils", REG_BLOCK_COILS}, {"di", REG_BLOCK_DI}
+  };
+
+  char qstr[128];
+  if (httpd_req_get_url_query_str(req, qstr, sizeof(qstr)) != ESP_OK) {
+    return api_send_error(req, 400, "No ranges (use hr=, ir=, coils=, di= as start:count)");
   }
 
-  st_logic_engine_state_t *st = st_logic_get_state();
-  st_debug_state_t *dbg = &st->debugger[id - 1];
+  RegBlockRange ranges[REG_BLOCK_MAX_RANGES];
+  int n = 0;
+  for (int k = 0; k < REG_BLOCK_MAX_RANGES; k++) {
+    char val[16];
+    if (httpd_query_key_value(qstr, keys[k].key, val, sizeof(val)) != ESP_OK) continue;
 
-  // Find /debug/ suffix
-  const char *debug_pos = strstr(uri, "/debug/");
-  if (!debug_pos) {
-    return api_send_error(req, 400, "Missing debug action");
+    char *colon = strchr(val, ':');
+    int start = atoi(val);
+    int count = colon ? atoi(colon + 1) : 0;
+    int cap = reg_block_capacity(keys[k].type);
+    if (!colon || start < 0 || start >= cap || count < 1) {
+      return api_send_error(req, 400, "Invalid range (expected start:count)");
+    }
+    if (start + count > cap) count = cap - start;
+
+    ranges[n].type = keys[k].type;
+    ranges[n].start = (uint16_t)start;
+    ranges[n].count = (uint16_t)count;
+    n++;
+  }
+  if (n == 0) {
+    return api_send_error(req, 400, "No ranges (use hr=, ir=, coils=, di= as start:count)");
   }
-  const char *action = debug_pos + 7; // skip "/debug/"
 
-  // Strip query params
-  char action_buf[32];
-  int ai = 0;
+  if (api_wants_reg_block(req)) {
+    return api_send_reg_blocks(req, ranges, n);
+  }
+
+  // JSON: render from the binary snapshot so both formats are equally consistent
+  size_t snap_len = 0;
+  uint8_t *snap = reg_block_take(req, ranges, n, &snap_len);
+  if (!snap) return ESP_OK;
+
+  size_t buf_size = 128;
+  for (int i = 0; i < n; i++) {
+    bool regs = (ranges[i].type == REG_BLOCK_HR || ranges[i].type == REG_BLOCK_IR);
+    buf_size += 48 + (size_t)ranges[i].count * (regs ? 6 : 2);
+  }
+  char *buf = (char *)malloc(buf_size);
+  if (!buf) {
+    free(snap);
+    return api_send_error(req, 500, "Out of memory");
+  }
+
+  const uint8_t *p = snap;
+  int pos = snprintf(buf, buf_size, "{\"seq\":%lu,\"uptime_ms\":%lu",
+                     (unsigned long)get_be32(p + 8), (unsigned long)get_be32(p + 12));
+  for (int i = 0; i < n; i++) {
+    const RegBlockRange *r = &ranges[i];
+    const uint8_t *d = p + REG_BLOCK_HDR_SIZE;
+    pos += snprintf(buf + pos, buf_size - pos, ",\"%s\":{\"start\":%u,\"values\":[",
+                    keys[r->type - 1].key, r->start);
+    for (uint16_t j = 0; j < r->count; j++) {
+      if (j > 0) buf[pos++] = ',';
+      if (r->type == REG_BLOCK_HR || r->type == REG_BLOCK_IR) {
+        pos += snprintf(buf + pos, buf_size - pos, "%u", get_be16(d + j * 2));
+      } else {
+        buf[pos++] = ((d[j >> 3] >> (j & 7)) & 1) ? '1' : '0';
+      }
+    }
+    pos += snprintf(buf + pos, buf_size - pos, "]}");
+    p = d + reg_block_data_len(r->type, r->count);
+  }
+  snprintf(buf + pos, buf_size - pos, "}");
+  free(snap);
+
+  esp_err_t ret = api_send_json(req, buf);
+  free(buf);
+  return ret;
+}
+
+/* ============================================================================
+ * FEAT-156: Edge timestamp stream — GET /api/counters/{id}/edges
+ *
+ * Pull stream over the counter's edge ring: the client passes the "next"
+ * value of the previous reply as ?since= and gets every edge captured since,
+ * plus how many were overwritten before it asked. Without ?since= the reply
+ * starts at the oldest edge still in the ring. The first request enables
+ * capture (SW_ISR mode only).
+ *
+ * Binary reply (Accept: application/octet-stream), big-endian:
+ *   [0..1]   magic 'E','D'
+ *   [2]      version (1)
+ *   [3]      counter id
+ *   [4..7]   edge number of the first timestamp
+ *   [8..11]  count
+ *   [12..15] edges lost before the first timestamp
+ * followed by count x uint32 micros() timestamps.
+ * ============================================================================ */
+
+#define EDGE_BLOCK_HDR_SIZE   16
+#define EDGE_STREAM_CHUNK     64      // Timestamps per read/send chunk
+
+static bool api_parse_query_u32(httpd_req_t *req, const char *key, uint32_t *out)
+{
+  char qstr[128];
+  if (httpd_req_get_url_query_str(req, qstr, sizeof(qstr)) != ESP_OK) return false;
+  char val[16];
+  if (httpd_query_key_value(qstr, key, val, sizeof(val)) != ESP_OK) return false;
+  char *end = NULL;
+  unsigned long v = strtoul(val, &end, 10);
+  if (end == val || *end != '\0') return false;
+  *out = (uint32_t)v;
+  return true;
+}
+
+static esp_err_t api_handler_counter_edges_get(httpd_req_t *req)
+{
+  http_server_stat_request();
+  CHECK_AUTH(req);
+
+  int id = api_extract_id_from_uri(req, "/api/counters/");
+  if (id < 1 || id > COUNTER_COUNT) {
+    return api_send_error(req, 400, "Invalid counter ID (must be 1-4)");
+  }
+
+  CounterConfig cfg;
+  if (!counter_engine_get_config(id, &cfg)) {
+    return api_send_error(req, 404, "Counter not found");
+  }
+  if (cfg.hw_mode != COUNTER_HW_SW_ISR) {
+    return api_send_error(req, 409, "Edge capture requires SW_ISR mode");
+  }
+  if (!counter_sw_isr_edges_enable(id)) {
+    return api_send_error(req, 500, "Out of memory");
+  }
+
+  uint32_t tail = 0, head = 0;
+  counter_sw_isr_edges_window(id, &tail, &head);
+
+  uint32_t cursor = tail;
+  api_parse_query_u32(req, "since", &cursor);
+  uint32_t max = COUNTER_EDGE_RING_SIZE;
+  if (api_parse_query_u32(req, "max", &max) && (max < 1 || max > COUNTER_EDGE_RING_SIZE)) {
+    return api_send_error(req, 400, "max out of range (1 to ring size)");
+  }
+
+  // Take the whole reply from the ring first so header and body agree
+  uint32_t *stamps = (uint32_t *)malloc(max * sizeof(uint32_t));
+  if (!stamps) {
+    return api_send_error(req, 500, "Out of memory");
+  }
+  uint32_t lost = 0, n = 0;
+  while (n < max) {
+    uint32_t want = max - n;
+    if (want > EDGE_STREAM_CHUNK) want = EDGE_STREAM_CHUNK;
+    uint32_t got = counter_sw_isr_edges_read(id, &cursor, stamps + n, want, &lost);
+    if (got == 0) break;
+    n += got;
+  }
+  uint32_t first = cursor - n;
+
+  httpd_resp_set_hdr(req, "Cache-Control", "no-store, no-cache, must-revalidate");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+  if (api_wants_reg_block(req)) {
+    uint8_t hdr[EDGE_BLOCK_HDR_SIZE];
+    hdr[0] = 'E';
+    hdr[1] = 'D';
+    hdr[2] = 1;
+    hdr[3] = (uint8_t)id;
+    put_be32(hdr + 4, first);
+    put_be32(hdr + 8, n);
+    put_be32(hdr + 12, lost);
+    httpd_resp_set_type(req, REG_BLOCK_MIME);
+    httpd_resp_send_chunk(req, (const char *)hdr, sizeof(hdr));
+    for (uint32_t i = 0; i < n; i++) {
+      put_be32((uint8_t *)&stamps[i], stamps[i]);  // In place: each slot is read once
+    }
+    for (uint32_t i = 0; i < n; i += EDGE_STREAM_CHUNK) {
+      uint32_t len = (n - i < EDGE_STREAM_CHUNK) ? n - i : EDGE_STREAM_CHUNK;
+      httpd_resp_send_chunk(req, (const char *)(stamps + i), len * sizeof(uint32_t));
+    }
+  } else {
+    char chunk[EDGE_STREAM_CHUNK * 11 + 128];
+    int pos = snprintf(chunk, sizeof(chunk),
+                       "{\"id\":%d,\"first\":%lu,\"next\":%lu,\"head\":%lu,\"lost\":%lu,\"count\":%lu,\"edges_us\":[",
+                       id, (unsigned long)first, (unsigned long)cursor, (unsigned long)head,
+                       (unsigned long)lost, (unsigned long)n);
+    httpd_resp_set_type(req, "application/json");
+    for (uint32_t i = 0; i < n; i++) {
+      pos += snprintf(chunk + pos, sizeof(chunk) - pos, i ? ",%lu" : "%lu", (unsigned long)stamps[i]);
+      if (pos > (int)sizeof(chunk) - 16) {
+        httpd_resp_send_chunk(req, chunk, pos);
+        pos = 0;
+      }
+    }
+    pos += snprintf(chunk + pos, sizeof(chunk) - pos, "]}");
+    httpd_resp_send_chunk(req, chunk, pos);
+  }
+  httpd_resp_send_chunk(req, NULL, 0);
+  free(stamps);
+
+  if (debug_flags_get()->http_api) {
+    debug_printf("[API] %s -> 200 OK (%lu edges)\n", req->uri, (unsigned long)n);
+  }
+  http_server_stat_success();
+  return ESP_OK;
+}
+
+/* ============================================================================
+ * FEAT-020: ST Logic Debug API — suffix routing via /api/logic/{id}/debug/*
+ * ============================================================================ */
+
+esp_err_t api_handler_logic_debug(httpd_req_t *req)
+{
+  http_server_stat_request();
+  CHECK_AUTH(req);
+
+  // Parse: /api/logic/{id}/debug/{action}
+  const char *uri = req->uri;
+  int id = api_extract_id_from_uri(req, "/api/logic/");
+  if (id < 1 || id > ST_LOGIC_MAX_PROGRAMS) {
+    return api_send_error(req, 400, "Invalid program ID (must be 1-4)");
+  }
+
+  st_logic_engine_state_t *st = st_logic_get_state();
+  st_debug_state_t *dbg = &st->debugger[id - 1];
+
+  // Find /debug/ suffix
+  const char *debug_pos = strstr(uri, "/debug/");
+  if (!debug_pos) {
+    return api_send_error(req, 400, "Missing debug action");
+  }
+  const char *action = debug_pos + 7; // skip "/debug/"
+
+  // Strip query params
+  char action_buf[32];
+  int ai = 0;
   while (*action && *action != '?' && ai < 31) {
     action_buf[ai++] = *action++;
   }
@@ -5714,8 +6558,112 @@ esp_err_t api_handler_api_version(httpd_req_t *req)
  *
  * Returns metrics in Prometheus text exposition format (text/plain).
  * Scrape-ready for Prometheus/Grafana integration.
+ *
+ * FEAT-149 (v7.9.8.0): Output is streamed as HTTP chunks from a small stack
+ * buffer instead of a 12 KB heap buffer, so scrapes keep working on a
+ * fragmented heap. Optional ?families=modbus,st limits the output to the
+ * named metric families (default: all).
  * ============================================================================ */
 
+#define PROM_CHUNK_SIZE     1024   // Stack buffer, flushed as one HTTP chunk
+
+#define PROM_FAM_SYSTEM     0x0001  // uptime, heap, flash, psram, watchdog, tasks, firmware
+#define PROM_FAM_HTTP       0x0002
+#define PROM_FAM_MODBUS     0x0004  // slave/master config + stats, async cache
+#define PROM_FAM_NETWORK    0x0008  // wifi, ethernet, telnet, sse
+#define PROM_FAM_COUNTER    0x0010
+#define PROM_FAM_TIMER      0x0020
+#define PROM_FAM_ST         0x0040
+#define PROM_FAM_GPIO       0x0080
+#define PROM_FAM_REGISTERS  0x0100  // non-zero HR/IR dump (largest family)
+#define PROM_FAM_PERSIST    0x0200
+#define PROM_FAM_NTP        0x0400
+#define PROM_FAM_ALARM      0x0800
+#define PROM_FAM_HISTORY    0x1000
+#define PROM_FAM_ALL        0x1FFF
+
+static const struct {
+  const char *name;
+  uint16_t    mask;
+} prom_families[] = {
+  {"system",    PROM_FAM_SYSTEM},
+  {"http",      PROM_FAM_HTTP},
+  {"modbus",    PROM_FAM_MODBUS},
+  {"network",   PROM_FAM_NETWORK},
+  {"counter",   PROM_FAM_COUNTER},
+  {"timer",     PROM_FAM_TIMER},
+  {"st",        PROM_FAM_ST},
+  {"gpio",      PROM_FAM_GPIO},
+  {"registers", PROM_FAM_REGISTERS},
+  {"persist",   PROM_FAM_PERSIST},
+  {"ntp",       PROM_FAM_NTP},
+  {"alarm",     PROM_FAM_ALARM},
+  {"history",   PROM_FAM_HISTORY},
+};
+
+typedef struct {
+  httpd_req_t *req;
+  int          pos;
+  esp_err_t    err;                  // First send error; later output is dropped
+  char         buf[PROM_CHUNK_SIZE];
+} prom_writer_t;
+
+static void prom_flush(prom_writer_t *w)
+{
+  if (w->pos > 0 && w->err == ESP_OK) {
+    w->err = httpd_resp_send_chunk(w->req, w->buf, w->pos);
+  }
+  w->pos = 0;
+}
+
+static void prom_printf(prom_writer_t *w, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void prom_printf(prom_writer_t *w, const char *fmt, ...)
+{
+  if (w->err != ESP_OK) return;
+
+  // Format directly into the buffer; if the line doesn't fit, flush and retry once.
+  // A single line larger than the whole buffer is dropped (never emitted truncated).
+  for (int attempt = 0; attempt < 2; attempt++) {
+    int remaining = PROM_CHUNK_SIZE - w->pos;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(w->buf + w->pos, remaining, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if (n < remaining) {
+      w->pos += n;
+      return;
+    }
+    if (w->pos == 0) return;
+    prom_flush(w);
+  }
+}
+
+// Parse "?families=modbus,st" into a PROM_FAM_* mask.
+// Returns PROM_FAM_ALL if absent, 0 if any name is unknown.
+static uint16_t prom_parse_families(httpd_req_t *req)
+{
+  char qstr[192];
+  char val[160];
+  if (httpd_req_get_url_query_str(req, qstr, sizeof(qstr)) != ESP_OK) return PROM_FAM_ALL;
+  if (httpd_query_key_value(qstr, "families", val, sizeof(val)) != ESP_OK) return PROM_FAM_ALL;
+
+  uint16_t mask = 0;
+  char *save = NULL;
+  for (char *tok = strtok_r(val, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+    bool found = false;
+    for (size_t i = 0; i < sizeof(prom_families) / sizeof(prom_families[0]); i++) {
+      if (strcasecmp(tok, prom_families[i].name) == 0) {
+        mask |= prom_families[i].mask;
+        found = true;
+        break;
+      }
+    }
+    if (!found) return 0;
+  }
+  return mask;
+}
+
 esp_err_t api_handler_metrics(httpd_req_t *req)
 {
   http_server_stat_request();
@@ -5725,503 +6673,706 @@ esp_err_t api_handler_metrics(httpd_req_t *req)
     return api_send_error(req, 429, "Too many requests");
   }
 
-  // Buffer for Prometheus text format (12KB for expanded metrics incl. tasks/cache)
-  char *buf = (char *)malloc(12288);
-  if (!buf) {
-    return api_send_error(req, 500, "Out of memory");
+  uint16_t families = prom_parse_families(req);
+  if (families == 0) {
+    return api_send_error(req, 400, "Unknown metric family");
   }
-  int pos = 0;
-  int remaining = 12288;
-
-  #define PROM_APPEND(...) do { \
-    int n = snprintf(buf + pos, remaining, __VA_ARGS__); \
-    if (n > 0 && n < remaining) { pos += n; remaining -= n; } \
-  } while(0)
 
-  // --- System metrics ---
-  PROM_APPEND("# HELP esp32_uptime_seconds Device uptime in seconds\n");
-  PROM_APPEND("# TYPE esp32_uptime_seconds gauge\n");
-  PROM_APPEND("esp32_uptime_seconds %lu\n", (unsigned long)(millis() / 1000));
-
-  PROM_APPEND("# HELP esp32_heap_free_bytes Free heap memory in bytes\n");
-  PROM_APPEND("# TYPE esp32_heap_free_bytes gauge\n");
-  PROM_APPEND("esp32_heap_free_bytes %lu\n", (unsigned long)ESP.getFreeHeap());
-
-  PROM_APPEND("# HELP esp32_heap_min_free_bytes Minimum free heap since boot\n");
-  PROM_APPEND("# TYPE esp32_heap_min_free_bytes gauge\n");
-  PROM_APPEND("esp32_heap_min_free_bytes %lu\n", (unsigned long)ESP.getMinFreeHeap());
-
-  // --- Flash chip metrics ---
-  PROM_APPEND("# HELP esp32_flash_total_bytes Total flash size (from eFuse) in bytes\n");
-  PROM_APPEND("# TYPE esp32_flash_total_bytes gauge\n");
-  PROM_APPEND("esp32_flash_total_bytes %lu\n", (unsigned long)ESP.getFlashChipSize());
-  PROM_APPEND("# HELP esp32_flash_speed_hz Flash access speed in Hz\n");
-  PROM_APPEND("# TYPE esp32_flash_speed_hz gauge\n");
-  PROM_APPEND("esp32_flash_speed_hz %lu\n", (unsigned long)ESP.getFlashChipSpeed());
-
-  // --- PSRAM metrics (if available) ---
-  uint32_t psram_total = ESP.getPsramSize();
-  if (psram_total > 0) {
-    PROM_APPEND("# HELP esp32_psram_total_bytes Total PSRAM in bytes\n");
-    PROM_APPEND("# TYPE esp32_psram_total_bytes gauge\n");
-    PROM_APPEND("esp32_psram_total_bytes %lu\n", (unsigned long)psram_total);
-    PROM_APPEND("# HELP esp32_psram_free_bytes Free PSRAM in bytes\n");
-    PROM_APPEND("# TYPE esp32_psram_free_bytes gauge\n");
-    PROM_APPEND("esp32_psram_free_bytes %lu\n", (unsigned long)ESP.getFreePsram());
-  }
-
-  // --- HTTP API metrics ---
-  const HttpServerStats *stats = http_server_get_stats();
-  if (stats) {
-    PROM_APPEND("# HELP http_requests_total Total HTTP API requests\n");
-    PROM_APPEND("# TYPE http_requests_total counter\n");
-    PROM_APPEND("http_requests_total %lu\n", stats->total_requests);
-
-    PROM_APPEND("# HELP http_requests_success_total Successful HTTP responses (2xx)\n");
-    PROM_APPEND("# TYPE http_requests_success_total counter\n");
-    PROM_APPEND("http_requests_success_total %lu\n", stats->successful_requests);
-
-    PROM_APPEND("# HELP http_requests_client_errors_total Client error responses (4xx)\n");
-    PROM_APPEND("# TYPE http_requests_client_errors_total counter\n");
-    PROM_APPEND("http_requests_client_errors_total %lu\n", stats->client_errors);
-
-    PROM_APPEND("# HELP http_requests_server_errors_total Server error responses (5xx)\n");
-    PROM_APPEND("# TYPE http_requests_server_errors_total counter\n");
-    PROM_APPEND("http_requests_server_errors_total %lu\n", stats->server_errors);
-
-    PROM_APPEND("# HELP http_auth_failures_total Authentication failures\n");
-    PROM_APPEND("# TYPE http_auth_failures_total counter\n");
-    PROM_APPEND("http_auth_failures_total %lu\n", stats->auth_failures);
-  }
-
-  // --- Modbus Slave config metrics ---
-  PROM_APPEND("# HELP modbus_slave_config_enabled Modbus slave enabled (1=yes, 0=no)\n");
-  PROM_APPEND("# TYPE modbus_slave_config_enabled gauge\n");
-  PROM_APPEND("modbus_slave_config_enabled %d\n", g_persist_config.modbus_slave.enabled ? 1 : 0);
-  PROM_APPEND("# HELP modbus_slave_config_id Modbus slave ID\n");
-  PROM_APPEND("# TYPE modbus_slave_config_id gauge\n");
-  PROM_APPEND("modbus_slave_config_id %d\n", g_persist_config.modbus_slave.slave_id);
-  PROM_APPEND("# HELP modbus_slave_config_baudrate Modbus slave baudrate\n");
-  PROM_APPEND("# TYPE modbus_slave_config_baudrate gauge\n");
-  PROM_APPEND("modbus_slave_config_baudrate %lu\n", (unsigned long)g_persist_config.modbus_slave.baudrate);
-  PROM_APPEND("# HELP modbus_slave_config_parity Modbus slave parity (0=N, 1=E, 2=O)\n");
-  PROM_APPEND("# TYPE modbus_slave_config_parity gauge\n");
-  PROM_APPEND("modbus_slave_config_parity %d\n", g_persist_config.modbus_slave.parity);
-  PROM_APPEND("# HELP modbus_slave_config_stopbits Modbus slave stop bits\n");
-  PROM_APPEND("# TYPE modbus_slave_config_stopbits gauge\n");
-  PROM_APPEND("modbus_slave_config_stopbits %d\n", g_persist_config.modbus_slave.stop_bits);
-
-  // --- Modbus Slave metrics ---
-  PROM_APPEND("# HELP modbus_slave_requests_total Total Modbus slave requests\n");
-  PROM_APPEND("# TYPE modbus_slave_requests_total counter\n");
-  PROM_APPEND("modbus_slave_requests_total %lu\n", g_persist_config.modbus_slave.total_requests);
-
-  PROM_APPEND("# HELP modbus_slave_success_total Successful Modbus slave responses\n");
-  PROM_APPEND("# TYPE modbus_slave_success_total counter\n");
-  PROM_APPEND("modbus_slave_success_total %lu\n", g_persist_config.modbus_slave.successful_requests);
-
-  PROM_APPEND("# HELP modbus_slave_crc_errors_total Modbus slave CRC errors\n");
-  PROM_APPEND("# TYPE modbus_slave_crc_errors_total counter\n");
-  PROM_APPEND("modbus_slave_crc_errors_total %lu\n", g_persist_config.modbus_slave.crc_errors);
-
-  PROM_APPEND("# HELP modbus_slave_exceptions_total Modbus slave exception responses\n");
-  PROM_APPEND("# TYPE modbus_slave_exceptions_total counter\n");
-  PROM_APPEND("modbus_slave_exceptions_total %lu\n", g_persist_config.modbus_slave.exception_errors);
-
-  // --- Heap detailed metrics ---
-  PROM_APPEND("# HELP esp32_heap_largest_free_block Largest contiguous free heap block\n");
-  PROM_APPEND("# TYPE esp32_heap_largest_free_block gauge\n");
-  PROM_APPEND("esp32_heap_largest_free_block %lu\n", (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
-
-  // --- Modbus Master config metrics ---
-  PROM_APPEND("# HELP modbus_master_config_enabled Modbus master enabled (1=yes, 0=no)\n");
-  PROM_APPEND("# TYPE modbus_master_config_enabled gauge\n");
-  PROM_APPEND("modbus_master_config_enabled %d\n", g_modbus_master_config.enabled ? 1 : 0);
-  PROM_APPEND("# HELP modbus_master_config_baudrate Modbus master baudrate\n");
-  PROM_APPEND("# TYPE modbus_master_config_baudrate gauge\n");
-  PROM_APPEND("modbus_master_config_baudrate %lu\n", (unsigned long)g_modbus_master_config.baudrate);
-  PROM_APPEND("# HELP modbus_master_config_parity Modbus master parity (0=N, 1=E, 2=O)\n");
-  PROM_APPEND("# TYPE modbus_master_config_parity gauge\n");
-  PROM_APPEND("modbus_master_config_parity %d\n", g_modbus_master_config.parity);
-  PROM_APPEND("# HELP modbus_master_config_stopbits Modbus master stop bits\n");
-  PROM_APPEND("# TYPE modbus_master_config_stopbits gauge\n");
-  PROM_APPEND("modbus_master_config_stopbits %d\n", g_modbus_master_config.stop_bits);
-
-  // --- Modbus Master metrics ---
-  PROM_APPEND("# HELP modbus_master_stats_age_ms Milliseconds since last stats reset\n");
-  PROM_APPEND("# TYPE modbus_master_stats_age_ms gauge\n");
-  PROM_APPEND("modbus_master_stats_age_ms %lu\n",
-    g_modbus_master_config.stats_since_ms > 0 ? (unsigned long)(millis() - g_modbus_master_config.stats_since_ms) : (unsigned long)millis());
-
-  PROM_APPEND("# HELP modbus_master_requests_total Total Modbus master requests\n");
-  PROM_APPEND("# TYPE modbus_master_requests_total counter\n");
-  PROM_APPEND("modbus_master_requests_total %lu\n", g_modbus_master_config.total_requests);
-
-  PROM_APPEND("# HELP modbus_master_success_total Successful Modbus master responses\n");
-  PROM_APPEND("# TYPE modbus_master_success_total counter\n");
-  PROM_APPEND("modbus_master_success_total %lu\n", g_modbus_master_config.successful_requests);
-
-  PROM_APPEND("# HELP modbus_master_timeout_errors_total Modbus master timeout errors\n");
-  PROM_APPEND("# TYPE modbus_master_timeout_errors_total counter\n");
-  PROM_APPEND("modbus_master_timeout_errors_total %lu\n", g_modbus_master_config.timeout_errors);
-
-  PROM_APPEND("# HELP modbus_master_crc_errors_total Modbus master CRC errors\n");
-  PROM_APPEND("# TYPE modbus_master_crc_errors_total counter\n");
-  PROM_APPEND("modbus_master_crc_errors_total %lu\n", g_modbus_master_config.crc_errors);
-
-  PROM_APPEND("# HELP modbus_master_exception_errors_total Modbus master exception errors\n");
-  PROM_APPEND("# TYPE modbus_master_exception_errors_total counter\n");
-  PROM_APPEND("modbus_master_exception_errors_total %lu\n", g_modbus_master_config.exception_errors);
-
-  // --- Modbus Master Async Cache metrics ---
-  const mb_async_state_t *mb_async = mb_async_get_state();
-  if (mb_async && mb_async->task_running) {
-    PROM_APPEND("# HELP modbus_master_cache_hits Async cache hit count\n");
-    PROM_APPEND("# TYPE modbus_master_cache_hits counter\n");
-    PROM_APPEND("modbus_master_cache_hits %lu\n", (unsigned long)mb_async->cache_hits);
-    PROM_APPEND("# HELP modbus_master_cache_misses Async cache miss count\n");
-    PROM_APPEND("# TYPE modbus_master_cache_misses counter\n");
-    PROM_APPEND("modbus_master_cache_misses %lu\n", (unsigned long)mb_async->cache_misses);
-    PROM_APPEND("# HELP modbus_master_cache_entries Active cache entries\n");
-    PROM_APPEND("# TYPE modbus_master_cache_entries gauge\n");
-    PROM_APPEND("modbus_master_cache_entries %d\n", mb_async->entry_count);
-    PROM_APPEND("# HELP modbus_master_queue_full_count Queue full rejections\n");
-    PROM_APPEND("# TYPE modbus_master_queue_full_count counter\n");
-    PROM_APPEND("modbus_master_queue_full_count %lu\n", (unsigned long)mb_async->queue_full_count);
-    PROM_APPEND("# HELP modbus_master_queue_depth Current queue depth\n");
-    PROM_APPEND("# TYPE modbus_master_queue_depth gauge\n");
-    PROM_APPEND("modbus_master_queue_depth %u\n", (unsigned)mb_async->pq_count);
-    PROM_APPEND("# HELP modbus_master_queue_hwm Queue high watermark\n");
-    PROM_APPEND("# TYPE modbus_master_queue_hwm gauge\n");
-    PROM_APPEND("modbus_master_queue_hwm %u\n", (unsigned)mb_async->queue_high_watermark);
-    PROM_APPEND("# HELP modbus_master_priority_drops Requests dropped by priority eviction\n");
-    PROM_APPEND("# TYPE modbus_master_priority_drops counter\n");
-    PROM_APPEND("modbus_master_priority_drops %lu\n", (unsigned long)mb_async->priority_drops);
-    PROM_APPEND("# HELP modbus_master_cache_hit_rate Cache hit rate percent\n");
-    PROM_APPEND("# TYPE modbus_master_cache_hit_rate gauge\n");
-    {
-      uint32_t total_lookups = mb_async->cache_hits + mb_async->cache_misses;
-      uint8_t hit_pct = total_lookups > 0 ? (uint8_t)(mb_async->cache_hits * 100 / total_lookups) : 0;
-      PROM_APPEND("modbus_master_cache_hit_rate %u\n", hit_pct);
-    }
-    PROM_APPEND("# HELP modbus_master_cache_utilization Cache slot utilization percent\n");
-    PROM_APPEND("# TYPE modbus_master_cache_utilization gauge\n");
-    PROM_APPEND("modbus_master_cache_utilization %u\n",
-                (unsigned)(mb_async->entry_count * 100 / MB_CACHE_MAX_ENTRIES));
-    PROM_APPEND("# HELP modbus_master_cache_ttl_ms Cache entry TTL in ms (0=never expire)\n");
-    PROM_APPEND("# TYPE modbus_master_cache_ttl_ms gauge\n");
-    PROM_APPEND("modbus_master_cache_ttl_ms %u\n", (unsigned)g_modbus_master_config.cache_ttl_ms);
-
-    // Per-slave cache entries with status
-    PROM_APPEND("# HELP modbus_master_slave_status Per-slave cache entry status\n");
-    PROM_APPEND("# TYPE modbus_master_slave_status gauge\n");
-    for (int i = 0; i < mb_async->entry_count && i < MB_CACHE_MAX_ENTRIES; i++) {
-      const mb_cache_entry_t *e = &mb_async->entries[i];
-      if (e->status != MB_CACHE_EMPTY) {
-        const char *st = (e->status == MB_CACHE_VALID) ? "valid" :
-                         (e->status == MB_CACHE_PENDING) ? "pending" :
-                         (e->status == MB_CACHE_ERROR) ? "error" : "empty";
-        uint32_t age_ms = (e->last_update_ms > 0) ? (millis() - e->last_update_ms) : 0;
-        uint8_t disp_fc = (e->last_fc > 0) ? e->last_fc : e->key.req_type;
-        PROM_APPEND("modbus_master_slave_status{slave=\"%d\",addr=\"%d\",fc=\"%d\",status=\"%s\",age_ms=\"%u\"} %d\n",
-                     e->key.slave_id, e->key.address, disp_fc, st, age_ms,
-                     (e->status == MB_CACHE_VALID) ? 1 : (e->status == MB_CACHE_ERROR) ? -1 : 0);
-      }
-    }
-    // Per-slave adaptive backoff status
-    PROM_APPEND("# HELP modbus_master_slave_backoff Per-slave adaptive backoff delay in ms\n");
-    PROM_APPEND("# TYPE modbus_master_slave_backoff gauge\n");
-    for (int i = 0; i < MB_SLAVE_BACKOFF_MAX; i++) {
-      if (mb_async->slave_backoff[i].slave_id > 0) {
-        PROM_APPEND("modbus_master_slave_backoff{slave=\"%d\",timeouts=\"%d\",successes=\"%d\"} %d\n",
-                     mb_async->slave_backoff[i].slave_id,
-                     mb_async->slave_backoff[i].timeout_count,
-                     mb_async->slave_backoff[i].success_count,
-                     mb_async->slave_backoff[i].backoff_ms);
-      }
-    }
-  }
-
-  // --- SSE metrics ---
-  PROM_APPEND("# HELP sse_clients_active Active SSE client connections\n");
-  PROM_APPEND("# TYPE sse_clients_active gauge\n");
-  PROM_APPEND("sse_clients_active %d\n", sse_get_client_count());
+  // Alarm detection piggybacks on the scrape interval, independent of the filter
+  alarm_check_thresholds();
 
-  // --- Network metrics ---
-  PROM_APPEND("# HELP wifi_connected WiFi connection status (1=connected, 0=disconnected)\n");
-  PROM_APPEND("# TYPE wifi_connected gauge\n");
-  PROM_APPEND("wifi_connected %d\n", wifi_driver_is_connected() ? 1 : 0);
+  // Headers must be set before the first chunk goes out
+  httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
 
-  int rssi = wifi_driver_get_rssi();
-  if (wifi_driver_is_connected() && rssi != 0) {
-    PROM_APPEND("# HELP wifi_rssi_dbm WiFi signal strength in dBm\n");
-    PROM_APPEND("# TYPE wifi_rssi_dbm gauge\n");
-    PROM_APPEND("wifi_rssi_dbm %d\n", rssi);
-  }
+  prom_writer_t pw;
+  pw.req = req;
+  pw.pos = 0;
+  pw.err = ESP_OK;
 
-  PROM_APPEND("# HELP ethernet_connected Ethernet connection status (1=connected, 0=disconnected)\n");
-  PROM_APPEND("# TYPE ethernet_connected gauge\n");
-  PROM_APPEND("ethernet_connected %d\n", ethernet_driver_is_connected() ? 1 : 0);
+  #define PROM_APPEND(...) prom_printf(&pw, __VA_ARGS__)
 
-  const NetworkState *net_state = network_manager_get_state();
-  if (net_state) {
-    PROM_APPEND("# HELP telnet_connected Telnet client connection status (1=connected, 0=disconnected)\n");
-    PROM_APPEND("# TYPE telnet_connected gauge\n");
-    PROM_APPEND("telnet_connected %d\n", net_state->telnet_client_connected ? 1 : 0);
+  const mb_async_state_t *mb_async = mb_async_get_state();
 
-    // FEAT-075: Telnet client details for TCP connection monitor
-    {
-      uint32_t tel_ip = 0, tel_uptime = 0;
-      char tel_user[32] = {0};
-      if (network_manager_get_telnet_client_info(&tel_ip, &tel_uptime, tel_user)) {
-        uint8_t *ip = (uint8_t *)&tel_ip;
-        PROM_APPEND("# HELP telnet_client_ip Telnet client IP as label\n");
-        PROM_APPEND("# TYPE telnet_client_ip gauge\n");
-        PROM_APPEND("telnet_client_ip{ip=\"%d.%d.%d.%d\",user=\"%s\"} 1\n",
-                     ip[0], ip[1], ip[2], ip[3], tel_user[0] ? tel_user : "(auth)");
-        PROM_APPEND("# HELP telnet_client_uptime_seconds Telnet client connection uptime\n");
-        PROM_APPEND("# TYPE telnet_client_uptime_seconds gauge\n");
-        PROM_APPEND("telnet_client_uptime_seconds %lu\n", (unsigned long)tel_uptime);
+  if (families & PROM_FAM_SYSTEM) {
+    // --- System metrics ---
+    PROM_APPEND("# HELP esp32_uptime_seconds Device uptime in seconds\n");
+    PROM_APPEND("# TYPE esp32_uptime_seconds gauge\n");
+    PROM_APPEND("esp32_uptime_seconds %lu\n", (unsigned long)(millis() / 1000));
+
+    PROM_APPEND("# HELP esp32_heap_free_bytes Free heap memory in bytes\n");
+    PROM_APPEND("# TYPE esp32_heap_free_bytes gauge\n");
+    PROM_APPEND("esp32_heap_free_bytes %lu\n", (unsigned long)ESP.getFreeHeap());
+
+    PROM_APPEND("# HELP esp32_heap_min_free_bytes Minimum free heap since boot\n");
+    PROM_APPEND("# TYPE esp32_heap_min_free_bytes gauge\n");
+    PROM_APPEND("esp32_heap_min_free_bytes %lu\n", (unsigned long)ESP.getMinFreeHeap());
+
+    // --- Flash chip metrics ---
+    PROM_APPEND("# HELP esp32_flash_total_bytes Total flash size (from eFuse) in bytes\n");
+    PROM_APPEND("# TYPE esp32_flash_total_bytes gauge\n");
+    PROM_APPEND("esp32_flash_total_bytes %lu\n", (unsigned long)ESP.getFlashChipSize());
+    PROM_APPEND("# HELP esp32_flash_speed_hz Flash access speed in Hz\n");
+    PROM_APPEND("# TYPE esp32_flash_speed_hz gauge\n");
+    PROM_APPEND("esp32_flash_speed_hz %lu\n", (unsigned long)ESP.getFlashChipSpeed());
+
+    // --- PSRAM metrics (if available) ---
+    uint32_t psram_total = ESP.getPsramSize();
+    if (psram_total > 0) {
+      PROM_APPEND("# HELP esp32_psram_total_bytes Total PSRAM in bytes\n");
+      PROM_APPEND("# TYPE esp32_psram_total_bytes gauge\n");
+      PROM_APPEND("esp32_psram_total_bytes %lu\n", (unsigned long)psram_total);
+      PROM_APPEND("# HELP esp32_psram_free_bytes Free PSRAM in bytes\n");
+      PROM_APPEND("# TYPE esp32_psram_free_bytes gauge\n");
+      PROM_APPEND("esp32_psram_free_bytes %lu\n", (unsigned long)ESP.getFreePsram());
+    }
+  }
+
+  if (families & PROM_FAM_HTTP) {
+    // --- HTTP API metrics ---
+    const HttpServerStats *stats = http_server_get_stats();
+    if (stats) {
+      PROM_APPEND("# HELP http_requests_total Total HTTP API requests\n");
+      PROM_APPEND("# TYPE http_requests_total counter\n");
+      PROM_APPEND("http_requests_total %lu\n", stats->total_requests);
+
+      PROM_APPEND("# HELP http_requests_success_total Successful HTTP responses (2xx)\n");
+      PROM_APPEND("# TYPE http_requests_success_total counter\n");
+      PROM_APPEND("http_requests_success_total %lu\n", stats->successful_requests);
+
+      PROM_APPEND("# HELP http_requests_client_errors_total Client error responses (4xx)\n");
+      PROM_APPEND("# TYPE http_requests_client_errors_total counter\n");
+      PROM_APPEND("http_requests_client_errors_total %lu\n", stats->client_errors);
+
+      PROM_APPEND("# HELP http_requests_server_errors_total Server error responses (5xx)\n");
+      PROM_APPEND("# TYPE http_requests_server_errors_total counter\n");
+      PROM_APPEND("http_requests_server_errors_total %lu\n", stats->server_errors);
+
+      PROM_APPEND("# HELP http_auth_failures_total Authentication failures\n");
+      PROM_APPEND("# TYPE http_auth_failures_total counter\n");
+      PROM_APPEND("http_auth_failures_total %lu\n", stats->auth_failures);
+    }
+  }
+
+  if (families & PROM_FAM_MODBUS) {
+    // --- Modbus Slave config metrics ---
+    PROM_APPEND("# HELP modbus_slave_config_enabled Modbus slave enabled (1=yes, 0=no)\n");
+    PROM_APPEND("# TYPE modbus_slave_config_enabled gauge\n");
+    PROM_APPEND("modbus_slave_config_enabled %d\n", g_persist_config.modbus_slave.enabled ? 1 : 0);
+    PROM_APPEND("# HELP modbus_slave_config_id Modbus slave ID\n");
+    PROM_APPEND("# TYPE modbus_slave_config_id gauge\n");
+    PROM_APPEND("modbus_slave_config_id %d\n", g_persist_config.modbus_slave.slave_id);
+    PROM_APPEND("# HELP modbus_slave_config_baudrate Modbus slave baudrate\n");
+    PROM_APPEND("# TYPE modbus_slave_config_baudrate gauge\n");
+    PROM_APPEND("modbus_slave_config_baudrate %lu\n", (unsigned long)g_persist_config.modbus_slave.baudrate);
+    PROM_APPEND("# HELP modbus_slave_config_parity Modbus slave parity (0=N, 1=E, 2=O)\n");
+    PROM_APPEND("# TYPE modbus_slave_config_parity gauge\n");
+    PROM_APPEND("modbus_slave_config_parity %d\n", g_persist_config.modbus_slave.parity);
+    PROM_APPEND("# HELP modbus_slave_config_stopbits Modbus slave stop bits\n");
+    PROM_APPEND("# TYPE modbus_slave_config_stopbits gauge\n");
+    PROM_APPEND("modbus_slave_config_stopbits %d\n", g_persist_config.modbus_slave.stop_bits);
+
+    // --- Modbus Slave metrics ---
+    PROM_APPEND("# HELP modbus_slave_requests_total Total Modbus slave requests\n");
+    PROM_APPEND("# TYPE modbus_slave_requests_total counter\n");
+    PROM_APPEND("modbus_slave_requests_total %lu\n", g_persist_config.modbus_slave.total_requests);
+
+    PROM_APPEND("# HELP modbus_slave_success_total Successful Modbus slave responses\n");
+    PROM_APPEND("# TYPE modbus_slave_success_total counter\n");
+    PROM_APPEND("modbus_slave_success_total %lu\n", g_persist_config.modbus_slave.successful_requests);
+
+    PROM_APPEND("# HELP modbus_slave_crc_errors_total Modbus slave CRC errors\n");
+    PROM_APPEND("# TYPE modbus_slave_crc_errors_total counter\n");
+    PROM_APPEND("modbus_slave_crc_errors_total %lu\n", g_persist_config.modbus_slave.crc_errors);
+
+    PROM_APPEND("# HELP modbus_slave_exceptions_total Modbus slave exception responses\n");
+    PROM_APPEND("# TYPE modbus_slave_exceptions_total counter\n");
+    PROM_APPEND("modbus_slave_exceptions_total %lu\n", g_persist_config.modbus_slave.exception_errors);
+  }
+
+  if (families & PROM_FAM_SYSTEM) {
+    // --- Heap detailed metrics ---
+    PROM_APPEND("# HELP esp32_heap_largest_free_block Largest contiguous free heap block\n");
+    PROM_APPEND("# TYPE esp32_heap_largest_free_block gauge\n");
+    PROM_APPEND("esp32_heap_largest_free_block %lu\n", (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  }
+
+  if (families & PROM_FAM_MODBUS) {
+    // --- Modbus Master config metrics ---
+    PROM_APPEND("# HELP modbus_master_config_enabled Modbus master enabled (1=yes, 0=no)\n");
+    PROM_APPEND("# TYPE modbus_master_config_enabled gauge\n");
+    PROM_APPEND("modbus_master_config_enabled %d\n", g_modbus_master_config.enabled ? 1 : 0);
+    PROM_APPEND("# HELP modbus_master_config_baudrate Modbus master baudrate\n");
+    PROM_APPEND("# TYPE modbus_master_config_baudrate gauge\n");
+    PROM_APPEND("modbus_master_config_baudrate %lu\n", (unsigned long)g_modbus_master_config.baudrate);
+    PROM_APPEND("# HELP modbus_master_config_parity Modbus master parity (0=N, 1=E, 2=O)\n");
+    PROM_APPEND("# TYPE modbus_master_config_parity gauge\n");
+    PROM_APPEND("modbus_master_config_parity %d\n", g_modbus_master_config.parity);
+    PROM_APPEND("# HELP modbus_master_config_stopbits Modbus master stop bits\n");
+    PROM_APPEND("# TYPE modbus_master_config_stopbits gauge\n");
+    PROM_APPEND("modbus_master_config_stopbits %d\n", g_modbus_master_config.stop_bits);
+
+    // --- Modbus Master metrics ---
+    PROM_APPEND("# HELP modbus_master_stats_age_ms Milliseconds since last stats reset\n");
+    PROM_APPEND("# TYPE modbus_master_stats_age_ms gauge\n");
+    PROM_APPEND("modbus_master_stats_age_ms %lu\n",
+      g_modbus_master_config.stats_since_ms > 0 ? (unsigned long)(millis() - g_modbus_master_config.stats_since_ms) : (unsigned long)millis());
+
+    PROM_APPEND("# HELP modbus_master_requests_total Total Modbus master requests\n");
+    PROM_APPEND("# TYPE modbus_master_requests_total counter\n");
+    PROM_APPEND("modbus_master_requests_total %lu\n", g_modbus_master_config.total_requests);
+
+    PROM_APPEND("# HELP modbus_master_success_total Successful Modbus master responses\n");
+    PROM_APPEND("# TYPE modbus_master_success_total counter\n");
+    PROM_APPEND("modbus_master_success_total %lu\n", g_modbus_master_config.successful_requests);
+
+    PROM_APPEND("# HELP modbus_master_timeout_errors_total Modbus master timeout errors\n");
+    PROM_APPEND("# TYPE modbus_master_timeout_errors_total counter\n");
+    PROM_APPEND("modbus_master_timeout_errors_total %lu\n", g_modbus_master_config.timeout_errors);
+
+    PROM_APPEND("# HELP modbus_master_crc_errors_total Modbus master CRC errors\n");
+    PROM_APPEND("# TYPE modbus_master_crc_errors_total counter\n");
+    PROM_APPEND("modbus_master_crc_errors_total %lu\n", g_modbus_master_config.crc_errors);
+
+    PROM_APPEND("# HELP modbus_master_exception_errors_total Modbus master exception errors\n");
+    PROM_APPEND("# TYPE modbus_master_exception_errors_total counter\n");
+    PROM_APPEND("modbus_master_exception_errors_total %lu\n", g_modbus_master_config.exception_errors);
+
+    // --- Modbus Master Async Cache metrics ---
+    if (mb_async && mb_async->task_running) {
+      PROM_APPEND("# HELP modbus_master_cache_hits Async cache hit count\n");
+      PROM_APPEND("# TYPE modbus_master_cache_hits counter\n");
+      PROM_APPEND("modbus_master_cache_hits %lu\n", (unsigned long)mb_async->cache_hits);
+      PROM_APPEND("# HELP modbus_master_cache_misses Async cache miss count\n");
+      PROM_APPEND("# TYPE modbus_master_cache_misses counter\n");
+      PROM_APPEND("modbus_master_cache_misses %lu\n", (unsigned long)mb_async->cache_misses);
+      PROM_APPEND("# HELP modbus_master_cache_entries Active cache entries\n");
+      PROM_APPEND("# TYPE modbus_master_cache_entries gauge\n");
+      PROM_APPEND("modbus_master_cache_entries %d\n", mb_async->entry_count);
+      PROM_APPEND("# HELP modbus_master_queue_full_count Queue full rejections\n");
+      PROM_APPEND("# TYPE modbus_master_queue_full_count counter\n");
+      PROM_APPEND("modbus_master_queue_full_count %lu\n", (unsigned long)mb_async->queue_full_count);
+      PROM_APPEND("# HELP modbus_master_queue_depth Current queue depth\n");
+      PROM_APPEND("# TYPE modbus_master_queue_depth gauge\n");
+      PROM_APPEND("modbus_master_queue_depth %u\n", (unsigned)mb_async->pq_count);
+      PROM_APPEND("# HELP modbus_master_queue_hwm Queue high watermark\n");
+      PROM_APPEND("# TYPE modbus_master_queue_hwm gauge\n");
+      PROM_APPEND("modbus_master_queue_hwm %u\n", (unsigned)mb_async->queue_high_watermark);
+      PROM_APPEND("# HELP modbus_master_priority_drops Requests dropped by priority eviction\n");
+      PROM_APPEND("# TYPE modbus_master_priority_drops counter\n");
+      PROM_APPEND("modbus_master_priority_drops %lu\n", (unsigned long)mb_async->priority_drops);
+      PROM_APPEND("# HELP modbus_master_cache_hit_rate Cache hit rate percent\n");
+      PROM_APPEND("# TYPE modbus_master_cache_hit_rate gauge\n");
+      {
+        uint32_t total_lookups = mb_async->cache_hits + mb_async->cache_misses;
+        uint8_t hit_pct = total_lookups > 0 ? (uint8_t)(mb_async->cache_hits * 100 / total_lookups) : 0;
+        PROM_APPEND("modbus_master_cache_hit_rate %u\n", hit_pct);
+      }
+      PROM_APPEND("# HELP modbus_master_cache_utilization Cache slot utilization percent\n");
+      PROM_APPEND("# TYPE modbus_master_cache_utilization gauge\n");
+      PROM_APPEND("modbus_master_cache_utilization %u\n",
+                  (unsigned)(mb_async->entry_count * 100 / MB_CACHE_MAX_ENTRIES));
+      PROM_APPEND("# HELP modbus_master_cache_ttl_ms Cache entry TTL in ms (0=never expire)\n");
+      PROM_APPEND("# TYPE modbus_master_cache_ttl_ms gauge\n");
+      PROM_APPEND("modbus_master_cache_ttl_ms %u\n", (unsigned)g_modbus_master_config.cache_ttl_ms);
+
+      // Per-slave cache entries with status
+      PROM_APPEND("# HELP modbus_master_slave_status Per-slave cache entry status\n");
+      PROM_APPEND("# TYPE modbus_master_slave_status gauge\n");
+      for (int i = 0; i < mb_async->entry_count && i < MB_CACHE_MAX_ENTRIES; i++) {
+        const mb_cache_entry_t *e = &mb_async->entries[i];
+        if (e->status != MB_CACHE_EMPTY) {
+          const char *st = (e->status == MB_CACHE_VALID) ? "valid" :
+                           (e->status == MB_CACHE_PENDING) ? "pending" :
+                           (e->status == MB_CACHE_ERROR) ? "error" : "empty";
+          uint32_t age_ms = (e->last_update_ms > 0) ? (millis() - e->last_update_ms) : 0;
+          uint8_t disp_fc = (e->last_fc > 0) ? e->last_fc : e->key.req_type;
+          PROM_APPEND("modbus_master_slave_status{slave=\"%d\",addr=\"%d\",fc=\"%d\",status=\"%s\",age_ms=\"%u\"} %d\n",
+                       e->key.slave_id, e->key.address, disp_fc, st, age_ms,
+                       (e->status == MB_CACHE_VALID) ? 1 : (e->status == MB_CACHE_ERROR) ? -1 : 0);
+        }
+      }
+      // Per-slave adaptive backoff status
+      PROM_APPEND("# HELP modbus_master_slave_backoff Per-slave adaptive backoff delay in ms\n");
+      PROM_APPEND("# TYPE modbus_master_slave_backoff gauge\n");
+      for (int i = 0; i < MB_SLAVE_BACKOFF_MAX; i++) {
+        if (mb_async->slave_backoff[i].slave_id > 0) {
+          PROM_APPEND("modbus_master_slave_backoff{slave=\"%d\",timeouts=\"%d\",successes=\"%d\"} %d\n",
+                       mb_async->slave_backoff[i].slave_id,
+                       mb_async->slave_backoff[i].timeout_count,
+                       mb_async->slave_backoff[i].success_count,
+                       mb_async->slave_backoff[i].backoff_ms);
+        }
       }
     }
-
-    PROM_APPEND("# HELP wifi_reconnect_retries WiFi reconnect retry count\n");
-    PROM_APPEND("# TYPE wifi_reconnect_retries counter\n");
-    PROM_APPEND("wifi_reconnect_retries %lu\n", (unsigned long)net_state->wifi_reconnect_retries);
   }
 
-  // --- Counter metrics (expanded) ---
-  PROM_APPEND("# HELP counter_value Current counter values\n");
-  PROM_APPEND("# TYPE counter_value gauge\n");
-  PROM_APPEND("# HELP counter_frequency_hz Measured counter frequency in Hz\n");
-  PROM_APPEND("# TYPE counter_frequency_hz gauge\n");
-  for (int i = 0; i < COUNTER_COUNT; i++) {
-    CounterConfig cfg;
-    if (counter_engine_get_config(i + 1, &cfg) && cfg.enabled) {
-      uint64_t val = counter_engine_get_value(i + 1);
-      PROM_APPEND("counter_value{id=\"%d\"} %llu\n", i + 1, (unsigned long long)val);
-      uint16_t hz = counter_frequency_get(i + 1);
-      PROM_APPEND("counter_frequency_hz{id=\"%d\"} %u\n", i + 1, (unsigned)hz);
+  if (families & PROM_FAM_NETWORK) {
+    // --- SSE metrics ---
+    PROM_APPEND("# HELP sse_clients_active Active SSE client connections\n");
+    PROM_APPEND("# TYPE sse_clients_active gauge\n");
+    PROM_APPEND("sse_clients_active %d\n", sse_get_client_count());
+
+    // --- Network metrics ---
+    PROM_APPEND("# HELP wifi_connected WiFi connection status (1=connected, 0=disconnected)\n");
+    PROM_APPEND("# TYPE wifi_connected gauge\n");
+    PROM_APPEND("wifi_connected %d\n", wifi_driver_is_connected() ? 1 : 0);
+
+    int rssi = wifi_driver_get_rssi();
+    if (wifi_driver_is_connected() && rssi != 0) {
+      PROM_APPEND("# HELP wifi_rssi_dbm WiFi signal strength in dBm\n");
+      PROM_APPEND("# TYPE wifi_rssi_dbm gauge\n");
+      PROM_APPEND("wifi_rssi_dbm %d\n", rssi);
+    }
+
+    PROM_APPEND("# HELP ethernet_connected Ethernet connection status (1=connected, 0=disconnected)\n");
+    PROM_APPEND("# TYPE ethernet_connected gauge\n");
+    PROM_APPEND("ethernet_connected %d\n", ethernet_driver_is_connected() ? 1 : 0);
+
+    const NetworkState *net_state = network_manager_get_state();
+    if (net_state) {
+      PROM_APPEND("# HELP telnet_connected Telnet client connection status (1=connected, 0=disconnected)\n");
+      PROM_APPEND("# TYPE telnet_connected gauge\n");
+      PROM_APPEND("telnet_connected %d\n", net_state->telnet_client_connected ? 1 : 0);
+
+      // FEAT-075: Telnet client details for TCP connection monitor
+      {
+        uint32_t tel_ip = 0, tel_uptime = 0;
+        char tel_user[32] = {0};
+        if (network_manager_get_telnet_client_info(&tel_ip, &tel_uptime, tel_user)) {
+          uint8_t *ip = (uint8_t *)&tel_ip;
+          PROM_APPEND("# HELP telnet_client_ip Telnet client IP as label\n");
+          PROM_APPEND("# TYPE telnet_client_ip gauge\n");
+          PROM_APPEND("telnet_client_ip{ip=\"%d.%d.%d.%d\",user=\"%s\"} 1\n",
+                       ip[0], ip[1], ip[2], ip[3], tel_user[0] ? tel_user : "(auth)");
+          PROM_APPEND("# HELP telnet_client_uptime_seconds Telnet client connection uptime\n");
+          PROM_APPEND("# TYPE telnet_client_uptime_seconds gauge\n");
+          PROM_APPEND("telnet_client_uptime_seconds %lu\n", (unsigned long)tel_uptime);
+        }
+      }
+
+      PROM_APPEND("# HELP wifi_reconnect_retries WiFi reconnect retry count\n");
+      PROM_APPEND("# TYPE wifi_reconnect_retries counter\n");
+      PROM_APPEND("wifi_reconnect_retries %lu\n", (unsigned long)net_state->wifi_reconnect_retries);
+    }
+  }
+
+  if (families & PROM_FAM_COUNTER) {
+    // --- Counter metrics (expanded) ---
+    PROM_APPEND("# HELP counter_value Current counter values\n");
+    PROM_APPEND("# TYPE counter_value gauge\n");
+    PROM_APPEND("# HELP counter_frequency_hz Measured counter frequency in Hz\n");
+    PROM_APPEND("# TYPE counter_frequency_hz gauge\n");
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+      CounterConfig cfg;
+      if (counter_engine_get_config(i + 1, &cfg) && cfg.enabled) {
+        uint64_t val = counter_engine_get_value(i + 1);
+        PROM_APPEND("counter_value{id=\"%d\"} %llu\n", i + 1, (unsigned long long)val);
+        uint32_t mhz = counter_frequency_get_mhz(i + 1);
+        PROM_APPEND("counter_frequency_hz{id=\"%d\"} %lu.%03lu\n", i + 1,
+                    (unsigned long)(mhz / 1000), (unsigned long)(mhz % 1000));
+      }
     }
   }
 
-  // --- Timer metrics (expanded) ---
-  PROM_APPEND("# HELP timer_output Current timer output coil state (1=on, 0=off)\n");
-  PROM_APPEND("# TYPE timer_output gauge\n");
-  PROM_APPEND("# HELP timer_is_running Timer active state (1=running, 0=stopped)\n");
-  PROM_APPEND("# TYPE timer_is_running gauge\n");
-  PROM_APPEND("# HELP timer_current_phase Timer current phase (0-3)\n");
-  PROM_APPEND("# TYPE timer_current_phase gauge\n");
-  for (int i = 0; i < TIMER_COUNT; i++) {
-    TimerConfig cfg;
-    if (timer_engine_get_config(i + 1, &cfg) && cfg.enabled) {
-      uint8_t coil_val = registers_get_coil(cfg.output_coil);
-      PROM_APPEND("timer_output{id=\"%d\"} %d\n", i + 1, coil_val ? 1 : 0);
-      uint8_t phase = 0, active = 0;
-      timer_engine_get_runtime(i + 1, &phase, &active);
-      PROM_APPEND("timer_is_running{id=\"%d\"} %d\n", i + 1, active ? 1 : 0);
-      PROM_APPEND("timer_current_phase{id=\"%d\"} %d\n", i + 1, phase);
+  if (families & PROM_FAM_TIMER) {
+    // --- Timer metrics (expanded) ---
+    PROM_APPEND("# HELP timer_output Current timer output coil state (1=on, 0=off)\n");
+    PROM_APPEND("# TYPE timer_output gauge\n");
+    PROM_APPEND("# HELP timer_is_running Timer active state (1=running, 0=stopped)\n");
+    PROM_APPEND("# TYPE timer_is_running gauge\n");
+    PROM_APPEND("# HELP timer_current_phase Timer current phase (0-3)\n");
+    PROM_APPEND("# TYPE timer_current_phase gauge\n");
+    for (int i = 0; i < TIMER_COUNT; i++) {
+      TimerConfig cfg;
+      if (timer_engine_get_config(i + 1, &cfg) && cfg.enabled) {
+        uint8_t coil_val = registers_get_coil(cfg.output_coil);
+        PROM_APPEND("timer_output{id=\"%d\"} %d\n", i + 1, coil_val ? 1 : 0);
+        uint8_t phase = 0, active = 0;
+        timer_engine_get_runtime(i + 1, &phase, &active);
+        PROM_APPEND("timer_is_running{id=\"%d\"} %d\n", i + 1, active ? 1 : 0);
+        PROM_APPEND("timer_current_phase{id=\"%d\"} %d\n", i + 1, phase);
+      }
     }
   }
 
-  // --- ST Logic metrics ---
-  st_logic_engine_state_t *logic_state = st_logic_get_state();
-  if (logic_state) {
-    PROM_APPEND("# HELP st_logic_enabled ST Logic engine global enabled state\n");
-    PROM_APPEND("# TYPE st_logic_enabled gauge\n");
-    PROM_APPEND("st_logic_enabled %d\n", logic_state->enabled ? 1 : 0);
-
-    PROM_APPEND("# HELP st_logic_total_cycles Total ST Logic execution cycles\n");
-    PROM_APPEND("# TYPE st_logic_total_cycles counter\n");
-    PROM_APPEND("st_logic_total_cycles %lu\n", (unsigned long)logic_state->total_cycles);
-
-    PROM_APPEND("# HELP st_logic_cycle_overruns Total cycle overruns (cycle > interval)\n");
-    PROM_APPEND("# TYPE st_logic_cycle_overruns counter\n");
-    PROM_APPEND("st_logic_cycle_overruns %lu\n", (unsigned long)logic_state->cycle_overrun_count);
-
-    PROM_APPEND("# HELP st_logic_execution_count Program execution count\n");
-    PROM_APPEND("# TYPE st_logic_execution_count counter\n");
-    PROM_APPEND("# HELP st_logic_error_count Program error count\n");
-    PROM_APPEND("# TYPE st_logic_error_count counter\n");
-    PROM_APPEND("# HELP st_logic_exec_time_us Last execution time in microseconds\n");
-    PROM_APPEND("# TYPE st_logic_exec_time_us gauge\n");
-    PROM_APPEND("# HELP st_logic_min_exec_us Minimum execution time in microseconds\n");
-    PROM_APPEND("# TYPE st_logic_min_exec_us gauge\n");
-    PROM_APPEND("# HELP st_logic_max_exec_us Maximum execution time in microseconds\n");
-    PROM_APPEND("# TYPE st_logic_max_exec_us gauge\n");
-    PROM_APPEND("# HELP st_logic_overrun_count Program overrun count\n");
-    PROM_APPEND("# TYPE st_logic_overrun_count counter\n");
-
-    for (int i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
-      st_logic_program_config_t *prog = st_logic_get_program(logic_state, i);
-      if (prog && prog->enabled) {
-        PROM_APPEND("st_logic_execution_count{slot=\"%d\",name=\"%s\"} %u\n",
-                     i + 1, prog->name, (unsigned)prog->execution_count);
-        PROM_APPEND("st_logic_error_count{slot=\"%d\",name=\"%s\"} %u\n",
-                     i + 1, prog->name, (unsigned)prog->error_count);
-        PROM_APPEND("st_logic_exec_time_us{slot=\"%d\",name=\"%s\"} %lu\n",
-                     i + 1, prog->name, (unsigned long)prog->last_execution_us);
-        PROM_APPEND("st_logic_min_exec_us{slot=\"%d\",name=\"%s\"} %lu\n",
-                     i + 1, prog->name, (unsigned long)prog->min_execution_us);
-        PROM_APPEND("st_logic_max_exec_us{slot=\"%d\",name=\"%s\"} %lu\n",
-                     i + 1, prog->name, (unsigned long)prog->max_execution_us);
-        PROM_APPEND("st_logic_overrun_count{slot=\"%d\",name=\"%s\"} %lu\n",
-                     i + 1, prog->name, (unsigned long)prog->overrun_count);
+  if (families & PROM_FAM_ST) {
+    // --- ST Logic metrics ---
+    st_logic_engine_state_t *logic_state = st_logic_get_state();
+    if (logic_state) {
+      PROM_APPEND("# HELP st_logic_enabled ST Logic engine global enabled state\n");
+      PROM_APPEND("# TYPE st_logic_enabled gauge\n");
+      PROM_APPEND("st_logic_enabled %d\n", logic_state->enabled ? 1 : 0);
+
+      PROM_APPEND("# HELP st_logic_total_cycles Total ST Logic execution cycles\n");
+      PROM_APPEND("# TYPE st_logic_total_cycles counter\n");
+      PROM_APPEND("st_logic_total_cycles %lu\n", (unsigned long)logic_state->total_cycles);
+
+      PROM_APPEND("# HELP st_logic_cycle_overruns Total cycle overruns (cycle > interval)\n");
+      PROM_APPEND("# TYPE st_logic_cycle_overruns counter\n");
+      PROM_APPEND("st_logic_cycle_overruns %lu\n", (unsigned long)logic_state->cycle_overrun_count);
+
+      PROM_APPEND("# HELP st_logic_execution_count Program execution count\n");
+      PROM_APPEND("# TYPE st_logic_execution_count counter\n");
+      PROM_APPEND("# HELP st_logic_error_count Program error count\n");
+      PROM_APPEND("# TYPE st_logic_error_count counter\n");
+      PROM_APPEND("# HELP st_logic_exec_time_us Last execution time in microseconds\n");
+      PROM_APPEND("# TYPE st_logic_exec_time_us gauge\n");
+      PROM_APPEND("# HELP st_logic_min_exec_us Minimum execution time in microseconds\n");
+      PROM_APPEND("# TYPE st_logic_min_exec_us gauge\n");
+      PROM_APPEND("# HELP st_logic_max_exec_us Maximum execution time in microseconds\n");
+      PROM_APPEND("# TYPE st_logic_max_exec_us gauge\n");
+      PROM_APPEND("# HELP st_logic_overrun_count Program overrun count\n");
+      PROM_APPEND("# TYPE st_logic_overrun_count counter\n");
+
+      for (int i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+        st_logic_program_config_t *prog = st_logic_get_program(logic_state, i);
+        if (prog && prog->enabled) {
+          PROM_APPEND("st_logic_execution_count{slot=\"%d\",name=\"%s\"} %u\n",
+                       i + 1, prog->name, (unsigned)prog->execution_count);
+          PROM_APPEND("st_logic_error_count{slot=\"%d\",name=\"%s\"} %u\n",
+                       i + 1, prog->name, (unsigned)prog->error_count);
+          PROM_APPEND("st_logic_exec_time_us{slot=\"%d\",name=\"%s\"} %lu\n",
+                       i + 1, prog->name, (unsigned long)prog->last_execution_us);
+          PROM_APPEND("st_logic_min_exec_us{slot=\"%d\",name=\"%s\"} %lu\n",
+                       i + 1, prog->name, (unsigned long)prog->min_execution_us);
+          PROM_APPEND("st_logic_max_exec_us{slot=\"%d\",name=\"%s\"} %lu\n",
+                       i + 1, prog->name, (unsigned long)prog->max_execution_us);
+          PROM_APPEND("st_logic_overrun_count{slot=\"%d\",name=\"%s\"} %lu\n",
+                       i + 1, prog->name, (unsigned long)prog->overrun_count);
+        }
       }
+
+      // Execute-in-place bytecode (v7.9.9.8)
+      StXipInfo xi;
+      st_bytecode_xip_info(&xi);
+      PROM_APPEND("# HELP st_logic_xip_programs Programs executing bytecode from mapped flash\n");
+      PROM_APPEND("# TYPE st_logic_xip_programs gauge\n");
+      PROM_APPEND("st_logic_xip_programs %u\n", (unsigned)xi.mapped);
+      PROM_APPEND("# HELP st_logic_xip_bytes Instruction bytes executed in place (not in heap)\n");
+      PROM_APPEND("# TYPE st_logic_xip_bytes gauge\n");
+      PROM_APPEND("st_logic_xip_bytes %lu\n", (unsigned long)xi.flash_bytes);
     }
   }
 
 #ifdef SHIFT_REGISTER_ENABLED
-  // --- GPIO Digital Input metrics (74HC165, GPIO 101-108) ---
-  PROM_APPEND("# HELP gpio_digital_input Digital input state (1=high, 0=low)\n");
-  PROM_APPEND("# TYPE gpio_digital_input gauge\n");
-  for (int i = 0; i < VGPIO_SR_INPUT_COUNT; i++) {
-    uint8_t pin = VGPIO_SR_INPUT_BASE + i;
-    PROM_APPEND("gpio_digital_input{pin=\"%d\"} %d\n", pin, gpio_read(pin) ? 1 : 0);
-  }
+  if (families & PROM_FAM_GPIO) {
+    // --- GPIO Digital Input metrics (74HC165, GPIO 101-108) ---
+    PROM_APPEND("# HELP gpio_digital_input Digital input state (1=high, 0=low)\n");
+    PROM_APPEND("# TYPE gpio_digital_input gauge\n");
+    for (int i = 0; i < VGPIO_SR_INPUT_COUNT; i++) {
+      uint8_t pin = VGPIO_SR_INPUT_BASE + i;
+      PROM_APPEND("gpio_digital_input{pin=\"%d\"} %d\n", pin, gpio_read(pin) ? 1 : 0);
+    }
 
-  // --- GPIO Digital Output metrics (74HC595, GPIO 201-208) ---
-  PROM_APPEND("# HELP gpio_digital_output Digital output state (1=high, 0=low)\n");
-  PROM_APPEND("# TYPE gpio_digital_output gauge\n");
-  for (int i = 0; i < VGPIO_SR_OUTPUT_COUNT; i++) {
-    uint8_t pin = VGPIO_SR_OUTPUT_BASE + i;
-    PROM_APPEND("gpio_digital_output{pin=\"%d\"} %d\n", pin, gpio_read(pin) ? 1 : 0);
+    // --- GPIO Digital Output metrics (74HC595, GPIO 201-208) ---
+    PROM_APPEND("# HELP gpio_digital_output Digital output state (1=high, 0=low)\n");
+    PROM_APPEND("# TYPE gpio_digital_output gauge\n");
+    for (int i = 0; i < VGPIO_SR_OUTPUT_COUNT; i++) {
+      uint8_t pin = VGPIO_SR_OUTPUT_BASE + i;
+      PROM_APPEND("gpio_digital_output{pin=\"%d\"} %d\n", pin, gpio_read(pin) ? 1 : 0);
+    }
   }
 #endif
 
-  // --- Modbus Register metrics (non-zero holding & input registers) ---
-  PROM_APPEND("# HELP modbus_holding_register Modbus holding register value\n");
-  PROM_APPEND("# TYPE modbus_holding_register gauge\n");
-  for (int addr = 0; addr < HOLDING_REGS_SIZE; addr++) {
-    uint16_t val = registers_get_holding_register(addr);
-    if (val != 0) {
-      PROM_APPEND("modbus_holding_register{addr=\"%d\"} %u\n", addr, (unsigned)val);
+  if (families & PROM_FAM_REGISTERS) {
+    // --- Modbus Register metrics (non-zero holding & input registers) ---
+    PROM_APPEND("# HELP modbus_holding_register Modbus holding register value\n");
+    PROM_APPEND("# TYPE modbus_holding_register gauge\n");
+    for (int addr = 0; addr < HOLDING_REGS_SIZE; addr++) {
+      uint16_t val = registers_get_holding_register(addr);
+      if (val != 0) {
+        PROM_APPEND("modbus_holding_register{addr=\"%d\"} %u\n", addr, (unsigned)val);
+      }
     }
-  }
 
-  PROM_APPEND("# HELP modbus_input_register Modbus input register value\n");
-  PROM_APPEND("# TYPE modbus_input_register gauge\n");
-  for (int addr = 0; addr < INPUT_REGS_SIZE; addr++) {
-    uint16_t val = registers_get_input_register(addr);
-    if (val != 0) {
-      PROM_APPEND("modbus_input_register{addr=\"%d\"} %u\n", addr, (unsigned)val);
+    PROM_APPEND("# HELP modbus_input_register Modbus input register value\n");
+    PROM_APPEND("# TYPE modbus_input_register gauge\n");
+    for (int addr = 0; addr < INPUT_REGS_SIZE; addr++) {
+      uint16_t val = registers_get_input_register(addr);
+      if (val != 0) {
+        PROM_APPEND("modbus_input_register{addr=\"%d\"} %u\n", addr, (unsigned)val);
+      }
     }
   }
 
-  // --- Persistence Group metrics ---
-  PersistentRegisterData *pr = &g_persist_config.persist_regs;
-  if (pr->enabled && pr->group_count > 0) {
-    PROM_APPEND("# HELP persist_group_reg_count Number of registers in persistence group\n");
-    PROM_APPEND("# TYPE persist_group_reg_count gauge\n");
-    PROM_APPEND("# HELP persist_group_last_save_ms Last save timestamp (ms since boot)\n");
-    PROM_APPEND("# TYPE persist_group_last_save_ms gauge\n");
-    for (int i = 0; i < pr->group_count && i < PERSIST_MAX_GROUPS; i++) {
-      PersistGroup *grp = &pr->groups[i];
-      PROM_APPEND("persist_group_reg_count{group=\"%s\"} %d\n", grp->name, grp->reg_count);
-      PROM_APPEND("persist_group_last_save_ms{group=\"%s\"} %lu\n", grp->name, (unsigned long)grp->last_save_ms);
+  if (families & PROM_FAM_PERSIST) {
+    // --- Persistence Group metrics ---
+    PersistentRegisterData *pr = &g_persist_config.persist_regs;
+    if (pr->enabled && pr->group_count > 0) {
+      PROM_APPEND("# HELP persist_group_reg_count Number of registers in persistence group\n");
+      PROM_APPEND("# TYPE persist_group_reg_count gauge\n");
+      PROM_APPEND("# HELP persist_group_last_save_ms Last save timestamp (ms since boot)\n");
+      PROM_APPEND("# TYPE persist_group_last_save_ms gauge\n");
+      for (int i = 0; i < pr->group_count && i < PERSIST_MAX_GROUPS; i++) {
+        PersistGroup *grp = &pr->groups[i];
+        PROM_APPEND("persist_group_reg_count{group=\"%s\"} %d\n", grp->name, grp->reg_count);
+        PROM_APPEND("persist_group_last_save_ms{group=\"%s\"} %lu\n", grp->name, (unsigned long)grp->last_save_ms);
+      }
     }
-  }
 
-  // --- Watchdog metrics ---
-  WatchdogState *wd = watchdog_get_state();
-  if (wd) {
-    PROM_APPEND("# HELP watchdog_reboot_count Total reboots tracked by watchdog\n");
-    PROM_APPEND("# TYPE watchdog_reboot_count counter\n");
-    PROM_APPEND("watchdog_reboot_count %lu\n", wd->reboot_counter);
+    // --- Flash writer task (v7.9.9.6) ---
+    PersistWriterStats ws;
+    persist_writer_get_stats(&ws);
+    PROM_APPEND("# HELP persist_writer_pending Flash writes waiting in the writer queue\n");
+    PROM_APPEND("# TYPE persist_writer_pending gauge\n");
+    PROM_APPEND("persist_writer_pending %lu\n", (unsigned long)ws.pending);
+    PROM_APPEND("# HELP persist_writer_writes_total Flash writes executed by result\n");
+    PROM_APPEND("# TYPE persist_writer_writes_total counter\n");
+    PROM_APPEND("persist_writer_writes_total{result=\"ok\"} %lu\n", (unsigned long)ws.written);
+    PROM_APPEND("persist_writer_writes_total{result=\"failed\"} %lu\n", (unsigned long)ws.failed);
+    PROM_APPEND("# HELP persist_writer_coalesced_total Saves merged into a pending write\n");
+    PROM_APPEND("# TYPE persist_writer_coalesced_total counter\n");
+    PROM_APPEND("persist_writer_coalesced_total %lu\n", (unsigned long)ws.coalesced);
+    PROM_APPEND("# HELP persist_writer_rejected_total Saves rejected (queue full or no memory)\n");
+    PROM_APPEND("# TYPE persist_writer_rejected_total counter\n");
+    PROM_APPEND("persist_writer_rejected_total %lu\n", (unsigned long)ws.rejected);
+    PROM_APPEND("# HELP persist_writer_max_write_ms Longest flash write since boot\n");
+    PROM_APPEND("# TYPE persist_writer_max_write_ms gauge\n");
+    PROM_APPEND("persist_writer_max_write_ms %lu\n", (unsigned long)ws.max_write_ms);
+
+    // --- LittleFS file storage (v7.9.10.3, only once mounted) ---
+    FsMountInfo fi;
+    fs_mount_info(&fi);
+    if (fi.mounted) {
+      const FsStats *fst = fs_store_stats();
+      PROM_APPEND("# HELP fs_used_bytes LittleFS bytes in use\n");
+      PROM_APPEND("# TYPE fs_used_bytes gauge\n");
+      PROM_APPEND("fs_used_bytes %lu\n", (unsigned long)fi.used_bytes);
+      PROM_APPEND("# HELP fs_total_bytes LittleFS partition size\n");
+      PROM_APPEND("# TYPE fs_total_bytes gauge\n");
+      PROM_APPEND("fs_total_bytes %lu\n", (unsigned long)fi.total_bytes);
+      PROM_APPEND("# HELP fs_bytes_total Bytes read and written (atomic replace) since boot\n");
+      PROM_APPEND("# TYPE fs_bytes_total counter\n");
+      PROM_APPEND("fs_bytes_total{op=\"read\"} %lu\n", (unsigned long)fst->read_bytes);
+      PROM_APPEND("fs_bytes_total{op=\"write\"} %lu\n", (unsigned long)fst->write_bytes);
+      PROM_APPEND("# HELP fs_throughput_kbps Average throughput since boot (write incl. fsync + rename)\n");
+      PROM_APPEND("# TYPE fs_throughput_kbps gauge\n");
+      PROM_APPEND("fs_throughput_kbps{op=\"read\"} %lu\n",
+                  (unsigned long)fs_kb_per_s(fst->read_bytes, fst->read_us));
+      PROM_APPEND("fs_throughput_kbps{op=\"write\"} %lu\n",
+                  (unsigned long)fs_kb_per_s(fst->write_bytes, fst->write_us));
+      PROM_APPEND("# HELP fs_errors_total Failed file writes (previous file kept)\n");
+      PROM_APPEND("# TYPE fs_errors_total counter\n");
+      PROM_APPEND("fs_errors_total %lu\n", (unsigned long)fst->errors);
+      PROM_APPEND("# HELP fs_migrated_files Files moved from SPIFFS to LittleFS this boot\n");
+      PROM_APPEND("# TYPE fs_migrated_files gauge\n");
+      PROM_APPEND("fs_migrated_files %u\n", (unsigned)fi.migrated_files);
+    }
+  }
+
+  if (families & PROM_FAM_SYSTEM) {
+    // --- Watchdog metrics ---
+    WatchdogState *wd = watchdog_get_state();
+    if (wd) {
+      PROM_APPEND("# HELP watchdog_reboot_count Total reboots tracked by watchdog\n");
+      PROM_APPEND("# TYPE watchdog_reboot_count counter\n");
+      PROM_APPEND("watchdog_reboot_count %lu\n", wd->reboot_counter);
+
+      PROM_APPEND("# HELP watchdog_reset_reason Last reset reason (ESP_RST enum)\n");
+      PROM_APPEND("# TYPE watchdog_reset_reason gauge\n");
+      PROM_APPEND("watchdog_reset_reason %lu\n", wd->last_reset_reason);
+    }
+
+    // --- Boot timeline (v7.9.10.0) ---
+    const BootTrace *bt = boot_trace_current();
+    PROM_APPEND("# HELP boot_phase_duration_us Duration of each setup() phase this boot\n");
+    PROM_APPEND("# TYPE boot_phase_duration_us gauge\n");
+    for (uint8_t i = 0; i < bt->phase_count; i++) {
+      PROM_APPEND("boot_phase_duration_us{phase=\"%s\"} %lu\n", bt->phases[i].name,
+                  (unsigned long)boot_trace_phase_us(bt, i));
+    }
+    if (bt->ready) {
+      PROM_APPEND("# HELP boot_time_to_ready_us App start to Modbus slave serving\n");
+      PROM_APPEND("# TYPE boot_time_to_ready_us gauge\n");
+      PROM_APPEND("boot_time_to_ready_us %lu\n", (unsigned long)bt->ready_us);
+    }
+    const BootTrace *bp = boot_trace_previous();
+    if (bp) {
+      PROM_APPEND("# HELP boot_previous_ready Previous boot reached ready before its reset\n");
+      PROM_APPEND("# TYPE boot_previous_ready gauge\n");
+      PROM_APPEND("boot_previous_ready %u\n", (unsigned)bp->ready);
+      if (bp->ready) {
+        PROM_APPEND("# HELP boot_previous_time_to_ready_us Time to ready of the previous boot\n");
+        PROM_APPEND("# TYPE boot_previous_time_to_ready_us gauge\n");
+        PROM_APPEND("boot_previous_time_to_ready_us %lu\n", (unsigned long)bp->ready_us);
+      }
+    }
 
-    PROM_APPEND("# HELP watchdog_reset_reason Last reset reason (ESP_RST enum)\n");
-    PROM_APPEND("# TYPE watchdog_reset_reason gauge\n");
-    PROM_APPEND("watchdog_reset_reason %lu\n", wd->last_reset_reason);
+    // --- Warm restart retention (v7.9.10.2) ---
+    const WarmRetainStats *wr = warm_retain_get_stats();
+    PROM_APPEND("# HELP warm_retain_restored Runtime state restored from no-init RAM this boot\n");
+    PROM_APPEND("# TYPE warm_retain_restored gauge\n");
+    PROM_APPEND("warm_retain_restored %u\n", wr->restored ? 1u : 0u);
+    PROM_APPEND("# HELP warm_retain_crash_skipped Restore skipped after repeated panic/WDT resets\n");
+    PROM_APPEND("# TYPE warm_retain_crash_skipped gauge\n");
+    PROM_APPEND("warm_retain_crash_skipped %u\n", wr->crash_skipped ? 1u : 0u);
+    PROM_APPEND("# HELP warm_retain_crash_streak Panic/WDT restores in a row, incl. this boot\n");
+    PROM_APPEND("# TYPE warm_retain_crash_streak gauge\n");
+    PROM_APPEND("warm_retain_crash_streak %u\n", wr->crash_streak);
+    if (wr->restored) {
+      PROM_APPEND("# HELP warm_retain_restore_us Time to validate and apply the snapshot\n");
+      PROM_APPEND("# TYPE warm_retain_restore_us gauge\n");
+      PROM_APPEND("warm_retain_restore_us %lu\n", (unsigned long)wr->restore_us);
+      PROM_APPEND("# HELP warm_retain_programs_skipped ST programs changed since the snapshot\n");
+      PROM_APPEND("# TYPE warm_retain_programs_skipped gauge\n");
+      PROM_APPEND("warm_retain_programs_skipped %u\n", wr->programs_skipped);
+    }
+    PROM_APPEND("# HELP warm_retain_snapshots_total Snapshots written this boot\n");
+    PROM_APPEND("# TYPE warm_retain_snapshots_total counter\n");
+    PROM_APPEND("warm_retain_snapshots_total %lu\n", (unsigned long)wr->snapshots);
+    PROM_APPEND("# HELP warm_retain_snapshot_bytes Size of the last snapshot\n");
+    PROM_APPEND("# TYPE warm_retain_snapshot_bytes gauge\n");
+    PROM_APPEND("warm_retain_snapshot_bytes %lu\n", (unsigned long)wr->snapshot_bytes);
+    PROM_APPEND("# HELP warm_retain_snapshot_max_us Slowest snapshot this boot\n");
+    PROM_APPEND("# TYPE warm_retain_snapshot_max_us gauge\n");
+    PROM_APPEND("warm_retain_snapshot_max_us %lu\n", (unsigned long)wr->snapshot_max_us);
+    PROM_APPEND("# HELP warm_retain_dropped_sections Sections that did not fit the last snapshot\n");
+    PROM_APPEND("# TYPE warm_retain_dropped_sections gauge\n");
+    PROM_APPEND("warm_retain_dropped_sections %lu\n", (unsigned long)wr->dropped);
+
+    // --- FreeRTOS task metrics ---
+    {
+      UBaseType_t task_count = uxTaskGetNumberOfTasks();
+      PROM_APPEND("# HELP freertos_task_count Number of FreeRTOS tasks\n");
+      PROM_APPEND("# TYPE freertos_task_count gauge\n");
+      PROM_APPEND("freertos_task_count %u\n", (unsigned)task_count);
+
+      // Report stack HWM for known tasks by handle
+      PROM_APPEND("# HELP freertos_task_stack_hwm Task stack high-water mark in bytes\n");
+      PROM_APPEND("# TYPE freertos_task_stack_hwm gauge\n");
+
+      // Main loop task (current task on Core 1)
+      TaskHandle_t cur = xTaskGetCurrentTaskHandle();
+      if (cur) {
+        PROM_APPEND("freertos_task_stack_hwm{task=\"loopTask\"} %lu\n",
+                     (unsigned long)(uxTaskGetStackHighWaterMark(cur) * 4));
+      }
+
+      // Async Modbus Master task
+      if (mb_async && mb_async->task_handle) {
+        PROM_APPEND("freertos_task_stack_hwm{task=\"mb_async\"} %lu\n",
+                     (unsigned long)(uxTaskGetStackHighWaterMark(mb_async->task_handle) * 4));
+      }
+
+      // IDLE tasks (core 0 and core 1)
+      TaskHandle_t idle0 = xTaskGetIdleTaskHandleForCPU(0);
+      TaskHandle_t idle1 = xTaskGetIdleTaskHandleForCPU(1);
+      if (idle0) {
+        PROM_APPEND("freertos_task_stack_hwm{task=\"IDLE0\"} %lu\n",
+                     (unsigned long)(uxTaskGetStackHighWaterMark(idle0) * 4));
+      }
+      if (idle1) {
+        PROM_APPEND("freertos_task_stack_hwm{task=\"IDLE1\"} %lu\n",
+                     (unsigned long)(uxTaskGetStackHighWaterMark(idle1) * 4));
+      }
+    }
+
+    // --- Firmware info ---
+    PROM_APPEND("# HELP firmware_info Firmware version info\n");
+    PROM_APPEND("# TYPE firmware_info gauge\n");
+    PROM_APPEND("firmware_info{version=\"%s\",build=\"%d\"} 1\n", PROJECT_VERSION, BUILD_NUMBER);
   }
 
-  // --- FreeRTOS task metrics ---
-  {
-    UBaseType_t task_count = uxTaskGetNumberOfTasks();
-    PROM_APPEND("# HELP freertos_task_count Number of FreeRTOS tasks\n");
-    PROM_APPEND("# TYPE freertos_task_count gauge\n");
-    PROM_APPEND("freertos_task_count %u\n", (unsigned)task_count);
+  if (families & PROM_FAM_NTP) {
+    // --- NTP metrics ---
+    PROM_APPEND("# HELP ntp_enabled NTP enabled (1=yes, 0=no)\n");
+    PROM_APPEND("# TYPE ntp_enabled gauge\n");
+    PROM_APPEND("ntp_enabled %d\n", g_persist_config.ntp.enabled ? 1 : 0);
 
-    // Report stack HWM for known tasks by handle
-    PROM_APPEND("# HELP freertos_task_stack_hwm Task stack high-water mark in bytes\n");
-    PROM_APPEND("# TYPE freertos_task_stack_hwm gauge\n");
+    PROM_APPEND("# HELP ntp_synced NTP time synchronized (1=yes, 0=no)\n");
+    PROM_APPEND("# TYPE ntp_synced gauge\n");
+    PROM_APPEND("ntp_synced %d\n", ntp_driver_is_synced() ? 1 : 0);
 
-    // Main loop task (current task on Core 1)
-    TaskHandle_t cur = xTaskGetCurrentTaskHandle();
-    if (cur) {
-      PROM_APPEND("freertos_task_stack_hwm{task=\"loopTask\"} %lu\n",
-                   (unsigned long)(uxTaskGetStackHighWaterMark(cur) * 4));
-    }
+    PROM_APPEND("# HELP ntp_sync_count Total NTP synchronizations since boot\n");
+    PROM_APPEND("# TYPE ntp_sync_count counter\n");
+    PROM_APPEND("ntp_sync_count %lu\n", (unsigned long)ntp_driver_get_sync_count());
 
-    // Async Modbus Master task
-    if (mb_async && mb_async->task_handle) {
-      PROM_APPEND("freertos_task_stack_hwm{task=\"mb_async\"} %lu\n",
-                   (unsigned long)(uxTaskGetStackHighWaterMark(mb_async->task_handle) * 4));
-    }
+    if (ntp_driver_is_synced()) {
+      PROM_APPEND("# HELP ntp_epoch_seconds Current epoch time\n");
+      PROM_APPEND("# TYPE ntp_epoch_seconds gauge\n");
+      PROM_APPEND("ntp_epoch_seconds %lu\n", (unsigned long)ntp_driver_get_epoch());
 
-    // IDLE tasks (core 0 and core 1)
-    TaskHandle_t idle0 = xTaskGetIdleTaskHandleForCPU(0);
-    TaskHandle_t idle1 = xTaskGetIdleTaskHandleForCPU(1);
-    if (idle0) {
-      PROM_APPEND("freertos_task_stack_hwm{task=\"IDLE0\"} %lu\n",
-                   (unsigned long)(uxTaskGetStackHighWaterMark(idle0) * 4));
+      PROM_APPEND("# HELP ntp_last_sync_age_ms Milliseconds since last sync\n");
+      PROM_APPEND("# TYPE ntp_last_sync_age_ms gauge\n");
+      PROM_APPEND("ntp_last_sync_age_ms %lu\n", (unsigned long)ntp_driver_get_last_sync_age_ms());
     }
-    if (idle1) {
-      PROM_APPEND("freertos_task_stack_hwm{task=\"IDLE1\"} %lu\n",
-                   (unsigned long)(uxTaskGetStackHighWaterMark(idle1) * 4));
+  }
+
+  if (families & PROM_FAM_ALARM) {
+    // --- Alarm log metrics ---
+    PROM_APPEND("# HELP alarm_log_count Total alarm entries in log\n");
+    PROM_APPEND("# TYPE alarm_log_count gauge\n");
+    PROM_APPEND("alarm_log_count %d\n", alarm_log_count);
+
+    uint8_t unack = 0;
+    for (int i = 0; i < alarm_log_count; i++) {
+      int idx = (alarm_log_head - alarm_log_count + i + ALARM_LOG_MAX) % ALARM_LOG_MAX;
+      if (!alarm_log[idx].acknowledged) unack++;
     }
+    PROM_APPEND("# HELP alarm_unacknowledged_count Unacknowledged alarms\n");
+    PROM_APPEND("# TYPE alarm_unacknowledged_count gauge\n");
+    PROM_APPEND("alarm_unacknowledged_count %d\n", unack);
   }
 
-  // --- Firmware info ---
-  PROM_APPEND("# HELP firmware_info Firmware version info\n");
-  PROM_APPEND("# TYPE firmware_info gauge\n");
-  PROM_APPEND("firmware_info{version=\"%s\",build=\"%d\"} 1\n", PROJECT_VERSION, BUILD_NUMBER);
+  if (families & PROM_FAM_HISTORY) {
+    // --- Historian metrics (FEAT-173) ---
+    const HistorianStats *hs = historian_get_stats();
+    PROM_APPEND("# HELP historian_points Historian points sampling\n");
+    PROM_APPEND("# TYPE historian_points gauge\n");
+    PROM_APPEND("historian_points %u\n", hs->points);
 
-  // --- NTP metrics ---
-  PROM_APPEND("# HELP ntp_enabled NTP enabled (1=yes, 0=no)\n");
-  PROM_APPEND("# TYPE ntp_enabled gauge\n");
-  PROM_APPEND("ntp_enabled %d\n", g_persist_config.ntp.enabled ? 1 : 0);
+    PROM_APPEND("# HELP historian_pool_bytes Historian ring memory\n");
+    PROM_APPEND("# TYPE historian_pool_bytes gauge\n");
+    PROM_APPEND("historian_pool_bytes{pool=\"%s\"} %lu\n", hs->psram ? "psram" : "dram",
+                (unsigned long)hs->pool_bytes);
 
-  PROM_APPEND("# HELP ntp_synced NTP time synchronized (1=yes, 0=no)\n");
-  PROM_APPEND("# TYPE ntp_synced gauge\n");
-  PROM_APPEND("ntp_synced %d\n", ntp_driver_is_synced() ? 1 : 0);
+    PROM_APPEND("# HELP historian_samples_total Samples stored since the last config change\n");
+    PROM_APPEND("# TYPE historian_samples_total counter\n");
+    PROM_APPEND("historian_samples_total %lu\n", (unsigned long)hs->samples);
 
-  PROM_APPEND("# HELP ntp_sync_count Total NTP synchronizations since boot\n");
-  PROM_APPEND("# TYPE ntp_sync_count counter\n");
-  PROM_APPEND("ntp_sync_count %lu\n", (unsigned long)ntp_driver_get_sync_count());
+    PROM_APPEND("# HELP historian_late_total Samples skipped because the loop was late\n");
+    PROM_APPEND("# TYPE historian_late_total counter\n");
+    PROM_APPEND("historian_late_total %lu\n", (unsigned long)hs->late);
 
-  if (ntp_driver_is_synced()) {
-    PROM_APPEND("# HELP ntp_epoch_seconds Current epoch time\n");
-    PROM_APPEND("# TYPE ntp_epoch_seconds gauge\n");
-    PROM_APPEND("ntp_epoch_seconds %lu\n", (unsigned long)ntp_driver_get_epoch());
+    PROM_APPEND("# HELP historian_spill_quota_bytes Effective spill budget (spill_kb clamped to the partition)\n");
+    PROM_APPEND("# TYPE historian_spill_quota_bytes gauge\n");
+    PROM_APPEND("historian_spill_quota_bytes %lu\n", (unsigned long)hs->spill_quota);
 
-    PROM_APPEND("# HELP ntp_last_sync_age_ms Milliseconds since last sync\n");
-    PROM_APPEND("# TYPE ntp_last_sync_age_ms gauge\n");
-    PROM_APPEND("ntp_last_sync_age_ms %lu\n", (unsigned long)ntp_driver_get_last_sync_age_ms());
-  }
+    PROM_APPEND("# HELP historian_spill_files_total Spill files written to flash\n");
+    PROM_APPEND("# TYPE historian_spill_files_total counter\n");
+    PROM_APPEND("historian_spill_files_total %lu\n", (unsigned long)hs->spill_files);
 
-  // --- Alarm log metrics ---
-  alarm_check_thresholds();
-  PROM_APPEND("# HELP alarm_log_count Total alarm entries in log\n");
-  PROM_APPEND("# TYPE alarm_log_count gauge\n");
-  PROM_APPEND("alarm_log_count %d\n", alarm_log_count);
+    PROM_APPEND("# HELP historian_spill_bytes_total Bytes written to spill files\n");
+    PROM_APPEND("# TYPE historian_spill_bytes_total counter\n");
+    PROM_APPEND("historian_spill_bytes_total %lu\n", (unsigned long)hs->spill_bytes);
 
-  uint8_t unack = 0;
-  for (int i = 0; i < alarm_log_count; i++) {
-    int idx = (alarm_log_head - alarm_log_count + i + ALARM_LOG_MAX) % ALARM_LOG_MAX;
-    if (!alarm_log[idx].acknowledged) unack++;
+    PROM_APPEND("# HELP historian_spill_errors_total Failed spill writes\n");
+    PROM_APPEND("# TYPE historian_spill_errors_total counter\n");
+    PROM_APPEND("historian_spill_errors_total %lu\n", (unsigned long)hs->spill_errors);
+
+    PROM_APPEND("# HELP historian_spill_dropped_total Raw blocks overwritten before spill\n");
+    PROM_APPEND("# TYPE historian_spill_dropped_total counter\n");
+    PROM_APPEND("historian_spill_dropped_total %lu\n", (unsigned long)hs->spill_dropped);
+
+    PROM_APPEND("# HELP historian_queries_total Range queries served\n");
+    PROM_APPEND("# TYPE historian_queries_total counter\n");
+    PROM_APPEND("historian_queries_total %lu\n", (unsigned long)hs->queries);
   }
-  PROM_APPEND("# HELP alarm_unacknowledged_count Unacknowledged alarms\n");
-  PROM_APPEND("# TYPE alarm_unacknowledged_count gauge\n");
-  PROM_APPEND("alarm_unacknowledged_count %d\n", unack);
 
   #undef PROM_APPEND
 
-  // Send as text/plain (Prometheus format)
-  httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
-  httpd_resp_set_hdr(req, "Cache-Control", "no-store");
-  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-  httpd_resp_sendstr(req, buf);
-  free(buf);
+  // Flush the tail and terminate the chunked response
+  prom_flush(&pw);
+  if (pw.err != ESP_OK) {
+    if (debug_flags_get()->http_api) {
+      debug_printf("[API] %s -> stream aborted (%s)\n", req->uri, esp_err_to_name(pw.err));
+    }
+    http_server_stat_server_error();
+    return pw.err;
+  }
+  httpd_resp_send_chunk(req, NULL, 0);
 
   http_server_stat_success();
   return ESP_OK;
@@ -6353,7 +7504,17 @@ esp_err_t api_handler_persist_groups_list(httpd_req_t *req)
       (unsigned long)grp->last_save_ms);
   }
 
-  pos += snprintf(buf + pos, 2048 - pos, "]}");
+  // v7.9.9.5: group journal (SAVE() target)
+  PersistJournalInfo ji;
+  registers_persist_journal_info(&ji);
+  pos += snprintf(buf + pos, 2048 - pos,
+    "],\"journal\":{\"active\":%s,\"size\":%lu,\"sectors\":%u,\"active_sector\":%u,"
+    "\"free_in_sector\":%lu,\"appends\":%lu,\"unchanged\":%lu,\"relocated\":%lu,"
+    "\"erases\":%lu,\"torn\":%lu,\"min_sector_erases\":%lu,\"max_sector_erases\":%lu}}",
+    ji.active ? "true" : "false", (unsigned long)ji.size, ji.sectors, ji.active_sector,
+    (unsigned long)ji.free_in_sector, (unsigned long)ji.appends, (unsigned long)ji.unchanged,
+    (unsigned long)ji.relocated, (unsigned long)ji.erases, (unsigned long)ji.torn,
+    (unsigned long)ji.min_erases, (unsigned long)ji.max_erases);
 
   esp_err_t ret = api_send_json(req, buf);
   free(buf);
@@ -6522,7 +7683,7 @@ esp_err_t api_handler_persist_save(httpd_req_t *req)
     // No body = save all
     registers_persist_save_all_groups();
     g_persist_config.crc16 = config_calculate_crc16(&g_persist_config);
-    if (config_save_to_nvs(&g_persist_config)) {
+    if (config_save_to_nvs_wait(&g_persist_config, PW_WAIT_TIMEOUT_MS)) {
       return api_send_json(req, "{\"status\":200,\"message\":\"All groups saved to NVS\"}");
     }
     return api_send_error(req, 500, "NVS write failed");
@@ -6550,7 +7711,7 @@ esp_err_t api_handler_persist_save(httpd_req_t *req)
   }
 
   g_persist_config.crc16 = config_calculate_crc16(&g_persist_config);
-  if (config_save_to_nvs(&g_persist_config)) {
+  if (config_save_to_nvs_wait(&g_persist_config, PW_WAIT_TIMEOUT_MS)) {
     return api_send_json(req, "{\"status\":200,\"message\":\"Saved to NVS\"}");
   }
   return api_send_error(req, 500, "NVS write failed");
@@ -6596,6 +7757,290 @@ esp_err_t api_handler_persist_restore(httpd_req_t *req)
   return api_send_json(req, "{\"status\":200,\"message\":\"Restored\"}");
 }
 
+/* ============================================================================
+ * FEAT-173: Historian API (v7.9.10.4)
+ *
+ *   GET  /api/history        points, tiers and the time range held
+ *   GET  /api/history/{n}    range query, point 1-8:
+ *                            ?tier=0-3 (raw, 1 min, 10 min, 1 h)
+ *                            ?from=&to= (ms, same clock as the data) or
+ *                            ?last=<seconds> back from now
+ *   POST /api/history        configuration, applied at once (clears RAM history)
+ *
+ * The range reply is CSV by default ("time_ms,value" or
+ * "time_ms,min,max,avg"). With "Accept: application/octet-stream" or
+ * ?format=bin it is the stored blocks (hist_ring.h) behind a 16 byte
+ * header, big-endian:
+ *   [0..1]   magic 'H','I'
+ *   [2]      version (1)
+ *   [3]      point (1-8)
+ *   [4]      tier
+ *   [5]      fields per record (1 raw, 3 tiers)
+ *   [6..7]   block size
+ *   [8..11]  period ms
+ *   [12..15] reserved (0)
+ * followed by every HIST_BLOCK_SIZE block overlapping the range, oldest
+ * first. Records outside [from, to] in the first/last block are not cut.
+ * ============================================================================ */
+
+#define HIST_REPLY_HDR_SIZE   16
+#define HIST_CSV_CHUNK        1024
+
+typedef struct {
+  httpd_req_t *req;
+  uint8_t  fields;
+  uint32_t period_ms;
+  uint64_t from;
+  uint64_t to;
+  uint32_t rows;
+  uint32_t corrupt;
+  int      pos;
+  bool     err;
+  char     buf[HIST_CSV_CHUNK];
+} HistCsvCtx;
+
+static bool api_parse_query_u64(httpd_req_t *req, const char *key, uint64_t *out)
+{
+  char qstr[128];
+  if (httpd_req_get_url_query_str(req, qstr, sizeof(qstr)) != ESP_OK) return false;
+  char val[24];
+  if (httpd_query_key_value(qstr, key, val, sizeof(val)) != ESP_OK) return false;
+  char *end = NULL;
+  unsigned long long v = strtoull(val, &end, 10);
+  if (end == val || *end != '\0') return false;
+  *out = (uint64_t)v;
+  return true;
+}
+
+static bool hist_csv_flush(HistCsvCtx *c)
+{
+  if (c->pos > 0 && httpd_resp_send_chunk(c->req, c->buf, c->pos) != ESP_OK) c->err = true;
+  c->pos = 0;
+  return !c->err;
+}
+
+static bool hist_csv_record(void *ctx, uint64_t t_ms, const int64_t *v)
+{
+  HistCsvCtx *c = (HistCsvCtx *)ctx;
+  if (c->fields == 1) {
+    c->pos += snprintf(c->buf + c->pos, sizeof(c->buf) - c->pos, "%llu,%lld\n",
+                       (unsigned long long)t_ms, (long long)v[0]);
+  } else {
+    c->pos += snprintf(c->buf + c->pos, sizeof(c->buf) - c->pos, "%llu,%lld,%lld,%lld\n",
+                       (unsigned long long)t_ms, (long long)v[0], (long long)v[1], (long long)v[2]);
+  }
+  c->rows++;
+  return c->pos < (int)sizeof(c->buf) - 96 || hist_csv_flush(c);
+}
+
+static bool hist_csv_block(void *ctx, const uint8_t *block)
+{
+  HistCsvCtx *c = (HistCsvCtx *)ctx;
+  if (hist_block_decode(block, c->fields, c->period_ms, c->from, c->to, hist_csv_record, c) < 0) {
+    c->corrupt++;
+  }
+  return !c->err;
+}
+
+static bool hist_bin_block(void *ctx, const uint8_t *block)
+{
+  return httpd_resp_send_chunk((httpd_req_t *)ctx, (const char *)block, HIST_BLOCK_SIZE) == ESP_OK;
+}
+
+esp_err_t api_handler_history_get(httpd_req_t *req)
+{
+  http_server_stat_request();
+  CHECK_AUTH(req);
+
+  const HistorianStats *hs = historian_get_stats();
+  JsonDocument doc;
+  doc["enabled"] = g_persist_config.historian.enabled ? true : false;
+  doc["active"] = hs->active;
+  doc["pool_bytes"] = hs->pool_bytes;
+  doc["pool"] = hs->psram ? "psram" : "dram";
+  doc["spill_kb"] = g_persist_config.historian.spill_kb;
+  doc["spill_quota_bytes"] = hs->spill_quota;
+  doc["clock"] = ntp_driver_is_synced() ? "unix_ms" : "uptime_ms";
+  doc["now_ms"] = historian_now_ms();
+  doc["samples"] = hs->samples;
+  doc["late"] = hs->late;
+
+  JsonArray points = doc["points"].to<JsonArray>();
+  for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+    HistorianPointStatus st;
+    historian_point_status(p, &st);
+    if (st.cfg.source == HIST_SRC_OFF) continue;
+    JsonObject o = points.add<JsonObject>();
+    o["id"] = p + 1;
+    o["source"] = historian_source_name(st.cfg.source);
+    o["address"] = st.cfg.address;
+    o["interval_ms"] = st.cfg.interval_ms;
+    o["sampling"] = st.sampling;
+    if (!st.sampling) continue;
+    o["value"] = st.last_value;
+    o["spill_files"] = st.spill_files;
+    o["spill_slots"] = st.spill_slots;
+    JsonArray tiers = o["tiers"].to<JsonArray>();
+    for (uint8_t t = 0; t < HIST_TIER_COUNT; t++) {
+      if (st.capacity[t] == 0) continue;
+      JsonObject to = tiers.add<JsonObject>();
+      to["tier"] = t;
+      to["period_ms"] = t == HIST_TIER_RAW ? st.cfg.interval_ms : hist_tier_period_ms[t];
+      to["records"] = st.records[t];
+      to["blocks"] = st.blocks[t];
+      to["capacity"] = st.capacity[t];
+      if (st.blocks[t] > 0) {
+        to["oldest_ms"] = st.oldest_ms[t];
+        to["newest_ms"] = st.newest_ms[t];
+      }
+    }
+  }
+
+  size_t len = measureJson(doc) + 1;
+  char *buf = (char *)malloc(len);
+  if (!buf) return api_send_error(req, 500, "Out of memory");
+  serializeJson(doc, buf, len);
+  esp_err_t ret = api_send_json(req, buf);
+  free(buf);
+  return ret;
+}
+
+esp_err_t api_handler_history_point_get(httpd_req_t *req)
+{
+  http_server_stat_request();
+  CHECK_AUTH(req);
+
+  int id = api_extract_id_from_uri(req, "/api/history/");
+  if (id < 1 || id > HIST_MAX_POINTS) {
+    return api_send_error(req, 400, "Invalid point (must be 1-8)");
+  }
+  HistorianPointStatus st;
+  historian_point_status((uint8_t)(id - 1), &st);
+  if (!st.sampling) {
+    return api_send_error(req, 404, "Point not sampling");
+  }
+
+  uint32_t tier = HIST_TIER_RAW;
+  if (api_parse_query_u32(req, "tier", &tier) && (tier >= HIST_TIER_COUNT || st.capacity[tier] == 0)) {
+    return api_send_error(req, 400, "Tier not available for this point");
+  }
+  uint64_t from = 0, to = UINT64_MAX, last_s = 0;
+  api_parse_query_u64(req, "from", &from);
+  api_parse_query_u64(req, "to", &to);
+  if (api_parse_query_u64(req, "last", &last_s)) {
+    uint64_t now = historian_now_ms();
+    from = last_s * 1000 < now ? now - last_s * 1000 : 0;
+  }
+  if (from > to) {
+    return api_send_error(req, 400, "from after to");
+  }
+
+  char fmt[8] = "";
+  char qstr[128];
+  if (httpd_req_get_url_query_str(req, qstr, sizeof(qstr)) == ESP_OK) {
+    httpd_query_key_value(qstr, "format", fmt, sizeof(fmt));
+  }
+  bool binary = api_wants_reg_block(req) || !strcmp(fmt, "bin");
+  uint8_t fields = tier == HIST_TIER_RAW ? 1 : 3;
+  uint32_t period = tier == HIST_TIER_RAW ? st.cfg.interval_ms : hist_tier_period_ms[tier];
+
+  httpd_resp_set_hdr(req, "Cache-Control", "no-store, no-cache, must-revalidate");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  httpd_resp_set_hdr(req, "X-History-Clock", ntp_driver_is_synced() ? "unix_ms" : "uptime_ms");
+
+  uint32_t blocks = 0;
+  uint32_t rows = 0;
+  if (binary) {
+    uint8_t hdr[HIST_REPLY_HDR_SIZE] = { 0 };
+    hdr[0] = 'H';
+    hdr[1] = 'I';
+    hdr[2] = 1;
+    hdr[3] = (uint8_t)id;
+    hdr[4] = (uint8_t)tier;
+    hdr[5] = fields;
+    put_be16(hdr + 6, HIST_BLOCK_SIZE);
+    put_be32(hdr + 8, period);
+    httpd_resp_set_type(req, REG_BLOCK_MIME);
+    httpd_resp_send_chunk(req, (const char *)hdr, sizeof(hdr));
+    blocks = historian_query((uint8_t)(id - 1), (uint8_t)tier, from, to, hist_bin_block, req);
+  } else {
+    HistCsvCtx *c = (HistCsvCtx *)calloc(1, sizeof(HistCsvCtx));
+    if (!c) return api_send_error(req, 500, "Out of memory");
+    c->req = req;
+    c->fields = fields;
+    c->period_ms = period;
+    c->from = from;
+    c->to = to;
+    c->pos = snprintf(c->buf, sizeof(c->buf), fields == 1 ? "time_ms,value\n" : "time_ms,min,max,avg\n");
+    httpd_resp_set_type(req, "text/csv");
+    blocks = historian_query((uint8_t)(id - 1), (uint8_t)tier, from, to, hist_csv_block, c);
+    hist_csv_flush(c);
+    rows = c->rows;
+    if (c->corrupt && debug_flags_get()->http_api) {
+      debug_printf("[API] %s: %lu corrupt history blocks skipped\n", req->uri, (unsigned long)c->corrupt);
+    }
+    free(c);
+  }
+  httpd_resp_send_chunk(req, NULL, 0);
+
+  if (debug_flags_get()->http_api) {
+    debug_printf("[API] %s -> 200 OK (%lu blocks, %lu rows)\n", req->uri,
+                 (unsigned long)blocks, (unsigned long)rows);
+  }
+  http_server_stat_success();
+  return ESP_OK;
+}
+
+esp_err_t api_handler_history_post(httpd_req_t *req)
+{
+  http_server_stat_request();
+  CHECK_AUTH_WRITE(req);
+
+  char body[1024];
+  int len = httpd_req_recv(req, body, sizeof(body) - 1);
+  if (len <= 0) {
+    return api_send_error(req, 400, "Empty request body");
+  }
+  body[len] = '\0';
+
+  JsonDocument doc;
+  if (deserializeJson(doc, body)) {
+    return api_send_error(req, 400, "Invalid JSON");
+  }
+
+  // Validate everything on a copy first: a bad point changes nothing
+  HistorianConfig cfg = g_persist_config.historian;
+  if (doc.containsKey("enabled")) {
+    cfg.enabled = doc["enabled"].as<bool>() ? 1 : 0;
+  }
+  if (doc.containsKey("spill_kb")) {
+    uint32_t kb = doc["spill_kb"].as<uint32_t>();
+    if (kb > 255) return api_send_error(req, 400, "spill_kb must be 0-255");
+    cfg.spill_kb = (uint8_t)kb;
+  }
+  for (JsonObject p : doc["points"].as<JsonArray>()) {
+    int id = p["id"] | 0;
+    if (id < 1 || id > HIST_MAX_POINTS) {
+      return api_send_error(req, 400, "Invalid point id (must be 1-8)");
+    }
+    HistPointConfig *pc = &cfg.points[id - 1];
+    if (p.containsKey("source") && !historian_source_parse(p["source"].as<const char*>(), &pc->source)) {
+      return api_send_error(req, 400, "source must be off, hr, ir or counter");
+    }
+    if (p.containsKey("address")) pc->address = p["address"].as<uint16_t>();
+    if (p.containsKey("interval_ms")) pc->interval_ms = p["interval_ms"].as<uint32_t>();
+    const char *why = historian_point_check(pc);
+    if (why) {
+      return api_send_error(req, 400, why);
+    }
+  }
+
+  g_persist_config.historian = cfg;
+  historian_apply(&g_persist_config.historian);
+
+  return api_send_json(req, "{\"status\":200,\"message\":\"Historian config updated. Save to persist.\"}");
+}
+
 /* ============================================================================
  * FEAT-028: Request Rate Limiting (v7.0.4)
  *
@@ -6748,8 +8193,7 @@ esp_err_t api_v1_dispatch_delete(httpd_req_t *req)
 
 // Routing table entry
 typedef struct {
-  const char *prefix;     // URI prefix to match (after v1 rewrite)
-  bool exact;             // true = exact match, false = prefix match
+  const char *path;       // "/api/x" = exact, "/api/x/" = catch-all below /api/x (after v1 rewrite)
   int method;             // HTTP_GET, HTTP_POST, HTTP_DELETE, or -1 for any
   esp_err_t (*handler)(httpd_req_t *req);
 } V1Route;
@@ -6774,6 +8218,7 @@ extern esp_err_t api_handler_hr_bulk_read(httpd_req_t *req);
 extern esp_err_t api_handler_ir_bulk_read(httpd_req_t *req);
 extern esp_err_t api_handler_coils_bulk_read(httpd_req_t *req);
 extern esp_err_t api_handler_di_bulk_read(httpd_req_t *req);
+extern esp_err_t api_handler_registers_multi(httpd_req_t *req);
 extern esp_err_t api_handler_heartbeat(httpd_req_t *req);
 extern esp_err_t api_handler_sse_status(httpd_req_t *req);
 extern esp_err_t api_handler_sse_clients(httpd_req_t *req);
@@ -6791,92 +8236,29 @@ extern esp_err_t api_handler_cli_exec(httpd_req_t *req);
 extern esp_err_t api_handler_bindings_list(httpd_req_t *req);
 extern esp_err_t api_handler_bindings_delete(httpd_req_t *req);
 
-// Routing table — order matters (more specific first)
+// Routing table (api_v1_routes.h) — compiled into v1_router on first request (FEAT-151).
+#define API_V1_ROUTE(path, method, handler) {path, method, handler},
 static const V1Route v1_routes[] = {
-  // Exact matches first
-  {"/api/status",           true,  HTTP_GET,    api_handler_status},
-  {"/api/config",           true,  HTTP_GET,    api_handler_config_get},
-  {"/api/counters",         true,  HTTP_GET,    api_handler_counters},
-  {"/api/timers",           true,  HTTP_GET,    api_handler_timers},
-  {"/api/logic",            true,  HTTP_GET,    api_handler_logic},
-  {"/api/gpio",             true,  HTTP_GET,    api_handler_gpio},
-  {"/api/wifi",             true,  HTTP_GET,    api_handler_wifi_get},
-  {"/api/wifi",             true,  HTTP_POST,   api_handler_wifi_post},
-  {"/api/ethernet",         true,  HTTP_GET,    api_handler_ethernet_get},
-  {"/api/ethernet",         true,  HTTP_POST,   api_handler_ethernet_post},
-  {"/api/debug",            true,  HTTP_GET,    api_handler_debug_get},
-  {"/api/debug",            true,  HTTP_POST,   api_handler_debug_set},
-  {"/api/modules",          true,  HTTP_GET,    api_handler_modules_get},
-  {"/api/modules",          true,  HTTP_POST,   api_handler_modules_post},
-  {"/api/hostname",         true,  HTTP_GET,    api_handler_hostname_get},
-  {"/api/hostname",         true,  HTTP_POST,   api_handler_hostname_post},
-  {"/api/telnet",           true,  HTTP_GET,    api_handler_telnet_get},
-  {"/api/telnet",           true,  HTTP_POST,   api_handler_telnet_post},
-  {"/api/system/reboot",    true,  HTTP_POST,   api_handler_system_reboot},
-  {"/api/system/save",      true,  HTTP_POST,   api_handler_system_save},
-  {"/api/system/load",      true,  HTTP_POST,   api_handler_system_load},
-  {"/api/system/defaults",  true,  HTTP_POST,   api_handler_system_defaults},
-  {"/api/system/watchdog",  true,  HTTP_GET,    api_handler_system_watchdog},
-  {"/api/system/backup",    true,  HTTP_GET,    api_handler_system_backup},
-  {"/api/system/restore",   true,  HTTP_POST,   api_handler_system_restore},
-  {"/api/http",             true,  HTTP_POST,   api_handler_http_config_post},
-  {"/api/logic/settings",   true,  HTTP_POST,   api_handler_logic_settings_post},
-  {"/api/dashboard/layout", true,  HTTP_GET,    api_handler_dashboard_layout_get},
-  {"/api/dashboard/layout", true,  HTTP_POST,   api_handler_dashboard_layout_post},
-  {"/api/events/status",    true,  HTTP_GET,    api_handler_sse_status},
-  {"/api/events/clients",   true,  HTTP_GET,    api_handler_sse_clients},
-  {"/api/events/disconnect", true, HTTP_POST,   api_handler_sse_disconnect},
-  {"/api/version",          true,  HTTP_GET,    api_handler_api_version},
-  {"/api/metrics",          true,  HTTP_GET,    api_handler_metrics},
-  {"/api/persist/groups",   true,  HTTP_GET,    api_handler_persist_groups_list},
-  {"/api/persist/save",     true,  HTTP_POST,   api_handler_persist_save},
-  {"/api/persist/restore",  true,  HTTP_POST,   api_handler_persist_restore},
-  {"/api/user/me",          true,  HTTP_GET,    api_handler_user_me},
-  {"/api/cli",              true,  HTTP_POST,   api_handler_cli_exec},
-  {"/api/bindings",         true,  HTTP_GET,    api_handler_bindings_list},
-
-  // Bulk register operations (before wildcards)
-  {"/api/registers/hr",     true,  HTTP_GET,    api_handler_hr_bulk_read},
-  {"/api/registers/ir",     true,  HTTP_GET,    api_handler_ir_bulk_read},
-  {"/api/registers/coils",  true,  HTTP_GET,    api_handler_coils_bulk_read},
-  {"/api/registers/di",     true,  HTTP_GET,    api_handler_di_bulk_read},
-  {"/api/registers/hr/bulk", true,  HTTP_POST,  api_handler_hr_bulk_write},
-  {"/api/registers/coils/bulk", true, HTTP_POST, api_handler_coils_bulk_write},
-
-  // Heartbeat (before gpio wildcard — more specific match first)
-  {"/api/gpio/2/heartbeat", true,  HTTP_GET,    api_handler_heartbeat},
-  {"/api/gpio/2/heartbeat", true,  HTTP_POST,   api_handler_heartbeat},
-
-  // Wildcard prefix matches
-  {"/api/counters/",        false, HTTP_GET,    api_handler_counter_single},
-  {"/api/counters/",        false, HTTP_POST,   api_handler_counter_single},
-  {"/api/counters/",        false, HTTP_DELETE,  api_handler_counter_delete},
-  {"/api/timers/",          false, HTTP_GET,    api_handler_timer_single},
-  {"/api/timers/",          false, HTTP_POST,   api_handler_timer_config_post},
-  {"/api/timers/",          false, HTTP_DELETE,  api_handler_timer_delete},
-  {"/api/registers/hr/",    false, HTTP_GET,    api_handler_hr_read},
-  {"/api/registers/hr/",    false, HTTP_POST,   api_handler_hr_write},
-  {"/api/registers/ir/",    false, HTTP_GET,    api_handler_ir_read},
-  {"/api/registers/coils/", false, HTTP_GET,    api_handler_coil_read},
-  {"/api/registers/coils/", false, HTTP_POST,   api_handler_coil_write},
-  {"/api/registers/di/",    false, HTTP_GET,    api_handler_di_read},
-  {"/api/gpio/",            false, HTTP_GET,    api_handler_gpio_single},
-  {"/api/gpio/",            false, HTTP_POST,   api_handler_gpio_write},
-  {"/api/gpio/",            false, HTTP_DELETE,  api_handler_gpio_config_delete},
-  {"/api/logic/",           false, HTTP_GET,    api_handler_logic_single},
-  {"/api/logic/",           false, HTTP_POST,   api_handler_logic_single},
-  {"/api/logic/",           false, HTTP_DELETE,  api_handler_logic_delete},
-  {"/api/modbus/",          false, HTTP_GET,    api_handler_modbus_get},
-  {"/api/modbus/",          false, HTTP_POST,   api_handler_modbus_post},
-  {"/api/wifi/",            false, HTTP_POST,   api_handler_wifi_post},
-  {"/api/persist/groups/",  false, HTTP_GET,    api_handler_persist_group_single},
-  {"/api/persist/groups/",  false, HTTP_POST,   api_handler_persist_group_post},
-  {"/api/persist/groups/",  false, HTTP_DELETE,  api_handler_persist_group_delete},
-  {"/api/bindings/",        false, HTTP_DELETE,  api_handler_bindings_delete},
+  API_V1_ROUTES
 
   // Sentinel
-  {NULL, false, -1, NULL}
+  {NULL, -1, NULL}
 };
+#undef API_V1_ROUTE
+
+static ApiRouter v1_router;
+static bool v1_router_ready = false;
+
+static void v1_router_build(void)
+{
+  api_router_init(&v1_router);
+  for (int i = 0; v1_routes[i].path != NULL; i++) {
+    if (!api_router_add(&v1_router, v1_routes[i].path, v1_routes[i].method, (uint8_t)i)) {
+      debug_printf("[API] v1 router full, route %s dropped\n", v1_routes[i].path);
+    }
+  }
+  v1_router_ready = true;
+}
 
 static esp_err_t v1_dispatch(httpd_req_t *req)
 {
@@ -6890,32 +8272,28 @@ static esp_err_t v1_dispatch(httpd_req_t *req)
     return api_send_error(req, 400, "Invalid v1 API path");
   }
 
-  const char *uri = req->uri;
-  int method = req->method;
-
-  // Try routing table
-  for (int i = 0; v1_routes[i].prefix != NULL; i++) {
-    const V1Route *r = &v1_routes[i];
-
-    // Check method
-    if (r->method != -1 && r->method != method) continue;
-
-    // Check URI match
-    if (r->exact) {
-      if (strcmp(uri, r->prefix) != 0) continue;
-    } else {
-      if (strncmp(uri, r->prefix, strlen(r->prefix)) != 0) continue;
-    }
-
-    // Match found — call handler
-    esp_err_t result = r->handler(req);
+  // httpd runs handlers on a single task, so lazy build needs no lock
+  if (!v1_router_ready) {
+    v1_router_build();
+  }
 
-    // Restore URI
+  ApiRouteMatch m = api_router_match(&v1_router, req->uri, req->method);
+  if (m.route_id < 0) {
+    // No match — restore URI and return 404
     v1_restore_uri(req, orig_len);
-    return result;
+    return api_send_error(req, 404, "Endpoint not found in API v1");
   }
 
-  // No match — restore URI and return 404
+  // Publish the ID parsed by the router so api_extract_id_from_uri() can skip re-parsing
+  if (m.rest) {
+    api_route_id_ctx.req = req;
+    api_route_id_ctx.rest = m.rest;
+    api_route_id_ctx.id = api_parse_uri_id(m.rest);
+  }
+
+  esp_err_t result = v1_routes[m.route_id].handler(req);
+
+  api_route_id_ctx.req = NULL;
   v1_restore_uri(req, orig_len);
-  return api_send_error(req, 404, "Endpoint not found in API v1");
+  return result;
 }
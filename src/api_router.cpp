@@ -0,0 +1,169 @@
+/**
+ * @file api_router.cpp
+ * @brief Segment trie router for the /api/v1 dispatcher (v7.9.8.2)
+ *
+ * LAYER 1.5: Protocol helper (pure, host-testable)
+ * Each trie node is one path segment. Child lookup goes through a single
+ * open-addressing hash table keyed on (parent index, segment hash), so a
+ * lookup touches one or two slots per segment.
+ */
+
+#include "api_router.h"
+#include <string.h>
+
+/* FNV-1a over one segment, folded to 16 bits */
+static uint16_t seg_hash(const char *s, uint8_t len)
+{
+  uint32_t h = 2166136261u;
+  for (uint8_t i = 0; i < len; i++) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619u;
+  }
+  return (uint16_t)(h ^ (h >> 16));
+}
+
+static uint8_t slot_of(uint8_t parent, uint16_t hash)
+{
+  uint32_t k = ((uint32_t)parent * 0x9E3779B1u) ^ hash;
+  return (uint8_t)((k ^ (k >> 7)) & (API_ROUTER_HASH_SLOTS - 1));
+}
+
+static int find_child(const ApiRouter *r, uint8_t parent, const char *seg, uint8_t len, uint16_t hash)
+{
+  uint8_t slot = slot_of(parent, hash);
+  for (int probe = 0; probe < API_ROUTER_HASH_SLOTS; probe++) {
+    uint8_t v = r->slots[slot];
+    if (v == 0) return -1;
+    const ApiRouterNode *n = &r->nodes[v - 1];
+    if (n->parent == parent && n->seg_hash == hash && n->seg_len == len &&
+        memcmp(n->seg, seg, len) == 0) {
+      return v - 1;
+    }
+    slot = (slot + 1) & (API_ROUTER_HASH_SLOTS - 1);
+  }
+  return -1;
+}
+
+static int add_child(ApiRouter *r, uint8_t parent, const char *seg, uint8_t len, uint16_t hash)
+{
+  if (r->node_count >= API_ROUTER_MAX_NODES) return -1;
+
+  uint8_t slot = slot_of(parent, hash);
+  while (r->slots[slot] != 0) {
+    slot = (slot + 1) & (API_ROUTER_HASH_SLOTS - 1);
+  }
+
+  uint8_t idx = r->node_count++;
+  ApiRouterNode *n = &r->nodes[idx];
+  n->seg = seg;
+  n->seg_len = len;
+  n->seg_hash = hash;
+  n->parent = parent;
+  n->exact_head = API_ROUTER_NONE;
+  n->rest_head = API_ROUTER_NONE;
+  r->slots[slot] = idx + 1;
+  return idx;
+}
+
+/* Append route to a node list (keeps add order = precedence order) */
+static void list_append(ApiRouter *r, uint8_t *head, uint8_t route_id)
+{
+  while (*head != API_ROUTER_NONE) {
+    head = &r->routes[*head].next;
+  }
+  *head = route_id;
+}
+
+/* First route in list accepting this method, or -1 */
+static int list_find(const ApiRouter *r, uint8_t head, int method)
+{
+  while (head != API_ROUTER_NONE) {
+    const ApiRouterRoute *rt = &r->routes[head];
+    if (rt->method == API_ROUTER_METHOD_ANY || rt->method == method) return head;
+    head = rt->next;
+  }
+  return -1;
+}
+
+void api_router_init(ApiRouter *r)
+{
+  memset(r, 0, sizeof(*r));
+  // Node 0 is the root ("" before the first '/')
+  r->nodes[0].exact_head = API_ROUTER_NONE;
+  r->nodes[0].rest_head = API_ROUTER_NONE;
+  r->node_count = 1;
+}
+
+bool api_router_add(ApiRouter *r, const char *path, int method, uint8_t route_id)
+{
+  if (!path || path[0] != '/' || route_id >= API_ROUTER_MAX_ROUTES) return false;
+
+  uint8_t node = 0;
+  const char *p = path;
+  bool catch_all = false;
+
+  while (*p == '/') {
+    const char *seg = ++p;
+    while (*p && *p != '/') p++;
+    uint8_t len = (uint8_t)(p - seg);
+    if (len == 0) {
+      // Trailing "/" marks a catch-all on the current node
+      catch_all = true;
+      break;
+    }
+    uint16_t h = seg_hash(seg, len);
+    int child = find_child(r, node, seg, len, h);
+    if (child < 0) child = add_child(r, node, seg, len, h);
+    if (child < 0) return false;
+    node = (uint8_t)child;
+  }
+
+  r->routes[route_id].method = (int8_t)method;
+  r->routes[route_id].next = API_ROUTER_NONE;
+  list_append(r, catch_all ? &r->nodes[node].rest_head : &r->nodes[node].exact_head, route_id);
+  return true;
+}
+
+ApiRouteMatch api_router_match(const ApiRouter *r, const char *uri, int method)
+{
+  ApiRouteMatch best = { -1, NULL };
+  if (!uri || uri[0] != '/') return best;
+
+  uint8_t node = 0;
+  const char *p = uri;
+
+  while (*p == '/') {
+    const char *seg = ++p;
+
+    // Anything below this node can fall back to its catch-all
+    int rid = list_find(r, r->nodes[node].rest_head, method);
+    if (rid >= 0) {
+      best.route_id = rid;
+      best.rest = seg;
+    }
+
+    // Hash the segment while scanning for its end
+    uint32_t h = 2166136261u;
+    while (*p && *p != '/' && *p != '?') {
+      h ^= (uint8_t)*p++;
+      h *= 16777619u;
+    }
+    size_t len = (size_t)(p - seg);
+    if (len == 0 || len > 255) break;
+
+    int child = find_child(r, node, seg, (uint8_t)len, (uint16_t)(h ^ (h >> 16)));
+    if (child < 0) break;
+    node = (uint8_t)child;
+
+    if (*p != '/') {
+      // End of path (or start of query string): exact route wins
+      rid = list_find(r, r->nodes[node].exact_head, method);
+      if (rid >= 0) {
+        best.route_id = rid;
+        best.rest = NULL;
+      }
+      break;
+    }
+  }
+  return best;
+}
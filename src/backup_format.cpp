@@ -0,0 +1,256 @@
+/**
+ * @file backup_format.cpp
+ * @brief Binary config backup container (v7.9.10.1)
+ *
+ * LAYER 6: Persistence - Backup format (pure, no ESP-IDF)
+ * The writer batches small fields into BK_WRITE_BUF before calling the
+ * sink (one HTTP chunk per flush); the reader is a byte-exact state
+ * machine, so chunk boundaries may fall anywhere, also inside headers.
+ */
+
+#include "backup_format.h"
+#include <string.h>
+
+enum {
+  RD_FILE_HDR = 0,
+  RD_REC_HDR,
+  RD_PAYLOAD,
+  RD_CRC,
+  RD_DONE
+};
+
+/* ============================================================================
+ * CRC-32 (zlib compatible, nibble table)
+ * ============================================================================ */
+
+static const uint32_t crc_nibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t bk_crc32(uint32_t crc, const void *data, uint32_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  crc = ~crc;
+  for (uint32_t i = 0; i < len; i++) {
+    crc ^= p[i];
+    crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+    crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+/* ============================================================================
+ * WRITER
+ * ============================================================================ */
+
+static void wr_flush(BkWriter *w) {
+  if (w->pos > 0 && w->err == BK_OK && !w->sink->write(w->sink->ctx, w->buf, w->pos)) {
+    w->err = BK_ERR_SINK;
+  }
+  w->pos = 0;
+}
+
+static void wr_out(BkWriter *w, const void *data, uint32_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  while (len > 0 && w->err == BK_OK) {
+    uint32_t n = BK_WRITE_BUF - w->pos;
+    if (n > len) n = len;
+    memcpy(w->buf + w->pos, p, n);
+    w->pos += n;
+    p += n;
+    len -= n;
+    if (w->pos == BK_WRITE_BUF) wr_flush(w);
+  }
+}
+
+void bk_writer_init(BkWriter *w, const BkSink *sink, uint16_t flags) {
+  memset(w, 0, sizeof(*w));
+  w->sink = sink;
+  BkFileHeader fh;
+  fh.magic = BK_MAGIC;
+  fh.format = BK_FORMAT_VERSION;
+  fh.flags = flags;
+  w->header_crc = bk_crc32(0, &fh, sizeof(fh));
+  wr_out(w, &fh, sizeof(fh));
+}
+
+bool bk_begin(BkWriter *w, uint8_t type, uint8_t id, uint8_t version, uint32_t len) {
+  if (w->open || w->err != BK_OK) return false;
+  BkRecordHeader h;
+  h.type = type;
+  h.id = id;
+  h.version = version;
+  h.reserved = 0;
+  h.len = len;
+  w->crc = bk_crc32(0, &h, sizeof(h));
+  w->remaining = len;
+  w->open = true;
+  wr_out(w, &h, sizeof(h));
+  return w->err == BK_OK;
+}
+
+bool bk_data(BkWriter *w, const void *data, uint32_t len) {
+  if (!w->open || len > w->remaining) return false;
+  w->crc = bk_crc32(w->crc, data, len);
+  w->remaining -= len;
+  wr_out(w, data, len);
+  return w->err == BK_OK;
+}
+
+bool bk_end(BkWriter *w) {
+  if (!w->open || w->remaining != 0) return false;
+  w->open = false;
+  w->records++;
+  wr_out(w, &w->crc, sizeof(w->crc));
+  return w->err == BK_OK;
+}
+
+bool bk_record(BkWriter *w, uint8_t type, uint8_t id, uint8_t version,
+               const void *data, uint32_t len) {
+  return bk_begin(w, type, id, version, len) && bk_data(w, data, len) && bk_end(w);
+}
+
+BkError bk_finish(BkWriter *w) {
+  if (w->err != BK_OK) return w->err;
+  if (w->open) return BK_ERR_TRUNCATED;
+  BkEnd end;
+  end.records = w->records;
+  end.header_crc = w->header_crc;
+  bk_record(w, BK_REC_END, 0, 0, &end, sizeof(end));
+  wr_flush(w);
+  return w->err;
+}
+
+/* ============================================================================
+ * READER
+ * ============================================================================ */
+
+void bk_reader_init(BkReader *r, const BkHandler *h, uint32_t max_payload) {
+  memset(r, 0, sizeof(*r));
+  r->h = h;
+  r->max_payload = max_payload;
+  r->state = RD_FILE_HDR;
+}
+
+// Collect up to need bytes of a fixed-size field; true when complete
+static bool rd_collect(BkReader *r, uint8_t *field, uint32_t need,
+                       const uint8_t **p, uint32_t *len) {
+  uint32_t n = need - r->got;
+  if (n > *len) n = *len;
+  memcpy(field + r->got, *p, n);
+  r->got += n;
+  *p += n;
+  *len -= n;
+  if (r->got < need) return false;
+  r->got = 0;
+  return true;
+}
+
+static BkError rd_header(BkReader *r) {
+  memcpy(&r->rec, r->hdr, sizeof(r->rec));
+  r->crc = bk_crc32(0, r->hdr, sizeof(BkRecordHeader));
+  r->dst = NULL;
+  if (r->rec.type == BK_REC_END) {
+    if (r->rec.len != sizeof(r->end_buf)) return BK_ERR_SIZE;
+    r->dst = r->end_buf;
+  } else {
+    if (r->rec.len > r->max_payload) return BK_ERR_SIZE;
+    if (r->h->begin) r->dst = r->h->begin(r->h->ctx, &r->rec);
+  }
+  r->state = r->rec.len ? RD_PAYLOAD : RD_CRC;
+  return BK_OK;
+}
+
+static BkError rd_complete(BkReader *r) {
+  uint32_t stored;
+  memcpy(&stored, r->crc_buf, sizeof(stored));
+  if (stored != r->crc) return BK_ERR_CRC;
+
+  if (r->rec.type == BK_REC_END) {
+    BkEnd end;
+    memcpy(&end, r->end_buf, sizeof(end));
+    if (end.header_crc != r->header_crc) return BK_ERR_CRC;
+    if (end.records != r->records) return BK_ERR_TRUNCATED;
+    r->state = RD_DONE;
+    return BK_OK;
+  }
+  if (r->h->record && !r->h->record(r->h->ctx, &r->rec, r->dst)) return BK_ERR_HANDLER;
+  r->records++;
+  r->state = RD_REC_HDR;
+  return BK_OK;
+}
+
+BkError bk_reader_feed(BkReader *r, const void *data, uint32_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  while (len > 0 && r->err == BK_OK) {
+    switch (r->state) {
+      case RD_FILE_HDR:
+        if (rd_collect(r, r->hdr, sizeof(BkFileHeader), &p, &len)) {
+          BkFileHeader fh;
+          memcpy(&fh, r->hdr, sizeof(fh));
+          if (fh.magic != BK_MAGIC) {
+            r->err = BK_ERR_MAGIC;
+          } else if (fh.format > BK_FORMAT_VERSION) {
+            r->err = BK_ERR_FORMAT;
+          } else {
+            r->flags = fh.flags;
+            r->header_crc = bk_crc32(0, &fh, sizeof(fh));
+            r->state = RD_REC_HDR;
+          }
+        }
+        break;
+
+      case RD_REC_HDR:
+        if (rd_collect(r, r->hdr, sizeof(BkRecordHeader), &p, &len)) {
+          r->err = rd_header(r);
+        }
+        break;
+
+      case RD_PAYLOAD: {
+        uint32_t n = r->rec.len - r->got;
+        if (n > len) n = len;
+        r->crc = bk_crc32(r->crc, p, n);
+        if (r->dst) memcpy(r->dst + r->got, p, n);
+        r->got += n;
+        p += n;
+        len -= n;
+        if (r->got == r->rec.len) {
+          r->got = 0;
+          r->state = RD_CRC;
+        }
+        break;
+      }
+
+      case RD_CRC:
+        if (rd_collect(r, r->crc_buf, sizeof(r->crc_buf), &p, &len)) {
+          r->err = rd_complete(r);
+        }
+        break;
+
+      default:  // RD_DONE
+        r->err = BK_ERR_TRAILING;
+        break;
+    }
+  }
+  return r->err;
+}
+
+BkError bk_reader_finish(BkReader *r) {
+  if (r->err == BK_OK && r->state != RD_DONE) r->err = BK_ERR_TRUNCATED;
+  return r->err;
+}
+
+const char *bk_error_name(BkError e) {
+  switch (e) {
+    case BK_OK:            return "ok";
+    case BK_ERR_MAGIC:     return "not a backup";
+    case BK_ERR_FORMAT:    return "unsupported format version";
+    case BK_ERR_CRC:       return "CRC mismatch";
+    case BK_ERR_SIZE:      return "record too large";
+    case BK_ERR_HANDLER:   return "record rejected";
+    case BK_ERR_TRUNCATED: return "truncated";
+    case BK_ERR_TRAILING:  return "data after end record";
+    case BK_ERR_SINK:      return "write failed";
+    default:               return "?";
+  }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file boot_trace.cpp
+ * @brief Boot timeline profiler (v7.9.10.0)
+ *
+ * LAYER 8: System - Boot diagnostics
+ * A mark costs a micros() read, a short strncpy and a CRC over ~220 bytes
+ * of RTC memory, so it can stay enabled in production builds.
+ */
+
+#include "boot_trace.h"
+#include "watchdog_monitor.h"
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_rom_crc.h>
+#include <stddef.h>
+#include <string.h>
+
+RTC_NOINIT_ATTR static BootTrace rtc_trace;
+static BootTrace prev_trace;
+static bool prev_valid = false;
+static uint32_t last_mark_us = 0;
+
+static uint32_t trace_crc(const BootTrace *t) {
+  return esp_rom_crc32_le(0, (const uint8_t *)t, offsetof(BootTrace, crc32));
+}
+
+static void trace_seal(void) {
+  rtc_trace.crc32 = trace_crc(&rtc_trace);
+}
+
+void boot_trace_begin(void) {
+  uint32_t boot_count = 0;
+  prev_valid = rtc_trace.magic == BOOT_TRACE_MAGIC &&
+               rtc_trace.phase_count <= BOOT_TRACE_MAX_PHASES &&
+               rtc_trace.crc32 == trace_crc(&rtc_trace);
+  if (prev_valid) {
+    prev_trace = rtc_trace;
+    boot_count = rtc_trace.boot_count;
+  }
+
+  memset(&rtc_trace, 0, sizeof(rtc_trace));
+  rtc_trace.magic = BOOT_TRACE_MAGIC;
+  rtc_trace.boot_count = boot_count + 1;
+  rtc_trace.reset_reason = (uint8_t)esp_reset_reason();
+  trace_seal();
+  last_mark_us = 0;
+}
+
+uint32_t boot_trace_mark(const char *phase) {
+  uint32_t now = (uint32_t)micros();
+  uint32_t duration = now - last_mark_us;
+  last_mark_us = now;
+
+  if (rtc_trace.phase_count < BOOT_TRACE_MAX_PHASES) {
+    BootTracePhase *p = &rtc_trace.phases[rtc_trace.phase_count++];
+    strncpy(p->name, phase, BOOT_TRACE_NAME_LEN - 1);
+    p->name[BOOT_TRACE_NAME_LEN - 1] = '\0';
+    p->end_us = now;
+    trace_seal();
+  }
+  return duration;
+}
+
+void boot_trace_ready(void) {
+  if (rtc_trace.ready) return;
+  rtc_trace.ready_us = (uint32_t)micros();
+  rtc_trace.ready = 1;
+  trace_seal();
+  watchdog_record_boot_ready(rtc_trace.ready_us);
+}
+
+const BootTrace *boot_trace_current(void) {
+  return &rtc_trace;
+}
+
+const BootTrace *boot_trace_previous(void) {
+  return prev_valid ? &prev_trace : NULL;
+}
+
+uint32_t boot_trace_phase_us(const BootTrace *t, uint8_t i) {
+  if (i >= t->phase_count) return 0;
+  return t->phases[i].end_us - (i > 0 ? t->phases[i - 1].end_us : 0);
+}
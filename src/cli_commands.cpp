@@ -24,9 +24,14 @@
 #include "config_struct.h"
 #include "config_save.h"
 #include "config_load.h"
+#include "persist_writer.h"
+#include "warm_retain.h"
+#include "historian.h"
+#include "config_store.h"
 #include "st_logic_config.h"
 #include "config_apply.h"
 #include "gpio_driver.h"
+#include "gpio_mapping.h"
 #include "heartbeat.h"
 #include "debug.h"
 #include "debug_flags.h"
@@ -69,6 +74,7 @@ void cli_cmd_set_counter(uint8_t argc, char* argv[]) {
 
   // Parse key:value parameters (TODO: implement full parser)
   CounterConfig cfg = counter_config_defaults(id);
+  CounterQuadConfig quad = counter_config_quad_defaults(id);  // FEAT-157
 
   for (uint8_t i = 3; i < argc; i++) {
     char* arg = argv[i];
@@ -135,6 +141,29 @@ void cli_cmd_set_counter(uint8_t argc, char* argv[]) {
     } else if (!strcmp(key, "direction")) {
       if (!strcmp(value, "down")) cfg.direction = COUNTER_DIR_DOWN;
       else cfg.direction = COUNTER_DIR_UP;
+    } else if (!strcmp(key, "freq-mode")) {
+      // FEAT-154: gate = 1 s count window, reciprocal = period between edges (mHz)
+      if (!strcmp(value, "reciprocal") || !strcmp(value, "1")) cfg.freq_mode = COUNTER_FREQ_RECIPROCAL;
+      else cfg.freq_mode = COUNTER_FREQ_GATE;
+    } else if (!strcmp(key, "quad")) {
+      // FEAT-157: A/B encoder decoding (hw mode only, hw-gpio = A)
+      if (!strcmp(value, "x1") || !strcmp(value, "1")) quad.mode = COUNTER_QUAD_X1;
+      else if (!strcmp(value, "x2") || !strcmp(value, "2")) quad.mode = COUNTER_QUAD_X2;
+      else if (!strcmp(value, "x4") || !strcmp(value, "4")) quad.mode = COUNTER_QUAD_X4;
+      else quad.mode = COUNTER_QUAD_OFF;
+    } else if (!strcmp(key, "quad-b")) {
+      uint8_t pin = atoi(value);
+      if (pin == 0 || pin > 39) {
+        debug_println("ERROR: Invalid GPIO pin for quad-b (must be 1-39)");
+        continue;
+      }
+      quad.gpio_b = pin;
+    } else if (!strcmp(key, "quad-filter-ns")) {
+      quad.glitch_ns = atoi(value);
+    } else if (!strcmp(key, "vel-filter")) {
+      quad.velocity_filter_ms = atoi(value);
+    } else if (!strcmp(key, "vel-sample")) {
+      quad.velocity_sample_ms = atoi(value);
     } else if (!strcmp(key, "debounce")) {
       cfg.debounce_enabled = (!strcmp(value, "on")) ? 1 : 0;
     } else if (!strcmp(key, "debounce-ms")) {
@@ -298,10 +327,22 @@ void cli_cmd_set_counter(uint8_t argc, char* argv[]) {
     }
   }
 
+  // FEAT-157: Quadrature needs PCNT and both pins
+  if (quad.mode != COUNTER_QUAD_OFF) {
+    if (cfg.hw_mode != COUNTER_HW_PCNT || cfg.hw_gpio == 0 || quad.gpio_b == 0) {
+      debug_println("  HINT: quad mode requires hw-mode:hw hw-gpio:<A> quad-b:<B>");
+    } else if (quad.gpio_b == cfg.hw_gpio) {
+      debug_println("ERROR: quad-b must differ from hw-gpio");
+      return;
+    }
+  }
+
   // Store in persistent config
   if (id >= 1 && id <= COUNTER_COUNT) {
     g_persist_config.counters[id - 1] = cfg;
+    g_persist_config.counter_quad[id - 1] = quad;
   }
+  counter_config_set_quad(id, &quad);
 
   // Apply configuration to engine
   if (counter_engine_configure(id, &cfg)) {
@@ -647,6 +688,9 @@ void cli_cmd_set_timer(uint8_t argc, char* argv[]) {
       cfg.ctrl_reg = atoi(value);
     } else if (!strcmp(key, "enabled")) {
       cfg.enabled = (!strcmp(value, "on") || !strcmp(value, "1")) ? 1 : 0;
+    } else if (!strcmp(key, "time-base")) {
+      // v7.9.8.9: us = all durations above in microseconds
+      cfg.time_base = !strcmp(value, "us") ? TIMER_TIME_BASE_US : TIMER_TIME_BASE_MS;
     }
   }
 
@@ -809,6 +853,8 @@ void cli_cmd_no_set_gpio(uint8_t argc, char* argv[]) {
     g_persist_config.var_maps[i] = g_persist_config.var_maps[i + 1];
   }
   g_persist_config.var_map_count--;
+  if (gpio_pin < 64) g_persist_config.gpio_irq_pins &= ~(1ULL << gpio_pin);
+  gpio_mapping_invalidate();
 
   debug_print("GPIO ");
   debug_print_uint(gpio_pin);
@@ -824,17 +870,18 @@ void cli_cmd_no_set_gpio(uint8_t argc, char* argv[]) {
 }
 
 /**
- * set gpio <pin> input <idx>   (INPUT mode: GPIO pin → discrete input)
- * set gpio <pin> coil <idx>    (OUTPUT mode: coil → GPIO pin)
+ * set gpio <pin> input <idx> [irq]   (INPUT mode: GPIO pin → discrete input)
+ * set gpio <pin> coil <idx>          (OUTPUT mode: coil → GPIO pin)
  */
 void cli_cmd_set_gpio(uint8_t argc, char* argv[]) {
   if (argc < 3) {
     debug_println("SET GPIO: missing arguments");
-    debug_println("  Usage: set gpio <pin> input <idx>");
+    debug_println("  Usage: set gpio <pin> input <idx> [irq]");
     debug_println("         set gpio <pin> coil <idx>");
     debug_println("  Examples:");
-    debug_println("    set gpio 23 input 45   (GPIO23 input → discrete input 45)");
-    debug_println("    set gpio 12 coil 112   (Coil 112 → GPIO12 output)");
+    debug_println("    set gpio 23 input 45       (GPIO23 input → discrete input 45)");
+    debug_println("    set gpio 23 input 45 irq   (same, updated by pin interrupt)");
+    debug_println("    set gpio 12 coil 112       (Coil 112 → GPIO12 output)");
     return;
   }
 
@@ -883,6 +930,22 @@ void cli_cmd_set_gpio(uint8_t argc, char* argv[]) {
     return;
   }
 
+  // FEAT-163: optional interrupt mode (real input pins only)
+  bool use_irq = false;
+  if (argc >= 4) {
+    if (strcasecmp(argv[3], "irq") != 0) {
+      debug_print("SET GPIO: unknown option '");
+      debug_print(argv[3]);
+      debug_println("' (expected 'irq')");
+      return;
+    }
+    if (!is_input || gpio_pin >= 40) {
+      debug_println("SET GPIO: irq needs an input on GPIO 0-39");
+      return;
+    }
+    use_irq = true;
+  }
+
   // Find existing GPIO mapping or create new
   uint8_t found_idx = 0xff;
   for (uint8_t i = 0; i < g_persist_config.var_map_count; i++) {
@@ -910,6 +973,11 @@ void cli_cmd_set_gpio(uint8_t argc, char* argv[]) {
   g_persist_config.var_maps[found_idx].associated_timer = 0xff;    // No timer in STATIC mode
   g_persist_config.var_maps[found_idx].input_reg = input_index;
   g_persist_config.var_maps[found_idx].coil_reg = coil_index;
+  if (gpio_pin < 64) {
+    if (use_irq) g_persist_config.gpio_irq_pins |= 1ULL << gpio_pin;
+    else g_persist_config.gpio_irq_pins &= ~(1ULL << gpio_pin);
+  }
+  gpio_mapping_invalidate();
 
   // Initialize GPIO pin direction
   if (is_input) {
@@ -924,6 +992,7 @@ void cli_cmd_set_gpio(uint8_t argc, char* argv[]) {
   if (is_input) {
     debug_print(" - INPUT:");
     debug_print_uint(input_index);
+    if (use_irq) debug_print(" (irq)");
   } else {
     debug_print(" - COIL:");
     debug_print_uint(coil_index);
@@ -952,7 +1021,7 @@ void cli_cmd_save(void) {
   bool success = config_save_to_nvs(&g_persist_config);
 
   if (success) {
-    debug_println("SAVE: Configuration saved successfully");
+    debug_println("SAVE: Configuration queued (written by the persist writer)");
     debug_printf("  Schema: v%d  CRC: 0x%04X  Size: %u bytes\n",
                  g_persist_config.schema_version, g_persist_config.crc16,
                  (unsigned)sizeof(PersistConfig));
@@ -1065,6 +1134,7 @@ void cli_cmd_load(void) {
   bool success = config_load_from_nvs(&g_persist_config);
 
   if (success) {
+    gpio_mapping_invalidate();
     debug_println("LOAD: Configuration loaded successfully");
 
     // Count enabled counters and timers
@@ -1534,6 +1604,9 @@ void cli_cmd_set_persist_auto_load(uint8_t argc, char* argv[]) {
 void cli_cmd_defaults(void) {
   debug_println("Resetting to factory defaults...");
 
+  // Lazy config sections must count as loaded, or "save" would keep them
+  config_store_ensure_all();
+
   // Reset config to defaults (zero out everything)
   memset(&g_persist_config, 0, sizeof(PersistConfig));
   g_persist_config.schema_version = 1;
@@ -1555,6 +1628,7 @@ void cli_cmd_defaults(void) {
     g_persist_config.var_maps[i].input_type = 0;      // Default: Holding Register
     g_persist_config.var_maps[i].output_type = 0;     // Default: Holding Register
   }
+  gpio_mapping_invalidate();
 
   debug_println("DEFAULTS: Configuration reset to factory defaults");
   debug_println("NOTE: Use 'save' to persist, or 'reboot' to discard");
@@ -1563,6 +1637,10 @@ void cli_cmd_defaults(void) {
 void cli_cmd_reboot(void) {
   debug_println("Rebooting in 2 seconds...");
   delay(2000);
+  if (!persist_writer_flush(PW_FLUSH_TIMEOUT_MS)) {
+    debug_println("WARNING: Pending flash writes did not finish");
+  }
+  warm_retain_snapshot();  // Latest state for the warm restart
   esp_restart();
 }
 
@@ -2729,6 +2807,92 @@ void cli_cmd_show_ntp() {
   debug_println("");
 }
 
+/* ============================================================================
+ * HISTORIAN CONFIGURATION (v7.9.10.4)
+ * ============================================================================ */
+
+void cli_cmd_set_history(uint8_t argc, char* argv[]) {
+  if (argc < 1) {
+    debug_println("SET HISTORY: konfigurér historian (trend-data på enheden)");
+    debug_println("");
+    debug_println("  Brug:");
+    debug_println("    set history enable|disable");
+    debug_println("    set history point <1-8> hr|ir <addr> <interval_ms>");
+    debug_println("    set history point <1-8> counter <1-4> <interval_ms>");
+    debug_println("    set history point <1-8> off");
+    debug_println("    set history spill <kb>       - Flash spill budget (0 = kun RAM, max 255)");
+    debug_println("");
+    debug_println("  Interval 100-3600000 ms. Ændringer anvendes straks og");
+    debug_println("  nulstiller historikken i RAM.");
+    debug_println("");
+    debug_println("  Note: Brug 'save' for at gemme til NVS");
+    return;
+  }
+
+  const char* option = argv[0];
+  HistorianConfig cfg = g_persist_config.historian;
+
+  if (!strcmp(option, "enable") || !strcmp(option, "on")) {
+    cfg.enabled = 1;
+
+  } else if (!strcmp(option, "disable") || !strcmp(option, "off")) {
+    cfg.enabled = 0;
+
+  } else if (!strcmp(option, "spill")) {
+    if (argc < 2 || atoi(argv[1]) < 0 || atoi(argv[1]) > 255) {
+      debug_println("SET HISTORY SPILL: ugyldig størrelse (0-255 KB)");
+      return;
+    }
+    cfg.spill_kb = (uint8_t)atoi(argv[1]);
+
+  } else if (!strcmp(option, "point")) {
+    int id = (argc >= 2) ? atoi(argv[1]) : 0;
+    if (id < 1 || id > HIST_MAX_POINTS || argc < 3) {
+      debug_println("SET HISTORY POINT: brug 'set history point <1-8> hr|ir|counter <addr> <interval_ms>'");
+      return;
+    }
+    HistPointConfig pc = cfg.points[id - 1];
+    const char* src = argv[2];
+    if (!historian_source_parse(src, &pc.source)) {
+      debug_print("SET HISTORY POINT: ukendt kilde '");
+      debug_print(src);
+      debug_println("' (brug: hr, ir, counter, off)");
+      return;
+    }
+    if (pc.source != HIST_SRC_OFF) {
+      if (argc < 5) {
+        debug_println("SET HISTORY POINT: mangler adresse og interval");
+        return;
+      }
+      pc.address = (uint16_t)atoi(argv[3]);
+      pc.interval_ms = (uint32_t)strtoul(argv[4], NULL, 10);
+    }
+    const char* why = historian_point_check(&pc);
+    if (why) {
+      debug_print("SET HISTORY POINT: ");
+      debug_println(why);
+      return;
+    }
+    cfg.points[id - 1] = pc;
+
+  } else {
+    debug_print("SET HISTORY: ukendt option '");
+    debug_print(option);
+    debug_println("' (brug: enable, disable, point, spill)");
+    return;
+  }
+
+  g_persist_config.historian = cfg;
+  bool active = historian_apply(&g_persist_config.historian);
+  const HistorianStats* hs = historian_get_stats();
+  if (active) {
+    debug_printf("Historian aktiv: %u punkter, %lu KB %s\n", hs->points,
+                 (unsigned long)(hs->pool_bytes / 1024), hs->psram ? "PSRAM" : "DRAM");
+  } else {
+    debug_println(cfg.enabled ? "Historian: ingen punkter sampler" : "Historian deaktiveret");
+  }
+}
+
 void cli_cmd_ping(uint8_t argc, char* argv[]) {
   if (argc < 1) {
     debug_println("Brug: ping <ip/hostname> [count]");
@@ -30,6 +30,7 @@
 #include "constants.h"
 #include "register_allocator.h"  // BUG-025: Register overlap checking
 #include "counter_config.h"      // For counter_config_get/set (persistent cleanup)
+#include "gpio_mapping.h"        // Binding plan invalidation
 
 /* Forward declarations - from existing CLI infrastructure */
 extern void debug_println(const char *msg);
@@ -82,6 +83,8 @@ int cli_cmd_set_logic_upload(st_logic_engine_state_t *logic_state, uint8_t progr
     debug_printf("Source size: %d bytes\n", (int)source_len);
     debug_printf("Pool: %d/%d bytes used (%d bytes free)\n",
                  (int)pool_used, ST_LOGIC_POOL_SIZE, (int)pool_free);
+    debug_printf("Filesystem: max %u bytes per program save\n",
+                 (unsigned)st_logic_fs_source_limit(program_id));
     debug_printf("Error: %s\n", prog->last_error);
     debug_println("");
     return -1;
@@ -552,6 +555,7 @@ int cli_cmd_set_logic_bind(st_logic_engine_state_t *logic_state, uint8_t program
       i--;  // Re-check this index (we just shifted)
     }
   }
+  gpio_mapping_invalidate();  // Removed bindings must leave the plan even if adding fails
 
   // Step 2: Check if we have space for new mapping(s)
   uint8_t mappings_needed = (is_input && is_output) ? 2 : 1;
@@ -173,6 +173,7 @@ static const char* normalize_alias(const char* s) {
   if (str_eq_i(s, "ECHO")) return "ECHO";
   if (str_eq_i(s, "DEBUG") || str_eq_i(s, "DBG")) return "DEBUG";
   if (str_eq_i(s, "WATCHDOG") || str_eq_i(s, "WDG")) return "WATCHDOG";
+  if (str_eq_i(s, "BOOT")) return "BOOT";
   if (str_eq_i(s, "VERBOSE") || str_eq_i(s, "VERB")) return "VERBOSE";
 
   // Modbus Master/Slave/Mode commands
@@ -196,6 +197,7 @@ static const char* normalize_alias(const char* s) {
   if (str_eq_i(s, "RS485")) return "RS485";
   if (str_eq_i(s, "ETHERNET") || str_eq_i(s, "ETH")) return "ETHERNET";
   if (str_eq_i(s, "NTP") || str_eq_i(s, "SNTP")) return "NTP";
+  if (str_eq_i(s, "HISTORY") || str_eq_i(s, "HISTORIAN") || str_eq_i(s, "HIST")) return "HISTORY";
   if (str_eq_i(s, "TX")) return "TX";
   if (str_eq_i(s, "RX")) return "RX";
   if (str_eq_i(s, "DIR")) return "DIR";
@@ -323,6 +325,8 @@ static void print_show_help(void) {
   debug_println("    show gpio [pin]        - GPIO mappings");
   debug_println("    show metrics           - Prometheus metrics reference");
   debug_println("    show watchdog          - Watchdog monitor status");
+  debug_println("    show boot              - Boot timeline (denne + forrige opstart)");
+  debug_println("    show history           - Historian punkter, tiers og spill");
   debug_println("    show debug             - Debug flags");
   debug_println("    show echo              - Echo status");
   debug_println("");
@@ -349,6 +353,7 @@ static void print_set_help(void) {
   debug_println("    set timer ?               - Timer kommandoer");
   debug_println("    set logic ?               - ST Logic kommandoer");
   debug_println("    set persist ?             - Persistence grupper");
+  debug_println("    set history ?             - Historian (trend-data paa enheden)");
   debug_println("");
   debug_println("  Network:");
   debug_println("    set wifi ?                - Wi-Fi kommandoer");
@@ -587,9 +592,11 @@ static void print_timer_help(void) {
   debug_println("  output-coil:<idx>   - Output coil index");
   debug_println("  ctrl-reg:<addr>     - Control register address");
   debug_println("  enabled:<on|off>    - Enable/disable timer");
+  debug_println("  time-base:<ms|us>   - Unit of all durations (default ms)");
   debug_println("");
   debug_println("Example:");
   debug_println("  set timer 1 mode 3 on-ms:1000 off-ms:500 output-coil:0");
+  debug_println("  set timer 2 mode 3 on-ms:250 off-ms:750 time-base:us output-coil:1");
   debug_println("");
 }
 
@@ -598,6 +605,7 @@ static void print_gpio_help(void) {
   debug_println("Available 'set gpio' commands:");
   debug_println("  set gpio <pin> coil <idx>         - Map GPIO til coil output");
   debug_println("  set gpio <pin> input <idx>        - Map GPIO til discrete input");
+  debug_println("  set gpio <pin> input <idx> irq    - Samme, opdateret via pin-interrupt");
   debug_println("  set gpio <pin> mode <in|out|...>  - Sæt GPIO mode");
   debug_println("  no set gpio <pin>                 - Fjern GPIO mapping");
   debug_println("");
@@ -800,6 +808,9 @@ bool cli_parser_execute(char* line) {
     } else if (!strcmp(what, "NTP")) {
       cli_cmd_show_ntp();
       return true;
+    } else if (!strcmp(what, "HISTORY")) {
+      cli_cmd_show_history();
+      return true;
     } else if (!strcmp(what, "RATE-LIMIT")) {
       cli_cmd_show_rate_limit();
       return true;
@@ -821,6 +832,9 @@ bool cli_parser_execute(char* line) {
     } else if (!strcmp(what, "WATCHDOG")) {
       cli_cmd_show_watchdog();
       return true;
+    } else if (!strcmp(what, "BOOT")) {
+      cli_cmd_show_boot();
+      return true;
     } else if (!strcmp(what, "MODBUS-MASTER") || !strcmp(what, "MB-MASTER")) {
       cli_cmd_show_modbus_master();
       return true;
@@ -1279,6 +1293,13 @@ bool cli_parser_execute(char* line) {
       }
       cli_cmd_set_ntp(argc - 2, argv + 2);
       return true;
+    } else if (!strcmp(what, "HISTORY")) {
+      if (argc < 3) {
+        cli_cmd_set_history(0, NULL);
+        return true;
+      }
+      cli_cmd_set_history(argc - 2, argv + 2);
+      return true;
     } else if (!strcmp(what, "RATE-LIMIT")) {
       if (argc < 3) {
         debug_println("Usage: set rate-limit enable|disable");
@@ -2229,6 +2250,8 @@ bool cli_parser_execute(char* line) {
     debug_println("  show coils              - Coils");
     debug_println("  show debug, dbg         - Debug flags");
     debug_println("  show watchdog, wdg      - Watchdog status");
+    debug_println("  show boot               - Boot timeline per fase");
+    debug_println("  show history, hist      - Historian punkter og tiers");
     debug_println("  show persist            - Persistence groups");
     debug_println("  show modbus-master, mb-master - Modbus master config");
     debug_println("  show modbus-slave, mb-slave   - Modbus slave config");
@@ -2585,6 +2608,12 @@ void cli_parser_print_help(void) {
   debug_println("      scale:<float>             - Multiply output (e.g. 2.5)");
   debug_println("      bit-width:<8|16|32|64>    - Counter resolution");
   debug_println("      dir:<up|down>             - Count direction");
+  debug_println("      freq-mode:<gate|reciprocal> - Hz per 1 s window, or period (mHz, uses freq-reg+1)");
+  debug_println("      quad:<off|x1|x2|x4>       - A/B encoder (hw mode, hw-gpio = A, signed position)");
+  debug_println("      quad-b:<gpio>             - Encoder channel B");
+  debug_println("      quad-filter-ns:<ns>       - PCNT glitch filter (0 = off, max 12787)");
+  debug_println("      vel-filter:<ms>           - Velocity low-pass time constant (default: 100)");
+  debug_println("      vel-sample:<ms>           - Velocity sample interval (default: 10, HR x15-x16)");
   debug_println("      debounce:<on|off>         - Enable/disable debounce (default: on)");
   debug_println("      debounce-ms:<ms>          - Debounce time in ms (default: 10)");
   debug_println("");
@@ -17,11 +17,16 @@
 #include "counter_engine.h"
 #include "counter_config.h"
 #include "counter_frequency.h"
+#include "counter_sw_isr.h"
+#include "counter_hw.h"
 #include "timer_engine.h"
 #include "timer_config.h"
 #include "registers.h"
 #include "registers_persist.h"
 #include "watchdog_monitor.h"
+#include "boot_trace.h"
+#include "warm_retain.h"
+#include "historian.h"
 #include "version.h"
 #include "cli_shell.h"
 #include "config_struct.h"
@@ -38,6 +43,8 @@
 #include "rbac.h"
 #include "wifi_driver.h"
 #include "gpio_driver.h"
+#include "gpio_mapping.h"
+#include "di_irq.h"
 #include "modbus_master.h"
 #include <Arduino.h>
 #include <stdio.h>
@@ -203,6 +210,22 @@ void cli_cmd_show_config(const char *section) {
   debug_print("-");
   debug_print_uint(VGPIO_SR_INPUT_BASE + VGPIO_SR_INPUT_COUNT - 1);
   debug_println(")");
+
+  gpio_sr_stats_t sr;
+  gpio_driver_get_sr_stats(&sr);
+  if (sr.spi_active) {
+    debug_print("  Driver: SPI/DMA, sample every ");
+    debug_print_uint(sr.period_us);
+    debug_print(" us (samples ");
+    debug_print_uint(sr.samples);
+    debug_print(", flushes ");
+    debug_print_uint(sr.flushes);
+    debug_print(", overruns ");
+    debug_print_uint(sr.overruns);
+    debug_println(")");
+  } else {
+    debug_println("  Driver: bit-bang (SPI host unavailable)");
+  }
 #endif
 
   // Analog inputs
@@ -582,6 +605,9 @@ void cli_cmd_show_config(const char *section) {
           debug_print(" UNKNOWN");
       }
 
+      if (cfg.time_base == TIMER_TIME_BASE_US) {
+        debug_print(" time-base:us");
+      }
       debug_print(" output-coil:");
       debug_print_uint(cfg.output_coil);
       debug_print(" ctrl-reg:");
@@ -1742,6 +1768,18 @@ void cli_cmd_show_config(const char *section) {
         debug_print_uint(cfg.debounce_ms);
       }
 
+      if (cfg.freq_mode == COUNTER_FREQ_RECIPROCAL) {
+        debug_print(" freq-mode:reciprocal");
+      }
+
+      // FEAT-157: Quadrature
+      CounterQuadConfig quad;
+      if (counter_config_get_quad(id, &quad) && quad.mode != COUNTER_QUAD_OFF) {
+        debug_printf(" quad:x%u quad-b:%u", quad.mode, quad.gpio_b);
+        if (quad.glitch_ns) debug_printf(" quad-filter-ns:%u", quad.glitch_ns);
+        debug_printf(" vel-filter:%u vel-sample:%u", quad.velocity_filter_ms, quad.velocity_sample_ms);
+      }
+
       // Input/Pin based on hw_mode
       if (cfg.hw_mode == COUNTER_HW_PCNT && cfg.hw_gpio > 0) {
         debug_print(" hw-gpio:");
@@ -1839,6 +1877,10 @@ void cli_cmd_show_config(const char *section) {
           break;
       }
 
+      if (cfg.time_base == TIMER_TIME_BASE_US) {
+        debug_print(" time-base:us");
+      }
+
       // Output coil
       debug_print(" output-coil:");
       debug_print_uint(cfg.output_coil);
@@ -2252,6 +2294,11 @@ void cli_cmd_show_counter(uint8_t id, bool verbose) {
     debug_print("  Frequency Register (Hz): ");
     debug_print_uint(cfg.freq_reg);
     debug_println("");
+    if (cfg.freq_mode == COUNTER_FREQ_RECIPROCAL) {
+      debug_print("  Frequency Fraction Register (mHz): ");
+      debug_print_uint(cfg.freq_reg + 1);
+      debug_println("");
+    }
   }
 
   if (cfg.ctrl_reg < 1000) {
@@ -2301,8 +2348,30 @@ void cli_cmd_show_counter(uint8_t id, bool verbose) {
   debug_println("");
 
   debug_print("  Frequency: ");
-  debug_print_uint(freq);
-  debug_println(" Hz");
+  if (cfg.freq_mode == COUNTER_FREQ_RECIPROCAL) {
+    uint32_t mhz = counter_frequency_get_mhz(id);
+    debug_printf("%lu.%03lu Hz (reciprocal)\n", (unsigned long)(mhz / 1000), (unsigned long)(mhz % 1000));
+  } else {
+    debug_print_uint(freq);
+    debug_println(" Hz");
+  }
+
+  // FEAT-156: Edge timestamp ring (enabled by CNT_EDGES or GET .../edges)
+  uint32_t edge_tail = 0, edge_head = 0;
+  if (counter_sw_isr_edges_window(id, &edge_tail, &edge_head)) {
+    debug_printf("  Edge Capture: ON (%lu edges captured, %lu in ring)\n",
+                 (unsigned long)edge_head, (unsigned long)(edge_head - edge_tail));
+  }
+
+  // FEAT-157: Quadrature position/velocity
+  if (counter_hw_is_quadrature(id)) {
+    CounterQuadConfig quad;
+    counter_config_get_quad(id, &quad);
+    debug_printf("  Quadrature: x%u (A=GPIO%u B=GPIO%u)\n", quad.mode, cfg.hw_gpio, quad.gpio_b);
+    debug_printf("  Position: %lld counts\n", (long long)counter_hw_get_position(id));
+    debug_printf("  Velocity: %ld counts/s (HR%u-%u)\n", (long)counter_hw_get_velocity(id),
+                 quad.velocity_reg, quad.velocity_reg + 1);
+  }
 
   // Compare feature
   if (cfg.compare_enabled) {
@@ -2433,6 +2502,7 @@ void cli_cmd_show_timers(void) {
       debug_println("DISABLED");
       continue;
     }
+    const char* unit = (cfg.time_base == TIMER_TIME_BASE_US) ? "us" : "ms";
 
     // Show mode and status
     switch (cfg.mode) {
@@ -2440,17 +2510,20 @@ void cli_cmd_show_timers(void) {
         debug_println("ONE-SHOT (Mode 1)");
         debug_print("  P1: ");
         debug_print_uint(cfg.phase1_duration_ms);
-        debug_print("ms → ");
+        debug_print(unit);
+        debug_print(" → ");
         debug_print_uint(cfg.phase1_output_state);
         debug_println("");
         debug_print("  P2: ");
         debug_print_uint(cfg.phase2_duration_ms);
-        debug_print("ms → ");
+        debug_print(unit);
+        debug_print(" → ");
         debug_print_uint(cfg.phase2_output_state);
         debug_println("");
         debug_print("  P3: ");
         debug_print_uint(cfg.phase3_duration_ms);
-        debug_print("ms → ");
+        debug_print(unit);
+        debug_print(" → ");
         debug_print_uint(cfg.phase3_output_state);
         debug_println("");
         break;
@@ -2459,7 +2532,7 @@ void cli_cmd_show_timers(void) {
         debug_println("MONOSTABLE (Mode 2)");
         debug_print("  Pulse: ");
         debug_print_uint(cfg.pulse_duration_ms);
-        debug_println("ms");
+        debug_println(unit);
         debug_print("  P1 (rest): ");
         debug_print_uint(cfg.phase1_output_state);
         debug_println("");
@@ -2472,10 +2545,10 @@ void cli_cmd_show_timers(void) {
         debug_println("ASTABLE (Mode 3)");
         debug_print("  ON: ");
         debug_print_uint(cfg.on_duration_ms);
-        debug_println("ms");
+        debug_println(unit);
         debug_print("  OFF: ");
         debug_print_uint(cfg.off_duration_ms);
-        debug_println("ms");
+        debug_println(unit);
         debug_print("  P1 (ON): ");
         debug_print_uint(cfg.phase1_output_state);
         debug_println("");
@@ -2493,7 +2566,7 @@ void cli_cmd_show_timers(void) {
         debug_println(cfg.trigger_edge == 1 ? "RISING (0→1)" : "FALLING (1→0)");
         debug_print("  Delay: ");
         debug_print_uint(cfg.delay_ms);
-        debug_println("ms");
+        debug_println(unit);
         debug_print("  Output level: ");
         debug_print_uint(cfg.phase1_output_state);
         debug_println("");
@@ -2545,6 +2618,7 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
 
   debug_println("Status: ENABLED");
   debug_println("");
+  const char* unit = (cfg.time_base == TIMER_TIME_BASE_US) ? "us" : "ms";
 
   // Show mode and parameters
   switch (cfg.mode) {
@@ -2554,7 +2628,7 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
       debug_println("Phase 1:");
       debug_print("  Duration: ");
       debug_print_uint(cfg.phase1_duration_ms);
-      debug_println("ms");
+      debug_println(unit);
       debug_print("  Output State: ");
       debug_print_uint(cfg.phase1_output_state);
       debug_println("");
@@ -2562,7 +2636,7 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
       debug_println("Phase 2:");
       debug_print("  Duration: ");
       debug_print_uint(cfg.phase2_duration_ms);
-      debug_println("ms");
+      debug_println(unit);
       debug_print("  Output State: ");
       debug_print_uint(cfg.phase2_output_state);
       debug_println("");
@@ -2570,7 +2644,7 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
       debug_println("Phase 3:");
       debug_print("  Duration: ");
       debug_print_uint(cfg.phase3_duration_ms);
-      debug_println("ms");
+      debug_println(unit);
       debug_print("  Output State: ");
       debug_print_uint(cfg.phase3_output_state);
       debug_println("");
@@ -2581,7 +2655,7 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
       debug_println("");
       debug_print("Pulse Duration: ");
       debug_print_uint(cfg.pulse_duration_ms);
-      debug_println("ms");
+      debug_println(unit);
       debug_print("Rest Output State: ");
       debug_print_uint(cfg.phase1_output_state);
       debug_println("");
@@ -2595,10 +2669,10 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
       debug_println("");
       debug_print("ON Duration: ");
       debug_print_uint(cfg.on_duration_ms);
-      debug_println("ms");
+      debug_println(unit);
       debug_print("OFF Duration: ");
       debug_print_uint(cfg.off_duration_ms);
-      debug_println("ms");
+      debug_println(unit);
       debug_print("ON Output State: ");
       debug_print_uint(cfg.phase1_output_state);
       debug_println("");
@@ -2617,7 +2691,7 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
       debug_println(cfg.trigger_edge == 1 ? "RISING (0→1)" : "FALLING (1→0)");
       debug_print("Delay: ");
       debug_print_uint(cfg.delay_ms);
-      debug_println("ms");
+      debug_println(unit);
       debug_print("Output Level: ");
       debug_print_uint(cfg.phase1_output_state);
       debug_println("");
@@ -2668,27 +2742,37 @@ void cli_cmd_show_timer(uint8_t id, bool verbose) {
     switch (cfg.mode) {
       case TIMER_MODE_1_ONESHOT:
         debug_println("  - ONE-SHOT: Executes once per START command");
-        debug_println("  - Total duration: p1 + p2 + p3 ms");
+        debug_println("  - Total duration: p1 + p2 + p3");
         debug_print("  - Calculated: ");
         debug_print_uint(cfg.phase1_duration_ms + cfg.phase2_duration_ms + cfg.phase3_duration_ms);
-        debug_println(" ms per cycle");
+        debug_print(" ");
+        debug_print(unit);
+        debug_println(" per cycle");
         break;
       case TIMER_MODE_2_MONOSTABLE:
         debug_println("  - MONOSTABLE: Retriggerable pulse timer");
         debug_println("  - Trigger extends pulse duration (does not queue)");
         debug_print("  - Pulse width: ");
         debug_print_uint(cfg.pulse_duration_ms);
-        debug_println(" ms");
+        debug_print(" ");
+        debug_println(unit);
         break;
       case TIMER_MODE_3_ASTABLE: {
-        debug_println("  - ASTABLE: Free-running oscillator");
+        uint32_t period = cfg.on_duration_ms + cfg.off_duration_ms;
+        debug_println("  - ASTABLE: Free-running oscillator (esp_timer deadlines)");
         debug_print("  - Period: ");
-        debug_print_uint(cfg.on_duration_ms + cfg.off_duration_ms);
-        debug_println(" ms");
-        float freq_hz = 1000.0f / (float)(cfg.on_duration_ms + cfg.off_duration_ms);
-        debug_print("  - Frequency: ");
-        debug_print_float(freq_hz);
-        debug_println(" Hz");
+        debug_print_uint(period);
+        debug_print(" ");
+        debug_println(unit);
+        if (period > 0) {
+          float freq_hz = ((cfg.time_base == TIMER_TIME_BASE_US) ? 1000000.0f : 1000.0f) / (float)period;
+          debug_print("  - Frequency: ");
+          debug_print_float(freq_hz);
+          debug_println(" Hz");
+        }
+        debug_print("  - Late resyncs: ");
+        debug_print_uint(timer_engine_get_late_resyncs(id));
+        debug_println(" (callback fell a whole period behind)");
         break;
       }
       case TIMER_MODE_4_INPUT_TRIGGERED:
@@ -2999,6 +3083,13 @@ void cli_cmd_show_gpio(void) {
       if (map->is_input) {
         debug_print("INPUT:");
         debug_print_uint(map->input_reg);
+        if (map->gpio_pin < 64 && (g_persist_config.gpio_irq_pins & (1ULL << map->gpio_pin))) {
+          // FEAT-163: interrupt mode, "pending" if the pin could not be attached
+          bool active = (di_irq_active_pins() & (1ULL << map->gpio_pin)) != 0;
+          debug_printf(" (irq%s, %lu edges%s)", active ? "" : " pending",
+                       (unsigned long)di_irq_edge_count(map->gpio_pin),
+                       di_irq_caught(map->gpio_pin, false) ? ", caught" : "");
+        }
       } else {
         debug_print("COIL:");
         debug_print_uint(map->coil_reg);
@@ -3008,6 +3099,14 @@ void cli_cmd_show_gpio(void) {
       debug_print("']");
       debug_println("");
     }
+
+    uint8_t plan_in = 0, plan_out = 0;
+    gpio_mapping_get_plan_stats(&plan_in, &plan_out);
+    debug_print("  Batched: ");
+    debug_print_uint(plan_in);
+    debug_print(" inputs, ");
+    debug_print_uint(plan_out);
+    debug_println(" outputs per cycle (port registers)");
   } else {
     debug_println("(No user-configured GPIO mappings)");
   }
@@ -3656,7 +3755,8 @@ void cli_cmd_show_sse(void) {
           if (t & SSE_TOPIC_COUNTERS)  { strcat(topics_str, "cnt"); first = false; }
           if (t & SSE_TOPIC_TIMERS)    { if (!first) strcat(topics_str, ","); strcat(topics_str, "tmr"); first = false; }
           if (t & SSE_TOPIC_REGISTERS) { if (!first) strcat(topics_str, ","); strcat(topics_str, "reg"); first = false; }
-          if (t & SSE_TOPIC_SYSTEM)    { if (!first) strcat(topics_str, ","); strcat(topics_str, "sys"); }
+          if (t & SSE_TOPIC_SYSTEM)    { if (!first) strcat(topics_str, ","); strcat(topics_str, "sys"); first = false; }
+          if (t & SSE_TOPIC_INPUTS)    { if (!first) strcat(topics_str, ","); strcat(topics_str, "in"); }
           if (topics_str[0] == '\0') strcpy(topics_str, "none");
         }
 
@@ -4552,6 +4652,131 @@ void cli_cmd_show_watchdog(void) {
   debug_print("Last reboot uptime: ");
   debug_print_uint(wdt->last_reboot_uptime_ms / 1000);
   debug_println(" seconds");
+  if (wdt->boot_ready_us) {
+    debug_printf("Boot time to ready: %lu ms\n", (unsigned long)(wdt->boot_ready_us / 1000));
+  }
+  debug_println("");
+}
+
+/* ============================================================================
+ * SHOW BOOT (v7.9.10.0)
+ * ============================================================================ */
+
+static void show_boot_trace(const char *title, const BootTrace *t) {
+  debug_printf("%s (boot #%lu, reset reason %u):\n", title,
+               (unsigned long)t->boot_count, (unsigned)t->reset_reason);
+  for (uint8_t i = 0; i < t->phase_count; i++) {
+    debug_printf("  %-12s %9lu us   t=%7lu us\n", t->phases[i].name,
+                 (unsigned long)boot_trace_phase_us(t, i), (unsigned long)t->phases[i].end_us);
+  }
+  if (t->ready) {
+    debug_printf("  %-12s %9s      t=%7lu us  (%lu ms)\n", "READY", "",
+                 (unsigned long)t->ready_us, (unsigned long)(t->ready_us / 1000));
+  } else {
+    debug_println("  READY        ikke naaet");
+  }
+}
+
+void cli_cmd_show_boot(void) {
+  debug_println("");
+  debug_println("=== Boot Timeline ===");
+  show_boot_trace("Denne opstart", boot_trace_current());
+  const BootTrace *prev = boot_trace_previous();
+  if (prev) {
+    debug_println("");
+    show_boot_trace("Forrige opstart", prev);
+  } else {
+    debug_println("Forrige opstart: ingen (RTC-hukommelse tabt ved power-on)");
+  }
+
+  // v7.9.10.2: warm restart retention
+  const WarmRetainStats *wr = warm_retain_get_stats();
+  debug_println("");
+  debug_println("Warm restart retention:");
+  if (wr->restored) {
+    debug_printf("  Genskabt:    snapshot #%lu, %lu bytes paa %lu us, %u ST-programmer (%u aendret)\n",
+                 (unsigned long)wr->snapshot_seq, (unsigned long)wr->restore_bytes,
+                 (unsigned long)wr->restore_us, wr->programs, wr->programs_skipped);
+  } else if (wr->crash_skipped) {
+    debug_printf("  Genskabt:    nej (%u panic/WDT-resets i traek - crash-loop, startet fra NVS)\n",
+                 wr->crash_streak);
+  } else {
+    debug_println(wr->warm ? "  Genskabt:    nej (ingen gyldig snapshot)"
+                           : "  Genskabt:    nej (kold start)");
+  }
+  if (wr->restored && wr->crash_streak) {
+    debug_printf("  Crash-serie: %u af max %u panic/WDT-genskabelser i traek\n",
+                 wr->crash_streak, (unsigned)WARM_RETAIN_CRASH_MAX);
+  }
+  debug_printf("  Snapshots:   %lu, sidste %lu bytes paa %lu us (max %lu us), hver %u ms\n",
+               (unsigned long)wr->snapshots, (unsigned long)wr->snapshot_bytes,
+               (unsigned long)wr->snapshot_us, (unsigned long)wr->snapshot_max_us,
+               (unsigned)WARM_RETAIN_INTERVAL_MS);
+  if (wr->dropped) {
+    debug_printf("  ADVARSEL:    %lu sektioner passede ikke i %u bytes\n",
+                 (unsigned long)wr->dropped, (unsigned)WARM_RETAIN_AREA_SIZE);
+  }
+  debug_println("");
+}
+
+/* ============================================================================
+ * SHOW HISTORY (v7.9.10.4)
+ * ============================================================================ */
+
+static const char *const hist_tier_names[HIST_TIER_COUNT] = { "raw", "1 min", "10 min", "1 time" };
+
+void cli_cmd_show_history(void) {
+  extern bool ntp_driver_is_synced(void);
+  const HistorianConfig *cfg = &g_persist_config.historian;
+  const HistorianStats *hs = historian_get_stats();
+
+  debug_println("");
+  debug_println("=== Historian ===");
+  debug_printf("  Status:      %s%s\n", cfg->enabled ? "aktiveret" : "deaktiveret",
+               cfg->enabled && !hs->active ? " (ingen punkter sampler)" : "");
+  if (hs->active) {
+    debug_printf("  Pool:        %lu KB %s, %u punkter\n", (unsigned long)(hs->pool_bytes / 1024),
+                 hs->psram ? "PSRAM" : "DRAM", hs->points);
+  }
+  debug_printf("  Tid:         %s\n", ntp_driver_is_synced() ? "Unix ms (NTP)" : "ms siden opstart (ingen NTP)");
+  debug_printf("  Samples:     %lu (%lu sprunget over, loop forsinket)\n",
+               (unsigned long)hs->samples, (unsigned long)hs->late);
+  if (cfg->spill_kb > 0) {
+    debug_printf("  Flash spill: %u KB budget (%lu KB effektivt), %lu filer / %lu bytes skrevet, %lu fejl, %lu blokke tabt\n",
+                 cfg->spill_kb, (unsigned long)(hs->spill_quota / 1024), (unsigned long)hs->spill_files, (unsigned long)hs->spill_bytes,
+                 (unsigned long)hs->spill_errors, (unsigned long)hs->spill_dropped);
+  } else {
+    debug_println("  Flash spill: fra (kun RAM)");
+  }
+
+  uint64_t now = historian_now_ms();
+  for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+    HistorianPointStatus st;
+    historian_point_status(p, &st);
+    if (st.cfg.source == HIST_SRC_OFF) continue;
+    debug_printf("\n  Punkt %u: %s %u hver %lu ms", p + 1, historian_source_name(st.cfg.source),
+                 st.cfg.address, (unsigned long)st.cfg.interval_ms);
+    if (!st.sampling) {
+      debug_println("  (sampler ikke)");
+      continue;
+    }
+    debug_printf("  = %lld", (long long)st.last_value);
+    if (st.spill_slots > 0) debug_printf("  [%u/%u spill-filer]", st.spill_files, st.spill_slots);
+    debug_println("");
+    for (uint8_t t = 0; t < HIST_TIER_COUNT; t++) {
+      if (st.capacity[t] == 0) continue;
+      debug_printf("    %-7s %6lu poster  %4lu/%-4lu blokke", hist_tier_names[t],
+                   (unsigned long)st.records[t], (unsigned long)st.blocks[t], (unsigned long)st.capacity[t]);
+      if (st.oldest_ms[t] > 0 && st.oldest_ms[t] <= now) {
+        uint32_t age_s = (uint32_t)((now - st.oldest_ms[t]) / 1000);
+        debug_printf("  %lu t %02lu min tilbage", (unsigned long)(age_s / 3600),
+                     (unsigned long)(age_s / 60 % 60));
+      }
+      debug_println("");
+    }
+  }
+  debug_println("");
+  debug_println("  Data: GET /api/history/<punkt>?tier=0-3&last=<sek> (CSV eller binaer)");
   debug_println("");
 }
 
@@ -4577,7 +4802,7 @@ void cli_cmd_show_backup(void) {
            proto, (int)(ip & 0xFF), (int)((ip >> 8) & 0xFF),
            (int)((ip >> 16) & 0xFF), (int)((ip >> 24) & 0xFF), port);
 
-  char line[128];
+  char line[192];
 
   debug_println("\n1) Download backup (browser eller curl):");
   snprintf(line, sizeof(line), "   %s/api/system/backup", base);
@@ -4600,6 +4825,16 @@ void cli_cmd_show_backup(void) {
   }
   debug_println(line);
 
+  // v7.9.10.1: Binary backup (config_backup.h)
+  debug_println("\n3) Binaer backup (hurtigere, med bytecode):");
+  snprintf(line, sizeof(line), "   curl%s -H \"Accept: application/octet-stream\" \"%s/api/system/backup?bytecode=1\" -o backup.mbk",
+           g_persist_config.network.http.auth_enabled ? " -u <user>:<password>" : "", base);
+  debug_println(line);
+  snprintf(line, sizeof(line), "   curl%s -X POST -H \"Content-Type: application/octet-stream\" --data-binary @backup.mbk %s/api/system/restore",
+           g_persist_config.network.http.auth_enabled ? " -u <user>:<password>" : "", base);
+  debug_println(line);
+  debug_println("   Konvertering til/fra JSON: scripts/backup_tool.py");
+
   debug_println("\nIndhold: Modbus, WiFi, HTTP, counters, timers,");
   debug_println("         registers, coils, var_maps, ST Logic source.");
   debug_println("         Passwords inkluderet i backup.");
@@ -4644,6 +4879,9 @@ void cli_cmd_show_metrics(void) {
   debug_println("Endpoint: GET /api/metrics");
   debug_println("Format: Prometheus text exposition (v0.0.4)");
   debug_println("Content-Type: text/plain; version=0.0.4; charset=utf-8");
+  debug_println("Transfer: chunked (streamed, no heap buffer)");
+  debug_println("Filter: ?families=system,http,modbus,network,counter,timer,");
+  debug_println("                  st,gpio,registers,persist,ntp,alarm");
 
   debug_println("\n--- System ---");
   debug_println("  esp32_uptime_seconds          gauge    Device uptime");
@@ -4683,6 +4921,8 @@ void cli_cmd_show_metrics(void) {
   debug_println("  st_logic_min_exec_us{s,n}     gauge    Min exec time (us)");
   debug_println("  st_logic_max_exec_us{s,n}     gauge    Max exec time (us)");
   debug_println("  st_logic_overrun_count{s,n}   counter  Program overruns");
+  debug_println("  st_logic_xip_programs         gauge    Programs run from flash");
+  debug_println("  st_logic_xip_bytes            gauge    Instr bytes not in heap");
 
   debug_println("\n--- GPIO ---");
   debug_println("  gpio_digital_input{pin}       gauge    DI 101-108 (74HC165)");
@@ -4695,6 +4935,11 @@ void cli_cmd_show_metrics(void) {
   debug_println("\n--- Persistence ---");
   debug_println("  persist_group_reg_count{grp}  gauge    Regs per group");
   debug_println("  persist_group_last_save_ms    gauge    Last save time");
+  debug_println("  persist_writer_pending        gauge    Queued flash writes");
+  debug_println("  persist_writer_writes_total   counter  Writes {result}");
+  debug_println("  persist_writer_coalesced_total counter Merged saves");
+  debug_println("  persist_writer_rejected_total counter  Queue full");
+  debug_println("  persist_writer_max_write_ms   gauge    Longest write");
 
   debug_println("\n--- Network ---");
   debug_println("  wifi_connected                gauge    WiFi (0/1)");
@@ -4706,6 +4951,9 @@ void cli_cmd_show_metrics(void) {
 
   debug_println("\n--- Other ---");
   debug_println("  watchdog_reboot_count         counter  Reboot count");
+  debug_println("  boot_phase_duration_us{phase} gauge    setup() phase time");
+  debug_println("  boot_time_to_ready_us         gauge    Start to Modbus ready");
+  debug_println("  boot_previous_ready           gauge    Prev boot reached ready");
   debug_println("  firmware_info{ver,build}      gauge    Version info");
 
   uint32_t ip = network_manager_get_local_ip();
@@ -8,8 +8,10 @@
 
 #include "config_apply.h"
 #include "counter_engine.h"
+#include "counter_config.h"
 #include "timer_engine.h"
 #include "gpio_driver.h"
+#include "gpio_mapping.h"
 #include "config_struct.h"
 #include "registers.h"
 #include "registers_persist.h"
@@ -55,6 +57,7 @@ bool config_apply(const PersistConfig* cfg) {
   cli_shell_set_remote_echo(cfg->remote_echo);
 
   // Apply variable mappings (initialize GPIO pins)
+  gpio_mapping_invalidate();
   debug_print("  Variable mappings (GPIO + ST): ");
   debug_print_uint(cfg->var_map_count);
   debug_println("");
@@ -216,6 +219,7 @@ bool config_apply(const PersistConfig* cfg) {
       debug_print("    Counter ");
       debug_print_uint(i + 1);
       debug_println(" enabled - configuring...");
+      counter_config_set_quad(i + 1, &cfg->counter_quad[i]);  // FEAT-157: before configure
       counter_engine_configure(i + 1, &cfg->counters[i]);
 
       // BUG-017 FIX: Check auto-start flag and trigger start if enabled
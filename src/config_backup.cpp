@@ -0,0 +1,268 @@
+/**
+ * @file config_backup.cpp
+ * @brief Binary config backup and restore (v7.9.10.1)
+ *
+ * LAYER 6: Persistence - Backup/restore
+ * Backup: one section buffer (CS_MAX_SECTION_SIZE), program sources are
+ * streamed straight from the source pool, bytecode images are built one
+ * at a time. Restore: a staged PersistConfig plus one heap buffer per
+ * program and image in the upload, freed by config_restore_free().
+ */
+
+#include "config_backup.h"
+#include "config_sections.h"
+#include "config_store.h"
+#include "config_load.h"
+#include "config_struct.h"
+#include "constants.h"
+#include "build_version.h"
+#include "st_logic_config.h"
+#include "st_bytecode_persist.h"
+#include "st_xip_image.h"
+#include "session_token.h"
+#include "debug.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Largest record accepted on restore: a full source pool plus program header
+#define BACKUP_MAX_RECORD   (sizeof(BkProgramHeader) + ST_LOGIC_POOL_SIZE)
+
+struct ConfigRestore {
+  BkReader       reader;
+  BkHandler      handler;
+  PersistConfig  staged;          // g_persist_config + restored sections
+  PersistConfig  defaults;        // Tail of sections from an older firmware
+  uint32_t       mask;            // Sections restored into staged
+  uint8_t       *program[ST_LOGIC_MAX_PROGRAMS];
+  uint32_t       program_len[ST_LOGIC_MAX_PROGRAMS];
+  uint8_t       *image[ST_LOGIC_MAX_PROGRAMS];
+  uint32_t       image_len[ST_LOGIC_MAX_PROGRAMS];
+  uint8_t        section_buf[CS_MAX_SECTION_SIZE];
+  ConfigRestoreResult res;
+};
+
+/* ============================================================================
+ * BACKUP
+ * ============================================================================ */
+
+static void backup_program(BkWriter *w, st_logic_engine_state_t *st, uint8_t id, uint16_t flags) {
+  st_logic_program_config_t *prog = &st->programs[id];
+  // Deferred source not read yet: no record, so a restore leaves the slot
+  // alone instead of clearing it
+  if (prog->source_deferred) {
+    debug_printf("[BACKUP] Source of program %u not loaded yet - skipped\n", id);
+    return;
+  }
+  const char *src = st_logic_get_source_code(st, id);
+  uint32_t src_len = src ? prog->source_size : 0;
+
+  BkProgramHeader ph;
+  memset(&ph, 0, sizeof(ph));
+  ph.enabled = prog->enabled;
+  strncpy(ph.name, prog->name, sizeof(ph.name) - 1);
+
+  // Empty slots are written too: restoring the backup clears them
+  if (bk_begin(w, BK_REC_PROGRAM, id, 1, sizeof(ph) + src_len)) {
+    bk_data(w, &ph, sizeof(ph));
+    if (src_len) bk_data(w, src, src_len);
+    bk_end(w);
+  }
+
+  if (!(flags & BK_FLAG_BYTECODE) || !src_len || !prog->compiled) return;
+  uint32_t size = st_xip_image_size(&prog->bytecode);
+  uint8_t *img = (uint8_t *)malloc(size);
+  if (!img) {
+    debug_printf("[BACKUP] No memory for %u byte image of program %u - skipped\n",
+                 (unsigned)size, id);
+    return;
+  }
+  uint32_t crc = st_crc32((const uint8_t *)src, src_len);
+  if (st_xip_build(&prog->bytecode, crc, img, size) == size) {
+    bk_record(w, BK_REC_BYTECODE, id, ST_BYTECODE_VERSION, img, size);
+  }
+  free(img);
+}
+
+BkError config_backup_write(const BkSink *sink, uint16_t flags) {
+  config_store_ensure_all();  // Lazy sections hold defaults until loaded
+
+  BkWriter *w = (BkWriter *)malloc(sizeof(BkWriter));
+  uint8_t *buf = (uint8_t *)malloc(CS_MAX_SECTION_SIZE);
+  if (!w || !buf) {
+    free(w);
+    free(buf);
+    return BK_ERR_SINK;
+  }
+  bk_writer_init(w, sink, flags);
+
+  BkInfo info;
+  memset(&info, 0, sizeof(info));
+  strncpy(info.firmware, PROJECT_VERSION, sizeof(info.firmware) - 1);
+  info.build = BUILD_NUMBER;
+  info.schema_version = g_persist_config.schema_version;
+  info.config_size = sizeof(PersistConfig);
+  bk_record(w, BK_REC_INFO, 0, 1, &info, sizeof(info));
+
+  for (uint8_t i = 0; i < CFG_SEC_COUNT; i++) {
+    ConfigSectionId id = (ConfigSectionId)i;
+    cs_gather(&g_persist_config, id, buf);
+    bk_record(w, BK_REC_SECTION, i, cs_sections[i].version, buf, cs_section_size(id));
+  }
+  free(buf);
+
+  st_logic_engine_state_t *st = st_logic_get_state();
+  if (st && (flags & BK_FLAG_SOURCES)) {
+    for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+      backup_program(w, st, i, flags);
+    }
+  }
+
+  BkError err = bk_finish(w);
+  free(w);
+  return err;
+}
+
+/* ============================================================================
+ * RESTORE
+ * ============================================================================ */
+
+static uint8_t *restore_begin_record(void *ctx, const BkRecordHeader *rec) {
+  ConfigRestore *r = (ConfigRestore *)ctx;
+  switch (rec->type) {
+    case BK_REC_SECTION:
+      if (rec->id >= CFG_SEC_COUNT || rec->len > CS_MAX_SECTION_SIZE) return NULL;
+      return r->section_buf;
+
+    case BK_REC_PROGRAM:
+      if (rec->id >= ST_LOGIC_MAX_PROGRAMS || rec->len < sizeof(BkProgramHeader)) return NULL;
+      free(r->program[rec->id]);
+      r->program[rec->id] = (uint8_t *)malloc(rec->len);
+      r->program_len[rec->id] = rec->len;
+      return r->program[rec->id];
+
+    case BK_REC_BYTECODE:
+      // Images of another compiler version are useless: skip, compile instead
+      if (rec->id >= ST_LOGIC_MAX_PROGRAMS || rec->version != ST_BYTECODE_VERSION) return NULL;
+      free(r->image[rec->id]);
+      r->image[rec->id] = (uint8_t *)malloc(rec->len);
+      r->image_len[rec->id] = rec->len;
+      return r->image[rec->id];
+
+    case BK_REC_INFO:
+      return rec->len == sizeof(BkInfo) ? r->section_buf : NULL;
+
+    default:
+      return NULL;
+  }
+}
+
+static bool restore_record(void *ctx, const BkRecordHeader *rec, uint8_t *payload) {
+  ConfigRestore *r = (ConfigRestore *)ctx;
+  switch (rec->type) {
+    case BK_REC_SECTION:
+      if (payload && cs_apply(&r->staged, (ConfigSectionId)rec->id, rec->version, payload,
+                              rec->len, &r->defaults) != CS_VERSION) {
+        r->mask |= CS_BIT(rec->id);
+        r->res.sections++;
+      } else {
+        r->res.sections_skipped++;
+      }
+      return true;
+
+    case BK_REC_PROGRAM:
+      // Slot in range but no buffer: out of memory
+      return rec->id >= ST_LOGIC_MAX_PROGRAMS || rec->len < sizeof(BkProgramHeader) || payload;
+
+    case BK_REC_INFO:
+      if (payload) {
+        BkInfo info;
+        memcpy(&info, payload, sizeof(info));
+        memcpy(r->res.firmware, info.firmware, sizeof(r->res.firmware) - 1);
+      }
+      return true;
+
+    default:
+      return true;  // Bytecode without a buffer: compiled from source instead
+  }
+}
+
+ConfigRestore *config_restore_begin(void) {
+  ConfigRestore *r = (ConfigRestore *)calloc(1, sizeof(ConfigRestore));
+  if (!r) return NULL;
+  config_store_ensure_all();  // Sections not in the backup are kept as stored
+  memcpy(&r->staged, &g_persist_config, sizeof(PersistConfig));
+  config_init_defaults(&r->defaults);
+  r->handler.ctx = r;
+  r->handler.begin = restore_begin_record;
+  r->handler.record = restore_record;
+  bk_reader_init(&r->reader, &r->handler, BACKUP_MAX_RECORD);
+  return r;
+}
+
+BkError config_restore_feed(ConfigRestore *r, const void *data, uint32_t len) {
+  return bk_reader_feed(&r->reader, data, len);
+}
+
+static void restore_program(ConfigRestore *r, st_logic_engine_state_t *st, uint8_t id) {
+  BkProgramHeader ph;
+  memcpy(&ph, r->program[id], sizeof(ph));
+  const char *src = (const char *)r->program[id] + sizeof(ph);
+  uint32_t src_len = r->program_len[id] - sizeof(ph);
+
+  st_logic_delete(st, id);
+  r->res.programs++;
+  if (src_len > 0) {
+    if (!st_logic_upload(st, id, src, src_len)) {
+      r->res.errors++;
+    } else if (r->image[id] &&
+               st_bytecode_install_image(id, r->image[id], r->image_len[id],
+                                         st_crc32((const uint8_t *)src, src_len)) &&
+               st_logic_load_cached(st, id)) {
+      r->res.cached++;
+    } else if (st_logic_compile(st, id)) {
+      r->res.compiled++;
+    } else {
+      r->res.errors++;
+    }
+  }
+
+  memcpy(st->programs[id].name, ph.name, sizeof(ph.name));
+  st->programs[id].name[sizeof(st->programs[id].name) - 1] = '\0';
+  st_logic_set_enabled(st, id, ph.enabled ? 1 : 0);
+}
+
+BkError config_restore_commit(ConfigRestore *r, ConfigRestoreResult *res) {
+  BkError err = bk_reader_finish(&r->reader);
+  if (err != BK_OK) return err;
+
+  // Programs first: st_logic_delete() drops their var_maps, which the
+  // mappings section below puts back
+  st_logic_engine_state_t *st = st_logic_get_state();
+  if (st && (r->reader.flags & BK_FLAG_SOURCES)) {
+    for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+      if (r->program[i]) restore_program(r, st, i);
+    }
+    st_logic_save_to_persist_config(&g_persist_config);
+  }
+
+  cs_copy(&g_persist_config, &r->staged, r->mask);
+  g_persist_config.schema_version = CONFIG_SCHEMA_VERSION;
+  if (config_sanitize(&g_persist_config)) {
+    debug_println("[BACKUP] Restored config had out-of-bounds counts (sanitized)");
+  }
+
+  // Users and credentials were replaced: no token issued before survives
+  session_token_revoke_all();
+
+  *res = r->res;
+  return BK_OK;
+}
+
+void config_restore_free(ConfigRestore *r) {
+  if (!r) return;
+  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+    free(r->program[i]);
+    free(r->image[i]);
+  }
+  free(r);
+}
@@ -8,25 +8,28 @@
 
 #include "config_load.h"
 #include "config_save.h"
+#include "config_store.h"
 #include "constants.h"
 #include "mb_async.h"
 #include "rbac.h"
 #include "debug.h"
 #include "debug_flags.h"
 #include "network_config.h"
+#include "counter_config.h"
 #include <nvs_flash.h>
 #include <nvs.h>
 #include <cstddef>
 #include <cstring>
+#include <cstdlib>
 
 // NVS key for storing config
-#define NVS_CONFIG_KEY "modbus_cfg"
+#define NVS_CONFIG_KEY "modbus_cfg"  // Legacy monolithic blob (read until converted)
 #define NVS_NAMESPACE  "modbus"
 
 /**
  * @brief Initialize configuration with factory defaults
  */
-static void config_init_defaults(PersistConfig* cfg) {
+void config_init_defaults(PersistConfig* cfg) {
   memset(cfg, 0, sizeof(PersistConfig));
   cfg->schema_version = CONFIG_SCHEMA_VERSION;  // Current schema version
 
@@ -107,6 +110,14 @@ static void config_init_defaults(PersistConfig* cfg) {
   memset(cfg->dashboard_card_tabs, 0, sizeof(cfg->dashboard_card_tabs));
   memset(cfg->dashboard_card_hidden, 0, sizeof(cfg->dashboard_card_hidden));
 
+  // Counter quadrature mode (v7.9.8.8) - off, velocity at smart default
+  for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+    cfg->counter_quad[i] = counter_config_quad_defaults(i + 1);
+  }
+
+  // Input interrupt mode (v7.9.9.4) - all mapped inputs polled
+  cfg->gpio_irq_pins = 0;
+
   // Initialize network config with defaults (v3.0+)
   network_config_init_defaults(&cfg->network);
 
@@ -123,6 +134,92 @@ static void config_init_defaults(PersistConfig* cfg) {
   cfg->var_map_count = 0;  // No mappings in default config
 }
 
+bool config_sanitize(PersistConfig* out) {
+  // BUG-140: Sanitize count fields to prevent out-of-bounds access
+  bool sanitized = false;
+
+  if (out->var_map_count > 32) {
+    debug_print("WARN: var_map_count=");
+    debug_print_uint(out->var_map_count);
+    debug_println(" exceeds max, clamping to 32");
+    out->var_map_count = 32;
+    sanitized = true;
+  }
+
+  if (out->persist_regs.group_count > PERSIST_MAX_GROUPS) {
+    debug_print("WARN: persist group_count=");
+    debug_print_uint(out->persist_regs.group_count);
+    debug_println(" exceeds max, clamping to 8");
+    out->persist_regs.group_count = PERSIST_MAX_GROUPS;
+    sanitized = true;
+  }
+
+  if (out->static_reg_count > MAX_DYNAMIC_REGS) {
+    debug_print("WARN: static_reg_count=");
+    debug_print_uint(out->static_reg_count);
+    debug_println(" exceeds max, clamping");
+    out->static_reg_count = MAX_DYNAMIC_REGS;
+    sanitized = true;
+  }
+
+  if (out->static_coil_count > MAX_DYNAMIC_COILS) {
+    debug_print("WARN: static_coil_count=");
+    debug_print_uint(out->static_coil_count);
+    debug_println(" exceeds max, clamping");
+    out->static_coil_count = MAX_DYNAMIC_COILS;
+    sanitized = true;
+  }
+
+  return sanitized;
+}
+
+// Clamp counts and print the load summary (legacy and sectioned load)
+static void config_sanitize_and_report(PersistConfig* out, uint16_t calculated_crc) {
+  bool sanitized = config_sanitize(out);
+
+  // Print summary
+  debug_print("CONFIG LOADED: schema=");
+  debug_print_uint(out->schema_version);
+  debug_print(", slave_id=");
+  debug_print_uint(out->modbus_slave.slave_id);
+  debug_print(", baudrate=");
+  debug_print_uint(out->modbus_slave.baudrate);
+  debug_print(", var_maps=");
+  debug_print_uint(out->var_map_count);
+  debug_print(", static_regs=");
+  debug_print_uint(out->static_reg_count);
+  debug_print(", static_coils=");
+  debug_print_uint(out->static_coil_count);
+  debug_print(", CRC=");
+  debug_print_uint(calculated_crc);
+  debug_println(" OK");
+
+  if (sanitized) {
+    debug_println("WARN: Config had out-of-bounds values (sanitized)");
+  }
+
+  // Debug: Print loaded GPIO mappings
+  if (out->var_map_count > 0) {
+    debug_println("  Loaded variable mappings:");
+    for (uint8_t i = 0; i < out->var_map_count; i++) {
+      const VariableMapping* map = &out->var_maps[i];
+      debug_print("    [");
+      debug_print_uint(i);
+      debug_print("] source_type=");
+      debug_print_uint(map->source_type);
+      debug_print(" gpio_pin=");
+      debug_print_uint(map->gpio_pin);
+      debug_print(" is_input=");
+      debug_print_uint(map->is_input);
+      debug_print(" input_reg=");
+      debug_print_uint(map->input_reg);
+      debug_print(" coil_reg=");
+      debug_print_uint(map->coil_reg);
+      debug_println("");
+    }
+  }
+}
+
 bool config_load_from_nvs(PersistConfig* out) {
   if (out == NULL) {
     debug_println("ERROR: config_load_from_nvs - NULL output");
@@ -134,6 +231,26 @@ bool config_load_from_nvs(PersistConfig* out) {
     debug_println("[LOAD_START] Loading config from NVS...");
   }
 
+  // Sectioned layout (v7.9.9.7); the legacy blob below is only read until
+  // the first complete save has converted it
+  PersistConfig* defaults = (PersistConfig*)malloc(sizeof(PersistConfig));
+  if (defaults == NULL) {
+    // Nothing is marked loaded, so no save can overwrite stored sections
+    debug_println("ERROR: Out of memory loading config, using defaults");
+    config_init_defaults(out);
+    return false;
+  }
+  config_init_defaults(defaults);
+  bool sectioned = config_store_load(out, defaults);
+  free(defaults);
+  if (sectioned) {
+    out->schema_version = CONFIG_SCHEMA_VERSION;
+    out->crc16 = config_calculate_crc16(out);
+    config_sanitize_and_report(out, out->crc16);
+    return true;
+  }
+  config_store_adopt_legacy();
+
   // Open NVS
   nvs_handle_t handle;
   esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
@@ -418,6 +535,27 @@ bool config_load_from_nvs(PersistConfig* out) {
       out->schema_version = 19;
 
       debug_println("CONFIG LOAD: Migration 18→19 complete");
+    }
+
+    if (out->schema_version == 19) {
+      debug_println("CONFIG LOAD: Migrating schema 19 → 20 (counter quadrature)");
+
+      for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        out->counter_quad[i] = counter_config_quad_defaults(i + 1);
+      }
+
+      out->schema_version = 20;
+
+      debug_println("CONFIG LOAD: Migration 19→20 complete");
+    }
+
+    if (out->schema_version == 20) {
+      debug_println("CONFIG LOAD: Migrating schema 20 → 21 (input interrupt mode)");
+
+      out->gpio_irq_pins = 0;
+      out->schema_version = 21;
+
+      debug_println("CONFIG LOAD: Migration 20→21 complete");
     } else if (out->schema_version != CONFIG_SCHEMA_VERSION) {
       debug_print("ERROR: Unsupported schema version (stored=");
       debug_print_uint(out->schema_version);
@@ -450,82 +588,6 @@ bool config_load_from_nvs(PersistConfig* out) {
     return false;  // CRITICAL FIX: Return false to indicate load failure
   }
 
-  // BUG-140: Sanitize count fields to prevent out-of-bounds access
-  bool sanitized = false;
-
-  if (out->var_map_count > 32) {
-    debug_print("WARN: var_map_count=");
-    debug_print_uint(out->var_map_count);
-    debug_println(" exceeds max, clamping to 32");
-    out->var_map_count = 32;
-    sanitized = true;
-  }
-
-  if (out->persist_regs.group_count > PERSIST_MAX_GROUPS) {
-    debug_print("WARN: persist group_count=");
-    debug_print_uint(out->persist_regs.group_count);
-    debug_println(" exceeds max, clamping to 8");
-    out->persist_regs.group_count = PERSIST_MAX_GROUPS;
-    sanitized = true;
-  }
-
-  if (out->static_reg_count > MAX_DYNAMIC_REGS) {
-    debug_print("WARN: static_reg_count=");
-    debug_print_uint(out->static_reg_count);
-    debug_println(" exceeds max, clamping");
-    out->static_reg_count = MAX_DYNAMIC_REGS;
-    sanitized = true;
-  }
-
-  if (out->static_coil_count > MAX_DYNAMIC_COILS) {
-    debug_print("WARN: static_coil_count=");
-    debug_print_uint(out->static_coil_count);
-    debug_println(" exceeds max, clamping");
-    out->static_coil_count = MAX_DYNAMIC_COILS;
-    sanitized = true;
-  }
-
-  // Print summary
-  debug_print("CONFIG LOADED: schema=");
-  debug_print_uint(out->schema_version);
-  debug_print(", slave_id=");
-  debug_print_uint(out->modbus_slave.slave_id);
-  debug_print(", baudrate=");
-  debug_print_uint(out->modbus_slave.baudrate);
-  debug_print(", var_maps=");
-  debug_print_uint(out->var_map_count);
-  debug_print(", static_regs=");
-  debug_print_uint(out->static_reg_count);
-  debug_print(", static_coils=");
-  debug_print_uint(out->static_coil_count);
-  debug_print(", CRC=");
-  debug_print_uint(calculated_crc);
-  debug_println(" OK");
-
-  if (sanitized) {
-    debug_println("WARN: Config had out-of-bounds values (sanitized)");
-  }
-
-  // Debug: Print loaded GPIO mappings
-  if (out->var_map_count > 0) {
-    debug_println("  Loaded variable mappings:");
-    for (uint8_t i = 0; i < out->var_map_count; i++) {
-      const VariableMapping* map = &out->var_maps[i];
-      debug_print("    [");
-      debug_print_uint(i);
-      debug_print("] source_type=");
-      debug_print_uint(map->source_type);
-      debug_print(" gpio_pin=");
-      debug_print_uint(map->gpio_pin);
-      debug_print(" is_input=");
-      debug_print_uint(map->is_input);
-      debug_print(" input_reg=");
-      debug_print_uint(map->input_reg);
-      debug_print(" coil_reg=");
-      debug_print_uint(map->coil_reg);
-      debug_println("");
-    }
-  }
-
+  config_sanitize_and_report(out, calculated_crc);
   return true;
 }
@@ -3,12 +3,19 @@
  * @brief Configuration persistence - save to NVS (LAYER 6)
  *
  * Saves configuration structure to non-volatile storage with CRC16 integrity
+ *
+ * v7.9.9.6: config_save_to_nvs() copies the config and queues the NVS write
+ * in the persist writer task; saves still pending are coalesced.
+ * v7.9.9.7: the writer stores only the changed sections (config_store.h).
  */
 
 #include "config_save.h"
 #include "debug.h"
 #include "debug_flags.h"
+#include "persist_writer.h"
+#include "config_store.h"
 #include <string.h>
+#include <stdlib.h>
 #include <Arduino.h>
 
 /* ============================================================================
@@ -76,19 +83,17 @@ uint16_t config_calculate_crc16(const PersistConfig* cfg) {
  * NVS STORAGE (ESP32 EEPROM emulation)
  * ============================================================================ */
 
-#include <nvs_flash.h>
-#include <nvs.h>
-
-// NVS keys for storing config
-#define NVS_CONFIG_KEY "modbus_cfg"
-#define NVS_ST_LOGIC_KEY "st_logic_%d"  // ST Logic program (0-3)
-#define NVS_NAMESPACE  "modbus"
+// Config snapshot queued for the writer: the loaded-section mask is taken
+// before the copy, so a lazy section loaded meanwhile is never written
+// with the defaults that were in RAM when the copy was made
+typedef struct {
+  PersistConfig cfg;
+  uint32_t loaded_mask;
+} ConfigSnapshot;
 
-bool config_save_to_nvs(const PersistConfig* cfg) {
-  if (cfg == NULL) {
-    debug_println("ERROR: config_save_to_nvs - NULL config");
-    return false;
-  }
+// Write a private copy of the config to NVS (the CRC is set in place)
+static bool config_write_snapshot(PersistConfig* cfg_with_crc, uint32_t loaded_mask) {
+  const PersistConfig* cfg = cfg_with_crc;
 
   // DEBUG: Print what we're about to save (if enabled)
   DebugFlags* dbg = debug_flags_get();
@@ -111,52 +116,11 @@ bool config_save_to_nvs(const PersistConfig* cfg) {
     }
   }
 
-  // Allocate temp buffer on heap to avoid stack overflow
-  // (PersistConfig is ~30KB, too large for ESP32 stack)
-  PersistConfig* cfg_with_crc = (PersistConfig*)malloc(sizeof(PersistConfig));
-  if (!cfg_with_crc) {
-    debug_println("ERROR: Failed to allocate heap buffer for config save");
-    return false;
-  }
-
-  // Copy config to heap buffer and calculate CRC
-  memcpy(cfg_with_crc, cfg, sizeof(PersistConfig));
   cfg_with_crc->crc16 = config_calculate_crc16(cfg_with_crc);
-
-  // Open NVS
-  nvs_handle_t handle;
-  esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-  if (err != ESP_OK) {
-    debug_print("ERROR: NVS open failed: ");
-    debug_print_uint(err);
-    debug_println("");
-    free(cfg_with_crc);
-    return false;
-  }
-
-  // Write config blob to NVS
-  err = nvs_set_blob(handle, NVS_CONFIG_KEY, cfg_with_crc, sizeof(PersistConfig));
-  if (err != ESP_OK) {
-    debug_print("ERROR: NVS set_blob failed: ");
-    debug_print_uint(err);
-    debug_println("");
-    nvs_close(handle);
-    free(cfg_with_crc);
-    return false;
-  }
-
-  // BUG-146 FIX: Save CRC value before freeing memory
   uint16_t saved_crc = cfg_with_crc->crc16;
 
-  // Commit to flash
-  err = nvs_commit(handle);
-  nvs_close(handle);
-  free(cfg_with_crc);
-
-  if (err != ESP_OK) {
-    debug_print("ERROR: NVS commit failed: ");
-    debug_print_uint(err);
-    debug_println("");
+  // v7.9.9.7: only sections that differ from NVS are written
+  if (!config_store_save(cfg, loaded_mask)) {
     return false;
   }
 
@@ -175,10 +139,51 @@ bool config_save_to_nvs(const PersistConfig* cfg) {
     debug_print(", static_coils=");
     debug_print_uint(cfg->static_coil_count);
     debug_print(", CRC=");
-    debug_print_uint(saved_crc);  // BUG-146 FIX: Use saved CRC instead of freed pointer
+    debug_print_uint(saved_crc);
     debug_println("");
   }
 
   return true;
 }
 
+/* ============================================================================
+ * ENTRY POINTS (v7.9.9.6: flash writes run in the persist writer task)
+ * ============================================================================ */
+
+static bool config_exec(uint16_t key, void* data, uint32_t len) {
+  (void)key;
+  if (len != sizeof(ConfigSnapshot)) return false;
+  ConfigSnapshot* snap = (ConfigSnapshot*)data;
+  return config_write_snapshot(&snap->cfg, snap->loaded_mask);
+}
+
+static ConfigSnapshot* config_snapshot(const PersistConfig* cfg) {
+  ConfigSnapshot* snap = (ConfigSnapshot*)persist_writer_alloc(sizeof(ConfigSnapshot));
+  if (snap == NULL) return NULL;
+  snap->loaded_mask = config_store_loaded_mask();
+  memcpy(&snap->cfg, cfg, sizeof(PersistConfig));
+  return snap;
+}
+
+bool config_save_to_nvs(const PersistConfig* cfg) {
+  if (cfg == NULL) {
+    debug_println("ERROR: config_save_to_nvs - NULL config");
+    return false;
+  }
+  ConfigSnapshot* snap = config_snapshot(cfg);
+  if (snap == NULL ||
+      !persist_writer_submit_owned(PW_KEY_CONFIG, config_exec, snap, sizeof(ConfigSnapshot), NULL, NULL)) {
+    debug_println("ERROR: Config save not queued (writer queue full / out of memory)");
+    return false;
+  }
+  return true;
+}
+
+bool config_save_to_nvs_wait(const PersistConfig* cfg, uint32_t timeout_ms) {
+  if (cfg == NULL) return false;
+  ConfigSnapshot* snap = config_snapshot(cfg);
+  if (snap == NULL) return false;
+  bool ok = persist_writer_submit_wait(PW_KEY_CONFIG, config_exec, snap, sizeof(ConfigSnapshot), timeout_ms);
+  free(snap);
+  return ok;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file config_sections.cpp
+ * @brief Sectioned PersistConfig storage (v7.9.9.7)
+ *
+ * LAYER 6: Persistence - Config layout (pure, no NVS)
+ * Section payloads are gathered from / scattered to the struct ranges via
+ * one stack buffer of CS_MAX_SECTION_SIZE; the host test checks that the
+ * ranges tile PersistConfig exactly (everything but crc16).
+ */
+
+#include "config_sections.h"
+#include <stddef.h>
+#include <string.h>
+
+#define CS_FIELDS(first, last) \
+  { (uint16_t)offsetof(PersistConfig, first), \
+    (uint16_t)(offsetof(PersistConfig, last) + sizeof(((PersistConfig *)0)->last) - \
+               offsetof(PersistConfig, first)) }
+
+const ConfigSection cs_sections[CFG_SEC_COUNT] = {
+  { "network",  "cs_network",  1, 2, { CS_FIELDS(network, network),
+                                       CS_FIELDS(ntp, ntp) } },
+  { "modbus",   "cs_modbus",   1, 4, { CS_FIELDS(modbus_slave, modbus_slave),
+                                       CS_FIELDS(modbus_master, modbus_master),
+                                       CS_FIELDS(modbus_mode, modbus_mode),
+                                       CS_FIELDS(modbus_slave_uart, uart2_dir_pin) } },
+  { "counters", "cs_counters", 1, 2, { CS_FIELDS(counters, timers),
+                                       CS_FIELDS(counter_quad, counter_quad) } },
+  { "mappings", "cs_mappings", 1, 2, { CS_FIELDS(static_reg_count, var_maps),
+                                       CS_FIELDS(gpio_irq_pins, gpio_irq_pins) } },
+  { "persist",  "cs_persist",  1, 2, { CS_FIELDS(persist_regs, persist_regs),
+                                       CS_FIELDS(historian, historian) } },
+  { "rbac",     "cs_rbac",     1, 1, { CS_FIELDS(rbac, rbac) } },
+  { "ui",       "cs_ui",       1, 1, { CS_FIELDS(dashboard_card_order, dashboard_card_hidden) } },
+  { "system",   "cs_system",   1, 6, { CS_FIELDS(schema_version, schema_version),
+                                       CS_FIELDS(hostname, remote_echo),
+                                       CS_FIELDS(gpio2_user_mode, gpio2_user_mode),
+                                       CS_FIELDS(st_logic_interval_ms, st_logic_interval_ms),
+                                       CS_FIELDS(module_flags, module_flags),
+                                       CS_FIELDS(ao1_mode, ao2_mode) } },
+};
+
+static uint16_t crc16_update(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+  // CRC-16/CCITT-FALSE, bitwise (sections are small)
+  for (uint32_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+void cs_init(ConfigStore *s, const CsStoreOps *ops)
+{
+  memset(s, 0, sizeof(*s));
+  s->ops = ops;
+}
+
+uint32_t cs_section_size(ConfigSectionId id)
+{
+  uint32_t n = 0;
+  for (uint8_t r = 0; r < cs_sections[id].range_count; r++) n += cs_sections[id].ranges[r].len;
+  return n;
+}
+
+uint16_t cs_section_crc(const PersistConfig *cfg, ConfigSectionId id)
+{
+  const ConfigSection *sec = &cs_sections[id];
+  uint16_t crc = 0xFFFF;
+  for (uint8_t r = 0; r < sec->range_count; r++) {
+    crc = crc16_update(crc, (const uint8_t *)cfg + sec->ranges[r].offset, sec->ranges[r].len);
+  }
+  return crc;
+}
+
+void cs_gather(const PersistConfig *cfg, ConfigSectionId id, uint8_t *out)
+{
+  const ConfigSection *sec = &cs_sections[id];
+  for (uint8_t r = 0; r < sec->range_count; r++) {
+    memcpy(out, (const uint8_t *)cfg + sec->ranges[r].offset, sec->ranges[r].len);
+    out += sec->ranges[r].len;
+  }
+}
+
+// Copy the first n payload bytes into cfg, the rest of the section from defaults
+static void scatter(PersistConfig *cfg, ConfigSectionId id, const uint8_t *in, uint32_t n,
+                    const PersistConfig *defaults)
+{
+  const ConfigSection *sec = &cs_sections[id];
+  uint32_t pos = 0;
+  for (uint8_t r = 0; r < sec->range_count; r++) {
+    uint8_t *dst = (uint8_t *)cfg + sec->ranges[r].offset;
+    uint32_t len = sec->ranges[r].len;
+    uint32_t from_in = pos >= n ? 0 : (n - pos < len ? n - pos : len);
+    if (from_in) memcpy(dst, in + pos, from_in);
+    if (from_in < len) {
+      memcpy(dst + from_in, (const uint8_t *)defaults + sec->ranges[r].offset + from_in,
+             len - from_in);
+    }
+    pos += len;
+  }
+}
+
+CsLoadResult cs_apply(PersistConfig *cfg, ConfigSectionId id, uint8_t version,
+                      const uint8_t *payload, uint32_t size, const PersistConfig *defaults)
+{
+  if (version != cs_sections[id].version) return CS_VERSION;
+  scatter(cfg, id, payload, size, defaults);
+  return size == cs_section_size(id) ? CS_LOADED : CS_RESIZED;
+}
+
+void cs_copy(PersistConfig *dst, const PersistConfig *src, uint32_t mask)
+{
+  for (uint8_t i = 0; i < CFG_SEC_COUNT; i++) {
+    if (!(mask & CS_BIT(i))) continue;
+    const ConfigSection *sec = &cs_sections[i];
+    for (uint8_t r = 0; r < sec->range_count; r++) {
+      memcpy((uint8_t *)dst + sec->ranges[r].offset, (const uint8_t *)src + sec->ranges[r].offset,
+             sec->ranges[r].len);
+    }
+  }
+}
+
+bool cs_present(ConfigStore *s)
+{
+  uint8_t buf[sizeof(CsHeader) + CS_MAX_SECTION_SIZE];
+  uint32_t len = sizeof(buf);
+  if (!s->ops->read(s->ops->ctx, cs_sections[CFG_SEC_SYSTEM].key, buf, &len)) return false;
+  CsHeader h;
+  memcpy(&h, buf, sizeof(h));
+  return len >= sizeof(h) && h.magic == CS_MAGIC && h.id == CFG_SEC_SYSTEM;
+}
+
+CsLoadResult cs_load(ConfigStore *s, PersistConfig *cfg, ConfigSectionId id,
+                     const PersistConfig *defaults)
+{
+  uint8_t buf[sizeof(CsHeader) + CS_MAX_SECTION_SIZE];
+  uint32_t len = sizeof(buf);
+  CsLoadResult res;
+
+  s->loaded |= CS_BIT(id);
+  s->crc_valid &= ~CS_BIT(id);
+  s->stats.loads++;
+
+  if (!s->ops->read(s->ops->ctx, cs_sections[id].key, buf, &len)) {
+    res = CS_MISSING;
+  } else {
+    CsHeader h;
+    memcpy(&h, buf, sizeof(h));
+    const uint8_t *payload = buf + sizeof(h);
+    if (len < sizeof(h) || h.magic != CS_MAGIC || h.id != id ||
+        h.size != len - sizeof(h) || crc16_update(0xFFFF, payload, h.size) != h.crc) {
+      res = CS_CORRUPT;
+    } else {
+      res = cs_apply(cfg, id, h.version, payload, h.size, defaults);
+      if (res == CS_LOADED) {
+        s->saved_crc[id] = h.crc;
+        s->crc_valid |= CS_BIT(id);
+      }
+      // CS_RESIZED: rewritten in the current size on next save
+      if (res != CS_VERSION) {
+        s->last_result[id] = (uint8_t)res;
+        return res;
+      }
+    }
+  }
+
+  scatter(cfg, id, NULL, 0, defaults);
+  s->last_result[id] = (uint8_t)res;
+  return res;
+}
+
+int cs_save(ConfigStore *s, const PersistConfig *cfg, uint32_t mask)
+{
+  uint8_t buf[sizeof(CsHeader) + CS_MAX_SECTION_SIZE];
+  int written = 0;
+  bool ok = true;
+
+  s->stats.saves++;
+  for (uint8_t i = 0; i < CFG_SEC_COUNT; i++) {
+    ConfigSectionId id = (ConfigSectionId)i;
+    if (!(mask & CS_BIT(id))) continue;
+
+    uint32_t size = cs_section_size(id);
+    cs_gather(cfg, id, buf + sizeof(CsHeader));
+    uint16_t crc = crc16_update(0xFFFF, buf + sizeof(CsHeader), size);
+    if ((s->crc_valid & CS_BIT(id)) && s->saved_crc[id] == crc) {
+      s->stats.skipped++;
+      continue;
+    }
+
+    CsHeader h;
+    h.magic = CS_MAGIC;
+    h.id = id;
+    h.version = cs_sections[id].version;
+    h.size = (uint16_t)size;
+    h.crc = crc;
+    memcpy(buf, &h, sizeof(h));
+
+    if (s->ops->write(s->ops->ctx, cs_sections[id].key, buf, sizeof(h) + size)) {
+      s->saved_crc[id] = crc;
+      s->crc_valid |= CS_BIT(id);
+      s->stats.written++;
+      s->stats.bytes += sizeof(h) + size;
+      written++;
+    } else {
+      s->crc_valid &= ~CS_BIT(id);
+      s->stats.errors++;
+      ok = false;
+    }
+  }
+
+  if (written > 0 && !s->ops->commit(s->ops->ctx)) {
+    s->crc_valid = 0;
+    ok = false;
+  }
+  return ok ? written : -1;
+}
+
+void cs_invalidate(ConfigStore *s)
+{
+  s->crc_valid = 0;
+}
+
+const char *cs_result_name(CsLoadResult r)
+{
+  switch (r) {
+    case CS_LOADED:  return "ok";
+    case CS_RESIZED: return "resized";
+    case CS_MISSING: return "missing";
+    case CS_CORRUPT: return "corrupt";
+    case CS_VERSION: return "version";
+    default:         return "?";
+  }
+}
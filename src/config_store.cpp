@@ -0,0 +1,203 @@
+/**
+ * @file config_store.cpp
+ * @brief NVS backend for sectioned config storage (v7.9.9.7)
+ *
+ * LAYER 6: Persistence - Config storage
+ * The store mutex serializes the boot load, lazy loads (HTTP task) and
+ * saves (persist writer task). The NVS handle is opened per operation and
+ * passed to the section engine as ops context.
+ */
+
+#include "config_store.h"
+#include "config_load.h"
+#include "config_struct.h"
+#include "debug.h"
+#include <nvs_flash.h>
+#include <nvs.h>
+#include <stdlib.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define NVS_NAMESPACE       "modbus"
+#define NVS_LEGACY_KEY      "modbus_cfg"   // Monolithic blob (schema <= 21)
+
+static ConfigStore store;
+static CsStoreOps store_ops;
+static SemaphoreHandle_t store_mutex = NULL;
+static bool legacy_blob = false;           // Erase once the layout is complete
+static bool sectioned = false;             // NVS holds every section
+
+/* ============================================================================
+ * NVS OPS (ctx = nvs_handle_t*)
+ * ============================================================================ */
+
+static bool nvs_read_op(void *ctx, const char *key, void *buf, uint32_t *len) {
+  size_t size = *len;
+  if (nvs_get_blob(*(nvs_handle_t *)ctx, key, buf, &size) != ESP_OK) return false;
+  *len = (uint32_t)size;
+  return true;
+}
+
+static bool nvs_write_op(void *ctx, const char *key, const void *buf, uint32_t len) {
+  esp_err_t err = nvs_set_blob(*(nvs_handle_t *)ctx, key, buf, len);
+  if (err != ESP_OK) {
+    debug_print("ERROR: NVS set_blob ");
+    debug_print(key);
+    debug_print(" failed: ");
+    debug_print_uint(err);
+    debug_println("");
+    return false;
+  }
+  return true;
+}
+
+static bool nvs_commit_op(void *ctx) {
+  return nvs_commit(*(nvs_handle_t *)ctx) == ESP_OK;
+}
+
+static void store_lock(void) {
+  if (store_mutex == NULL) {
+    store_mutex = xSemaphoreCreateMutex();
+    store_ops.read = nvs_read_op;
+    store_ops.write = nvs_write_op;
+    store_ops.commit = nvs_commit_op;
+    cs_init(&store, &store_ops);
+  }
+  xSemaphoreTake(store_mutex, portMAX_DELAY);
+}
+
+static void store_unlock(void) {
+  xSemaphoreGive(store_mutex);
+}
+
+/* ============================================================================
+ * LOAD
+ * ============================================================================ */
+
+bool config_store_load(PersistConfig *out, const PersistConfig *defaults) {
+  nvs_handle_t handle;
+  if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) return false;
+
+  store_lock();
+  store_ops.ctx = &handle;
+  bool present = cs_present(&store);
+  if (present) {
+    memcpy(out, defaults, sizeof(PersistConfig));
+    for (uint8_t i = 0; i < CFG_SEC_COUNT; i++) {
+      if (CONFIG_STORE_LAZY & CS_BIT(i)) continue;
+      CsLoadResult r = cs_load(&store, out, (ConfigSectionId)i, defaults);
+      if (r != CS_LOADED) {
+        debug_print("CONFIG LOAD: Section '");
+        debug_print(cs_sections[i].name);
+        debug_print("' ");
+        debug_print(cs_result_name(r));
+        debug_println(r == CS_RESIZED ? " - new fields use defaults" : " - using defaults");
+      }
+    }
+    sectioned = true;
+    // Legacy blob left behind by an interrupted cleanup
+    size_t legacy_size = 0;
+    legacy_blob = nvs_get_blob(handle, NVS_LEGACY_KEY, NULL, &legacy_size) == ESP_OK;
+  }
+  store_ops.ctx = NULL;
+  store_unlock();
+  nvs_close(handle);
+  return present;
+}
+
+void config_store_adopt_legacy(void) {
+  store_lock();
+  store.loaded = CS_ALL;
+  cs_invalidate(&store);
+  legacy_blob = true;
+  store_unlock();
+}
+
+void config_store_ensure(ConfigSectionId id) {
+  store_lock();
+  if (store.loaded & CS_BIT(id)) {
+    store_unlock();
+    return;
+  }
+
+  PersistConfig *defaults = (PersistConfig *)malloc(sizeof(PersistConfig));
+  nvs_handle_t handle;
+  bool opened = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK;
+  if (defaults && opened) {
+    config_init_defaults(defaults);
+    store_ops.ctx = &handle;
+    CsLoadResult r = cs_load(&store, &g_persist_config, id, defaults);
+    store_ops.ctx = NULL;
+    if (r != CS_LOADED) {
+      debug_print("CONFIG: Section '");
+      debug_print(cs_sections[id].name);
+      debug_print("' ");
+      debug_println(cs_result_name(r));
+    }
+  } else {
+    // No NVS / no memory: keep the defaults in RAM but never write them
+    // over what may be stored
+    debug_print("ERROR: Could not load config section '");
+    debug_print(cs_sections[id].name);
+    debug_println("'");
+  }
+  if (opened) nvs_close(handle);
+  free(defaults);
+  store_unlock();
+}
+
+void config_store_ensure_all(void) {
+  for (uint8_t i = 0; i < CFG_SEC_COUNT; i++) {
+    config_store_ensure((ConfigSectionId)i);
+  }
+}
+
+uint32_t config_store_loaded_mask(void) {
+  store_lock();
+  uint32_t mask = store.loaded;
+  store_unlock();
+  return mask;
+}
+
+/* ============================================================================
+ * SAVE (persist writer task)
+ * ============================================================================ */
+
+bool config_store_save(const PersistConfig *cfg, uint32_t mask) {
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+  if (err != ESP_OK) {
+    debug_print("ERROR: NVS open failed: ");
+    debug_print_uint(err);
+    debug_println("");
+    return false;
+  }
+
+  store_lock();
+  store_ops.ctx = &handle;
+  int written = cs_save(&store, cfg, mask);
+  store_ops.ctx = NULL;
+
+  // Conversion done once every section is stored: drop the legacy blob
+  if (written >= 0 && mask == CS_ALL) sectioned = true;
+  if (written >= 0 && legacy_blob && sectioned) {
+    nvs_erase_key(handle, NVS_LEGACY_KEY);
+    if (nvs_commit(handle) == ESP_OK) {
+      legacy_blob = false;
+      debug_println("CONFIG SAVE: Converted to sectioned storage");
+    }
+  }
+  store_unlock();
+  nvs_close(handle);
+
+  return written >= 0;
+}
+
+void config_store_get_info(CsStats *stats, uint32_t *loaded, uint8_t last_result[CFG_SEC_COUNT]) {
+  store_lock();
+  if (stats) *stats = store.stats;
+  if (loaded) *loaded = store.loaded;
+  if (last_result) memcpy(last_result, store.last_result, CFG_SEC_COUNT);
+  store_unlock();
+}
@@ -16,6 +16,7 @@
  * ============================================================================ */
 
 static CounterConfig counter_configs[COUNTER_COUNT];
+static CounterQuadConfig counter_quad_configs[COUNTER_COUNT];  // FEAT-157
 
 /* ============================================================================
  * INITIALIZATION
@@ -24,6 +25,7 @@ static CounterConfig counter_configs[COUNTER_COUNT];
 void counter_config_init(void) {
   for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
     counter_configs[i] = counter_config_defaults(i + 1);
+    counter_quad_configs[i] = counter_config_quad_defaults(i + 1);
   }
 }
 
@@ -51,7 +53,7 @@ CounterConfig counter_config_defaults(uint8_t id) {
   uint16_t base = 100 + ((id - 1) * 20);
   cfg.value_reg = base + 0;          // 100, 120, 140, 160 (uses +0,+1,+2,+3 for 64-bit)
   cfg.raw_reg = base + 4;            // 104, 124, 144, 164 (uses +4,+5,+6,+7 for 64-bit)
-  cfg.freq_reg = base + 8;           // 108, 128, 148, 168 (16-bit, uses 1 reg)
+  cfg.freq_reg = base + 8;           // 108, 128, 148, 168 (16-bit, +9 = mHz fraction in reciprocal mode)
   cfg.ctrl_reg = base + 10;          // 110, 130, 150, 170 (16-bit, uses 1 reg, bit 3 = overflow)
   cfg.compare_value_reg = base + 11; // 111, 131, 151, 171 (uses +11,+12,+13,+14 for 64-bit)
 
@@ -69,11 +71,26 @@ CounterConfig counter_config_defaults(uint8_t id) {
   cfg.reset_on_read = 1;         // Auto-clear bit 4 on ctrl-reg read by default
   cfg.compare_source = 1;        // BUG-040: 1 = prescaled (most intuitive)
 
+  cfg.freq_mode = COUNTER_FREQ_GATE;  // FEAT-154: Reciprocal mode uses freq_reg+1 for mHz
+
   // Note: Compare status stored in ctrl_reg bit 4 (no register/bit config needed)
 
   return cfg;
 }
 
+CounterQuadConfig counter_config_quad_defaults(uint8_t id) {
+  CounterQuadConfig q = {0};
+  q.mode = COUNTER_QUAD_OFF;
+  q.gpio_b = 0;
+  q.glitch_ns = 0;
+  // FEAT-157: Smart default in the free tail of the counter's 20-register
+  // block: 115, 135, 155, 175 (+15,+16 int32). Only written in quad mode.
+  q.velocity_reg = 100 + ((id - 1) * 20) + 15;
+  q.velocity_filter_ms = COUNTER_VEL_FILTER_MS;
+  q.velocity_sample_ms = COUNTER_VEL_SAMPLE_MS;
+  return q;
+}
+
 /* ============================================================================
  * VALIDATION
  * ============================================================================ */
@@ -122,6 +139,9 @@ void counter_config_sanitize(CounterConfig* cfg) {
   // Clamp compare mode to valid values (0-2)
   if (cfg->compare_mode > 2) cfg->compare_mode = 0;
 
+  // FEAT-154: Unknown frequency mode falls back to gate
+  if (cfg->freq_mode > COUNTER_FREQ_RECIPROCAL) cfg->freq_mode = COUNTER_FREQ_GATE;
+
   // Note: Compare status stored in ctrl_reg bit 4, no additional validation needed
 }
 
@@ -155,3 +175,39 @@ bool counter_config_set(uint8_t id, const CounterConfig* cfg) {
 CounterConfig* counter_config_get_all(void) {
   return counter_configs;
 }
+
+/* ============================================================================
+ * QUADRATURE CONFIGURATION ACCESS (FEAT-157)
+ * ============================================================================ */
+
+bool counter_config_get_quad(uint8_t id, CounterQuadConfig* out) {
+  if (id < 1 || id > COUNTER_COUNT || out == NULL) return false;
+
+  *out = counter_quad_configs[id - 1];
+  return true;
+}
+
+bool counter_config_set_quad(uint8_t id, const CounterQuadConfig* q) {
+  if (id < 1 || id > COUNTER_COUNT || q == NULL) return false;
+
+  CounterQuadConfig sanitized = *q;
+  if (sanitized.mode != COUNTER_QUAD_X1 && sanitized.mode != COUNTER_QUAD_X2 &&
+      sanitized.mode != COUNTER_QUAD_X4) {
+    sanitized.mode = COUNTER_QUAD_OFF;
+  }
+  if (sanitized.glitch_ns > 12787) sanitized.glitch_ns = 12787;  // 1023 APB cycles
+  if (sanitized.velocity_reg != 0xFFFF && sanitized.velocity_reg + 1 >= HOLDING_REGS_SIZE) {
+    sanitized.velocity_reg = 0xFFFF;
+  }
+  if (sanitized.velocity_sample_ms < 1) sanitized.velocity_sample_ms = 1;
+  counter_quad_configs[id - 1] = sanitized;
+
+  return true;
+}
+
+bool counter_config_is_quad(uint8_t id) {
+  if (id < 1 || id > COUNTER_COUNT) return false;
+  return counter_configs[id - 1].hw_mode == COUNTER_HW_PCNT &&
+         counter_quad_configs[id - 1].mode != COUNTER_QUAD_OFF &&
+         counter_quad_configs[id - 1].gpio_b > 0;
+}
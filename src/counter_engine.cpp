@@ -18,6 +18,9 @@
  * - value register = counterValue × scale
  * - raw register = counterValue / prescaler
  * - frequency register = measured Hz (no prescaler)
+ * - frequency register + 1 = mHz fraction (reciprocal freq_mode only)
+ * - quadrature (FEAT-157): value/raw are signed (two's complement at
+ *   bit_width), frequency register = |velocity|, velocity register = int32
  *
  * Context: This is the "orchestrator" that ties all modes together
  */
@@ -34,6 +37,8 @@
 #include <string.h>
 #include <math.h>
 #include <Arduino.h>  // For millis()
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 /* ============================================================================
  * GLOBAL STATE
@@ -53,6 +58,9 @@ static CounterCompareRuntime counter_compare_state[COUNTER_COUNT];
 // Simple spinlock: write lock bit during multi-word register updates
 static volatile uint8_t counter_write_lock[COUNTER_COUNT] = {0, 0, 0, 0};
 
+// FEAT-155: Compare check runs from the loop and from the PCNT event task
+static SemaphoreHandle_t counter_compare_mutex = NULL;
+
 // Forward declaration for compare check function
 static void counter_engine_check_compare(uint8_t id, uint64_t counter_value);
 
@@ -63,6 +71,7 @@ static void counter_engine_check_compare(uint8_t id, uint64_t counter_value);
 void counter_engine_init(void) {
   // Initialize configuration system
   counter_config_init();
+  counter_hw_module_init();
 
   // BUG FIX 1.6: Don't init counters here with default config
   // Init will be called by counter_engine_configure() when config is applied
@@ -76,6 +85,9 @@ void counter_engine_init(void) {
 
   // COMPARE FEATURE: Initialize runtime state (v2.3+)
   memset(counter_compare_state, 0, sizeof(counter_compare_state));
+  if (counter_compare_mutex == NULL) {
+    counter_compare_mutex = xSemaphoreCreateMutex();
+  }
 }
 
 /* ============================================================================
@@ -383,6 +395,7 @@ void counter_engine_store_value_to_registers(uint8_t id) {
 
   // Get current value from appropriate mode
   uint64_t counter_value = counter_engine_get_value(id);
+  bool quad = (cfg.hw_mode == COUNTER_HW_PCNT) && counter_hw_is_quadrature(id);
 
   // FIX P0.7: PCNT hardware counts ONLY the configured edges (rising/falling/both)
   // Previous code incorrectly assumed PCNT always counts both edges and divided by 2
@@ -404,6 +417,14 @@ void counter_engine_store_value_to_registers(uint8_t id) {
   double scale = (cfg.scale_factor > 0.0f) ? (double)cfg.scale_factor : 1.0;
   double scaled_float = (double)counter_value * scale;
 
+  // FEAT-157: Quadrature position is signed, divide/scale before wrapping
+  int64_t position = 0;
+  if (quad) {
+    position = counter_hw_get_position(id);
+    raw_value = (uint64_t)(position / (int64_t)(cfg.prescaler > 1 ? cfg.prescaler : 1));
+    scaled_float = (double)position * scale;
+  }
+
   // Clamp to bit width
   uint8_t bw = cfg.bit_width;
   uint64_t max_val = 0;
@@ -423,10 +444,18 @@ void counter_engine_store_value_to_registers(uint8_t id) {
       break;
   }
 
-  if (scaled_float < 0.0) scaled_float = 0.0;
-  if (scaled_float > (double)max_val) scaled_float = (double)max_val;
-
-  uint64_t scaled_value = (uint64_t)(scaled_float + 0.5);  // Round to nearest
+  uint64_t scaled_value;
+  if (quad) {
+    // Round half away from zero, wrap to bit width like the raw value
+    double r = (scaled_float < 0.0) ? scaled_float - 0.5 : scaled_float + 0.5;
+    if (r > 9.2e18) r = 9.2e18;
+    if (r < -9.2e18) r = -9.2e18;
+    scaled_value = (uint64_t)(int64_t)r;
+  } else {
+    if (scaled_float < 0.0) scaled_float = 0.0;
+    if (scaled_float > (double)max_val) scaled_float = (double)max_val;
+    scaled_value = (uint64_t)(scaled_float + 0.5);  // Round to nearest
+  }
   scaled_value &= max_val;
   raw_value &= max_val;
 
@@ -456,10 +485,31 @@ void counter_engine_store_value_to_registers(uint8_t id) {
   // Release write lock
   counter_write_lock[lock_id] = 0;
 
+  // FEAT-157: Velocity (counts/s, int32 LSW first); freq_reg gets |velocity|
+  int32_t velocity = quad ? counter_hw_get_velocity(id) : 0;
+  if (quad) {
+    CounterQuadConfig qcfg;
+    if (counter_config_get_quad(id, &qcfg) && qcfg.velocity_reg + 1 < HOLDING_REGS_SIZE) {
+      registers_set_holding_register(qcfg.velocity_reg, (uint16_t)((uint32_t)velocity & 0xFFFF));
+      registers_set_holding_register(qcfg.velocity_reg + 1, (uint16_t)((uint32_t)velocity >> 16));
+    }
+  }
+
   // Write frequency to freq register (no prescaler compensation)
   if (cfg.freq_reg < HOLDING_REGS_SIZE) {
     uint16_t freq_hz = counter_frequency_get(id);
+    if (quad) {
+      uint32_t speed = (velocity < 0) ? (uint32_t)(-(int64_t)velocity) : (uint32_t)velocity;
+      freq_hz = (speed > 65535) ? 65535 : (uint16_t)speed;
+    }
     registers_set_holding_register(cfg.freq_reg, freq_hz);
+
+    // FEAT-154: Reciprocal mode adds the mHz fraction in the next register
+    // (Hz = freq_reg + freq_reg+1 / 1000)
+    if (cfg.freq_mode == COUNTER_FREQ_RECIPROCAL && cfg.freq_reg + 1 < HOLDING_REGS_SIZE) {
+      uint32_t mhz = counter_frequency_get_mhz(id);
+      registers_set_holding_register(cfg.freq_reg + 1, (uint16_t)(mhz % 1000));
+    }
   }
 
   // Write overflow flag to ctrl_reg bit 3
@@ -508,7 +558,62 @@ void counter_engine_store_value_to_registers(uint8_t id) {
  * COMPARE FEATURE (v2.3+)
  * ============================================================================ */
 
+// BUG-030: Read compare_value from Modbus register (allows runtime modification)
+static uint64_t counter_engine_read_compare_value(const CounterConfig* cfg) {
+  uint64_t compare_value = cfg->compare_value;  // Fallback to config value
+  if (cfg->compare_value_reg < HOLDING_REGS_SIZE) {
+    uint8_t words = (cfg->bit_width <= 16) ? 1 : (cfg->bit_width == 32) ? 2 : 4;
+    compare_value = 0;
+    for (uint8_t w = 0; w < words && cfg->compare_value_reg + w < HOLDING_REGS_SIZE; w++) {
+      uint16_t word = registers_get_holding_register(cfg->compare_value_reg + w);
+      compare_value |= ((uint64_t)word) << (16 * w);
+    }
+  }
+  return compare_value;
+}
+
+static void counter_engine_check_compare_locked(uint8_t id, uint64_t counter_value);
+
+// Serialized: loop() and the PCNT event task (higher priority) may both check
 static void counter_engine_check_compare(uint8_t id, uint64_t counter_value) {
+  if (counter_compare_mutex) xSemaphoreTake(counter_compare_mutex, portMAX_DELAY);
+  counter_engine_check_compare_locked(id, counter_value);
+  if (counter_compare_mutex) xSemaphoreGive(counter_compare_mutex);
+}
+
+void counter_engine_compare_event(uint8_t id) {
+  if (id < 1 || id > 4) return;
+  counter_engine_check_compare(id, counter_engine_get_value(id));
+}
+
+bool counter_engine_compare_target(uint8_t id, uint64_t* out_raw) {
+  if (id < 1 || id > 4 || out_raw == NULL) return false;
+
+  CounterConfig cfg;
+  if (!counter_config_get(id, &cfg) || !cfg.compare_enabled) return false;
+  // All compare modes trigger on a rising crossing, which DOWN counting only
+  // produces at wrap - leave that to the loop check
+  if (cfg.direction == COUNTER_DIR_DOWN) return false;
+
+  uint64_t compare_value = counter_engine_read_compare_value(&cfg);
+  // Mode 1 (>) needs one more than the compare value in the source domain
+  uint64_t source_target = (cfg.compare_mode == 1) ? compare_value + 1 : compare_value;
+
+  if (cfg.compare_source == 1) {
+    uint64_t prescaler = (cfg.prescaler > 1) ? cfg.prescaler : 1;
+    *out_raw = source_target * prescaler;
+  } else if (cfg.compare_source == 2) {
+    // Scaled source is rounded: round(v * scale) >= t  <=>  v >= (t - 0.5) / scale
+    double scale = (cfg.scale_factor > 0.0f) ? (double)cfg.scale_factor : 1.0;
+    double raw = ((double)source_target - 0.5) / scale;
+    *out_raw = (raw <= 0.0) ? 0 : (uint64_t)ceil(raw);
+  } else {
+    *out_raw = source_target;
+  }
+  return true;
+}
+
+static void counter_engine_check_compare_locked(uint8_t id, uint64_t counter_value) {
   if (id < 1 || id > 4) return;
 
   CounterConfig cfg;
@@ -521,15 +626,7 @@ static void counter_engine_check_compare(uint8_t id, uint64_t counter_value) {
   }
 
   // BUG-030: Read compare_value from Modbus register (allows runtime modification)
-  uint64_t compare_value = cfg.compare_value;  // Fallback to config value
-  if (cfg.compare_value_reg < HOLDING_REGS_SIZE) {
-    uint8_t words = (cfg.bit_width <= 16) ? 1 : (cfg.bit_width == 32) ? 2 : 4;
-    compare_value = 0;
-    for (uint8_t w = 0; w < words && cfg.compare_value_reg + w < HOLDING_REGS_SIZE; w++) {
-      uint16_t word = registers_get_holding_register(cfg.compare_value_reg + w);
-      compare_value |= ((uint64_t)word) << (16 * w);
-    }
-  }
+  uint64_t compare_value = counter_engine_read_compare_value(&cfg);
 
   // BUG-040 FIX: Calculate compare source value based on compare_source setting
   // 0 = raw (hardware counter), 1 = prescaled (÷ prescaler), 2 = scaled (× scale)
@@ -639,6 +736,18 @@ uint64_t counter_engine_get_value(uint8_t id) {
   }
 }
 
+int64_t counter_engine_get_position(uint8_t id) {
+  if (id < 1 || id > 4) return 0;
+  if (counter_hw_is_quadrature(id)) return counter_hw_get_position(id);
+  return (int64_t)counter_engine_get_value(id);
+}
+
+int32_t counter_engine_get_velocity(uint8_t id) {
+  if (id < 1 || id > 4) return 0;
+  if (counter_hw_is_quadrature(id)) return counter_hw_get_velocity(id);
+  return (int32_t)counter_frequency_get(id);
+}
+
 void counter_engine_set_value(uint8_t id, uint64_t value) {
   if (id < 1 || id > 4) return;
 
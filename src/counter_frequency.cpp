@@ -20,12 +20,21 @@
  * 6. Reset on timeout (5+ sec) or counter reset
  *
  * Works identically for all counter modes (SW/ISR/HW)
+ *
+ * FEAT-154: Reciprocal mode (cfg.freq_mode = COUNTER_FREQ_RECIPROCAL)
+ * measures the time between edges via freq_estimator (mHz resolution):
+ * - ISR mode: exact per-edge micros() timestamps from the interrupt
+ * - SW/PCNT: edges seen per loop pass, stamped with micros() at the pass
+ *   (error ~ loop time / gate, hence the longer minimum gate)
  */
 
 #include "counter_frequency.h"
 #include "counter_config.h"  // BUG FIX 1.8: Need config for bit_width
 #include "registers.h"
 #include "constants.h"
+#include "counter_sw_isr.h"
+#include "freq_estimator.h"
+#include <Arduino.h>
 #include <string.h>
 
 /* ============================================================================
@@ -37,10 +46,84 @@ typedef struct {
   uint64_t last_count;         // Count at last measurement
   uint32_t last_measure_ms;    // Timestamp of last measurement (0 = not started)
   uint8_t window_valid;        // Timing window is valid for calculation
+
+  // FEAT-154: Reciprocal mode
+  FreqEstimator est;           // Period estimator state
+  uint32_t freq_mhz;           // Last estimate in milli-Hz (both modes)
+  uint32_t edge_total;         // SW/PCNT: edges accumulated from value deltas
+  uint32_t edge_us;            // SW/PCNT: micros() of the pass that saw the last edge
+  uint64_t edge_last_value;    // SW/PCNT: counter value at last pass
+  uint8_t est_ready;           // est + edge tracking initialized
 } FrequencyState;
 
 static FrequencyState freq_state[4] = {0};
 
+// Reciprocal mode timing. A measurement closes on the first edge after
+// min_gate, so low rates update every period and high rates every min_gate.
+static const FreqEstConfig FREQ_EST_ISR = {100000UL, 10000000UL};        // 100 ms gate, 0.1 Hz floor
+static const FreqEstConfig FREQ_EST_SAMPLED = {1000000UL, 10000000UL};   // 1 s gate, 0.1 Hz floor
+
+/* ============================================================================
+ * COUNT DELTA (direction and bit-width aware)
+ * ============================================================================ */
+
+// Edges between two counter values. Returns false if the delta looks like a
+// reset/reload rather than a wrap.
+static bool counter_frequency_delta(const CounterConfig* cfg, uint64_t last, uint64_t current,
+                                    uint64_t* out_delta) {
+  // BUG-184 FIX: Direction-aware frequency calculation
+  // UP counting: current_value >= last_count is normal
+  // DOWN counting: current_value <= last_count is normal
+  uint64_t max_val = 0xFFFFFFFFFFFFFFFFULL;  // Default 64-bit
+  switch (cfg->bit_width) {
+    case 8:
+      max_val = 0xFFULL;
+      break;
+    case 16:
+      max_val = 0xFFFFULL;
+      break;
+    case 32:
+      max_val = 0xFFFFFFFFULL;
+      break;
+    // 64-bit: use default
+  }
+
+  uint64_t delta_count = 0;
+  if (cfg->direction == COUNTER_DIR_DOWN) {
+    // DOWN counting: value decreases over time
+    if (current <= last) {
+      // Normal: count decreased
+      delta_count = last - current;
+    } else {
+      // Underflow wrap-around: counter wrapped from 0 to start_value
+      // Example: last=5, current=995, start=1000 → wrapped, delta = 5 + (1000 - 995) = 10
+      delta_count = last + (cfg->start_value - current) + 1;
+
+      // Sanity check: if delta is unreasonably large (>50% of start_value), skip
+      if (cfg->start_value > 0 && delta_count > cfg->start_value / 2) {
+        return false;
+      }
+    }
+  } else {
+    // UP counting: value increases over time (original logic)
+    if (current >= last) {
+      // Normal: count increased
+      delta_count = current - last;
+    } else {
+      // Overflow wrap-around
+      delta_count = (max_val - last) + current + 1;
+
+      // Sanity check: if delta is unreasonably large (>50% of max), skip
+      if (delta_count > max_val / 2) {
+        return false;
+      }
+    }
+  }
+
+  *out_delta = delta_count;
+  return true;
+}
+
 /* ============================================================================
  * INITIALIZATION
  * ============================================================================ */
@@ -53,6 +136,69 @@ void counter_frequency_init(uint8_t id) {
   state->last_count = 0;
   state->last_measure_ms = 0;
   state->window_valid = 0;
+  state->freq_mhz = 0;
+  state->est_ready = 0;
+}
+
+/* ============================================================================
+ * RECIPROCAL MODE (FEAT-154)
+ * ============================================================================ */
+
+static uint16_t counter_frequency_update_reciprocal(uint8_t id, FrequencyState* state,
+                                                    const CounterConfig* cfg, uint64_t current_value) {
+  uint32_t now_us = micros();
+  uint32_t edge_count = 0;
+  uint32_t edge_us = 0;
+  const FreqEstConfig* est_cfg = &FREQ_EST_SAMPLED;
+
+  if (cfg->hw_mode == COUNTER_HW_SW_ISR &&
+      counter_sw_isr_get_edge_sample(id, &edge_count, &edge_us)) {
+    est_cfg = &FREQ_EST_ISR;
+  } else {
+    // SW/PCNT: no per-edge timestamp, count edges from value deltas
+    if (!state->est_ready) {
+      state->edge_last_value = current_value;
+      state->edge_us = now_us;
+    }
+    uint64_t delta = 0;
+    if (current_value != state->edge_last_value) {
+      if (counter_frequency_delta(cfg, state->edge_last_value, current_value, &delta) &&
+          delta <= 100000ULL) {
+        state->edge_total += (uint32_t)delta;
+        state->edge_us = now_us;
+      } else {
+        // Reload/reset: restart the measurement
+        state->est_ready = 0;
+      }
+      state->edge_last_value = current_value;
+    }
+    edge_count = state->edge_total;
+    edge_us = state->edge_us;
+  }
+
+  if (!state->est_ready) {
+    freq_est_reset(&state->est, edge_count);
+    state->freq_mhz = 0;
+    state->current_hz = 0;
+    state->window_valid = 0;
+    state->est_ready = 1;
+    return 0;
+  }
+
+  if (freq_est_update(&state->est, est_cfg, edge_count, edge_us, now_us)) {
+    state->window_valid = 1;
+    state->last_measure_ms = registers_get_millis();
+  }
+  if (state->est.method == FREQ_EST_NONE) {
+    state->window_valid = 0;
+  }
+
+  // Same 0-20000 Hz register range as gate mode. Integer part only, so
+  // freq_reg + (freq_reg+1)/1000 is the exact value.
+  state->freq_mhz = state->est.freq_mhz;
+  if (state->freq_mhz > 20000000UL) state->freq_mhz = 20000000UL;
+  state->current_hz = (uint16_t)(state->freq_mhz / 1000);
+  return state->current_hz;
 }
 
 /* ============================================================================
@@ -69,6 +215,11 @@ uint16_t counter_frequency_update(uint8_t id, uint64_t current_value) {
   CounterConfig cfg;
   if (!counter_config_get(id, &cfg)) return state->current_hz;
 
+  if (cfg.freq_mode == COUNTER_FREQ_RECIPROCAL) {
+    return counter_frequency_update_reciprocal(id, state, &cfg, current_value);
+  }
+  state->est_ready = 0;  // Mode switched back to gate: re-arm on next switch
+
   // First-time initialization
   if (state->last_measure_ms == 0) {
     state->last_measure_ms = now_ms;
@@ -87,55 +238,7 @@ uint16_t counter_frequency_update(uint8_t id, uint64_t current_value) {
 
     // Calculate count delta (handle wrap-around)
     uint64_t delta_count = 0;
-    uint8_t valid_delta = 1;
-
-    // BUG-184 FIX: Direction-aware frequency calculation
-    // UP counting: current_value >= last_count is normal
-    // DOWN counting: current_value <= last_count is normal
-    uint64_t max_val = 0xFFFFFFFFFFFFFFFFULL;  // Default 64-bit
-    switch (cfg.bit_width) {
-      case 8:
-        max_val = 0xFFULL;
-        break;
-      case 16:
-        max_val = 0xFFFFULL;
-        break;
-      case 32:
-        max_val = 0xFFFFFFFFULL;
-        break;
-      // 64-bit: use default
-    }
-
-    if (cfg.direction == COUNTER_DIR_DOWN) {
-      // DOWN counting: value decreases over time
-      if (current_value <= state->last_count) {
-        // Normal: count decreased
-        delta_count = state->last_count - current_value;
-      } else {
-        // Underflow wrap-around: counter wrapped from 0 to start_value
-        // Example: last=5, current=995, start=1000 → wrapped, delta = 5 + (1000 - 995) = 10
-        delta_count = state->last_count + (cfg.start_value - current_value) + 1;
-
-        // Sanity check: if delta is unreasonably large (>50% of start_value), skip
-        if (cfg.start_value > 0 && delta_count > cfg.start_value / 2) {
-          valid_delta = 0;
-        }
-      }
-    } else {
-      // UP counting: value increases over time (original logic)
-      if (current_value >= state->last_count) {
-        // Normal: count increased
-        delta_count = current_value - state->last_count;
-      } else {
-        // Overflow wrap-around
-        delta_count = (max_val - state->last_count) + current_value + 1;
-
-        // Sanity check: if delta is unreasonably large (>50% of max), skip
-        if (delta_count > max_val / 2) {
-          valid_delta = 0;
-        }
-      }
-    }
+    uint8_t valid_delta = counter_frequency_delta(&cfg, state->last_count, current_value, &delta_count) ? 1 : 0;
 
     // Validate delta against max 100 kHz threshold (1000 counts/10ms)
     if (valid_delta && delta_count <= 100000UL) {
@@ -150,6 +253,7 @@ uint16_t counter_frequency_update(uint8_t id, uint64_t current_value) {
       }
 
       state->current_hz = (uint16_t)freq_calc;
+      state->freq_mhz = freq_calc * 1000UL;
     }
     // else: keep last valid value
 
@@ -162,6 +266,7 @@ uint16_t counter_frequency_update(uint8_t id, uint64_t current_value) {
     state->last_measure_ms = now_ms;
     state->last_count = current_value;
     state->current_hz = 0;
+    state->freq_mhz = 0;
     state->window_valid = 0;
   }
 
@@ -177,6 +282,11 @@ uint16_t counter_frequency_get(uint8_t id) {
   return freq_state[id - 1].current_hz;
 }
 
+uint32_t counter_frequency_get_mhz(uint8_t id) {
+  if (id < 1 || id > 4) return 0;
+  return freq_state[id - 1].freq_mhz;
+}
+
 void counter_frequency_reset(uint8_t id) {
   if (id < 1 || id > 4) return;
 
@@ -185,6 +295,8 @@ void counter_frequency_reset(uint8_t id) {
   state->last_count = 0;
   state->last_measure_ms = 0;
   state->window_valid = 0;
+  state->freq_mhz = 0;
+  state->est_ready = 0;
 }
 
 bool counter_frequency_is_valid(uint8_t id, uint16_t* out_hz, uint32_t* out_window) {
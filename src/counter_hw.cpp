@@ -10,28 +10,53 @@
  * - Reading pulse counts directly from PCNT hardware
  * - Overflow handling
  * - Value accumulation and tracking
- * - BUG FIX P0.6: Dedicated RTOS task for high-frequency PCNT polling
+ * - FEAT-155: Event-driven (replaces BUG FIX P0.6 10 ms polling task)
+ *
+ * Value model (FEAT-155):
+ *   edges = pcnt_unit_get_total()  (64-bit, extended by limit-event ISR)
+ *   value = base_value +/- (edges - base_edges), wrapped to bit_width
+ * base_value/base_edges only change on set/reset/wrap and are published
+ * with a seqlock, so readers on any core get a consistent 64-bit value
+ * without locks. A threshold event is armed at the count where the compare
+ * value will be reached; pcnt_event_task runs the compare check then.
+ * With no input there are no interrupts and no wake-ups.
+ *
+ * Quadrature (FEAT-157): hw_gpio = A, CounterQuadConfig.gpio_b = B. The
+ * unit counts both ways, so the position is signed and never folded:
+ *   position = base_value +/- (edges - base_edges)
+ *   value    = position wrapped to bit_width (two's complement)
+ * Velocity is sampled from the position in counter_hw_loop().
  */
 
 #include "counter_hw.h"
 #include "counter_config.h"
+#include "counter_engine.h"
 #include "pcnt_driver.h"
+#include "quad_decoder.h"
 #include "registers.h"
 #include "constants.h"
 #include "types.h"
 #include <string.h>
 #include <driver/pcnt.h>  // BUG FIX P0: Include ESP-IDF PCNT for pause/resume
 #include <esp_log.h>
-#include <Arduino.h>  // For millis()
+#include <Arduino.h>  // For millis(), micros()
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
 
 /* ============================================================================
  * HW MODE RUNTIME STATE (per counter)
- * Uses CounterHWState from types.h
+ * Uses CounterHWState from types.h: pcnt_value = value at base_edges
  * ============================================================================ */
 
 static CounterHWState hw_state[COUNTER_COUNT] = {0};
+static uint64_t hw_base_edges[COUNTER_COUNT] = {0};     // Extended PCNT count at pcnt_value
+static volatile uint32_t hw_base_seq[COUNTER_COUNT] = {0};  // Odd while base is updated
+static int16_t hw_armed_thres[COUNTER_COUNT] = {0};     // Armed threshold count (0 = none)
+static SemaphoreHandle_t hw_arm_mutex = NULL;           // Loop vs. PCNT event task (hw_armed_thres)
+static uint8_t hw_quad[COUNTER_COUNT] = {0};            // FEAT-157: Unit runs as quadrature decoder
+static QuadVelocity hw_vel[COUNTER_COUNT];
+static QuadVelocityConfig hw_vel_cfg[COUNTER_COUNT];
 
 /* ============================================================================
  * PCNT UNIT MAPPING
@@ -41,100 +66,152 @@ static CounterHWState hw_state[COUNTER_COUNT] = {0};
 static const uint8_t counter_to_pcnt[COUNTER_COUNT] = {0, 1, 2, 3};
 
 /* ============================================================================
- * RTOS TASK FOR HIGH-FREQUENCY PCNT POLLING (BUG FIX P0.6)
- * Priority 10 = higher than loop() task (priority 1)
- * Polls every 10ms to prevent PCNT wrap being missed
+ * VALUE MODEL (FEAT-155)
  * ============================================================================ */
 
-static TaskHandle_t pcnt_task_handle = NULL;
+static uint64_t counter_hw_max_val(const CounterConfig* cfg) {
+  switch (cfg->bit_width) {
+    case 8: return 0xFFULL;
+    case 16: return 0xFFFFULL;
+    case 32: return 0xFFFFFFFFULL;
+    default: return 0xFFFFFFFFFFFFFFFFULL;
+  }
+}
 
-static void pcnt_poll_task(void* pvParameters) {
-  TickType_t xLastWakeTime = xTaskGetTickCount();
-  const TickType_t xFrequency = pdMS_TO_TICKS(10);  // 10ms = 100 Hz poll rate
+// Value after delta edges from base_value, wrapped like SW-ISR mode:
+// UP wraps max_val → start_value (BUG-180), DOWN wraps 0 → start_value (BUG-181)
+static uint64_t counter_hw_project(const CounterConfig* cfg, uint64_t base_value,
+                                   uint64_t delta, bool* wrapped) {
+  uint64_t max_val = counter_hw_max_val(cfg);
+  uint64_t start = cfg->start_value & max_val;
+  *wrapped = false;
+
+  if (cfg->direction == COUNTER_DIR_DOWN) {
+    if (delta <= base_value) return base_value - delta;
+    *wrapped = true;
+    uint64_t under = delta - base_value - 1;  // Edges after reaching 0
+    return start - (under % (start + 1));
+  }
 
-  for (;;) {
-    // Poll all PCNT counters
-    for (uint8_t id = 1; id <= COUNTER_COUNT; id++) {
-      CounterConfig cfg;
-      if (!counter_config_get(id, &cfg)) continue;
-      if (!cfg.enabled || cfg.hw_mode != COUNTER_HW_PCNT) continue;
-
-      CounterHWState* state = &hw_state[id - 1];
-      if (!state->is_counting) continue;
-
-      uint8_t pcnt_unit = counter_to_pcnt[id - 1];
-      uint32_t hw_count = pcnt_unit_get_count(pcnt_unit);
-
-      // BUG-024 EXTENDED FIX: Use 16-bit wrap handling (PCNT hardware is 16-bit)
-      // pcnt_driver.cpp now returns uint16_t (0-65535) properly converted from int16_t
-      // Must detect wrap at 65536, not 2^32
-      if (hw_count != state->last_count) {
-        // Calculate delta with 16-bit wrap handling
-        int64_t delta;
-        if (hw_count >= state->last_count) {
-          // Normal case: counter increased
-          delta = (int64_t)hw_count - (int64_t)state->last_count;
-        } else {
-          // Wrap case: counter wrapped around at 65536 (2^16)
-          // delta = (hw_count + 65536) - last_count = (hw_count - last_count) + 65536
-          delta = (int64_t)hw_count - (int64_t)state->last_count;
-          // delta is negative, add 65536 to get positive wrap delta
-          delta += 65536;  // 2^16 for PCNT 16-bit hardware
-        }
-
-        // Apply direction
-        if (cfg.direction == COUNTER_DIR_DOWN) {
-          delta = -delta;
-        }
-
-        // Apply delta
-        if (delta > 0) {
-          state->pcnt_value += (uint64_t)delta;
-        } else if (delta < 0) {
-          // BUG-181 FIX: DOWN counting with underflow wrapping to start_value
-          uint64_t abs_delta = (uint64_t)(-delta);
-          if (state->pcnt_value >= abs_delta) {
-            state->pcnt_value -= abs_delta;
-          } else {
-            // Underflow: wrap to start_value and continue counting
-            // Example: value=2, delta=-5, start=1000 → (2 - 5) = -3 → wrap to 1000 - 3 = 997
-            uint64_t underflow = abs_delta - state->pcnt_value;
-            state->pcnt_value = cfg.start_value - underflow;
-            state->overflow_count++;  // Set overflow flag on underflow
-          }
-        }
-
-        state->last_count = hw_count;
-
-        // DEBUG: Log PCNT activity every 5 seconds (FIX P0.7 verification)
-        static uint32_t last_log[COUNTER_COUNT] = {0};
-        uint32_t now = millis();
-        if (now - last_log[id - 1] >= 5000 && state->pcnt_value > 0) {
-          // BUG-024 EXTENDED: hw_count is 16-bit unsigned (0-65535) from PCNT hardware
-          ESP_LOGI("CNTR_HW", "C%d PCNT: hw_count=%lu delta=%lld pcnt_value=%llu edge=%d",
-                   id, hw_count, delta, state->pcnt_value, cfg.edge_type);
-          last_log[id - 1] = now;
-        }
-      }
+  if (base_value <= max_val && delta <= max_val - base_value) return base_value + delta;
+  *wrapped = true;
+  uint64_t over = delta - (max_val - base_value) - 1;  // Edges after max_val
+  uint64_t span = max_val - start + 1;                  // start..max_val (0 = full 2^64)
+  return start + (span ? over % span : over);
+}
 
-      // Check overflow
-      uint64_t max_val = 0xFFFFFFFFFFFFFFFFULL;
-      switch (cfg.bit_width) {
-        case 8: max_val = 0xFFULL; break;
-        case 16: max_val = 0xFFFFULL; break;
-        case 32: max_val = 0xFFFFFFFFULL; break;
-      }
+// FEAT-157: Signed position of a quadrature counter (no wrap handling)
+static int64_t counter_hw_quad_position(const CounterConfig* cfg, uint64_t base_value,
+                                        uint64_t delta) {
+  int64_t d = (int64_t)delta;
+  return (int64_t)base_value + (cfg->direction == COUNTER_DIR_DOWN ? -d : d);
+}
+
+static void counter_hw_rebase(uint8_t id, uint64_t value, uint64_t edges) {
+  uint8_t idx = id - 1;
+  __atomic_add_fetch(&hw_base_seq[idx], 1, __ATOMIC_ACQ_REL);
+  hw_state[idx].pcnt_value = value;
+  hw_base_edges[idx] = edges;
+  __atomic_add_fetch(&hw_base_seq[idx], 1, __ATOMIC_RELEASE);
+}
+
+static void counter_hw_read_base(uint8_t id, uint64_t* value, uint64_t* edges) {
+  uint8_t idx = id - 1;
+  uint32_t seq;
+  do {
+    seq = __atomic_load_n(&hw_base_seq[idx], __ATOMIC_ACQUIRE);
+    *value = hw_state[idx].pcnt_value;
+    *edges = hw_base_edges[idx];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) || seq != __atomic_load_n(&hw_base_seq[idx], __ATOMIC_ACQUIRE));
+}
+
+static uint64_t counter_hw_edges(uint8_t id) {
+  return (uint64_t)pcnt_unit_get_total(counter_to_pcnt[id - 1]);
+}
+
+/* ============================================================================
+ * COMPARE THRESHOLD (FEAT-155)
+ * Arm PCNT threshold 0 at the hardware count where the compare value is
+ * reached. Only within the current limit period; the limit event re-arms.
+ * Serialized by hw_arm_mutex: the loop and the PCNT event task (higher
+ * priority, same core) both arm. rearm = the armed threshold was consumed
+ * or the unit was reconfigured, program it even if the value is unchanged.
+ * ============================================================================ */
 
-      // BUG-180 FIX: Preserve overflow counts when wrapping to start_value
-      if (state->pcnt_value > max_val) {
-        uint64_t overflow_amt = state->pcnt_value - max_val - 1;
-        state->pcnt_value = (cfg.start_value + overflow_amt) & max_val;
-        state->overflow_count++;
+static void counter_hw_arm_compare_ex(uint8_t id, bool rearm) {
+  uint8_t idx = id - 1;
+  uint8_t unit = counter_to_pcnt[idx];
+  int16_t thres = 0;
+
+  if (hw_arm_mutex) xSemaphoreTake(hw_arm_mutex, portMAX_DELAY);
+  if (rearm) hw_armed_thres[idx] = 0;
+
+  // Targets are computed for an up-counting unit; quadrature counters are
+  // compared from the loop only
+  uint64_t target = 0;
+  if (!hw_quad[idx] && hw_state[idx].is_counting &&
+      counter_engine_compare_target(id, &target)) {
+    uint64_t value = counter_hw_get_value(id);
+    if (target > value) {
+      uint64_t edges_left = target - value;
+      int64_t hw_count = pcnt_unit_get_total(unit) % PCNT_UNIT_H_LIM;
+      if ((uint64_t)hw_count + edges_left < PCNT_UNIT_H_LIM) {
+        thres = (int16_t)(hw_count + edges_left);
       }
     }
+  }
+
+  if (thres != hw_armed_thres[idx] || rearm) {
+    pcnt_unit_set_threshold(unit, thres);
+    hw_armed_thres[idx] = thres;
+  }
+  if (hw_arm_mutex) xSemaphoreGive(hw_arm_mutex);
+}
+
+static void counter_hw_arm_compare(uint8_t id) {
+  counter_hw_arm_compare_ex(id, false);
+}
+
+/* ============================================================================
+ * EVENT TASK (FEAT-155)
+ * Blocks until the PCNT ISR notifies it. Notification bits:
+ *   bit n     = limit event on unit n (re-arm threshold)
+ *   bit n + 8 = threshold event on unit n (compare reached)
+ * ============================================================================ */
+
+static TaskHandle_t pcnt_task_handle = NULL;
+
+static void IRAM_ATTR counter_hw_pcnt_event(uint8_t unit, uint32_t events) {
+  if (pcnt_task_handle == NULL) return;
+  uint32_t bits = 0;
+  if (events & PCNT_UNIT_EVT_LIMIT) bits |= (1UL << unit);
+  if (events & PCNT_UNIT_EVT_THRESHOLD) bits |= (1UL << (unit + 8));
+
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(pcnt_task_handle, bits, eSetBits, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+static void pcnt_event_task(void* pvParameters) {
+  (void)pvParameters;
+  for (;;) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, 0xFFFFFFFFUL, &bits, portMAX_DELAY);
 
-    // Wait for next poll cycle
-    vTaskDelayUntil(&xLastWakeTime, xFrequency);
+    for (uint8_t id = 1; id <= COUNTER_COUNT; id++) {
+      uint8_t unit = counter_to_pcnt[id - 1];
+      bool limit = bits & (1UL << unit);
+      bool thres = bits & (1UL << (unit + 8));
+      if (!limit && !thres) continue;
+
+      if (thres) {
+        // Threshold reached: run compare now instead of on the next loop pass
+        counter_engine_compare_event(id);
+      }
+      // Hardware count restarted at 0 (limit) or threshold consumed: re-arm
+      counter_hw_arm_compare_ex(id, true);
+    }
   }
 }
 
@@ -142,6 +219,12 @@ static void pcnt_poll_task(void* pvParameters) {
  * INITIALIZATION
  * ============================================================================ */
 
+void counter_hw_module_init(void) {
+  if (hw_arm_mutex == NULL) {
+    hw_arm_mutex = xSemaphoreCreateMutex();
+  }
+}
+
 void counter_hw_init(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return;
 
@@ -150,6 +233,9 @@ void counter_hw_init(uint8_t id) {
   state->last_count = 0;
   state->overflow_count = 0;
   state->is_counting = 0;
+  hw_base_edges[id - 1] = 0;
+  hw_quad[id - 1] = 0;
+  quad_velocity_reset(&hw_vel[id - 1]);
 
   // Initialize PCNT unit (zero counter)
   uint8_t pcnt_unit = counter_to_pcnt[id - 1];
@@ -161,18 +247,19 @@ void counter_hw_init(uint8_t id) {
     state->pcnt_value = cfg.start_value;
   }
 
-  // BUG FIX P0.6: Start RTOS task on first init (only once)
-  if (id == 1 && pcnt_task_handle == NULL) {
+  // FEAT-155: Event task replaces the 10 ms poll task (created once)
+  if (pcnt_task_handle == NULL) {
     xTaskCreatePinnedToCore(
-      pcnt_poll_task,       // Task function
-      "pcnt_poll",          // Task name
+      pcnt_event_task,      // Task function
+      "pcnt_evt",           // Task name
       4096,                 // Stack size (bytes)
       NULL,                 // Parameters
       10,                   // Priority (higher than loop = 1)
       &pcnt_task_handle,    // Task handle
       1                     // Core 1 (same as loop)
     );
-    ESP_LOGI("CNTR_HW", "RTOS task created for PCNT polling (100Hz, priority 10)");
+    pcnt_unit_set_event_callback(counter_hw_pcnt_event);
+    ESP_LOGI("CNTR_HW", "RTOS task created for PCNT events (priority 10)");
   }
 }
 
@@ -206,17 +293,34 @@ bool counter_hw_configure(uint8_t id, uint8_t gpio_pin) {
     neg_edge = PCNT_EDGE_FALLING;
   }
 
-  // Direction support: PCNT hardware counts incrementally (can be positive/negative)
-  // We apply direction in delta calculation (lines 82-84 in pcnt_poll_task)
-  // DOWN direction: delta is inverted to decrement counter value
+  // Direction support: PCNT hardware counts up only; direction is applied
+  // in counter_hw_project() (DOWN subtracts edges from base value)
+
+  // FEAT-157: Quadrature decoding replaces edge_type; direction inverts
+  CounterQuadConfig quad;
+  hw_quad[id - 1] = 0;
+  if (counter_config_is_quad(id) && counter_config_get_quad(id, &quad)) {
+    if (pcnt_unit_configure_quadrature(pcnt_unit, gpio_pin, quad.gpio_b, quad.mode,
+                                       quad.glitch_ns)) {
+      hw_quad[id - 1] = 1;
+      hw_vel_cfg[id - 1].sample_us = (uint32_t)quad.velocity_sample_ms * 1000UL;
+      hw_vel_cfg[id - 1].tau_us = (uint32_t)quad.velocity_filter_ms * 1000UL;
+      quad_velocity_reset(&hw_vel[id - 1]);
+    } else {
+      ESP_LOGW("CNTR_HW", "C%d: quadrature x%d rejected, using single input", id, quad.mode);
+    }
+  }
 
-  // Configure PCNT unit
-  pcnt_unit_configure(pcnt_unit, gpio_pin, pos_edge, neg_edge);
+  // Configure PCNT unit (clears hardware count and 64-bit extension)
+  if (!hw_quad[id - 1]) {
+    pcnt_unit_configure(pcnt_unit, gpio_pin, pos_edge, neg_edge);
+  }
 
-  // Set start value in pcnt_value
-  state->pcnt_value = cfg.start_value;
+  // Set start value as base at edge 0
+  counter_hw_rebase(id, cfg.start_value, 0);
   state->last_count = 0;
   state->is_counting = 1;
+  counter_hw_arm_compare_ex(id, true);  // Unit was cleared: old threshold is gone
 
   // DEBUG: Verify edge configuration with readable enum string
   ESP_LOGI("CNTR_HW", "C%d configured: PCNT_U%d GPIO%d edge=%s dir=%d start=%llu",
@@ -235,10 +339,35 @@ bool counter_hw_configure(uint8_t id, uint8_t gpio_pin) {
  * ============================================================================ */
 
 void counter_hw_loop(uint8_t id) {
-  // BUG FIX P0.6: PCNT polling now handled by dedicated RTOS task
-  // This function kept for compatibility but does nothing
-  // All PCNT reading/delta calculation happens in pcnt_poll_task() at 100Hz
-  (void)id;  // Suppress unused warning
+  if (id < 1 || id > COUNTER_COUNT) return;
+
+  CounterConfig cfg;
+  if (!counter_config_get(id, &cfg)) return;
+
+  // FEAT-155: Counting is done by hardware + limit ISR. Here only fold a
+  // wrap into the base (sets overflow flag) and keep the threshold in step
+  // with runtime changes of the compare register.
+  uint64_t base_value, base_edges;
+  counter_hw_read_base(id, &base_value, &base_edges);
+  uint64_t edges = counter_hw_edges(id);
+
+  // FEAT-157: Quadrature position is signed and not folded. A limit event
+  // in either direction is taken from the PCNT status, so the loop rate
+  // does not bound the speed of the encoder.
+  if (hw_quad[id - 1]) {
+    int64_t pos = counter_hw_quad_position(&cfg, base_value, edges - base_edges);
+    quad_velocity_update(&hw_vel[id - 1], &hw_vel_cfg[id - 1], pos, micros());
+    return;
+  }
+
+  bool wrapped = false;
+  uint64_t value = counter_hw_project(&cfg, base_value, edges - base_edges, &wrapped);
+  if (wrapped) {
+    counter_hw_rebase(id, value, edges);
+    hw_state[id - 1].overflow_count++;
+  }
+
+  counter_hw_arm_compare(id);
 }
 
 /* ============================================================================
@@ -252,28 +381,15 @@ void counter_hw_reset(uint8_t id) {
   if (!counter_config_get(id, &cfg)) return;
 
   CounterHWState* state = &hw_state[id - 1];
-  uint8_t pcnt_unit = counter_to_pcnt[id - 1];
-
-  // FIX P1.1: Disable is_counting flag to prevent polling task from accumulating delta
-  // During reset window, polling task will skip this counter (line 63 checks is_counting)
-  state->is_counting = 0;
-
-  // Step 1: Pause PCNT counting (hardware gate)
-  pcnt_counter_pause((pcnt_unit_t)pcnt_unit);
 
-  // Step 2: Clear PCNT hardware counter
-  pcnt_counter_clear((pcnt_unit_t)pcnt_unit);
-
-  // Step 3: Reset software state
-  state->pcnt_value = cfg.start_value;
+  // FEAT-155: No hardware clear needed - rebase at the current edge count,
+  // so edges arriving during the reset are not lost
+  counter_hw_rebase(id, cfg.start_value, counter_hw_edges(id));
   state->overflow_count = 0;
-  state->last_count = 0;  // Sync with hardware (both now 0)
-
-  // Step 4: Resume PCNT hardware counting
-  pcnt_counter_resume((pcnt_unit_t)pcnt_unit);
-
-  // Step 5: Re-enable counting for polling task
+  state->last_count = 0;
   state->is_counting = 1;
+  quad_velocity_reset(&hw_vel[id - 1]);
+  counter_hw_arm_compare(id);
 }
 
 
@@ -284,20 +400,48 @@ void counter_hw_reset(uint8_t id) {
 uint64_t counter_hw_get_value(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return 0;
 
-  CounterHWState* state = &hw_state[id - 1];
-  return state->pcnt_value;
+  CounterConfig cfg;
+  if (!counter_config_get(id, &cfg)) return hw_state[id - 1].pcnt_value;
+
+  // FEAT-155: Exact value at call time, lock-free (seqlock base + ISR-extended count)
+  uint64_t base_value, base_edges;
+  counter_hw_read_base(id, &base_value, &base_edges);
+  if (hw_quad[id - 1]) {
+    int64_t pos = counter_hw_quad_position(&cfg, base_value, counter_hw_edges(id) - base_edges);
+    return (uint64_t)pos & counter_hw_max_val(&cfg);
+  }
+  bool wrapped;
+  return counter_hw_project(&cfg, base_value, counter_hw_edges(id) - base_edges, &wrapped);
+}
+
+int64_t counter_hw_get_position(uint8_t id) {
+  if (id < 1 || id > COUNTER_COUNT) return 0;
+  if (!hw_quad[id - 1]) return (int64_t)counter_hw_get_value(id);
+
+  CounterConfig cfg;
+  if (!counter_config_get(id, &cfg)) return 0;
+  uint64_t base_value, base_edges;
+  counter_hw_read_base(id, &base_value, &base_edges);
+  return counter_hw_quad_position(&cfg, base_value, counter_hw_edges(id) - base_edges);
+}
+
+int32_t counter_hw_get_velocity(uint8_t id) {
+  if (id < 1 || id > COUNTER_COUNT || !hw_quad[id - 1]) return 0;
+  return quad_velocity_get(&hw_vel[id - 1]);
+}
+
+bool counter_hw_is_quadrature(uint8_t id) {
+  if (id < 1 || id > COUNTER_COUNT) return false;
+  return hw_quad[id - 1] != 0;
 }
 
 void counter_hw_set_value(uint8_t id, uint64_t value) {
   if (id < 1 || id > COUNTER_COUNT) return;
 
-  CounterHWState* state = &hw_state[id - 1];
-  state->pcnt_value = value;
-
-  // Also clear PCNT so next loop will read from 0
-  uint8_t pcnt_unit = counter_to_pcnt[id - 1];
-  pcnt_unit_clear(pcnt_unit);
-  state->last_count = 0;
+  counter_hw_rebase(id, value, counter_hw_edges(id));
+  hw_state[id - 1].last_count = 0;
+  quad_velocity_reset(&hw_vel[id - 1]);
+  counter_hw_arm_compare(id);
 }
 
 uint8_t counter_hw_get_overflow(uint8_t id) {
@@ -324,6 +468,7 @@ void counter_hw_start(uint8_t id) {
   // Resume PCNT hardware counter
   uint8_t pcnt_unit = counter_to_pcnt[id - 1];
   pcnt_counter_resume((pcnt_unit_t)pcnt_unit);
+  counter_hw_arm_compare(id);
 }
 
 void counter_hw_stop(uint8_t id) {
@@ -335,4 +480,5 @@ void counter_hw_stop(uint8_t id) {
   // Stop PCNT hardware counter
   uint8_t pcnt_unit = counter_to_pcnt[id - 1];
   pcnt_counter_pause((pcnt_unit_t)pcnt_unit);
+  counter_hw_arm_compare(id);  // Disarms (not counting)
 }
@@ -9,15 +9,19 @@
  * - GPIO interrupt attachment and handling
  * - ISR-based edge counting (INT0-INT5)
  * - Debounce in main loop
+ * - Optional edge timestamp ring (FEAT-156)
  */
 
 #include "counter_sw_isr.h"
+#include "edge_ring.h"
 #include "counter_config.h"
 #include "gpio_driver.h"
+#include "gpio_mapping.h"
 #include "registers.h"
 #include "constants.h"
 #include "types.h"
 #include <Arduino.h>
+#include <esp_heap_caps.h>
 #include <string.h>
 
 /* ============================================================================
@@ -28,109 +32,61 @@
  * optimizations that cache values in registers. Without volatile, the compiler
  * may not reload values from memory, causing race conditions between ISR and
  * main loop contexts.
+ *
+ * FEAT-156: Everything the ISR touches for one counter lives in one context
+ * entry, passed to the shared handler as its argument (attachInterruptArg).
  * ============================================================================ */
 
-static volatile CounterSWState isr_state[COUNTER_COUNT] = {0};  // BUG FIX 3.1: volatile for ISR access
+typedef struct {
+  volatile CounterSWState state;        // BUG FIX 3.1: volatile for ISR access
+  volatile uint32_t last_interrupt_us;  // Debounce reference
+  volatile uint64_t start_val;          // BUG-181 FIX: start_value for underflow wrapping
+  volatile uint8_t direction;           // BUG FIX 1.5: CounterDirection
+  // FEAT-154: Accepted edges and timestamp of the latest one (reciprocal frequency).
+  // edge_seq is odd while the ISR updates the pair (see counter_sw_isr_get_edge_sample)
+  volatile uint32_t edge_seq;
+  volatile uint32_t edge_count;
+  volatile uint32_t edge_us;
+  // FEAT-156: Optional edge timestamp ring (buf == NULL until first enabled)
+  EdgeRing ring;
+} CounterIsrCtx;
+
+static CounterIsrCtx isr_ctx[COUNTER_COUNT];
 static uint8_t isr_gpio_pins[COUNTER_COUNT] = {0};
-static volatile unsigned long last_interrupt_time[COUNTER_COUNT] = {0};
-static const unsigned long DEBOUNCE_MICROS = 50;  // 50 microseconds debounce
-static volatile uint8_t isr_direction[COUNTER_COUNT] = {COUNTER_DIR_UP, COUNTER_DIR_UP, COUNTER_DIR_UP, COUNTER_DIR_UP};  // BUG FIX 1.5 + 3.1
-static volatile uint64_t isr_max_val[COUNTER_COUNT] = {0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL};  // BUG-036 FIX: max value for overflow wrapping
-static volatile uint64_t isr_start_val[COUNTER_COUNT] = {0, 0, 0, 0};  // BUG-181 FIX: start_value for underflow wrapping
+static const uint32_t DEBOUNCE_MICROS = 50;  // 50 microseconds debounce
 
 /* ============================================================================
- * ISR HANDLERS (IRAM_ATTR for fast interrupt handling with debounce)
+ * ISR HANDLER (IRAM_ATTR, shared by all counters)
  * ============================================================================ */
 
-void IRAM_ATTR counter_isr_0() {
-  // BUG FIX 2.1: Check if counting is enabled
-  if (!isr_state[0].is_counting) return;
-
-  unsigned long interrupt_time = micros();
-  if (interrupt_time - last_interrupt_time[0] > DEBOUNCE_MICROS) {
-    // BUG FIX 1.5 + BUG-181: Implement direction with proper underflow wrapping
-    if (isr_direction[0] == COUNTER_DIR_UP) {
-      isr_state[0].counter_value++;
-    } else {
-      // BUG-181 FIX: DOWN counting wraps to start_value (stored in ISR at attach time)
-      if (isr_state[0].counter_value > 0) {
-        isr_state[0].counter_value--;
-      } else {
-        // Underflow: wrap to isr_start_val (not max_val!)
-        isr_state[0].counter_value = isr_start_val[0];
-        isr_state[0].overflow_flag = 1;  // Set overflow flag on underflow wrap
-      }
-    }
-    last_interrupt_time[0] = interrupt_time;
-  }
-}
+static void IRAM_ATTR counter_isr(void* arg) {
+  CounterIsrCtx* c = (CounterIsrCtx*)arg;
 
-void IRAM_ATTR counter_isr_1() {
   // BUG FIX 2.1: Check if counting is enabled
-  if (!isr_state[1].is_counting) return;
-
-  unsigned long interrupt_time = micros();
-  if (interrupt_time - last_interrupt_time[1] > DEBOUNCE_MICROS) {
-    // BUG FIX 1.5 + BUG-181: Implement direction with proper underflow wrapping
-    if (isr_direction[1] == COUNTER_DIR_UP) {
-      isr_state[1].counter_value++;
-    } else {
-      // BUG-181 FIX: DOWN counting wraps to start_value (not max_val!)
-      if (isr_state[1].counter_value > 0) {
-        isr_state[1].counter_value--;
-      } else {
-        // Underflow: wrap to isr_start_val (consistent with UP mode)
-        isr_state[1].counter_value = isr_start_val[1];
-        isr_state[1].overflow_flag = 1;  // Set overflow flag on underflow wrap
-      }
-    }
-    last_interrupt_time[1] = interrupt_time;
-  }
-}
+  if (!c->state.is_counting) return;
 
-void IRAM_ATTR counter_isr_2() {
-  // BUG FIX 2.1: Check if counting is enabled
-  if (!isr_state[2].is_counting) return;
-
-  unsigned long interrupt_time = micros();
-  if (interrupt_time - last_interrupt_time[2] > DEBOUNCE_MICROS) {
-    // BUG FIX 1.5 + BUG-181: Implement direction with proper underflow wrapping
-    if (isr_direction[2] == COUNTER_DIR_UP) {
-      isr_state[2].counter_value++;
-    } else {
-      // BUG-181 FIX: DOWN counting wraps to start_value (not max_val!)
-      if (isr_state[2].counter_value > 0) {
-        isr_state[2].counter_value--;
-      } else {
-        // Underflow: wrap to isr_start_val (consistent with UP mode)
-        isr_state[2].counter_value = isr_start_val[2];
-        isr_state[2].overflow_flag = 1;  // Set overflow flag on underflow wrap
-      }
-    }
-    last_interrupt_time[2] = interrupt_time;
+  uint32_t now = (uint32_t)micros();
+  if (now - c->last_interrupt_us <= DEBOUNCE_MICROS) return;
+  c->last_interrupt_us = now;
+
+  // BUG FIX 1.5 + BUG-181: Implement direction with proper underflow wrapping
+  if (c->direction == COUNTER_DIR_UP) {
+    c->state.counter_value++;
+  } else if (c->state.counter_value > 0) {
+    c->state.counter_value--;
+  } else {
+    // BUG-181 FIX: DOWN counting wraps to start_value (not max_val!)
+    c->state.counter_value = c->start_val;
+    c->state.overflow_flag = 1;  // Set overflow flag on underflow wrap
   }
-}
 
-void IRAM_ATTR counter_isr_3() {
-  // BUG FIX 2.1: Check if counting is enabled
-  if (!isr_state[3].is_counting) return;
-
-  unsigned long interrupt_time = micros();
-  if (interrupt_time - last_interrupt_time[3] > DEBOUNCE_MICROS) {
-    // BUG FIX 1.5 + BUG-181: Implement direction with proper underflow wrapping
-    if (isr_direction[3] == COUNTER_DIR_UP) {
-      isr_state[3].counter_value++;
-    } else {
-      // BUG-181 FIX: DOWN counting wraps to start_value (not max_val!)
-      if (isr_state[3].counter_value > 0) {
-        isr_state[3].counter_value--;
-      } else {
-        // Underflow: wrap to isr_start_val (consistent with UP mode)
-        isr_state[3].counter_value = isr_start_val[3];
-        isr_state[3].overflow_flag = 1;  // Set overflow flag on underflow wrap
-      }
-    }
-    last_interrupt_time[3] = interrupt_time;
+  c->edge_seq++;
+  c->edge_us = now;
+  c->edge_count++;
+  c->edge_seq++;
+
+  if (c->ring.buf != NULL) {
+    edge_ring_push(&c->ring, now);
   }
 }
 
@@ -141,7 +97,7 @@ void IRAM_ATTR counter_isr_3() {
 void counter_sw_isr_init(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return;
 
-  volatile CounterSWState* state = &isr_state[id - 1];  // BUG FIX 3.1: volatile pointer
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;  // BUG FIX 3.1: volatile pointer
   state->counter_value = 0;
   state->last_level = 0;
   state->debounce_timer = 0;
@@ -170,7 +126,7 @@ void counter_sw_isr_loop(uint8_t id) {
     return;
   }
 
-  volatile CounterSWState* state = &isr_state[id - 1];  // BUG FIX 3.1: volatile pointer
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;  // BUG FIX 3.1: volatile pointer
 
   // Check for overflow/underflow based on bit width
   uint64_t max_val = 0xFFFFFFFFFFFFFFFFULL;
@@ -214,27 +170,14 @@ void counter_sw_isr_attach(uint8_t id, uint8_t gpio_pin) {
   // Configure GPIO as input
   pinMode(gpio_pin, INPUT);
 
-  // BUG FIX 1.5: Store direction for ISR use
-  isr_direction[id - 1] = cfg.direction;
+  CounterIsrCtx* c = &isr_ctx[id - 1];
 
-  // BUG-036 FIX: Store max_val for ISR overflow wrapping
-  switch (cfg.bit_width) {
-    case 8:
-      isr_max_val[id - 1] = 0xFFULL;
-      break;
-    case 16:
-      isr_max_val[id - 1] = 0xFFFFULL;
-      break;
-    case 32:
-      isr_max_val[id - 1] = 0xFFFFFFFFULL;
-      break;
-    default:
-      isr_max_val[id - 1] = 0xFFFFFFFFFFFFFFFFULL;  // 64-bit
-      break;
-  }
+  // BUG FIX 1.5: Store direction for ISR use
+  c->direction = cfg.direction;
 
   // BUG-181 FIX: Store start_value for ISR underflow wrapping in DOWN mode
-  isr_start_val[id - 1] = cfg.start_value;
+  // (UP overflow at bit_width is folded in counter_sw_isr_loop)
+  c->start_val = cfg.start_value;
 
   // Map edge type to Arduino interrupt mode
   int mode = RISING;  // Default
@@ -246,20 +189,11 @@ void counter_sw_isr_attach(uint8_t id, uint8_t gpio_pin) {
     mode = RISING;
   }
 
-  // Attach the correct ISR based on counter ID
-  void (*isr_handler)() = NULL;
-  switch (id) {
-    case 1: isr_handler = counter_isr_0; break;
-    case 2: isr_handler = counter_isr_1; break;
-    case 3: isr_handler = counter_isr_2; break;
-    case 4: isr_handler = counter_isr_3; break;
-  }
-
-  if (isr_handler != NULL) {
-    attachInterrupt(digitalPinToInterrupt(gpio_pin), isr_handler, mode);
-    isr_gpio_pins[id - 1] = gpio_pin;
-    isr_state[id - 1].is_counting = 1;
-  }
+  // FEAT-156: One handler for all counters, context selects the counter
+  attachInterruptArg(digitalPinToInterrupt(gpio_pin), counter_isr, c, mode);
+  isr_gpio_pins[id - 1] = gpio_pin;
+  c->state.is_counting = 1;
+  gpio_mapping_invalidate();  // FEAT-163: pin is no longer free for input interrupts
 }
 
 void counter_sw_isr_detach(uint8_t id) {
@@ -268,9 +202,18 @@ void counter_sw_isr_detach(uint8_t id) {
   if (isr_gpio_pins[id - 1] > 0) {
     detachInterrupt(digitalPinToInterrupt(isr_gpio_pins[id - 1]));
     isr_gpio_pins[id - 1] = 0;
+    gpio_mapping_invalidate();
   }
 
-  isr_state[id - 1].is_counting = 0;
+  isr_ctx[id - 1].state.is_counting = 0;
+}
+
+uint64_t counter_sw_isr_attached_pins(void) {
+  uint64_t pins = 0;
+  for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+    if (isr_gpio_pins[i] > 0 && isr_gpio_pins[i] < 64) pins |= 1ULL << isr_gpio_pins[i];
+  }
+  return pins;
 }
 
 /* ============================================================================
@@ -283,7 +226,7 @@ void counter_sw_isr_reset(uint8_t id) {
   CounterConfig cfg;
   if (!counter_config_get(id, &cfg)) return;
 
-  volatile CounterSWState* state = &isr_state[id - 1];  // BUG FIX 3.1: volatile pointer
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;  // BUG FIX 3.1: volatile pointer
   state->counter_value = cfg.start_value;
   state->debounce_timer = 0;
 }
@@ -296,28 +239,85 @@ uint64_t counter_sw_isr_get_value(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return 0;
   // BUG-034 FIX: Use volatile pointer to ensure fresh read from memory
   // Without this, compiler may cache value in register and miss ISR updates
-  volatile CounterSWState* state = &isr_state[id - 1];
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;
   return state->counter_value;
 }
 
 void counter_sw_isr_set_value(uint8_t id, uint64_t value) {
   if (id < 1 || id > COUNTER_COUNT) return;
   // BUG-034 FIX: Use volatile pointer for consistent access
-  volatile CounterSWState* state = &isr_state[id - 1];
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;
   state->counter_value = value;
 }
 
+bool counter_sw_isr_get_edge_sample(uint8_t id, uint32_t* edge_count, uint32_t* edge_us) {
+  if (id < 1 || id > COUNTER_COUNT || edge_count == NULL || edge_us == NULL) return false;
+  if (isr_gpio_pins[id - 1] == 0) return false;
+
+  const CounterIsrCtx* c = &isr_ctx[id - 1];
+
+  // ISR may run on the other core: retry while an update is in progress or
+  // one completed during the read, so the pair always belongs to the same edge
+  uint32_t seq, count, stamp;
+  do {
+    seq = c->edge_seq;
+    stamp = c->edge_us;
+    count = c->edge_count;
+  } while ((seq & 1) || seq != c->edge_seq);
+
+  *edge_count = count;
+  *edge_us = stamp;
+  return true;
+}
+
+/* ============================================================================
+ * EDGE TIMESTAMP RING (FEAT-156)
+ * Off by default; storage is allocated on first enable and kept for the
+ * lifetime of the firmware, so the ISR never sees a buffer being freed.
+ * ============================================================================ */
+
+bool counter_sw_isr_edges_enable(uint8_t id) {
+  if (id < 1 || id > COUNTER_COUNT) return false;
+  EdgeRing* ring = &isr_ctx[id - 1].ring;
+  if (ring->buf != NULL) return true;
+
+  // Internal RAM: the ISR is IRAM and may run while the flash/PSRAM cache is off
+  uint32_t* buf = (uint32_t*)heap_caps_malloc(COUNTER_EDGE_RING_SIZE * sizeof(uint32_t),
+                                              MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (buf == NULL) return false;
+  return edge_ring_init(ring, buf, COUNTER_EDGE_RING_SIZE);
+}
+
+bool counter_sw_isr_edges_enabled(uint8_t id) {
+  if (id < 1 || id > COUNTER_COUNT) return false;
+  return isr_ctx[id - 1].ring.buf != NULL;
+}
+
+bool counter_sw_isr_edges_window(uint8_t id, uint32_t* tail, uint32_t* head) {
+  if (!counter_sw_isr_edges_enabled(id)) return false;
+  const EdgeRing* ring = &isr_ctx[id - 1].ring;
+  if (head) *head = edge_ring_head(ring);
+  if (tail) *tail = edge_ring_tail(ring);
+  return true;
+}
+
+uint32_t counter_sw_isr_edges_read(uint8_t id, uint32_t* cursor, uint32_t* out,
+                                   uint32_t max, uint32_t* lost) {
+  if (!counter_sw_isr_edges_enabled(id) || cursor == NULL || out == NULL) return 0;
+  return edge_ring_read(&isr_ctx[id - 1].ring, cursor, out, max, lost);
+}
+
 uint8_t counter_sw_isr_get_overflow(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return 0;
   // BUG-034 FIX: Use volatile pointer for consistent access
-  volatile CounterSWState* state = &isr_state[id - 1];
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;
   return state->overflow_flag;
 }
 
 void counter_sw_isr_clear_overflow(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return;
   // BUG-034 FIX: Use volatile pointer for consistent access
-  volatile CounterSWState* state = &isr_state[id - 1];
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;
   state->overflow_flag = 0;
 }
 
@@ -328,13 +328,13 @@ void counter_sw_isr_clear_overflow(uint8_t id) {
 void counter_sw_isr_start(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return;
   // BUG-034 FIX: Use volatile pointer for consistent access
-  volatile CounterSWState* state = &isr_state[id - 1];
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;
   state->is_counting = 1;
 }
 
 void counter_sw_isr_stop(uint8_t id) {
   if (id < 1 || id > COUNTER_COUNT) return;
   // BUG-034 FIX: Use volatile pointer for consistent access
-  volatile CounterSWState* state = &isr_state[id - 1];
+  volatile CounterSWState* state = &isr_ctx[id - 1].state;
   state->is_counting = 0;
 }
@@ -0,0 +1,66 @@
+/**
+ * @file di_event.cpp
+ * @brief Lock-free digital input event ring (v7.9.9.4)
+ *
+ * LAYER 4: Register/Coil Storage - Interrupt-driven inputs (pure data structure)
+ * Event numbers are free-running uint32; all comparisons are done on
+ * differences, so head wrap at 2^32 is harmless.
+ */
+
+#include "di_event.h"
+
+bool di_event_ring_init(DiEventRing *r, DiEvent *buf, uint32_t size)
+{
+  if (!buf || size < 2 || (size & (size - 1)) != 0) return false;
+  r->mask = size - 1;
+  __atomic_store_n(&r->head, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&r->buf, buf, __ATOMIC_RELEASE);
+  return true;
+}
+
+uint32_t di_event_read(const DiEventRing *r, uint32_t *cursor,
+                       DiEvent *out, uint32_t max, uint32_t *lost)
+{
+  if (!r->buf) return 0;
+
+  uint32_t size = r->mask + 1;
+  uint32_t cur = *cursor;
+  uint32_t h = di_event_head(r);
+
+  // Cursor ahead of head (stale cursor from before a re-init): restart at head
+  if ((int32_t)(h - cur) < 0) {
+    *cursor = h;
+    return 0;
+  }
+
+  // Fell a ring behind: skip to the oldest slot still valid. The slot of
+  // event h - size is the one the next push rewrites, so it never counts.
+  if (h - cur >= size) {
+    if (lost) *lost += h - size + 1 - cur;
+    cur = h - size + 1;
+  }
+
+  uint32_t n = h - cur;
+  if (n > max) n = max;
+  for (uint32_t i = 0; i < n; i++) {
+    out[i] = r->buf[(cur + i) & r->mask];
+  }
+
+  // Events pushed during the copy may have overwritten the first slots read.
+  // A slot is several words, so the one a push may be rewriting right now
+  // (event h2 - size) is dropped too: event e is valid while h2 - e < size.
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);   // Slot copies before the re-read
+  uint32_t h2 = di_event_head(r);
+  uint32_t torn = 0;
+  if (h2 - cur >= size) {
+    torn = h2 - size - cur + 1;
+    if (torn > n) torn = n;
+    for (uint32_t i = torn; i < n; i++) {
+      out[i - torn] = out[i];
+    }
+    if (lost) *lost += torn;
+  }
+
+  *cursor = cur + n;
+  return n - torn;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file di_irq.cpp
+ * @brief Interrupt-driven digital inputs (v7.9.9.4)
+ *
+ * LAYER 4: Register/Coil Storage - GPIO input change detection
+ *
+ * One IRAM handler for all pins, attached with attachInterruptArg and given
+ * the pin's context (same pattern as counter_sw_isr). All GPIO interrupts
+ * are dispatched by the single GPIO ISR service, so the handler is the only
+ * producer of the event ring.
+ */
+
+#include "di_irq.h"
+#include "counter_sw_isr.h"
+#include "registers.h"
+#include <Arduino.h>
+#include <soc/gpio_struct.h>
+#include <string.h>
+
+/* ============================================================================
+ * ISR STATE (per pin)
+ * ============================================================================ */
+
+typedef struct {
+  uint8_t di_byte;                      // Discrete input byte
+  uint8_t di_mask;                      // Bits in that byte fed by the pin
+} DiIrqTarget;
+
+typedef struct {
+  uint8_t pin;
+  volatile uint8_t target_count;
+  DiIrqTarget targets[DI_IRQ_DI_PER_PIN];
+  volatile uint32_t edges;              // ISR runs since boot
+  volatile uint32_t rise_us;            // Last rising edge
+  volatile uint8_t rise_valid;          // rise_us belongs to the current high phase
+  // Latest high pulse; pulse_seq is odd while the ISR updates the pair
+  volatile uint32_t pulse_seq;
+  volatile uint32_t pulse_count;
+  volatile uint32_t pulse_us;
+} DiIrqPin;
+
+static DiIrqPin irq_pins[DI_IRQ_PIN_COUNT];
+static uint32_t irq_caught[2];          // Latch bits, GPIO 0-31 and 32-39
+static uint64_t irq_attached = 0;       // Pins with our handler attached
+
+static DiEvent irq_event_buf[DI_IRQ_EVENT_RING];
+static DiEventRing irq_events;
+
+static_assert((DI_IRQ_EVENT_RING & (DI_IRQ_EVENT_RING - 1)) == 0, "event ring must be a power of two");
+
+static inline uint8_t di_irq_level(uint8_t pin) {
+  return (pin < 32) ? (uint8_t)((GPIO.in >> pin) & 1) : (uint8_t)((GPIO.in1.val >> (pin - 32)) & 1);
+}
+
+/* ============================================================================
+ * ISR HANDLER (IRAM_ATTR, shared by all pins)
+ * ============================================================================ */
+
+static void IRAM_ATTR di_irq_isr(void* arg) {
+  DiIrqPin* p = (DiIrqPin*)arg;
+  uint32_t now = (uint32_t)micros();
+  uint8_t pin = p->pin;
+  uint8_t level = di_irq_level(pin);
+
+  uint8_t n = p->target_count;
+  for (uint8_t i = 0; i < n; i++) {
+    const DiIrqTarget* t = &p->targets[i];
+    registers_set_discrete_input_isr(t->di_byte, t->di_mask, level ? t->di_mask : 0);
+  }
+
+  // Latched even if the level read back has already returned (pulse shorter
+  // than the interrupt latency)
+  __atomic_fetch_or(&irq_caught[pin >> 5], 1u << (pin & 31), __ATOMIC_RELAXED);
+  p->edges++;
+
+  if (level) {
+    p->rise_us = now;
+    p->rise_valid = 1;
+  } else if (p->rise_valid) {
+    p->rise_valid = 0;
+    p->pulse_seq++;
+    p->pulse_us = now - p->rise_us;
+    p->pulse_count++;
+    p->pulse_seq++;
+  }
+
+  di_event_push(&irq_events, now, pin, level);
+}
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+uint64_t di_irq_usable_pins(uint64_t requested) {
+  return requested & GPIO_PLAN_PORT_MASK & ~counter_sw_isr_attached_pins();
+}
+
+// Store the current level in the pin's discrete inputs
+static void di_irq_sync(const DiIrqPin* p) {
+  uint8_t level = di_irq_level(p->pin);
+  for (uint8_t i = 0; i < p->target_count; i++) {
+    const DiIrqTarget* t = &p->targets[i];
+    registers_set_discrete_input_bits(t->di_byte, t->di_mask, level ? t->di_mask : 0);
+  }
+}
+
+void di_irq_apply(const gpio_plan_t *plan) {
+  if (irq_events.buf == NULL) {
+    di_event_ring_init(&irq_events, irq_event_buf, DI_IRQ_EVENT_RING);
+  }
+
+  // Group the plan's interrupt inputs per pin (and per byte within a pin)
+  DiIrqTarget targets[DI_IRQ_PIN_COUNT][DI_IRQ_DI_PER_PIN];
+  uint8_t counts[DI_IRQ_PIN_COUNT];
+  memset(counts, 0, sizeof(counts));
+  for (uint8_t i = 0; i < plan->irq_input_count; i++) {
+    const gpio_plan_irq_t* q = &plan->irq_inputs[i];
+    if (q->pin >= DI_IRQ_PIN_COUNT) continue;
+    uint8_t k = 0;
+    while (k < counts[q->pin] && targets[q->pin][k].di_byte != q->byte) k++;
+    if (k == counts[q->pin]) {
+      if (k >= DI_IRQ_DI_PER_PIN) continue;
+      targets[q->pin][k].di_byte = q->byte;
+      targets[q->pin][k].di_mask = 0;
+      counts[q->pin]++;
+    }
+    targets[q->pin][k].di_mask |= q->mask;
+  }
+
+  // Pins taken over by a counter keep the counter's handler
+  uint64_t ours = di_irq_usable_pins(~0ULL);
+
+  for (uint8_t pin = 0; pin < DI_IRQ_PIN_COUNT; pin++) {
+    uint64_t bit = 1ULL << pin;
+    DiIrqPin* p = &irq_pins[pin];
+    bool was = (irq_attached & bit) != 0;
+    bool want = counts[pin] > 0 && (plan->irq_mask & bit);
+
+    if (was && !want) {
+      if (ours & bit) detachInterrupt(digitalPinToInterrupt(pin));
+      p->target_count = 0;
+      irq_attached &= ~bit;
+      continue;
+    }
+    if (!want) continue;
+
+    // Attached pins are updated in place: the ISR reads target_count first,
+    // so it never sees a target that is not filled in yet
+    p->target_count = 0;
+    memcpy(p->targets, targets[pin], sizeof(p->targets));
+    p->pin = pin;
+    p->target_count = counts[pin];
+
+    if (!was) {
+      uint32_t edges = p->edges;
+      di_irq_sync(p);
+      p->rise_valid = 0;
+      attachInterruptArg(digitalPinToInterrupt(pin), di_irq_isr, p, CHANGE);
+      // An edge between the sync and the attach would otherwise be missed
+      if (p->edges == edges) di_irq_sync(p);
+      irq_attached |= bit;
+    }
+  }
+}
+
+/* ============================================================================
+ * ACCESS
+ * ============================================================================ */
+
+uint64_t di_irq_active_pins(void) {
+  return irq_attached;
+}
+
+uint32_t di_irq_edge_count(uint8_t pin) {
+  if (pin >= DI_IRQ_PIN_COUNT) return 0;
+  return irq_pins[pin].edges;
+}
+
+bool di_irq_caught(uint8_t pin, bool clear) {
+  if (pin >= DI_IRQ_PIN_COUNT) return false;
+  uint32_t bit = 1u << (pin & 31);
+  uint32_t word = clear ? __atomic_fetch_and(&irq_caught[pin >> 5], ~bit, __ATOMIC_RELAXED)
+                        : __atomic_load_n(&irq_caught[pin >> 5], __ATOMIC_RELAXED);
+  return (word & bit) != 0;
+}
+
+bool di_irq_get_pulse(uint8_t pin, uint32_t *count, uint32_t *width_us) {
+  if (pin >= DI_IRQ_PIN_COUNT || !(irq_attached & (1ULL << pin))) return false;
+  const DiIrqPin* p = &irq_pins[pin];
+
+  // ISR may run on the other core: retry until the pair is from one pulse
+  uint32_t seq, c, w;
+  do {
+    seq = p->pulse_seq;
+    c = p->pulse_count;
+    w = p->pulse_us;
+  } while ((seq & 1) || seq != p->pulse_seq);
+
+  if (count) *count = c;
+  if (width_us) *width_us = w;
+  return true;
+}
+
+uint32_t di_irq_events_head(void) {
+  return di_event_head(&irq_events);
+}
+
+uint32_t di_irq_events_read(uint32_t *cursor, DiEvent *out, uint32_t max, uint32_t *lost) {
+  return di_event_read(&irq_events, cursor, out, max, lost);
+}
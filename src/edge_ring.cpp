@@ -0,0 +1,69 @@
+/**
+ * @file edge_ring.cpp
+ * @brief Lock-free edge timestamp ring (v7.9.8.7)
+ *
+ * LAYER 5: Feature Engines - Counter edge capture (pure data structure)
+ * Edge numbers are free-running uint32; all comparisons are done on
+ * differences, so head wrap at 2^32 is harmless.
+ */
+
+#include "edge_ring.h"
+
+bool edge_ring_init(EdgeRing *r, uint32_t *buf, uint32_t size)
+{
+  if (!buf || size < 2 || (size & (size - 1)) != 0) return false;
+  r->mask = size - 1;
+  __atomic_store_n(&r->head, 0, __ATOMIC_RELAXED);
+  // Publish storage last: the ISR treats buf != NULL as "capture on"
+  __atomic_store_n(&r->buf, buf, __ATOMIC_RELEASE);
+  return true;
+}
+
+uint32_t edge_ring_tail(const EdgeRing *r)
+{
+  uint32_t h = edge_ring_head(r);
+  uint32_t size = r->mask + 1;
+  return (h > size) ? h - size : 0;
+}
+
+uint32_t edge_ring_read(const EdgeRing *r, uint32_t *cursor,
+                        uint32_t *out, uint32_t max, uint32_t *lost)
+{
+  uint32_t size = r->mask + 1;
+  uint32_t cur = *cursor;
+  uint32_t h = edge_ring_head(r);
+
+  // Cursor ahead of head (stale cursor from before a re-init): restart at head
+  if ((int32_t)(h - cur) < 0) {
+    *cursor = h;
+    return 0;
+  }
+
+  // Fell more than one ring behind: skip to the oldest slot still valid
+  if (h - cur > size) {
+    if (lost) *lost += h - size - cur;
+    cur = h - size;
+  }
+
+  uint32_t n = h - cur;
+  if (n > max) n = max;
+  for (uint32_t i = 0; i < n; i++) {
+    out[i] = r->buf[(cur + i) & r->mask];
+  }
+
+  // Edges pushed during the copy may have overwritten the first slots read.
+  // Slot for edge e is valid while head - e <= size.
+  uint32_t h2 = edge_ring_head(r);
+  uint32_t torn = 0;
+  if (h2 - cur > size) {
+    torn = h2 - size - cur;
+    if (torn > n) torn = n;
+    for (uint32_t i = torn; i < n; i++) {
+      out[i - torn] = out[i];
+    }
+    if (lost) *lost += torn;
+  }
+
+  *cursor = cur + n;
+  return n - torn;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file freq_estimator.cpp
+ * @brief Reciprocal (period-based) frequency estimator (v7.9.8.5)
+ *
+ * LAYER 5: Feature Engines - Frequency Measurement (pure math)
+ * All times are uint32 microseconds; differences are taken modulo 2^32, so
+ * spans up to ~71 minutes are handled across micros() wrap.
+ */
+
+#include "freq_estimator.h"
+
+void freq_est_reset(FreqEstimator *st, uint32_t edge_count)
+{
+  st->ref_count = edge_count;
+  st->ref_us = 0;
+  st->freq_mhz = 0;
+  st->periods = 0;
+  st->have_ref = 0;
+  st->method = FREQ_EST_NONE;
+}
+
+bool freq_est_update(FreqEstimator *st, const FreqEstConfig *cfg,
+                     uint32_t edge_count, uint32_t edge_us, uint32_t now_us)
+{
+  uint32_t n = edge_count - st->ref_count;
+
+  if (!st->have_ref) {
+    // First edge after reset only starts the clock: the time before it is
+    // not a whole period
+    if (n != 0) {
+      st->ref_count = edge_count;
+      st->ref_us = edge_us;
+      st->have_ref = 1;
+    }
+    return false;
+  }
+
+  if (n != 0) {
+    uint32_t span_us = edge_us - st->ref_us;
+    if (span_us >= cfg->min_gate_us && span_us > 0) {
+      uint64_t mhz = (uint64_t)n * 1000000000ULL / span_us;
+      st->freq_mhz = (mhz > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)mhz;
+      st->periods = n;
+      st->method = (n == 1) ? FREQ_EST_PERIOD : FREQ_EST_GATE;
+      st->ref_count = edge_count;
+      st->ref_us = edge_us;
+      return true;
+    }
+  }
+
+  // No measurement closed: check how long the input has been silent
+  uint32_t since_us = now_us - edge_us;
+  if (since_us >= cfg->timeout_us) {
+    freq_est_reset(st, edge_count);
+    return false;
+  }
+  if (st->freq_mhz > 0 && since_us > 0) {
+    // Next period is at least since_us long, so f <= 1/since_us
+    uint64_t bound = 1000000000ULL / since_us;
+    if (bound < st->freq_mhz) {
+      st->freq_mhz = (uint32_t)bound;
+      st->method = FREQ_EST_DECAY;
+    }
+  }
+  return false;
+}
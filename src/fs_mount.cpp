@@ -0,0 +1,120 @@
+/**
+ * @file fs_mount.cpp
+ * @brief LittleFS mount and one-time SPIFFS migration (v7.9.10.3)
+ *
+ * LAYER 6: Persistence - File storage
+ * Called lazily by the ST loaders and the persist writer task; the boot
+ * fast path (XIP bytecode cache) never mounts the filesystem. The lock is
+ * created by fs_mount_init() from setup(), before the writer task starts.
+ */
+
+#include "fs_mount.h"
+#include "fs_store.h"
+#include "debug.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <SPIFFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <string.h>
+
+static FsMountInfo mount_info;
+static volatile bool mount_tried = false;
+static volatile bool mount_ok = false;         // Set after recovery, read without the lock
+static uint32_t mount_failed_ms = 0;           // millis() of the last failed attempt
+static SemaphoreHandle_t mount_mutex = NULL;   // ST loaders vs. persist writer task
+
+// A failed mount is retried, but not on every call: each attempt can take
+// hundreds of ms (format/migration) and callers sit in the loop
+#define FS_MOUNT_RETRY_MS  10000
+
+static uint32_t fs_clock_us(void) {
+  return (uint32_t)micros();
+}
+
+// SPIFFS on the partition: move its files to LittleFS
+static bool fs_migrate_spiffs(void) {
+  uint32_t t0 = micros();
+  FsImport imp;
+  bool collected = fs_import_collect(&imp, FS_SPIFFS_MOUNT_POINT);
+  SPIFFS.end();
+  if (!collected) {
+    debug_println("[FS] SPIFFS kunne ikke laeses helt - migrering udskudt, partition uaendret");
+    return false;
+  }
+
+  if (!LittleFS.format() || !LittleFS.begin(false, FS_MOUNT_POINT, 10, FS_PARTITION_LABEL) ||
+      !fs_store_init(FS_MOUNT_POINT, fs_clock_us)) {
+    debug_println("[FS] LittleFS format fejlede efter SPIFFS-laesning");
+    fs_import_free(&imp);
+    return false;
+  }
+  mount_info.migrated_files = fs_import_write(&imp);
+  mount_info.migrated_bytes = imp.bytes;
+  if (mount_info.migrated_files != imp.count) {
+    debug_printf("[FS] Migrering: %u af %u filer skrevet\n", mount_info.migrated_files, imp.count);
+  }
+  fs_import_free(&imp);
+  mount_info.migrate_us = micros() - t0;
+  debug_printf("[FS] Migreret %u filer (%lu bytes) fra SPIFFS til LittleFS paa %lu ms\n",
+               mount_info.migrated_files, (unsigned long)mount_info.migrated_bytes,
+               (unsigned long)(mount_info.migrate_us / 1000));
+  return true;
+}
+
+static bool fs_mount_locked(void) {
+  uint32_t t0 = micros();
+
+  bool ok = LittleFS.begin(false, FS_MOUNT_POINT, 10, FS_PARTITION_LABEL);
+  if (ok) {
+    ok = fs_store_init(FS_MOUNT_POINT, fs_clock_us);
+  } else if (SPIFFS.begin(false, FS_SPIFFS_MOUNT_POINT, 10, FS_PARTITION_LABEL)) {
+    ok = fs_migrate_spiffs();
+  } else {
+    // Blank or corrupt partition: nothing to lose
+    ok = LittleFS.begin(true, FS_MOUNT_POINT, 10, FS_PARTITION_LABEL) &&
+         fs_store_init(FS_MOUNT_POINT, fs_clock_us);
+    mount_info.formatted = ok;
+  }
+
+  mount_info.mounted = ok;
+  mount_info.mount_us = micros() - t0;
+  if (!ok) {
+    debug_println("[FS] LittleFS mount fejlede");
+    return false;
+  }
+  uint32_t stale = fs_store_recover();
+  if (stale) {
+    debug_printf("[FS] %lu ufuldendte skrivninger fjernet (gamle filer bevaret)\n", (unsigned long)stale);
+  }
+  return true;
+}
+
+void fs_mount_init(void) {
+  if (mount_mutex == NULL) mount_mutex = xSemaphoreCreateMutex();
+}
+
+bool fs_mount(void) {
+  if (mount_ok) return true;
+  if (mount_tried && millis() - mount_failed_ms < FS_MOUNT_RETRY_MS) return false;
+  if (mount_mutex == NULL) return false;  // fs_mount_init() not run yet
+
+  xSemaphoreTake(mount_mutex, portMAX_DELAY);
+  if (!mount_ok &&
+      (!mount_tried || millis() - mount_failed_ms >= FS_MOUNT_RETRY_MS)) {
+    mount_ok = fs_mount_locked();
+    if (!mount_ok) mount_failed_ms = millis();
+    mount_tried = true;
+  }
+  bool ok = mount_ok;
+  xSemaphoreGive(mount_mutex);
+  return ok;
+}
+
+void fs_mount_info(FsMountInfo *info) {
+  *info = mount_info;
+  if (mount_info.mounted) {
+    info->total_bytes = LittleFS.totalBytes();
+    info->used_bytes = LittleFS.usedBytes();
+  }
+}
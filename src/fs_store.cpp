@@ -0,0 +1,238 @@
+/**
+ * @file fs_store.cpp
+ * @brief File storage with atomic replace for ST sources and bytecode (v7.9.10.3)
+ *
+ * LAYER 6: Persistence - File storage (pure, no ESP-IDF)
+ * Only stdio, dirent and unistd, which the ESP-IDF VFS provides for a
+ * mounted LittleFS partition as well.
+ */
+
+#include "fs_store.h"
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char fs_root[FS_ROOT_MAX];
+static bool fs_ready = false;
+static fs_clock_fn fs_now = NULL;
+static FsStats fs_stats;
+
+static bool fs_path(const char *name, char *out, size_t size) {
+  if (!fs_ready || !name || name[0] != '/' || strlen(name) >= FS_NAME_MAX) return false;
+  int n = snprintf(out, size, "%s%s", fs_root, name);
+  return n > 0 && (size_t)n < size;
+}
+
+static bool has_tmp_suffix(const char *name) {
+  size_t n = strlen(name);
+  size_t s = sizeof(FS_TMP_SUFFIX) - 1;
+  return n >= s && strcmp(name + n - s, FS_TMP_SUFFIX) == 0;
+}
+
+bool fs_store_init(const char *root, fs_clock_fn now_us) {
+  fs_ready = false;
+  memset(&fs_stats, 0, sizeof(fs_stats));
+  if (!root || strlen(root) >= sizeof(fs_root)) return false;
+  struct stat st;
+  if (stat(root, &st) != 0 || !S_ISDIR(st.st_mode)) return false;
+  strcpy(fs_root, root);
+  fs_now = now_us;
+  fs_ready = true;
+  return true;
+}
+
+bool fs_store_ready(void) {
+  return fs_ready;
+}
+
+uint32_t fs_store_recover(void) {
+  if (!fs_ready) return 0;
+  DIR *dir = opendir(fs_root);
+  if (!dir) return 0;
+  uint32_t removed = 0;
+  char path[FS_PATH_MAX + sizeof(FS_TMP_SUFFIX)];
+  struct dirent *e;
+  while ((e = readdir(dir)) != NULL) {
+    if (!has_tmp_suffix(e->d_name)) continue;
+    int n = snprintf(path, sizeof(path), "%s/%s", fs_root, e->d_name);
+    if (n > 0 && (size_t)n < sizeof(path) && unlink(path) == 0) removed++;
+  }
+  closedir(dir);
+  fs_stats.stale_tmp += removed;
+  return removed;
+}
+
+bool fs_exists(const char *name) {
+  return fs_size(name) >= 0;
+}
+
+int32_t fs_size(const char *name) {
+  char path[FS_PATH_MAX];
+  struct stat st;
+  if (!fs_path(name, path, sizeof(path)) || stat(path, &st) != 0 || !S_ISREG(st.st_mode)) return -1;
+  return (int32_t)st.st_size;
+}
+
+bool fs_remove(const char *name) {
+  char path[FS_PATH_MAX];
+  if (!fs_path(name, path, sizeof(path))) return false;
+  return unlink(path) == 0 || !fs_exists(name);
+}
+
+/* ============================================================================
+ * READ
+ * ============================================================================ */
+
+bool fs_read_open(FsReader *r, const char *name) {
+  char path[FS_PATH_MAX];
+  memset(r, 0, sizeof(*r));
+  if (!fs_path(name, path, sizeof(path))) return false;
+  r->t0 = fs_now ? fs_now() : 0;
+  r->f = fopen(path, "rb");
+  return r->f != NULL;
+}
+
+uint32_t fs_read(FsReader *r, void *buf, uint32_t len) {
+  if (!r->f || len == 0) return 0;
+  uint32_t n = (uint32_t)fread(buf, 1, len, r->f);
+  r->bytes += n;
+  return n;
+}
+
+void fs_read_close(FsReader *r) {
+  if (!r->f) return;
+  fclose(r->f);
+  r->f = NULL;
+  fs_stats.reads++;
+  fs_stats.read_bytes += r->bytes;
+  if (fs_now) fs_stats.read_us += fs_now() - r->t0;
+}
+
+/* ============================================================================
+ * ATOMIC WRITE
+ * ============================================================================ */
+
+bool fs_write_open(FsWriter *w, const char *name) {
+  memset(w, 0, sizeof(*w));
+  if (!fs_path(name, w->path, sizeof(w->path))) {
+    fs_stats.errors++;
+    return false;
+  }
+  snprintf(w->tmp, sizeof(w->tmp), "%s" FS_TMP_SUFFIX, w->path);
+  w->t0 = fs_now ? fs_now() : 0;
+  w->f = fopen(w->tmp, "wb");
+  if (!w->f) {
+    fs_stats.errors++;
+    return false;
+  }
+  return true;
+}
+
+bool fs_write(FsWriter *w, const void *data, uint32_t len) {
+  if (!w->f || w->err) return false;
+  if (len && fwrite(data, 1, len, w->f) != len) {
+    w->err = true;
+    return false;
+  }
+  w->bytes += len;
+  return true;
+}
+
+bool fs_write_commit(FsWriter *w) {
+  if (!w->f) return false;
+  bool ok = !w->err && fflush(w->f) == 0 && fsync(fileno(w->f)) == 0;
+  ok = fclose(w->f) == 0 && ok;
+  w->f = NULL;
+  if (ok) ok = rename(w->tmp, w->path) == 0;
+  if (!ok) {
+    unlink(w->tmp);
+    fs_stats.errors++;
+    return false;
+  }
+  fs_stats.commits++;
+  fs_stats.write_bytes += w->bytes;
+  if (fs_now) fs_stats.write_us += fs_now() - w->t0;
+  return true;
+}
+
+void fs_write_abort(FsWriter *w) {
+  if (!w->f) return;
+  fclose(w->f);
+  w->f = NULL;
+  unlink(w->tmp);
+  fs_stats.aborts++;
+}
+
+bool fs_write_file(const char *name, const void *data, uint32_t len) {
+  FsWriter w;
+  if (!fs_write_open(&w, name)) return false;
+  fs_write(&w, data, len);
+  return fs_write_commit(&w);
+}
+
+const FsStats *fs_store_stats(void) {
+  return &fs_stats;
+}
+
+uint32_t fs_kb_per_s(uint32_t bytes, uint32_t us) {
+  if (us == 0) return 0;
+  return (uint32_t)(((uint64_t)bytes * 1000000u / 1024u) / us);
+}
+
+/* ============================================================================
+ * IMPORT (one-time migration from another filesystem)
+ * ============================================================================ */
+
+static bool import_file(FsImport *imp, const char *dir, const char *entry) {
+  char path[FS_PATH_MAX + FS_NAME_MAX];
+  int n = snprintf(path, sizeof(path), "%s/%s", dir, entry);
+  if (n <= 0 || (size_t)n >= sizeof(path)) return false;
+  struct stat st;
+  if (stat(path, &st) != 0) return false;
+  if (!S_ISREG(st.st_mode)) return true;  // Subdirectories are not migrated
+  if (imp->count >= FS_IMPORT_MAX_FILES || strlen(entry) + 2 > FS_NAME_MAX) return false;
+
+  FsImportFile *f = &imp->files[imp->count];
+  snprintf(f->name, sizeof(f->name), "/%s", entry);
+  f->len = (uint32_t)st.st_size;
+  f->data = (uint8_t *)malloc(f->len ? f->len : 1);
+  if (!f->data) return false;
+  imp->count++;  // Owned from here, freed by fs_import_free()
+
+  FILE *in = fopen(path, "rb");
+  if (!in) return false;
+  bool ok = fread(f->data, 1, f->len, in) == f->len;
+  fclose(in);
+  imp->bytes += f->len;
+  return ok;
+}
+
+bool fs_import_collect(FsImport *imp, const char *dir) {
+  memset(imp, 0, sizeof(*imp));
+  DIR *d = opendir(dir);
+  if (!d) return false;
+  bool ok = true;
+  struct dirent *e;
+  while (ok && (e = readdir(d)) != NULL) {
+    if (e->d_name[0] == '.' || has_tmp_suffix(e->d_name)) continue;
+    ok = import_file(imp, dir, e->d_name);
+  }
+  closedir(d);
+  if (!ok) fs_import_free(imp);
+  return ok;
+}
+
+uint8_t fs_import_write(const FsImport *imp) {
+  uint8_t written = 0;
+  for (uint8_t i = 0; i < imp->count; i++) {
+    if (fs_write_file(imp->files[i].name, imp->files[i].data, imp->files[i].len)) written++;
+  }
+  return written;
+}
+
+void fs_import_free(FsImport *imp) {
+  for (uint8_t i = 0; i < imp->count; i++) free(imp->files[i].data);
+  memset(imp, 0, sizeof(*imp));
+}
@@ -7,12 +7,30 @@
  *   - GPIO 0-39:    Real ESP32 GPIO pins
  *   - GPIO 100-107: Shift register inputs  (SN74HC165, ES32D26 DI1-DI8)
  *   - GPIO 200-223: Shift register outputs (SN74HC595, ES32D26 DO1-DO8 relæer)
+ *
+ * v7.9.9.1: The shift register chains are driven by an SPI host with DMA.
+ * Inputs are sampled by a periodic esp_timer into a double buffer; outputs
+ * are sent only when the output cache is dirty. Bit-banging is kept as a
+ * fallback if the SPI host cannot be claimed.
+ *
+ * v7.9.9.2: Port-wide access for gpio_mapping - all real pins are read or
+ * written with the GPIO in/out set/clear registers, and the shift register
+ * bytes are exchanged as whole words.
  */
 
 #include "gpio_driver.h"
 #include "constants.h"
 #include <Arduino.h>
+#include <string.h>
 #include <driver/gpio.h>
+#include <soc/gpio_struct.h>
+#ifdef SHIFT_REGISTER_ENABLED
+#include <driver/spi_master.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_gpio.h>
+#include <soc/spi_periph.h>
+#endif
 
 /* ============================================================================
  * INTERRUPT HANDLERS
@@ -38,12 +56,45 @@ static void IRAM_ATTR gpio_isr_wrapper(void) {
 
 #ifdef SHIFT_REGISTER_ENABLED
 
-// Cached shift register state (updated by shift_register_poll())
+// Cached shift register state (updated by gpio_driver_poll_inputs())
 static uint8_t sr_input_cache[SR_IN_COUNT] = {0};    // Last read from 74HC165
 static uint8_t sr_output_cache[SR_OUT_COUNT] = {0};   // Current state of 74HC595
 static bool sr_output_dirty = false;                   // Needs flush to hardware
 static bool sr_initialized = false;
 
+/* SPI/DMA driver state (v7.9.9.1)
+ *
+ * One full-duplex transaction clocks both chains: 595 data on MOSI, 165 QH
+ * on MISO, and the bus clock is routed to both CLK pins. The frame is as
+ * long as the longer chain; output bytes go last so they end up in the 595s,
+ * input bytes come first. LOAD is pulsed before each frame (pre_cb); LATCH is
+ * pulsed after a frame only if it carried new output data (post_cb), so
+ * sampling frames shift the 595s without touching the relays.
+ */
+#define SR_FRAME_BYTES  ((SR_IN_COUNT > SR_OUT_COUNT) ? SR_IN_COUNT : SR_OUT_COUNT)
+#define SR_DMA_BYTES    ((SR_FRAME_BYTES + 3) & ~3)
+
+static_assert(PIN_SR_IN_LOAD < 32 && PIN_SR_OUT_LATCH < 32 && PIN_SR_OUT_OE < 32,
+              "SR callbacks use GPIO.out_w1ts/w1tc (GPIO 0-31)");
+
+static spi_device_handle_t sr_spi = NULL;           // NULL = bit-bang fallback
+static esp_timer_handle_t sr_sample_timer = NULL;
+static spi_transaction_t sr_trans;
+static uint8_t *sr_dma_tx = NULL;                    // DMA-capable frame buffers
+static uint8_t *sr_dma_rx = NULL;
+static bool sr_in_flight = false;                    // Owned by the sampler
+
+// Input double buffer: the sampler writes the back buffer, then flips
+static uint8_t sr_input_buf[2][SR_IN_COUNT];
+static volatile uint8_t sr_input_front = 0;
+
+// Output frame handed from the main loop to the sampler
+static portMUX_TYPE sr_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t sr_output_frame[SR_OUT_COUNT];
+static bool sr_output_pending = false;
+
+static gpio_sr_stats_t sr_stats = {};
+
 /**
  * @brief Initialize shift register GPIO pins
  */
@@ -79,11 +130,13 @@ static void shift_register_init(void) {
   sr_initialized = true;
 }
 
+static bool shift_register_spi_init(void);
+
 /**
- * @brief Read all shift register inputs (SN74HC165)
+ * @brief Read all shift register inputs (SN74HC165) by bit-banging
  *
  * Pulses LOAD to latch parallel inputs, then clocks out serial data.
- * Results stored in sr_input_cache[].
+ * Results stored in sr_input_cache[]. Fallback when SPI is unavailable.
  */
 static void shift_register_read_inputs(void) {
   // Ensure clock is LOW before LOAD pulse
@@ -112,10 +165,10 @@ static void shift_register_read_inputs(void) {
 }
 
 /**
- * @brief Flush output cache to shift registers (SN74HC595)
+ * @brief Flush output cache to shift registers (SN74HC595) by bit-banging
  *
  * Shifts out all bytes in sr_output_cache[], then pulses LATCH.
- * Only called when sr_output_dirty is true.
+ * Only called when sr_output_dirty is true. Fallback when SPI is unavailable.
  */
 static void shift_register_flush_outputs(void) {
   if (!sr_output_dirty) return;
@@ -143,6 +196,152 @@ static void shift_register_flush_outputs(void) {
   sr_output_dirty = false;
 }
 
+/* ============================================================================
+ * SHIFT REGISTER SPI/DMA DRIVER (v7.9.9.1)
+ * ============================================================================ */
+
+// Before each frame: latch the 165 parallel inputs (SH/LD active LOW)
+static void IRAM_ATTR sr_spi_pre_cb(spi_transaction_t *t) {
+  (void)t;
+  GPIO.out_w1tc = (1u << PIN_SR_IN_LOAD);
+  delayMicroseconds(1);
+  GPIO.out_w1ts = (1u << PIN_SR_IN_LOAD);
+}
+
+// After a frame with new output data: latch the 595s and enable outputs
+static void IRAM_ATTR sr_spi_post_cb(spi_transaction_t *t) {
+  if (!t->user) return;
+  GPIO.out_w1ts = (1u << PIN_SR_OUT_LATCH);
+  delayMicroseconds(1);
+  GPIO.out_w1tc = (1u << PIN_SR_OUT_LATCH);
+  GPIO.out_w1tc = (1u << PIN_SR_OUT_OE);  // OE active LOW
+}
+
+/**
+ * @brief Fixed-rate sampler (esp_timer task)
+ *
+ * Publishes the previous frame's inputs, then queues the next frame with
+ * the pending output data if the main loop flushed any.
+ */
+static void sr_sample_tick(void *arg) {
+  (void)arg;
+
+  if (sr_in_flight) {
+    spi_transaction_t *done = NULL;
+    if (spi_device_get_trans_result(sr_spi, &done, 0) != ESP_OK) {
+      sr_stats.overruns++;  // Previous frame still running - skip this tick
+      return;
+    }
+    sr_in_flight = false;
+
+    // First bytes on MISO come from the last 165 in the chain
+    uint8_t back = sr_input_front ^ 1;
+    for (int k = 0; k < SR_IN_COUNT; k++) {
+      sr_input_buf[back][SR_IN_COUNT - 1 - k] = sr_dma_rx[k];
+    }
+    sr_input_front = back;
+    sr_stats.samples++;
+  }
+
+  // Output bytes go last, last 595 first (same order as the bit-bang path)
+  bool latch = false;
+  portENTER_CRITICAL(&sr_mux);
+  if (sr_output_pending) {
+    for (int k = 0; k < SR_OUT_COUNT; k++) {
+      sr_dma_tx[SR_FRAME_BYTES - SR_OUT_COUNT + k] = sr_output_frame[SR_OUT_COUNT - 1 - k];
+    }
+    sr_output_pending = false;
+    latch = true;
+  }
+  portEXIT_CRITICAL(&sr_mux);
+
+  sr_trans.user = (void *)(uintptr_t)latch;
+  if (spi_device_queue_trans(sr_spi, &sr_trans, 0) == ESP_OK) {
+    sr_in_flight = true;
+    if (latch) sr_stats.flushes++;
+  } else if (latch) {
+    portENTER_CRITICAL(&sr_mux);
+    sr_output_pending = true;  // Retry next tick (unless the loop queued newer data)
+    portEXIT_CRITICAL(&sr_mux);
+  }
+}
+
+/**
+ * @brief Claim SR_SPI_HOST for both chains and start the sampler
+ * @return false if the host or memory is unavailable (bit-bang is used instead)
+ */
+static bool shift_register_spi_init(void) {
+  sr_dma_tx = (uint8_t *)heap_caps_calloc(1, SR_DMA_BYTES, MALLOC_CAP_DMA);
+  sr_dma_rx = (uint8_t *)heap_caps_calloc(1, SR_DMA_BYTES, MALLOC_CAP_DMA);
+  if (!sr_dma_tx || !sr_dma_rx) goto fail_mem;
+
+  {
+    spi_bus_config_t buscfg = {};
+    buscfg.mosi_io_num = PIN_SR_OUT_DATA;
+    buscfg.miso_io_num = PIN_SR_IN_DATA;
+    buscfg.sclk_io_num = PIN_SR_OUT_CLOCK;
+    buscfg.quadwp_io_num = -1;
+    buscfg.quadhd_io_num = -1;
+    buscfg.max_transfer_sz = SR_DMA_BYTES;
+    if (spi_bus_initialize(SR_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO) != ESP_OK) goto fail_mem;
+
+    spi_device_interface_config_t devcfg = {};
+    devcfg.mode = 0;                     // 595 shifts and 165 is sampled on rising CLK
+    devcfg.clock_speed_hz = SR_SPI_CLOCK_HZ;
+    devcfg.spics_io_num = -1;            // LOAD/LATCH are driven by the callbacks
+    devcfg.queue_size = 1;
+    devcfg.pre_cb = sr_spi_pre_cb;
+    devcfg.post_cb = sr_spi_post_cb;
+    if (spi_bus_add_device(SR_SPI_HOST, &devcfg, &sr_spi) != ESP_OK) goto fail_bus;
+
+    // 165 CLK is on its own pin: route the same SPI clock signal there
+    esp_rom_gpio_pad_select_gpio(PIN_SR_IN_CLOCK);
+    gpio_set_direction((gpio_num_t)PIN_SR_IN_CLOCK, GPIO_MODE_OUTPUT);
+    esp_rom_gpio_connect_out_signal(PIN_SR_IN_CLOCK, spi_periph_signal[SR_SPI_HOST].spiclk_out, false, false);
+    // QH is driven by the 165 — no pull (GPIO15 strapping pullup)
+    gpio_set_pull_mode((gpio_num_t)PIN_SR_IN_DATA, GPIO_FLOATING);
+
+    memset(&sr_trans, 0, sizeof(sr_trans));
+    sr_trans.length = SR_FRAME_BYTES * 8;
+    sr_trans.rxlength = SR_FRAME_BYTES * 8;
+    sr_trans.tx_buffer = sr_dma_tx;
+    sr_trans.rx_buffer = sr_dma_rx;
+
+    esp_timer_create_args_t targs = {};
+    targs.callback = sr_sample_tick;
+    targs.dispatch_method = ESP_TIMER_TASK;
+    targs.name = "sr_sample";
+    if (esp_timer_create(&targs, &sr_sample_timer) != ESP_OK) goto fail_dev;
+    if (esp_timer_start_periodic(sr_sample_timer, SR_SAMPLE_PERIOD_US) != ESP_OK) {
+      esp_timer_delete(sr_sample_timer);
+      sr_sample_timer = NULL;
+      goto fail_dev;
+    }
+  }
+
+  sr_stats.spi_active = 1;
+  sr_stats.period_us = SR_SAMPLE_PERIOD_US;
+  return true;
+
+fail_dev:
+  spi_bus_remove_device(sr_spi);
+  sr_spi = NULL;
+fail_bus:
+  spi_bus_free(SR_SPI_HOST);
+fail_mem:
+  heap_caps_free(sr_dma_tx);
+  heap_caps_free(sr_dma_rx);
+  sr_dma_tx = sr_dma_rx = NULL;
+  return false;
+}
+
+/**
+ * @brief Wait until the sampler has run (diagnostics only)
+ */
+static void shift_register_spi_settle(void) {
+  delay((2 * SR_SAMPLE_PERIOD_US) / 1000 + 1);
+}
+
 /**
  * @brief Read a virtual input pin from shift register cache
  * @param vpin Virtual pin 100-107 (maps to DI1-DI8)
@@ -189,6 +388,9 @@ void gpio_driver_init(void) {
   // GPIO driver uses Arduino HAL which is already initialized
 #ifdef SHIFT_REGISTER_ENABLED
   shift_register_init();
+  if (!shift_register_spi_init()) {
+    Serial.println("[SR] SPI host unavailable - using bit-bang shift register I/O");
+  }
 #endif
 }
 
@@ -245,31 +447,105 @@ void gpio_write(uint8_t pin, uint8_t level) {
 }
 
 /* ============================================================================
- * SHIFT REGISTER POLL (call from main loop)
+ * PORT-WIDE ACCESS (batched gpio_mapping, v7.9.9.2)
  * ============================================================================ */
 
-void gpio_driver_poll(void) {
+uint64_t gpio_driver_read_port(void) {
+  // GPIO 0-31 in one register, GPIO 32-39 in the low byte of the second
+  return (uint64_t)GPIO.in | ((uint64_t)(GPIO.in1.val & 0xFF) << 32);
+}
+
+void gpio_driver_write_port(uint64_t set_mask, uint64_t clear_mask) {
+  // Write-1-to-set/clear registers: pins outside the masks are untouched
+  if ((uint32_t)set_mask) GPIO.out_w1ts = (uint32_t)set_mask;
+  if ((uint32_t)clear_mask) GPIO.out_w1tc = (uint32_t)clear_mask;
+  if ((set_mask >> 32) & 0xFF) GPIO.out1_w1ts.val = (uint32_t)(set_mask >> 32) & 0xFF;
+  if ((clear_mask >> 32) & 0xFF) GPIO.out1_w1tc.val = (uint32_t)(clear_mask >> 32) & 0xFF;
+}
+
+uint32_t gpio_driver_sr_input_bits(void) {
+  uint32_t bits = 0;
 #ifdef SHIFT_REGISTER_ENABLED
-  if (!sr_initialized) return;
-  shift_register_read_inputs();
-  shift_register_flush_outputs();
+  for (uint8_t chip = 0; chip < SR_IN_COUNT && chip < 4; chip++) {
+    bits |= (uint32_t)sr_input_cache[chip] << (chip * 8);
+  }
+#endif
+  return bits;
+}
+
+uint32_t gpio_driver_sr_output_bits(void) {
+  uint32_t bits = 0;
+#ifdef SHIFT_REGISTER_ENABLED
+  for (uint8_t chip = 0; chip < SR_OUT_COUNT && chip < 4; chip++) {
+    bits |= (uint32_t)sr_output_cache[chip] << (chip * 8);
+  }
+#endif
+  return bits;
+}
+
+void gpio_driver_sr_write_outputs(uint32_t mask, uint32_t bits) {
+#ifdef SHIFT_REGISTER_ENABLED
+  for (uint8_t chip = 0; chip < SR_OUT_COUNT && chip < 4; chip++) {
+    uint8_t m = (uint8_t)(mask >> (chip * 8));
+    if (!m) continue;
+    uint8_t next = (uint8_t)((sr_output_cache[chip] & ~m) | ((bits >> (chip * 8)) & m));
+    if (next != sr_output_cache[chip]) {
+      sr_output_cache[chip] = next;
+      sr_output_dirty = true;
+    }
+  }
+#else
+  (void)mask;
+  (void)bits;
 #endif
 }
 
+/* ============================================================================
+ * SHIFT REGISTER POLL (call from main loop)
+ * ============================================================================ */
+
+void gpio_driver_poll(void) {
+  gpio_driver_poll_inputs();
+  gpio_driver_flush_outputs();
+}
+
 void gpio_driver_poll_inputs(void) {
 #ifdef SHIFT_REGISTER_ENABLED
   if (!sr_initialized) return;
+  if (sr_spi) {
+    // Snapshot the latest sample so the whole loop cycle sees one input state
+    memcpy(sr_input_cache, sr_input_buf[sr_input_front], SR_IN_COUNT);
+    return;
+  }
   shift_register_read_inputs();
 #endif
 }
 
 void gpio_driver_flush_outputs(void) {
 #ifdef SHIFT_REGISTER_ENABLED
-  if (!sr_initialized) return;
+  if (!sr_initialized || !sr_output_dirty) return;
+  if (sr_spi) {
+    // Hand the frame to the sampler; it goes out with the next frame
+    portENTER_CRITICAL(&sr_mux);
+    memcpy(sr_output_frame, sr_output_cache, SR_OUT_COUNT);
+    sr_output_pending = true;
+    portEXIT_CRITICAL(&sr_mux);
+    sr_output_dirty = false;
+    return;
+  }
   shift_register_flush_outputs();
 #endif
 }
 
+void gpio_driver_get_sr_stats(gpio_sr_stats_t *out) {
+  if (!out) return;
+#ifdef SHIFT_REGISTER_ENABLED
+  *out = sr_stats;
+#else
+  memset(out, 0, sizeof(*out));
+#endif
+}
+
 /* ============================================================================
  * SHIFT REGISTER HARDWARE TEST
  * ============================================================================ */
@@ -283,7 +559,8 @@ void gpio_driver_test_sr(void) {
     PIN_SR_IN_DATA, PIN_SR_IN_CLOCK, PIN_SR_IN_LOAD);
 
   // Test 1: Read current input state
-  shift_register_read_inputs();
+  if (sr_spi) shift_register_spi_settle();
+  gpio_driver_poll_inputs();
   Serial.printf("[SR TEST] Input cache: 0x%02X (", sr_input_cache[0]);
   for (int b = 7; b >= 0; b--) {
     Serial.print((sr_input_cache[0] >> b) & 1);
@@ -294,7 +571,8 @@ void gpio_driver_test_sr(void) {
   Serial.println("[SR TEST] Setting ALL outputs ON...");
   sr_output_cache[0] = 0xFF;
   sr_output_dirty = true;
-  shift_register_flush_outputs();
+  gpio_driver_flush_outputs();
+  if (sr_spi) shift_register_spi_settle();
   Serial.println("[SR TEST] Flushed 0xFF — relæer skal nu være ON");
   Serial.println("[SR TEST] Vent 3 sekunder...");
   delay(3000);
@@ -303,7 +581,8 @@ void gpio_driver_test_sr(void) {
   Serial.println("[SR TEST] Setting ALL outputs OFF...");
   sr_output_cache[0] = 0x00;
   sr_output_dirty = true;
-  shift_register_flush_outputs();
+  gpio_driver_flush_outputs();
+  if (sr_spi) shift_register_spi_settle();
   Serial.println("[SR TEST] Flushed 0x00 — relæer skal nu være OFF");
   delay(1000);
 
@@ -312,7 +591,7 @@ void gpio_driver_test_sr(void) {
   for (int i = 0; i < 8; i++) {
     sr_output_cache[0] = (1 << i);
     sr_output_dirty = true;
-    shift_register_flush_outputs();
+    gpio_driver_flush_outputs();
     Serial.printf("[SR TEST] Relay %d ON (0x%02X)\n", i + 1, sr_output_cache[0]);
     delay(500);
   }
@@ -320,7 +599,8 @@ void gpio_driver_test_sr(void) {
   // Reset all OFF
   sr_output_cache[0] = 0x00;
   sr_output_dirty = true;
-  shift_register_flush_outputs();
+  gpio_driver_flush_outputs();
+  if (sr_spi) shift_register_spi_settle();
   Serial.println("[SR TEST] All OFF — test done");
 
 #else
@@ -337,7 +617,8 @@ void gpio_driver_test_sr_input(void) {
   // Test 1: Læs 5 gange med 500ms mellemrum
   Serial.println("\n[TEST 1] Læser inputs 5 gange (tryk/slip en input under testen):");
   for (int i = 0; i < 5; i++) {
-    shift_register_read_inputs();
+    if (sr_spi) shift_register_spi_settle();
+    gpio_driver_poll_inputs();
     Serial.printf("  Læsning %d: 0x%02X  (IN8..IN1: ", i + 1, sr_input_cache[0]);
     for (int b = 7; b >= 0; b--) {
       Serial.print((sr_input_cache[0] >> b) & 1);
@@ -346,7 +627,13 @@ void gpio_driver_test_sr_input(void) {
     if (i < 4) delay(500);
   }
 
-  // Test 2: Manuel bit-bang med debug per bit
+  // Test 2: Manuel bit-bang med debug per bit (pins ejes af SPI i SPI-mode)
+  if (sr_spi) {
+    Serial.printf("\n[TEST 2] Sprunget over: SPI/DMA aktiv (%lu samples, %lu overruns)\n",
+                  (unsigned long)sr_stats.samples, (unsigned long)sr_stats.overruns);
+    Serial.println("[SR INPUT TEST] Done");
+    return;
+  }
   Serial.println("\n[TEST 2] Manuel bit-bang:");
   digitalWrite(PIN_SR_IN_CLOCK, LOW);
   delayMicroseconds(10);
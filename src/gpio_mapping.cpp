@@ -8,128 +8,139 @@
  * This handles ALL variable I/O:
  * - GPIO pins (INPUT/OUTPUT modes)
  * - ST Logic program variables (INPUT/OUTPUT modes)
+ *
+ * v7.9.9.2: GPIO mappings are compiled into a gpio_plan once per mapping
+ * change. Each cycle then reads all mapped pins with two port register
+ * reads plus the shift register byte, updates the discrete inputs a byte at
+ * a time, and drives the outputs with set/clear masks.
+ *
+ * v7.9.9.3: ST variable bindings are compiled the same way into an
+ * st_binding_plan - a flat list of typed copies between register and
+ * variable pointers - and run under one variable lock per direction.
+ *
+ * v7.9.9.4: inputs on pins in interrupt mode (gpio_irq_pins) are left out
+ * of the polled plan; di_irq attaches a CHANGE interrupt that writes their
+ * discrete inputs on every edge.
  */
 
 #include "gpio_mapping.h"
+#include "gpio_plan.h"
+#include "st_binding_plan.h"
+#include "di_irq.h"
 #include "config_struct.h"
 #include "gpio_driver.h"
 #include "registers.h"
+#include "timer_engine.h"
 #include "st_logic_config.h"
 #include "st_logic_engine.h"  // BUG-038 FIX: For variable locking
-#include <string.h>            // BUG-105: For memcpy() (REAL type conversion)
+#include <stddef.h>
 
-/**
- * @brief Read all INPUT mappings (GPIO + ST variables)
- *
- * Called BEFORE st_logic_engine_loop() to provide fresh inputs.
- * - GPIO INPUT mode: Read GPIO pin → write to discrete input
- * - ST VAR INPUT mode: Read holding register/discrete input → write to ST variable
- */
-static void gpio_mapping_read_inputs(void) {
-  for (uint8_t i = 0; i < g_persist_config.var_map_count; i++) {
-    const VariableMapping* map = &g_persist_config.var_maps[i];
+/* ============================================================================
+ * MAPPING PLANS (v7.9.9.2 GPIO, v7.9.9.3 ST bindings)
+ * ============================================================================ */
 
-    // ========================================================================
-    // GPIO MAPPING - INPUT ONLY
-    // ========================================================================
-    if (map->source_type == MAPPING_SOURCE_GPIO) {
-      // Skip mappings associated with counters/timers (handled by their engines)
-      if (map->associated_counter != 0xff || map->associated_timer != 0xff) {
-        continue;
-      }
+static gpio_plan_t gpio_plan;
+static st_binding_plan_t st_binding_plan;
+static volatile bool mapping_plans_valid = false;
 
-      if (map->is_input) {
-        // INPUT mode: GPIO pin → discrete input
-        if (map->input_reg != 65535) {
-          // gpio_read() handles both real GPIOs (0-39) and
-          // virtual shift register pins (101-108, 201-224)
-          uint8_t level = gpio_read(map->gpio_pin);
-          registers_set_discrete_input(map->input_reg, level);
-        }
-      }
-    }
-    // ========================================================================
-    // ST LOGIC VARIABLE MAPPING - INPUT ONLY
-    // ========================================================================
-    else if (map->source_type == MAPPING_SOURCE_ST_VAR) {
-      st_logic_engine_state_t *st_state = st_logic_get_state();
-      if (!st_state) continue;
+static_assert(sizeof(((PersistConfig*)0)->var_maps) / sizeof(VariableMapping) <= ST_BIND_MAX_ENTRIES,
+              "ST binding plan smaller than var_maps[]");
 
-      st_logic_program_config_t *prog = st_logic_get_program(st_state, map->st_program_id);
-      if (!prog || !prog->compiled || map->st_var_index >= prog->bytecode.var_count) {
-        continue;
-      }
+void gpio_mapping_invalidate(void) {
+  mapping_plans_valid = false;
+}
+
+// Variable of a compiled program (what the binding loop checked every cycle)
+static st_value_t* mapping_resolve_var(uint8_t program_id, uint8_t var_index, st_datatype_t *type) {
+  st_logic_engine_state_t *st_state = st_logic_get_state();
+  if (!st_state) return NULL;
+
+  st_logic_program_config_t *prog = st_logic_get_program(st_state, program_id);
+  if (!prog || !prog->compiled || var_index >= prog->bytecode.var_count) return NULL;
+
+  *type = prog->bytecode.var_types[var_index];
+  return &prog->bytecode.variables[var_index];
+}
 
-      if (map->is_input) {
-        // INPUT mode: Read from Modbus, write to ST variable
-        if (map->input_reg != 65535) {
-          // BUG-010 FIX: Type-aware bounds check (DI uses different size than HR)
-          // BUG-049 FIX: Add bounds check for Coil type
-          // BUG-105 FIX: Multi-register bounds check (word_count)
-          uint8_t word_count = (map->word_count > 0) ? map->word_count : 1;
+static void mapping_plans_update(void) {
+  if (mapping_plans_valid) return;
+
+  // Mark valid before building: an edit during the build invalidates again
+  mapping_plans_valid = true;
+  gpio_plan_build(&gpio_plan, g_persist_config.var_maps, g_persist_config.var_map_count,
+                  di_irq_usable_pins(g_persist_config.gpio_irq_pins));
+  di_irq_apply(&gpio_plan);
+
+  st_bind_target_t target;
+  target.holding = registers_get_holding_regs();
+  target.coils = registers_get_coils();
+  target.discrete = registers_get_discrete_inputs();
+  target.resolve_var = mapping_resolve_var;
+  target.holding_plain = registers_holding_is_plain;
+  st_binding_plan_build(&st_binding_plan, g_persist_config.var_maps,
+                        g_persist_config.var_map_count, &target);
+}
+
+void gpio_mapping_get_plan_stats(uint8_t *inputs, uint8_t *outputs) {
+  mapping_plans_update();
+  if (inputs) *inputs = gpio_plan.gpio_inputs;
+  if (outputs) *outputs = gpio_plan.gpio_outputs;
+}
 
-          if (map->input_type == 1) {
-            // Discrete Input - check DI array size (32 bytes = 256 bits)
-            if (map->input_reg >= DISCRETE_INPUTS_SIZE * 8) continue;
-          } else if (map->input_type == 2) {
-            // Coil - check Coil array size (32 bytes = 256 bits)
-            if (map->input_reg >= COILS_SIZE * 8) continue;
-          } else {
-            // Holding Register - check HR array size (multi-register aware)
-            if (map->input_reg + word_count > HOLDING_REGS_SIZE) continue;
-          }
+// GPIO INPUT mode: all mapped pins -> discrete inputs
+static void gpio_mapping_read_gpio(void) {
+  const gpio_plan_t *plan = &gpio_plan;
+  if (plan->in_run_count == 0) return;
+
+  uint64_t image = 0;
+  if (plan->in_mask & GPIO_PLAN_PORT_MASK) {
+    image |= gpio_driver_read_port();
+  }
+  if (plan->in_mask >> GPIO_PLAN_SR_IN_BIT) {
+    image |= (uint64_t)gpio_driver_sr_input_bits() << GPIO_PLAN_SR_IN_BIT;
+    image |= (uint64_t)gpio_driver_sr_output_bits() << GPIO_PLAN_SR_OUT_BIT;
+  }
+  gpio_plan_scatter_inputs(plan, image, registers_set_discrete_input_bits);
+}
 
-          // BUG-038 FIX: Lock before writing to ST variable
-          st_logic_lock_variables();
+// GPIO OUTPUT mode: coils -> all mapped pins
+static void gpio_mapping_write_gpio(void) {
+  const gpio_plan_t *plan = &gpio_plan;
+  uint64_t drive = plan->out_mask;
+  if (drive == 0) return;
 
-          // BUG-002 & BUG-105 FIX: Store value with correct type conversion
-          st_datatype_t var_type = prog->bytecode.var_types[map->st_var_index];
+  // Timer outputs are written by the timer's deadline callback
+  if (drive & GPIO_PLAN_PORT_MASK) {
+    drive &= ~timer_engine_owned_pin_mask();
+  }
 
-          if (var_type == ST_TYPE_BOOL) {
-            // BOOL: read from DI or Coil
-            uint16_t reg_value;
-            if (map->input_type == 1) {
-              reg_value = registers_get_discrete_input(map->input_reg) ? 1 : 0;
-            } else if (map->input_type == 2) {
-              reg_value = registers_get_coil(map->input_reg) ? 1 : 0;
-            } else {
-              reg_value = registers_get_holding_register(map->input_reg);
-            }
-            prog->bytecode.variables[map->st_var_index].bool_val = (reg_value != 0);
-          }
-          else if (var_type == ST_TYPE_INT) {
-            // INT: 16-bit signed, 1 register
-            uint16_t reg_value = registers_get_holding_register(map->input_reg);
-            prog->bytecode.variables[map->st_var_index].int_val = (int16_t)reg_value;
-          }
-          else if (var_type == ST_TYPE_DINT) {
-            // BUG-125 FIX: DINT: 32-bit signed, 2 registers (LSW first, MSW second)
-            uint16_t low_word = registers_get_holding_register(map->input_reg);      // LSW at base
-            uint16_t high_word = registers_get_holding_register(map->input_reg + 1); // MSW at base+1
-            int32_t dint_value = ((int32_t)high_word << 16) | low_word;
-            prog->bytecode.variables[map->st_var_index].dint_val = dint_value;
-          }
-          else if (var_type == ST_TYPE_DWORD) {
-            // BUG-125 FIX: DWORD: 32-bit unsigned, 2 registers (LSW first, MSW second)
-            uint16_t low_word = registers_get_holding_register(map->input_reg);      // LSW at base
-            uint16_t high_word = registers_get_holding_register(map->input_reg + 1); // MSW at base+1
-            uint32_t dword_value = ((uint32_t)high_word << 16) | low_word;
-            prog->bytecode.variables[map->st_var_index].dword_val = dword_value;
-          }
-          else if (var_type == ST_TYPE_REAL) {
-            // BUG-125 FIX: REAL: 32-bit float, 2 registers (IEEE 754, LSW first, MSW second)
-            uint16_t low_word = registers_get_holding_register(map->input_reg);      // LSW at base
-            uint16_t high_word = registers_get_holding_register(map->input_reg + 1); // MSW at base+1
-            uint32_t bits = ((uint32_t)high_word << 16) | low_word;
-            float real_value;
-            memcpy(&real_value, &bits, sizeof(float));  // Reinterpret bits as float
-            prog->bytecode.variables[map->st_var_index].real_val = real_value;
-          }
+  uint64_t image = gpio_plan_gather_outputs(plan, registers_get_coils());
+  uint64_t port = drive & GPIO_PLAN_PORT_MASK;
+  if (port) {
+    gpio_driver_write_port(image & port, ~image & port);
+  }
+  uint64_t sr = drive >> GPIO_PLAN_SR_OUT_BIT;
+  if (sr) {
+    gpio_driver_sr_write_outputs((uint32_t)sr, (uint32_t)(image >> GPIO_PLAN_SR_OUT_BIT));
+  }
+}
 
-          st_logic_unlock_variables();
-        }
-      }
-    }
+/**
+ * @brief Read all INPUT mappings (GPIO + ST variables)
+ *
+ * Called BEFORE st_logic_engine_loop() to provide fresh inputs.
+ * - GPIO INPUT mode: Read GPIO pin → write to discrete input
+ * - ST VAR INPUT mode: Read holding register/discrete input → write to ST variable
+ */
+static void gpio_mapping_read_inputs(void) {
+  mapping_plans_update();
+  gpio_mapping_read_gpio();
+
+  if (st_binding_plan.in_count > 0) {
+    // BUG-038 FIX: Lock before writing to ST variables (once for the whole list)
+    st_logic_lock_variables();
+    st_binding_plan_run_inputs(&st_binding_plan);
+    st_logic_unlock_variables();
   }
 }
 
@@ -141,104 +152,18 @@ static void gpio_mapping_read_inputs(void) {
  * - ST VAR OUTPUT mode: Read ST variable → write to holding register/coil
  */
 static void gpio_mapping_write_outputs(void) {
-  for (uint8_t i = 0; i < g_persist_config.var_map_count; i++) {
-    const VariableMapping* map = &g_persist_config.var_maps[i];
-
-    // ========================================================================
-    // GPIO MAPPING - OUTPUT ONLY
-    // ========================================================================
-    if (map->source_type == MAPPING_SOURCE_GPIO) {
-      // Skip mappings associated with counters/timers (handled by their engines)
-      if (map->associated_counter != 0xff || map->associated_timer != 0xff) {
-        continue;
-      }
-
-      if (!map->is_input) {
-        // OUTPUT mode: Coil → GPIO pin
-        if (map->coil_reg != 65535) {
-          uint8_t value = registers_get_coil(map->coil_reg);
-          gpio_write(map->gpio_pin, value);
-        }
-      }
-    }
-    // ========================================================================
-    // ST LOGIC VARIABLE MAPPING - OUTPUT ONLY
-    // ========================================================================
-    else if (map->source_type == MAPPING_SOURCE_ST_VAR) {
-      st_logic_engine_state_t *st_state = st_logic_get_state();
-      if (!st_state) continue;
-
-      st_logic_program_config_t *prog = st_logic_get_program(st_state, map->st_program_id);
-      if (!prog || !prog->compiled || map->st_var_index >= prog->bytecode.var_count) {
-        continue;
-      }
-
-      if (!map->is_input) {
-        // OUTPUT mode: Read from ST variable, write to Modbus
-        // BUG-038 FIX: Lock before reading ST variable
-        st_logic_lock_variables();
-
-        // BUG-002 & BUG-105 FIX: Read value with correct type conversion
-        st_datatype_t var_type = prog->bytecode.var_types[map->st_var_index];
-
-        // Check output_type to determine destination
-        if (map->coil_reg != 65535) {
-          // output_type: 0 = Holding Register, 1 = Coil
-          if (map->output_type == 1) {
-            // Output to COIL (BOOL variables)
-            uint8_t coil_value = 0;
-            if (var_type == ST_TYPE_BOOL) {
-              coil_value = prog->bytecode.variables[map->st_var_index].bool_val ? 1 : 0;
-            } else {
-              // Convert INT/DINT/REAL to BOOL (non-zero = 1)
-              coil_value = (prog->bytecode.variables[map->st_var_index].int_val != 0) ? 1 : 0;
-            }
-            registers_set_coil(map->coil_reg, coil_value);
-          }
-          else {
-            // Output to HOLDING REGISTER (multi-register aware)
-            if (var_type == ST_TYPE_BOOL) {
-              // BOOL: 1 register
-              uint16_t reg_value = prog->bytecode.variables[map->st_var_index].bool_val ? 1 : 0;
-              registers_set_holding_register(map->coil_reg, reg_value);
-            }
-            else if (var_type == ST_TYPE_INT) {
-              // INT: 16-bit signed, 1 register
-              int16_t int_value = prog->bytecode.variables[map->st_var_index].int_val;
-              registers_set_holding_register(map->coil_reg, (uint16_t)int_value);
-            }
-            else if (var_type == ST_TYPE_DINT) {
-              // BUG-125 FIX: DINT: 32-bit signed, 2 registers (LSW first, MSW second)
-              int32_t dint_value = prog->bytecode.variables[map->st_var_index].dint_val;
-              uint16_t low_word = (uint16_t)(dint_value & 0xFFFF);
-              uint16_t high_word = (uint16_t)((dint_value >> 16) & 0xFFFF);
-              registers_set_holding_register(map->coil_reg, low_word);      // LSW at base
-              registers_set_holding_register(map->coil_reg + 1, high_word); // MSW at base+1
-            }
-            else if (var_type == ST_TYPE_DWORD) {
-              // BUG-125 FIX: DWORD: 32-bit unsigned, 2 registers (LSW first, MSW second)
-              uint32_t dword_value = prog->bytecode.variables[map->st_var_index].dword_val;
-              uint16_t low_word = (uint16_t)(dword_value & 0xFFFF);
-              uint16_t high_word = (uint16_t)((dword_value >> 16) & 0xFFFF);
-              registers_set_holding_register(map->coil_reg, low_word);      // LSW at base
-              registers_set_holding_register(map->coil_reg + 1, high_word); // MSW at base+1
-            }
-            else if (var_type == ST_TYPE_REAL) {
-              // BUG-125 FIX: REAL: 32-bit float, 2 registers (IEEE 754, LSW first, MSW second)
-              float real_value = prog->bytecode.variables[map->st_var_index].real_val;
-              uint32_t bits;
-              memcpy(&bits, &real_value, sizeof(float));  // Reinterpret float as bits
-              uint16_t low_word = (uint16_t)(bits & 0xFFFF);
-              uint16_t high_word = (uint16_t)((bits >> 16) & 0xFFFF);
-              registers_set_holding_register(map->coil_reg, low_word);      // LSW at base
-              registers_set_holding_register(map->coil_reg + 1, high_word); // MSW at base+1
-            }
-          }
-        }
-
-        st_logic_unlock_variables();
-      }
-    }
+  mapping_plans_update();
+  gpio_mapping_write_gpio();
+
+  if (st_binding_plan.out_count > 0) {
+    static const st_bind_io_t io = { registers_set_coil, registers_set_holding_register };
+
+    // BUG-038 FIX: Lock before reading ST variables (once for the whole list)
+    registers_batch_begin();
+    st_logic_lock_variables();
+    st_binding_plan_run_outputs(&st_binding_plan, &io);
+    st_logic_unlock_variables();
+    registers_batch_end();
   }
 }
 
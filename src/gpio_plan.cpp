@@ -0,0 +1,151 @@
+/**
+ * @file gpio_plan.cpp
+ * @brief Precomputed GPIO mapping plan (v7.9.9.2)
+ *
+ * LAYER 4: Register/Coil Storage (pure logic)
+ */
+
+#include "gpio_plan.h"
+#include <string.h>
+
+static_assert(GPIO_PLAN_SR_OUT_BIT + GPIO_PLAN_SR_OUT_COUNT <= GPIO_PLAN_ZERO_BIT,
+              "GPIO pin image exceeds 63 bits");
+
+#define GPIO_PLAN_NONE  0xFF
+
+uint8_t gpio_plan_pin_bit(uint8_t pin, bool for_output) {
+  if (pin < GPIO_PLAN_PORT_BITS) return pin;
+#ifdef SHIFT_REGISTER_ENABLED
+  // SR inputs can only be read; SR outputs are driven and read back
+  if (!for_output && pin >= VGPIO_SR_INPUT_BASE && pin < VGPIO_SR_INPUT_BASE + VGPIO_SR_INPUT_COUNT) {
+    return GPIO_PLAN_SR_IN_BIT + (pin - VGPIO_SR_INPUT_BASE);
+  }
+  if (pin >= VGPIO_SR_OUTPUT_BASE && pin < VGPIO_SR_OUTPUT_BASE + VGPIO_SR_OUTPUT_COUNT) {
+    return GPIO_PLAN_SR_OUT_BIT + (pin - VGPIO_SR_OUTPUT_BASE);
+  }
+#else
+  (void)for_output;
+#endif
+  return GPIO_PLAN_NONE;
+}
+
+static bool plan_mapping_used(const VariableMapping *map) {
+  if (map->source_type != MAPPING_SOURCE_GPIO) return false;
+  // Counter/timer mappings are handled by their engines
+  return map->associated_counter == 0xff && map->associated_timer == 0xff;
+}
+
+// Extend the last run by one bit, or start a new one
+static void plan_add_bit(gpio_plan_run_t *runs, uint8_t *count, uint8_t byte,
+                         uint8_t reg_bit, uint8_t img_bit) {
+  if (*count > 0) {
+    gpio_plan_run_t *r = &runs[*count - 1];
+    uint8_t len = reg_bit - r->reg_bit;
+    if (r->byte == byte && img_bit != GPIO_PLAN_ZERO_BIT && r->img_bit + len == img_bit &&
+        r->mask == (uint8_t)(((1u << len) - 1) << r->reg_bit)) {
+      r->mask |= (uint8_t)(1u << reg_bit);
+      return;
+    }
+  }
+  if (*count >= GPIO_PLAN_MAX_RUNS) return;
+  gpio_plan_run_t *r = &runs[(*count)++];
+  r->byte = byte;
+  r->reg_bit = reg_bit;
+  r->img_bit = img_bit;
+  r->mask = (uint8_t)(1u << reg_bit);
+}
+
+void gpio_plan_build(gpio_plan_t *plan, const VariableMapping *maps, uint8_t count,
+                     uint64_t irq_pins) {
+  memset(plan, 0, sizeof(*plan));
+  irq_pins &= GPIO_PLAN_PORT_MASK;
+
+  // Inputs: image bit feeding each discrete input (later mappings win)
+  uint8_t di_src[DISCRETE_INPUTS_SIZE * 8];
+  memset(di_src, GPIO_PLAN_NONE, sizeof(di_src));
+
+  // Outputs: coil driving each image bit (later mappings win)
+  uint16_t pin_coil[64];
+  for (uint8_t b = 0; b < 64; b++) pin_coil[b] = 0xFFFF;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const VariableMapping *map = &maps[i];
+    if (!plan_mapping_used(map)) continue;
+
+    if (map->is_input) {
+      if (map->input_reg >= DISCRETE_INPUTS_SIZE * 8) continue;
+      uint8_t bit = gpio_plan_pin_bit(map->gpio_pin, false);
+      di_src[map->input_reg] = (bit == GPIO_PLAN_NONE) ? GPIO_PLAN_ZERO_BIT : bit;
+    } else {
+      if (map->coil_reg == 65535) continue;
+      uint8_t bit = gpio_plan_pin_bit(map->gpio_pin, true);
+      if (bit == GPIO_PLAN_NONE) continue;
+      pin_coil[bit] = map->coil_reg;
+    }
+  }
+
+  for (uint16_t di = 0; di < DISCRETE_INPUTS_SIZE * 8; di++) {
+    uint8_t src = di_src[di];
+    if (src == GPIO_PLAN_NONE) continue;
+    plan->gpio_inputs++;
+    if (src != GPIO_PLAN_ZERO_BIT && (irq_pins & (1ULL << src))) {
+      if (plan->irq_input_count >= GPIO_PLAN_MAX_RUNS) continue;
+      gpio_plan_irq_t *q = &plan->irq_inputs[plan->irq_input_count++];
+      q->pin = src;
+      q->byte = di / 8;
+      q->mask = (uint8_t)(1u << (di % 8));
+      plan->irq_mask |= 1ULL << src;
+      continue;
+    }
+    plan_add_bit(plan->in_runs, &plan->in_run_count, di / 8, di % 8, src);
+    if (src != GPIO_PLAN_ZERO_BIT) plan->in_mask |= 1ULL << src;
+  }
+
+  // Runs are keyed by image bit here; merge while pins and coils both step by one
+  for (uint8_t b = 0; b < 64; b++) {
+    uint16_t coil = pin_coil[b];
+    if (coil == 0xFFFF) continue;
+    plan->out_mask |= 1ULL << b;
+    plan->gpio_outputs++;
+    if (coil >= COILS_SIZE * 8) continue;  // No coil: pin is driven low
+
+    gpio_plan_run_t *r = plan->out_run_count ? &plan->out_runs[plan->out_run_count - 1] : NULL;
+    uint8_t len = r ? (uint8_t)(b - r->img_bit) : 0;
+    if (r && r->byte == coil / 8 && r->reg_bit + len == coil % 8 &&
+        r->mask == (uint8_t)(((1u << len) - 1) << r->reg_bit)) {
+      r->mask |= (uint8_t)(1u << (coil % 8));
+      continue;
+    }
+    if (plan->out_run_count >= GPIO_PLAN_MAX_RUNS) continue;
+    r = &plan->out_runs[plan->out_run_count++];
+    r->byte = coil / 8;
+    r->reg_bit = coil % 8;
+    r->img_bit = b;
+    r->mask = (uint8_t)(1u << (coil % 8));
+  }
+}
+
+void gpio_plan_scatter_inputs(const gpio_plan_t *plan, uint64_t image,
+                              void (*store)(uint8_t byte, uint8_t mask, uint8_t bits)) {
+  uint8_t i = 0;
+  while (i < plan->in_run_count) {
+    // Runs are sorted by byte: combine all runs of one byte into one store
+    uint8_t byte = plan->in_runs[i].byte;
+    uint8_t mask = 0, bits = 0;
+    for (; i < plan->in_run_count && plan->in_runs[i].byte == byte; i++) {
+      const gpio_plan_run_t *r = &plan->in_runs[i];
+      mask |= r->mask;
+      bits |= (uint8_t)(((image >> r->img_bit) << r->reg_bit) & r->mask);
+    }
+    store(byte, mask, bits);
+  }
+}
+
+uint64_t gpio_plan_gather_outputs(const gpio_plan_t *plan, const uint8_t *coils) {
+  uint64_t image = 0;
+  for (uint8_t i = 0; i < plan->out_run_count; i++) {
+    const gpio_plan_run_t *r = &plan->out_runs[i];
+    image |= (uint64_t)((coils[r->byte] & r->mask) >> r->reg_bit) << r->img_bit;
+  }
+  return image;
+}
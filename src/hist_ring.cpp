@@ -0,0 +1,241 @@
+/**
+ * @file hist_ring.cpp
+ * @brief Delta-encoded time-series ring with min/max/avg tiers (v7.9.10.4)
+ *
+ * LAYER 5: Feature Engines - Historian storage (pure data structure)
+ * Deltas are taken in uint64 arithmetic, so any int64 step (counter reset,
+ * register jump) wraps and decodes back exactly.
+ */
+
+#include "hist_ring.h"
+#include <string.h>
+
+#define HIST_VARINT_MAX   10  // LEB128 bytes for 64 bits
+
+const uint32_t hist_tier_period_ms[HIST_TIER_COUNT] = { 0, 60000UL, 600000UL, 3600000UL };
+
+void hist_put_be16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+void hist_put_be32(uint8_t *p, uint32_t v) {
+  hist_put_be16(p, (uint16_t)(v >> 16));
+  hist_put_be16(p + 2, (uint16_t)v);
+}
+
+void hist_put_be64(uint8_t *p, uint64_t v) {
+  hist_put_be32(p, (uint32_t)(v >> 32));
+  hist_put_be32(p + 4, (uint32_t)v);
+}
+
+uint16_t hist_get_be16(const uint8_t *p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+uint32_t hist_get_be32(const uint8_t *p) {
+  return ((uint32_t)hist_get_be16(p) << 16) | hist_get_be16(p + 2);
+}
+
+uint64_t hist_get_be64(const uint8_t *p) {
+  return ((uint64_t)hist_get_be32(p) << 32) | hist_get_be32(p + 4);
+}
+
+static uint8_t put_varint(uint8_t *out, uint64_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+// Encode one record as deltas to last; returns bytes written to out
+static uint8_t encode_record(const int64_t *last, const int64_t *v, uint8_t fields, uint8_t *out) {
+  uint8_t n = 0;
+  for (uint8_t f = 0; f < fields; f++) {
+    int64_t d = (int64_t)((uint64_t)v[f] - (uint64_t)last[f]);
+    n += put_varint(out + n, ((uint64_t)d << 1) ^ (uint64_t)(d >> 63));
+  }
+  return n;
+}
+
+/* ============================================================================
+ * SERIES
+ * ============================================================================ */
+
+bool hist_series_init(HistSeries *s, uint8_t *mem, uint32_t size, uint8_t fields, uint32_t period_ms) {
+  memset(s, 0, sizeof(*s));
+  uint32_t nblocks = size / HIST_BLOCK_SIZE;
+  if (!mem || nblocks < 2 || fields == 0 || fields > HIST_FIELDS_MAX || period_ms == 0) return false;
+  s->mem = mem;
+  s->nblocks = nblocks > 0xFFFF ? 0xFFFF : (uint16_t)nblocks;
+  s->fields = fields;
+  s->period_ms = period_ms;
+  return true;
+}
+
+uint32_t hist_series_tail(const HistSeries *s) {
+  return s->next_seq - s->blocks;
+}
+
+const uint8_t *hist_series_block(const HistSeries *s, uint32_t seq) {
+  if (!s->mem || seq - hist_series_tail(s) >= s->blocks) return NULL;
+  return s->mem + (seq % s->nblocks) * HIST_BLOCK_SIZE;
+}
+
+static uint8_t *open_block(HistSeries *s, uint64_t t0) {
+  if (s->blocks < s->nblocks) {
+    s->blocks++;
+  } else {
+    s->evicted++;  // Slot of the oldest block is reused
+  }
+  uint32_t seq = s->next_seq++;
+  uint8_t *b = s->mem + (seq % s->nblocks) * HIST_BLOCK_SIZE;
+  hist_put_be64(b, t0);
+  hist_put_be32(b + 8, seq);
+  hist_put_be16(b + 12, 0);
+  hist_put_be16(b + 14, 0);
+  memset(s->last, 0, sizeof(s->last));
+  s->next_t = t0;
+  s->open = true;
+  return b;
+}
+
+void hist_series_append(HistSeries *s, uint64_t t_ms, const int64_t *v) {
+  if (!s->mem) return;
+
+  // Continue the open block if t is within half a period of its next slot
+  uint64_t half = s->period_ms / 2;
+  bool cont = s->open && t_ms + half >= s->next_t && t_ms + half < s->next_t + s->period_ms;
+
+  uint8_t rec[HIST_FIELDS_MAX * HIST_VARINT_MAX];
+  uint8_t *b = NULL;
+  uint8_t len = 0;
+  if (cont) {
+    b = s->mem + ((s->next_seq - 1) % s->nblocks) * HIST_BLOCK_SIZE;
+    len = encode_record(s->last, v, s->fields, rec);
+    if (hist_get_be16(b + 14) + len > HIST_BLOCK_PAYLOAD) {
+      b = open_block(s, s->next_t);  // Full: next block continues the same timeline
+    }
+  } else {
+    b = open_block(s, t_ms);
+  }
+  if (hist_get_be16(b + 12) == 0) {
+    len = encode_record(s->last, v, s->fields, rec);  // Block start: absolute values
+  }
+
+  uint16_t used = hist_get_be16(b + 14);
+  memcpy(b + HIST_BLOCK_HDR_SIZE + used, rec, len);
+  hist_put_be16(b + 12, (uint16_t)(hist_get_be16(b + 12) + 1));
+  hist_put_be16(b + 14, (uint16_t)(used + len));
+  memcpy(s->last, v, s->fields * sizeof(int64_t));
+  s->next_t += s->period_ms;
+  s->records++;
+}
+
+/* ============================================================================
+ * POINT (raw + tiers)
+ * ============================================================================ */
+
+bool hist_point_init(HistPoint *p, uint8_t *mem, uint32_t size, uint32_t interval_ms) {
+  memset(p, 0, sizeof(*p));
+  uint32_t total = size / HIST_BLOCK_SIZE;
+  uint32_t tier_blocks[HIST_TIER_COUNT] = { 0 };
+  uint32_t raw_blocks = total;
+  for (uint8_t t = HIST_TIER_1M; t < HIST_TIER_COUNT; t++) {
+    p->agg[t].bucket = UINT64_MAX;
+    if (hist_tier_period_ms[t] <= interval_ms || total / 6 < 2) continue;
+    tier_blocks[t] = total / 6;
+    raw_blocks -= tier_blocks[t];
+  }
+
+  uint8_t *next = mem;
+  bool ok = hist_series_init(&p->tier[HIST_TIER_RAW], next, raw_blocks * HIST_BLOCK_SIZE, 1, interval_ms);
+  next += raw_blocks * HIST_BLOCK_SIZE;
+  for (uint8_t t = HIST_TIER_1M; t < HIST_TIER_COUNT; t++) {
+    if (tier_blocks[t] == 0) continue;
+    hist_series_init(&p->tier[t], next, tier_blocks[t] * HIST_BLOCK_SIZE, 3, hist_tier_period_ms[t]);
+    next += tier_blocks[t] * HIST_BLOCK_SIZE;
+  }
+  return ok;
+}
+
+static int64_t agg_avg(const HistAgg *a) {
+  int64_t n = (int64_t)a->n;
+  return (a->sum >= 0 ? a->sum + n / 2 : a->sum - n / 2) / n;  // Rounded to nearest
+}
+
+void hist_point_sample(HistPoint *p, uint64_t t_ms, int64_t v) {
+  hist_series_append(&p->tier[HIST_TIER_RAW], t_ms, &v);
+
+  for (uint8_t t = HIST_TIER_1M; t < HIST_TIER_COUNT; t++) {
+    HistAgg *a = &p->agg[t];
+    if (!p->tier[t].mem) continue;
+    uint64_t bucket = t_ms - t_ms % hist_tier_period_ms[t];
+    if (bucket != a->bucket) {
+      if (a->n > 0) {
+        int64_t rec[3] = { a->min, a->max, agg_avg(a) };
+        hist_series_append(&p->tier[t], a->bucket, rec);
+      }
+      a->bucket = bucket;
+      a->min = a->max = a->sum = v;
+      a->n = 1;
+      continue;
+    }
+    if (v < a->min) a->min = v;
+    if (v > a->max) a->max = v;
+    a->sum += v;
+    a->n++;
+  }
+}
+
+/* ============================================================================
+ * DECODE
+ * ============================================================================ */
+
+bool hist_block_info(const uint8_t *block, HistBlockInfo *info) {
+  info->t0 = hist_get_be64(block);
+  info->seq = hist_get_be32(block + 8);
+  info->count = hist_get_be16(block + 12);
+  info->used = hist_get_be16(block + 14);
+  if (info->used > HIST_BLOCK_PAYLOAD || info->count > info->used) return false;
+  return (info->count == 0) == (info->used == 0);
+}
+
+uint64_t hist_block_end(const HistBlockInfo *info, uint32_t period_ms) {
+  return info->t0 + (uint64_t)(info->count ? info->count - 1 : 0) * period_ms;
+}
+
+int32_t hist_block_decode(const uint8_t *block, uint8_t fields, uint32_t period_ms,
+                          uint64_t from, uint64_t to, hist_record_fn fn, void *ctx) {
+  HistBlockInfo info;
+  if (fields == 0 || fields > HIST_FIELDS_MAX || !hist_block_info(block, &info)) return -1;
+
+  const uint8_t *data = block + HIST_BLOCK_HDR_SIZE;
+  uint32_t pos = 0;
+  int64_t cur[HIST_FIELDS_MAX] = { 0 };
+  int32_t emitted = 0;
+  for (uint16_t i = 0; i < info.count; i++) {
+    for (uint8_t f = 0; f < fields; f++) {
+      uint64_t z = 0;
+      uint8_t shift = 0;
+      uint8_t byte;
+      do {
+        if (pos >= info.used || shift >= 64) return -1;
+        byte = data[pos++];
+        z |= (uint64_t)(byte & 0x7F) << shift;
+        shift += 7;
+      } while (byte & 0x80);
+      int64_t d = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+      cur[f] = (int64_t)((uint64_t)cur[f] + (uint64_t)d);
+    }
+    uint64_t t = info.t0 + (uint64_t)i * period_ms;
+    if (t > to) return emitted;  // Records are in time order
+    if (t < from) continue;
+    emitted++;
+    if (!fn(ctx, t, cur)) return emitted;
+  }
+  return pos == info.used ? emitted : -1;
+}
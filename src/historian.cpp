@@ -0,0 +1,513 @@
+/**
+ * @file historian.cpp
+ * @brief On-device historian for registers and counters (v7.9.10.4)
+ *
+ * LAYER 5: Feature Engines - Historian
+ * loop() samples and the HTTP task reads, both under hist_mutex; a reader
+ * only holds it for one 128 byte block copy. Spill files are written by the
+ * persist writer task; their header tells a query which boot/configuration
+ * wrote them, so blocks that are still in RAM are not returned twice.
+ */
+
+#include "historian.h"
+#include "constants.h"
+#include "config_struct.h"
+#include "registers.h"
+#include "counter_engine.h"
+#include "ntp_driver.h"
+#include "persist_writer.h"
+#include "fs_mount.h"
+#include "fs_store.h"
+#include "debug.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <sys/time.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIST_SPILL_VERSION    1
+#define HIST_SPILL_FILE_SIZE  (HISTORIAN_SPILL_HDR_SIZE + HISTORIAN_SPILL_BLOCKS * HIST_BLOCK_SIZE)
+
+typedef struct {
+  HistPointConfig cfg;
+  bool     sampling;
+  uint32_t due_ms;            // millis() of the next sample
+  int64_t  last_value;
+  uint8_t  spill_slots;       // File slots, 0 = spill off
+  uint8_t  spill_files;       // Slots holding a file of this point
+  bool     spill_failed;      // A write failed: no more spill until the next apply
+  uint32_t spill_next;        // First raw block not submitted yet
+  uint32_t spill_segno;       // Number of the next spill file
+} HistPointState;
+
+static SemaphoreHandle_t hist_mutex = NULL;
+static uint8_t *hist_pool = NULL;
+static HistPoint hist_points[HIST_MAX_POINTS];
+static HistPointState hist_state[HIST_MAX_POINTS];
+static HistorianStats hist_stats;
+static uint32_t hist_generation = 0;   // Bumped by every apply
+static uint32_t hist_boot_id = 0;      // Random per boot
+
+// hist_mutex is created by historian_init() from setup(), before the HTTP
+// server and any spill job can call in
+static void hist_lock(void) {
+  xSemaphoreTake(hist_mutex, portMAX_DELAY);
+}
+
+static void hist_unlock(void) {
+  xSemaphoreGive(hist_mutex);
+}
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+const char *historian_source_name(uint8_t source) {
+  switch (source) {
+    case HIST_SRC_HR:       return "hr";
+    case HIST_SRC_IR:       return "ir";
+    case HIST_SRC_COUNTER:  return "counter";
+    default:                return "off";
+  }
+}
+
+bool historian_source_parse(const char *name, uint8_t *out) {
+  if (!name) return false;
+  for (uint8_t src = HIST_SRC_OFF; src <= HIST_SRC_COUNTER; src++) {
+    if (!strcmp(name, historian_source_name(src))) {
+      *out = src;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *historian_point_check(const HistPointConfig *pc) {
+  switch (pc->source) {
+    case HIST_SRC_OFF:
+      return NULL;
+    case HIST_SRC_HR:
+      if (pc->address >= HOLDING_REGS_SIZE) return "holding register out of range";
+      break;
+    case HIST_SRC_IR:
+      if (pc->address >= INPUT_REGS_SIZE) return "input register out of range";
+      break;
+    case HIST_SRC_COUNTER:
+      if (pc->address < 1 || pc->address > COUNTER_COUNT) return "counter id must be 1-4";
+      break;
+    default:
+      return "unknown source";
+  }
+  if (pc->interval_ms < HIST_MIN_INTERVAL_MS || pc->interval_ms > HIST_MAX_INTERVAL_MS) {
+    return "interval must be 100 ms - 1 h";
+  }
+  return NULL;
+}
+
+uint64_t historian_now_ms(void) {
+  if (ntp_driver_is_synced()) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000ULL + (uint64_t)(tv.tv_usec / 1000);
+  }
+  return (uint64_t)(esp_timer_get_time() / 1000);
+}
+
+static int64_t read_source(const HistPointConfig *pc) {
+  switch (pc->source) {
+    case HIST_SRC_HR:       return registers_get_holding_register(pc->address);
+    case HIST_SRC_IR:       return registers_get_input_register(pc->address);
+    case HIST_SRC_COUNTER:  return (int64_t)counter_engine_get_value((uint8_t)pc->address);
+    default:                return 0;
+  }
+}
+
+/* ============================================================================
+ * SPILL FILES
+ *
+ * Header (big-endian): [0..1] 'H','S'  [2] version  [3] point  [4] source
+ * [5] blocks  [6..7] address  [8..11] interval ms  [12..15] file number
+ * [16..19] boot id  [20..23] generation; then the raw blocks.
+ * ============================================================================ */
+
+static void spill_name(char *out, uint8_t point, uint8_t slot) {
+  snprintf(out, FS_NAME_MAX, "/hist_%u_%u.bin", point, slot);
+}
+
+static bool spill_header_matches(const uint8_t *h, uint8_t point, const HistPointConfig *pc) {
+  return h[0] == 'H' && h[1] == 'S' && h[2] == HIST_SPILL_VERSION && h[3] == point &&
+         h[4] == pc->source && h[5] == HISTORIAN_SPILL_BLOCKS &&
+         hist_get_be16(h + 6) == pc->address && hist_get_be32(h + 8) == pc->interval_ms;
+}
+
+static bool spill_read_header(uint8_t point, uint8_t slot, uint8_t *h) {
+  char name[FS_NAME_MAX];
+  spill_name(name, point, slot);
+  FsReader r;
+  if (!fs_read_open(&r, name)) return false;
+  bool ok = fs_read(&r, h, HISTORIAN_SPILL_HDR_SIZE) == HISTORIAN_SPILL_HDR_SIZE;
+  fs_read_close(&r);
+  return ok;
+}
+
+// Writer task: one spill file, atomically replacing the slot's previous file
+static bool spill_exec(uint16_t key, void *data, uint32_t len) {
+  (void)key;
+  const uint8_t *h = (const uint8_t *)data;
+  uint8_t point = h[3];
+  uint32_t segno = hist_get_be32(h + 12);
+
+  hist_lock();
+  bool current = hist_get_be32(h + 20) == hist_generation && hist_state[point].spill_slots > 0;
+  uint8_t slot = current ? (uint8_t)(segno % hist_state[point].spill_slots) : 0;
+  hist_unlock();
+  if (!current) return true;  // Reconfigured since: the blocks are gone anyway
+
+  char name[FS_NAME_MAX];
+  spill_name(name, point, slot);
+  bool ok = fs_mount();
+  bool is_new = ok && !fs_exists(name);
+  if (ok && is_new) {
+    FsMountInfo info;
+    fs_mount_info(&info);
+    ok = info.total_bytes > info.used_bytes + len + HISTORIAN_SPILL_RESERVE;
+  }
+  ok = ok && fs_write_file(name, data, len);
+
+  hist_lock();
+  if (ok) {
+    hist_stats.spill_files++;
+    hist_stats.spill_bytes += len;
+    if (is_new && hist_get_be32(h + 20) == hist_generation) hist_state[point].spill_files++;
+  } else {
+    hist_stats.spill_errors++;
+    if (hist_get_be32(h + 20) == hist_generation) hist_state[point].spill_failed = true;
+  }
+  hist_unlock();
+  return ok;
+}
+
+// Main loop: hand every HISTORIAN_SPILL_BLOCKS sealed raw blocks to the writer
+static void spill_check(uint8_t point) {
+  HistPointState *st = &hist_state[point];
+  HistSeries *raw = &hist_points[point].tier[HIST_TIER_RAW];
+  if (st->spill_slots == 0 || st->spill_failed) return;
+
+  hist_lock();
+  uint32_t tail = hist_series_tail(raw);
+  if ((int32_t)(st->spill_next - tail) < 0) {
+    hist_stats.spill_dropped += tail - st->spill_next;
+    st->spill_next = tail;
+  }
+  // The newest block is still open
+  bool ready = raw->next_seq - st->spill_next > HISTORIAN_SPILL_BLOCKS;
+  hist_unlock();
+  if (!ready) return;
+
+  uint8_t *buf = (uint8_t *)persist_writer_alloc(HIST_SPILL_FILE_SIZE);
+  if (!buf) {
+    hist_stats.spill_errors++;
+    return;
+  }
+  memset(buf, 0, HISTORIAN_SPILL_HDR_SIZE);
+  buf[0] = 'H';
+  buf[1] = 'S';
+  buf[2] = HIST_SPILL_VERSION;
+  buf[3] = point;
+  buf[4] = st->cfg.source;
+  buf[5] = HISTORIAN_SPILL_BLOCKS;
+  hist_put_be16(buf + 6, st->cfg.address);
+  hist_put_be32(buf + 8, st->cfg.interval_ms);
+  hist_put_be32(buf + 12, st->spill_segno);
+  hist_put_be32(buf + 16, hist_boot_id);
+
+  hist_lock();
+  hist_put_be32(buf + 20, hist_generation);
+  for (uint32_t i = 0; i < HISTORIAN_SPILL_BLOCKS; i++) {
+    memcpy(buf + HISTORIAN_SPILL_HDR_SIZE + i * HIST_BLOCK_SIZE,
+           hist_series_block(raw, st->spill_next + i), HIST_BLOCK_SIZE);
+  }
+  hist_unlock();
+
+  uint16_t key = PW_KEY_HISTORY(point, st->spill_segno);
+  st->spill_next += HISTORIAN_SPILL_BLOCKS;
+  st->spill_segno++;
+  if (!persist_writer_submit_owned(key, spill_exec, buf, HIST_SPILL_FILE_SIZE, NULL, NULL)) {
+    hist_stats.spill_errors++;
+  }
+}
+
+// Remove files of other configurations, find the next file number per point
+static void spill_scan(const HistorianConfig *cfg, uint32_t generation) {
+  if (!fs_mount()) return;
+
+  // The ST sources must still be replaceable when the spill budget is full
+  FsMountInfo info;
+  fs_mount_info(&info);
+  uint32_t room = info.total_bytes > HISTORIAN_SPILL_RESERVE ? info.total_bytes - HISTORIAN_SPILL_RESERVE : 0;
+  uint32_t quota = (uint32_t)cfg->spill_kb * 1024;
+  if (quota > room) {
+    debug_printf("HISTORIAN: spill %u KB begraenset til %lu KB (%lu KB LittleFS, %lu KB reserveret til ST)\n",
+                 cfg->spill_kb, (unsigned long)(room / 1024), (unsigned long)(info.total_bytes / 1024),
+                 (unsigned long)(HISTORIAN_SPILL_RESERVE / 1024));
+    quota = room;
+  }
+
+  uint8_t slots = 0;
+  uint8_t sampling = 0;
+  for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+    if (hist_state[p].sampling) sampling++;
+  }
+  if (quota > 0 && sampling > 0) {
+    uint32_t n = quota / sampling / HIST_SPILL_FILE_SIZE;
+    slots = n > HISTORIAN_SPILL_MAX_FILES ? HISTORIAN_SPILL_MAX_FILES : (uint8_t)n;
+  }
+  hist_lock();
+  if (generation == hist_generation) hist_stats.spill_quota = slots ? quota : 0;
+  hist_unlock();
+
+  for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+    bool keep_point = hist_state[p].sampling && slots > 0;
+    uint8_t files = 0;
+    uint32_t next = 0;
+    for (uint8_t s = 0; s < HISTORIAN_SPILL_MAX_FILES; s++) {
+      char name[FS_NAME_MAX];
+      spill_name(name, p, s);
+      if (!fs_exists(name)) continue;
+      uint8_t h[HISTORIAN_SPILL_HDR_SIZE];
+      if (keep_point && s < slots && spill_read_header(p, s, h) &&
+          spill_header_matches(h, p, &hist_state[p].cfg)) {
+        uint32_t segno = hist_get_be32(h + 12);
+        if (files == 0 || segno + 1 > next) next = segno + 1;
+        files++;
+      } else {
+        fs_remove(name);
+      }
+    }
+    hist_lock();
+    if (generation == hist_generation && hist_state[p].sampling) {
+      hist_state[p].spill_slots = keep_point ? slots : 0;
+      hist_state[p].spill_files = files;
+      hist_state[p].spill_segno = next;
+    }
+    hist_unlock();
+  }
+}
+
+/* ============================================================================
+ * LIFECYCLE
+ * ============================================================================ */
+
+bool historian_apply(const HistorianConfig *cfg) {
+  hist_lock();
+  uint32_t generation = ++hist_generation;
+  if (hist_boot_id == 0) hist_boot_id = esp_random() | 1;
+  if (hist_pool) heap_caps_free(hist_pool);
+  hist_pool = NULL;
+  memset(hist_points, 0, sizeof(hist_points));
+  memset(hist_state, 0, sizeof(hist_state));
+  hist_stats.active = false;
+  hist_stats.psram = false;
+  hist_stats.pool_bytes = 0;
+  hist_stats.points = 0;
+  hist_stats.samples = 0;
+  hist_stats.late = 0;
+  hist_stats.spill_quota = 0;
+
+  uint8_t count = 0;
+  for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+    hist_state[p].cfg = cfg->points[p];
+    if (cfg->enabled && cfg->points[p].source != HIST_SRC_OFF &&
+        historian_point_check(&cfg->points[p]) == NULL) {
+      hist_state[p].sampling = true;
+      count++;
+    }
+  }
+
+  if (count > 0) {
+    uint32_t size = HISTORIAN_POOL_PSRAM;
+    hist_pool = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    hist_stats.psram = hist_pool != NULL;
+    if (!hist_pool) {
+      size = HISTORIAN_POOL_DRAM;
+      hist_pool = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    if (hist_pool) {
+      uint32_t share = (size / count) / HIST_BLOCK_SIZE * HIST_BLOCK_SIZE;
+      uint8_t *next = hist_pool;
+      uint32_t now = millis();
+      for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+        if (!hist_state[p].sampling) continue;
+        hist_state[p].sampling = hist_point_init(&hist_points[p], next, share, hist_state[p].cfg.interval_ms);
+        hist_state[p].due_ms = now;
+        next += share;
+        if (hist_state[p].sampling) hist_stats.points++;
+      }
+      hist_stats.pool_bytes = size;
+      hist_stats.active = hist_stats.points > 0;
+    } else {
+      debug_println("HISTORIAN: ingen hukommelse til pool - sampling stoppet");
+      for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) hist_state[p].sampling = false;
+    }
+  }
+  bool active = hist_stats.active;
+  hist_unlock();
+
+  spill_scan(cfg, generation);
+  return active;
+}
+
+void historian_init(void) {
+  if (hist_mutex == NULL) hist_mutex = xSemaphoreCreateMutex();
+  historian_apply(&g_persist_config.historian);
+}
+
+void historian_loop(void) {
+  if (!hist_stats.active) return;
+
+  uint32_t now = millis();
+  uint64_t t_ms = 0;
+  bool have_t = false;
+  for (uint8_t p = 0; p < HIST_MAX_POINTS; p++) {
+    HistPointState *st = &hist_state[p];
+    if (!st->sampling || (int32_t)(now - st->due_ms) < 0) continue;
+    if (!have_t) {
+      t_ms = historian_now_ms();
+      have_t = true;
+    }
+
+    int64_t v = read_source(&st->cfg);
+    hist_lock();
+    hist_point_sample(&hist_points[p], t_ms, v);
+    hist_unlock();
+    st->last_value = v;
+    hist_stats.samples++;
+
+    // Missed slots are skipped, not caught up: the gap opens a new block
+    st->due_ms += st->cfg.interval_ms;
+    if ((int32_t)(now - st->due_ms) >= 0) {
+      hist_stats.late += (now - st->due_ms) / st->cfg.interval_ms + 1;
+      st->due_ms = now + st->cfg.interval_ms;
+    }
+    spill_check(p);
+  }
+}
+
+/* ============================================================================
+ * STATUS AND QUERY
+ * ============================================================================ */
+
+bool historian_point_status(uint8_t point, HistorianPointStatus *out) {
+  if (point >= HIST_MAX_POINTS) return false;
+  memset(out, 0, sizeof(*out));
+  hist_lock();
+  const HistPointState *st = &hist_state[point];
+  out->cfg = st->cfg;
+  out->sampling = st->sampling;
+  out->last_value = st->last_value;
+  out->spill_slots = st->spill_slots;
+  out->spill_files = st->spill_files;
+  for (uint8_t t = 0; t < HIST_TIER_COUNT && st->sampling; t++) {
+    const HistSeries *s = &hist_points[point].tier[t];
+    out->capacity[t] = s->mem ? s->nblocks : 0;
+    out->blocks[t] = s->blocks;
+    out->records[t] = s->records;
+    HistBlockInfo info;
+    const uint8_t *oldest = hist_series_block(s, hist_series_tail(s));
+    if (oldest && hist_block_info(oldest, &info) && info.count > 0) out->oldest_ms[t] = info.t0;
+    if (s->open && s->next_t >= s->period_ms) out->newest_ms[t] = s->next_t - s->period_ms;
+  }
+  hist_unlock();
+  return true;
+}
+
+static bool block_overlaps(const uint8_t *block, uint32_t period_ms, uint64_t from, uint64_t to) {
+  HistBlockInfo info;
+  if (!hist_block_info(block, &info) || info.count == 0) return false;
+  return info.t0 <= to && hist_block_end(&info, period_ms) >= from;
+}
+
+uint32_t historian_query(uint8_t point, uint8_t tier, uint64_t from, uint64_t to,
+                         historian_block_fn fn, void *ctx) {
+  if (point >= HIST_MAX_POINTS || tier >= HIST_TIER_COUNT) return 0;
+
+  hist_lock();
+  const HistSeries *s = &hist_points[point].tier[tier];
+  bool usable = hist_state[point].sampling && s->mem != NULL;
+  HistPointConfig cfg = hist_state[point].cfg;
+  uint8_t slots = tier == HIST_TIER_RAW ? hist_state[point].spill_slots : 0;
+  uint32_t period = s->period_ms;
+  uint32_t seq = hist_series_tail(s);
+  uint32_t end = s->next_seq;
+  uint32_t generation = hist_generation;
+  hist_stats.queries++;
+  hist_unlock();
+  if (!usable) return 0;
+
+  uint8_t block[HIST_BLOCK_SIZE];
+  uint32_t sent = 0;
+  bool go_on = true;
+
+  // Spill files, oldest first; blocks of this run from seq on are in RAM
+  if (slots > 0 && fs_mount()) {
+    uint32_t segnos[HISTORIAN_SPILL_MAX_FILES];
+    uint8_t order[HISTORIAN_SPILL_MAX_FILES];
+    uint8_t files = 0;
+    for (uint8_t sl = 0; sl < slots; sl++) {
+      uint8_t h[HISTORIAN_SPILL_HDR_SIZE];
+      if (!spill_read_header(point, sl, h) || !spill_header_matches(h, point, &cfg)) continue;
+      uint32_t segno = hist_get_be32(h + 12);
+      uint8_t i = files++;
+      while (i > 0 && segnos[i - 1] > segno) {  // Insertion sort by file number
+        segnos[i] = segnos[i - 1];
+        order[i] = order[i - 1];
+        i--;
+      }
+      segnos[i] = segno;
+      order[i] = sl;
+    }
+    for (uint8_t f = 0; f < files && go_on; f++) {
+      char name[FS_NAME_MAX];
+      spill_name(name, point, order[f]);
+      FsReader r;
+      uint8_t h[HISTORIAN_SPILL_HDR_SIZE];
+      if (!fs_read_open(&r, name)) continue;
+      if (fs_read(&r, h, sizeof(h)) == sizeof(h) && spill_header_matches(h, point, &cfg)) {
+        bool this_run = hist_get_be32(h + 16) == hist_boot_id && hist_get_be32(h + 20) == generation;
+        while (go_on && fs_read(&r, block, sizeof(block)) == sizeof(block)) {
+          HistBlockInfo info;
+          if (!hist_block_info(block, &info)) break;
+          if (this_run && (int32_t)(info.seq - seq) >= 0) break;
+          if (!block_overlaps(block, period, from, to)) continue;
+          sent++;
+          go_on = fn(ctx, block);
+        }
+      }
+      fs_read_close(&r);
+    }
+  }
+
+  // RAM, one block copy per lock
+  for (; seq != end && go_on; seq++) {
+    hist_lock();
+    const uint8_t *b = generation == hist_generation ? hist_series_block(s, seq) : NULL;
+    if (b) memcpy(block, b, sizeof(block));
+    hist_unlock();
+    if (!b || !block_overlaps(block, period, from, to)) continue;
+    sent++;
+    go_on = fn(ctx, block);
+  }
+
+  hist_lock();
+  hist_stats.query_blocks += sent;
+  hist_unlock();
+  return sent;
+}
+
+const HistorianStats *historian_get_stats(void) {
+  return &hist_stats;
+}
@@ -110,6 +110,7 @@ extern esp_err_t api_handler_ir_bulk_read(httpd_req_t *req);
 extern esp_err_t api_handler_coils_bulk_read(httpd_req_t *req);
 extern esp_err_t api_handler_coils_bulk_write(httpd_req_t *req);
 extern esp_err_t api_handler_di_bulk_read(httpd_req_t *req);
+extern esp_err_t api_handler_registers_multi(httpd_req_t *req);
 extern esp_err_t api_handler_logic_debug(httpd_req_t *req);
 extern esp_err_t api_handler_heartbeat(httpd_req_t *req);
 extern esp_err_t api_handler_cors_preflight(httpd_req_t *req);
@@ -508,6 +509,26 @@ static const httpd_uri_t uri_ntp_post = {
   .user_ctx = NULL
 };
 
+// FEAT-173: Historian (v7.9.10.4)
+static const httpd_uri_t uri_history_get = {
+  .uri      = "/api/history",
+  .method   = HTTP_GET,
+  .handler  = api_handler_history_get,
+  .user_ctx = NULL
+};
+static const httpd_uri_t uri_history_post = {
+  .uri      = "/api/history",
+  .method   = HTTP_POST,
+  .handler  = api_handler_history_post,
+  .user_ctx = NULL
+};
+static const httpd_uri_t uri_history_point_get = {
+  .uri      = "/api/history/*",
+  .method   = HTTP_GET,
+  .handler  = api_handler_history_point_get,
+  .user_ctx = NULL
+};
+
 // FEAT-024: Hostname
 static const httpd_uri_t uri_hostname_get = {
   .uri      = "/api/hostname",
@@ -567,6 +588,13 @@ static const httpd_uri_t uri_di_bulk_read = {
   .handler  = api_handler_di_bulk_read,
   .user_ctx = NULL
 };
+// FEAT-152: Multi-range register snapshot
+static const httpd_uri_t uri_registers_multi = {
+  .uri      = "/api/registers/multi",
+  .method   = HTTP_GET,
+  .handler  = api_handler_registers_multi,
+  .user_ctx = NULL
+};
 
 // FEAT-020: ST Logic Debug — routed via suffix in logic_single handler, no extra URIs needed
 
@@ -607,6 +635,22 @@ static const httpd_uri_t uri_user_me = {
   .user_ctx = NULL
 };
 
+// FEAT-153: Session tokens
+extern esp_err_t api_handler_auth_login(httpd_req_t *req);
+extern esp_err_t api_handler_auth_logout(httpd_req_t *req);
+static const httpd_uri_t uri_auth_login = {
+  .uri      = "/api/auth/login",
+  .method   = HTTP_POST,
+  .handler  = api_handler_auth_login,
+  .user_ctx = NULL
+};
+static const httpd_uri_t uri_auth_logout = {
+  .uri      = "/api/auth/logout",
+  .method   = HTTP_POST,
+  .handler  = api_handler_auth_logout,
+  .user_ctx = NULL
+};
+
 // v7.3.1: Web CLI + Bindings + Monitor
 extern esp_err_t api_handler_cli_exec(httpd_req_t *req);
 extern esp_err_t api_handler_bindings_list(httpd_req_t *req);
@@ -878,7 +922,7 @@ int http_server_start(const HttpConfig *config)
     // Plain HTTP mode
     httpd_config_t httpd_config = HTTPD_DEFAULT_CONFIG();
     httpd_config.server_port = config->port;
-    httpd_config.max_uri_handlers = 96;
+    httpd_config.max_uri_handlers = 104;
     httpd_config.stack_size = 8192;
     httpd_config.uri_match_fn = httpd_uri_match_wildcard;
     httpd_config.lru_purge_enable = true;  // BUG-241: Auto-close idle keep-alive connections to reduce heap fragmentation
@@ -915,6 +959,7 @@ int http_server_start(const HttpConfig *config)
   httpd_register_uri_handler(http_state.server, &uri_coils_bulk_read);
   httpd_register_uri_handler(http_state.server, &uri_coils_bulk_write);
   httpd_register_uri_handler(http_state.server, &uri_di_bulk_read);
+  httpd_register_uri_handler(http_state.server, &uri_registers_multi);
   // Registers (single, wildcard)
   httpd_register_uri_handler(http_state.server, &uri_hr_read);
   httpd_register_uri_handler(http_state.server, &uri_hr_write);
@@ -967,6 +1012,10 @@ int http_server_start(const HttpConfig *config)
   // v7.8.1: NTP API
   httpd_register_uri_handler(http_state.server, &uri_ntp_get);
   httpd_register_uri_handler(http_state.server, &uri_ntp_post);
+  // v7.9.10.4: FEAT-173 Historian
+  httpd_register_uri_handler(http_state.server, &uri_history_get);
+  httpd_register_uri_handler(http_state.server, &uri_history_post);
+  httpd_register_uri_handler(http_state.server, &uri_history_point_get);
   // v6.3.0: FEAT-024 Hostname
   httpd_register_uri_handler(http_state.server, &uri_hostname_get);
   httpd_register_uri_handler(http_state.server, &uri_hostname_post);
@@ -1003,6 +1052,8 @@ int http_server_start(const HttpConfig *config)
   // v7.2.3: Web-based ST Logic editor (served outside /api/ namespace)
   // v7.3.1: Web CLI + Bindings
   httpd_register_uri_handler(http_state.server, &uri_user_me);
+  httpd_register_uri_handler(http_state.server, &uri_auth_login);
+  httpd_register_uri_handler(http_state.server, &uri_auth_logout);
   httpd_register_uri_handler(http_state.server, &uri_cli_exec);
   httpd_register_uri_handler(http_state.server, &uri_bindings_list);
   httpd_register_uri_handler(http_state.server, &uri_bindings_delete);
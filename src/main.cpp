@@ -34,11 +34,17 @@
 #include "ir_pool_manager.h"  // v5.1.0 - IR pool management
 #include "network_manager.h"
 #include "watchdog_monitor.h"
+#include "boot_trace.h"          // v7.9.10.0 - boot timeline profiler
 #include "register_allocator.h"
 #include "registers_persist.h"
+#include "warm_retain.h"         // v7.9.10.2 - warm restart retention
+#include "historian.h"           // v7.9.10.4 - on-device historian
+#include "persist_writer.h"      // v7.9.9.6 - async flash writes
+#include "fs_mount.h"             // v7.9.10.3 - LittleFS mount
 #include "sse_events.h"        // v7.0.0 - SSE real-time events
 #include "ntp_driver.h"        // v7.8.1 - NTP time synchronization
 #include "mb_async.h"          // v7.7.0 - Async Modbus Master background task
+#include <esp_system.h>        // esp_reset_reason()
 #include <esp_ota_ops.h>       // v7.5.0 - FEAT-031 OTA boot validation
 
 // ============================================================================
@@ -47,23 +53,62 @@
 
 Console *g_serial_console = NULL;  // Used by cli_commands.cpp to detect Serial vs Telnet
 
+// ============================================================================
+// BOOT PHASE TIMING (v7.9.9.9, boot_trace v7.9.10.0)
+// ============================================================================
+
+// Record the end of a phase in the boot timeline and print its duration
+static void boot_phase_done(const char *phase) {
+  uint32_t us = boot_trace_mark(phase);
+  Serial.printf("  [boot] %-10s %7lu us  (t=%lu ms)\n", phase,
+                (unsigned long)us, (unsigned long)(micros() / 1000));
+}
+
+// Restart after a crash or watchdog: nobody is at the console, skip the waits.
+// Only if the previous boot reached ready - a crash during boot (e.g. a bad
+// config) keeps the SPACE abort so the USB console can still be recovered.
+static bool boot_unattended(void) {
+  const BootTrace *prev = boot_trace_previous();
+  if (!prev || !prev->ready) return false;
+
+  switch (esp_reset_reason()) {
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+      return true;
+    default:
+      return false;
+  }
+}
+
 // ============================================================================
 // SETUP
 // ============================================================================
 
 void setup() {
+  boot_trace_begin();
+
   // Disable brownout detector (38-pin boards with weak USB power)
   WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
 
   // Initialize serial ports
   Serial.begin(SERIAL_BAUD_DEBUG);      // USB debug (UART0)
-  delay(1000);  // Wait for serial monitor
+  if (!boot_unattended()) {
+    delay(1000);  // Wait for serial monitor
+  }
 
   Serial.printf("=== Modbus RTU Server (ESP32) ===\n");
   Serial.printf("Version: %s Build #%d\n", PROJECT_VERSION, BUILD_NUMBER);
   Serial.printf("Built: %s\n", BUILD_TIMESTAMP);
   Serial.printf("Git: %s@%s\n", GIT_BRANCH, GIT_HASH);
   Serial.println("");
+  const BootTrace *prev_boot = boot_trace_previous();
+  if (prev_boot && !prev_boot->ready) {
+    Serial.printf("BOOT: Forrige opstart naaede ikke ready (sidste fase: %s)\n",
+                  prev_boot->phase_count ? prev_boot->phases[prev_boot->phase_count - 1].name : "-");
+  }
+  boot_phase_done("serial");
 
   // Initialize NVS flash (for configuration persistence)
   esp_err_t err = nvs_flash_init();
@@ -75,6 +120,13 @@ void setup() {
   }
   ESP_ERROR_CHECK(err);
   Serial.println("NVS: Initialized");
+  boot_phase_done("nvs");
+
+  fs_mount_init();  // Lock only; mounting stays lazy
+
+  // Start the flash writer task before anything can save (v7.9.9.6)
+  Serial.print("Persist writer: ");
+  Serial.println(persist_writer_init() ? "OK" : "synchronous");
 
   // Initialize watchdog monitor (v4.0+)
   Serial.print("Watchdog: ");
@@ -85,6 +137,7 @@ void setup() {
   Serial.print("Config: Loading... ");
   config_load_from_nvs(&g_persist_config);
   Serial.println("OK");
+  boot_phase_done("config");
 
   // Initialize hardware drivers
   Serial.print("GPIO: ");
@@ -93,6 +146,7 @@ void setup() {
   Serial.print("UART: ");
   uart_driver_init();       // UART0/UART1 initialization
   Serial.println("OK");
+  boot_phase_done("drivers");
 
   // Initialize subsystems (with default configs)
   // Granular boot diagnostics: each letter = one subsystem initialized
@@ -147,24 +201,36 @@ void setup() {
   Serial.print("S"); Serial.flush();   // SSE
   sse_init();               // SSE real-time events (v7.0.0)
   Serial.println(" OK");
+  boot_phase_done("subsystems");
 
   // Load ST Logic programs from persistent config
   Serial.print("ST Logic: ");
   st_logic_load_from_persist_config(&g_persist_config);
-  Serial.println("OK");
+  st_logic_engine_state_t *logic_boot = st_logic_get_state();
+  Serial.printf("OK (%u from cache without source, %u compiled)\n",
+                logic_boot->boot_cached, logic_boot->boot_compiled);
+  boot_phase_done("st_logic");
 
   // v5.1.0 - Reallocate IR pool for loaded programs (based on EXPORT flags in bytecode)
   ir_pool_reallocate_all(st_logic_get_state());
+  boot_phase_done("ir_pool");
 
   // Apply loaded configuration (MUST be after subsystem init to override defaults)
   config_apply(&g_persist_config);
+  boot_phase_done("apply");
 
   // Initialize global register allocator (BUG-025 fix for v4.2.0)
   // This must be AFTER config_apply() so all subsystems are configured
   register_allocator_init();
 
+#if DEBUG_BOOT_ALLOCATOR_DUMP
   // DEBUG: Dump allocation map to see what's allocated at boot
   register_allocator_debug_dump();
+#endif
+  boot_phase_done("allocator");
+
+  // Latest group values from the persist journal override PersistConfig (v7.9.9.5)
+  registers_persist_journal_init();
 
   // Auto-load persistent register groups if enabled (v4.3.0)
   uint8_t auto_loaded = registers_persist_auto_load_execute();
@@ -173,6 +239,29 @@ void setup() {
     Serial.print(auto_loaded);
     Serial.println(" persistent register group(s) from NVS");
   }
+  boot_phase_done("persist");
+
+  // Warm restart: state mirrored in no-init RAM is newer than NVS (v7.9.10.2)
+  if (warm_retain_restore()) {
+    const WarmRetainStats *wr = warm_retain_get_stats();
+    Serial.printf("Warm restart: runtime state genskabt (%lu bytes, %lu us, %u ST-programmer",
+                  (unsigned long)wr->restore_bytes, (unsigned long)wr->restore_us, wr->programs);
+    if (wr->programs_skipped) Serial.printf(", %u aendret - ikke genskabt", wr->programs_skipped);
+    Serial.println(")");
+  } else if (warm_retain_get_stats()->crash_skipped) {
+    Serial.printf("Warm restart: %u panic/WDT-resets i traek - runtime state IKKE genskabt (starter fra NVS)\n",
+                  warm_retain_get_stats()->crash_streak);
+  }
+  boot_phase_done("retain");
+
+  // Historian: sample configured registers/counters into the trend ring (v7.9.10.4)
+  historian_init();
+  const HistorianStats *hs = historian_get_stats();
+  if (hs->active) {
+    Serial.printf("Historian: %u punkter, %lu KB %s\n", hs->points,
+                  (unsigned long)(hs->pool_bytes / 1024), hs->psram ? "PSRAM" : "DRAM");
+  }
+  boot_phase_done("historian");
 
   Serial.println("\nSetup complete.");
   Serial.println("Modbus RTU Server ready on UART1 (GPIO4/5, 9600 baud)");
@@ -207,11 +296,17 @@ void setup() {
   } else {
     Serial.println("ERROR: Failed to initialize network manager");
   }
+  boot_phase_done("network");
 
   // ES32D26: Deferred Modbus Master UART activation
   // GPIO1/3 shares USB serial with RS485 — give user chance to abort
 #if MODBUS_SINGLE_TRANSCEIVER
-  if (mb_mode == MODBUS_MODE_MASTER) {
+  if (mb_mode == MODBUS_MODE_MASTER && boot_unattended()) {
+    // Restart after a crash: take over RS485 at once (v7.9.10.0)
+    Serial.println(">> RS485 master aktiveret uden ventetid (genstart efter fejl).");
+    Serial.flush();
+    modbus_master_activate_uart();
+  } else if (mb_mode == MODBUS_MODE_MASTER) {
     Serial.println();
     Serial.println(">> RS485 Master mode: USB console vil blive overtaget.");
     Serial.println(">> Tryk MELLEMRUM inden 5 sek for at forblive i USB console...");
@@ -255,6 +350,7 @@ void setup() {
 
   // Initialize NTP time sync (v7.8.1) — after network init
   ntp_driver_init();
+  boot_phase_done("ntp");
 
   // Initialize CLI remote (unified serial + Telnet)
   if (cli_remote_init() == 0) {
@@ -270,6 +366,7 @@ void setup() {
   }
 
   cli_shell_init(g_serial_console);  // CLI system (last, shows prompt)
+  boot_phase_done("cli");
 
   // FEAT-031: OTA boot validation — confirm firmware is working
   // If this was an OTA update, mark it valid so bootloader won't rollback
@@ -282,6 +379,9 @@ void setup() {
 // ============================================================================
 
 void loop() {
+  // Boot timeline: first pass = Modbus slave serving (no-op afterwards)
+  boot_trace_ready();
+
   // Network subsystem (v3.0+ Wi-Fi auto-reconnect, Telnet server)
   network_manager_loop();
   cli_remote_loop();
@@ -309,7 +409,7 @@ void loop() {
   registers_update_dynamic_registers();
   registers_update_dynamic_coils();
 
-  // Læs shift register inputs (ES32D26: SN74HC165 digitale inputs → cache)
+  // Læs shift register inputs (ES32D26: seneste SPI-sample af SN74HC165 → cache)
   gpio_driver_poll_inputs();
 
   // UNIFIED VARIABLE MAPPING: Read INPUT bindings (GPIO + ST variables)
@@ -323,7 +423,7 @@ void loop() {
   // This must happen AFTER st_logic_engine_loop() to push results to registers
   gpio_mapping_write_after_st_logic();
 
-  // Flush shift register outputs (ES32D26: cache → SN74HC595 relæer)
+  // Flush shift register outputs (ES32D26: cache → SN74HC595 relæer, kun ved ændring)
   // Skal ske EFTER write_after_st_logic() så nye output-værdier når hardware med det samme
   gpio_driver_flush_outputs();
 
@@ -331,6 +431,15 @@ void loop() {
   // BUG-008 FIX: Moved here to ensure IR 220-251 contain current iteration's results
   registers_update_st_logic_status();
 
+  // Mirror runtime state to no-init RAM for a warm restart (v7.9.10.2)
+  warm_retain_loop();
+
+  // Historian samples (after the ST cycle, so values are this iteration's)
+  historian_loop();
+
+  // Read sources of programs booted from the bytecode cache (not in the httpd getter)
+  st_logic_deferred_source_loop(st_logic_get_state());
+
   // Heartbeat LED
   heartbeat_loop();
 
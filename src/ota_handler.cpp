@@ -34,6 +34,7 @@
 #include "constants.h"
 #include "version.h"
 #include "debug.h"
+#include "persist_writer.h"
 
 // External functions from http_server.cpp / api_handlers.cpp
 extern void http_server_stat_request(void);
@@ -82,6 +83,7 @@ static struct {
 static void ota_reboot_task(void *arg)
 {
   vTaskDelay(pdMS_TO_TICKS(OTA_REBOOT_DELAY_MS));
+  persist_writer_flush(PW_FLUSH_TIMEOUT_MS);  // Queued flash writes first
   ESP_LOGI(TAG, "Rebooting into new firmware...");
   esp_restart();
 }
@@ -4,18 +4,80 @@
  *
  * LAYER 0: Hardware Abstraction Driver
  * Provides pulse counter functionality via ESP32 PCNT peripheral
+ *
+ * v7.9.8.6: 64-bit extension in the limit-event ISR (FEAT-155). The unit
+ * resets to 0 at PCNT_UNIT_H_LIM and the ISR adds the limit to a software
+ * accumulator, so no wrap can be missed regardless of input rate.
+ *
+ * v7.9.8.8: Quadrature configuration (FEAT-157), both channels of a unit.
+ *
+ * The ISR is the only writer of the extension. It acknowledges a unit's
+ * interrupt inside its seqlock window, so a reader that sees the unit's
+ * raw interrupt bit set (and the seq unchanged) knows a limit event is
+ * latched but not yet added, whatever the direction or size of the step.
  */
 
 #include "pcnt_driver.h"
+#include "quad_decoder.h"
 #include <string.h>
 #include <driver/pcnt.h>
 #include <esp_log.h>
+#include <esp_attr.h>
+#include <soc/pcnt_struct.h>
+#include <freertos/FreeRTOS.h>
 
 static const char* TAG = "PCNT";
 
 // PCNT configuration state
 static uint8_t pcnt_configured[4] = {0};
 
+// Extended count: accumulated limit events. pcnt_seq is odd while the ISR
+// (or pcnt_unit_clear) updates pcnt_accum, readers retry (seqlock).
+// pcnt_mux serializes the two writers across cores.
+static volatile int64_t pcnt_accum[4] = {0};
+static volatile uint32_t pcnt_seq[4] = {0};
+static portMUX_TYPE pcnt_mux = portMUX_INITIALIZER_UNLOCKED;
+// FEAT-157: Unit counts both ways (quadrature)
+static uint8_t pcnt_bidir[4] = {0};
+static pcnt_event_cb_t pcnt_event_cb = NULL;
+static bool pcnt_isr_installed = false;
+
+/* ============================================================================
+ * LIMIT / THRESHOLD EVENT ISR
+ * ============================================================================ */
+
+// Own handler instead of the ISR service: the service acknowledges the
+// interrupt before calling the unit handler, which would leave a window
+// where the hardware count has restarted but no reader can tell.
+static void IRAM_ATTR pcnt_unit_isr(void* arg) {
+  (void)arg;
+  uint32_t intr = PCNT.int_st.val;
+
+  for (uint8_t unit = 0; unit < 4; unit++) {
+    if (!(intr & BIT(unit))) continue;
+    uint32_t status = PCNT.status_unit[unit].val;
+
+    portENTER_CRITICAL_ISR(&pcnt_mux);
+    __atomic_add_fetch(&pcnt_seq[unit], 1, __ATOMIC_ACQ_REL);
+    if (status & PCNT_EVT_H_LIM) pcnt_accum[unit] += PCNT_UNIT_H_LIM;
+    if (status & PCNT_EVT_L_LIM) pcnt_accum[unit] += PCNT_UNIT_L_LIM;
+    PCNT.int_clr.val = BIT(unit);
+    __atomic_add_fetch(&pcnt_seq[unit], 1, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL_ISR(&pcnt_mux);
+
+    uint32_t events = 0;
+    if (status & (PCNT_EVT_H_LIM | PCNT_EVT_L_LIM)) events |= PCNT_UNIT_EVT_LIMIT;
+    if (status & PCNT_EVT_THRES_0) events |= PCNT_UNIT_EVT_THRESHOLD;
+    if (events && pcnt_event_cb) {
+      pcnt_event_cb(unit, events);
+    }
+  }
+}
+
+void pcnt_unit_set_event_callback(pcnt_event_cb_t cb) {
+  pcnt_event_cb = cb;
+}
+
 /* ============================================================================
  * PCNT UNIT INITIALIZATION
  * ============================================================================ */
@@ -31,6 +93,30 @@ void pcnt_unit_init(uint8_t unit) {
   // Do NOT call pcnt_counter_pause/clear here - PCNT not configured yet!
 }
 
+/* ============================================================================
+ * EVENT SETUP (shared by single-channel and quadrature configuration)
+ * ============================================================================ */
+
+static void pcnt_unit_enable_events(uint8_t unit) {
+  // FEAT-155: Limit events extend the count, threshold 0 is armed on demand
+  // by pcnt_unit_set_threshold() (replaces the 10 ms polling task)
+  pcnt_event_enable((pcnt_unit_t)unit, PCNT_EVT_H_LIM);
+  pcnt_event_enable((pcnt_unit_t)unit, PCNT_EVT_L_LIM);
+  pcnt_event_disable((pcnt_unit_t)unit, PCNT_EVT_THRES_0);
+  pcnt_event_disable((pcnt_unit_t)unit, PCNT_EVT_THRES_1);
+  pcnt_event_disable((pcnt_unit_t)unit, PCNT_EVT_ZERO);
+
+  if (!pcnt_isr_installed) {
+    esp_err_t err = pcnt_isr_register(pcnt_unit_isr, NULL, 0, NULL);
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "ISR register failed: %d", err);
+    } else {
+      pcnt_isr_installed = true;
+    }
+  }
+  pcnt_intr_enable((pcnt_unit_t)unit);
+}
+
 /* ============================================================================
  * PCNT UNIT CONFIGURATION
  * ============================================================================ */
@@ -66,15 +152,8 @@ void pcnt_unit_configure(uint8_t unit, uint8_t gpio_pin,
   ESP_LOGI(TAG, "  PCNT_COUNT_DIS=%d, PCNT_COUNT_INC=%d",
            PCNT_COUNT_DIS, PCNT_COUNT_INC);
 
-  // BUG-182 FIX: PCNT limits must allow full 16-bit unsigned range (0-65535)
-  // PCNT hardware is signed 16-bit, but we want unsigned behavior:
-  // - For UP counting: need to count from 0 to 65535 (via signed -32768 to 32767 mapping)
-  // - Set h_lim very high to avoid premature wrapping at 32767
-  // - Set l_lim very low to allow full negative range (maps to 32768-65535 unsigned)
-  //
-  // NOTE: ESP32 PCNT is ALWAYS signed! We convert to unsigned in pcnt_unit_get_count()
-  // Setting limits to INT16_MIN/MAX allows natural signed overflow at ±32768,
-  // which maps to continuous unsigned sequence 0→65535 after uint16_t cast.
+  // FEAT-155: The unit resets to 0 when it reaches either limit and raises
+  // the matching event; pcnt_unit_isr() adds the limit to pcnt_accum.
   pcnt_config_t pcnt_config = {
     .pulse_gpio_num = gpio_pin,
     .ctrl_gpio_num = PCNT_PIN_NOT_USED,
@@ -82,33 +161,109 @@ void pcnt_unit_configure(uint8_t unit, uint8_t gpio_pin,
     .hctrl_mode = PCNT_MODE_KEEP,
     .pos_mode = pos_mode,
     .neg_mode = neg_mode,
-    .counter_h_lim = INT16_MAX,    // 32767 - full positive range
-    .counter_l_lim = INT16_MIN,    // -32768 - full negative range
+    .counter_h_lim = PCNT_UNIT_H_LIM,
+    .counter_l_lim = PCNT_UNIT_L_LIM,
     .unit = (pcnt_unit_t)unit,
     .channel = PCNT_CHANNEL_0,
   };
 
   pcnt_unit_config(&pcnt_config);
 
-  // BUG-182 FIX: DISABLE watchpoint events at limits (prevent hardware interrupt triggers)
-  // We handle overflow in software (counter_hw.cpp), not via hardware events
-  pcnt_set_event_value((pcnt_unit_t)unit, PCNT_EVT_H_LIM, INT16_MAX);
-  pcnt_set_event_value((pcnt_unit_t)unit, PCNT_EVT_L_LIM, INT16_MIN);
-  pcnt_event_disable((pcnt_unit_t)unit, PCNT_EVT_H_LIM);
-  pcnt_event_disable((pcnt_unit_t)unit, PCNT_EVT_L_LIM);
-  pcnt_event_disable((pcnt_unit_t)unit, PCNT_EVT_ZERO);
+  // FEAT-157: Release channel 1 in case the unit was a x4 decoder before
+  if (pcnt_bidir[unit]) {
+    pcnt_config.pulse_gpio_num = PCNT_PIN_NOT_USED;
+    pcnt_config.pos_mode = PCNT_COUNT_DIS;
+    pcnt_config.neg_mode = PCNT_COUNT_DIS;
+    pcnt_config.channel = PCNT_CHANNEL_1;
+    pcnt_unit_config(&pcnt_config);
+  }
+
+  pcnt_unit_enable_events(unit);
 
   // BUG FIX P0.1: DISABLE filter for high-frequency counting
   // Filter/debounce only for low-frequency (manual button press, noisy environments)
   // At 5 kHz, filter can cause missed pulses - disable completely
   pcnt_filter_disable((pcnt_unit_t)unit);
 
-  // Clear and start counter
-  pcnt_counter_pause((pcnt_unit_t)unit);
-  pcnt_counter_clear((pcnt_unit_t)unit);
-  pcnt_counter_resume((pcnt_unit_t)unit);
+  pcnt_bidir[unit] = 0;
+  pcnt_configured[unit] = 1;
 
+  // Clear and start counter (also zeroes the extension)
+  pcnt_unit_clear(unit);
+}
+
+/* ============================================================================
+ * QUADRATURE CONFIGURATION (FEAT-157)
+ * Channel setup comes from quad_decoder_rules(), the same table the host
+ * test drives with synthetic A/B sequences.
+ * ============================================================================ */
+
+static pcnt_count_mode_t pcnt_edge_from_rule(uint8_t action) {
+  switch (action) {
+    case QUAD_EDGE_INC: return PCNT_COUNT_INC;
+    case QUAD_EDGE_DEC: return PCNT_COUNT_DEC;
+    default:            return PCNT_COUNT_DIS;
+  }
+}
+
+static pcnt_ctrl_mode_t pcnt_ctrl_from_rule(uint8_t action) {
+  switch (action) {
+    case QUAD_CTRL_REVERSE: return PCNT_MODE_REVERSE;
+    case QUAD_CTRL_DISABLE: return PCNT_MODE_DISABLE;
+    default:                return PCNT_MODE_KEEP;
+  }
+}
+
+bool pcnt_unit_configure_quadrature(uint8_t unit, uint8_t gpio_a, uint8_t gpio_b,
+                                    uint8_t mode, uint16_t filter_ns) {
+  if (unit >= 4) return false;
+
+  QuadChannelRule rules[2];
+  uint8_t channels = quad_decoder_rules(mode, rules);
+  if (channels == 0) return false;
+
+  // Channel 0: pulse A / control B; channel 1: pulse B / control A
+  const uint8_t pulse_pin[2] = {gpio_a, gpio_b};
+  const uint8_t ctrl_pin[2] = {gpio_b, gpio_a};
+  const pcnt_channel_t chan[2] = {PCNT_CHANNEL_0, PCNT_CHANNEL_1};
+
+  for (uint8_t c = 0; c < 2; c++) {
+    pcnt_config_t pcnt_config = {
+      .pulse_gpio_num = (c < channels) ? pulse_pin[c] : PCNT_PIN_NOT_USED,
+      .ctrl_gpio_num = (c < channels) ? ctrl_pin[c] : PCNT_PIN_NOT_USED,
+      .lctrl_mode = (c < channels) ? pcnt_ctrl_from_rule(rules[c].lctrl) : PCNT_MODE_KEEP,
+      .hctrl_mode = (c < channels) ? pcnt_ctrl_from_rule(rules[c].hctrl) : PCNT_MODE_KEEP,
+      .pos_mode = (c < channels) ? pcnt_edge_from_rule(rules[c].pos) : PCNT_COUNT_DIS,
+      .neg_mode = (c < channels) ? pcnt_edge_from_rule(rules[c].neg) : PCNT_COUNT_DIS,
+      .counter_h_lim = PCNT_UNIT_H_LIM,
+      .counter_l_lim = PCNT_UNIT_L_LIM,
+      .unit = (pcnt_unit_t)unit,
+      .channel = chan[c],
+    };
+    pcnt_unit_config(&pcnt_config);
+  }
+
+  ESP_LOGI(TAG, "Unit%d quadrature x%d: A=GPIO%d B=GPIO%d filter=%uns",
+           unit, mode, gpio_a, gpio_b, filter_ns);
+
+  pcnt_unit_enable_events(unit);
+
+  // Glitch filter in APB cycles (12.5 ns, 10-bit). Encoders on long cables
+  // ring on every edge; unlike single-channel mode a glitch here can count
+  // the wrong way, so the filter is worth its bandwidth cost.
+  uint32_t cycles = ((uint32_t)filter_ns * 2 + 24) / 25;
+  if (cycles == 0) {
+    pcnt_filter_disable((pcnt_unit_t)unit);
+  } else {
+    if (cycles > 1023) cycles = 1023;
+    pcnt_set_filter_value((pcnt_unit_t)unit, (uint16_t)cycles);
+    pcnt_filter_enable((pcnt_unit_t)unit);
+  }
+
+  pcnt_bidir[unit] = 1;
   pcnt_configured[unit] = 1;
+  pcnt_unit_clear(unit);
+  return true;
 }
 
 /* ============================================================================
@@ -141,12 +296,59 @@ uint32_t pcnt_unit_get_count(uint8_t unit) {
 void pcnt_unit_clear(uint8_t unit) {
   if (unit >= 4) return;
 
-  // Reset hardware counter
+  // Reset hardware counter and extension while paused (no limit event can
+  // fire); an event latched before the pause is dropped with the count
   pcnt_counter_pause((pcnt_unit_t)unit);
   pcnt_counter_clear((pcnt_unit_t)unit);
+  portENTER_CRITICAL(&pcnt_mux);
+  __atomic_add_fetch(&pcnt_seq[unit], 1, __ATOMIC_ACQ_REL);
+  pcnt_accum[unit] = 0;
+  PCNT.int_clr.val = BIT(unit);
+  __atomic_add_fetch(&pcnt_seq[unit], 1, __ATOMIC_RELEASE);
+  portEXIT_CRITICAL(&pcnt_mux);
   pcnt_counter_resume((pcnt_unit_t)unit);
 }
 
+int64_t pcnt_unit_get_total(uint8_t unit) {
+  if (unit >= 4 || !pcnt_configured[unit]) return 0;
+
+  // The unit resets at the limit before the ISR has added it to pcnt_accum.
+  // The raw interrupt bit stays set until the ISR acknowledges it inside
+  // its seqlock window, so a set bit read on both sides of the count (seq
+  // unchanged) means the count has restarted and the latched limit is due.
+  uint32_t seq, pending, status;
+  int64_t accum;
+  int16_t count;
+  do {
+    seq = __atomic_load_n(&pcnt_seq[unit], __ATOMIC_ACQUIRE);
+    pending = PCNT.int_raw.val & BIT(unit);
+    status = PCNT.status_unit[unit].val;
+    accum = pcnt_accum[unit];
+    count = 0;
+    pcnt_get_counter_value((pcnt_unit_t)unit, &count);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) || pending != (PCNT.int_raw.val & BIT(unit)) ||
+           seq != __atomic_load_n(&pcnt_seq[unit], __ATOMIC_ACQUIRE));
+
+  int64_t total = accum + count;
+  if (pending) {
+    if (status & PCNT_EVT_H_LIM) total += PCNT_UNIT_H_LIM;
+    if (status & PCNT_EVT_L_LIM) total += PCNT_UNIT_L_LIM;
+  }
+  return total;
+}
+
+void pcnt_unit_set_threshold(uint8_t unit, int16_t value) {
+  if (unit >= 4 || !pcnt_configured[unit]) return;
+
+  if (value <= 0 || value >= PCNT_UNIT_H_LIM) {
+    pcnt_event_disable((pcnt_unit_t)unit, PCNT_EVT_THRES_0);
+    return;
+  }
+  pcnt_set_event_value((pcnt_unit_t)unit, PCNT_EVT_THRES_0, value);
+  pcnt_event_enable((pcnt_unit_t)unit, PCNT_EVT_THRES_0);
+}
+
 void pcnt_unit_set_count(uint8_t unit, uint32_t value) {
   if (unit >= 4) return;
 
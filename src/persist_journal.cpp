@@ -0,0 +1,409 @@
+/**
+ * @file persist_journal.cpp
+ * @brief Append-only, wear-leveled journal for persistent register groups (v7.9.9.5)
+ *
+ * LAYER 4: Register Persistence - Log-structured group store (pure data structure)
+ *
+ * On-flash format (little endian):
+ *   sector header  magic u32 | sector seq u32 | erase count u32 | 0xFFFF | crc16
+ *   record         0xA7 | key | count | 0xFF | seq u32 | tag u16 | crc16 |
+ *                  values u16[count] | 0xFF padding to 4 bytes
+ * The record CRC covers the header (without the CRC field) and the values.
+ * Seq numbers are free-running uint32 and compared by difference.
+ */
+
+#include "persist_journal.h"
+#include <string.h>
+
+#define PJ_SECTOR_MAGIC   0x314A5050u   // "PPJ1"
+#define PJ_RECORD_MAGIC   0xA7
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t erase_count;
+  uint16_t reserved;
+  uint16_t crc;
+} PjSectorHdr;
+
+typedef struct {
+  uint8_t  magic;
+  uint8_t  key;
+  uint8_t  count;
+  uint8_t  reserved;
+  uint32_t seq;
+  uint16_t tag;
+  uint16_t crc;
+} PjRecordHdr;
+
+static_assert(sizeof(PjSectorHdr) == PJ_SECTOR_HDR_SIZE, "sector header layout");
+static_assert(sizeof(PjRecordHdr) == PJ_RECORD_HDR_SIZE, "record header layout");
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+uint16_t pj_crc16(uint16_t crc, const void *data, uint32_t len)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  while (len--) {
+    crc ^= (uint16_t)(*p++) << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+uint32_t pj_record_size(uint8_t count)
+{
+  return (PJ_RECORD_HDR_SIZE + 2u * count + 3u) & ~3u;
+}
+
+static inline bool seq_newer_or_equal(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) >= 0;
+}
+
+static inline uint32_t sector_addr(const PersistJournal *j, uint16_t s)
+{
+  return (uint32_t)s * j->flash->sector_size;
+}
+
+static uint16_t record_crc(const PjRecordHdr *h, const uint16_t *values)
+{
+  uint16_t crc = pj_crc16(0xFFFF, h, PJ_RECORD_HDR_SIZE - 2);
+  return pj_crc16(crc, values, 2u * h->count);
+}
+
+static bool sector_hdr_valid(const PjSectorHdr *h)
+{
+  return h->magic == PJ_SECTOR_MAGIC &&
+         h->crc == pj_crc16(0xFFFF, h, PJ_SECTOR_HDR_SIZE - 2);
+}
+
+// True if [off, end) of the area reads back as erased flash
+static bool range_erased(const PersistJournal *j, uint32_t off, uint32_t end, bool *ok)
+{
+  uint8_t buf[64];
+  while (off < end) {
+    uint32_t n = end - off;
+    if (n > sizeof(buf)) n = sizeof(buf);
+    if (!j->flash->read(j->flash->ctx, off, buf, n)) {
+      *ok = false;
+      return false;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+      if (buf[i] != 0xFF) return false;
+    }
+    off += n;
+  }
+  return true;
+}
+
+static bool erase_sector(PersistJournal *j, uint16_t s)
+{
+  if (!j->flash->erase(j->flash->ctx, sector_addr(j, s))) return false;
+  j->erase_count[s]++;
+  j->stats.erases++;
+  return true;
+}
+
+// Write a fresh header into an erased sector and make it the active one
+static bool activate_sector(PersistJournal *j, uint16_t s, uint32_t seq)
+{
+  PjSectorHdr h;
+  h.magic = PJ_SECTOR_MAGIC;
+  h.seq = seq;
+  h.erase_count = j->erase_count[s];
+  h.reserved = 0xFFFF;
+  h.crc = pj_crc16(0xFFFF, &h, PJ_SECTOR_HDR_SIZE - 2);
+  if (!j->flash->write(j->flash->ctx, sector_addr(j, s), &h, sizeof(h))) return false;
+  j->active = s;
+  j->used_mask |= 1u << s;
+  j->sector_seq = seq;
+  j->write_off = PJ_SECTOR_HDR_SIZE;
+  return true;
+}
+
+/* ============================================================================
+ * SCAN
+ * ============================================================================ */
+
+// Index the records of one sector; returns the offset after the last record
+// (sector_size if the sector holds something that is not a record)
+static uint32_t scan_sector(PersistJournal *j, uint16_t s, bool *ok)
+{
+  uint32_t ss = j->flash->sector_size;
+  uint32_t base = sector_addr(j, s);
+  uint32_t off = PJ_SECTOR_HDR_SIZE;
+
+  while (off + PJ_RECORD_HDR_SIZE <= ss) {
+    PjRecordHdr h;
+    if (!j->flash->read(j->flash->ctx, base + off, &h, sizeof(h))) {
+      *ok = false;
+      return ss;
+    }
+
+    const uint8_t *raw = (const uint8_t *)&h;
+    bool blank = true;
+    for (uint32_t i = 0; i < sizeof(h); i++) {
+      if (raw[i] != 0xFF) { blank = false; break; }
+    }
+    if (blank) return off;
+
+    if (h.magic != PJ_RECORD_MAGIC || h.key >= PJ_MAX_KEYS || h.count > PJ_MAX_VALUES) {
+      return ss;  // Not a record boundary: nothing after it can be trusted
+    }
+    uint32_t len = pj_record_size(h.count);
+    if (off + len > ss) return ss;
+
+    uint16_t values[PJ_MAX_VALUES];
+    if (!j->flash->read(j->flash->ctx, base + off + PJ_RECORD_HDR_SIZE, values, 2u * h.count)) {
+      *ok = false;
+      return ss;
+    }
+
+    if (h.crc != record_crc(&h, values)) {
+      j->stats.torn++;
+    } else {
+      PjIndexEntry *e = &j->index[h.key];
+      // Equal seq: a compaction copy in a newer sector replaces the original
+      if (e->addr == 0 || seq_newer_or_equal(h.seq, e->seq)) {
+        e->addr = base + off;
+        e->seq = h.seq;
+        e->tag = h.tag;
+        e->count = h.count;
+      }
+      if (seq_newer_or_equal(h.seq, j->next_seq)) j->next_seq = h.seq + 1;
+    }
+    off += len;
+  }
+  return ss;
+}
+
+/* ============================================================================
+ * COMPACTION
+ * ============================================================================ */
+
+// Copy the live records of sector victim into the active sector, then erase it
+static bool compact_sector(PersistJournal *j, uint16_t victim)
+{
+  uint32_t ss = j->flash->sector_size;
+  uint32_t lo = sector_addr(j, victim);
+
+  for (uint8_t k = 0; k < PJ_MAX_KEYS; k++) {
+    PjIndexEntry *e = &j->index[k];
+    if (e->addr == 0 || e->addr < lo || e->addr >= lo + ss) continue;
+
+    uint8_t rec[PJ_RECORD_HDR_SIZE + 2 * PJ_MAX_VALUES];
+    uint32_t len = pj_record_size(e->count);
+    if (j->write_off + len > ss) return false;   // Cannot happen, see pj_mount
+    if (!j->flash->read(j->flash->ctx, e->addr, rec, len)) return false;
+
+    uint32_t dst = sector_addr(j, j->active) + j->write_off;
+    if (!j->flash->write(j->flash->ctx, dst, rec, len)) {
+      j->write_off = ss;
+      return false;
+    }
+    e->addr = dst;
+    j->write_off += len;
+    j->stats.relocated++;
+  }
+
+  if (!erase_sector(j, victim)) return false;
+  j->used_mask &= ~(1u << victim);
+  return true;
+}
+
+// Move into the spare sector and reclaim the oldest one as the new spare
+static bool advance(PersistJournal *j)
+{
+  uint16_t next = (uint16_t)((j->active + 1) % j->sector_count);
+  if (!activate_sector(j, next, j->sector_seq + 1)) return false;
+
+  // Still erased during the first lap; otherwise erased even without live
+  // records, since it is the next spare
+  uint16_t victim = (uint16_t)((next + 1) % j->sector_count);
+  if (!(j->used_mask & (1u << victim))) return true;
+  return compact_sector(j, victim);
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+bool pj_mount(PersistJournal *j, const PjFlashOps *flash)
+{
+  memset(j, 0, sizeof(*j));
+  if (!flash || !flash->read || !flash->write || !flash->erase) return false;
+  // Room for two full live sets: a compaction finished at mount may find
+  // part of the live set already copied
+  uint32_t min_sector = PJ_SECTOR_HDR_SIZE + 2 * PJ_MAX_KEYS * pj_record_size(PJ_MAX_VALUES);
+  if (flash->sector_size < min_sector || (flash->sector_size & 3) != 0) return false;
+  uint32_t n = flash->size / flash->sector_size;
+  if (n < 2 || n > PJ_MAX_SECTORS) return false;
+
+  j->flash = flash;
+  j->sector_count = (uint16_t)n;
+  j->next_seq = 1;
+
+  // Classify sectors: valid (has a header), erased, or garbage
+  uint32_t valid_mask = 0;
+  uint32_t seqs[PJ_MAX_SECTORS];
+  uint32_t max_erases = 0;
+  for (uint16_t s = 0; s < n; s++) {
+    PjSectorHdr h;
+    if (!flash->read(flash->ctx, sector_addr(j, s), &h, sizeof(h))) return false;
+    if (!sector_hdr_valid(&h)) continue;
+    valid_mask |= 1u << s;
+    seqs[s] = h.seq;
+    j->erase_count[s] = h.erase_count;
+    if (h.erase_count > max_erases) max_erases = h.erase_count;
+  }
+
+  // A sector without header lost its erase count with the erase; it was
+  // erased last, so it has at least the highest count still on flash
+  bool ok = true;
+  for (uint16_t s = 0; s < n; s++) {
+    if (valid_mask & (1u << s)) continue;
+    j->erase_count[s] = max_erases;
+    bool erased = range_erased(j, sector_addr(j, s), sector_addr(j, s) + flash->sector_size, &ok);
+    if (!ok) return false;
+    if (!erased && !erase_sector(j, s)) return false;
+  }
+
+  // Sort valid sectors oldest first
+  uint16_t order[PJ_MAX_SECTORS];
+  uint16_t used = 0;
+  for (uint16_t s = 0; s < n; s++) {
+    if (!(valid_mask & (1u << s))) continue;
+    uint16_t i = used++;
+    while (i > 0 && !seq_newer_or_equal(seqs[s], seqs[order[i - 1]])) {
+      order[i] = order[i - 1];
+      i--;
+    }
+    order[i] = s;
+  }
+
+  if (used == 0) {
+    if (!activate_sector(j, 0, 1)) return false;
+    j->mounted = true;
+    return true;
+  }
+
+  uint32_t end = 0;
+  for (uint16_t i = 0; i < used; i++) {
+    end = scan_sector(j, order[i], &ok);
+    if (!ok) return false;
+  }
+
+  j->used_mask = valid_mask;
+  j->active = order[used - 1];
+  j->sector_seq = seqs[j->active];
+  j->write_off = end;
+
+  // Leftovers of a torn append behind the last record: never program over them
+  uint32_t base = sector_addr(j, j->active);
+  if (j->write_off < flash->sector_size &&
+      !range_erased(j, base + j->write_off, base + flash->sector_size, &ok)) {
+    if (!ok) return false;
+    j->write_off = flash->sector_size;
+  }
+
+  // Compaction interrupted after the switch: the spare still holds data
+  uint16_t victim = (uint16_t)((j->active + 1) % n);
+  if (j->used_mask & (1u << victim)) {
+    if (!compact_sector(j, victim)) return false;
+  }
+
+  j->mounted = true;
+  return true;
+}
+
+bool pj_append(PersistJournal *j, uint8_t key, uint16_t tag,
+               const uint16_t *values, uint8_t count)
+{
+  if (!j->mounted || key >= PJ_MAX_KEYS || count > PJ_MAX_VALUES) return false;
+
+  uint32_t len = pj_record_size(count);
+  if (j->write_off + len > j->flash->sector_size) {
+    if (!advance(j)) {
+      j->mounted = false;   // Spare invariant broken; the next mount repairs it
+      return false;
+    }
+  }
+
+  uint8_t rec[PJ_RECORD_HDR_SIZE + 2 * PJ_MAX_VALUES];
+  memset(rec, 0xFF, len);
+  PjRecordHdr h;
+  h.magic = PJ_RECORD_MAGIC;
+  h.key = key;
+  h.count = count;
+  h.reserved = 0xFF;
+  h.seq = j->next_seq;
+  h.tag = tag;
+  h.crc = record_crc(&h, values);
+  memcpy(rec, &h, sizeof(h));
+  memcpy(rec + PJ_RECORD_HDR_SIZE, values, 2u * count);
+
+  uint32_t addr = sector_addr(j, j->active) + j->write_off;
+  if (!j->flash->write(j->flash->ctx, addr, rec, len)) {
+    j->write_off = j->flash->sector_size;   // State of the range unknown
+    return false;
+  }
+
+  PjIndexEntry *e = &j->index[key];
+  e->addr = addr;
+  e->seq = h.seq;
+  e->tag = tag;
+  e->count = count;
+  j->write_off += len;
+  j->next_seq++;
+  j->stats.appends++;
+  j->stats.bytes_written += len;
+  return true;
+}
+
+bool pj_latest(const PersistJournal *j, uint8_t key, uint16_t *tag, uint32_t *seq)
+{
+  if (!j->mounted || key >= PJ_MAX_KEYS || j->index[key].addr == 0) return false;
+  if (tag) *tag = j->index[key].tag;
+  if (seq) *seq = j->index[key].seq;
+  return true;
+}
+
+bool pj_read(PersistJournal *j, uint8_t key, uint16_t *tag,
+             uint16_t *values, uint8_t *count)
+{
+  if (!j->mounted || key >= PJ_MAX_KEYS || j->index[key].addr == 0) return false;
+  const PjIndexEntry *e = &j->index[key];
+
+  PjRecordHdr h;
+  if (!j->flash->read(j->flash->ctx, e->addr, &h, sizeof(h))) return false;
+  if (h.magic != PJ_RECORD_MAGIC || h.key != key || h.count > PJ_MAX_VALUES) return false;
+  if (!j->flash->read(j->flash->ctx, e->addr + PJ_RECORD_HDR_SIZE, values, 2u * h.count)) return false;
+  if (h.crc != record_crc(&h, values)) return false;
+
+  if (tag) *tag = h.tag;
+  if (count) *count = h.count;
+  return true;
+}
+
+uint32_t pj_free_in_sector(const PersistJournal *j)
+{
+  if (!j->mounted) return 0;
+  return j->flash->sector_size - j->write_off;
+}
+
+void pj_wear(const PersistJournal *j, uint32_t *min_erases, uint32_t *max_erases)
+{
+  uint32_t lo = 0, hi = 0;
+  for (uint16_t s = 0; s < j->sector_count; s++) {
+    uint32_t c = j->erase_count[s];
+    if (s == 0 || c < lo) lo = c;
+    if (c > hi) hi = c;
+  }
+  if (min_erases) *min_erases = lo;
+  if (max_erases) *max_erases = hi;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file persist_queue.cpp
+ * @brief Coalescing job queue for the flash writer task (v7.9.9.6)
+ *
+ * LAYER 6: Persistence - Flash write scheduling (pure data structure)
+ * At most PQ_MAX_JOBS jobs, so a linear scan is cheaper than any index.
+ * Submission numbers are free-running and compared by difference.
+ */
+
+#include "persist_queue.h"
+#include <string.h>
+
+void pq_init(PersistQueue *q)
+{
+  memset(q, 0, sizeof(*q));
+}
+
+static PqJob *find_pending(PersistQueue *q, uint16_t key)
+{
+  for (uint8_t i = 0; i < PQ_MAX_JOBS; i++) {
+    if (q->jobs[i].pending && q->jobs[i].key == key) return &q->jobs[i];
+  }
+  return NULL;
+}
+
+PqSubmitResult pq_submit(PersistQueue *q, uint16_t key, pq_exec_t exec,
+                         void *data, uint32_t len, pq_done_cb_t cb, void *ctx,
+                         void **old_data)
+{
+  PqJob *j = find_pending(q, key);
+  if (j) {
+    if (cb && j->cb_count >= PQ_MAX_CALLBACKS) {
+      q->rejected++;
+      return PQ_FULL;
+    }
+    if (old_data) *old_data = j->data;
+    j->exec = exec;
+    j->data = data;
+    j->len = len;
+    j->submits++;
+    if (cb) {
+      j->cbs[j->cb_count].fn = cb;
+      j->cbs[j->cb_count].ctx = ctx;
+      j->cb_count++;
+    }
+    q->submitted++;
+    q->coalesced++;
+    return PQ_COALESCED;
+  }
+
+  for (uint8_t i = 0; i < PQ_MAX_JOBS; i++) {
+    j = &q->jobs[i];
+    if (j->pending) continue;
+    memset(j, 0, sizeof(*j));
+    j->pending = true;
+    j->key = key;
+    j->order = q->next_order++;
+    j->submits = 1;
+    j->exec = exec;
+    j->data = data;
+    j->len = len;
+    if (cb) {
+      j->cbs[0].fn = cb;
+      j->cbs[0].ctx = ctx;
+      j->cb_count = 1;
+    }
+    q->submitted++;
+    return PQ_QUEUED;
+  }
+
+  q->rejected++;
+  return PQ_FULL;
+}
+
+bool pq_take(PersistQueue *q, PqJob *out)
+{
+  PqJob *oldest = NULL;
+  for (uint8_t i = 0; i < PQ_MAX_JOBS; i++) {
+    PqJob *j = &q->jobs[i];
+    if (!j->pending) continue;
+    if (!oldest || (int32_t)(j->order - oldest->order) < 0) oldest = j;
+  }
+  if (!oldest) return false;
+
+  *out = *oldest;
+  oldest->pending = false;
+  oldest->data = NULL;
+  return true;
+}
+
+uint32_t pq_pending(const PersistQueue *q)
+{
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < PQ_MAX_JOBS; i++) {
+    if (q->jobs[i].pending) n++;
+  }
+  return n;
+}
+
+bool pq_is_pending(const PersistQueue *q, uint16_t key)
+{
+  for (uint8_t i = 0; i < PQ_MAX_JOBS; i++) {
+    if (q->jobs[i].pending && q->jobs[i].key == key) return true;
+  }
+  return false;
+}
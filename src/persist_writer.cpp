@@ -0,0 +1,259 @@
+/**
+ * @file persist_writer.cpp
+ * @brief Asynchronous flash writer task (v7.9.9.6)
+ *
+ * LAYER 6: Persistence - Flash write scheduling
+ *
+ * The mutex only guards the queue and statistics; it is never held while
+ * flash is written, so a submit from the main loop costs a snapshot copy
+ * and a few microseconds of locking.
+ */
+
+#include "persist_writer.h"
+#include "debug.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <string.h>
+
+static PersistQueue pw_queue;
+static SemaphoreHandle_t pw_mutex = NULL;
+static TaskHandle_t pw_task = NULL;
+static PersistWriterStats pw_stats;
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+void *persist_writer_alloc(uint32_t len) {
+  void *p = heap_caps_malloc(len ? len : 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!p) p = malloc(len ? len : 1);
+  return p;
+}
+
+const char *persist_writer_key_name(uint16_t key) {
+  switch (key & 0xFF00) {
+    case PW_KEY_CONFIG:         return "config";
+    case PW_KEY_ST_PROGRAMS:    return "st-programs";
+    case PW_KEY_BYTECODE(0):    return "bytecode";
+    case PW_KEY_GROUP(0):       return "persist-group";
+    case PW_KEY_HISTORY(0, 0):  return "history";
+    default:                    return "unknown";
+  }
+}
+
+static bool in_writer_task(void) {
+  return pw_task != NULL && xTaskGetCurrentTaskHandle() == pw_task;
+}
+
+static void record_result(uint16_t key, bool ok, uint32_t ms) {
+  pw_stats.last_write_ms = ms;
+  pw_stats.total_write_ms += ms;
+  if (ms > pw_stats.max_write_ms) pw_stats.max_write_ms = ms;
+  if (ok) {
+    pw_stats.written++;
+  } else {
+    pw_stats.failed++;
+    pw_stats.last_fail_key = key;
+  }
+}
+
+// Writer not running: execute in the caller
+static bool run_sync(uint16_t key, pq_exec_t exec, void *data, uint32_t len,
+                     pq_done_cb_t cb, void *ctx) {
+  uint32_t t0 = millis();
+  bool ok = exec(key, data, len);
+  free(data);
+  record_result(key, ok, millis() - t0);
+  if (cb) cb(ok, ctx);
+  return ok;
+}
+
+/* ============================================================================
+ * TASK
+ * ============================================================================ */
+
+static void persist_writer_task(void *arg) {
+  (void)arg;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    for (;;) {
+      PqJob job;
+      xSemaphoreTake(pw_mutex, portMAX_DELAY);
+      bool got = pq_take(&pw_queue, &job);
+      pw_stats.busy_key = got ? job.key : 0;
+      xSemaphoreGive(pw_mutex);
+      if (!got) break;
+
+      uint32_t t0 = millis();
+      bool ok = job.exec(job.key, job.data, job.len);
+      uint32_t ms = millis() - t0;
+      free(job.data);
+
+      xSemaphoreTake(pw_mutex, portMAX_DELAY);
+      record_result(job.key, ok, ms);
+      pw_stats.busy_key = 0;
+      xSemaphoreGive(pw_mutex);
+
+      if (!ok) {
+        debug_print("[PERSIST] Write failed: ");
+        debug_print(persist_writer_key_name(job.key));
+        debug_print(" #");
+        debug_print_uint(job.key & 0xFF);
+        debug_println("");
+      }
+      for (uint8_t i = 0; i < job.cb_count; i++) {
+        job.cbs[i].fn(ok, job.cbs[i].ctx);
+      }
+    }
+  }
+}
+
+bool persist_writer_init(void) {
+  if (pw_task != NULL) return true;
+
+  pq_init(&pw_queue);
+  pw_mutex = xSemaphoreCreateMutex();
+  if (!pw_mutex) {
+    Serial.println("[PERSIST] FEJL: Kunne ikke oprette mutex - synkrone flash-writes");
+    return false;
+  }
+
+  TaskHandle_t handle = NULL;
+  BaseType_t ret = xTaskCreatePinnedToCore(persist_writer_task, "persist_wr", PW_TASK_STACK,
+                                           NULL, PW_TASK_PRIO, &handle, PW_TASK_CORE);
+  if (ret != pdPASS) {
+    Serial.println("[PERSIST] FEJL: Kunne ikke starte writer task - synkrone flash-writes");
+    return false;
+  }
+  pw_task = handle;
+  pw_stats.running = true;
+  return true;
+}
+
+/* ============================================================================
+ * SUBMIT
+ * ============================================================================ */
+
+bool persist_writer_submit_owned(uint16_t key, pq_exec_t exec, void *data, uint32_t len,
+                                 pq_done_cb_t cb, void *ctx) {
+  if (!data) {
+    pw_stats.rejected++;
+    return false;
+  }
+  if (pw_task == NULL) {
+    return run_sync(key, exec, data, len, cb, ctx);
+  }
+
+  void *old = NULL;
+  xSemaphoreTake(pw_mutex, portMAX_DELAY);
+  PqSubmitResult r = pq_submit(&pw_queue, key, exec, data, len, cb, ctx, &old);
+  if (r == PQ_FULL) {
+    pw_stats.rejected++;
+  } else {
+    pw_stats.submitted++;
+    if (r == PQ_COALESCED) pw_stats.coalesced++;
+  }
+  xSemaphoreGive(pw_mutex);
+
+  if (r == PQ_FULL) {
+    free(data);
+    return false;
+  }
+  if (old) free(old);
+  xTaskNotifyGive(pw_task);
+  return true;
+}
+
+bool persist_writer_submit(uint16_t key, pq_exec_t exec, const void *data, uint32_t len,
+                           pq_done_cb_t cb, void *ctx) {
+  void *copy = persist_writer_alloc(len);
+  if (!copy) {
+    pw_stats.rejected++;
+    return false;
+  }
+  if (len) memcpy(copy, data, len);
+  return persist_writer_submit_owned(key, exec, copy, len, cb, ctx);
+}
+
+/* ============================================================================
+ * WAITING
+ * ============================================================================ */
+
+// Shared by the waiter and the callback; the last one to let go frees it,
+// so a waiter that timed out never leaves the callback a dangling pointer
+typedef struct {
+  SemaphoreHandle_t done;
+  volatile bool ok;
+  uint32_t refs;
+} PwWaiter;
+
+static void waiter_release(PwWaiter *w) {
+  if (__atomic_sub_fetch(&w->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    vSemaphoreDelete(w->done);
+    free(w);
+  }
+}
+
+static void waiter_done(bool ok, void *ctx) {
+  PwWaiter *w = (PwWaiter *)ctx;
+  w->ok = ok;
+  xSemaphoreGive(w->done);
+  waiter_release(w);
+}
+
+bool persist_writer_submit_wait(uint16_t key, pq_exec_t exec, const void *data, uint32_t len,
+                                uint32_t timeout_ms) {
+  if (pw_task == NULL || in_writer_task()) {
+    void *copy = persist_writer_alloc(len);
+    if (!copy) return false;
+    if (len) memcpy(copy, data, len);
+    return run_sync(key, exec, copy, len, NULL, NULL);
+  }
+
+  PwWaiter *w = (PwWaiter *)malloc(sizeof(PwWaiter));
+  if (!w) return false;
+  w->done = xSemaphoreCreateBinary();
+  if (!w->done) {
+    free(w);
+    return false;
+  }
+  w->ok = false;
+  w->refs = 2;
+
+  if (!persist_writer_submit(key, exec, data, len, waiter_done, w)) {
+    vSemaphoreDelete(w->done);
+    free(w);
+    return false;
+  }
+
+  bool finished = xSemaphoreTake(w->done, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+  bool ok = finished && w->ok;
+  waiter_release(w);
+  return ok;
+}
+
+bool persist_writer_flush(uint32_t timeout_ms) {
+  if (pw_task == NULL) return true;
+  if (in_writer_task()) return false;
+
+  uint32_t start = millis();
+  for (;;) {
+    xSemaphoreTake(pw_mutex, portMAX_DELAY);
+    bool idle = pq_pending(&pw_queue) == 0 && pw_stats.busy_key == 0;
+    xSemaphoreGive(pw_mutex);
+    if (idle) return true;
+    if (millis() - start >= timeout_ms) return false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+
+void persist_writer_get_stats(PersistWriterStats *out) {
+  if (pw_mutex) xSemaphoreTake(pw_mutex, portMAX_DELAY);
+  *out = pw_stats;
+  out->pending = pq_pending(&pw_queue);
+  if (pw_mutex) xSemaphoreGive(pw_mutex);
+}
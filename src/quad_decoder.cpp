@@ -0,0 +1,115 @@
+/**
+ * @file quad_decoder.cpp
+ * @brief Quadrature (A/B encoder) decoding rules and velocity estimator (v7.9.8.8)
+ *
+ * LAYER 5: Feature Engines - Counter quadrature mode (pure math)
+ *
+ * Forward sequence (A leads B), bit 0 = A, bit 1 = B:
+ *   00 -> 01 -> 11 -> 10 -> 00
+ *   A rises with B low, B rises with A high,
+ *   A falls with B high, B falls with A low
+ */
+
+#include "quad_decoder.h"
+
+uint8_t quad_decoder_rules(uint8_t mode, QuadChannelRule rules[2])
+{
+  // Channel 0: pulse A, control B. A rising with B low is forward,
+  // B high reverses.
+  QuadChannelRule a = { QUAD_EDGE_INC, QUAD_EDGE_DIS, QUAD_CTRL_KEEP, QUAD_CTRL_REVERSE };
+  // Channel 1: pulse B, control A. B falling with A low is forward,
+  // A high reverses (B rising with A high is then forward too).
+  QuadChannelRule b = { QUAD_EDGE_DEC, QUAD_EDGE_INC, QUAD_CTRL_KEEP, QUAD_CTRL_REVERSE };
+
+  switch (mode) {
+    case 1: {
+      // One count per cycle at the 00 <-> 01 step: A rising with B low
+      // forward, A falling with B low backward, nothing while B is high.
+      // Counting A rising only would drift when the shaft dithers on it.
+      QuadChannelRule x1 = { QUAD_EDGE_INC, QUAD_EDGE_DEC, QUAD_CTRL_KEEP, QUAD_CTRL_DISABLE };
+      rules[0] = x1;
+      return 1;
+    }
+    case 2:
+      // A falling with B high is forward: DEC reversed by B high
+      a.neg = QUAD_EDGE_DEC;
+      rules[0] = a;
+      return 1;
+    case 4:
+      a.neg = QUAD_EDGE_DEC;
+      rules[0] = a;
+      rules[1] = b;
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+static int8_t quad_channel_apply(const QuadChannelRule *r, bool pulse_prev, bool pulse,
+                                 bool ctrl)
+{
+  if (pulse_prev == pulse) return 0;
+  uint8_t action = pulse ? r->pos : r->neg;
+  int8_t delta = (action == QUAD_EDGE_INC) ? 1 : (action == QUAD_EDGE_DEC) ? -1 : 0;
+  uint8_t ctrl_action = ctrl ? r->hctrl : r->lctrl;
+  if (ctrl_action == QUAD_CTRL_DISABLE) return 0;
+  return (ctrl_action == QUAD_CTRL_REVERSE) ? (int8_t)-delta : delta;
+}
+
+int8_t quad_decoder_step(const QuadChannelRule *rules, uint8_t channels,
+                         uint8_t prev_ab, uint8_t ab)
+{
+  bool a0 = prev_ab & 1, b0 = (prev_ab >> 1) & 1;
+  bool a1 = ab & 1, b1 = (ab >> 1) & 1;
+
+  // Both inputs changing at once is not a valid quadrature step (direction
+  // unknown); the hardware resolves it by whichever edge it samples first
+  if (a0 != a1 && b0 != b1) return 0;
+
+  int8_t delta = 0;
+  if (channels >= 1) delta += quad_channel_apply(&rules[0], a0, a1, b1);
+  if (channels >= 2) delta += quad_channel_apply(&rules[1], b0, b1, a1);
+  return delta;
+}
+
+void quad_velocity_reset(QuadVelocity *v)
+{
+  v->last_pos = 0;
+  v->last_us = 0;
+  v->cps = 0.0f;
+  v->have_ref = 0;
+}
+
+bool quad_velocity_update(QuadVelocity *v, const QuadVelocityConfig *cfg,
+                          int64_t pos, uint32_t now_us)
+{
+  if (!v->have_ref) {
+    v->last_pos = pos;
+    v->last_us = now_us;
+    v->have_ref = 1;
+    return false;
+  }
+
+  uint32_t dt = now_us - v->last_us;
+  if (dt == 0 || dt < cfg->sample_us) return false;
+
+  float raw = (float)(pos - v->last_pos) * 1000000.0f / (float)dt;
+  if (cfg->tau_us == 0) {
+    v->cps = raw;
+  } else {
+    // Discrete first order low-pass, exact for the actual sample interval
+    float alpha = (float)dt / (float)((uint64_t)cfg->tau_us + dt);
+    v->cps += alpha * (raw - v->cps);
+  }
+  v->last_pos = pos;
+  v->last_us = now_us;
+  return true;
+}
+
+int32_t quad_velocity_get(const QuadVelocity *v)
+{
+  float c = v->cps;
+  if (c >= 2147483647.0f) return INT32_MAX;
+  if (c <= -2147483648.0f) return INT32_MIN;
+  return (int32_t)(c < 0 ? c - 0.5f : c + 0.5f);
+}
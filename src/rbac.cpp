@@ -13,6 +13,7 @@
 #include <esp_log.h>
 
 #include "rbac.h"
+#include "session_token.h"
 #include "config_struct.h"
 #include "debug.h"
 
@@ -112,18 +113,88 @@ static int rbac_legacy_from_basic(const char *auth_value)
   return -1;
 }
 
+static bool rbac_any_auth_enabled(void)
+{
+  return g_persist_config.rbac.enabled || g_persist_config.network.http.auth_enabled;
+}
+
+static uint32_t fnv1a_str(uint32_t h, const char *s, size_t max_len)
+{
+  for (size_t i = 0; i < max_len && s[i]; i++) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/**
+ * Session tokens are bound to the auth mode and legacy credentials they were
+ * issued under. The fingerprint is compared on every check instead of hooking
+ * each writer, so CLI, API, config restore and config_apply are all covered:
+ * the first request after a change revokes every outstanding token.
+ * Covers every user slot too, so editing or replacing users (restore)
+ * revokes as well. Called from several httpd/SSE tasks: seen is swapped
+ * atomically, so a change is acted on exactly once per observed value.
+ */
+static void rbac_sync_auth_stamp(void)
+{
+  static uint32_t seen = 0;
+  const HttpConfig *http = &g_persist_config.network.http;
+
+  uint32_t h = 2166136261u;
+  h = (h ^ (g_persist_config.rbac.enabled ? 1u : 0u)) * 16777619u;
+  h = (h ^ (http->auth_enabled ? 1u : 0u)) * 16777619u;
+  h = fnv1a_str(h, http->username, sizeof(http->username));
+  h = (h ^ ':') * 16777619u;
+  h = fnv1a_str(h, http->password, sizeof(http->password));
+  for (uint8_t i = 0; i < RBAC_MAX_USERS; i++) {
+    const RbacUser *u = &g_persist_config.rbac.users[i];
+    h = (h ^ u->active) * 16777619u;
+    h = fnv1a_str(h, u->username, sizeof(u->username));
+    h = (h ^ ':') * 16777619u;
+    h = fnv1a_str(h, u->password, sizeof(u->password));
+    h = (h ^ u->roles) * 16777619u;
+    h = (h ^ u->privilege) * 16777619u;
+  }
+  if (h == 0) h = 1;  // 0 = not yet seen
+
+  if (__atomic_load_n(&seen, __ATOMIC_ACQUIRE) == h) return;
+  uint32_t prev = __atomic_exchange_n(&seen, h, __ATOMIC_ACQ_REL);
+  if (prev != 0 && prev != h) {
+    session_token_revoke_all();
+    ESP_LOGI(TAG, "Auth config changed - all sessions revoked");
+  }
+}
+
+static int rbac_check_bearer(const char *token)
+{
+  int uid = session_token_check(token);
+  // Under RBAC only real users log in; a virtual-admin token can only stem
+  // from a login made while auth was off
+  if (uid == 99 && g_persist_config.rbac.enabled) return -1;
+  return uid;
+}
+
 int rbac_check_http(httpd_req_t *req)
 {
+  rbac_sync_auth_stamp();
+
+  // No auth configured: any header (including a stale Bearer) is ignored
+  if (!rbac_any_auth_enabled()) {
+    return 99; // No auth required, virtual admin
+  }
+
   // Extract Authorization header
   char auth_buf[256] = {0};
   if (httpd_req_get_hdr_value_str(req, "Authorization", auth_buf, sizeof(auth_buf)) != ESP_OK) {
-    // No header — check if auth is even required
-    if (!g_persist_config.rbac.enabled && !g_persist_config.network.http.auth_enabled) {
-      return 99; // No auth required, virtual admin
-    }
     return -1;
   }
 
+  // Session token (v7.9.8.4): O(1) slot lookup, no Base64/user table scan
+  if (strncmp(auth_buf, "Bearer ", 7) == 0) {
+    return rbac_check_bearer(auth_buf + 7);
+  }
+
   if (g_persist_config.rbac.enabled) {
     return rbac_auth_from_basic(auth_buf);
   }
@@ -132,6 +203,13 @@ int rbac_check_http(httpd_req_t *req)
 
 int rbac_check_sse(const char *auth_header)
 {
+  rbac_sync_auth_stamp();
+
+  if (!rbac_any_auth_enabled()) return 99;
+
+  if (auth_header && strncmp(auth_header, "Bearer ", 7) == 0) {
+    return rbac_check_bearer(auth_header + 7);
+  }
   if (!g_persist_config.rbac.enabled) {
     return rbac_legacy_from_basic(auth_header);
   }
@@ -212,6 +290,7 @@ int rbac_set_user(const char *username, const char *password, uint8_t roles, uin
       cfg->users[i].password[RBAC_PASSWORD_MAX - 1] = '\0';
       cfg->users[i].roles = roles;
       cfg->users[i].privilege = privilege;
+      session_token_revoke_user(i);  // Old sessions must re-login with new credentials
       ESP_LOGI(TAG, "Updated user '%s' (slot %d, roles=0x%02x, priv=0x%02x)",
         username, i, roles, privilege);
       return i;
@@ -248,6 +327,7 @@ bool rbac_delete_user(const char *username)
     if (cfg->users[i].active && strcmp(cfg->users[i].username, username) == 0) {
       ESP_LOGI(TAG, "Deleted user '%s' (slot %d)", username, i);
       memset(&cfg->users[i], 0, sizeof(RbacUser));
+      session_token_revoke_user(i);
       if (cfg->user_count > 0) cfg->user_count--;
 
       // If no users left, disable RBAC
@@ -72,12 +72,22 @@ void register_allocator_init(void) {
       // Allocate single-word registers (always 16-bit)
       // Note: overflow flag is now in ctrl_reg bit 3, no separate register needed
       register_allocator_allocate(cfg.freq_reg, REG_OWNER_COUNTER, id, "frq");
+      if (cfg.freq_mode == COUNTER_FREQ_RECIPROCAL) {
+        register_allocator_allocate(cfg.freq_reg + 1, REG_OWNER_COUNTER, id, "frm");  // FEAT-154: mHz fraction
+      }
       register_allocator_allocate(cfg.ctrl_reg, REG_OWNER_COUNTER, id, "ctl");
 
       // Allocate compare_value register range (1-4 words depending on bit_width)
       if (cfg.compare_enabled && cfg.compare_value_reg < ALLOCATOR_SIZE) {
         register_allocator_allocate_range(cfg.compare_value_reg, words, REG_OWNER_COUNTER, id, "cmp");
       }
+
+      // FEAT-157: Quadrature velocity (int32, 2 words)
+      CounterQuadConfig quad;
+      if (counter_config_get_quad(id, &quad) && quad.mode != COUNTER_QUAD_OFF &&
+          quad.velocity_reg < ALLOCATOR_SIZE) {
+        register_allocator_allocate_range(quad.velocity_reg, 2, REG_OWNER_COUNTER, id, "vel");
+      }
     }
   }
 
@@ -18,6 +18,8 @@
 #include "types.h"
 #include "constants.h"
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <string.h>
 #include <math.h>
 
@@ -28,7 +30,44 @@
 static uint16_t holding_regs[HOLDING_REGS_SIZE] = {0};      // 16-bit registers
 static uint16_t input_regs[INPUT_REGS_SIZE] = {0};          // 16-bit registers
 static uint8_t coils[COILS_SIZE] = {0};                     // Packed bits (8 per byte)
-static uint8_t discrete_inputs[DISCRETE_INPUTS_SIZE] = {0}; // Packed bits (8 per byte)
+// v7.9.9.4: word aligned so bit updates can be a 32-bit compare-and-swap
+// (input interrupts update single bits concurrently with the polled inputs)
+static uint8_t discrete_inputs[DISCRETE_INPUTS_SIZE] __attribute__((aligned(4))) = {0};
+
+// Snapshot consistency (v7.9.8.3): every setter bumps reg_write_seq after the
+// store; reg_writers_active is non-zero while a store is in flight. Writers
+// run on several tasks (main loop, Modbus, HTTP), so a plain odd/even seqlock
+// would not hold - the separate in-flight count covers overlapping writers.
+static volatile uint32_t reg_write_seq = 0;
+static volatile uint32_t reg_writers_active = 0;
+
+#define REG_SEQ_SPIN_MAX    64   // Reader polls before giving up the CPU
+#define REG_SEQ_WAIT_TICKS  2    // Reader sleeps waiting for a preempted writer
+
+static inline __attribute__((always_inline)) void reg_write_begin(void) {
+  __atomic_add_fetch(&reg_writers_active, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline __attribute__((always_inline)) void reg_write_end(void) {
+  __atomic_add_fetch(&reg_write_seq, 1, __ATOMIC_RELEASE);
+  __atomic_sub_fetch(&reg_writers_active, 1, __ATOMIC_RELEASE);
+}
+
+static_assert(DISCRETE_INPUTS_SIZE % 4 == 0, "discrete_inputs must be whole words");
+
+// Update bits of one discrete input byte with a CAS on its aligned word, so a
+// concurrent store from an input ISR (other core) to another bit is kept
+static inline __attribute__((always_inline))
+void di_store_bits(uint16_t byte_idx, uint8_t mask, uint8_t bits) {
+  uint32_t *word = (uint32_t*)&discrete_inputs[byte_idx & ~3u];
+  uint32_t shift = (byte_idx & 3u) * 8;   // Little-endian byte order
+  uint32_t wmask = (uint32_t)mask << shift;
+  uint32_t wbits = ((uint32_t)(bits & mask)) << shift;
+  uint32_t old = __atomic_load_n(word, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(word, &old, (old & ~wmask) | wbits, true,
+                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+  }
+}
 
 /* ============================================================================
  * FORWARD DECLARATIONS (handlers called from registers_set_holding_register)
@@ -49,7 +88,9 @@ uint16_t registers_get_holding_register(uint16_t addr) {
 
 void registers_set_holding_register(uint16_t addr, uint16_t value) {
   if (addr >= HOLDING_REGS_SIZE) return;
+  reg_write_begin();
   holding_regs[addr] = value;
+  reg_write_end();
 
   // Process ST Logic control registers
   if (addr >= ST_LOGIC_CONTROL_REG_BASE && addr < ST_LOGIC_CONTROL_REG_BASE + ST_LOGIC_MAX_PROGRAMS) {
@@ -71,6 +112,23 @@ uint16_t* registers_get_holding_regs(void) {
   return holding_regs;
 }
 
+bool registers_holding_is_plain(uint16_t addr) {
+  if (addr >= HOLDING_REGS_SIZE) return false;
+  // Addresses handled by registers_set_holding_register() beyond the store
+  if (addr >= ST_LOGIC_CONTROL_REG_BASE && addr < ST_LOGIC_CONTROL_REG_BASE + ST_LOGIC_MAX_PROGRAMS) return false;
+  if (addr == ST_LOGIC_EXEC_INTERVAL_RW_REG || addr == ST_LOGIC_EXEC_INTERVAL_RW_REG + 1) return false;
+  if (addr >= ST_LOGIC_VAR_INPUT_REG_BASE && addr < ST_LOGIC_VAR_INPUT_REG_BASE + 32) return false;
+  return true;
+}
+
+void registers_batch_begin(void) {
+  reg_write_begin();
+}
+
+void registers_batch_end(void) {
+  reg_write_end();
+}
+
 /* ============================================================================
  * INPUT REGISTERS (Read-Only from Modbus, Write from drivers)
  * ============================================================================ */
@@ -82,7 +140,9 @@ uint16_t registers_get_input_register(uint16_t addr) {
 
 void registers_set_input_register(uint16_t addr, uint16_t value) {
   if (addr >= INPUT_REGS_SIZE) return;
+  reg_write_begin();
   input_regs[addr] = value;
+  reg_write_end();
 }
 
 uint16_t* registers_get_input_regs(void) {
@@ -105,11 +165,15 @@ void registers_set_coil(uint16_t idx, uint8_t value) {
   uint16_t byte_idx = idx / 8;
   uint16_t bit_idx = idx % 8;
 
+  // Atomic bit update: timer_engine sets coils from the esp_timer task
+  // while the main loop and Modbus write other bits of the same byte
+  reg_write_begin();
   if (value) {
-    coils[byte_idx] |= (1 << bit_idx);  // Set bit
+    __atomic_or_fetch(&coils[byte_idx], (uint8_t)(1 << bit_idx), __ATOMIC_RELAXED);   // Set bit
   } else {
-    coils[byte_idx] &= ~(1 << bit_idx); // Clear bit
+    __atomic_and_fetch(&coils[byte_idx], (uint8_t)~(1 << bit_idx), __ATOMIC_RELAXED); // Clear bit
   }
+  reg_write_end();
 }
 
 uint8_t* registers_get_coils(void) {
@@ -132,11 +196,25 @@ void registers_set_discrete_input(uint16_t idx, uint8_t value) {
   uint16_t byte_idx = idx / 8;
   uint16_t bit_idx = idx % 8;
 
-  if (value) {
-    discrete_inputs[byte_idx] |= (1 << bit_idx);  // Set bit
-  } else {
-    discrete_inputs[byte_idx] &= ~(1 << bit_idx); // Clear bit
-  }
+  reg_write_begin();
+  di_store_bits(byte_idx, (uint8_t)(1 << bit_idx), value ? 0xFF : 0);
+  reg_write_end();
+}
+
+void registers_set_discrete_input_bits(uint8_t byte_idx, uint8_t mask, uint8_t bits) {
+  if (byte_idx >= DISCRETE_INPUTS_SIZE) return;
+
+  reg_write_begin();
+  di_store_bits(byte_idx, mask, bits);
+  reg_write_end();
+}
+
+void IRAM_ATTR registers_set_discrete_input_isr(uint8_t byte_idx, uint8_t mask, uint8_t bits) {
+  if (byte_idx >= DISCRETE_INPUTS_SIZE) return;
+
+  reg_write_begin();
+  di_store_bits(byte_idx, mask, bits);
+  reg_write_end();
 }
 
 uint8_t* registers_get_discrete_inputs(void) {
@@ -154,6 +232,36 @@ void registers_init(void) {
   memset(discrete_inputs, 0, sizeof(discrete_inputs));
 }
 
+/* ============================================================================
+ * SNAPSHOT CONSISTENCY (v7.9.8.3)
+ * ============================================================================ */
+
+uint32_t registers_seq_read_begin(void) {
+  // A store takes a few instructions, unless its (lower priority) task was
+  // preempted between begin and end - possibly by this reader on the same
+  // core, where spinning would never let it finish. Spin briefly, then block
+  // so the writer can run. The wait is bounded: a copy started while a store
+  // is still in flight fails registers_seq_read_retry().
+  for (uint32_t spin = 0; spin < REG_SEQ_SPIN_MAX; spin++) {
+    if (__atomic_load_n(&reg_writers_active, __ATOMIC_ACQUIRE) == 0) break;
+  }
+  for (uint32_t t = 0; t < REG_SEQ_WAIT_TICKS; t++) {
+    if (__atomic_load_n(&reg_writers_active, __ATOMIC_ACQUIRE) == 0) break;
+    vTaskDelay(1);
+  }
+  return __atomic_load_n(&reg_write_seq, __ATOMIC_ACQUIRE);
+}
+
+bool registers_seq_read_retry(uint32_t seq) {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&reg_writers_active, __ATOMIC_ACQUIRE) != 0 ||
+         __atomic_load_n(&reg_write_seq, __ATOMIC_ACQUIRE) != seq;
+}
+
+uint32_t registers_get_write_seq(void) {
+  return __atomic_load_n(&reg_write_seq, __ATOMIC_ACQUIRE);
+}
+
 uint32_t registers_get_millis(void) {
   return millis();
 }
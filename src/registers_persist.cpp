@@ -8,9 +8,18 @@
 #include "registers_persist.h"
 #include "registers.h"
 #include "config_struct.h"
+#include "persist_journal.h"
+#include "persist_writer.h"
+#include "config_store.h"
+#include "st_bytecode_persist.h"
+#include "fs_store.h"
+#include "fs_mount.h"
 #include "debug.h"
 #include <cstring>
 #include <Arduino.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 // External reference to global config
 extern PersistConfig g_persist_config;
@@ -31,6 +40,170 @@ static inline uint8_t get_safe_group_count(PersistentRegisterData* pr) {
   return pr->group_count;
 }
 
+/* ============================================================================
+ * GROUP JOURNAL (v7.9.9.5)
+ * ============================================================================ */
+
+// Journal key = group ID (1-8). Records carry a layout tag so values saved
+// for another register list (group edited, deleted and shifted) are ignored.
+static const esp_partition_t* journal_part = NULL;
+static PjFlashOps journal_ops;
+static PersistJournal journal;
+static SemaphoreHandle_t journal_mutex = NULL;
+static uint32_t journal_unchanged = 0;
+
+static bool journal_flash_read(void* ctx, uint32_t addr, void* buf, uint32_t len) {
+  return esp_partition_read((const esp_partition_t*)ctx, addr, buf, len) == ESP_OK;
+}
+
+static bool journal_flash_write(void* ctx, uint32_t addr, const void* buf, uint32_t len) {
+  return esp_partition_write((const esp_partition_t*)ctx, addr, buf, len) == ESP_OK;
+}
+
+static bool journal_flash_erase(void* ctx, uint32_t addr) {
+  return esp_partition_erase_range((const esp_partition_t*)ctx, addr, SPI_FLASH_SEC_SIZE) == ESP_OK;
+}
+
+static uint16_t group_layout_tag(const PersistGroup* grp) {
+  uint16_t crc = pj_crc16(0xFFFF, grp->name, strnlen(grp->name, sizeof(grp->name)));
+  crc = pj_crc16(crc, &grp->reg_count, 1);
+  return pj_crc16(crc, grp->reg_addresses, 2u * grp->reg_count);
+}
+
+// Copy the group's latest journal record into reg_values (mutex held)
+static bool journal_overlay(uint8_t idx) {
+  PersistGroup* grp = &g_persist_config.persist_regs.groups[idx];
+  uint16_t tag;
+  uint16_t values[PJ_MAX_VALUES];
+  uint8_t count;
+  if (!pj_read(&journal, idx + 1, &tag, values, &count)) return false;
+  if (tag != group_layout_tag(grp) || count != grp->reg_count) return false;
+  memcpy(grp->reg_values, values, 2u * count);
+  return true;
+}
+
+// Group snapshot carried by a persist writer job (v7.9.9.6)
+typedef struct {
+  uint16_t tag;
+  uint8_t count;
+  uint16_t values[PJ_MAX_VALUES];
+} JournalJob;
+
+// Append a group snapshot (writer task); skipped if the journal already
+// holds these values. Compared against flash rather than a "changed" flag,
+// because coalescing may drop the job that carried the change.
+static bool journal_exec(uint16_t key, void* data, uint32_t len) {
+  if (len != sizeof(JournalJob)) return false;
+  const JournalJob* job = (const JournalJob*)data;
+  uint8_t pj_key = (uint8_t)(key & 0xFF);
+
+  xSemaphoreTake(journal_mutex, portMAX_DELAY);
+  bool ok;
+  uint16_t last_tag;
+  uint16_t last_values[PJ_MAX_VALUES];
+  uint8_t last_count;
+  if (pj_read(&journal, pj_key, &last_tag, last_values, &last_count) &&
+      last_tag == job->tag && last_count == job->count &&
+      memcmp(last_values, job->values, 2u * job->count) == 0) {
+    journal_unchanged++;
+    ok = true;
+  } else {
+    ok = pj_append(&journal, pj_key, job->tag, job->values, job->count);
+  }
+  xSemaphoreGive(journal_mutex);
+  return ok;
+}
+
+// Queue a group snapshot for the journal
+static bool journal_commit(uint8_t idx) {
+  if (!registers_persist_journal_active()) return true;
+
+  PersistGroup* grp = &g_persist_config.persist_regs.groups[idx];
+  JournalJob job;
+  memset(&job, 0, sizeof(job));
+  job.tag = group_layout_tag(grp);
+  job.count = grp->reg_count > PJ_MAX_VALUES ? PJ_MAX_VALUES : grp->reg_count;
+  memcpy(job.values, grp->reg_values, 2u * job.count);  // PersistGroup is packed
+
+  return persist_writer_submit(PW_KEY_GROUP(idx + 1), journal_exec, &job, sizeof(job), NULL, NULL);
+}
+
+bool registers_persist_journal_init(void) {
+  journal_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          (esp_partition_subtype_t)PERSIST_JOURNAL_SUBTYPE,
+                                          PERSIST_JOURNAL_LABEL);
+  if (journal_part == NULL) {
+    debug_println("Persist journal: no 'pjournal' partition - SAVE() writes NVS");
+    return false;
+  }
+
+  journal_ops.ctx = (void*)journal_part;
+  journal_ops.size = journal_part->size;
+  journal_ops.sector_size = SPI_FLASH_SEC_SIZE;
+  journal_ops.read = journal_flash_read;
+  journal_ops.write = journal_flash_write;
+  journal_ops.erase = journal_flash_erase;
+  if (journal_mutex == NULL) {
+    journal_mutex = xSemaphoreCreateMutex();
+  }
+
+  if (!pj_mount(&journal, &journal_ops)) {
+    debug_println("Persist journal: mount failed - SAVE() writes NVS");
+    return false;
+  }
+
+  uint8_t applied = registers_persist_journal_load(0);
+  debug_print("Persist journal: ");
+  debug_print_uint(journal.sector_count);
+  debug_print(" sectors, ");
+  debug_print_uint(applied);
+  debug_print(" groups from journal");
+  if (journal.stats.torn > 0) {
+    debug_print(", ");
+    debug_print_uint(journal.stats.torn);
+    debug_print(" torn records skipped");
+  }
+  debug_println("");
+  return true;
+}
+
+bool registers_persist_journal_active(void) {
+  return journal_part != NULL && journal.mounted;
+}
+
+uint8_t registers_persist_journal_load(uint8_t group_id) {
+  if (!registers_persist_journal_active()) return 0;
+  uint8_t safe_count = get_safe_group_count(&g_persist_config.persist_regs);
+  if (group_id > safe_count) return 0;
+
+  uint8_t first = group_id ? group_id - 1 : 0;
+  uint8_t last = group_id ? group_id : safe_count;
+  uint8_t applied = 0;
+  xSemaphoreTake(journal_mutex, portMAX_DELAY);
+  for (uint8_t i = first; i < last; i++) {
+    if (journal_overlay(i)) applied++;
+  }
+  xSemaphoreGive(journal_mutex);
+  return applied;
+}
+
+void registers_persist_journal_info(PersistJournalInfo* out) {
+  memset(out, 0, sizeof(*out));
+  out->active = registers_persist_journal_active();
+  if (journal_part == NULL) return;
+
+  out->size = journal_part->size;
+  out->sectors = journal.sector_count;
+  out->active_sector = journal.active;
+  out->free_in_sector = pj_free_in_sector(&journal);
+  out->appends = journal.stats.appends;
+  out->unchanged = journal_unchanged;
+  out->relocated = journal.stats.relocated;
+  out->erases = journal.stats.erases;
+  out->torn = journal.stats.torn;
+  pj_wear(&journal, &out->min_erases, &out->max_erases);
+}
+
 /* ============================================================================
  * INITIALIZATION
  * ============================================================================ */
@@ -281,6 +454,19 @@ bool registers_persist_group_has_reg(const char* group_name, uint16_t reg_addr)
  * SAVE/RESTORE OPERATIONS
  * ============================================================================ */
 
+// Copy current holding register values into the group and journal them
+static bool persist_group_snapshot(uint8_t idx) {
+  PersistGroup* grp = &g_persist_config.persist_regs.groups[idx];
+  for (uint8_t i = 0; i < grp->reg_count; i++) {
+    grp->reg_values[i] = registers_get_holding_register(grp->reg_addresses[i]);
+  }
+
+  // Update timestamp
+  grp->last_save_ms = millis();
+
+  return journal_commit(idx);
+}
+
 bool registers_persist_group_save(const char* group_name) {
   PersistGroup* grp = registers_persist_group_find(group_name);
   if (grp == NULL) {
@@ -291,15 +477,13 @@ bool registers_persist_group_save(const char* group_name) {
   }
 
   // Snapshot current register values
-  for (uint8_t i = 0; i < grp->reg_count; i++) {
-    uint16_t addr = grp->reg_addresses[i];
-    uint16_t value = registers_get_holding_register(addr);
-    grp->reg_values[i] = value;
+  if (!persist_group_snapshot((uint8_t)(grp - g_persist_config.persist_regs.groups))) {
+    debug_print("ERROR: Could not queue journal write for group '");
+    debug_print(group_name);
+    debug_println("'");
+    return false;
   }
 
-  // Update timestamp
-  grp->last_save_ms = millis();
-
   debug_print("✓ Saved group '");
   debug_print(group_name);
   debug_print("' (");
@@ -309,6 +493,19 @@ bool registers_persist_group_save(const char* group_name) {
   return true;
 }
 
+bool registers_persist_group_commit(uint8_t group_id) {
+  uint8_t safe_count = get_safe_group_count(&g_persist_config.persist_regs);
+  if (group_id > safe_count) return false;
+
+  uint8_t first = group_id ? group_id - 1 : 0;
+  uint8_t last = group_id ? group_id : safe_count;
+  bool ok = true;
+  for (uint8_t i = first; i < last; i++) {
+    if (!persist_group_snapshot(i)) ok = false;
+  }
+  return ok;
+}
+
 bool registers_persist_group_save_by_id(uint8_t group_id) {
   PersistentRegisterData* pr = &g_persist_config.persist_regs;
 
@@ -631,6 +828,161 @@ void registers_persist_list_groups(void) {
     debug_println("");
   }
 
+  PersistJournalInfo ji;
+  registers_persist_journal_info(&ji);
+  if (ji.active) {
+    debug_print("Journal: ");
+    debug_print_uint(ji.size / 1024);
+    debug_print(" KB, sector ");
+    debug_print_uint(ji.active_sector);
+    debug_print("/");
+    debug_print_uint(ji.sectors);
+    debug_print(" (");
+    debug_print_uint(ji.free_in_sector);
+    debug_println(" bytes free)");
+    debug_print("  Since boot: ");
+    debug_print_uint(ji.appends);
+    debug_print(" records, ");
+    debug_print_uint(ji.unchanged);
+    debug_print(" unchanged saves skipped, ");
+    debug_print_uint(ji.erases);
+    debug_print(" erases, ");
+    debug_print_uint(ji.relocated);
+    debug_println(" relocated");
+    debug_print("  Sector erases: ");
+    debug_print_uint(ji.min_erases);
+    debug_print("-");
+    debug_print_uint(ji.max_erases);
+    if (ji.torn > 0) {
+      debug_print(", torn records at boot: ");
+      debug_print_uint(ji.torn);
+    }
+    debug_println("");
+  } else {
+    debug_println("Journal: not available (SAVE() writes full config to NVS)");
+  }
+
+  PersistWriterStats ws;
+  persist_writer_get_stats(&ws);
+  debug_print("Writer: ");
+  if (!ws.running) {
+    debug_print("synchronous");
+  } else if (ws.busy_key) {
+    debug_print("writing ");
+    debug_print(persist_writer_key_name(ws.busy_key));
+  } else {
+    debug_print("idle");
+  }
+  debug_print(", ");
+  debug_print_uint(ws.pending);
+  debug_println(" pending");
+  debug_print("  Since boot: ");
+  debug_print_uint(ws.written);
+  debug_print(" writes, ");
+  debug_print_uint(ws.coalesced);
+  debug_print(" coalesced, ");
+  debug_print_uint(ws.failed);
+  debug_print(" failed, ");
+  debug_print_uint(ws.rejected);
+  debug_print(" rejected, max ");
+  debug_print_uint(ws.max_write_ms);
+  debug_println(" ms");
+  if (ws.failed > 0) {
+    debug_print("  Last failure: ");
+    debug_print(persist_writer_key_name(ws.last_fail_key));
+    debug_print(" #");
+    debug_print_uint(ws.last_fail_key & 0xFF);
+    debug_println("");
+  }
+
+  CsStats cs;
+  uint32_t cs_loaded;
+  uint8_t cs_result[CFG_SEC_COUNT];
+  config_store_get_info(&cs, &cs_loaded, cs_result);
+  debug_print("Config sections: ");
+  debug_print_uint(cs.written);
+  debug_print(" written (");
+  debug_print_uint(cs.bytes);
+  debug_print(" bytes), ");
+  debug_print_uint(cs.skipped);
+  debug_print(" unchanged skipped, ");
+  debug_print_uint(cs.errors);
+  debug_println(" errors");
+  debug_print("  ");
+  for (uint8_t i = 0; i < CFG_SEC_COUNT; i++) {
+    debug_print(cs_sections[i].name);
+    debug_print("=");
+    if (!(cs_loaded & CS_BIT(i))) {
+      debug_print("lazy");
+    } else {
+      debug_print(cs_result_name((CsLoadResult)cs_result[i]));
+    }
+    debug_print(" ");
+  }
+  debug_println("");
+
+  StXipInfo xi;
+  st_bytecode_xip_info(&xi);
+  if (xi.active) {
+    debug_print("Bytecode XIP: ");
+    debug_print_uint(xi.size / 1024);
+    debug_print(" KB, ");
+    debug_print_uint(ST_XIP_SLOTS);
+    debug_print(" x ");
+    debug_print_uint(xi.slot_size / 1024);
+    debug_print(" KB slots, ");
+    debug_print_uint(xi.mapped);
+    debug_print(" programs in place (");
+    debug_print_uint(xi.flash_bytes);
+    debug_println(" bytes not in heap)");
+    debug_print("  Since boot: ");
+    debug_print_uint(xi.writes);
+    debug_print(" images written, ");
+    debug_print_uint(xi.fallbacks);
+    debug_println(" too large (LittleFS)");
+  } else {
+    debug_println("Bytecode XIP: not available (bytecode cache in LittleFS, loaded to heap)");
+  }
+
+  // v7.9.10.3: ST sources and .bc fallback on LittleFS (mounted on first use)
+  FsMountInfo fi;
+  fs_mount_info(&fi);
+  if (fi.mounted) {
+    const FsStats *fst = fs_store_stats();
+    debug_print("Filesystem: LittleFS ");
+    debug_print_uint(fi.used_bytes / 1024);
+    debug_print(" / ");
+    debug_print_uint(fi.total_bytes / 1024);
+    debug_print(" KB used, mount ");
+    debug_print_uint(fi.mount_us / 1000);
+    debug_println(" ms");
+    debug_print("  Since boot: ");
+    debug_print_uint(fst->reads);
+    debug_print(" reads (");
+    debug_print_uint(fs_kb_per_s(fst->read_bytes, fst->read_us));
+    debug_print(" KB/s), ");
+    debug_print_uint(fst->commits);
+    debug_print(" atomic writes (");
+    debug_print_uint(fs_kb_per_s(fst->write_bytes, fst->write_us));
+    debug_print(" KB/s), ");
+    debug_print_uint(fst->errors);
+    debug_print(" errors, ");
+    debug_print_uint(fst->stale_tmp);
+    debug_println(" interrupted writes cleaned up");
+    if (fi.migrated_files) {
+      debug_print("  Migrated from SPIFFS this boot: ");
+      debug_print_uint(fi.migrated_files);
+      debug_print(" files, ");
+      debug_print_uint(fi.migrated_bytes);
+      debug_print(" bytes in ");
+      debug_print_uint(fi.migrate_us / 1000);
+      debug_println(" ms");
+    }
+  } else {
+    debug_println("Filesystem: LittleFS not mounted (not needed yet or mount failed)");
+  }
+  debug_println("");
+
   debug_println("CLI commands:");
   debug_println("  set persist auto-load enable");
   debug_println("  set persist auto-load add <group_id>");
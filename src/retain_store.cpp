@@ -0,0 +1,118 @@
+/**
+ * @file retain_store.cpp
+ * @brief Double-buffered snapshot area for warm-restart retention (v7.9.10.2)
+ *
+ * LAYER 4: Register Persistence - Retained RAM image (pure data structure)
+ * Sections are padded to 4 bytes so payloads stay word aligned for the
+ * caller's structs.
+ */
+
+#include "retain_store.h"
+#include <stddef.h>
+#include <string.h>
+
+#define RS_ALIGN(n)   (((n) + 3u) & ~3u)
+
+static RsSlotHeader *slot_hdr(const RetainStore *s, uint8_t slot) {
+  return (RsSlotHeader *)(s->mem + slot * s->slot_size);
+}
+
+static uint8_t *slot_data(const RetainStore *s, uint8_t slot) {
+  return s->mem + slot * s->slot_size + sizeof(RsSlotHeader);
+}
+
+static bool slot_valid(const RetainStore *s, uint8_t slot) {
+  const RsSlotHeader *h = slot_hdr(s, slot);
+  if (h->magic != RS_MAGIC || h->layout != s->layout) return false;
+  if (s->crc(0, (const uint8_t *)h, offsetof(RsSlotHeader, hdr_crc)) != h->hdr_crc) return false;
+  if (h->len > s->slot_size - sizeof(RsSlotHeader)) return false;
+  return s->crc(0, slot_data(s, slot), h->len) == h->crc;
+}
+
+// Newest valid slot, -1 if none
+static int newest_slot(const RetainStore *s) {
+  bool v0 = slot_valid(s, 0);
+  bool v1 = slot_valid(s, 1);
+  if (v0 && v1) return (int32_t)(slot_hdr(s, 1)->seq - slot_hdr(s, 0)->seq) > 0 ? 1 : 0;
+  if (v0) return 0;
+  if (v1) return 1;
+  return -1;
+}
+
+void rs_init(RetainStore *s, void *mem, uint32_t size, uint32_t layout, rs_crc_fn crc) {
+  memset(s, 0, sizeof(*s));
+  s->mem = (uint8_t *)mem;
+  s->slot_size = (size / 2) & ~3u;
+  s->layout = layout;
+  s->crc = crc;
+}
+
+const uint8_t *rs_latest(RetainStore *s, uint32_t *len, uint32_t *seq) {
+  int slot = newest_slot(s);
+  if (slot < 0) return NULL;
+  const RsSlotHeader *h = slot_hdr(s, (uint8_t)slot);
+  *len = h->len;
+  if (seq) *seq = h->seq;
+  return slot_data(s, (uint8_t)slot);
+}
+
+void rs_begin(RetainStore *s) {
+  int newest = newest_slot(s);
+  s->slot = newest == 0 ? 1 : 0;
+  s->seq = newest < 0 ? 0 : slot_hdr(s, (uint8_t)newest)->seq;
+  memset(slot_hdr(s, s->slot), 0, sizeof(RsSlotHeader));
+  s->pos = 0;
+  s->dropped = 0;
+  s->open = true;
+}
+
+uint8_t *rs_section(RetainStore *s, uint8_t type, uint8_t id, uint16_t len) {
+  if (!s->open) return NULL;
+  uint32_t need = sizeof(RsSection) + RS_ALIGN(len);
+  if (s->pos + need > s->slot_size - sizeof(RsSlotHeader)) {
+    s->dropped++;
+    return NULL;
+  }
+  uint8_t *p = slot_data(s, s->slot) + s->pos;
+  RsSection sec;
+  sec.type = type;
+  sec.id = id;
+  sec.len = len;
+  memcpy(p, &sec, sizeof(sec));
+  memset(p + sizeof(sec) + len, 0, RS_ALIGN(len) - len);
+  s->pos += need;
+  return p + sizeof(sec);
+}
+
+uint32_t rs_commit(RetainStore *s) {
+  if (!s->open) return 0;
+  RsSlotHeader h;
+  h.magic = RS_MAGIC;
+  h.layout = s->layout;
+  h.seq = s->seq + 1;
+  h.len = s->pos;
+  h.crc = s->crc(0, slot_data(s, s->slot), s->pos);
+  h.hdr_crc = s->crc(0, (const uint8_t *)&h, offsetof(RsSlotHeader, hdr_crc));
+  memcpy(slot_hdr(s, s->slot), &h, sizeof(h));
+  s->seq = h.seq;
+  s->open = false;
+  return s->pos;
+}
+
+void rs_clear(RetainStore *s) {
+  memset(slot_hdr(s, 0), 0, sizeof(RsSlotHeader));
+  memset(slot_hdr(s, 1), 0, sizeof(RsSlotHeader));
+  s->seq = 0;
+  s->open = false;
+}
+
+bool rs_next(const uint8_t *data, uint32_t len, uint32_t *pos,
+             RsSection *sec, const uint8_t **payload) {
+  if (*pos + sizeof(RsSection) > len) return false;
+  memcpy(sec, data + *pos, sizeof(*sec));
+  uint32_t next = *pos + sizeof(RsSection) + RS_ALIGN(sec->len);
+  if (next > len) return false;
+  *payload = data + *pos + sizeof(RsSection);
+  *pos = next;
+  return true;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file session_token.cpp
+ * @brief Short-lived HTTP session tokens (v7.9.8.4)
+ *
+ * LAYER 2: Security
+ * Token format: "SSxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx" — SS = slot index (hex),
+ * followed by SESSION_TOKEN_SECRET_LEN hex chars from esp_random(). Only the
+ * addressed slot is compared, and the compare never exits early.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <Arduino.h>
+
+#include "session_token.h"
+
+typedef struct {
+  char     secret[SESSION_TOKEN_SECRET_LEN + 1];
+  int      user_idx;
+  uint32_t issued_ms;
+  uint32_t last_used_ms;
+  bool     active;
+} SessionSlot;
+
+static SessionSlot sessions[SESSION_TOKEN_SLOTS];
+static portMUX_TYPE session_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool session_expired(const SessionSlot *s, uint32_t now)
+{
+  return (now - s->last_used_ms) >= SESSION_TOKEN_IDLE_MS ||
+         (now - s->issued_ms) >= SESSION_TOKEN_MAX_AGE_MS;
+}
+
+// Timing does not depend on where the first mismatch is
+static bool ct_equal(const char *a, const char *b, size_t n)
+{
+  uint8_t diff = 0;
+  for (size_t i = 0; i < n; i++) {
+    diff |= (uint8_t)(a[i] ^ b[i]);
+  }
+  return diff == 0;
+}
+
+static int hex_nibble(char c)
+{
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// Slot addressed by a well-formed token, or -1
+static int session_slot_of(const char *token)
+{
+  if (!token || strnlen(token, SESSION_TOKEN_LEN + 1) != SESSION_TOKEN_LEN) return -1;
+  int hi = hex_nibble(token[0]);
+  int lo = hex_nibble(token[1]);
+  if (hi < 0 || lo < 0) return -1;
+  int slot = hi * 16 + lo;
+  return slot < SESSION_TOKEN_SLOTS ? slot : -1;
+}
+
+bool session_token_issue(int user_idx, char *out, size_t out_len)
+{
+  if (user_idx < 0 || !out || out_len < SESSION_TOKEN_LEN + 1) return false;
+
+  // Generate the secret outside the critical section
+  char secret[SESSION_TOKEN_SECRET_LEN + 1];
+  snprintf(secret, sizeof(secret), "%08lx%08lx%08lx%06lx",
+           (unsigned long)esp_random(), (unsigned long)esp_random(),
+           (unsigned long)esp_random(), (unsigned long)(esp_random() & 0x00FFFFFF));
+
+  uint32_t now = millis();
+  int slot = -1;
+
+  taskENTER_CRITICAL(&session_mux);
+  uint32_t max_idle = 0;
+  for (int i = 0; i < SESSION_TOKEN_SLOTS; i++) {
+    SessionSlot *s = &sessions[i];
+    if (!s->active || session_expired(s, now)) { slot = i; break; }
+    // Evict the session idle the longest if the table is full
+    if (now - s->last_used_ms >= max_idle) {
+      max_idle = now - s->last_used_ms;
+      slot = i;
+    }
+  }
+  SessionSlot *s = &sessions[slot];
+  memcpy(s->secret, secret, sizeof(s->secret));
+  s->user_idx = user_idx;
+  s->issued_ms = now;
+  s->last_used_ms = now;
+  s->active = true;
+  taskEXIT_CRITICAL(&session_mux);
+
+  snprintf(out, out_len, "%02x%s", slot, secret);
+  return true;
+}
+
+int session_token_check(const char *token)
+{
+  int slot = session_slot_of(token);
+  if (slot < 0) return -1;
+
+  uint32_t now = millis();
+  int user_idx = -1;
+
+  taskENTER_CRITICAL(&session_mux);
+  SessionSlot *s = &sessions[slot];
+  if (s->active) {
+    if (session_expired(s, now)) {
+      s->active = false;
+    } else if (ct_equal(s->secret, token + 2, SESSION_TOKEN_SECRET_LEN)) {
+      user_idx = s->user_idx;
+      s->last_used_ms = now;
+    }
+  }
+  taskEXIT_CRITICAL(&session_mux);
+  return user_idx;
+}
+
+bool session_token_revoke(const char *token)
+{
+  int slot = session_slot_of(token);
+  if (slot < 0) return false;
+
+  bool revoked = false;
+  taskENTER_CRITICAL(&session_mux);
+  SessionSlot *s = &sessions[slot];
+  if (s->active && ct_equal(s->secret, token + 2, SESSION_TOKEN_SECRET_LEN)) {
+    s->active = false;
+    revoked = true;
+  }
+  taskEXIT_CRITICAL(&session_mux);
+  return revoked;
+}
+
+void session_token_revoke_user(int user_idx)
+{
+  taskENTER_CRITICAL(&session_mux);
+  for (int i = 0; i < SESSION_TOKEN_SLOTS; i++) {
+    if (sessions[i].active && sessions[i].user_idx == user_idx) {
+      sessions[i].active = false;
+    }
+  }
+  taskEXIT_CRITICAL(&session_mux);
+}
+
+void session_token_revoke_all(void)
+{
+  taskENTER_CRITICAL(&session_mux);
+  for (int i = 0; i < SESSION_TOKEN_SLOTS; i++) {
+    sessions[i].active = false;
+  }
+  taskEXIT_CRITICAL(&session_mux);
+}
+
+int session_token_active_count(void)
+{
+  uint32_t now = millis();
+  int count = 0;
+  taskENTER_CRITICAL(&session_mux);
+  for (int i = 0; i < SESSION_TOKEN_SLOTS; i++) {
+    if (sessions[i].active && !session_expired(&sessions[i], now)) count++;
+  }
+  taskEXIT_CRITICAL(&session_mux);
+  return count;
+}
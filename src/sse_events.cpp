@@ -32,6 +32,7 @@
 #include "registers.h"
 #include "counter_engine.h"
 #include "timer_engine.h"
+#include "di_irq.h"
 #include "config_struct.h"
 #include "build_version.h"
 #include "debug.h"
@@ -131,6 +132,8 @@ typedef struct {
   uint8_t  watched_di[SSE_MAX_WATCH_PER_TYPE];
   SseWatchList watch;
   uint32_t last_heartbeat_ms;
+  uint32_t input_cursor;        // Next di_irq event to send (FEAT-163)
+  uint32_t input_lost;          // Events lost since the last one sent
 } SseClientState;
 
 // Full-range state for watch_all mode (heap-allocated, ~1.5 KB per client)
@@ -241,6 +244,7 @@ static uint8_t sse_parse_query(const char *query, SseWatchList *watch)
     if (strstr(subscribe, "timers"))   topics |= SSE_TOPIC_TIMERS;
     if (strstr(subscribe, "registers")) topics |= SSE_TOPIC_REGISTERS;
     if (strstr(subscribe, "system"))   topics |= SSE_TOPIC_SYSTEM;
+    if (strstr(subscribe, "inputs"))   topics |= SSE_TOPIC_INPUTS;
     if (strstr(subscribe, "all"))      { topics = SSE_TOPIC_ALL; is_subscribe_all = true; }
   }
   if (!topics) { topics = SSE_TOPIC_ALL; is_subscribe_all = true; }
@@ -516,6 +520,7 @@ static void sse_client_task(void *arg)
     }
     sse_snapshot_timers(state);
     state->last_heartbeat_ms = millis();
+    state->input_cursor = di_irq_events_head();  // Only edges from now on
 
     // Allocate full-range state for watch_all mode (~1.5 KB)
     SseWatchAllState *all_state = NULL;
@@ -679,6 +684,23 @@ static void sse_client_task(void *arg)
         }
       }
 
+      // Input edges (FEAT-163): every change recorded by an input interrupt,
+      // in order, with the ISR's µs timestamp
+      if (topics & SSE_TOPIC_INPUTS) {
+        DiEvent ev[8];
+        uint32_t n;
+        while ((n = di_irq_events_read(&state->input_cursor, ev, 8, &state->input_lost)) > 0) {
+          for (uint32_t k = 0; k < n; k++) {
+            char data[96];
+            snprintf(data, sizeof(data),
+              "{\"pin\":%u,\"level\":%u,\"t_us\":%lu,\"lost\":%lu}",
+              ev[k].pin, ev[k].level, (unsigned long)ev[k].t_us, (unsigned long)state->input_lost);
+            if (!sse_send_event_fd(fd, "input", data)) { free(all_state); free(state); goto done; }
+            state->input_lost = 0;
+          }
+        }
+      }
+
       // Heartbeat keepalive
       uint32_t now = millis();
       if (now - state->last_heartbeat_ms >= sse_cfg_heartbeat()) {
@@ -962,7 +984,7 @@ esp_err_t api_handler_sse_status(httpd_req_t *req)
   snprintf(buf, sizeof(buf),
     "{\"sse_enabled\":%s,\"sse_port\":%d,\"max_clients\":%d,\"active_clients\":%d,"
     "\"check_interval_ms\":%d,\"heartbeat_ms\":%d,"
-    "\"topics\":[\"counters\",\"timers\",\"registers\",\"system\"],"
+    "\"topics\":[\"counters\",\"timers\",\"registers\",\"system\",\"inputs\"],"
     "\"endpoint\":\"http://<ip>:%d/api/events?subscribe=<topics>&token=<token>\"%s}",
     sse_cfg_enabled() ? "true" : "false",
     sse_port, (int)sse_cfg_max_clients(), (int)sse_active_clients,
@@ -1021,6 +1043,7 @@ esp_err_t api_handler_sse_clients(httpd_req_t *req)
       if (t & 0x02) strcat(topics_str, "tmr,");
       if (t & 0x04) strcat(topics_str, "reg,");
       if (t & 0x08) strcat(topics_str, "sys,");
+      if (t & 0x10) strcat(topics_str, "in,");
       size_t len = strlen(topics_str);
       if (len > 0) topics_str[len - 1] = '\0'; // remove trailing comma
     }
@@ -0,0 +1,187 @@
+/**
+ * @file st_binding_plan.cpp
+ * @brief Precompiled copy list for ST variable bindings (v7.9.9.3)
+ *
+ * LAYER 4: Register/Coil Storage (pure logic)
+ */
+
+#include "st_binding_plan.h"
+#include <string.h>
+
+// Words outside the holding register table
+static uint16_t bind_zero_words[2] = {0, 0};    // Read as 0
+static uint16_t bind_sink_words[2];             // Writes discarded
+
+static uint16_t* bind_in_word(const st_bind_target_t *t, uint32_t addr, uint8_t w) {
+  return (addr < HOLDING_REGS_SIZE) ? &t->holding[addr] : &bind_zero_words[w];
+}
+
+static uint16_t* bind_out_word(const st_bind_target_t *t, uint32_t addr, uint8_t w) {
+  return (addr < HOLDING_REGS_SIZE) ? &t->holding[addr] : &bind_sink_words[w];
+}
+
+// Mirrors the per-binding INPUT branch gpio_mapping ran every cycle
+static bool bind_compile_input(const VariableMapping *map, const st_bind_target_t *t,
+                               st_value_t *var, st_datatype_t type, st_bind_entry_t *e) {
+  if (map->input_reg == 65535) return false;
+
+  uint8_t word_count = (map->word_count > 0) ? map->word_count : 1;
+  if (map->input_type == 1) {
+    if (map->input_reg >= DISCRETE_INPUTS_SIZE * 8) return false;
+  } else if (map->input_type == 2) {
+    if (map->input_reg >= COILS_SIZE * 8) return false;
+  } else {
+    if (map->input_reg + word_count > HOLDING_REGS_SIZE) return false;
+  }
+
+  e->var = var;
+  e->addr = map->input_reg;
+  switch (type) {
+    case ST_TYPE_BOOL:
+      if (map->input_type == 1 || map->input_type == 2) {
+        uint8_t *bytes = (map->input_type == 1) ? t->discrete : t->coils;
+        e->op = ST_BIND_IN_BIT_BOOL;
+        e->bits = &bytes[map->input_reg / 8];
+        e->mask = (uint8_t)(1u << (map->input_reg % 8));
+      } else {
+        e->op = ST_BIND_IN_REG_BOOL;
+        e->reg[0] = bind_in_word(t, map->input_reg, 0);
+      }
+      return true;
+    case ST_TYPE_INT:
+      e->op = ST_BIND_IN_REG16;
+      e->reg[0] = bind_in_word(t, map->input_reg, 0);
+      return true;
+    case ST_TYPE_DINT:
+    case ST_TYPE_DWORD:
+    case ST_TYPE_REAL:
+      // Same 32-bit pattern for all three (REAL is reinterpreted, not converted)
+      e->op = ST_BIND_IN_REG32;
+      e->reg[0] = bind_in_word(t, map->input_reg, 0);
+      e->reg[1] = bind_in_word(t, (uint32_t)map->input_reg + 1, 1);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Mirrors the per-binding OUTPUT branch gpio_mapping ran every cycle
+static bool bind_compile_output(const VariableMapping *map, const st_bind_target_t *t,
+                                st_value_t *var, st_datatype_t type, st_bind_entry_t *e) {
+  if (map->coil_reg == 65535) return false;
+
+  e->var = var;
+  e->addr = map->coil_reg;
+
+  if (map->output_type == 1) {
+    if (map->coil_reg >= COILS_SIZE * 8) return false;
+    e->op = (type == ST_TYPE_BOOL) ? ST_BIND_OUT_BOOL_COIL : ST_BIND_OUT_INT_COIL;
+    return true;
+  }
+
+  uint8_t words;
+  switch (type) {
+    case ST_TYPE_BOOL:  e->op = ST_BIND_OUT_BOOL_REG; words = 1; break;
+    case ST_TYPE_INT:   e->op = ST_BIND_OUT_REG16;    words = 1; break;
+    case ST_TYPE_DINT:
+    case ST_TYPE_DWORD:
+    case ST_TYPE_REAL:  e->op = ST_BIND_OUT_REG32;    words = 2; break;
+    default:            return false;
+  }
+
+  bool plain = true;
+  for (uint8_t w = 0; w < words; w++) {
+    uint32_t addr = (uint32_t)map->coil_reg + w;
+    e->reg[w] = bind_out_word(t, addr, w);
+    if (addr < HOLDING_REGS_SIZE && !t->holding_plain((uint16_t)addr)) plain = false;
+  }
+  if (!plain) e->op |= ST_BIND_VIA_SETTER;
+  return true;
+}
+
+void st_binding_plan_build(st_binding_plan_t *plan, const VariableMapping *maps, uint8_t count,
+                           const st_bind_target_t *target) {
+  memset(plan, 0, sizeof(*plan));
+
+  for (uint8_t i = 0; i < count; i++) {
+    const VariableMapping *map = &maps[i];
+    if (map->source_type != MAPPING_SOURCE_ST_VAR) continue;
+
+    st_datatype_t type = ST_TYPE_NONE;
+    st_value_t *var = target->resolve_var(map->st_program_id, map->st_var_index, &type);
+    if (!var) continue;
+
+    st_bind_entry_t e;
+    memset(&e, 0, sizeof(e));
+    if (map->is_input) {
+      if (plan->in_count < ST_BIND_MAX_ENTRIES && bind_compile_input(map, target, var, type, &e)) {
+        plan->in[plan->in_count++] = e;
+      }
+    } else {
+      if (plan->out_count < ST_BIND_MAX_ENTRIES && bind_compile_output(map, target, var, type, &e)) {
+        if (e.op & ST_BIND_VIA_SETTER) plan->setter_count++;
+        plan->out[plan->out_count++] = e;
+      }
+    }
+  }
+}
+
+void st_binding_plan_run_inputs(const st_binding_plan_t *plan) {
+  const st_bind_entry_t *e = plan->in;
+  const st_bind_entry_t *end = e + plan->in_count;
+
+  for (; e < end; e++) {
+    switch (e->op) {
+      case ST_BIND_IN_BIT_BOOL:
+        e->var->bool_val = (*e->bits & e->mask) != 0;
+        break;
+      case ST_BIND_IN_REG_BOOL:
+        e->var->bool_val = (*e->reg[0] != 0);
+        break;
+      case ST_BIND_IN_REG16:
+        e->var->int_val = (int16_t)*e->reg[0];
+        break;
+      case ST_BIND_IN_REG32:
+        e->var->dword_val = ((uint32_t)*e->reg[1] << 16) | *e->reg[0];
+        break;
+    }
+  }
+}
+
+void st_binding_plan_run_outputs(const st_binding_plan_t *plan, const st_bind_io_t *io) {
+  const st_bind_entry_t *e = plan->out;
+  const st_bind_entry_t *end = e + plan->out_count;
+
+  for (; e < end; e++) {
+    switch (e->op) {
+      case ST_BIND_OUT_BOOL_COIL:
+        io->set_coil(e->addr, e->var->bool_val ? 1 : 0);
+        break;
+      case ST_BIND_OUT_INT_COIL:
+        io->set_coil(e->addr, (e->var->int_val != 0) ? 1 : 0);
+        break;
+      case ST_BIND_OUT_BOOL_REG:
+        *e->reg[0] = e->var->bool_val ? 1 : 0;
+        break;
+      case ST_BIND_OUT_REG16:
+        *e->reg[0] = (uint16_t)e->var->int_val;
+        break;
+      case ST_BIND_OUT_REG32:
+        *e->reg[0] = (uint16_t)(e->var->dword_val & 0xFFFF);
+        *e->reg[1] = (uint16_t)(e->var->dword_val >> 16);
+        break;
+
+      // Side-effect registers: same values, through the setter
+      case ST_BIND_OUT_BOOL_REG | ST_BIND_VIA_SETTER:
+        io->set_holding(e->addr, e->var->bool_val ? 1 : 0);
+        break;
+      case ST_BIND_OUT_REG16 | ST_BIND_VIA_SETTER:
+        io->set_holding(e->addr, (uint16_t)e->var->int_val);
+        break;
+      case ST_BIND_OUT_REG32 | ST_BIND_VIA_SETTER:
+        io->set_holding(e->addr, (uint16_t)(e->var->dword_val & 0xFFFF));
+        io->set_holding(e->addr + 1, (uint16_t)(e->var->dword_val >> 16));
+        break;
+    }
+  }
+}
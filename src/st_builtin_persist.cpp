@@ -3,6 +3,9 @@
  * @brief ST Logic persistence built-in functions implementation
  *
  * Implements SAVE() and LOAD() for register persistence from ST programs.
+ *
+ * v7.9.9.5: with the group journal available SAVE() appends one small record
+ * per group instead of rewriting the whole config, so it is not rate limited.
  */
 
 #include "st_builtin_persist.h"
@@ -25,6 +28,16 @@ st_value_t st_builtin_persist_save(st_value_t group_id_arg) {
   st_value_t result;
   uint8_t group_id = (uint8_t)group_id_arg.int_val;
 
+  // Journal: snapshot + append, quiet (may be called every cycle)
+  if (registers_persist_journal_active()) {
+    if (!registers_persist_is_enabled()) {
+      result.int_val = -1;
+      return result;
+    }
+    result.int_val = registers_persist_group_commit(group_id) ? 0 : -1;
+    return result;
+  }
+
   // Rate limiting: Max 1 save per 5 seconds (protect flash wear)
   uint32_t now = millis();
   if (now - last_save_ms < 5000) {
@@ -96,6 +109,13 @@ st_value_t st_builtin_persist_load(st_value_t group_id_arg) {
   st_value_t result;
   uint8_t group_id = (uint8_t)group_id_arg.int_val;
 
+  // Journal: it holds the latest saved values of each group
+  if (registers_persist_journal_active()) {
+    registers_persist_journal_load(group_id);
+    result.int_val = registers_persist_group_restore_by_id(group_id) ? 0 : -1;
+    return result;
+  }
+
   // Step 1: Load config from NVS
   debug_print("LOAD(");
   debug_print_uint(group_id);
@@ -92,12 +92,22 @@ st_value_t st_builtin_hysteresis(st_value_t in, st_value_t high, st_value_t low,
  * BLINK - Periodic Pulse Generator
  * ============================================================================ */
 
+// Enter a blink phase at `start` and schedule its end on the wheel
+static void blink_enter(st_blink_instance_t* instance, st_timer_wheel_t* wheel,
+                        uint8_t state, uint32_t start, uint32_t duration) {
+  instance->state = state;
+  instance->Q = (state == 1);
+  instance->timer = start;
+  instance->period = duration;
+  st_wheel_schedule(wheel, instance->wheel_node, start + duration);
+}
+
 st_value_t st_builtin_blink(st_value_t enable, st_value_t on_time, st_value_t off_time,
-                             st_blink_instance_t* instance) {
+                             st_blink_instance_t* instance, st_timer_wheel_t* wheel) {
   st_value_t result;
   result.bool_val = false;
 
-  if (!instance) {
+  if (!instance || !wheel) {
     return result;  // No storage - cannot maintain state
   }
 
@@ -109,6 +119,7 @@ st_value_t st_builtin_blink(st_value_t enable, st_value_t on_time, st_value_t of
     // Invalid time → disable blinking and return false
     instance->Q = false;
     instance->state = 0;  // IDLE
+    st_wheel_cancel(wheel, instance->wheel_node);
     result.bool_val = false;
     return result;
   }
@@ -116,43 +127,41 @@ st_value_t st_builtin_blink(st_value_t enable, st_value_t on_time, st_value_t of
   uint32_t on_time_ms = (uint32_t)on_time.int_val;
   uint32_t off_time_ms = (uint32_t)off_time.int_val;
 
-  // Get current timestamp
-  uint32_t now = millis();
+  // Cycle timestamp (wheel advanced by the engine at cycle start)
+  uint32_t now = wheel->now;
 
   // BUG-170 NOTE: millis() wraparound handling
-  // millis() wraps around after ~49.7 days (2^32 milliseconds).
-  // The expression (now - instance->timer) uses unsigned arithmetic which correctly
-  // handles wraparound due to two's complement modulo arithmetic (per C standard).
-  // Example: If timer=4294967290 and now=5 (after wrap), then:
-  //   now - timer = 5 - 4294967290 = 15 (via uint32_t wraparound)
-  // This is mathematically correct and no special handling is needed.
+  // Phase deadlines are timer + duration in wrapping uint32_t arithmetic; the
+  // wheel compares them with signed differences, so the wrap after ~49.7
+  // days needs no special handling.
 
   // State machine
   if (!enable_val) {
     // Disabled - reset to IDLE
+    if (instance->state != 0) st_wheel_cancel(wheel, instance->wheel_node);
     instance->Q = false;
     instance->state = 0;  // IDLE
     instance->timer = now;
+  } else if (instance->state == 0) {
+    // IDLE → Start blinking
+    blink_enter(instance, wheel, 1, now, on_time_ms);  // ON_PHASE
   } else {
-    if (instance->state == 0) {
-      // IDLE → Start blinking
-      instance->Q = true;
-      instance->timer = now;
-      instance->state = 1;  // ON_PHASE
-    } else if (instance->state == 1) {
-      // ON_PHASE - check if ON duration expired
-      if ((now - instance->timer) >= on_time_ms) {
-        instance->Q = false;
-        instance->timer = now;
-        instance->state = 2;  // OFF_PHASE
-      }
-    } else if (instance->state == 2) {
-      // OFF_PHASE - check if OFF duration expired
-      if ((now - instance->timer) >= off_time_ms) {
-        instance->Q = true;
-        instance->timer = now;
-        instance->state = 1;  // ON_PHASE
-      }
+    uint32_t duration = (instance->state == 1) ? on_time_ms : off_time_ms;
+    if (duration != instance->period) {
+      // ON/OFF time changed mid-phase: move the deadline
+      instance->period = duration;
+      st_wheel_schedule(wheel, instance->wheel_node, instance->timer + duration);
+    }
+
+    // Phase duration expired → switch phase. The next phase starts at the
+    // deadline (no drift from cycle jitter), or at now if that is already
+    // past as well (e.g. the program was paused).
+    if (st_wheel_take_fired(wheel, instance->wheel_node)) {
+      uint32_t start = instance->timer + duration;
+      uint8_t next = (instance->state == 1) ? 2 : 1;
+      uint32_t next_duration = (next == 1) ? on_time_ms : off_time_ms;
+      if ((int32_t)(start + next_duration - now) <= 0) start = now;
+      blink_enter(instance, wheel, next, start, next_duration);
     }
   }
 
@@ -3,19 +3,57 @@
  * @brief ST Timer Implementation (TON, TOF, TP)
  *
  * Implements IEC 61131-3 standard timers with millisecond precision.
+ *
+ * v7.9.9.0: Deadlines are tracked by the program's timer wheel. A timer
+ * schedules start_time + PT when it starts, cancels it when it is aborted,
+ * and finishes when the wheel reports the node as fired.
  */
 
 #include "st_builtin_timers.h"
 
+/* ============================================================================
+ * DEADLINE HELPERS
+ * ============================================================================ */
+
+// Start timing at the cycle timestamp
+static void timer_start(st_timer_instance_t* instance, st_timer_wheel_t* wheel, uint32_t preset_time) {
+  instance->start_time = wheel->now;
+  instance->PT = preset_time;
+  instance->running = true;
+  instance->ET = 0;
+  st_wheel_schedule(wheel, instance->wheel_node, instance->start_time + preset_time);
+}
+
+// Abort timing (deadline no longer relevant)
+static void timer_stop(st_timer_instance_t* instance, st_timer_wheel_t* wheel) {
+  if (instance->running) st_wheel_cancel(wheel, instance->wheel_node);
+  instance->running = false;
+  instance->ET = 0;
+}
+
+// true once the deadline of a running timer is reached
+static bool timer_expired(st_timer_instance_t* instance, st_timer_wheel_t* wheel, uint32_t preset_time) {
+  if (preset_time != instance->PT) {
+    // PT changed while running: move the deadline (fires now if already passed)
+    instance->PT = preset_time;
+    st_wheel_schedule(wheel, instance->wheel_node, instance->start_time + preset_time);
+  }
+  if (!st_wheel_take_fired(wheel, instance->wheel_node)) return false;
+  instance->running = false;
+  instance->ET = preset_time;
+  return true;
+}
+
 /* ============================================================================
  * TON - On-Delay Timer
  * ============================================================================ */
 
-st_value_t st_builtin_ton(st_value_t IN, st_value_t PT, st_timer_instance_t* instance) {
+st_value_t st_builtin_ton(st_value_t IN, st_value_t PT, st_timer_instance_t* instance,
+                          st_timer_wheel_t* wheel) {
   st_value_t result;
   result.bool_val = false;
 
-  if (!instance) {
+  if (!instance || !wheel) {
     return result;  // No storage - cannot run timer
   }
 
@@ -23,36 +61,25 @@ st_value_t st_builtin_ton(st_value_t IN, st_value_t PT, st_timer_instance_t* ins
   // v4.7+: PT validation - negative values → 0 (prevent huge unsigned conversion)
   // FEAT-121: Use dint_val for TIME support (32-bit range, up to ~24.8 days)
   uint32_t preset_time = (PT.dint_val < 0) ? 0 : (uint32_t)PT.dint_val;
-  uint32_t now = millis();
 
   // Detect rising edge on IN
   bool rising_edge = (current_IN && !instance->last_IN);
 
   if (rising_edge) {
     // Start timer on rising edge
-    instance->start_time = now;
-    instance->running = true;
-    instance->ET = 0;
     instance->Q = false;
+    timer_start(instance, wheel, preset_time);
   }
 
   if (current_IN) {
-    // Input is HIGH
-    if (instance->running) {
-      // Update elapsed time
-      instance->ET = now - instance->start_time;
-
-      // Check if preset time expired
-      if (instance->ET >= preset_time) {
-        instance->Q = true;
-        instance->running = false;  // Timer done
-      }
+    // Input is HIGH - Q goes TRUE when the deadline fires
+    if (instance->running && timer_expired(instance, wheel, preset_time)) {
+      instance->Q = true;
     }
   } else {
     // Input is LOW - reset timer immediately
     instance->Q = false;
-    instance->ET = 0;
-    instance->running = false;
+    timer_stop(instance, wheel);
   }
 
   // Update last state
@@ -67,11 +94,12 @@ st_value_t st_builtin_ton(st_value_t IN, st_value_t PT, st_timer_instance_t* ins
  * TOF - Off-Delay Timer
  * ============================================================================ */
 
-st_value_t st_builtin_tof(st_value_t IN, st_value_t PT, st_timer_instance_t* instance) {
+st_value_t st_builtin_tof(st_value_t IN, st_value_t PT, st_timer_instance_t* instance,
+                          st_timer_wheel_t* wheel) {
   st_value_t result;
   result.bool_val = false;
 
-  if (!instance) {
+  if (!instance || !wheel) {
     return result;  // No storage - cannot run timer
   }
 
@@ -79,36 +107,25 @@ st_value_t st_builtin_tof(st_value_t IN, st_value_t PT, st_timer_instance_t* ins
   // v4.7+: PT validation - negative values → 0 (prevent huge unsigned conversion)
   // FEAT-121: Use dint_val for TIME support (32-bit range, up to ~24.8 days)
   uint32_t preset_time = (PT.dint_val < 0) ? 0 : (uint32_t)PT.dint_val;
-  uint32_t now = millis();
 
   // Detect falling edge on IN
   bool falling_edge = (!current_IN && instance->last_IN);
 
   if (falling_edge) {
     // Start timer on falling edge
-    instance->start_time = now;
-    instance->running = true;
-    instance->ET = 0;
     instance->Q = true;  // Output stays TRUE during delay
+    timer_start(instance, wheel, preset_time);
   }
 
   if (!current_IN) {
-    // Input is LOW
-    if (instance->running) {
-      // Update elapsed time
-      instance->ET = now - instance->start_time;
-
-      // Check if preset time expired
-      if (instance->ET >= preset_time) {
-        instance->Q = false;
-        instance->running = false;  // Timer done
-      }
+    // Input is LOW - Q drops when the deadline fires
+    if (instance->running && timer_expired(instance, wheel, preset_time)) {
+      instance->Q = false;
     }
   } else {
     // Input is HIGH - output follows input immediately
     instance->Q = true;
-    instance->ET = 0;
-    instance->running = false;
+    timer_stop(instance, wheel);
   }
 
   // Update last state
@@ -123,11 +140,12 @@ st_value_t st_builtin_tof(st_value_t IN, st_value_t PT, st_timer_instance_t* ins
  * TP - Pulse Timer
  * ============================================================================ */
 
-st_value_t st_builtin_tp(st_value_t IN, st_value_t PT, st_timer_instance_t* instance) {
+st_value_t st_builtin_tp(st_value_t IN, st_value_t PT, st_timer_instance_t* instance,
+                         st_timer_wheel_t* wheel) {
   st_value_t result;
   result.bool_val = false;
 
-  if (!instance) {
+  if (!instance || !wheel) {
     return result;  // No storage - cannot run timer
   }
 
@@ -135,29 +153,19 @@ st_value_t st_builtin_tp(st_value_t IN, st_value_t PT, st_timer_instance_t* inst
   // v4.7+: PT validation - negative values → 0 (prevent huge unsigned conversion)
   // FEAT-121: Use dint_val for TIME support (32-bit range, up to ~24.8 days)
   uint32_t preset_time = (PT.dint_val < 0) ? 0 : (uint32_t)PT.dint_val;
-  uint32_t now = millis();
 
   // Detect rising edge on IN
   bool rising_edge = (current_IN && !instance->last_IN);
 
   if (rising_edge && !instance->running) {
     // Start pulse on rising edge (only if not already running)
-    instance->start_time = now;
-    instance->running = true;
-    instance->ET = 0;
     instance->Q = true;
+    timer_start(instance, wheel, preset_time);
   }
 
-  if (instance->running) {
-    // Update elapsed time
-    instance->ET = now - instance->start_time;
-
-    // Check if pulse duration expired
-    if (instance->ET >= preset_time) {
-      instance->Q = false;
-      instance->running = false;  // Pulse complete
-      instance->ET = preset_time;  // Clamp ET to PT
-    }
+  // Pulse completes when the deadline fires (ET stays clamped to PT)
+  if (instance->running && timer_expired(instance, wheel, preset_time)) {
+    instance->Q = false;
   }
 
   // Update last state
@@ -172,7 +180,10 @@ st_value_t st_builtin_tp(st_value_t IN, st_value_t PT, st_timer_instance_t* inst
  * HELPER FUNCTIONS
  * ============================================================================ */
 
-uint32_t st_timer_get_et(st_timer_instance_t* instance) {
+uint32_t st_timer_get_et(const st_timer_instance_t* instance, uint32_t now_ms) {
   if (!instance) return 0;
-  return instance->ET;
+  if (!instance->running) return instance->ET;
+
+  uint32_t et = now_ms - instance->start_time;
+  return (et < instance->PT) ? et : instance->PT;
 }
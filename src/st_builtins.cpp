@@ -546,6 +546,11 @@ st_value_t st_builtin_call(st_builtin_func_t func_id, st_value_t arg1, st_value_
     case ST_BUILTIN_CNT_RAW:
     case ST_BUILTIN_CNT_FREQ:
     case ST_BUILTIN_CNT_STATUS:
+    case ST_BUILTIN_CNT_EDGES:
+    case ST_BUILTIN_CNT_POS:
+    case ST_BUILTIN_CNT_VEL:
+    case ST_BUILTIN_DI_CAUGHT:
+    case ST_BUILTIN_DI_PULSE:
       // All handled directly in VM (st_vm.cpp)
       result.int_val = 0;
       break;
@@ -625,6 +630,11 @@ const char *st_builtin_name(st_builtin_func_t func_id) {
     case ST_BUILTIN_CNT_RAW:       return "CNT_RAW";
     case ST_BUILTIN_CNT_FREQ:      return "CNT_FREQ";
     case ST_BUILTIN_CNT_STATUS:    return "CNT_STATUS";
+    case ST_BUILTIN_CNT_EDGES:     return "CNT_EDGES";
+    case ST_BUILTIN_CNT_POS:       return "CNT_POS";
+    case ST_BUILTIN_CNT_VEL:       return "CNT_VEL";
+    case ST_BUILTIN_DI_CAUGHT:     return "DI_CAUGHT";
+    case ST_BUILTIN_DI_PULSE:      return "DI_PULSE";
     default:                       return "UNKNOWN";
   }
 }
@@ -748,6 +758,11 @@ uint8_t st_builtin_arg_count(st_builtin_func_t func_id) {
     case ST_BUILTIN_CNT_RAW:       // CNT_RAW(id)
     case ST_BUILTIN_CNT_FREQ:      // CNT_FREQ(id)
     case ST_BUILTIN_CNT_STATUS:    // CNT_STATUS(id)
+    case ST_BUILTIN_CNT_EDGES:     // CNT_EDGES(id)
+    case ST_BUILTIN_CNT_POS:       // CNT_POS(id)
+    case ST_BUILTIN_CNT_VEL:       // CNT_VEL(id)
+    case ST_BUILTIN_DI_CAUGHT:     // DI_CAUGHT(pin)
+    case ST_BUILTIN_DI_PULSE:      // DI_PULSE(pin)
       return 1;
 
     default:
@@ -794,11 +809,16 @@ st_datatype_t st_builtin_return_type(st_builtin_func_t func_id) {
     case ST_BUILTIN_MB_SUCCESS:        // MB_SUCCESS → BOOL
     case ST_BUILTIN_MB_BUSY:           // MB_BUSY → BOOL
     case ST_BUILTIN_MB_CACHE:          // MB_CACHE → BOOL (previous state)
+    case ST_BUILTIN_DI_CAUGHT:         // DI_CAUGHT → BOOL (latched edge)
       return ST_TYPE_BOOL;
 
     // Returns DINT
     case ST_BUILTIN_CNT_VALUE:         // CNT_VALUE → DINT (scaled counter value)
     case ST_BUILTIN_CNT_RAW:           // CNT_RAW → DINT (raw counter value)
+    case ST_BUILTIN_CNT_EDGES:         // CNT_EDGES → DINT (edge interval µs)
+    case ST_BUILTIN_CNT_POS:           // CNT_POS → DINT (signed position)
+    case ST_BUILTIN_CNT_VEL:           // CNT_VEL → DINT (counts/s)
+    case ST_BUILTIN_DI_PULSE:          // DI_PULSE → DINT (pulse width µs)
       return ST_TYPE_DINT;
 
     // Returns DWORD
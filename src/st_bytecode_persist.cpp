@@ -1,62 +1,185 @@
 /**
  * @file st_bytecode_persist.cpp
- * @brief Bytecode persistence to SPIFFS
+ * @brief Bytecode persistence (XIP slots, /logic_N.bc files as fallback)
  *
- * Serializes/deserializes compiled ST bytecode to /logic_N.bc files.
+ * Serializes/deserializes compiled ST bytecode to /logic_N.bc files
+ * (LittleFS via fs_store since v7.9.10.3, replaced atomically).
  * CRC32 of source code validates cache freshness.
+ *
+ * v7.9.9.8: XIP slots in the "stxip" partition take precedence. A slot is
+ * only erased by the persist writer after st_bytecode_save(), i.e. after the
+ * program has been recompiled into heap instructions — nothing runs from
+ * a slot while it is rewritten.
  */
 
 #include "st_bytecode_persist.h"
+#include "st_stateful.h"
 #include "debug.h"
 #include "debug_flags.h"
+#include "persist_writer.h"
 #include <string.h>
 #include <stdlib.h>
-#include <FS.h>
-#include <SPIFFS.h>
+#include "fs_store.h"
+#include "fs_mount.h"
+#include <esp_partition.h>
 
 /* ============================================================================
- * CRC32 (standard polynomial 0xEDB88320)
+ * HELPER: Build filename
  * ============================================================================ */
 
-uint32_t st_crc32(const uint8_t *data, uint32_t len) {
-  uint32_t crc = 0xFFFFFFFF;
-  for (uint32_t i = 0; i < len; i++) {
-    crc ^= data[i];
-    for (uint8_t bit = 0; bit < 8; bit++) {
-      if (crc & 1)
-        crc = (crc >> 1) ^ 0xEDB88320;
-      else
-        crc >>= 1;
-    }
-  }
-  return ~crc;
+static void bc_filename(uint8_t program_id, char *buf, size_t buf_size) {
+  snprintf(buf, buf_size, "/logic_%d.bc", program_id);
+}
+
+// One byte of a .bc file (0 past the end; the following reads fail anyway)
+static uint8_t bc_read_u8(FsReader *file) {
+  uint8_t b = 0;
+  fs_read(file, &b, 1);
+  return b;
 }
 
 /* ============================================================================
- * HELPER: Build filename
+ * XIP PARTITION (v7.9.9.8)
  * ============================================================================ */
 
-static void bc_filename(uint8_t program_id, char *buf, size_t buf_size) {
-  snprintf(buf, buf_size, "/logic_%d.bc", program_id);
+static const esp_partition_t *xip_part = NULL;
+static const uint8_t *xip_base = NULL;        // Whole partition, mapped once
+static spi_flash_mmap_handle_t xip_handle;
+static bool xip_probed = false;
+static uint32_t xip_slot_size = 0;
+static uint8_t xip_mapped_mask = 0;           // Programs running from their slot
+static uint32_t xip_instr_bytes[ST_XIP_SLOTS];
+static uint32_t xip_writes = 0;
+static uint32_t xip_fallbacks = 0;
+static StxFlashOps xip_ops;
+
+static bool xip_flash_write(void *ctx, uint32_t addr, const void *buf, uint32_t len) {
+  return esp_partition_write((const esp_partition_t *)ctx, addr, buf, len) == ESP_OK;
+}
+
+static bool xip_flash_erase(void *ctx, uint32_t addr) {
+  return esp_partition_erase_range((const esp_partition_t *)ctx, addr, SPI_FLASH_SEC_SIZE) == ESP_OK;
+}
+
+// Find and map the partition on first use (boot load runs before any save)
+static bool xip_ready(void) {
+  if (xip_probed) return xip_base != NULL;
+  xip_probed = true;
+
+  xip_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                      (esp_partition_subtype_t)ST_XIP_SUBTYPE, ST_XIP_LABEL);
+  if (xip_part == NULL) {
+    debug_println("[BC] No 'stxip' partition - bytecode cache in LittleFS");
+    return false;
+  }
+  const void *ptr = NULL;
+  esp_err_t err = esp_partition_mmap(xip_part, 0, xip_part->size, SPI_FLASH_MMAP_DATA,
+                                     &ptr, &xip_handle);
+  if (err != ESP_OK) {
+    debug_printf("[BC] XIP mmap failed (%d) - bytecode cache in LittleFS\n", (int)err);
+    return false;
+  }
+  xip_base = (const uint8_t *)ptr;
+  xip_slot_size = (xip_part->size / ST_XIP_SLOTS) & ~(uint32_t)(SPI_FLASH_SEC_SIZE - 1);
+  xip_ops.ctx = (void *)xip_part;
+  xip_ops.sector_size = SPI_FLASH_SEC_SIZE;
+  xip_ops.write = xip_flash_write;
+  xip_ops.erase = xip_flash_erase;
+  return true;
+}
+
+// Writes an image into its slot (persist writer task); the .bc file is stale now
+static bool xip_write_exec(uint16_t key, void *data, uint32_t len) {
+  uint8_t program_id = (uint8_t)(key & 0xFF);
+  if (!st_xip_write(&xip_ops, program_id * xip_slot_size, xip_slot_size,
+                    (const uint8_t *)data, len)) {
+    debug_printf("[BC] XIP slot %u write failed\n", program_id);
+    return false;
+  }
+  xip_writes++;
+
+  char filename[32];
+  bc_filename(program_id, filename, sizeof(filename));
+  if (fs_mount()) fs_remove(filename);
+  return true;
+}
+
+void st_bytecode_free_instructions(st_bytecode_program_t *bytecode) {
+  if (bytecode->instructions && !bytecode->instr_in_flash) {
+    free(bytecode->instructions);
+  }
+  // Mapped: the partition stays mapped, only forget the slot
+  if (bytecode->instr_in_flash && xip_base) {
+    uint32_t slot = (uint32_t)((const uint8_t *)bytecode->instructions - xip_base) / xip_slot_size;
+    if (slot < ST_XIP_SLOTS) {
+      xip_mapped_mask &= (uint8_t)~(1u << slot);
+      xip_instr_bytes[slot] = 0;
+    }
+  }
+  bytecode->instructions = NULL;
+  bytecode->instr_in_flash = 0;
+  bytecode->instr_count = 0;
+  bytecode->instr_capacity = 0;
+}
+
+void st_bytecode_xip_info(StXipInfo *info) {
+  memset(info, 0, sizeof(*info));
+  info->active = xip_ready();
+  if (!info->active) return;
+  info->size = xip_part->size;
+  info->slot_size = xip_slot_size;
+  for (uint8_t i = 0; i < ST_XIP_SLOTS; i++) {
+    if (xip_mapped_mask & (1u << i)) {
+      info->mapped++;
+      info->flash_bytes += xip_instr_bytes[i];
+    }
+  }
+  info->writes = xip_writes;
+  info->fallbacks = xip_fallbacks;
 }
 
 /* ============================================================================
- * SAVE bytecode to SPIFFS
+ * SAVE bytecode to a file
  * ============================================================================ */
 
+// Writes a serialized .bc image (persist writer task, v7.9.9.6)
+static bool bc_write_exec(uint16_t key, void *data, uint32_t len) {
+  char filename[32];
+  bc_filename((uint8_t)(key & 0xFF), filename, sizeof(filename));
+
+  // Temp file + rename: a failed write keeps the previous image
+  if (!fs_mount() || !fs_write_file(filename, data, len)) {
+    debug_printf("[BC] Save failed: cannot write %s\n", filename);
+    return false;
+  }
+  return true;
+}
+
 bool st_bytecode_save(uint8_t program_id, const st_bytecode_program_t *bytecode,
                       const char *source, uint32_t source_size) {
   if (program_id >= 4 || !bytecode || !bytecode->instructions || bytecode->instr_count == 0) {
     return false;
   }
 
-  char filename[32];
-  bc_filename(program_id, filename, sizeof(filename));
+  uint32_t source_crc = st_crc32((const uint8_t *)source, source_size);
 
-  File file = SPIFFS.open(filename, FILE_WRITE);
-  if (!file) {
-    debug_printf("[BC] Save failed: cannot open %s\n", filename);
-    return false;
+  // XIP slot if the partition exists and the image fits (v7.9.9.8)
+  if (xip_ready()) {
+    uint32_t size = st_xip_image_size(bytecode);
+    if (size <= xip_slot_size) {
+      uint8_t *xip_img = (uint8_t *)persist_writer_alloc(size);
+      if (!xip_img || st_xip_build(bytecode, source_crc, xip_img, size) != size) {
+        debug_printf("[BC] Save failed: no memory for %u byte image\n", (unsigned)size);
+        return false;
+      }
+      debug_printf("[BC] Queued XIP slot %u: %u instr, %u vars, %u bytes\n",
+                   program_id, bytecode->instr_count, bytecode->var_count, (unsigned)size);
+      return persist_writer_submit_owned(PW_KEY_BYTECODE(program_id), xip_write_exec,
+                                         xip_img, size, NULL, NULL);
+    }
+    xip_fallbacks++;
+    debug_printf("[BC] Image %u bytes > XIP slot %u bytes - using LittleFS\n",
+                 (unsigned)size, (unsigned)xip_slot_size);
   }
 
   // Build header
@@ -68,73 +191,90 @@ bool st_bytecode_save(uint8_t program_id, const st_bytecode_program_t *bytecode,
   header.var_count = bytecode->var_count;
   header.exported_var_count = bytecode->exported_var_count;
   header.has_func_registry = (bytecode->func_registry != NULL) ? 1 : 0;
-  header.source_crc32 = st_crc32((const uint8_t *)source, source_size);
+  header.source_crc32 = source_crc;
 
-  // Write header (16 bytes)
-  if (file.write((uint8_t *)&header, sizeof(header)) != sizeof(header)) {
-    file.close();
-    SPIFFS.remove(filename);
+  // Serialize the whole file into one snapshot; the file write happens
+  // in the persist writer task (v7.9.9.6)
+  const size_t var_bytes = 16 + 1 + 1 + sizeof(st_value_t);
+  const size_t func_bytes = 32 + 1 + 1 + 8 + 2 + 2 + 1 + 1 + 1;
+  size_t instr_bytes = (size_t)bytecode->instr_count * sizeof(st_bytecode_instr_t);
+  size_t len = sizeof(header) + 32 + bytecode->var_count * var_bytes + instr_bytes;
+  const st_function_registry_t *reg = bytecode->func_registry;
+  uint8_t total = reg ? (uint8_t)(reg->builtin_count + reg->user_count) : 0;
+  if (reg) len += 2 + total * func_bytes;
+
+  uint8_t *img = (uint8_t *)persist_writer_alloc(len);
+  if (!img) {
+    debug_printf("[BC] Save failed: no memory for %u byte image\n", (unsigned)len);
     return false;
   }
+  uint8_t *p = img;
 
-  // Write program name (32 bytes)
-  if (file.write((uint8_t *)bytecode->name, 32) != 32) {
-    file.close();
-    SPIFFS.remove(filename);
-    return false;
-  }
+  // Header (16 bytes) + program name (32 bytes)
+  memcpy(p, &header, sizeof(header));            p += sizeof(header);
+  memcpy(p, bytecode->name, 32);                 p += 32;
 
-  // Write variable table: name[16] + type(1) + export_flag(1) + initial_value(4) per variable
+  // Variable table: name[16] + type(1) + export_flag(1) + initial_value(4) per variable
   for (uint8_t v = 0; v < bytecode->var_count; v++) {
-    file.write((uint8_t *)bytecode->var_names[v], 16);
-    uint8_t type_byte = (uint8_t)bytecode->var_types[v];
-    file.write(type_byte);
-    file.write(bytecode->var_export_flags[v]);
-    // v2: Write initial value (4 bytes)
-    file.write((uint8_t *)&bytecode->var_initial[v], sizeof(st_value_t));
+    memcpy(p, bytecode->var_names[v], 16);       p += 16;
+    *p++ = (uint8_t)bytecode->var_types[v];
+    *p++ = bytecode->var_export_flags[v];
+    // v2: initial value (4 bytes)
+    memcpy(p, &bytecode->var_initial[v], sizeof(st_value_t));
+    p += sizeof(st_value_t);
   }
 
-  // Write instructions (instr_count × 8 bytes, flat POD)
-  size_t instr_bytes = (size_t)bytecode->instr_count * sizeof(st_bytecode_instr_t);
-  if (file.write((uint8_t *)bytecode->instructions, instr_bytes) != instr_bytes) {
-    file.close();
-    SPIFFS.remove(filename);
-    return false;
-  }
+  // Instructions (instr_count × 8 bytes, flat POD)
+  memcpy(p, bytecode->instructions, instr_bytes);
+  p += instr_bytes;
 
-  // Write function registry (optional)
-  if (bytecode->func_registry) {
-    const st_function_registry_t *reg = bytecode->func_registry;
-    file.write(reg->user_count);
-    file.write(reg->builtin_count);
-
-    uint8_t total = reg->builtin_count + reg->user_count;
+  // Function registry (optional)
+  if (reg) {
+    *p++ = reg->user_count;
+    *p++ = reg->builtin_count;
     for (uint8_t f = 0; f < total; f++) {
       const st_function_entry_t *entry = &reg->functions[f];
-      file.write((uint8_t *)entry->name, 32);
-      file.write((uint8_t)entry->return_type);
-      file.write(entry->param_count);
-      for (uint8_t p = 0; p < 8; p++) {
-        file.write((uint8_t)entry->param_types[p]);
+      memcpy(p, entry->name, 32);                p += 32;
+      *p++ = (uint8_t)entry->return_type;
+      *p++ = entry->param_count;
+      for (uint8_t i = 0; i < 8; i++) {
+        *p++ = (uint8_t)entry->param_types[i];
       }
-      file.write((uint8_t *)&entry->bytecode_addr, 2);
-      file.write((uint8_t *)&entry->bytecode_size, 2);
-      file.write(entry->is_builtin);
-      file.write(entry->is_function_block);
-      file.write(entry->instance_size);
+      memcpy(p, &entry->bytecode_addr, 2);       p += 2;
+      memcpy(p, &entry->bytecode_size, 2);       p += 2;
+      *p++ = entry->is_builtin;
+      *p++ = entry->is_function_block;
+      *p++ = entry->instance_size;
     }
   }
 
-  file.close();
+  debug_printf("[BC] Queued /logic_%u.bc: %u instr, %u vars, %u bytes\n",
+               program_id, header.instr_count, header.var_count, (unsigned)len);
 
-  debug_printf("[BC] Saved %s: %u instr, %u vars, %u bytes\n",
-               filename, header.instr_count, header.var_count, (unsigned)instr_bytes + sizeof(header));
+  return persist_writer_submit_owned(PW_KEY_BYTECODE(program_id), bc_write_exec,
+                                     img, (uint32_t)len, NULL, NULL);
+}
 
-  return true;
+/* ============================================================================
+ * INSTALL image from a backup (v7.9.10.1)
+ * ============================================================================ */
+
+bool st_bytecode_install_image(uint8_t program_id, const uint8_t *img, uint32_t len,
+                               uint32_t source_crc32) {
+  if (program_id >= 4 || !xip_ready() || len > xip_slot_size) return false;
+  // Never rewrite a slot a program is executing from
+  if (xip_mapped_mask & (1u << program_id)) return false;
+  st_xip_result_t r = st_xip_check(img, len, source_crc32);
+  if (r != ST_XIP_OK) {
+    debug_printf("[BC] Backup image for slot %u: %s\n", program_id, st_xip_result_name(r));
+    return false;
+  }
+  return persist_writer_submit_wait(PW_KEY_BYTECODE(program_id), xip_write_exec,
+                                    img, len, PW_WAIT_TIMEOUT_MS);
 }
 
 /* ============================================================================
- * LOAD bytecode from SPIFFS
+ * LOAD bytecode from a file
  * ============================================================================ */
 
 bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
@@ -142,45 +282,82 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
   if (program_id >= 4 || !bytecode || !source || source_size == 0) {
     return false;
   }
+  return st_bytecode_load_crc(program_id, bytecode,
+                              st_crc32((const uint8_t *)source, source_size), true);
+}
+
+bool st_bytecode_load_crc(uint8_t program_id, st_bytecode_program_t *bytecode,
+                          uint32_t current_crc, bool use_file) {
+  if (program_id >= 4 || !bytecode) {
+    return false;
+  }
+
+  // XIP slot: instructions stay in flash, tables are copied (v7.9.9.8)
+  if (xip_ready()) {
+    const uint8_t *img = xip_base + program_id * xip_slot_size;
+    st_xip_result_t r = st_xip_check(img, xip_slot_size, current_crc);
+    if (r == ST_XIP_OK) {
+      st_function_registry_t *reg = NULL;
+      if (st_xip_func_count(img) > 0) {
+        reg = (st_function_registry_t *)malloc(sizeof(st_function_registry_t));
+        if (!reg) {
+          // Non-fatal: bytecode works without registry (no user functions callable)
+          debug_printf("[BC] XIP slot %u: registry malloc failed\n", program_id);
+        }
+      }
+      st_xip_attach(img, bytecode, reg);
+      bytecode->stateful = (struct st_stateful_storage*)st_stateful_create_for(
+          bytecode->instructions, bytecode->instr_count, NULL);
+      xip_mapped_mask |= (uint8_t)(1u << program_id);
+      xip_instr_bytes[program_id] = (uint32_t)bytecode->instr_count * sizeof(st_bytecode_instr_t);
+
+      debug_printf("[BC] Mapped XIP slot %u: %u instr, %u vars (in place)\n",
+                   program_id, bytecode->instr_count, bytecode->var_count);
+      return true;
+    }
+    if (r != ST_XIP_EMPTY) {
+      debug_printf("[BC] XIP slot %u: %s\n", program_id, st_xip_result_name(r));
+    }
+  }
+  if (!use_file) return false;
 
   char filename[32];
   bc_filename(program_id, filename, sizeof(filename));
 
-  if (!SPIFFS.exists(filename)) {
+  if (!fs_mount() || !fs_exists(filename)) {
     return false;
   }
 
-  File file = SPIFFS.open(filename, FILE_READ);
-  if (!file) {
+  FsReader file;
+  if (!fs_read_open(&file, filename)) {
     return false;
   }
 
   // Read and validate header
   st_bc_header_t header;
-  if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header)) {
-    file.close();
+  if (fs_read(&file, &header, sizeof(header)) != sizeof(header)) {
+    fs_read_close(&file);
     return false;
   }
 
   if (header.magic != ST_BYTECODE_MAGIC) {
     debug_printf("[BC] %s: bad magic 0x%08X\n", filename, (unsigned)header.magic);
-    file.close();
+    fs_read_close(&file);
     return false;
   }
 
   if (header.version != ST_BYTECODE_VERSION) {
     debug_printf("[BC] %s: version mismatch (file=%u, expected=%u) -> recompile\n",
                  filename, header.version, ST_BYTECODE_VERSION);
-    file.close();
+    fs_read_close(&file);
     return false;
   }
 
   // Validate CRC32 against current source
-  uint32_t current_crc = st_crc32((const uint8_t *)source, source_size);
   if (header.source_crc32 != current_crc) {
     debug_printf("[BC] %s: source changed (CRC 0x%08X != 0x%08X) -> recompile\n",
                  filename, (unsigned)header.source_crc32, (unsigned)current_crc);
-    file.close();
+    fs_read_close(&file);
     return false;
   }
 
@@ -189,13 +366,13 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
       header.var_count > 32 || header.exported_var_count > 32) {
     debug_printf("[BC] %s: invalid counts (instr=%u var=%u)\n",
                  filename, header.instr_count, header.var_count);
-    file.close();
+    fs_read_close(&file);
     return false;
   }
 
   // Read program name (32 bytes)
-  if (file.read((uint8_t *)bytecode->name, 32) != 32) {
-    file.close();
+  if (fs_read(&file, bytecode->name, 32) != 32) {
+    fs_read_close(&file);
     return false;
   }
 
@@ -203,17 +380,17 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
   bytecode->var_count = header.var_count;
   bytecode->exported_var_count = header.exported_var_count;
   for (uint8_t v = 0; v < header.var_count; v++) {
-    if (file.read((uint8_t *)bytecode->var_names[v], 16) != 16) {
-      file.close();
+    if (fs_read(&file, bytecode->var_names[v], 16) != 16) {
+      fs_read_close(&file);
       return false;
     }
-    uint8_t type_byte = file.read();
+    uint8_t type_byte = bc_read_u8(&file);
     bytecode->var_types[v] = (st_datatype_t)type_byte;
-    bytecode->var_export_flags[v] = file.read();
+    bytecode->var_export_flags[v] = bc_read_u8(&file);
 
     // v2: Read initial value and use it as starting value
-    if (file.read((uint8_t *)&bytecode->var_initial[v], sizeof(st_value_t)) != sizeof(st_value_t)) {
-      file.close();
+    if (fs_read(&file, &bytecode->var_initial[v], sizeof(st_value_t)) != sizeof(st_value_t)) {
+      fs_read_close(&file);
       return false;
     }
     bytecode->variables[v] = bytecode->var_initial[v];
@@ -222,16 +399,17 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
   // Allocate and read instructions
   size_t instr_bytes = (size_t)header.instr_count * sizeof(st_bytecode_instr_t);
   bytecode->instructions = (st_bytecode_instr_t *)malloc(instr_bytes);
+  bytecode->instr_in_flash = 0;
   if (!bytecode->instructions) {
     debug_printf("[BC] %s: malloc failed (%u bytes)\n", filename, (unsigned)instr_bytes);
-    file.close();
+    fs_read_close(&file);
     return false;
   }
 
-  if (file.read((uint8_t *)bytecode->instructions, instr_bytes) != instr_bytes) {
+  if (fs_read(&file, bytecode->instructions, instr_bytes) != instr_bytes) {
     free(bytecode->instructions);
     bytecode->instructions = NULL;
-    file.close();
+    fs_read_close(&file);
     return false;
   }
 
@@ -240,9 +418,10 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
 
   // Read function registry (optional)
   bytecode->func_registry = NULL;
-  if (header.has_func_registry && file.available() >= 2) {
-    uint8_t user_count = file.read();
-    uint8_t builtin_count = file.read();
+  uint8_t counts[2];
+  if (header.has_func_registry && fs_read(&file, counts, sizeof(counts)) == sizeof(counts)) {
+    uint8_t user_count = counts[0];
+    uint8_t builtin_count = counts[1];
     uint8_t total = builtin_count + user_count;
 
     if (total > 0 && total <= 64) {
@@ -258,17 +437,17 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
         bool reg_ok = true;
         for (uint8_t f = 0; f < total && reg_ok; f++) {
           st_function_entry_t *entry = &reg->functions[f];
-          if (file.read((uint8_t *)entry->name, 32) != 32) { reg_ok = false; break; }
-          entry->return_type = (st_datatype_t)file.read();
-          entry->param_count = file.read();
+          if (fs_read(&file, entry->name, 32) != 32) { reg_ok = false; break; }
+          entry->return_type = (st_datatype_t)bc_read_u8(&file);
+          entry->param_count = bc_read_u8(&file);
           for (uint8_t p = 0; p < 8; p++) {
-            entry->param_types[p] = (st_datatype_t)file.read();
+            entry->param_types[p] = (st_datatype_t)bc_read_u8(&file);
           }
-          if (file.read((uint8_t *)&entry->bytecode_addr, 2) != 2) { reg_ok = false; break; }
-          if (file.read((uint8_t *)&entry->bytecode_size, 2) != 2) { reg_ok = false; break; }
-          entry->is_builtin = file.read();
-          entry->is_function_block = file.read();
-          entry->instance_size = file.read();
+          if (fs_read(&file, &entry->bytecode_addr, 2) != 2) { reg_ok = false; break; }
+          if (fs_read(&file, &entry->bytecode_size, 2) != 2) { reg_ok = false; break; }
+          entry->is_builtin = bc_read_u8(&file);
+          entry->is_function_block = bc_read_u8(&file);
+          entry->instance_size = bc_read_u8(&file);
         }
 
         if (reg_ok) {
@@ -281,10 +460,12 @@ bool st_bytecode_load(uint8_t program_id, st_bytecode_program_t *bytecode,
     }
   }
 
-  // stateful pointer initialized to NULL — allocated on first execution
-  bytecode->stateful = NULL;
+  // v7.9.9.0: Stateful storage (timer/counter pools + timer wheel) sized
+  // from the cached instructions — cached TON/CTU programs need it too
+  bytecode->stateful = (struct st_stateful_storage*)st_stateful_create_for(
+      bytecode->instructions, bytecode->instr_count, NULL);
 
-  file.close();
+  fs_read_close(&file);
 
   debug_printf("[BC] Loaded %s: %u instr, %u vars (cached)\n",
                filename, header.instr_count, header.var_count);
@@ -302,8 +483,8 @@ void st_bytecode_invalidate(uint8_t program_id) {
   char filename[32];
   bc_filename(program_id, filename, sizeof(filename));
 
-  if (SPIFFS.exists(filename)) {
-    SPIFFS.remove(filename);
+  if (fs_mount() && fs_exists(filename)) {
+    fs_remove(filename);
     debug_printf("[BC] Invalidated %s\n", filename);
   }
 }
@@ -15,6 +15,10 @@
 #include <string.h>
 #include <stdio.h>
 
+// Stringify a pool cap for compile error messages (caps are build flags)
+#define ST_STR_(x) #x
+#define ST_STR(x)  ST_STR_(x)
+
 /* ============================================================================
  * LINE MAP (for source-level debugging breakpoints)
  * ============================================================================ */
@@ -529,6 +533,12 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
       else if (strcasecmp(node->data.function_call.func_name, "CNT_RAW") == 0) func_id = ST_BUILTIN_CNT_RAW;
       else if (strcasecmp(node->data.function_call.func_name, "CNT_FREQ") == 0) func_id = ST_BUILTIN_CNT_FREQ;
       else if (strcasecmp(node->data.function_call.func_name, "CNT_STATUS") == 0) func_id = ST_BUILTIN_CNT_STATUS;
+      else if (strcasecmp(node->data.function_call.func_name, "CNT_EDGES") == 0) func_id = ST_BUILTIN_CNT_EDGES;
+      else if (strcasecmp(node->data.function_call.func_name, "CNT_POS") == 0) func_id = ST_BUILTIN_CNT_POS;
+      else if (strcasecmp(node->data.function_call.func_name, "CNT_VEL") == 0) func_id = ST_BUILTIN_CNT_VEL;
+      // v7.9.9.4: Interrupt-driven inputs
+      else if (strcasecmp(node->data.function_call.func_name, "DI_CAUGHT") == 0) func_id = ST_BUILTIN_DI_CAUGHT;
+      else if (strcasecmp(node->data.function_call.func_name, "DI_PULSE") == 0) func_id = ST_BUILTIN_DI_PULSE;
       else {
         // FEAT-003: Check function registry for user-defined functions
         if (compiler->func_registry) {
@@ -600,8 +610,8 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
 
       // Edge detection functions
       if (func_id == ST_BUILTIN_R_TRIG || func_id == ST_BUILTIN_F_TRIG) {
-        if (compiler->edge_instance_count >= 8) {
-          st_compiler_error(compiler, "Too many edge detector instances (max 8)");
+        if (compiler->edge_instance_count >= ST_MAX_EDGE_INSTANCES) {
+          st_compiler_error(compiler, "Too many edge detector instances (max " ST_STR(ST_MAX_EDGE_INSTANCES) ")");
           return false;
         }
         instance_id = compiler->edge_instance_count++;
@@ -610,8 +620,8 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
       }
       // Timer functions
       else if (func_id == ST_BUILTIN_TON || func_id == ST_BUILTIN_TOF || func_id == ST_BUILTIN_TP) {
-        if (compiler->timer_instance_count >= 8) {
-          st_compiler_error(compiler, "Too many timer instances (max 8)");
+        if (compiler->timer_instance_count >= ST_MAX_TIMER_INSTANCES) {
+          st_compiler_error(compiler, "Too many timer instances (max " ST_STR(ST_MAX_TIMER_INSTANCES) ")");
           return false;
         }
         instance_id = compiler->timer_instance_count++;
@@ -620,8 +630,8 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
       }
       // Counter functions
       else if (func_id == ST_BUILTIN_CTU || func_id == ST_BUILTIN_CTD || func_id == ST_BUILTIN_CTUD) {
-        if (compiler->counter_instance_count >= 8) {
-          st_compiler_error(compiler, "Too many counter instances (max 8)");
+        if (compiler->counter_instance_count >= ST_MAX_COUNTER_INSTANCES) {
+          st_compiler_error(compiler, "Too many counter instances (max " ST_STR(ST_MAX_COUNTER_INSTANCES) ")");
           return false;
         }
         instance_id = compiler->counter_instance_count++;
@@ -630,8 +640,8 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
       }
       // Latch functions (v4.7.3)
       else if (func_id == ST_BUILTIN_SR || func_id == ST_BUILTIN_RS) {
-        if (compiler->latch_instance_count >= 8) {
-          st_compiler_error(compiler, "Too many latch instances (max 8)");
+        if (compiler->latch_instance_count >= ST_MAX_LATCH_INSTANCES) {
+          st_compiler_error(compiler, "Too many latch instances (max " ST_STR(ST_MAX_LATCH_INSTANCES) ")");
           return false;
         }
         instance_id = compiler->latch_instance_count++;
@@ -640,8 +650,8 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
       }
       // Signal processing functions (v4.8)
       else if (func_id == ST_BUILTIN_HYSTERESIS) {
-        if (compiler->hysteresis_instance_count >= 8) {
-          st_compiler_error(compiler, "Too many hysteresis instances (max 8)");
+        if (compiler->hysteresis_instance_count >= ST_MAX_HYSTERESIS_INSTANCES) {
+          st_compiler_error(compiler, "Too many hysteresis instances (max " ST_STR(ST_MAX_HYSTERESIS_INSTANCES) ")");
           return false;
         }
         instance_id = compiler->hysteresis_instance_count++;
@@ -649,8 +659,8 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
                      instance_id, node->data.function_call.func_name);
       }
       else if (func_id == ST_BUILTIN_BLINK) {
-        if (compiler->blink_instance_count >= 8) {
-          st_compiler_error(compiler, "Too many blink instances (max 8)");
+        if (compiler->blink_instance_count >= ST_MAX_BLINK_INSTANCES) {
+          st_compiler_error(compiler, "Too many blink instances (max " ST_STR(ST_MAX_BLINK_INSTANCES) ")");
           return false;
         }
         instance_id = compiler->blink_instance_count++;
@@ -658,8 +668,8 @@ bool st_compiler_compile_expr(st_compiler_t *compiler, st_ast_node_t *node) {
                      instance_id, node->data.function_call.func_name);
       }
       else if (func_id == ST_BUILTIN_FILTER) {
-        if (compiler->filter_instance_count >= 8) {
-          st_compiler_error(compiler, "Too many filter instances (max 8)");
+        if (compiler->filter_instance_count >= ST_MAX_FILTER_INSTANCES) {
+          st_compiler_error(compiler, "Too many filter instances (max " ST_STR(ST_MAX_FILTER_INSTANCES) ")");
           return false;
         }
         instance_id = compiler->filter_instance_count++;
@@ -1627,7 +1637,7 @@ st_bytecode_program_t *st_compiler_compile(st_compiler_t *compiler, st_program_t
   // Set up bytecode output buffer (always temp — instructions are dynamically sized)
   if (output) {
     // Free old dynamic instructions if recompiling
-    if (output->instructions) {
+    if (output->instructions && !output->instr_in_flash) {
       free(output->instructions);
       output->instructions = NULL;
     }
@@ -1812,27 +1822,29 @@ st_bytecode_program_t *st_compiler_compile(st_compiler_t *compiler, st_program_t
   }
 
   // v4.7+: Allocate stateful storage if any stateful functions were used
-  if (compiler->edge_instance_count > 0 ||
-      compiler->timer_instance_count > 0 ||
-      compiler->counter_instance_count > 0) {
-    st_stateful_storage_t *stateful = (st_stateful_storage_t *)malloc(sizeof(st_stateful_storage_t));
+  // v7.9.9.0: Sized to the instances of every kind (pools + timer wheel)
+  st_stateful_counts_t counts;
+  counts.timers = compiler->timer_instance_count;
+  counts.edges = compiler->edge_instance_count;
+  counts.counters = compiler->counter_instance_count;
+  counts.latches = compiler->latch_instance_count;
+  counts.hysteresis = compiler->hysteresis_instance_count;
+  counts.blinks = compiler->blink_instance_count;
+  counts.filters = compiler->filter_instance_count;
+
+  if (counts.timers || counts.edges || counts.counters || counts.latches ||
+      counts.hysteresis || counts.blinks || counts.filters) {
+    st_stateful_storage_t *stateful = st_stateful_create(&counts);
     if (!stateful) {
       st_compiler_error(compiler, "Failed to allocate stateful storage");
       free(bytecode);
       return NULL;
     }
-    st_stateful_init(stateful);
-
-    // Pre-allocate instances based on compiler counts
-    stateful->edge_count = compiler->edge_instance_count;
-    stateful->timer_count = compiler->timer_instance_count;
-    stateful->counter_count = compiler->counter_instance_count;
 
     bytecode->stateful = (struct st_stateful_storage*)stateful;  // Cast to opaque pointer
 
-    debug_printf("[COMPILER] Allocated stateful storage: edges=%d timers=%d counters=%d\n",
-                 compiler->edge_instance_count, compiler->timer_instance_count,
-                 compiler->counter_instance_count);
+    debug_printf("[COMPILER] Allocated stateful storage: edges=%d timers=%d counters=%d latches=%d blinks=%d\n",
+                 counts.edges, counts.timers, counts.counters, counts.latches, counts.blinks);
   } else {
     bytecode->stateful = NULL;
   }
@@ -1848,7 +1860,7 @@ st_bytecode_program_t *st_compiler_compile(st_compiler_t *compiler, st_program_t
   }
 
   if (compiler->error_count > 0) {
-    if (bytecode->stateful) free(bytecode->stateful);
+    st_stateful_destroy((st_stateful_storage_t *)bytecode->stateful);
     if (bytecode->func_registry) free(bytecode->func_registry);
     free(bytecode);
     g_line_map.valid = false;  // Invalidate line map on error
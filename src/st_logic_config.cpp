@@ -10,9 +10,11 @@
 #include "st_debug.h"  // FEAT-008: Reset debug state on delete/compile
 #include "register_allocator.h"
 #include "ir_pool_manager.h"  // v5.1.0 - IR pool management
-#include "st_bytecode_persist.h"  // Bytecode cache in SPIFFS
+#include "st_bytecode_persist.h"  // Bytecode cache (XIP slot or file)
 #include "st_source_scanner.h"   // Chunked compilation pre-scanner
 #include "st_stateful.h"         // st_stateful_storage_t for chunked compile
+#include "gpio_mapping.h"        // Binding plan invalidation (v7.9.9.3)
+#include "persist_writer.h"      // Async file writes (v7.9.9.6)
 #include "debug.h"
 #include "debug_flags.h"
 #include <string.h>
@@ -20,8 +22,10 @@
 #include <stdlib.h>
 #include <nvs_flash.h>
 #include <nvs.h>
+#include <Arduino.h>  // micros() for boot load timing
 #include <FS.h>
-#include <SPIFFS.h>
+#include "fs_store.h"             // Atomic file replace (v7.9.10.3)
+#include "fs_mount.h"
 #include <esp_heap_caps.h>  // heap_caps_malloc for PSRAM allocation (v7.9.7.6)
 
 /* ============================================================================
@@ -108,6 +112,9 @@ const char* st_logic_get_source_code(st_logic_engine_state_t *state, uint8_t pro
   if (!state->source_pool) return NULL;  // v7.9.7.6: pool init fejlede
 
   st_logic_program_config_t *prog = &state->programs[program_id];
+  if (prog->source_deferred) {
+    return NULL;  // Still on the filesystem (st_logic_deferred_source_loop)
+  }
   if (prog->source_offset == 0xFFFFFFFF || prog->source_size == 0) {
     return NULL;  // Not allocated
   }
@@ -202,6 +209,69 @@ static bool st_logic_pool_allocate(st_logic_engine_state_t *state, uint8_t progr
   return true;
 }
 
+/* ============================================================================
+ * DEFERRED SOURCE (v7.9.9.9)
+ * ============================================================================ */
+
+// Source CRC from the boot manifest of programs booted without source
+static uint32_t deferred_crc[ST_LOGIC_MAX_PROGRAMS];
+
+/**
+ * @brief Read the source of a program booted from the bytecode cache
+ *
+ * On failure the program keeps running from its cached bytecode, stays
+ * deferred (retried later) and keeps its manifest size, so a save does
+ * not mistake it for an empty slot.
+ */
+static bool st_logic_load_deferred_source(st_logic_engine_state_t *state, uint8_t program_id) {
+  st_logic_program_config_t *prog = &state->programs[program_id];
+  uint32_t deferred_size = prog->source_size;
+
+  char filename[32];
+  snprintf(filename, sizeof(filename), "/logic_%d.dat", program_id);
+  FsReader file;
+  uint8_t head[5];                     // Enabled flag (RAM is current) + size
+  uint32_t size = 0;
+  if (fs_mount() && fs_read_open(&file, filename) && fs_read(&file, head, sizeof(head)) == sizeof(head)) {
+    memcpy(&size, head + 1, sizeof(size));
+  }
+  if (size == 0 || size > ST_LOGIC_POOL_SIZE || !st_logic_pool_allocate(state, program_id, size) ||
+      fs_read(&file, &state->source_pool[prog->source_offset], size) != size) {
+    fs_read_close(&file);
+    st_logic_pool_free(state, program_id);
+    prog->source_size = deferred_size;
+    debug_printf("ST_LOGIC: Program %u: cannot read deferred source %s (retry in %us)\n",
+                 program_id + 1, filename, (unsigned)(ST_DEFERRED_RETRY_MS / 1000));
+    return false;
+  }
+  fs_read_close(&file);
+  prog->source_deferred = 0;
+
+  if (st_crc32((const uint8_t *)&state->source_pool[prog->source_offset], size) != deferred_crc[program_id]) {
+    debug_printf("ST_LOGIC: Program %u source differs from cached bytecode - compile to resync\n",
+                 program_id + 1);
+  }
+  return true;
+}
+
+void st_logic_deferred_source_loop(st_logic_engine_state_t *state) {
+  static uint32_t next_try_ms = 0;
+  static bool retrying = false;
+  if (!state->source_pool) return;
+
+  uint32_t now = millis();
+  if (retrying && (int32_t)(now - next_try_ms) < 0) return;
+
+  bool failed = false;
+  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+    if (state->programs[i].source_deferred && !st_logic_load_deferred_source(state, i)) {
+      failed = true;
+    }
+  }
+  retrying = failed;
+  next_try_ms = now + ST_DEFERRED_RETRY_MS;
+}
+
 /* ============================================================================
  * PROGRAM UPLOAD & COMPILATION
  * ============================================================================ */
@@ -230,6 +300,15 @@ bool st_logic_upload(st_logic_engine_state_t *state, uint8_t program_id,
     return false;
   }
 
+  // The save replaces the file atomically: old and new copy at once (v7.9.10.3)
+  uint32_t fs_limit = st_logic_fs_source_limit(program_id);
+  if (source_size > fs_limit) {
+    snprintf(prog->last_error, sizeof(prog->last_error),
+             "Too large to save: %u bytes (filesystem max %u)",
+             (unsigned int)source_size, (unsigned int)fs_limit);
+    return false;
+  }
+
   // Try to allocate space in pool
   if (!st_logic_pool_allocate(state, program_id, source_size)) {
     // Calculate available space
@@ -244,7 +323,9 @@ bool st_logic_upload(st_logic_engine_state_t *state, uint8_t program_id,
 
   // Copy source code to pool
   memcpy(&state->source_pool[prog->source_offset], source, source_size);
+  prog->source_deferred = 0;  // Replaces the source still in the file
   prog->compiled = 0;  // Mark as needing compilation
+  gpio_mapping_invalidate();  // Bindings to this program are no longer live
 
   // Invalidate bytecode cache (source changed)
   st_bytecode_invalidate(program_id);
@@ -265,15 +346,16 @@ static bool st_logic_compile_monolithic(st_logic_engine_state_t *state, uint8_t
 
   // Free old dynamic allocations if recompiling
   if (prog->bytecode.instructions) {
-    free(prog->bytecode.instructions);
-    prog->bytecode.instructions = NULL;
-    prog->bytecode.instr_count = 0;
-    prog->bytecode.instr_capacity = 0;
+    st_bytecode_free_instructions(&prog->bytecode);  // Heap or mapped XIP slot
   }
   if (prog->bytecode.func_registry) {
     free(prog->bytecode.func_registry);
     prog->bytecode.func_registry = NULL;
   }
+  if (prog->bytecode.stateful) {
+    st_stateful_destroy((st_stateful_storage_t *)prog->bytecode.stateful);
+    prog->bytecode.stateful = NULL;
+  }
 
   // Get source code from pool
   const char *source_raw = st_logic_get_source_code(state, program_id);
@@ -381,7 +463,7 @@ static bool st_logic_compile_monolithic(st_logic_engine_state_t *state, uint8_t
   free(g_compiler);
   g_compiler = NULL;
 
-  // Save compiled bytecode to SPIFFS cache for fast boot
+  // Save compiled bytecode to the cache for fast boot
   const char *cache_source = st_logic_get_source_code(state, program_id);
   if (cache_source && prog->source_size > 0) {
     st_bytecode_save(program_id, &prog->bytecode, cache_source, prog->source_size);
@@ -498,15 +580,16 @@ bool st_logic_compile_chunked(st_logic_engine_state_t *state, uint8_t program_id
 
   // Free old dynamic allocations if recompiling
   if (prog->bytecode.instructions) {
-    free(prog->bytecode.instructions);
-    prog->bytecode.instructions = NULL;
-    prog->bytecode.instr_count = 0;
-    prog->bytecode.instr_capacity = 0;
+    st_bytecode_free_instructions(&prog->bytecode);  // Heap or mapped XIP slot
   }
   if (prog->bytecode.func_registry) {
     free(prog->bytecode.func_registry);
     prog->bytecode.func_registry = NULL;
   }
+  if (prog->bytecode.stateful) {
+    st_stateful_destroy((st_stateful_storage_t *)prog->bytecode.stateful);
+    prog->bytecode.stateful = NULL;
+  }
 
   // Step 2: VAR pass — parse variable declarations with small AST pool
   g_compiler = (st_compiler_t *)malloc(sizeof(st_compiler_t));
@@ -759,21 +842,9 @@ bool st_logic_compile_chunked(st_logic_engine_state_t *state, uint8_t program_id
     prog->bytecode.func_registry = registry;
     g_compiler->func_registry = NULL;
 
-    // Allocate stateful storage if needed
-    if (g_compiler->edge_instance_count > 0 ||
-        g_compiler->timer_instance_count > 0 ||
-        g_compiler->counter_instance_count > 0) {
-      st_stateful_storage_t *stateful = (st_stateful_storage_t *)malloc(sizeof(st_stateful_storage_t));
-      if (stateful) {
-        st_stateful_init(stateful);
-        stateful->edge_count = g_compiler->edge_instance_count;
-        stateful->timer_count = g_compiler->timer_instance_count;
-        stateful->counter_count = g_compiler->counter_instance_count;
-        prog->bytecode.stateful = (struct st_stateful_storage*)stateful;
-      }
-    } else {
-      prog->bytecode.stateful = NULL;
-    }
+    // Allocate stateful storage if needed (v7.9.9.0: sized from the merged bytecode)
+    prog->bytecode.stateful = (struct st_stateful_storage*)st_stateful_create_for(
+        prog->bytecode.instructions, prog->bytecode.instr_count, NULL);
 
     prog->compiled = 1;
     prog->execution_count = 0;
@@ -828,7 +899,17 @@ chunked_cleanup:
 
 /* Public API: uses monolithic compile with bytecode caching */
 bool st_logic_compile(st_logic_engine_state_t *state, uint8_t program_id) {
-  return st_logic_compile_monolithic(state, program_id);
+  // A deferred program keeps running from its cached bytecode until the
+  // loop task has read its source
+  if (program_id < ST_LOGIC_MAX_PROGRAMS && state->programs[program_id].source_deferred) {
+    snprintf(state->programs[program_id].last_error, sizeof(state->programs[program_id].last_error),
+             "Source not loaded yet - retry");
+    return false;
+  }
+  bool ok = st_logic_compile_monolithic(state, program_id);
+  // Variable types/count may have changed: recompile the binding plan
+  gpio_mapping_invalidate();
+  return ok;
 }
 
 /* ============================================================================
@@ -926,13 +1007,16 @@ bool st_logic_delete(st_logic_engine_state_t *state, uint8_t program_id) {
   // Free dynamic bytecode allocations before clearing program
   st_logic_program_config_t *prog = &state->programs[program_id];
   if (prog->bytecode.instructions) {
-    free(prog->bytecode.instructions);
-    prog->bytecode.instructions = NULL;
+    st_bytecode_free_instructions(&prog->bytecode);  // Heap or mapped XIP slot
   }
   if (prog->bytecode.func_registry) {
     free(prog->bytecode.func_registry);
     prog->bytecode.func_registry = NULL;
   }
+  if (prog->bytecode.stateful) {
+    st_stateful_destroy((st_stateful_storage_t *)prog->bytecode.stateful);
+    prog->bytecode.stateful = NULL;
+  }
 
   // Clear the program itself
   memset(prog, 0, sizeof(*prog));
@@ -987,6 +1071,7 @@ bool st_logic_delete(st_logic_engine_state_t *state, uint8_t program_id) {
       i++;
     }
   }
+  gpio_mapping_invalidate();
 
   return true;
 }
@@ -1018,6 +1103,9 @@ void st_logic_update_binding_counts(st_logic_engine_state_t *state) {
       state->programs[map->st_program_id].binding_count++;
     }
   }
+
+  // Called after every binding edit: recompile the binding plan too
+  gpio_mapping_invalidate();
 }
 
 /**
@@ -1061,41 +1149,188 @@ void st_logic_reset_cycle_stats(st_logic_engine_state_t *state) {
 }
 
 /* ============================================================================
- * PERSISTENCE (SPIFFS STORAGE)
+ * PERSISTENCE (FILE STORAGE, LittleFS since v7.9.10.3)
  * ============================================================================ */
 
+// Boot manifest (v7.9.9.9): enabled flag, size and CRC of every source in
+// NVS, written by the same job as the .dat files. Boot matches the CRCs
+// against the XIP bytecode cache without mounting the filesystem. The
+// manifest is erased before the files are rewritten, so an interrupted save
+// falls back to the file path instead of pairing new sources with old bytecode.
+#define ST_BOOT_NVS_NAMESPACE  "st_logic"
+#define ST_BOOT_NVS_KEY        "boot"
+#define ST_BOOT_MAGIC          0x4253   // "SB"
+
+typedef struct __attribute__((packed)) {
+  uint8_t  enabled;
+  uint32_t source_size;                // 0 = empty slot
+  uint32_t source_crc32;
+} StBootEntry;
+
+typedef struct __attribute__((packed)) {
+  uint16_t magic;
+  uint16_t version;                    // ST_BYTECODE_VERSION at write time
+  StBootEntry programs[ST_LOGIC_MAX_PROGRAMS];
+} StBootManifest;
+
+static bool st_boot_manifest_read(StBootManifest *m) {
+  nvs_handle_t handle;
+  if (nvs_open(ST_BOOT_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) return false;
+  size_t size = sizeof(*m);
+  bool ok = nvs_get_blob(handle, ST_BOOT_NVS_KEY, m, &size) == ESP_OK &&
+            size == sizeof(*m) && m->magic == ST_BOOT_MAGIC && m->version == ST_BYTECODE_VERSION;
+  nvs_close(handle);
+  return ok;
+}
+
+// m == NULL erases the manifest
+static bool st_boot_manifest_write(const StBootManifest *m) {
+  nvs_handle_t handle;
+  if (nvs_open(ST_BOOT_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) return false;
+  esp_err_t err = m ? nvs_set_blob(handle, ST_BOOT_NVS_KEY, m, sizeof(*m))
+                    : nvs_erase_key(handle, ST_BOOT_NVS_KEY);
+  if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) err = nvs_commit(handle);
+  nvs_close(handle);
+  return err == ESP_OK;
+}
+
+// Snapshot of all program sources (v7.9.9.6): per program
+// enabled (1) + source_size (4) + source, packed back to back.
+// A deferred source is not in RAM: source_size ST_SNAPSHOT_KEEP followed by
+// its CRC (4) keeps the file on disk instead of deleting it as empty.
+#define ST_SNAPSHOT_KEEP  0xFFFFFFFFu
+
+static uint32_t st_programs_snapshot_size(st_logic_engine_state_t *state) {
+  uint32_t len = 0;
+  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+    uint32_t size = state->programs[i].source_size;
+    if (state->programs[i].source_deferred) size = 4;
+    else if (size > ST_LOGIC_POOL_SIZE || !st_logic_get_source_code(state, i)) size = 0;
+    len += 5 + size;
+  }
+  return len;
+}
+
+// Keep a deferred program's file; only its enabled flag may have changed,
+// which is copied through to a new file (old one kept on failure)
+static bool st_program_keep_file(const char *filename, uint8_t enabled, uint32_t *source_size) {
+  FsReader in;
+  uint8_t head[5];
+  if (!fs_read_open(&in, filename)) return false;
+  if (fs_read(&in, head, sizeof(head)) != sizeof(head)) {
+    fs_read_close(&in);
+    return false;
+  }
+  memcpy(source_size, head + 1, sizeof(*source_size));
+  if (head[0] == enabled) {
+    fs_read_close(&in);
+    return true;
+  }
+
+  FsWriter out;
+  if (!fs_write_open(&out, filename)) {
+    fs_read_close(&in);
+    return false;
+  }
+  head[0] = enabled;
+  bool ok = fs_write(&out, head, sizeof(head));
+  uint8_t buf[256];
+  uint32_t left = *source_size;
+  while (ok && left > 0) {
+    uint32_t n = fs_read(&in, buf, left < sizeof(buf) ? left : (uint32_t)sizeof(buf));
+    ok = n > 0 && fs_write(&out, buf, n);
+    left -= n;
+  }
+  fs_read_close(&in);
+  if (!ok) {
+    fs_write_abort(&out);
+    return false;
+  }
+  return fs_write_commit(&out);
+}
+
+uint32_t st_logic_fs_source_limit(uint8_t program_id) {
+  if (program_id >= ST_LOGIC_MAX_PROGRAMS || !fs_mount()) return ST_LOGIC_POOL_SIZE;
+
+  FsMountInfo info;
+  fs_mount_info(&info);
+  char filename[32];
+  snprintf(filename, sizeof(filename), "/logic_%d.bc", program_id);
+  int32_t bc_size = fs_size(filename);
+
+  // The old .dat stays until the rename, so nothing of it counts as free
+  uint32_t need = 5 + ST_LOGIC_FS_SLACK + (bc_size > 0 ? (uint32_t)bc_size : 0);
+  uint32_t free_bytes = info.total_bytes > info.used_bytes ? info.total_bytes - info.used_bytes : 0;
+  uint32_t limit = free_bytes > need ? free_bytes - need : 0;
+  return limit < ST_LOGIC_POOL_SIZE ? limit : ST_LOGIC_POOL_SIZE;
+}
+
 /**
- * @brief Save ST Logic programs to SPIFFS (unlimited size)
- * @return true if successful
+ * @brief Write an ST program snapshot to the filesystem (persist writer task)
+ *
+ * Each .dat file is replaced atomically (v7.9.10.3): a reset during the
+ * save leaves every program with either its old or its new source.
  */
-bool st_logic_save_to_nvs(void) {
-  st_logic_engine_state_t *state = st_logic_get_state();
+static bool st_programs_exec(uint16_t key, void *data, uint32_t len) {
+  (void)key;
   DebugFlags* dbg = debug_flags_get();
 
-  // Mount SPIFFS if not already mounted
-  if (!SPIFFS.begin(true)) {
+  // Mount LittleFS if not already mounted
+  if (!fs_mount()) {
     if (dbg->config_save) {
-      debug_println("ST_LOGIC SAVE: SPIFFS mount failed");
+      debug_println("ST_LOGIC SAVE: filesystem mount failed");
     }
     return false;
   }
 
   if (dbg->config_save) {
-    debug_println("ST_LOGIC SAVE: Saving programs to SPIFFS");
+    debug_println("ST_LOGIC SAVE: Saving programs to LittleFS");
   }
 
   // Save each program
+  const uint8_t *p = (const uint8_t *)data;
+  const uint8_t *end = p + len;
   uint8_t saved_count = 0;
-  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
-    st_logic_program_config_t *prog = &state->programs[i];
-
-    // Delete file if program is empty
+  bool ok = st_boot_manifest_write(NULL);
+  StBootManifest manifest;
+  memset(&manifest, 0, sizeof(manifest));
+  manifest.magic = ST_BOOT_MAGIC;
+  manifest.version = ST_BYTECODE_VERSION;
+  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS && p + 5 <= end; i++) {
+    uint8_t enabled = p[0];
+    uint32_t source_size;
+    memcpy(&source_size, p + 1, sizeof(source_size));
+    const uint8_t *source_code = p + 5;
     char filename[32];
     snprintf(filename, sizeof(filename), "/logic_%d.dat", i);
 
-    if (prog->source_size == 0) {
-      if (SPIFFS.exists(filename)) {
-        SPIFFS.remove(filename);
+    // Deferred source: the file on disk is the source
+    if (source_size == ST_SNAPSHOT_KEEP) {
+      p += 5 + 4;
+      if (p > end) return false;
+      manifest.programs[i].enabled = enabled;
+      memcpy(&manifest.programs[i].source_crc32, source_code, 4);
+      if (!st_program_keep_file(filename, enabled, &manifest.programs[i].source_size)) {
+        if (dbg->config_save) {
+          debug_print("  Program ");
+          debug_print_uint(i);
+          debug_println(": FAILED to keep deferred source file");
+        }
+        ok = false;
+      }
+      continue;
+    }
+
+    p += 5 + source_size;
+    if (p > end) return false;
+    manifest.programs[i].enabled = enabled;
+    manifest.programs[i].source_size = source_size;
+    manifest.programs[i].source_crc32 = st_crc32(source_code, source_size);
+
+    // Delete file if program is empty
+    if (source_size == 0) {
+      if (fs_exists(filename)) {
+        fs_remove(filename);
         if (dbg->config_save) {
           debug_print("  Program ");
           debug_print_uint(i);
@@ -1105,35 +1340,39 @@ bool st_logic_save_to_nvs(void) {
       continue;
     }
 
-    // Open file for writing
-    File file = SPIFFS.open(filename, FILE_WRITE);
-    if (!file) {
+    // Write to a temp file, renamed over the old one on commit
+    FsWriter file;
+    if (!fs_write_open(&file, filename)) {
       if (dbg->config_save) {
         debug_print("  Program ");
         debug_print_uint(i);
         debug_println(": FAILED to open file");
       }
+      ok = false;
       continue;
     }
 
     // Write: enabled flag (1 byte) + source size (4 bytes) + source code
-    file.write(prog->enabled);
-    file.write((uint8_t*)&prog->source_size, sizeof(uint32_t));
-
-    // Get source code from pool and write
-    const char *source_code = st_logic_get_source_code(state, i);
-    if (source_code && prog->source_size > 0 && prog->source_size <= ST_LOGIC_POOL_SIZE) {
-      file.write((uint8_t*)source_code, prog->source_size);
+    fs_write(&file, &enabled, 1);
+    fs_write(&file, &source_size, sizeof(uint32_t));
+    fs_write(&file, source_code, source_size);
+    if (!fs_write_commit(&file)) {
+      if (dbg->config_save) {
+        debug_print("  Program ");
+        debug_print_uint(i);
+        debug_println(": FAILED to write file (old file kept)");
+      }
+      ok = false;
+      continue;
     }
-    file.close();
 
     if (dbg->config_save) {
       debug_print("  Program ");
       debug_print_uint(i);
       debug_print(": saved ");
-      debug_print_uint(prog->source_size);
+      debug_print_uint(source_size);
       debug_print(" bytes (enabled=");
-      debug_print_uint(prog->enabled);
+      debug_print_uint(enabled);
       debug_println(")");
     }
     saved_count++;
@@ -1142,173 +1381,304 @@ bool st_logic_save_to_nvs(void) {
   if (dbg->config_save) {
     debug_print("ST_LOGIC SAVE: Saved ");
     debug_print_uint(saved_count);
-    debug_println(" programs to SPIFFS");
+    debug_println(" programs to LittleFS");
   }
 
-  return true;
+  // Only a complete save re-enables the boot fast path
+  if (ok) ok = st_boot_manifest_write(&manifest);
+
+  return ok;
 }
 
 /**
- * @brief Load ST Logic programs from SPIFFS
- * @return true if successful
+ * @brief Save ST Logic programs to the filesystem (unlimited size)
+ * @return true if the write was queued (v7.9.9.6: persist writer task)
+ *
+ * The sources are copied here; the files are written later by the
+ * writer, so the caller never waits for flash.
  */
-bool st_logic_load_from_nvs(void) {
+bool st_logic_save_to_nvs(void) {
   st_logic_engine_state_t *state = st_logic_get_state();
+
+  uint32_t len = st_programs_snapshot_size(state);
+  uint8_t *snap = (uint8_t *)persist_writer_alloc(len);
+  if (!snap) {
+    debug_println("ST_LOGIC SAVE: Out of memory for snapshot");
+    return false;
+  }
+
+  uint8_t *p = snap;
+  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+    st_logic_program_config_t *prog = &state->programs[i];
+    if (prog->source_deferred) {
+      uint32_t keep = ST_SNAPSHOT_KEEP;
+      p[0] = prog->enabled;
+      memcpy(p + 1, &keep, sizeof(keep));
+      memcpy(p + 5, &deferred_crc[i], sizeof(uint32_t));
+      p += 5 + 4;
+      continue;
+    }
+    const char *source_code = st_logic_get_source_code(state, i);
+    uint32_t size = prog->source_size;
+    if (size > ST_LOGIC_POOL_SIZE || !source_code) size = 0;
+    p[0] = prog->enabled;
+    memcpy(p + 1, &size, sizeof(size));
+    if (size > 0) memcpy(p + 5, source_code, size);
+    p += 5 + size;
+  }
+
+  return persist_writer_submit_owned(PW_KEY_ST_PROGRAMS, st_programs_exec, snap, len, NULL, NULL);
+}
+
+// Adopt a program loaded from the bytecode cache: IR pool for EXPORT variables
+static void st_logic_adopt_cached(st_logic_engine_state_t *state, uint8_t program_id) {
+  st_logic_program_config_t *prog = &state->programs[program_id];
+  prog->compiled = 1;
+  prog->bytecode.enabled = prog->enabled;
+
+  // Allocate IR pool for EXPORT variables (same as in st_logic_compile)
+  uint8_t ir_size_needed = ir_pool_calculate_size(&prog->bytecode);
+  if (ir_size_needed > 0) {
+    uint8_t ir_offset = ir_pool_allocate(state, program_id, ir_size_needed);
+    if (ir_offset == 255) {
+      prog->ir_pool_offset = 65535;
+      prog->ir_pool_size = 0;
+    }
+  } else {
+    prog->ir_pool_offset = 65535;
+    prog->ir_pool_size = 0;
+  }
+}
+
+bool st_logic_load_cached(st_logic_engine_state_t *state, uint8_t program_id) {
+  if (program_id >= ST_LOGIC_MAX_PROGRAMS) return false;
+  st_logic_program_config_t *prog = &state->programs[program_id];
+  const char *source = st_logic_get_source_code(state, program_id);
+  if (!source || !st_bytecode_load(program_id, &prog->bytecode, source, prog->source_size)) {
+    return false;
+  }
+  st_logic_adopt_cached(state, program_id);
+  gpio_mapping_invalidate();
+  return true;
+}
+
+// Read /logic_N.dat, then cached bytecode or a full compile
+static bool st_logic_load_program_file(st_logic_engine_state_t *state, uint8_t i) {
   DebugFlags* dbg = debug_flags_get();
+  st_logic_program_config_t *prog = &state->programs[i];
+
+  char filename[32];
+  snprintf(filename, sizeof(filename), "/logic_%d.dat", i);
 
-  // Mount SPIFFS if not already mounted
-  if (!SPIFFS.begin(true)) {
+  // Check if file exists
+  if (!fs_exists(filename)) {
+    // No file for this program slot - OK (empty slot)
+    return false;
+  }
+
+  // Open file for reading
+  FsReader file;
+  if (!fs_read_open(&file, filename)) {
     if (dbg->config_load) {
-      debug_println("ST_LOGIC LOAD: SPIFFS mount failed");
+      debug_print("  Program ");
+      debug_print_uint(i);
+      debug_println(": FAILED to open file");
     }
     return false;
   }
 
+  // Read: enabled flag (1 byte) + source size (4 bytes) + source code
+  uint8_t head[5];
+  if (fs_read(&file, head, sizeof(head)) != sizeof(head)) {
+    if (dbg->config_load) {
+      debug_print("  Program ");
+      debug_print_uint(i);
+      debug_println(": file too small");
+    }
+    fs_read_close(&file);
+    return false;
+  }
+
+  prog->enabled = head[0];
+  memcpy(&prog->source_size, head + 1, sizeof(uint32_t));
+
+  if (prog->source_size == 0 || prog->source_size > ST_LOGIC_POOL_SIZE) {
+    if (dbg->config_load) {
+      debug_print("  Program ");
+      debug_print_uint(i);
+      debug_print(": invalid size ");
+      debug_print_uint(prog->source_size);
+      debug_println("");
+    }
+    fs_read_close(&file);
+    return false;
+  }
+
+  // Allocate space in pool
+  if (!st_logic_pool_allocate(state, i, prog->source_size)) {
+    if (dbg->config_load) {
+      debug_print("  Program ");
+      debug_print_uint(i);
+      debug_println(": FAILED to allocate pool space");
+    }
+    fs_read_close(&file);
+    return false;
+  }
+
+  // Read source code from file into pool
+  uint32_t got = fs_read(&file, &state->source_pool[prog->source_offset], prog->source_size);
+  fs_read_close(&file);
+  prog->compiled = 0;  // Mark as needing recompilation
+  if (got != prog->source_size) {
+    if (dbg->config_load) {
+      debug_print("  Program ");
+      debug_print_uint(i);
+      debug_println(": file truncated");
+    }
+    st_logic_pool_free(state, i);
+    return false;
+  }
+
+  // Try loading cached bytecode first (avoids 36-94 KB peak heap)
+  const char *pool_source = st_logic_get_source_code(state, i);
+  if (pool_source && st_bytecode_load(i, &prog->bytecode, pool_source, prog->source_size)) {
+    st_logic_adopt_cached(state, i);
+
+    if (dbg->config_load) {
+      debug_print("  Program ");
+      debug_print_uint(i);
+      debug_print(": loaded ");
+      debug_print_uint(prog->source_size);
+      debug_print(" bytes, bytecode cached (");
+      debug_print_uint(prog->bytecode.instr_count);
+      debug_println(" instr)");
+    }
+    return true;
+  }
+
+  // Cache miss or invalid — full compile
   if (dbg->config_load) {
-    debug_println("ST_LOGIC LOAD: Loading programs from SPIFFS");
+    debug_print("  Program ");
+    debug_print_uint(i);
+    debug_print(": loaded ");
+    debug_print_uint(prog->source_size);
+    debug_print(" bytes, enabled=");
+    debug_print_uint(prog->enabled);
+    debug_print(", compiling...");
   }
 
-  // Load each program
-  uint8_t loaded_count = 0;
-  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
-    st_logic_program_config_t *prog = &state->programs[i];
+  // Compile (uses chunked for functions, monolithic for simple programs)
+  state->boot_compiled++;
+  if (st_logic_compile(state, i)) {
+    if (dbg->config_load) {
+      debug_println(" OK");
+    }
+    return true;
+  }
+  if (dbg->config_load) {
+    debug_print(" FAILED: ");
+    debug_println(prog->last_error);
+  }
+  return false;
+}
 
-    char filename[32];
-    snprintf(filename, sizeof(filename), "/logic_%d.dat", i);
+/**
+ * @brief Load ST Logic programs from the filesystem
+ * @return true if successful
+ *
+ * v7.9.9.9 fast path: programs whose manifest entry matches a valid XIP
+ * bytecode image (same source CRC and compiler version) are loaded without
+ * mounting the filesystem, reading the source or running the parser. Their source
+ * is read later by the loop task (st_logic_deferred_source_loop). Only the remaining
+ * programs go through LittleFS and, on a cache miss, the compiler.
+ */
+bool st_logic_load_from_nvs(void) {
+  st_logic_engine_state_t *state = st_logic_get_state();
+  DebugFlags* dbg = debug_flags_get();
+  uint32_t start_us = micros();
+  state->boot_cached = 0;
+  state->boot_compiled = 0;
+
+  StBootManifest manifest;
+  bool have_manifest = st_boot_manifest_read(&manifest);
+  uint8_t loaded_count = 0;
+  uint8_t pending = 0;                 // Programs that need the filesystem
 
-    // Check if file exists
-    if (!SPIFFS.exists(filename)) {
-      // No file for this program slot - OK (empty slot)
+  for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+    if (!have_manifest) {
+      pending |= (uint8_t)(1u << i);
       continue;
     }
+    const StBootEntry *e = &manifest.programs[i];
+    if (e->source_size == 0) continue;  // Empty slot
+
+    st_logic_program_config_t *prog = &state->programs[i];
+    if (e->source_size <= ST_LOGIC_POOL_SIZE &&
+        st_bytecode_load_crc(i, &prog->bytecode, e->source_crc32, false)) {
+      prog->enabled = e->enabled;
+      prog->source_size = e->source_size;
+      prog->source_deferred = 1;
+      deferred_crc[i] = e->source_crc32;
+      st_logic_adopt_cached(state, i);
+      state->boot_cached++;
+      loaded_count++;
 
-    // Open file for reading
-    File file = SPIFFS.open(filename, FILE_READ);
-    if (!file) {
       if (dbg->config_load) {
         debug_print("  Program ");
         debug_print_uint(i);
-        debug_println(": FAILED to open file");
+        debug_print(": bytecode cached (");
+        debug_print_uint(prog->bytecode.instr_count);
+        debug_println(" instr), source deferred");
       }
-      continue;
+    } else {
+      pending |= (uint8_t)(1u << i);
     }
+  }
 
-    // Read: enabled flag (1 byte) + source size (4 bytes) + source code
-    if (file.available() < 5) {
+  if (pending) {
+    // Mount LittleFS if not already mounted (migrates SPIFFS once, v7.9.10.3)
+    if (!fs_mount()) {
       if (dbg->config_load) {
-        debug_print("  Program ");
-        debug_print_uint(i);
-        debug_println(": file too small");
+        debug_println("ST_LOGIC LOAD: filesystem mount failed");
       }
-      file.close();
-      continue;
+      state->boot_load_us = micros() - start_us;
+      st_logic_update_binding_counts(state);
+      return false;
     }
 
-    prog->enabled = file.read();
-    file.read((uint8_t*)&prog->source_size, sizeof(uint32_t));
-
-    if (prog->source_size > 0 && prog->source_size <= ST_LOGIC_POOL_SIZE) {
-      // Allocate space in pool
-      if (!st_logic_pool_allocate(state, i, prog->source_size)) {
-        if (dbg->config_load) {
-          debug_print("  Program ");
-          debug_print_uint(i);
-          debug_println(": FAILED to allocate pool space");
-        }
-        file.close();
-        continue;
-      }
-
-      // Read source code from file into pool
-      file.read((uint8_t*)&state->source_pool[prog->source_offset], prog->source_size);
-      prog->compiled = 0;  // Mark as needing recompilation
-      file.close();
-
-      // Try loading cached bytecode first (avoids 36-94 KB peak heap)
-      const char *pool_source = st_logic_get_source_code(state, i);
-      if (pool_source && st_bytecode_load(i, &prog->bytecode, pool_source, prog->source_size)) {
-        prog->compiled = 1;
-        prog->bytecode.enabled = prog->enabled;
-
-        // Allocate IR pool for EXPORT variables (same as in st_logic_compile)
-        uint8_t ir_size_needed = ir_pool_calculate_size(&prog->bytecode);
-        if (ir_size_needed > 0) {
-          uint8_t ir_offset = ir_pool_allocate(state, i, ir_size_needed);
-          if (ir_offset == 255) {
-            prog->ir_pool_offset = 65535;
-            prog->ir_pool_size = 0;
-          }
-        } else {
-          prog->ir_pool_offset = 65535;
-          prog->ir_pool_size = 0;
-        }
+    if (dbg->config_load) {
+      debug_println("ST_LOGIC LOAD: Loading programs from LittleFS");
+    }
 
-        if (dbg->config_load) {
-          debug_print("  Program ");
-          debug_print_uint(i);
-          debug_print(": loaded ");
-          debug_print_uint(prog->source_size);
-          debug_print(" bytes, bytecode cached (");
-          debug_print_uint(prog->bytecode.instr_count);
-          debug_println(" instr)");
-        }
+    for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) {
+      if ((pending & (1u << i)) && st_logic_load_program_file(state, i)) {
         loaded_count++;
-      } else {
-        // Cache miss or invalid — full compile
-        if (dbg->config_load) {
-          debug_print("  Program ");
-          debug_print_uint(i);
-          debug_print(": loaded ");
-          debug_print_uint(prog->source_size);
-          debug_print(" bytes, enabled=");
-          debug_print_uint(prog->enabled);
-          debug_print(", compiling...");
-        }
-
-        // Compile (uses chunked for functions, monolithic for simple programs)
-        if (st_logic_compile(state, i)) {
-          if (dbg->config_load) {
-            debug_println(" OK");
-          }
-          loaded_count++;
-        } else {
-          if (dbg->config_load) {
-            debug_print(" FAILED: ");
-            debug_println(prog->last_error);
-          }
-        }
-      }
-    } else {
-      if (dbg->config_load) {
-        debug_print("  Program ");
-        debug_print_uint(i);
-        debug_print(": invalid size ");
-        debug_print_uint(prog->source_size);
-        debug_println("");
       }
-      file.close();
     }
   }
 
   if (dbg->config_load) {
     debug_print("ST_LOGIC LOAD: Loaded ");
     debug_print_uint(loaded_count);
-    debug_println(" programs from SPIFFS");
+    debug_print(" programs (");
+    debug_print_uint(state->boot_cached);
+    debug_println(" without source)");
   }
 
   // BUG-005 FIX: Update binding count cache after loading programs
   st_logic_update_binding_counts(state);
 
+  state->boot_load_us = micros() - start_us;
   return true;
 }
 
-// Legacy compatibility functions - redirect to SPIFFS storage
+// Legacy compatibility functions - redirect to file storage
 bool st_logic_save_to_persist_config(PersistConfig *config) {
-  (void)config;  // Unused - ST Logic now saves to SPIFFS filesystem
+  (void)config;  // Unused - ST Logic now saves to the filesystem
   return st_logic_save_to_nvs();  // Function name kept for compatibility
 }
 
 bool st_logic_load_from_persist_config(const PersistConfig *config) {
-  (void)config;  // Unused - ST Logic now loads from SPIFFS filesystem
+  (void)config;  // Unused - ST Logic now loads from the filesystem
   return st_logic_load_from_nvs();  // Function name kept for compatibility
 }
@@ -93,9 +93,10 @@ bool st_logic_execute_program(st_logic_engine_state_t *state, uint8_t program_id
   }
 
   // BUG-153 FIX: Update cycle time in stateful storage before execution
+  // v7.9.9.0: Also advance the timer wheel, so all timers see one cycle timestamp
   if (prog->bytecode.stateful) {
     st_stateful_storage_t *stateful = (st_stateful_storage_t*)prog->bytecode.stateful;
-    stateful->cycle_time_ms = state->execution_interval_ms;
+    st_stateful_begin_cycle(stateful, millis(), state->execution_interval_ms);
   }
 
   // FEAT-003: Set function registry for user-defined function calls
@@ -3,40 +3,147 @@
  * @brief Stateful Storage Implementation
  *
  * Manages persistent state for ST function blocks (timers, edges, counters).
+ * v7.9.9.0: Storage is sized per program and owns the program's timer wheel.
  */
 
 #include "st_stateful.h"
+#include "st_builtins.h"
+#include <stdlib.h>
 #include <string.h>
 
 /* ============================================================================
- * STORAGE INITIALIZATION
+ * STORAGE ALLOCATION
  * ============================================================================ */
 
-void st_stateful_init(st_stateful_storage_t* storage) {
-  if (!storage) return;
-
-  // Clear all memory
-  memset(storage, 0, sizeof(st_stateful_storage_t));
+// Round up so every instance array in the allocation stays aligned
+static size_t st_stateful_align(size_t n) {
+  return (n + 7u) & ~(size_t)7u;
+}
+
+bool st_stateful_scan(const st_bytecode_instr_t* instructions, uint16_t instr_count,
+                      st_stateful_counts_t* out) {
+  memset(out, 0, sizeof(*out));
+  if (!instructions) return false;
+
+  for (uint16_t i = 0; i < instr_count; i++) {
+    if (instructions[i].opcode != ST_OP_CALL_BUILTIN) continue;
+
+    uint8_t func_id = instructions[i].arg.builtin_call.func_id_low;
+    uint8_t used = instructions[i].arg.builtin_call.instance_id + 1;
+    uint8_t* count = NULL;
+
+    switch (func_id) {
+      case ST_BUILTIN_TON: case ST_BUILTIN_TOF: case ST_BUILTIN_TP:
+        count = &out->timers; break;
+      case ST_BUILTIN_R_TRIG: case ST_BUILTIN_F_TRIG:
+        count = &out->edges; break;
+      case ST_BUILTIN_CTU: case ST_BUILTIN_CTD: case ST_BUILTIN_CTUD:
+        count = &out->counters; break;
+      case ST_BUILTIN_SR: case ST_BUILTIN_RS:
+        count = &out->latches; break;
+      case ST_BUILTIN_HYSTERESIS:
+        count = &out->hysteresis; break;
+      case ST_BUILTIN_BLINK:
+        count = &out->blinks; break;
+      case ST_BUILTIN_FILTER:
+        count = &out->filters; break;
+      default:
+        break;  // Stateless builtin
+    }
+    if (count && used > *count) *count = used;
+  }
 
-  // Reset counters
-  storage->timer_count = 0;
-  storage->edge_count = 0;
-  storage->counter_count = 0;
-  storage->latch_count = 0;  // v4.7.3: SR/RS latches
-  storage->hysteresis_count = 0;  // v4.8: Signal processing
-  storage->blink_count = 0;
-  storage->filter_count = 0;
+  return (out->timers | out->edges | out->counters | out->latches |
+          out->hysteresis | out->blinks | out->filters) != 0;
+}
+
+st_stateful_storage_t* st_stateful_create(const st_stateful_counts_t* counts) {
+  if (!counts) return NULL;
+
+  uint16_t node_count = (uint16_t)counts->timers + counts->blinks;
+
+  // One allocation: header, then each instance array
+  size_t size = st_stateful_align(sizeof(st_stateful_storage_t));
+  size_t off_timers = size;  size += st_stateful_align(counts->timers * sizeof(st_timer_instance_t));
+  size_t off_edges = size;   size += st_stateful_align(counts->edges * sizeof(st_edge_instance_t));
+  size_t off_counters = size; size += st_stateful_align(counts->counters * sizeof(st_counter_instance_t));
+  size_t off_latches = size; size += st_stateful_align(counts->latches * sizeof(st_latch_instance_t));
+  size_t off_hyst = size;    size += st_stateful_align(counts->hysteresis * sizeof(st_hysteresis_instance_t));
+  size_t off_blinks = size;  size += st_stateful_align(counts->blinks * sizeof(st_blink_instance_t));
+  size_t off_filters = size; size += st_stateful_align(counts->filters * sizeof(st_filter_instance_t));
+  size_t off_nodes = size;   size += node_count * sizeof(st_wheel_node_t);
+
+  uint8_t* base = (uint8_t*)malloc(size);
+  if (!base) return NULL;
+  memset(base, 0, size);
+
+  st_stateful_storage_t* storage = (st_stateful_storage_t*)base;
+  storage->timers = (st_timer_instance_t*)(base + off_timers);
+  storage->timer_count = counts->timers;
+  storage->edges = (st_edge_instance_t*)(base + off_edges);
+  storage->edge_count = counts->edges;
+  storage->counters = (st_counter_instance_t*)(base + off_counters);
+  storage->counter_count = counts->counters;
+  storage->latches = (st_latch_instance_t*)(base + off_latches);
+  storage->latch_count = counts->latches;  // v4.7.3: SR/RS latches
+  storage->hysteresis = (st_hysteresis_instance_t*)(base + off_hyst);
+  storage->hysteresis_count = counts->hysteresis;  // v4.8: Signal processing
+  storage->blinks = (st_blink_instance_t*)(base + off_blinks);
+  storage->blink_count = counts->blinks;
+  storage->filters = (st_filter_instance_t*)(base + off_filters);
+  storage->filter_count = counts->filters;
+
+  // Wheel nodes: timers first, then blinks
+  storage->wheel_nodes = (st_wheel_node_t*)(base + off_nodes);
+  for (uint8_t i = 0; i < storage->timer_count; i++) {
+    storage->timers[i].wheel_node = i;
+  }
+  for (uint8_t i = 0; i < storage->blink_count; i++) {
+    storage->blinks[i].wheel_node = (uint16_t)(storage->timer_count + i);
+  }
+  // Time base is taken from the first st_stateful_begin_cycle() (empty wheel)
+  st_wheel_init(&storage->wheel, storage->wheel_nodes, node_count, 0);
 
   // BUG-153 FIX: Default cycle time (will be overridden by engine)
   storage->cycle_time_ms = 10;  // 10ms default (100Hz)
 
   // Mark as initialized
   storage->initialized = true;
+
+  return storage;
+}
+
+st_stateful_storage_t* st_stateful_create_for(const st_bytecode_instr_t* instructions,
+                                              uint16_t instr_count, bool* out_of_memory) {
+  if (out_of_memory) *out_of_memory = false;
+
+  st_stateful_counts_t counts;
+  if (!st_stateful_scan(instructions, instr_count, &counts)) return NULL;
+
+  st_stateful_storage_t* storage = st_stateful_create(&counts);
+  if (!storage && out_of_memory) *out_of_memory = true;
+  return storage;
+}
+
+void st_stateful_destroy(st_stateful_storage_t* storage) {
+  free(storage);
+}
+
+void st_stateful_begin_cycle(st_stateful_storage_t* storage, uint32_t now_ms, uint32_t cycle_time_ms) {
+  if (!storage || !storage->initialized) return;
+
+  storage->cycle_time_ms = cycle_time_ms;
+
+  // Marks expired deadlines; with nothing scheduled this only sets wheel.now
+  st_wheel_advance(&storage->wheel, now_ms);
 }
 
 void st_stateful_reset(st_stateful_storage_t* storage) {
   if (!storage || !storage->initialized) return;
 
+  // Drop all pending deadlines
+  st_wheel_init(&storage->wheel, storage->wheel_nodes, storage->wheel.node_count, storage->wheel.now);
+
   // Reset all timers
   for (uint8_t i = 0; i < storage->timer_count; i++) {
     storage->timers[i].Q = false;
@@ -84,28 +191,9 @@ void st_stateful_reset(st_stateful_storage_t* storage) {
 }
 
 /* ============================================================================
- * TIMER ALLOCATION
+ * TIMER ACCESS
  * ============================================================================ */
 
-st_timer_instance_t* st_stateful_alloc_timer(st_stateful_storage_t* storage, st_timer_type_t type) {
-  if (!storage || !storage->initialized) return NULL;
-  if (storage->timer_count >= ST_MAX_TIMER_INSTANCES) return NULL;
-
-  // Get next slot
-  st_timer_instance_t* timer = &storage->timers[storage->timer_count];
-  storage->timer_count++;
-
-  // Initialize timer
-  memset(timer, 0, sizeof(st_timer_instance_t));
-  timer->type = type;
-  timer->Q = false;
-  timer->ET = 0;
-  timer->running = false;
-  timer->last_IN = false;
-
-  return timer;
-}
-
 st_timer_instance_t* st_stateful_get_timer(st_stateful_storage_t* storage, uint8_t instance_id) {
   if (!storage || !storage->initialized) return NULL;
   if (instance_id >= storage->timer_count) return NULL;
@@ -113,25 +201,9 @@ st_timer_instance_t* st_stateful_get_timer(st_stateful_storage_t* storage, uint8
 }
 
 /* ============================================================================
- * EDGE DETECTOR ALLOCATION
+ * EDGE DETECTOR ACCESS
  * ============================================================================ */
 
-st_edge_instance_t* st_stateful_alloc_edge(st_stateful_storage_t* storage, st_edge_type_t type) {
-  if (!storage || !storage->initialized) return NULL;
-  if (storage->edge_count >= ST_MAX_EDGE_INSTANCES) return NULL;
-
-  // Get next slot
-  st_edge_instance_t* edge = &storage->edges[storage->edge_count];
-  storage->edge_count++;
-
-  // Initialize edge detector
-  memset(edge, 0, sizeof(st_edge_instance_t));
-  edge->type = type;
-  edge->last_state = false;
-
-  return edge;
-}
-
 st_edge_instance_t* st_stateful_get_edge(st_stateful_storage_t* storage, uint8_t instance_id) {
   if (!storage || !storage->initialized) return NULL;
   if (instance_id >= storage->edge_count) return NULL;
@@ -139,33 +211,9 @@ st_edge_instance_t* st_stateful_get_edge(st_stateful_storage_t* storage, uint8_t
 }
 
 /* ============================================================================
- * COUNTER ALLOCATION
+ * COUNTER ACCESS
  * ============================================================================ */
 
-st_counter_instance_t* st_stateful_alloc_counter(st_stateful_storage_t* storage, st_counter_type_t type) {
-  if (!storage || !storage->initialized) return NULL;
-  if (storage->counter_count >= ST_MAX_COUNTER_INSTANCES) return NULL;
-
-  // Get next slot
-  st_counter_instance_t* counter = &storage->counters[storage->counter_count];
-  storage->counter_count++;
-
-  // Initialize counter
-  memset(counter, 0, sizeof(st_counter_instance_t));
-  counter->type = type;
-  counter->CV = 0;
-  counter->PV = 0;
-  counter->Q = false;
-  counter->QU = false;
-  counter->QD = false;
-  counter->last_CU = false;
-  counter->last_CD = false;
-  counter->last_RESET = false;
-  counter->last_LOAD = false;
-
-  return counter;
-}
-
 st_counter_instance_t* st_stateful_get_counter(st_stateful_storage_t* storage, uint8_t instance_id) {
   if (!storage || !storage->initialized) return NULL;
   if (instance_id >= storage->counter_count) return NULL;
@@ -173,25 +221,9 @@ st_counter_instance_t* st_stateful_get_counter(st_stateful_storage_t* storage, u
 }
 
 /* ============================================================================
- * LATCH ALLOCATION
+ * LATCH ACCESS
  * ============================================================================ */
 
-st_latch_instance_t* st_stateful_alloc_latch(st_stateful_storage_t* storage, st_latch_type_t type) {
-  if (!storage || !storage->initialized) return NULL;
-  if (storage->latch_count >= ST_MAX_LATCH_INSTANCES) return NULL;
-
-  // Get next slot
-  st_latch_instance_t* latch = &storage->latches[storage->latch_count];
-  storage->latch_count++;
-
-  // Initialize latch
-  memset(latch, 0, sizeof(st_latch_instance_t));
-  latch->type = type;
-  latch->Q = false;
-
-  return latch;
-}
-
 st_latch_instance_t* st_stateful_get_latch(st_stateful_storage_t* storage, uint8_t instance_id) {
   if (!storage || !storage->initialized) return NULL;
   if (instance_id >= storage->latch_count) return NULL;
@@ -199,68 +231,21 @@ st_latch_instance_t* st_stateful_get_latch(st_stateful_storage_t* storage, uint8
 }
 
 /* ============================================================================
- * SIGNAL PROCESSING ALLOCATION (v4.8)
+ * SIGNAL PROCESSING ACCESS (v4.8)
  * ============================================================================ */
 
-st_hysteresis_instance_t* st_stateful_alloc_hysteresis(st_stateful_storage_t* storage) {
-  if (!storage || !storage->initialized) return NULL;
-  if (storage->hysteresis_count >= ST_MAX_HYSTERESIS_INSTANCES) return NULL;
-
-  // Get next slot
-  st_hysteresis_instance_t* hyst = &storage->hysteresis[storage->hysteresis_count];
-  storage->hysteresis_count++;
-
-  // Initialize hysteresis
-  memset(hyst, 0, sizeof(st_hysteresis_instance_t));
-  hyst->Q = false;
-
-  return hyst;
-}
-
 st_hysteresis_instance_t* st_stateful_get_hysteresis(st_stateful_storage_t* storage, uint8_t instance_id) {
   if (!storage || !storage->initialized) return NULL;
   if (instance_id >= storage->hysteresis_count) return NULL;
   return &storage->hysteresis[instance_id];
 }
 
-st_blink_instance_t* st_stateful_alloc_blink(st_stateful_storage_t* storage) {
-  if (!storage || !storage->initialized) return NULL;
-  if (storage->blink_count >= ST_MAX_BLINK_INSTANCES) return NULL;
-
-  // Get next slot
-  st_blink_instance_t* blink = &storage->blinks[storage->blink_count];
-  storage->blink_count++;
-
-  // Initialize blink
-  memset(blink, 0, sizeof(st_blink_instance_t));
-  blink->Q = false;
-  blink->state = 0;  // IDLE
-  blink->timer = 0;
-
-  return blink;
-}
-
 st_blink_instance_t* st_stateful_get_blink(st_stateful_storage_t* storage, uint8_t instance_id) {
   if (!storage || !storage->initialized) return NULL;
   if (instance_id >= storage->blink_count) return NULL;
   return &storage->blinks[instance_id];
 }
 
-st_filter_instance_t* st_stateful_alloc_filter(st_stateful_storage_t* storage) {
-  if (!storage || !storage->initialized) return NULL;
-  if (storage->filter_count >= ST_MAX_FILTER_INSTANCES) return NULL;
-
-  // Get next slot
-  st_filter_instance_t* filter = &storage->filters[storage->filter_count];
-  storage->filter_count++;
-
-  // Initialize filter
-  memset(filter, 0, sizeof(st_filter_instance_t));
-  filter->out_prev = 0.0f;
-
-  return filter;
-}
-
 st_filter_instance_t* st_stateful_get_filter(st_stateful_storage_t* storage, uint8_t instance_id) {
   if (!storage || !storage->initialized) return NULL;
   if (instance_id >= storage->filter_count) return NULL;
@@ -0,0 +1,156 @@
+/**
+ * @file st_timer_wheel.cpp
+ * @brief Hierarchical timer wheel for ST timer deadlines (v7.9.9.0)
+ *
+ * LAYER 5: Feature Engines - ST Logic (pure logic)
+ */
+
+#include "st_timer_wheel.h"
+
+#define ST_WHEEL_MASK  (ST_WHEEL_SLOTS - 1)
+
+static void wheel_unlink(st_timer_wheel_t *w, uint16_t id)
+{
+  st_wheel_node_t *n = &w->nodes[id];
+  if (n->prev != ST_WHEEL_NONE) w->nodes[n->prev].next = n->next;
+  else w->head[n->slot] = n->next;
+  if (n->next != ST_WHEEL_NONE) w->nodes[n->next].prev = n->prev;
+
+  w->level_pending[n->slot / ST_WHEEL_SLOTS]--;
+  w->pending--;
+  n->state = ST_WHEEL_IDLE;
+}
+
+// Link into the level whose slot span covers the distance to the deadline
+static void wheel_link(st_timer_wheel_t *w, uint16_t id)
+{
+  st_wheel_node_t *n = &w->nodes[id];
+  uint32_t delta = n->expires - w->now;
+
+  uint8_t level = 0;
+  while (level < ST_WHEEL_LEVELS - 1 && delta >= (1u << (ST_WHEEL_BITS * (level + 1)))) {
+    level++;
+  }
+  uint8_t slot = level * ST_WHEEL_SLOTS +
+                 ((n->expires >> (ST_WHEEL_BITS * level)) & ST_WHEEL_MASK);
+
+  n->slot = slot;
+  n->prev = ST_WHEEL_NONE;
+  n->next = w->head[slot];
+  if (n->next != ST_WHEEL_NONE) w->nodes[n->next].prev = id;
+  w->head[slot] = id;
+
+  w->level_pending[level]++;
+  w->pending++;
+  n->state = ST_WHEEL_PENDING;
+}
+
+void st_wheel_init(st_timer_wheel_t *w, st_wheel_node_t *nodes, uint16_t node_count,
+                   uint32_t now_ms)
+{
+  w->nodes = nodes;
+  w->node_count = node_count;
+  w->pending = 0;
+  w->now = now_ms;
+  w->fired_total = 0;
+  for (uint8_t l = 0; l < ST_WHEEL_LEVELS; l++) w->level_pending[l] = 0;
+  for (uint16_t s = 0; s < ST_WHEEL_LEVELS * ST_WHEEL_SLOTS; s++) w->head[s] = ST_WHEEL_NONE;
+  for (uint16_t i = 0; i < node_count; i++) {
+    nodes[i].state = ST_WHEEL_IDLE;
+    nodes[i].next = nodes[i].prev = ST_WHEEL_NONE;
+  }
+}
+
+void st_wheel_schedule(st_timer_wheel_t *w, uint16_t id, uint32_t expires)
+{
+  if (id >= w->node_count) return;
+  st_wheel_node_t *n = &w->nodes[id];
+  if (n->state == ST_WHEEL_PENDING) wheel_unlink(w, id);
+
+  n->expires = expires;
+  if ((int32_t)(expires - w->now) <= 0) {
+    n->state = ST_WHEEL_FIRED;
+    w->fired_total++;
+    return;
+  }
+  wheel_link(w, id);
+}
+
+void st_wheel_cancel(st_timer_wheel_t *w, uint16_t id)
+{
+  if (id >= w->node_count) return;
+  if (w->nodes[id].state == ST_WHEEL_PENDING) wheel_unlink(w, id);
+  w->nodes[id].state = ST_WHEEL_IDLE;
+}
+
+bool st_wheel_take_fired(st_timer_wheel_t *w, uint16_t id)
+{
+  if (id >= w->node_count || w->nodes[id].state != ST_WHEEL_FIRED) return false;
+  w->nodes[id].state = ST_WHEEL_IDLE;
+  return true;
+}
+
+// Move every node of one slot down to the level matching its remaining time
+static void wheel_cascade(st_timer_wheel_t *w, uint8_t slot)
+{
+  uint16_t id = w->head[slot];
+  while (id != ST_WHEEL_NONE) {
+    uint16_t next = w->nodes[id].next;
+    wheel_unlink(w, id);
+    wheel_link(w, id);
+    id = next;
+  }
+}
+
+uint16_t st_wheel_advance(st_timer_wheel_t *w, uint32_t now_ms)
+{
+  uint16_t fired = 0;
+
+  // Nothing scheduled: follow the clock whatever the distance or sign, so a
+  // stale start (fresh wheel, program idle > 24.8 days) cannot freeze it
+  if (w->pending == 0) {
+    w->now = now_ms;
+    return 0;
+  }
+
+  while ((int32_t)(now_ms - w->now) > 0) {
+    if (w->pending == 0) {
+      w->now = now_ms;
+      break;
+    }
+
+    // Nothing happens before the next boundary of the lowest non-empty
+    // level: jump to the tick just before it
+    uint8_t lowest = 0;
+    while (w->level_pending[lowest] == 0) lowest++;
+    if (lowest > 0) {
+      uint32_t last = w->now | ((1u << (ST_WHEEL_BITS * lowest)) - 1);
+      if ((int32_t)(last - now_ms) >= 0) {
+        w->now = now_ms;
+        break;
+      }
+      w->now = last;
+    }
+
+    w->now++;
+
+    // Entering a new block of level l: its slot moves down
+    for (uint8_t l = 1; l < ST_WHEEL_LEVELS; l++) {
+      if (w->now & ((1u << (ST_WHEEL_BITS * l)) - 1)) break;
+      wheel_cascade(w, l * ST_WHEEL_SLOTS + ((w->now >> (ST_WHEEL_BITS * l)) & ST_WHEEL_MASK));
+    }
+
+    uint8_t slot = w->now & ST_WHEEL_MASK;
+    uint16_t id = w->head[slot];
+    while (id != ST_WHEEL_NONE) {
+      uint16_t next = w->nodes[id].next;
+      wheel_unlink(w, id);
+      w->nodes[id].state = ST_WHEEL_FIRED;
+      w->fired_total++;
+      fired++;
+      id = next;
+    }
+  }
+
+  return fired;
+}
@@ -17,6 +17,8 @@
 #include "counter_engine.h"     // v7.7.2: HW counter access
 #include "counter_config.h"     // v7.7.2: Counter config get/set
 #include "counter_frequency.h"  // v7.7.2: Frequency read
+#include "counter_sw_isr.h"     // v7.9.8.7: Edge timestamp ring (CNT_EDGES)
+#include "di_irq.h"             // v7.9.9.4: Interrupt-driven inputs (DI_CAUGHT, DI_PULSE)
 #include "registers.h"          // v7.7.2: Register read/write for CNT_CTRL/STATUS
 #include "constants.h"          // v7.7.2: COUNTER_COUNT, HOLDING_REGS_SIZE
 #include "debug.h"
@@ -34,6 +36,65 @@ static inline st_datatype_t st_normalize_type(st_datatype_t t) {
   return (t == ST_TYPE_TIME) ? ST_TYPE_DINT : t;
 }
 
+/* ============================================================================
+ * FEAT-156: CNT_EDGES consumer state (one cursor per counter, shared by all
+ * ST programs — each edge interval is handed out once)
+ * ============================================================================ */
+typedef struct {
+  uint32_t cursor;    // Next edge number to read from the counter's ring
+  uint32_t prev_us;   // Timestamp of the previous edge read
+  uint8_t armed;      // Ring enabled and cursor positioned
+  uint8_t have_prev;  // prev_us is valid (cleared after lost edges)
+} st_cnt_edge_reader_t;
+
+static st_cnt_edge_reader_t st_cnt_edge_reader[COUNTER_COUNT];
+
+// Next edge-to-edge interval in µs, or -1 if no new interval is available
+static int32_t st_cnt_edges_next(uint8_t id) {
+  st_cnt_edge_reader_t *r = &st_cnt_edge_reader[id - 1];
+  if (!r->armed) {
+    // First call enables capture; only edges from now on are reported
+    if (!counter_sw_isr_edges_enable(id)) return -1;
+    counter_sw_isr_edges_window(id, NULL, &r->cursor);
+    r->have_prev = 0;
+    r->armed = 1;
+  }
+
+  uint32_t stamp, lost = 0;
+  while (counter_sw_isr_edges_read(id, &r->cursor, &stamp, 1, &lost) == 1) {
+    bool valid = r->have_prev && lost == 0;
+    uint32_t interval = stamp - r->prev_us;
+    r->prev_us = stamp;
+    r->have_prev = 1;
+    lost = 0;
+    if (valid) return (interval > (uint32_t)INT32_MAX) ? INT32_MAX : (int32_t)interval;
+  }
+  if (lost) r->have_prev = 0;  // Gap: next edge only re-anchors
+  return -1;
+}
+
+/* ============================================================================
+ * FEAT-163: DI_PULSE consumer state (pulses seen per pin, shared by all ST
+ * programs — each pulse is handed out once)
+ * ============================================================================ */
+static uint32_t st_di_pulse_seen[DI_IRQ_PIN_COUNT];
+static uint8_t st_di_pulse_armed[DI_IRQ_PIN_COUNT];
+
+// Width of the latest pulse completed since the last call, or -1
+static int32_t st_di_pulse_next(uint8_t pin) {
+  uint32_t count, width;
+  if (!di_irq_get_pulse(pin, &count, &width)) return -1;
+  if (!st_di_pulse_armed[pin]) {
+    // First call: only pulses from now on are reported
+    st_di_pulse_seen[pin] = count;
+    st_di_pulse_armed[pin] = 1;
+    return -1;
+  }
+  if (count == st_di_pulse_seen[pin]) return -1;
+  st_di_pulse_seen[pin] = count;
+  return (width > (uint32_t)INT32_MAX) ? INT32_MAX : (int32_t)width;
+}
+
 /* ============================================================================
  * INITIALIZATION & RESET
  * ============================================================================ */
@@ -1370,11 +1431,11 @@ static bool st_vm_exec_call_builtin(st_vm_t *vm, st_bytecode_instr_t *instr) {
     }
     st_timer_instance_t *instance = &stateful->timers[instance_id];
     if (func_id == ST_BUILTIN_TON) {
-      result = st_builtin_ton(arg1, arg2, instance);
+      result = st_builtin_ton(arg1, arg2, instance, &stateful->wheel);
     } else if (func_id == ST_BUILTIN_TOF) {
-      result = st_builtin_tof(arg1, arg2, instance);
+      result = st_builtin_tof(arg1, arg2, instance, &stateful->wheel);
     } else {
-      result = st_builtin_tp(arg1, arg2, instance);
+      result = st_builtin_tp(arg1, arg2, instance, &stateful->wheel);
     }
   }
   else if (func_id == ST_BUILTIN_CTU || func_id == ST_BUILTIN_CTD || func_id == ST_BUILTIN_CTUD) {
@@ -1575,7 +1636,7 @@ static bool st_vm_exec_call_builtin(st_vm_t *vm, st_bytecode_instr_t *instr) {
                            0;
 
     st_blink_instance_t *instance = &stateful->blinks[instance_id];
-    result = st_builtin_blink(enable_bool, on_time_int, off_time_int, instance);
+    result = st_builtin_blink(enable_bool, on_time_int, off_time_int, instance, &stateful->wheel);
   }
   else if (func_id == ST_BUILTIN_FILTER) {
     // BUG-158 FIX: Check vm->program first
@@ -1841,6 +1902,51 @@ static bool st_vm_exec_call_builtin(st_vm_t *vm, st_bytecode_instr_t *instr) {
       result.int_val = status;
     }
   }
+  else if (func_id == ST_BUILTIN_CNT_EDGES) {
+    // CNT_EDGES(id) → DINT (µs between the next unread captured edge and the
+    // one before it; -1 if none). Needs SW_ISR mode; first call enables capture.
+    int16_t cnt_id = (arg1_type == ST_TYPE_DINT) ? (int16_t)arg1.dint_val : arg1.int_val;
+    if (cnt_id < 1 || cnt_id > COUNTER_COUNT) {
+      result.dint_val = -1;
+    } else {
+      result.dint_val = st_cnt_edges_next((uint8_t)cnt_id);
+    }
+  }
+  else if (func_id == ST_BUILTIN_CNT_POS) {
+    // CNT_POS(id) → DINT (signed quadrature position, clamped to DINT range;
+    // counter value in single-input mode)
+    int16_t cnt_id = (arg1_type == ST_TYPE_DINT) ? (int16_t)arg1.dint_val : arg1.int_val;
+    if (cnt_id < 1 || cnt_id > COUNTER_COUNT) {
+      result.dint_val = 0;
+    } else {
+      int64_t pos = counter_engine_get_position(cnt_id);
+      if (pos > INT32_MAX) pos = INT32_MAX;
+      if (pos < INT32_MIN) pos = INT32_MIN;
+      result.dint_val = (int32_t)pos;
+    }
+  }
+  else if (func_id == ST_BUILTIN_DI_CAUGHT) {
+    // DI_CAUGHT(pin) → BOOL (an edge was seen on the interrupt input since the
+    // last call; read-and-clear, so pulses shorter than the ST cycle count)
+    int16_t pin = (arg1_type == ST_TYPE_DINT) ? (int16_t)arg1.dint_val : arg1.int_val;
+    result.bool_val = (pin >= 0 && pin < DI_IRQ_PIN_COUNT) ? di_irq_caught((uint8_t)pin, true) : false;
+  }
+  else if (func_id == ST_BUILTIN_DI_PULSE) {
+    // DI_PULSE(pin) → DINT (µs width of the latest high pulse completed since
+    // the last call; -1 if none or the pin is not interrupt driven)
+    int16_t pin = (arg1_type == ST_TYPE_DINT) ? (int16_t)arg1.dint_val : arg1.int_val;
+    result.dint_val = (pin >= 0 && pin < DI_IRQ_PIN_COUNT) ? st_di_pulse_next((uint8_t)pin) : -1;
+  }
+  else if (func_id == ST_BUILTIN_CNT_VEL) {
+    // CNT_VEL(id) → DINT (filtered counts/s, negative when reversing;
+    // measured Hz in single-input mode)
+    int16_t cnt_id = (arg1_type == ST_TYPE_DINT) ? (int16_t)arg1.dint_val : arg1.int_val;
+    if (cnt_id < 1 || cnt_id > COUNTER_COUNT) {
+      result.dint_val = 0;
+    } else {
+      result.dint_val = counter_engine_get_velocity(cnt_id);
+    }
+  }
   else {
     result = st_builtin_call(func_id, arg1, arg2);
   }
@@ -2056,7 +2162,7 @@ bool st_vm_step(st_vm_t *vm) {
           val.bool_val = ti->Q;
           val_type = ST_TYPE_BOOL;
         } else if (field_id == 1) {
-          val.dint_val = (int32_t)ti->ET;
+          val.dint_val = (int32_t)st_timer_get_et(ti, stateful->wheel.now);
           val_type = ST_TYPE_DINT;  // TIME represented as DINT in VM
         }
       } else if (fb_type == 1) {
@@ -0,0 +1,197 @@
+/**
+ * @file st_xip_image.cpp
+ * @brief Execute-in-place bytecode images (v7.9.9.8)
+ *
+ * LAYER 5: ST Logic - Flash image format (pure, no ESP-IDF)
+ * Images are only read by the firmware that wrote them, so instructions
+ * and registry entries are stored as raw structs; the header records their
+ * sizes and the compiler version, and any mismatch means recompile.
+ */
+
+#include "st_xip_image.h"
+#include "st_bytecode_persist.h"
+#include <stddef.h>
+#include <string.h>
+
+#define XIP_VAR_BYTES  (16 + 1 + 1)   // Name + type + export flag (initial value separate)
+
+static uint32_t align_up(uint32_t v, uint32_t a) {
+  return (v + a - 1) & ~(a - 1);
+}
+
+uint32_t st_crc32(const uint8_t *data, uint32_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (uint32_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      if (crc & 1)
+        crc = (crc >> 1) ^ 0xEDB88320;
+      else
+        crc >>= 1;
+    }
+  }
+  return ~crc;
+}
+
+static uint8_t func_total(const st_bytecode_program_t *bc) {
+  const st_function_registry_t *reg = bc->func_registry;
+  return reg ? (uint8_t)(reg->builtin_count + reg->user_count) : 0;
+}
+
+// Offsets of the three payload blocks for the given counts
+static void layout(uint16_t instr_count, uint8_t var_count, uint8_t funcs,
+                   uint32_t *instr_off, uint32_t *vars_off, uint32_t *funcs_off, uint32_t *size) {
+  *instr_off = align_up(sizeof(st_xip_header_t), 8);
+  *vars_off = *instr_off + (uint32_t)instr_count * sizeof(st_bytecode_instr_t);
+  uint32_t initial_off = align_up(*vars_off + (uint32_t)var_count * XIP_VAR_BYTES, 4);
+  *funcs_off = align_up(initial_off + (uint32_t)var_count * sizeof(st_value_t), 4);
+  *size = *funcs_off + (uint32_t)funcs * sizeof(st_function_entry_t);
+}
+
+uint32_t st_xip_image_size(const st_bytecode_program_t *bc) {
+  uint32_t instr_off, vars_off, funcs_off, size;
+  layout(bc->instr_count, bc->var_count, func_total(bc), &instr_off, &vars_off, &funcs_off, &size);
+  return size;
+}
+
+uint32_t st_xip_build(const st_bytecode_program_t *bc, uint32_t source_crc32,
+                      uint8_t *out, uint32_t cap) {
+  if (!bc->instructions || bc->instr_count == 0 || bc->var_count > 32) return 0;
+  uint8_t funcs = func_total(bc);
+  if (funcs > 32) return 0;
+
+  uint32_t instr_off, vars_off, funcs_off, size;
+  layout(bc->instr_count, bc->var_count, funcs, &instr_off, &vars_off, &funcs_off, &size);
+  if (size > cap) return 0;
+
+  st_xip_header_t h;
+  memset(&h, 0, sizeof(h));
+  h.instr_offset = instr_off;
+  h.vars_offset = vars_off;
+  h.funcs_offset = funcs_off;
+  h.image_size = size;
+
+  // Padding reads back as erased flash
+  memset(out, 0xFF, h.image_size);
+  memcpy(out + h.instr_offset, bc->instructions, (size_t)bc->instr_count * sizeof(st_bytecode_instr_t));
+
+  uint8_t n = bc->var_count;
+  uint8_t *v = out + h.vars_offset;
+  memcpy(v, bc->var_names, (size_t)n * 16);
+  for (uint8_t i = 0; i < n; i++) {
+    v[n * 16 + i] = (uint8_t)bc->var_types[i];
+    v[n * 17 + i] = bc->var_export_flags[i];
+  }
+  uint32_t initial_off = align_up(h.vars_offset + (uint32_t)n * XIP_VAR_BYTES, 4);
+  memcpy(out + initial_off, bc->var_initial, (size_t)n * sizeof(st_value_t));
+  if (funcs) {
+    memcpy(out + h.funcs_offset, bc->func_registry->functions, (size_t)funcs * sizeof(st_function_entry_t));
+  }
+
+  h.magic = ST_XIP_MAGIC;
+  h.version = ST_BYTECODE_VERSION;
+  h.header_size = sizeof(h);
+  h.source_crc32 = source_crc32;
+  h.instr_count = bc->instr_count;
+  h.instr_size = sizeof(st_bytecode_instr_t);
+  h.func_entry_size = sizeof(st_function_entry_t);
+  h.var_count = n;
+  h.exported_var_count = bc->exported_var_count;
+  h.func_user_count = funcs ? bc->func_registry->user_count : 0;
+  h.func_builtin_count = funcs ? bc->func_registry->builtin_count : 0;
+  memcpy(h.name, bc->name, sizeof(h.name));
+  h.name[sizeof(h.name) - 1] = '\0';
+  h.image_crc32 = st_crc32(out + sizeof(h), h.image_size - sizeof(h));
+  memcpy(out, &h, sizeof(h));
+  return h.image_size;
+}
+
+st_xip_result_t st_xip_check(const uint8_t *img, uint32_t avail, uint32_t source_crc32) {
+  if (avail < sizeof(st_xip_header_t)) return ST_XIP_EMPTY;
+  st_xip_header_t h;
+  memcpy(&h, img, sizeof(h));
+  if (h.magic != ST_XIP_MAGIC) return ST_XIP_EMPTY;
+  if (h.version != ST_BYTECODE_VERSION || h.header_size != sizeof(h) ||
+      h.instr_size != sizeof(st_bytecode_instr_t) ||
+      h.func_entry_size != sizeof(st_function_entry_t)) {
+    return ST_XIP_VERSION;
+  }
+  if (h.source_crc32 != source_crc32) return ST_XIP_SOURCE;
+
+  uint32_t instr_off, vars_off, funcs_off, size;
+  uint8_t funcs = (uint8_t)(h.func_user_count + h.func_builtin_count);
+  layout(h.instr_count, h.var_count, funcs, &instr_off, &vars_off, &funcs_off, &size);
+  if (h.instr_count == 0 || h.instr_count > 4096 || h.var_count > 32 ||
+      h.exported_var_count > h.var_count || funcs > 32 ||
+      h.image_size != size || size > avail || h.instr_offset != instr_off ||
+      h.vars_offset != vars_off || h.funcs_offset != funcs_off) {
+    return ST_XIP_CORRUPT;
+  }
+  if (st_crc32(img + sizeof(h), size - sizeof(h)) != h.image_crc32) return ST_XIP_CORRUPT;
+  return ST_XIP_OK;
+}
+
+uint8_t st_xip_func_count(const uint8_t *img) {
+  const st_xip_header_t *h = (const st_xip_header_t *)img;
+  return (uint8_t)(h->func_user_count + h->func_builtin_count);
+}
+
+void st_xip_attach(const uint8_t *img, st_bytecode_program_t *bc, st_function_registry_t *reg) {
+  st_xip_header_t h;
+  memcpy(&h, img, sizeof(h));
+
+  bc->instructions = (st_bytecode_instr_t *)(img + h.instr_offset);
+  bc->instr_count = h.instr_count;
+  bc->instr_capacity = h.instr_count;
+  bc->instr_in_flash = 1;
+
+  uint8_t n = h.var_count;
+  const uint8_t *v = img + h.vars_offset;
+  memcpy(bc->var_names, v, (size_t)n * 16);
+  for (uint8_t i = 0; i < n; i++) {
+    bc->var_types[i] = (st_datatype_t)v[n * 16 + i];
+    bc->var_export_flags[i] = v[n * 17 + i];
+  }
+  uint32_t initial_off = align_up(h.vars_offset + (uint32_t)n * XIP_VAR_BYTES, 4);
+  memcpy(bc->var_initial, img + initial_off, (size_t)n * sizeof(st_value_t));
+  memcpy(bc->variables, bc->var_initial, (size_t)n * sizeof(st_value_t));
+  bc->var_count = n;
+  bc->exported_var_count = h.exported_var_count;
+  memcpy(bc->name, h.name, sizeof(bc->name));
+
+  bc->func_registry = NULL;
+  uint8_t funcs = (uint8_t)(h.func_user_count + h.func_builtin_count);
+  if (reg && funcs) {
+    memset(reg, 0, sizeof(*reg));
+    memcpy(reg->functions, img + h.funcs_offset, (size_t)funcs * sizeof(st_function_entry_t));
+    reg->user_count = h.func_user_count;
+    reg->builtin_count = h.func_builtin_count;
+    bc->func_registry = reg;
+  }
+}
+
+bool st_xip_write(const StxFlashOps *ops, uint32_t slot_addr, uint32_t slot_size,
+                  const uint8_t *img, uint32_t len) {
+  if (len < sizeof(st_xip_header_t) || len > slot_size) return false;
+  uint32_t used = align_up(len, ops->sector_size);
+  for (uint32_t a = 0; a < used; a += ops->sector_size) {
+    if (!ops->erase(ops->ctx, slot_addr + a)) return false;
+  }
+  // Body first: until the header is programmed the slot reads as empty
+  if (!ops->write(ops->ctx, slot_addr + sizeof(st_xip_header_t), img + sizeof(st_xip_header_t),
+                  len - sizeof(st_xip_header_t))) {
+    return false;
+  }
+  return ops->write(ops->ctx, slot_addr, img, sizeof(st_xip_header_t));
+}
+
+const char *st_xip_result_name(st_xip_result_t r) {
+  switch (r) {
+    case ST_XIP_OK:      return "ok";
+    case ST_XIP_EMPTY:   return "empty";
+    case ST_XIP_VERSION: return "version";
+    case ST_XIP_SOURCE:  return "source changed";
+    case ST_XIP_CORRUPT: return "corrupt";
+    default:             return "?";
+  }
+}
@@ -97,6 +97,7 @@ void timer_config_sanitize(TimerConfig* cfg) {
   cfg->phase2_output_state = (cfg->phase2_output_state ? 1 : 0);
   cfg->phase3_output_state = (cfg->phase3_output_state ? 1 : 0);
   cfg->trigger_level = (cfg->trigger_level ? 1 : 0);
+  if (cfg->time_base > TIMER_TIME_BASE_US) cfg->time_base = TIMER_TIME_BASE_MS;
 }
 
 /* ============================================================================
@@ -5,140 +5,205 @@
  * Ported from: Mega2560 v3.6.5 modbus_timers.cpp
  * Adapted to: ESP32 modular architecture
  *
- * Minimal implementation matching types.h TimerConfig
+ * v7.9.8.9: Phase changes run from a per-timer esp_timer callback at the
+ * phase deadline (timer_sched). The callback sets the output coil and, when
+ * the coil is mapped to a GPIO pin, writes the pin directly, so output edges
+ * no longer depend on main loop latency. The loop only handles control
+ * registers, Mode 4 edge polling and idle output levels.
  */
 
 #include "timer_engine.h"
 #include "timer_config.h"
+#include "timer_sched.h"
 #include "registers.h"
+#include "config_struct.h"
+#include "gpio_driver.h"
 #include "debug.h"
 #include "constants.h"
 #include "types.h"
 #include <string.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 /* ============================================================================
  * TIMER RUNTIME STATE (per timer)
  * ============================================================================ */
 
 typedef struct {
-  uint32_t phase_start_ms;
   uint8_t current_phase;
   uint8_t is_active;
+  uint8_t out_pin;              // GPIO driven directly with output_coil (0xFF = none)
+  TimerSchedPlan plan;
+  TimerSchedState sched;
+  esp_timer_handle_t hrt;       // Phase deadline timer (NULL = polled from loop)
 } TimerRuntimeState;
 
-static TimerRuntimeState timer_state[TIMER_COUNT] = {0};
+static TimerRuntimeState timer_state[TIMER_COUNT];
+
+// Guards timer_state between the main loop and the esp_timer task
+static SemaphoreHandle_t timer_mutex = NULL;
+
+static inline void timer_lock(void) {
+  if (timer_mutex) xSemaphoreTake(timer_mutex, portMAX_DELAY);
+}
+
+static inline void timer_unlock(void) {
+  if (timer_mutex) xSemaphoreGive(timer_mutex);
+}
 
 /* ============================================================================
- * HELPER - SET COIL LEVEL
+ * HELPER - SET OUTPUT LEVEL
  * ============================================================================ */
 
-static void set_coil_level(uint16_t coil_idx, uint8_t high) {
-  if (coil_idx >= (COILS_SIZE * 8)) return;
-  registers_set_coil(coil_idx, high ? 1 : 0);
+static void set_output_level(TimerRuntimeState* state, const TimerConfig* cfg, uint8_t high) {
+  if (cfg->output_coil >= (COILS_SIZE * 8)) return;
+  registers_set_coil(cfg->output_coil, high ? 1 : 0);
+  if (state->out_pin != 0xFF) {
+    gpio_write(state->out_pin, high ? 1 : 0);
+  }
 }
 
-static uint8_t get_discrete_input_level(uint16_t input_idx) {
-  if (input_idx >= (DISCRETE_INPUTS_SIZE * 8)) return 0;
-  return registers_get_discrete_input(input_idx) ? 1 : 0;
+// GPIO output mapping for the timer's output coil, if it is a real pin
+static uint8_t resolve_output_pin(uint8_t id, const TimerConfig* cfg) {
+  for (uint8_t i = 0; i < g_persist_config.var_map_count; i++) {
+    const VariableMapping* map = &g_persist_config.var_maps[i];
+    if (map->source_type != MAPPING_SOURCE_GPIO || map->is_input) continue;
+    if (map->coil_reg != cfg->output_coil || map->gpio_pin >= 40) continue;
+    if (map->associated_counter != 0xff) continue;
+    if (map->associated_timer != 0xff && map->associated_timer != id) continue;
+    return map->gpio_pin;
+  }
+  return 0xFF;
 }
 
 /* ============================================================================
- * MODE 1: ONE-SHOT (3-phase sequence)
+ * PHASE PLAN (TimerConfig → timer_sched phases)
  * ============================================================================ */
 
-static void mode_one_shot(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
-  TimerRuntimeState* state = &timer_state[id - 1];
+static uint64_t duration_us(const TimerConfig* cfg, uint32_t value) {
+  return (cfg->time_base == TIMER_TIME_BASE_US) ? value : (uint64_t)value * 1000ULL;
+}
 
-  if (!state->is_active) return;
+static void build_plan(const TimerConfig* cfg, TimerSchedPlan* plan) {
+  memset(plan, 0, sizeof(*plan));
+  plan->end_level = TIMER_SCHED_LEAVE;
+
+  switch (cfg->mode) {
+    case TIMER_MODE_1_ONESHOT:
+      // P1(T1) → P2(T2) → P3(T3), output stays at P3
+      plan->phases = 3;
+      plan->level[0] = cfg->phase1_output_state;
+      plan->level[1] = cfg->phase2_output_state;
+      plan->level[2] = cfg->phase3_output_state;
+      plan->dur_us[0] = duration_us(cfg, cfg->phase1_duration_ms);
+      plan->dur_us[1] = duration_us(cfg, cfg->phase2_duration_ms);
+      plan->dur_us[2] = duration_us(cfg, cfg->phase3_duration_ms);
+      break;
 
-  switch (state->current_phase) {
-    case 0:
-      // Phase 1: set P1 level, start timing
-      set_coil_level(cfg->output_coil, cfg->phase1_output_state);
-      if (cfg->phase1_duration_ms == 0 || (now_ms - state->phase_start_ms >= cfg->phase1_duration_ms)) {
-        state->current_phase = 1;
-        state->phase_start_ms = now_ms;
-      }
+    case TIMER_MODE_2_MONOSTABLE:
+      // P2 pulse, then back to P1
+      plan->phases = 1;
+      plan->level[0] = cfg->phase2_output_state;
+      plan->end_level = cfg->phase1_output_state;
+      plan->dur_us[0] = duration_us(cfg, cfg->pulse_duration_ms);
       break;
 
-    case 1:
-      // Phase 2: set P2 level
-      set_coil_level(cfg->output_coil, cfg->phase2_output_state);
-      if (cfg->phase2_duration_ms == 0 || (now_ms - state->phase_start_ms >= cfg->phase2_duration_ms)) {
-        state->current_phase = 2;
-        state->phase_start_ms = now_ms;
+    case TIMER_MODE_3_ASTABLE:
+      // P1(on) ↔ P2(off)
+      plan->phases = 2;
+      plan->repeat = 1;
+      plan->level[0] = cfg->phase1_output_state;
+      plan->level[1] = cfg->phase2_output_state;
+      plan->dur_us[0] = duration_us(cfg, cfg->on_duration_ms);
+      plan->dur_us[1] = duration_us(cfg, cfg->off_duration_ms);
+      for (uint8_t p = 0; p < 2; p++) {
+        if (plan->dur_us[p] != 0 && plan->dur_us[p] < TIMER_HRT_MIN_US) {
+          plan->dur_us[p] = TIMER_HRT_MIN_US;
+        }
       }
       break;
 
-    case 2:
-      // Phase 3: set P3 level
-      set_coil_level(cfg->output_coil, cfg->phase3_output_state);
-      if (cfg->phase3_duration_ms == 0 || (now_ms - state->phase_start_ms >= cfg->phase3_duration_ms)) {
-        // Sequence complete
-        state->is_active = 0;
-        state->current_phase = 0;
-      }
+    case TIMER_MODE_4_INPUT_TRIGGERED:
+      // Output untouched during the delay, then latched at P1
+      plan->phases = 1;
+      plan->level[0] = TIMER_SCHED_LEAVE;
+      plan->end_level = cfg->phase1_output_state;
+      plan->dur_us[0] = duration_us(cfg, cfg->delay_ms);
       break;
 
     default:
-      state->is_active = 0;
-      state->current_phase = 0;
       break;
   }
 }
 
 /* ============================================================================
- * MODE 2: MONOSTABLE (retriggerable pulse)
+ * SCHEDULING (caller holds timer_mutex)
  * ============================================================================ */
 
-static void mode_monostable(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
+static void arm_deadline(TimerRuntimeState* state, int64_t now_us) {
+  if (state->hrt == NULL) return;
+  esp_timer_stop(state->hrt);
+  if (!state->sched.running) return;
+
+  int64_t wait_us = state->sched.deadline_us - now_us;
+  esp_timer_start_once(state->hrt, wait_us > 0 ? (uint64_t)wait_us : 1);
+}
+
+// Start (start=true) or advance the phase sequence, drive the output and
+// re-arm the deadline timer
+static void run_schedule(uint8_t id, const TimerConfig* cfg, int64_t now_us, bool start) {
   TimerRuntimeState* state = &timer_state[id - 1];
 
-  if (!state->is_active) {
-    // Not active: output at P1 level
-    set_coil_level(cfg->output_coil, cfg->phase1_output_state);
+  if (start) {
+    build_plan(cfg, &state->plan);
+    state->sched.level = TIMER_SCHED_LEAVE;
+    timer_sched_start(&state->plan, &state->sched, now_us);
+  } else if (timer_sched_expire(&state->plan, &state->sched, now_us) == 0) {
+    arm_deadline(state, now_us);  // Early wakeup
     return;
   }
 
-  // Active: start pulse
-  if (state->current_phase == 0) {
-    state->current_phase = 1;
-    state->phase_start_ms = now_ms;
-    set_coil_level(cfg->output_coil, cfg->phase2_output_state);
+  if (state->sched.level != TIMER_SCHED_LEAVE) {
+    set_output_level(state, cfg, state->sched.level);
   }
-  // Pulse ongoing: check if time expired
-  else if (state->current_phase == 1 && (now_ms - state->phase_start_ms >= cfg->pulse_duration_ms)) {
-    // Pulse complete: return to P1 level
-    set_coil_level(cfg->output_coil, cfg->phase1_output_state);
-    state->is_active = 0;
-    state->current_phase = 0;
+
+  // Map back to the phase/active values exposed via CLI/API
+  bool running = state->sched.running;
+  switch (cfg->mode) {
+    case TIMER_MODE_2_MONOSTABLE:
+      state->is_active = running;
+      state->current_phase = running ? 1 : 0;
+      break;
+    case TIMER_MODE_4_INPUT_TRIGGERED:
+      state->is_active = 1;                       // Latched after the delay
+      state->current_phase = running ? 0 : 1;
+      break;
+    default:
+      state->is_active = running;
+      state->current_phase = running ? state->sched.phase : 0;
+      break;
   }
-}
 
-/* ============================================================================
- * MODE 3: ASTABLE (oscillate between P1/P2)
- * ============================================================================ */
+  arm_deadline(state, now_us);
+}
 
-static void mode_astable(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
-  TimerRuntimeState* state = &timer_state[id - 1];
+static void stop_schedule(TimerRuntimeState* state) {
+  timer_sched_stop(&state->sched);
+  if (state->hrt) esp_timer_stop(state->hrt);
+  state->is_active = 0;
+  state->current_phase = 0;
+}
 
-  if (!state->is_active) return;  // Not running, stay silent
+static void timer_deadline_callback(void* arg) {
+  uint8_t id = (uint8_t)(uintptr_t)arg;
+  TimerConfig cfg;
 
-  if (state->current_phase == 0) {
-    // Phase 0: output P1, timing T1
-    set_coil_level(cfg->output_coil, cfg->phase1_output_state);
-    if (cfg->on_duration_ms == 0 || (now_ms - state->phase_start_ms >= cfg->on_duration_ms)) {
-      state->current_phase = 1;
-      state->phase_start_ms = now_ms;
-    }
-  } else {
-    // Phase 1: output P2, timing T2
-    set_coil_level(cfg->output_coil, cfg->phase2_output_state);
-    if (cfg->off_duration_ms == 0 || (now_ms - state->phase_start_ms >= cfg->off_duration_ms)) {
-      state->current_phase = 0;
-      state->phase_start_ms = now_ms;
-    }
+  timer_lock();
+  if (timer_config_get(id, &cfg) && cfg.enabled && timer_state[id - 1].sched.running) {
+    run_schedule(id, &cfg, esp_timer_get_time(), false);
   }
+  timer_unlock();
 }
 
 /* ============================================================================
@@ -149,7 +214,7 @@ static void mode_astable(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
 static uint8_t mode4_prev_input[TIMER_COUNT] = {0};
 static uint8_t mode4_initialized[TIMER_COUNT] = {0};
 
-static void mode_trigger(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
+static void mode_trigger(uint8_t id, TimerConfig* cfg, int64_t now_us) {
   TimerRuntimeState* state = &timer_state[id - 1];
 
   // For Mode 4: Read directly from a COIL as input trigger
@@ -172,7 +237,6 @@ static void mode_trigger(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
   // Detect edge
   uint8_t rising_edge = (prev_level == 0 && input_level == 1);
   uint8_t falling_edge = (prev_level == 1 && input_level == 0);
-  uint8_t any_edge = rising_edge || falling_edge;
 
   // Check if configured trigger matches detected edge
   uint8_t trigger_detected = 0;
@@ -182,36 +246,15 @@ static void mode_trigger(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
     trigger_detected = 1;  // Falling edge trigger
   }
 
-  if (trigger_detected) {
-    // Matching edge detected - set output immediately (or after delay)
-    if (cfg->delay_ms == 0) {
-      // Immediate: set output coil
-      set_coil_level(cfg->output_coil, cfg->phase1_output_state);
-      state->is_active = 1;
-      state->current_phase = 1;
-      state->phase_start_ms = now_ms;
-    } else {
-      // Delayed: wait delay_ms then set output
-      if (!state->is_active) {
-        state->is_active = 1;
-        state->current_phase = 0;
-        state->phase_start_ms = now_ms;
-      }
-    }
-  }
-
-  // Handle delayed output
-  if (state->is_active && cfg->delay_ms > 0 && state->current_phase == 0) {
-    if (now_ms - state->phase_start_ms >= cfg->delay_ms) {
-      // Delay expired - set output
-      set_coil_level(cfg->output_coil, cfg->phase1_output_state);
-      state->current_phase = 1;
-    }
+  // Immediate trigger sets the output now; a delayed one is not restarted
+  // while its delay is running or the output is latched
+  if (trigger_detected && (cfg->delay_ms == 0 || !state->is_active)) {
+    run_schedule(id, cfg, now_us, true);
   }
 
   // If not waiting for delay, keep output active
   if (state->is_active && state->current_phase == 1) {
-    set_coil_level(cfg->output_coil, cfg->phase1_output_state);
+    set_output_level(state, cfg, cfg->phase1_output_state);
   }
 }
 
@@ -221,7 +264,30 @@ static void mode_trigger(uint8_t id, TimerConfig* cfg, uint32_t now_ms) {
 
 void timer_engine_init(void) {
   timer_config_init();
-  memset(timer_state, 0, sizeof(timer_state));
+
+  if (timer_mutex == NULL) {
+    timer_mutex = xSemaphoreCreateMutex();
+  }
+
+  for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+    esp_timer_handle_t hrt = timer_state[i].hrt;
+    memset(&timer_state[i], 0, sizeof(timer_state[i]));
+    timer_state[i].out_pin = 0xFF;
+    timer_state[i].hrt = hrt;
+
+    if (hrt == NULL) {
+      esp_timer_create_args_t args = {};
+      args.callback = timer_deadline_callback;
+      args.arg = (void*)(uintptr_t)(i + 1);
+      args.dispatch_method = ESP_TIMER_TASK;
+      args.name = "timer_engine";
+      if (esp_timer_create(&args, &timer_state[i].hrt) != ESP_OK) {
+        // Falls back to polling the deadline from timer_engine_loop()
+        timer_state[i].hrt = NULL;
+        debug_printf("[TIMER] esp_timer create failed for timer %u, using loop timing\n", i + 1);
+      }
+    }
+  }
 }
 
 /* ============================================================================
@@ -237,12 +303,14 @@ void timer_engine_handle_control(uint8_t id) {
   }
 
   uint16_t ctrl_val = registers_get_holding_register(cfg.ctrl_reg);
+  if ((ctrl_val & 0x0007) == 0) return;
+
+  TimerRuntimeState* state = &timer_state[id - 1];
+  timer_lock();
 
   // Bit 0: Start command (triggers timer)
   if (ctrl_val & 0x0001) {
-    timer_state[id - 1].is_active = 1;
-    timer_state[id - 1].current_phase = 0;
-    timer_state[id - 1].phase_start_ms = registers_get_millis();
+    run_schedule(id, &cfg, esp_timer_get_time(), true);
 
     // Clear the start bit after executing
     registers_set_holding_register(cfg.ctrl_reg, ctrl_val & ~0x0001);
@@ -250,9 +318,8 @@ void timer_engine_handle_control(uint8_t id) {
 
   // Bit 1: Stop command
   if (ctrl_val & 0x0002) {
-    timer_state[id - 1].is_active = 0;
-    timer_state[id - 1].current_phase = 0;
-    set_coil_level(cfg.output_coil, 0);  // Turn off output when stopped
+    stop_schedule(state);
+    set_output_level(state, &cfg, 0);  // Turn off output when stopped
 
     // Clear the stop bit after executing
     registers_set_holding_register(cfg.ctrl_reg, ctrl_val & ~0x0002);
@@ -260,10 +327,8 @@ void timer_engine_handle_control(uint8_t id) {
 
   // Bit 2: Reset command (clears timer state)
   if (ctrl_val & 0x0004) {
-    timer_state[id - 1].is_active = 0;
-    timer_state[id - 1].current_phase = 0;
-    timer_state[id - 1].phase_start_ms = 0;
-    set_coil_level(cfg.output_coil, 0);  // Turn off output when reset
+    stop_schedule(state);
+    set_output_level(state, &cfg, 0);  // Turn off output when reset
 
     // For Mode 4, also reset edge detection
     if (cfg.mode == TIMER_MODE_4_INPUT_TRIGGERED) {
@@ -273,6 +338,8 @@ void timer_engine_handle_control(uint8_t id) {
     // Clear the reset bit after executing
     registers_set_holding_register(cfg.ctrl_reg, ctrl_val & ~0x0004);
   }
+
+  timer_unlock();
 }
 
 /* ============================================================================
@@ -280,7 +347,7 @@ void timer_engine_handle_control(uint8_t id) {
  * ============================================================================ */
 
 void timer_engine_loop(void) {
-  uint32_t now_ms = registers_get_millis();
+  int64_t now_us = esp_timer_get_time();
 
   for (uint8_t i = 0; i < TIMER_COUNT; i++) {
     TimerConfig cfg;
@@ -291,29 +358,34 @@ void timer_engine_loop(void) {
     // Handle control register commands (start/stop/reset)
     timer_engine_handle_control(i + 1);
 
-    // Run mode-specific state machine
-    switch (cfg.mode) {
-      case TIMER_MODE_1_ONESHOT:
-        if (timer_state[i].is_active) {
-          mode_one_shot(i + 1, &cfg, now_ms);
-        }
-        break;
+    TimerRuntimeState* state = &timer_state[i];
+    timer_lock();
 
-      case TIMER_MODE_2_MONOSTABLE:
-        mode_monostable(i + 1, &cfg, now_ms);
-        break;
+    // Mappings can change without reconfiguring the timer
+    state->out_pin = resolve_output_pin(i + 1, &cfg);
 
-      case TIMER_MODE_3_ASTABLE:
-        mode_astable(i + 1, &cfg, now_ms);
+    // No deadline timer: advance phases at loop rate
+    if (state->hrt == NULL && state->sched.running) {
+      run_schedule(i + 1, &cfg, now_us, false);
+    }
+
+    switch (cfg.mode) {
+      case TIMER_MODE_2_MONOSTABLE:
+        // Not active: output at P1 level
+        if (!state->is_active) {
+          set_output_level(state, &cfg, cfg.phase1_output_state);
+        }
         break;
 
       case TIMER_MODE_4_INPUT_TRIGGERED:
-        mode_trigger(i + 1, &cfg, now_ms);
+        mode_trigger(i + 1, &cfg, now_us);
         break;
 
       default:
         break;
     }
+
+    timer_unlock();
   }
 }
 
@@ -324,29 +396,33 @@ void timer_engine_loop(void) {
 bool timer_engine_configure(uint8_t id, const TimerConfig* cfg) {
   if (cfg == NULL) return false;
 
+  timer_lock();
+
   // Validate and set
   if (!timer_config_set(id, cfg)) {
+    timer_unlock();
     return false;
   }
 
   // Initialize runtime state
   if (id >= 1 && id <= TIMER_COUNT) {
-    timer_state[id - 1].is_active = 0;
-    timer_state[id - 1].current_phase = 0;
-    timer_state[id - 1].phase_start_ms = 0;
+    TimerConfig stored;
+    timer_config_get(id, &stored);
+    stop_schedule(&timer_state[id - 1]);
+    timer_state[id - 1].out_pin = resolve_output_pin(id, &stored);
 
     // Reset Mode 4 edge detection on reconfiguration
-    if (cfg->mode == TIMER_MODE_4_INPUT_TRIGGERED) {
+    if (stored.mode == TIMER_MODE_4_INPUT_TRIGGERED) {
       mode4_initialized[id - 1] = 0;  // Will re-initialize on next read
     }
 
     // Auto-start astable mode when enabled (continuous oscillation)
-    if (cfg->mode == TIMER_MODE_3_ASTABLE && cfg->enabled) {
-      timer_state[id - 1].is_active = 1;
-      timer_state[id - 1].phase_start_ms = registers_get_millis();
+    if (stored.mode == TIMER_MODE_3_ASTABLE && stored.enabled) {
+      run_schedule(id, &stored, esp_timer_get_time(), true);
     }
   }
 
+  timer_unlock();
   return true;
 }
 
@@ -361,13 +437,18 @@ bool timer_engine_get_runtime(uint8_t id, uint8_t* out_phase, uint8_t* out_activ
   return true;
 }
 
+uint32_t timer_engine_get_late_resyncs(uint8_t id) {
+  if (id < 1 || id > TIMER_COUNT) return 0;
+  return timer_state[id - 1].sched.late_resyncs;
+}
+
 /* ============================================================================
  * COIL WRITE CALLBACK
  * ============================================================================ */
 
 void timer_engine_on_coil_write(uint16_t coil_idx, uint8_t value) {
   (void)value;  // Value not used, just trigger on write
-  uint32_t now_ms = registers_get_millis();
+  int64_t now_us = esp_timer_get_time();
 
   for (uint8_t i = 0; i < TIMER_COUNT; i++) {
     TimerConfig cfg;
@@ -381,9 +462,9 @@ void timer_engine_on_coil_write(uint16_t coil_idx, uint8_t value) {
     if (cfg.mode == TIMER_MODE_3_ASTABLE && timer_state[i].is_active) continue;
 
     // Trigger this timer
-    timer_state[i].is_active = 1;
-    timer_state[i].current_phase = 0;
-    timer_state[i].phase_start_ms = now_ms;
+    timer_lock();
+    run_schedule(i + 1, &cfg, now_us, true);
+    timer_unlock();
   }
 }
 
@@ -404,15 +485,33 @@ bool timer_engine_has_coil(uint16_t coil_idx) {
   return false;
 }
 
+uint64_t timer_engine_owned_pin_mask(void) {
+  uint64_t mask = 0;
+  for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+    if (timer_state[i].out_pin == 0xFF) continue;
+    TimerConfig cfg;
+    if (!timer_config_get(i + 1, &cfg) || !cfg.enabled) continue;
+
+    // Monostable drives its idle level too; other modes only while running
+    if (timer_state[i].is_active || cfg.mode == TIMER_MODE_2_MONOSTABLE) {
+      mask |= 1ULL << timer_state[i].out_pin;
+    }
+  }
+
+  return mask;
+}
+
 void timer_engine_disable_all(void) {
+  timer_lock();
   for (uint8_t i = 0; i < TIMER_COUNT; i++) {
     TimerConfig cfg;
     if (!timer_config_get(i + 1, &cfg)) continue;
 
     cfg.enabled = 0;
     timer_config_set(i + 1, &cfg);
-    timer_state[i].is_active = 0;
+    stop_schedule(&timer_state[i]);
   }
+  timer_unlock();
 }
 
 void timer_engine_clear_alarms(void) {
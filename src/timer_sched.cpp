@@ -0,0 +1,74 @@
+/**
+ * @file timer_sched.cpp
+ * @brief Deadline-based phase sequencer for timer outputs (v7.9.8.9)
+ *
+ * LAYER 5: Feature Engines - Timer scheduling (pure logic)
+ */
+
+#include "timer_sched.h"
+
+// Enter phase p: its level becomes the output, its deadline follows the
+// previous one
+static void timer_sched_enter(const TimerSchedPlan *plan, TimerSchedState *s, uint8_t p)
+{
+  s->phase = p;
+  if (plan->level[p] != TIMER_SCHED_LEAVE) s->level = plan->level[p];
+  s->deadline_us += plan->dur_us[p];
+}
+
+static uint64_t timer_sched_period(const TimerSchedPlan *plan)
+{
+  uint64_t period = 0;
+  for (uint8_t p = 0; p < plan->phases; p++) period += plan->dur_us[p];
+  return period;
+}
+
+uint8_t timer_sched_start(const TimerSchedPlan *plan, TimerSchedState *s, int64_t now_us)
+{
+  s->running = 0;
+  if (plan->phases == 0 || plan->phases > TIMER_SCHED_MAX_PHASES) return 0;
+  // A repeating plan without any duration would spin
+  if (plan->repeat && timer_sched_period(plan) == 0) return 0;
+
+  s->deadline_us = now_us;
+  s->running = 1;
+  timer_sched_enter(plan, s, 0);
+  return timer_sched_expire(plan, s, now_us);
+}
+
+uint8_t timer_sched_expire(const TimerSchedPlan *plan, TimerSchedState *s, int64_t now_us)
+{
+  if (!s->running) return 0;
+
+  // More than a whole period behind (callback starved): drop the missed
+  // cycles and end the current phase now instead of bursting through them
+  if (plan->repeat) {
+    uint64_t period = timer_sched_period(plan);
+    if (now_us - s->deadline_us > (int64_t)period) {
+      s->deadline_us = now_us;
+      s->late_resyncs++;
+    }
+  }
+
+  uint8_t steps = 0;
+  while (s->running && s->deadline_us <= now_us) {
+    uint8_t next = s->phase + 1;
+    if (next >= plan->phases) {
+      if (!plan->repeat) {
+        s->phase = plan->phases;
+        s->running = 0;
+        if (plan->end_level != TIMER_SCHED_LEAVE) s->level = plan->end_level;
+        return steps + 1;
+      }
+      next = 0;
+    }
+    timer_sched_enter(plan, s, next);
+    steps++;
+  }
+  return steps;
+}
+
+void timer_sched_stop(TimerSchedState *s)
+{
+  s->running = 0;
+}
@@ -0,0 +1,303 @@
+/**
+ * @file warm_retain.cpp
+ * @brief Warm-restart retention of runtime state (v7.9.10.2)
+ *
+ * LAYER 4: Register Persistence - Warm restart retention
+ * The area is a plain no-init DRAM buffer (RTC slow memory is too small
+ * for the registers alone). A snapshot is ~1.1 KB plus the ST programs;
+ * written every 100 ms it costs a few hundred µs of memcpy and ROM CRC.
+ */
+
+#include "warm_retain.h"
+#include "retain_store.h"
+#include "constants.h"
+#include "registers.h"
+#include "counter_engine.h"
+#include "st_logic_config.h"
+#include "st_logic_engine.h"
+#include "st_stateful.h"
+#include "st_types.h"
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_rom_crc.h>
+#include <string.h>
+
+// Section types
+#define WR_SEC_HOLDING    1
+#define WR_SEC_INPUT      2
+#define WR_SEC_COILS      3
+#define WR_SEC_COUNTERS   4
+#define WR_SEC_PROGRAM    5   // id = program slot
+
+#define WR_FORMAT         1   // Bump when a section payload changes
+
+// Head of a WR_SEC_PROGRAM section; arrays follow in this order
+typedef struct {
+  uint32_t fingerprint;       // program_fingerprint() of the writer
+  uint8_t  var_count;         // st_value_t[var_count]
+  uint8_t  edges;             // st_edge_instance_t[edges]
+  uint8_t  counters;          // st_counter_instance_t[counters]
+  uint8_t  latches;           // st_latch_instance_t[latches]
+  uint8_t  hysteresis;        // st_hysteresis_instance_t[hysteresis]
+  uint8_t  filters;           // st_filter_instance_t[filters]
+  uint8_t  fb_count;          // st_fb_instance_t[fb_count]
+  uint8_t  reserved;
+} WrProgramHeader;
+
+static __NOINIT_ATTR uint8_t wr_area[WARM_RETAIN_AREA_SIZE] __attribute__((aligned(4)));
+
+// Crash streak, kept beside the area (garbage after power-on, hence the magic)
+#define WR_GUARD_MAGIC    0x57524347u   // "WRCG"
+typedef struct {
+  uint32_t magic;
+  uint32_t streak;            // Panic/WDT restores since the last stable run
+} WrCrashGuard;
+static __NOINIT_ATTR WrCrashGuard wr_guard;
+static RetainStore wr_store;
+static WarmRetainStats wr_stats;
+static bool wr_running = false;
+static uint32_t wr_last_ms = 0;
+
+/* ============================================================================
+ * LAYOUT
+ * ============================================================================ */
+
+// Any change of a retained struct makes old snapshots unreadable
+static uint32_t layout_fingerprint(void) {
+  const uint32_t sizes[] = {
+    WR_FORMAT, HOLDING_REGS_SIZE, INPUT_REGS_SIZE, COILS_SIZE,
+    sizeof(st_value_t), sizeof(st_edge_instance_t), sizeof(st_counter_instance_t),
+    sizeof(st_latch_instance_t), sizeof(st_hysteresis_instance_t),
+    sizeof(st_filter_instance_t), sizeof(st_fb_instance_t), sizeof(WrProgramHeader),
+  };
+  return esp_rom_crc32_le(0, (const uint8_t *)sizes, sizeof(sizes));
+}
+
+// Variables and instance counts of a compiled program: state only goes
+// back into the same program
+static uint32_t program_fingerprint(const st_bytecode_program_t *bc, const WrProgramHeader *h) {
+  uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)h + sizeof(h->fingerprint),
+                                  sizeof(*h) - sizeof(h->fingerprint));
+  crc = esp_rom_crc32_le(crc, (const uint8_t *)bc->var_names, bc->var_count * sizeof(bc->var_names[0]));
+  crc = esp_rom_crc32_le(crc, (const uint8_t *)bc->var_types, bc->var_count * sizeof(bc->var_types[0]));
+  return esp_rom_crc32_le(crc, (const uint8_t *)&bc->instr_count, sizeof(bc->instr_count));
+}
+
+static void program_header(const st_bytecode_program_t *bc, WrProgramHeader *h) {
+  memset(h, 0, sizeof(*h));
+  h->var_count = bc->var_count;
+  const st_stateful_storage_t *sf = (const st_stateful_storage_t *)bc->stateful;
+  if (sf && sf->initialized) {
+    h->edges = sf->edge_count;
+    h->counters = sf->counter_count;
+    h->latches = sf->latch_count;
+    h->hysteresis = sf->hysteresis_count;
+    h->filters = sf->filter_count;
+  }
+  const st_function_registry_t *reg = (const st_function_registry_t *)bc->func_registry;
+  if (reg) h->fb_count = reg->fb_instance_count < ST_MAX_FB_INSTANCES ? reg->fb_instance_count : ST_MAX_FB_INSTANCES;
+  h->fingerprint = program_fingerprint(bc, h);
+}
+
+static uint32_t program_payload_size(const WrProgramHeader *h) {
+  return sizeof(*h) + h->var_count * sizeof(st_value_t) +
+         h->edges * sizeof(st_edge_instance_t) + h->counters * sizeof(st_counter_instance_t) +
+         h->latches * sizeof(st_latch_instance_t) + h->hysteresis * sizeof(st_hysteresis_instance_t) +
+         h->filters * sizeof(st_filter_instance_t) + h->fb_count * sizeof(st_fb_instance_t);
+}
+
+// Copy between the program and a section payload (to_program selects the direction)
+static void program_copy(st_bytecode_program_t *bc, const WrProgramHeader *h, uint8_t *p, bool to_program) {
+  st_stateful_storage_t *sf = (st_stateful_storage_t *)bc->stateful;
+  st_function_registry_t *reg = (st_function_registry_t *)bc->func_registry;
+  struct { void *mem; uint32_t len; } parts[] = {
+    { bc->variables,                   h->var_count * (uint32_t)sizeof(st_value_t) },
+    { sf ? sf->edges : NULL,           h->edges * (uint32_t)sizeof(st_edge_instance_t) },
+    { sf ? sf->counters : NULL,        h->counters * (uint32_t)sizeof(st_counter_instance_t) },
+    { sf ? sf->latches : NULL,         h->latches * (uint32_t)sizeof(st_latch_instance_t) },
+    { sf ? sf->hysteresis : NULL,      h->hysteresis * (uint32_t)sizeof(st_hysteresis_instance_t) },
+    { sf ? sf->filters : NULL,         h->filters * (uint32_t)sizeof(st_filter_instance_t) },
+    { reg ? reg->fb_instances : NULL,  h->fb_count * (uint32_t)sizeof(st_fb_instance_t) },
+  };
+  p += sizeof(*h);
+  for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+    if (!parts[i].len) continue;
+    if (to_program) memcpy(parts[i].mem, p, parts[i].len);
+    else memcpy(p, parts[i].mem, parts[i].len);
+    p += parts[i].len;
+  }
+}
+
+/* ============================================================================
+ * SNAPSHOT
+ * ============================================================================ */
+
+static void snapshot_program(st_logic_engine_state_t *st, uint8_t id) {
+  st_logic_program_config_t *prog = &st->programs[id];
+  if (!prog->compiled) return;
+
+  WrProgramHeader h;
+  program_header(&prog->bytecode, &h);
+  uint8_t *p = rs_section(&wr_store, WR_SEC_PROGRAM, id, (uint16_t)program_payload_size(&h));
+  if (!p) return;
+  memcpy(p, &h, sizeof(h));
+  st_logic_lock_variables();
+  program_copy(&prog->bytecode, &h, p, false);
+  st_logic_unlock_variables();
+}
+
+void warm_retain_snapshot(void) {
+  if (!wr_running) return;
+  uint32_t t0 = (uint32_t)micros();
+
+  rs_begin(&wr_store);
+  uint8_t *p = rs_section(&wr_store, WR_SEC_HOLDING, 0, HOLDING_REGS_SIZE * sizeof(uint16_t));
+  if (p) memcpy(p, registers_get_holding_regs(), HOLDING_REGS_SIZE * sizeof(uint16_t));
+  p = rs_section(&wr_store, WR_SEC_INPUT, 0, INPUT_REGS_SIZE * sizeof(uint16_t));
+  if (p) memcpy(p, registers_get_input_regs(), INPUT_REGS_SIZE * sizeof(uint16_t));
+  p = rs_section(&wr_store, WR_SEC_COILS, 0, COILS_SIZE);
+  if (p) memcpy(p, registers_get_coils(), COILS_SIZE);
+
+  uint64_t counters[4];
+  for (uint8_t i = 0; i < 4; i++) counters[i] = counter_engine_get_value(i + 1);
+  p = rs_section(&wr_store, WR_SEC_COUNTERS, 0, sizeof(counters));
+  if (p) memcpy(p, counters, sizeof(counters));
+
+  st_logic_engine_state_t *st = st_logic_get_state();
+  if (st) {
+    for (uint8_t i = 0; i < ST_LOGIC_MAX_PROGRAMS; i++) snapshot_program(st, i);
+  }
+
+  wr_stats.snapshot_bytes = rs_commit(&wr_store);
+  wr_stats.dropped = wr_store.dropped;
+  wr_stats.snapshots++;
+  wr_stats.snapshot_us = (uint32_t)micros() - t0;
+  if (wr_stats.snapshot_us > wr_stats.snapshot_max_us) wr_stats.snapshot_max_us = wr_stats.snapshot_us;
+}
+
+void warm_retain_loop(void) {
+  uint32_t now = millis();
+  if (wr_guard.streak && now >= WARM_RETAIN_STABLE_MS) wr_guard.streak = 0;  // Survived: not a loop
+  if (now - wr_last_ms < WARM_RETAIN_INTERVAL_MS) return;
+  wr_last_ms = now;
+  warm_retain_snapshot();
+}
+
+/* ============================================================================
+ * RESTORE
+ * ============================================================================ */
+
+// Reset kinds that keep DRAM contents
+static bool reset_is_warm(esp_reset_reason_t reason) {
+  switch (reason) {
+    case ESP_RST_SW:        // esp_restart(): CLI reboot, OTA
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Warm resets the firmware did not ask for
+static bool reset_is_crash(esp_reset_reason_t reason) {
+  return reason != ESP_RST_SW && reset_is_warm(reason);
+}
+
+static void restore_program(st_logic_engine_state_t *st, uint8_t id, const uint8_t *payload, uint16_t len) {
+  if (id >= ST_LOGIC_MAX_PROGRAMS || len < sizeof(WrProgramHeader)) return;
+  st_logic_program_config_t *prog = &st->programs[id];
+
+  WrProgramHeader saved, now;
+  memcpy(&saved, payload, sizeof(saved));
+  if (!prog->compiled) {
+    wr_stats.programs_skipped++;
+    return;
+  }
+  program_header(&prog->bytecode, &now);
+  if (memcmp(&saved, &now, sizeof(now)) != 0 || program_payload_size(&now) != len) {
+    wr_stats.programs_skipped++;
+    return;
+  }
+  st_logic_lock_variables();
+  program_copy(&prog->bytecode, &now, (uint8_t *)payload, true);
+  st_logic_unlock_variables();
+  wr_stats.programs++;
+}
+
+bool warm_retain_restore(void) {
+  uint32_t t0 = (uint32_t)micros();
+  memset(&wr_stats, 0, sizeof(wr_stats));
+  rs_init(&wr_store, wr_area, sizeof(wr_area), layout_fingerprint(), esp_rom_crc32_le);
+  esp_reset_reason_t reason = esp_reset_reason();
+  wr_stats.warm = reset_is_warm(reason);
+  wr_running = true;
+
+  if (wr_guard.magic != WR_GUARD_MAGIC || !wr_stats.warm) {
+    wr_guard.magic = WR_GUARD_MAGIC;
+    wr_guard.streak = 0;
+  }
+
+  uint32_t len = 0;
+  const uint8_t *data = wr_stats.warm ? rs_latest(&wr_store, &len, &wr_stats.snapshot_seq) : NULL;
+  if (data && reset_is_crash(reason)) {
+    if (wr_guard.streak < 0xFF) wr_guard.streak++;
+    wr_stats.crash_streak = (uint8_t)wr_guard.streak;
+    if (wr_guard.streak > WARM_RETAIN_CRASH_MAX) {
+      // The retained state may be what crashes: start from NVS instead
+      wr_stats.crash_skipped = true;
+      data = NULL;
+    }
+  } else {
+    wr_guard.streak = 0;  // Deliberate restart or nothing to restore
+  }
+  if (!data) {
+    // Power-on garbage, a snapshot from before a cold start or a crash loop: never restore it
+    rs_clear(&wr_store);
+    return false;
+  }
+
+  st_logic_engine_state_t *st = st_logic_get_state();
+  uint32_t pos = 0;
+  RsSection sec;
+  const uint8_t *payload;
+  while (rs_next(data, len, &pos, &sec, &payload)) {
+    switch (sec.type) {
+      case WR_SEC_HOLDING:
+        if (sec.len == HOLDING_REGS_SIZE * sizeof(uint16_t)) memcpy(registers_get_holding_regs(), payload, sec.len);
+        break;
+      case WR_SEC_INPUT:
+        if (sec.len == INPUT_REGS_SIZE * sizeof(uint16_t)) memcpy(registers_get_input_regs(), payload, sec.len);
+        break;
+      case WR_SEC_COILS:
+        if (sec.len == COILS_SIZE) memcpy(registers_get_coils(), payload, sec.len);
+        break;
+      case WR_SEC_COUNTERS:
+        if (sec.len == 4 * sizeof(uint64_t)) {
+          for (uint8_t i = 0; i < 4; i++) {
+            uint64_t v;
+            memcpy(&v, payload + i * sizeof(v), sizeof(v));
+            counter_engine_set_value(i + 1, v);  // No-op for unconfigured counters
+          }
+        }
+        break;
+      case WR_SEC_PROGRAM:
+        if (st) restore_program(st, sec.id, payload, sec.len);
+        break;
+      default:
+        break;
+    }
+  }
+
+  wr_stats.restored = true;
+  wr_stats.restore_bytes = len;
+  wr_stats.restore_us = (uint32_t)micros() - t0;
+  return true;
+}
+
+const WarmRetainStats *warm_retain_get_stats(void) {
+  return &wr_stats;
+}
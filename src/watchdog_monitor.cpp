@@ -220,6 +220,11 @@ void watchdog_record_error(const char* error_msg) {
   watchdog_save_state();
 }
 
+void watchdog_record_boot_ready(uint32_t ready_us) {
+  g_watchdog_state.boot_ready_us = ready_us;
+  watchdog_save_state();
+}
+
 /* ============================================================================
  * PUBLIC API - NVS PERSISTENCE
  * ============================================================================ */
@@ -0,0 +1,46 @@
+/**
+ * @file web_assets.cpp
+ * @brief Serve precompressed web pages with ETag revalidation (v7.9.8.1)
+ *
+ * LAYER 7: User Interface - Web pages
+ * Page data itself lives in the generated web_assets_gz.cpp.
+ */
+
+#include <string.h>
+#include <esp_http_server.h>
+#include <Arduino.h>
+#include "web_assets.h"
+
+int web_asset_header_match(httpd_req_t *req, const char *field, const char *token)
+{
+  char hdr[160];
+  size_t len = httpd_req_get_hdr_value_len(req, field);
+  if (len == 0 || len >= sizeof(hdr)) return -1;
+  if (httpd_req_get_hdr_value_str(req, field, hdr, sizeof(hdr)) != ESP_OK) return -1;
+  return strstr(hdr, token) != NULL ? 1 : 0;
+}
+
+esp_err_t web_asset_send(httpd_req_t *req, const WebAsset *asset)
+{
+  // Cache-Control: no-cache = browser may keep the page but must revalidate,
+  // so a firmware update is picked up on the next load via the ETag.
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  httpd_resp_set_hdr(req, "ETag", asset->etag);
+
+  if (web_asset_header_match(req, "If-None-Match", asset->etag) == 1) {
+    httpd_resp_set_status(req, "304 Not Modified");
+    return httpd_resp_send(req, NULL, 0);
+  }
+
+  // No Accept-Encoding header means any coding is acceptable (RFC 9110)
+  if (web_asset_header_match(req, "Accept-Encoding", "gzip") == 0) {
+    httpd_resp_set_status(req, "406 Not Acceptable");
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_sendstr(req, "gzip required (use a browser or curl --compressed)\n");
+  }
+
+  httpd_resp_set_type(req, "text/html");
+  httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+  return httpd_resp_send(req, (const char *)asset->gz_data, asset->gz_len);
+}
@@ -7,11 +7,14 @@
  * Uses /api/cli endpoint for command execution.
  *
  * RAM impact: ~0 bytes runtime (HTML stored in flash/PROGMEM only)
+ * The page literal below is the source for scripts/generate_web_assets.py;
+ * the firmware serves the gzipped copy (web_assets_gz.cpp) - FEAT-150.
  */
 
 #include <esp_http_server.h>
 #include <Arduino.h>
 #include "web_cli.h"
+#include "web_assets.h"
 #include "debug.h"
 
 static const char PROGMEM cli_html[] = R"rawhtml(<!DOCTYPE html>
@@ -140,8 +143,9 @@ async function doLogin(){
   const p=document.getElementById('authPass').value;
   AUTH='Basic '+btoa(u+':'+p);
   try{
-    const r=await fetch('/api/status',{headers:{'Authorization':AUTH}});
+    const r=await fetch('/api/auth/login',{method:'POST',headers:{'Authorization':AUTH}});
     if(r.ok){
+      AUTH='Bearer '+(await r.json()).token;
       sessionStorage.setItem('hfplc_auth',AUTH);
       document.getElementById('loginModal').classList.remove('show');
       init();
@@ -218,7 +222,7 @@ if(d.authenticated){document.getElementById('userName').textContent=d.username;d
 else{document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('umLogout').style.display='none'}
 }).catch(function(){})
 }
-function doLogout(){sessionStorage.removeItem('hfplc_auth');AUTH='';document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('userMenu').classList.remove('show');if(document.getElementById('loginModal'))document.getElementById('loginModal').classList.add('show')}
+function doLogout(){if(AUTH.indexOf('Bearer ')===0)fetch('/api/auth/logout',{method:'POST',headers:{'Authorization':AUTH}}).catch(()=>{});sessionStorage.removeItem('hfplc_auth');AUTH='';document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('userMenu').classList.remove('show');if(document.getElementById('loginModal'))document.getElementById('loginModal').classList.add('show')}
 async function doGlobalSave(){var btn=document.getElementById('saveBtn');btn.classList.add('saving');btn.textContent='\u23F3 Gemmer...';try{var h={method:'POST'};if(AUTH)h.headers={'Authorization':AUTH};var r=await fetch('/api/system/save',h);if(r.ok){btn.classList.remove('saving');btn.classList.add('saved');btn.textContent='\u2705 Gemt!';}else{btn.classList.remove('saving');btn.classList.add('save-err');btn.textContent='\u274C Fejl';}}catch(e){btn.classList.remove('saving');btn.classList.add('save-err');btn.textContent='\u274C Fejl';}setTimeout(()=>{btn.className='save-btn';btn.innerHTML='&#128190; Save';},2000);}
 updateUserBadge();
 </script>
@@ -231,7 +235,5 @@ updateUserBadge();
 
 esp_err_t web_cli_handler(httpd_req_t *req)
 {
-  httpd_resp_set_type(req, "text/html");
-  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-  return httpd_resp_send(req, cli_html, strlen(cli_html));
+  return web_asset_send(req, &web_asset_cli);
 }
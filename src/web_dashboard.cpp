@@ -8,11 +8,14 @@
  *
  * Features: Live metrics, history graphs, alarms, register viewer, register map
  * RAM impact: ~0 bytes runtime (HTML stored in flash/PROGMEM only)
+ * The page literal below is the source for scripts/generate_web_assets.py;
+ * the firmware serves the gzipped copy (web_assets_gz.cpp) - FEAT-150.
  */
 
 #include <esp_http_server.h>
 #include <Arduino.h>
 #include "web_dashboard.h"
+#include "web_assets.h"
 #include "debug.h"
 
 static const char PROGMEM dashboard_html[] = R"rawhtml(<!DOCTYPE html>
@@ -1946,12 +1949,12 @@ function doLogin(){
 var u=document.getElementById('authUser').value;
 var p=document.getElementById('authPass').value;
 var auth='Basic '+btoa(u+':'+p);
-fetch('/api/user/me',{headers:{'Authorization':auth}}).then(function(r){return r.json()}).then(function(d){
-if(d.authenticated){sessionStorage.setItem('hfplc_auth',auth);document.getElementById('loginModal').classList.remove('show');updateUserBadge()}
+fetch('/api/auth/login',{method:'POST',headers:{'Authorization':auth}}).then(function(r){return r.json()}).then(function(d){
+if(d.token){sessionStorage.setItem('hfplc_auth','Bearer '+d.token);document.getElementById('loginModal').classList.remove('show');updateUserBadge()}
 else{document.getElementById('loginErr').style.display='block';document.getElementById('loginErr').textContent='Forkert brugernavn eller adgangskode'}
 }).catch(function(){document.getElementById('loginErr').style.display='block';document.getElementById('loginErr').textContent='Forbindelsesfejl'})
 }
-function doLogout(){sessionStorage.removeItem('hfplc_auth');document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('umLogout').style.display='none';document.getElementById('umLogin').style.display='block';document.getElementById('userMenu').classList.remove('show')}
+function doLogout(){var a=sessionStorage.getItem('hfplc_auth');if(a&&a.indexOf('Bearer ')===0)fetch('/api/auth/logout',{method:'POST',headers:{'Authorization':a}}).catch(function(){});sessionStorage.removeItem('hfplc_auth');document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('umLogout').style.display='none';document.getElementById('umLogin').style.display='block';document.getElementById('userMenu').classList.remove('show')}
 document.getElementById('authPass').addEventListener('keydown',function(e){if(e.key==='Enter')doLogin()});
 document.getElementById('authUser').addEventListener('keydown',function(e){if(e.key==='Enter')document.getElementById('authPass').focus()});
 async function doSystemSave(){
@@ -1978,7 +1981,5 @@ updateUserBadge();
 
 esp_err_t web_dashboard_handler(httpd_req_t *req)
 {
-  httpd_resp_set_type(req, "text/html");
-  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-  return httpd_resp_send(req, dashboard_html, strlen(dashboard_html));
+  return web_asset_send(req, &web_asset_dashboard);
 }
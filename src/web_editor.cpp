@@ -7,6 +7,8 @@
  * All program operations use existing /api/logic/* REST endpoints.
  *
  * RAM impact: ~0 bytes runtime (HTML stored in flash/PROGMEM only)
+ * The page literal below is the source for scripts/generate_web_assets.py;
+ * the firmware serves the gzipped copy (web_assets_gz.cpp) - FEAT-150.
  *
  * Panels: Editor, Bindings, Monitor, CLI Console
  * Features: Syntax highlighting, Auto-complete, Sparklines, Step debug, Backup
@@ -15,6 +17,7 @@
 #include <esp_http_server.h>
 #include <Arduino.h>
 #include "web_editor.h"
+#include "web_assets.h"
 #include "debug.h"
 
 static const char PROGMEM editor_html[] = R"rawhtml(<!DOCTYPE html>
@@ -275,7 +278,12 @@ CNT_SETUP_CMP(id,mode,val,src,ror)
 CNT_ENABLE(id,on_off)
 CNT_CTRL(id,cmd) 0=rst 1=start 2=stop
 CNT_VALUE(id) CNT_RAW(id)
-CNT_FREQ(id) CNT_STATUS(id)</code>
+CNT_FREQ(id) CNT_STATUS(id)
+CNT_EDGES(id) edge interval µs
+CNT_POS(id) CNT_VEL(id) encoder</code>
+<h3>Interrupt Inputs</h3>
+<code class="fn">DI_CAUGHT(pin) edge seen (clears)
+DI_PULSE(pin) high pulse µs</code>
 <h3>Modbus I/O</h3>
 <code class="fn">hr[addr] — Holding Register
 ir[addr] — Input Register
@@ -402,7 +410,7 @@ let sseConn=null; // FEAT-130: SSE connection for editor monitor
 
 // === ST Syntax Keywords ===
 const ST_KW=['PROGRAM','END_PROGRAM','FUNCTION','FUNCTION_BLOCK','END_FUNCTION','END_FUNCTION_BLOCK','VAR','VAR_INPUT','VAR_OUTPUT','END_VAR','VAR_GLOBAL','BEGIN','END','IF','THEN','ELSIF','ELSE','END_IF','CASE','OF','END_CASE','FOR','TO','BY','DO','END_FOR','WHILE','END_WHILE','REPEAT','UNTIL','END_REPEAT','RETURN','EXIT','TRUE','FALSE','NOT','AND','OR','XOR','MOD','EXPORT'];
-const ST_FN=['ABS','MIN','MAX','LIMIT','SCALE','SQRT','EXPT','LN','LOG','SEL','MUX','MOVE','HYSTERESIS','CLAMP','BIT_SET','BIT_CLR','BIT_TST','TON','TOF','TP','CTU','CTD','CTUD','SR','RS','R_TRIG','F_TRIG','SHL','SHR','ROL','ROR','MB_READ_HOLDING','MB_READ_INPUT','MB_READ_COIL','MB_READ_INPUT_REG','MB_WRITE_HOLDING','MB_WRITE_COIL','MB_SUCCESS','MB_BUSY','MB_ERROR','CNT_SETUP','CNT_SETUP_ADV','CNT_SETUP_CMP','CNT_ENABLE','CNT_CTRL','CNT_VALUE','CNT_RAW','CNT_FREQ','CNT_STATUS'];
+const ST_FN=['ABS','MIN','MAX','LIMIT','SCALE','SQRT','EXPT','LN','LOG','SEL','MUX','MOVE','HYSTERESIS','CLAMP','BIT_SET','BIT_CLR','BIT_TST','TON','TOF','TP','CTU','CTD','CTUD','SR','RS','R_TRIG','F_TRIG','SHL','SHR','ROL','ROR','MB_READ_HOLDING','MB_READ_INPUT','MB_READ_COIL','MB_READ_INPUT_REG','MB_WRITE_HOLDING','MB_WRITE_COIL','MB_SUCCESS','MB_BUSY','MB_ERROR','CNT_SETUP','CNT_SETUP_ADV','CNT_SETUP_CMP','CNT_ENABLE','CNT_CTRL','CNT_VALUE','CNT_RAW','CNT_FREQ','CNT_STATUS','CNT_EDGES','CNT_POS','CNT_VEL','DI_CAUGHT','DI_PULSE'];
 const ST_TY=['BOOL','INT','DINT','UINT','REAL','BYTE','WORD','DWORD','STRING','TIME'];
 
 // === Syntax Highlighting ===
@@ -513,7 +521,7 @@ async function doLogin(){
   btn.disabled=true;btn.textContent='Forbinder...';
   AUTH='Basic '+btoa(u+':'+p);
   try{
-    const r=await fetch('/api/status',{method:'GET',headers:{'Authorization':AUTH}});
+    const r=await fetch('/api/auth/login',{method:'POST',headers:{'Authorization':AUTH}});
     if(r.status===401){
       AUTH='';errEl.textContent='Forkert brugernavn eller adgangskode';errEl.style.display='block';
       btn.disabled=false;btn.textContent='Forbind';return;
@@ -526,6 +534,7 @@ async function doLogin(){
       AUTH='';errEl.textContent='Serverfejl: HTTP '+r.status;errEl.style.display='block';
       btn.disabled=false;btn.textContent='Forbind';return;
     }
+    AUTH='Bearer '+(await r.json()).token;
     sessionStorage.setItem('hfplc_auth',AUTH);
     document.getElementById('loginModal').classList.remove('show');
     init();
@@ -1165,7 +1174,7 @@ if(d.authenticated){document.getElementById('userName').textContent=d.username;d
 else{document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('umLogout').style.display='none'}
 }).catch(function(){})
 }
-function doLogout(){sessionStorage.removeItem('hfplc_auth');AUTH='';document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('userMenu').classList.remove('show');if(document.getElementById('loginModal'))document.getElementById('loginModal').classList.add('show')}
+function doLogout(){if(AUTH.indexOf('Bearer ')===0)fetch('/api/auth/logout',{method:'POST',headers:{'Authorization':AUTH}}).catch(()=>{});sessionStorage.removeItem('hfplc_auth');AUTH='';document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('userMenu').classList.remove('show');if(document.getElementById('loginModal'))document.getElementById('loginModal').classList.add('show')}
 async function doGlobalSave(){var btn=document.getElementById('saveBtn');btn.classList.add('saving');btn.textContent='\u23F3 Gemmer...';try{var h={method:'POST'};if(AUTH)h.headers={'Authorization':AUTH};var r=await fetch('/api/system/save',h);if(r.ok){btn.classList.remove('saving');btn.classList.add('saved');btn.textContent='\u2705 Gemt!';}else{btn.classList.remove('saving');btn.classList.add('save-err');btn.textContent='\u274C Fejl';}}catch(e){btn.classList.remove('saving');btn.classList.add('save-err');btn.textContent='\u274C Fejl';}setTimeout(()=>{btn.className='save-btn';btn.innerHTML='&#128190; Save';},2000);}
 
 // === FEAT-132: File Upload ===
@@ -1329,7 +1338,5 @@ updateUserBadge();
 
 esp_err_t web_editor_handler(httpd_req_t *req)
 {
-  httpd_resp_set_type(req, "text/html");
-  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-  return httpd_resp_send(req, editor_html, strlen(editor_html));
+  return web_asset_send(req, &web_asset_editor);
 }
@@ -10,11 +10,14 @@
  * - Current firmware version display
  *
  * RAM impact: ~0 bytes runtime (HTML stored in flash/PROGMEM only)
+ * The page literal below is the source for scripts/generate_web_assets.py;
+ * the firmware serves the gzipped copy (web_assets_gz.cpp) - FEAT-150.
  */
 
 #include <esp_http_server.h>
 #include <Arduino.h>
 #include "web_ota.h"
+#include "web_assets.h"
 #include "debug.h"
 
 static const char PROGMEM ota_html[] = R"rawhtml(<!DOCTYPE html>
@@ -125,7 +128,7 @@ let selectedFile=null;
 let pollTimer=null;
 
 function api(url,opts={}){
-  if(AUTH){if(!opts.headers)opts.headers={};opts.headers['Authorization']='Basic '+AUTH;}
+  if(AUTH){if(!opts.headers)opts.headers={};opts.headers['Authorization']=AUTH;}
   return fetch(url,opts).then(r=>{
     if(r.status===401){AUTH='';sessionStorage.removeItem('hfplc_auth');document.getElementById('loginModal').classList.add('show');throw new Error('Login');}
     return r;
@@ -134,10 +137,15 @@ function api(url,opts={}){
 function doLogin(){
   const u=document.getElementById('authUser').value;
   const p=document.getElementById('authPass').value;
-  AUTH=btoa(u+':'+p);
-  sessionStorage.setItem('hfplc_auth',AUTH);
-  document.getElementById('loginModal').classList.remove('show');
-  fetchStatus();
+  fetch('/api/auth/login',{method:'POST',headers:{'Authorization':'Basic '+btoa(u+':'+p)}}).then(r=>{
+    if(!r.ok)throw new Error('Login');
+    return r.json();
+  }).then(d=>{
+    AUTH='Bearer '+d.token;
+    sessionStorage.setItem('hfplc_auth',AUTH);
+    document.getElementById('loginModal').classList.remove('show');
+    fetchStatus();
+  }).catch(()=>{});
 }
 function setStatus(cls,msg){
   const el=document.getElementById('statusMsg');
@@ -177,7 +185,7 @@ function startUpload(){
 
   const xhr=new XMLHttpRequest();
   xhr.open('POST','/api/system/ota',true);
-  if(AUTH)xhr.setRequestHeader('Authorization','Basic '+AUTH);
+  if(AUTH)xhr.setRequestHeader('Authorization',AUTH);
   xhr.setRequestHeader('Content-Type','application/octet-stream');
 
   xhr.upload.onprogress=function(e){
@@ -271,7 +279,5 @@ fetchStatus();
 
 esp_err_t web_ota_handler(httpd_req_t *req)
 {
-  httpd_resp_set_type(req, "text/html");
-  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-  return httpd_resp_send(req, ota_html, strlen(ota_html));
+  return web_asset_send(req, &web_asset_ota);
 }
@@ -12,11 +12,14 @@
  * - System information
  *
  * RAM impact: ~0 bytes runtime (HTML stored in flash/PROGMEM only)
+ * The page literal below is the source for scripts/generate_web_assets.py;
+ * the firmware serves the gzipped copy (web_assets_gz.cpp) - FEAT-150.
  */
 
 #include <esp_http_server.h>
 #include <Arduino.h>
 #include "web_system.h"
+#include "web_assets.h"
 #include "debug.h"
 
 static const char PROGMEM system_html[] = R"rawhtml(<!DOCTYPE html>
@@ -303,10 +306,11 @@ function doLogin(){
   const u=$('authUser').value, p=$('authPass').value;
   if(!u||!p){$('loginErr').style.display='block';$('loginErr').textContent='Udfyld begge felter';return}
   AUTH='Basic '+btoa(u+':'+p);
-  fetch('/api/status',{headers:{'Authorization':AUTH}}).then(r=>{
+  fetch('/api/auth/login',{method:'POST',headers:{'Authorization':AUTH}}).then(r=>{
     if(!r.ok)throw new Error('Auth failed');
     return r.json();
-  }).then(()=>{
+  }).then(d=>{
+    AUTH='Bearer '+d.token;
     sessionStorage.setItem('hfplc_auth',AUTH);
     $('loginModal').classList.remove('show');
     refreshInfo();
@@ -656,7 +660,7 @@ if(d.authenticated){document.getElementById('userName').textContent=d.username;d
 else{document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('umLogout').style.display='none'}
 }).catch(function(){})
 }
-function doLogout(){sessionStorage.removeItem('hfplc_auth');AUTH='';document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('userMenu').classList.remove('show');if(document.getElementById('loginModal'))document.getElementById('loginModal').classList.add('show')}
+function doLogout(){if(AUTH.indexOf('Bearer ')===0)fetch('/api/auth/logout',{method:'POST',headers:{'Authorization':AUTH}}).catch(()=>{});sessionStorage.removeItem('hfplc_auth');AUTH='';document.getElementById('userName').textContent='Ikke logget ind';document.getElementById('userDot').className='dot dot-off';document.getElementById('userMenu').classList.remove('show');if(document.getElementById('loginModal'))document.getElementById('loginModal').classList.add('show')}
 updateUserBadge();
 </script>
 </body>
@@ -668,7 +672,5 @@ updateUserBadge();
 
 esp_err_t web_system_handler(httpd_req_t *req)
 {
-  httpd_resp_set_type(req, "text/html");
-  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-  return httpd_resp_send(req, system_html, strlen(system_html));
+  return web_asset_send(req, &web_asset_system);
 }
@@ -0,0 +1,196 @@
+/**
+ * @file api_router_bench.cpp
+ * @brief Host test + benchmark for the /api/v1 trie router (FEAT-151)
+ *
+ * Builds the firmware's v1 route table (api_v1_routes.h) into an ApiRouter,
+ * checks it fits the router limits and every lookup against the old linear
+ * strcmp/strncmp scan, then times both.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "api_router.h"
+#include "api_v1_routes.h"
+
+// http_parser method values as used by esp_http_server
+enum { HTTP_DELETE = 0, HTTP_GET = 1, HTTP_POST = 3 };
+
+typedef struct {
+  const char *path;
+  int method;
+} Route;
+
+// The firmware's v1 table (paths + methods; handlers are dropped)
+#define API_V1_ROUTE(path, method, handler) {path, method},
+static const Route routes[] = {
+  API_V1_ROUTES
+  {NULL, -1}
+};
+#undef API_V1_ROUTE
+
+// Old v1_dispatch: first match in table order, exact = no trailing slash
+static int linear_match(const char *uri, int method)
+{
+  for (int i = 0; routes[i].path != NULL; i++) {
+    const Route *r = &routes[i];
+    if (r->method != method) continue;
+    size_t len = strlen(r->path);
+    bool exact = r->path[len - 1] != '/';
+    if (exact) {
+      if (strcmp(uri, r->path) != 0) continue;
+    } else {
+      if (strncmp(uri, r->path, len) != 0) continue;
+    }
+    return i;
+  }
+  return -1;
+}
+
+typedef struct {
+  const char *uri;
+  int method;
+  const char *expect_path;   // NULL = 404
+  const char *expect_rest;   // NULL = exact match
+} Case;
+
+static const Case cases[] = {
+  {"/api/status",                 HTTP_GET,    "/api/status",            NULL},
+  {"/api/status",                 HTTP_POST,   NULL,                     NULL},
+  {"/api/wifi",                   HTTP_POST,   "/api/wifi",              NULL},
+  {"/api/wifi/scan",              HTTP_POST,   "/api/wifi/",             "scan"},
+  {"/api/counters",               HTTP_GET,    "/api/counters",          NULL},
+  {"/api/counters/3",             HTTP_GET,    "/api/counters/",         "3"},
+  {"/api/counters/3/reset",       HTTP_POST,   "/api/counters/",         "3/reset"},
+  {"/api/counters/2",             HTTP_DELETE, "/api/counters/",         "2"},
+  {"/api/counters/",              HTTP_GET,    "/api/counters/",         ""},
+  {"/api/logic/settings",         HTTP_POST,   "/api/logic/settings",    NULL},
+  {"/api/logic/settings",         HTTP_GET,    "/api/logic/",            "settings"},
+  {"/api/logic/1/source",         HTTP_GET,    "/api/logic/",            "1/source"},
+  {"/api/gpio/2/heartbeat",       HTTP_POST,   "/api/gpio/2/heartbeat",  NULL},
+  {"/api/gpio/2",                 HTTP_GET,    "/api/gpio/",             "2"},
+  {"/api/gpio/17",                HTTP_DELETE, "/api/gpio/",             "17"},
+  {"/api/registers/hr/bulk",      HTTP_POST,   "/api/registers/hr/bulk", NULL},
+  {"/api/registers/hr/100",       HTTP_POST,   "/api/registers/hr/",     "100"},
+  {"/api/registers/hr/100",       HTTP_GET,    "/api/registers/hr/",     "100"},
+  {"/api/registers/coils/bulk",   HTTP_POST,   "/api/registers/coils/bulk", NULL},
+  {"/api/registers/di/7",         HTTP_GET,    "/api/registers/di/",     "7"},
+  {"/api/registers/ir",           HTTP_GET,    "/api/registers/ir",      NULL},
+  {"/api/persist/groups/tank1",   HTTP_DELETE, "/api/persist/groups/",   "tank1"},
+  {"/api/modbus/slave",           HTTP_POST,   "/api/modbus/",           "slave"},
+  {"/api/events/disconnect",      HTTP_POST,   "/api/events/disconnect", NULL},
+  {"/api/registers/multi",        HTTP_GET,    "/api/registers/multi",   NULL},
+  {"/api/auth/login",             HTTP_POST,   "/api/auth/login",        NULL},
+  {"/api/auth/login",             HTTP_GET,    NULL,                     NULL},
+  {"/api/history",                HTTP_GET,    "/api/history",           NULL},
+  {"/api/history",                HTTP_POST,   "/api/history",           NULL},
+  {"/api/history/3",              HTTP_GET,    "/api/history/",          "3"},
+  {"/api/history/3",              HTTP_POST,   NULL,                     NULL},
+  {"/api/nope",                   HTTP_GET,    NULL,                     NULL},
+  {"/api/statusx",                HTTP_GET,    NULL,                     NULL},
+  {"/api/status/",                HTTP_GET,    NULL,                     NULL},
+  {"/api",                        HTTP_GET,    NULL,                     NULL},
+};
+
+// Query strings: the old exact strcmp missed these (404), the router ignores the query
+static const Case query_cases[] = {
+  {"/api/registers/hr?start=0&count=100", HTTP_GET, "/api/registers/hr",  NULL},
+  {"/api/metrics?families=modbus,st",     HTTP_GET, "/api/metrics",       NULL},
+  {"/api/counters/1?x=1",                 HTTP_GET, "/api/counters/",     "1?x=1"},
+};
+
+static int route_index(const char *path, int method)
+{
+  for (int i = 0; routes[i].path != NULL; i++) {
+    if (routes[i].method == method && strcmp(routes[i].path, path) == 0) return i;
+  }
+  return -1;
+}
+
+static int check(const ApiRouter *r, const Case *c, bool compare_linear)
+{
+  ApiRouteMatch m = api_router_match(r, c->uri, c->method);
+  int expect = c->expect_path ? route_index(c->expect_path, c->method) : -1;
+  int fails = 0;
+
+  if (m.route_id != expect) {
+    printf("FAIL %-36s route %d, expected %d\n", c->uri, m.route_id, expect);
+    fails++;
+  } else if (expect >= 0 && (c->expect_rest == NULL) != (m.rest == NULL)) {
+    printf("FAIL %-36s exact/catch-all mismatch\n", c->uri);
+    fails++;
+  } else if (c->expect_rest && strcmp(m.rest, c->expect_rest) != 0) {
+    printf("FAIL %-36s rest '%s', expected '%s'\n", c->uri, m.rest, c->expect_rest);
+    fails++;
+  }
+  if (compare_linear && linear_match(c->uri, c->method) != m.route_id) {
+    printf("FAIL %-36s differs from linear scan\n", c->uri);
+    fails++;
+  }
+  return fails;
+}
+
+int main(void)
+{
+  static ApiRouter router;
+  api_router_init(&router);
+  int route_count = 0;
+  for (int i = 0; routes[i].path != NULL; i++, route_count++) {
+    if (!api_router_add(&router, routes[i].path, routes[i].method, (uint8_t)i)) {
+      printf("FAIL add %s\n", routes[i].path);
+      return 1;
+    }
+  }
+  printf("routes: %d/%d, trie nodes: %d/%d, sizeof(ApiRouter): %zu bytes\n",
+         route_count, API_ROUTER_MAX_ROUTES, router.node_count, API_ROUTER_MAX_NODES,
+         sizeof(ApiRouter));
+
+  int fails = 0;
+  // The firmware drops routes that do not fit; the table must stay within the limits
+  if (route_count > API_ROUTER_MAX_ROUTES || router.node_count > API_ROUTER_MAX_NODES) {
+    printf("FAIL v1 table exceeds router limits\n");
+    fails++;
+  }
+  const int n_cases = sizeof(cases) / sizeof(cases[0]);
+  for (int i = 0; i < n_cases; i++) fails += check(&router, &cases[i], true);
+  for (size_t i = 0; i < sizeof(query_cases) / sizeof(query_cases[0]); i++) {
+    fails += check(&router, &query_cases[i], false);
+  }
+
+  // Every table entry must be reachable by its own path
+  for (int i = 0; routes[i].path != NULL; i++) {
+    char uri[64];
+    snprintf(uri, sizeof(uri), "%s%s", routes[i].path,
+             routes[i].path[strlen(routes[i].path) - 1] == '/' ? "1" : "");
+    if (api_router_match(&router, uri, routes[i].method).route_id != linear_match(uri, routes[i].method)) {
+      printf("FAIL reach %s\n", uri);
+      fails++;
+    }
+  }
+
+  // Benchmark: dashboard-like mix
+  const int iters = 200000;
+  volatile int sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int it = 0; it < iters; it++) {
+    const Case *c = &cases[it % n_cases];
+    sink += linear_match(c->uri, c->method);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int it = 0; it < iters; it++) {
+    const Case *c = &cases[it % n_cases];
+    sink += api_router_match(&router, c->uri, c->method).route_id;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  (void)sink;
+
+  double lin_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+  double trie_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / iters;
+  printf("linear scan: %7.1f ns/lookup\n", lin_ns);
+  printf("trie router: %7.1f ns/lookup (%.1fx)\n", trie_ns, lin_ns / trie_ns);
+
+  printf("%s (%d failures)\n", fails ? "FAILED" : "PASSED", fails);
+  return fails ? 1 : 0;
+}
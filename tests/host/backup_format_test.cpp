@@ -0,0 +1,282 @@
+/**
+ * @file backup_format_test.cpp
+ * @brief Host test for the binary config backup container (FEAT-170)
+ *
+ * Writes a backup through a memory sink and parses it again with the
+ * stream split at random chunk boundaries (also inside headers and CRCs).
+ * Covers CRC compatibility with zlib, streamed records, skipping of
+ * unknown record types, payload size limits, corrupt bytes anywhere in the
+ * stream, truncation, a dropped record, trailing data and a consumer
+ * rejecting a record.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "backup_format.h"
+#include "host_test.h"
+
+#define OUT_CAP   (64 * 1024)
+
+/* ============================================================================
+ * SINK / HANDLER
+ * ============================================================================ */
+
+typedef struct {
+  uint8_t  data[OUT_CAP];
+  uint32_t len;
+  uint32_t writes;
+  uint32_t fail_after;    // Fail the n-th write (0 = never)
+} MemSink;
+
+static bool mem_write(void *ctx, const void *buf, uint32_t len) {
+  MemSink *s = (MemSink *)ctx;
+  s->writes++;
+  if (s->fail_after && s->writes >= s->fail_after) return false;
+  if (s->len + len > OUT_CAP) return false;
+  memcpy(s->data + s->len, buf, len);
+  s->len += len;
+  return true;
+}
+
+typedef struct {
+  uint8_t  type;
+  uint8_t  id;
+  uint8_t  version;
+  uint32_t len;
+  uint32_t sum;           // Byte sum of the payload (0 if skipped)
+  bool     skipped;
+} SeenRecord;
+
+typedef struct {
+  SeenRecord seen[64];
+  uint32_t   count;
+  uint8_t    buf[8192];
+  uint8_t    reject_type; // record() returns false for this type
+} Collector;
+
+static uint8_t *col_begin(void *ctx, const BkRecordHeader *rec) {
+  Collector *c = (Collector *)ctx;
+  if (rec->type > BK_REC_BYTECODE) return NULL;   // Unknown: skip
+  return rec->len <= sizeof(c->buf) ? c->buf : NULL;
+}
+
+static bool col_record(void *ctx, const BkRecordHeader *rec, uint8_t *payload) {
+  Collector *c = (Collector *)ctx;
+  if (rec->type == c->reject_type) return false;
+  if (c->count >= 64) return false;
+  SeenRecord *s = &c->seen[c->count++];
+  s->type = rec->type;
+  s->id = rec->id;
+  s->version = rec->version;
+  s->len = rec->len;
+  s->skipped = payload == NULL;
+  s->sum = 0;
+  for (uint32_t i = 0; payload && i < rec->len; i++) s->sum += payload[i];
+  return true;
+}
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+static MemSink sink_mem;
+static BkSink sink = { &sink_mem, mem_write };
+static uint8_t section[3][700];
+static char source[3000];
+
+static uint32_t byte_sum(const void *data, uint32_t len) {
+  uint32_t s = 0;
+  for (uint32_t i = 0; i < len; i++) s += ((const uint8_t *)data)[i];
+  return s;
+}
+
+// Typical backup: info, three sections, one streamed program, one unknown record
+static BkError write_backup(MemSink *m) {
+  static BkWriter w;
+  memset(m, 0, sizeof(*m));
+  sink.ctx = m;
+  bk_writer_init(&w, &sink, BK_FLAG_SOURCES);
+
+  BkInfo info;
+  memset(&info, 0, sizeof(info));
+  strcpy(info.firmware, "7.9.10.1");
+  info.schema_version = 15;
+  bk_record(&w, BK_REC_INFO, 0, 1, &info, sizeof(info));
+
+  for (int i = 0; i < 3; i++) {
+    bk_record(&w, BK_REC_SECTION, (uint8_t)i, (uint8_t)(i + 1), section[i], sizeof(section[i]));
+  }
+
+  BkProgramHeader ph;
+  memset(&ph, 0, sizeof(ph));
+  ph.enabled = 1;
+  strcpy(ph.name, "Logic1");
+  uint32_t src_len = (uint32_t)strlen(source);
+  bk_begin(&w, BK_REC_PROGRAM, 0, 1, sizeof(ph) + src_len);
+  bk_data(&w, &ph, sizeof(ph));
+  for (uint32_t off = 0; off < src_len; off += 100) {
+    uint32_t n = src_len - off < 100 ? src_len - off : 100;
+    bk_data(&w, source + off, n);
+  }
+  bk_end(&w);
+
+  uint8_t future[40];
+  memset(future, 0x5A, sizeof(future));
+  bk_record(&w, 0x40, 7, 1, future, sizeof(future));
+
+  return bk_finish(&w);
+}
+
+// Parse data in random chunks of 1..max_chunk bytes
+static BkError parse(const uint8_t *data, uint32_t len, Collector *c,
+                     uint32_t max_chunk, uint32_t max_payload = 4096) {
+  static BkReader r;
+  BkHandler h = { c, col_begin, col_record };
+  c->count = 0;
+  bk_reader_init(&r, &h, max_payload);
+  uint32_t off = 0;
+  while (off < len) {
+    uint32_t n = 1 + (uint32_t)rand() % max_chunk;
+    if (n > len - off) n = len - off;
+    if (bk_reader_feed(&r, data + off, n) != BK_OK) break;
+    off += n;
+  }
+  return bk_reader_finish(&r);
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================ */
+
+static void test_crc(void) {
+  printf("== CRC-32\n");
+  // Reference values from zlib.crc32()
+  CHECK(bk_crc32(0, "123456789", 9) == 0xCBF43926u, "check value");
+  CHECK(bk_crc32(0, "", 0) == 0, "empty");
+  uint32_t part = bk_crc32(0, "1234", 4);
+  CHECK(bk_crc32(part, "56789", 5) == 0xCBF43926u, "incremental");
+}
+
+static void test_round_trip(void) {
+  printf("== Round trip, random chunk sizes\n");
+  CHECK(write_backup(&sink_mem) == BK_OK, "write");
+  CHECK(sink_mem.writes > 1, "writer flushes in chunks (%u writes)", sink_mem.writes);
+
+  static Collector c;
+  const uint32_t chunks[] = { 1, 3, 7, 64, 511, 4096, OUT_CAP };
+  for (uint32_t k = 0; k < sizeof(chunks) / sizeof(chunks[0]); k++) {
+    BkError e = parse(sink_mem.data, sink_mem.len, &c, chunks[k]);
+    CHECK(e == BK_OK, "chunk %u: %s", chunks[k], bk_error_name(e));
+    CHECK(c.count == 6, "chunk %u: %u records", chunks[k], c.count);
+    if (c.count != 6) continue;
+    CHECK(c.seen[0].type == BK_REC_INFO && c.seen[0].len == sizeof(BkInfo), "info");
+    for (int i = 0; i < 3; i++) {
+      const SeenRecord *s = &c.seen[1 + i];
+      CHECK(s->type == BK_REC_SECTION && s->id == i && s->version == i + 1, "section %d header", i);
+      CHECK(s->sum == byte_sum(section[i], sizeof(section[i])), "section %d payload", i);
+    }
+    CHECK(c.seen[4].type == BK_REC_PROGRAM &&
+          c.seen[4].len == sizeof(BkProgramHeader) + strlen(source), "program length");
+    CHECK(c.seen[5].type == 0x40 && c.seen[5].skipped, "unknown record skipped");
+  }
+}
+
+static void test_size_limit(void) {
+  printf("== Payload size limit\n");
+  static Collector c;
+  CHECK(parse(sink_mem.data, sink_mem.len, &c, 64, 2048) == BK_ERR_SIZE, "program > limit");
+  CHECK(c.count == 4, "records before the large one accepted (%u)", c.count);
+}
+
+static void test_corruption(void) {
+  printf("== Corruption anywhere is detected\n");
+  static uint8_t bad[OUT_CAP];
+  static Collector c;
+  uint32_t undetected = 0;
+  for (uint32_t pos = 0; pos < sink_mem.len; pos += 7) {
+    memcpy(bad, sink_mem.data, sink_mem.len);
+    bad[pos] ^= (uint8_t)(1 + rand() % 255);
+    if (parse(bad, sink_mem.len, &c, 300) == BK_OK) undetected++;
+  }
+  CHECK(undetected == 0, "%u corrupted streams accepted", undetected);
+
+  memcpy(bad, sink_mem.data, sink_mem.len);
+  bad[0] ^= 1;
+  CHECK(parse(bad, sink_mem.len, &c, 300) == BK_ERR_MAGIC, "bad magic");
+
+  memcpy(bad, sink_mem.data, sink_mem.len);
+  bad[4] = BK_FORMAT_VERSION + 1;
+  CHECK(parse(bad, sink_mem.len, &c, 300) == BK_ERR_FORMAT, "newer format");
+}
+
+static void test_truncation(void) {
+  printf("== Truncated / spliced streams\n");
+  static Collector c;
+  uint32_t accepted = 0;
+  for (uint32_t len = 0; len < sink_mem.len; len += 5) {
+    if (parse(sink_mem.data, len, &c, 128) == BK_OK) accepted++;
+  }
+  CHECK(accepted == 0, "%u truncated streams accepted", accepted);
+
+  // Drop the unknown record (header 8 + payload 40 + crc 4) before END:
+  // every remaining record is valid, only the END count reveals it
+  static uint8_t spliced[OUT_CAP];
+  const uint32_t end_size = sizeof(BkRecordHeader) + sizeof(BkEnd) + 4;
+  const uint32_t drop = sizeof(BkRecordHeader) + 40 + 4;
+  uint32_t keep = sink_mem.len - end_size - drop;
+  memcpy(spliced, sink_mem.data, keep);
+  memcpy(spliced + keep, sink_mem.data + sink_mem.len - end_size, end_size);
+  CHECK(parse(spliced, keep + end_size, &c, 128) == BK_ERR_TRUNCATED, "missing record");
+
+  memcpy(spliced, sink_mem.data, sink_mem.len);
+  spliced[sink_mem.len] = 0;
+  CHECK(parse(spliced, sink_mem.len + 1, &c, 128) == BK_ERR_TRAILING, "trailing byte");
+}
+
+static void test_errors(void) {
+  printf("== Handler and sink errors\n");
+  static Collector c;
+  c.reject_type = BK_REC_PROGRAM;
+  CHECK(parse(sink_mem.data, sink_mem.len, &c, 64) == BK_ERR_HANDLER, "rejected record");
+  c.reject_type = 0;
+
+  static MemSink failing;
+  static BkWriter w;
+  memset(&failing, 0, sizeof(failing));
+  failing.fail_after = 2;
+  BkSink fs = { &failing, mem_write };
+  bk_writer_init(&w, &fs, 0);
+  for (int i = 0; i < 3; i++) {
+    bk_record(&w, BK_REC_SECTION, (uint8_t)i, 1, section[i], sizeof(section[i]));
+  }
+  CHECK(bk_finish(&w) == BK_ERR_SINK, "sink failure reported");
+
+  memset(&failing, 0, sizeof(failing));
+  fs.ctx = &failing;
+  bk_writer_init(&w, &fs, 0);
+  CHECK(bk_begin(&w, BK_REC_SECTION, 0, 1, 10), "begin");
+  CHECK(!bk_data(&w, section[0], 11), "more data than announced");
+  CHECK(!bk_end(&w), "end before all data");
+  CHECK(bk_finish(&w) == BK_ERR_TRUNCATED, "finish with open record");
+}
+
+int main(void) {
+  srand(1234);
+  for (int i = 0; i < 3; i++) {
+    for (uint32_t j = 0; j < sizeof(section[i]); j++) section[i][j] = (uint8_t)rand();
+  }
+  for (uint32_t i = 0; i < sizeof(source) - 1; i++) source[i] = (char)(' ' + rand() % 90);
+
+  test_crc();
+  test_round_trip();
+  test_size_limit();
+  test_corruption();
+  test_truncation();
+  test_errors();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
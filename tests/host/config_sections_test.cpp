@@ -0,0 +1,306 @@
+/**
+ * @file config_sections_test.cpp
+ * @brief Host test for sectioned PersistConfig storage (FEAT-166)
+ *
+ * Runs the section engine against an in-memory key/value store. Covers
+ * that the section ranges tile PersistConfig exactly, round trips, delta
+ * saves (only changed sections written), sections that grew or changed
+ * version, corrupt blobs, sections left out of a save (lazy, not loaded)
+ * an interrupted first save that must not look like a complete layout, and
+ * gather/apply of section payloads held outside the store (binary backup).
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "config_sections.h"
+#include "host_test.h"
+
+/* ----------------------------------------------------------------------------
+ * In-memory store
+ * -------------------------------------------------------------------------- */
+
+typedef struct {
+  std::map<std::string, std::vector<uint8_t>> kv;
+  int fail_after;          // Writes left before failing (-1 = never)
+  uint32_t writes;
+} MemStore;
+
+static bool mem_read(void *ctx, const char *key, void *buf, uint32_t *len)
+{
+  MemStore *m = (MemStore *)ctx;
+  auto it = m->kv.find(key);
+  if (it == m->kv.end() || it->second.size() > *len) return false;
+  memcpy(buf, it->second.data(), it->second.size());
+  *len = (uint32_t)it->second.size();
+  return true;
+}
+
+static bool mem_write(void *ctx, const char *key, const void *buf, uint32_t len)
+{
+  MemStore *m = (MemStore *)ctx;
+  if (m->fail_after == 0) return false;
+  if (m->fail_after > 0) m->fail_after--;
+  m->kv[key].assign((const uint8_t *)buf, (const uint8_t *)buf + len);
+  m->writes++;
+  return true;
+}
+
+static bool mem_commit(void *ctx)
+{
+  (void)ctx;
+  return true;
+}
+
+static CsStoreOps make_ops(MemStore *m)
+{
+  m->fail_after = -1;
+  m->writes = 0;
+  CsStoreOps ops = { m, mem_read, mem_write, mem_commit };
+  return ops;
+}
+
+static void fill_random(PersistConfig *cfg)
+{
+  uint8_t *p = (uint8_t *)cfg;
+  for (size_t i = 0; i < sizeof(*cfg); i++) p[i] = (uint8_t)rand();
+}
+
+static bool same_config(const PersistConfig *a, const PersistConfig *b)
+{
+  return memcmp(a, b, offsetof(PersistConfig, crc16)) == 0;
+}
+
+static uint16_t crc16(const uint8_t *d, uint32_t n)
+{
+  uint16_t crc = 0xFFFF;
+  for (uint32_t i = 0; i < n; i++) {
+    crc ^= (uint16_t)d[i] << 8;
+    for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+static PersistConfig cfg, loaded, defaults;
+
+/* ----------------------------------------------------------------------------
+ * Tests
+ * -------------------------------------------------------------------------- */
+
+static void test_tiling(void)
+{
+  printf("== sections tile PersistConfig (all but crc16)\n");
+  static uint8_t owner[sizeof(PersistConfig)];
+  memset(owner, 0xFF, sizeof(owner));
+  uint32_t total = 0;
+  for (int id = 0; id < CFG_SEC_COUNT; id++) {
+    const ConfigSection *s = &cs_sections[id];
+    CHECK(strlen(s->key) <= 15, "%s: NVS key too long", s->name);
+    CHECK(cs_section_size((ConfigSectionId)id) <= CS_MAX_SECTION_SIZE, "%s: %u bytes",
+          s->name, cs_section_size((ConfigSectionId)id));
+    for (int r = 0; r < s->range_count; r++) {
+      for (uint32_t i = 0; i < s->ranges[r].len; i++) {
+        uint32_t off = s->ranges[r].offset + i;
+        CHECK(off < offsetof(PersistConfig, crc16), "%s covers crc16/out of range", s->name);
+        if (off >= sizeof(owner)) break;
+        CHECK(owner[off] == 0xFF, "byte %u in %s and section %u", off, s->name, owner[off]);
+        owner[off] = (uint8_t)id;
+      }
+    }
+    total += cs_section_size((ConfigSectionId)id);
+  }
+  uint32_t uncovered = 0;
+  for (uint32_t i = 0; i < offsetof(PersistConfig, crc16); i++) {
+    if (owner[i] == 0xFF) uncovered++;
+  }
+  CHECK(uncovered == 0, "%u bytes of PersistConfig in no section "
+        "(new field? add it to the end of its section)", uncovered);
+  printf("   %u sections, %u bytes\n", CFG_SEC_COUNT, total);
+}
+
+static void test_round_trip_and_delta(void)
+{
+  printf("== round trip, delta saves\n");
+  MemStore m;
+  CsStoreOps ops = make_ops(&m);
+  ConfigStore s;
+  cs_init(&s, &ops);
+
+  fill_random(&cfg);
+  CHECK(!cs_present(&s), "empty store present");
+  CHECK(cs_save(&s, &cfg, CS_ALL) == CFG_SEC_COUNT, "first save");
+  uint32_t full_bytes = s.stats.bytes;
+  CHECK(cs_present(&s), "complete layout not present");
+  CHECK(cs_save(&s, &cfg, CS_ALL) == 0 && s.stats.skipped == CFG_SEC_COUNT,
+        "unchanged save wrote %u", s.stats.written - CFG_SEC_COUNT);
+
+  // Fresh boot: load everything
+  ConfigStore s2;
+  cs_init(&s2, &ops);
+  memset(&loaded, 0, sizeof(loaded));
+  for (int id = 0; id < CFG_SEC_COUNT; id++) {
+    CHECK(cs_load(&s2, &loaded, (ConfigSectionId)id, &defaults) == CS_LOADED, "load %d", id);
+  }
+  CHECK(same_config(&cfg, &loaded), "round trip differs");
+  CHECK(cs_save(&s2, &loaded, CS_ALL) == 0, "save after load rewrote sections");
+
+  // Hostname change: only the system section
+  uint32_t before = s2.stats.bytes;
+  strcpy(loaded.hostname, "plc-hall-3");
+  CHECK(cs_save(&s2, &loaded, CS_ALL) == 1, "hostname change wrote more than one section");
+  CHECK(m.kv["cs_system"].size() == sizeof(CsHeader) + cs_section_size(CFG_SEC_SYSTEM),
+        "system blob size");
+  printf("   full save %u bytes, hostname change %u bytes\n", full_bytes, s2.stats.bytes - before);
+
+  // A mapping edit: only mappings
+  loaded.var_maps[5].gpio_pin ^= 0x5A;
+  loaded.gpio_irq_pins ^= 1;
+  uint32_t w = m.writes;
+  CHECK(cs_save(&s2, &loaded, CS_ALL) == 1 && m.writes == w + 1, "mapping change");
+  CHECK(m.kv.count("cs_mappings") == 1, "mappings key");
+}
+
+static void test_layout_changes(void)
+{
+  printf("== grown section, version bump, corrupt blob\n");
+  MemStore m;
+  CsStoreOps ops = make_ops(&m);
+  ConfigStore s;
+  cs_init(&s, &ops);
+  fill_random(&cfg);
+  fill_random(&defaults);
+  cs_save(&s, &cfg, CS_ALL);
+
+  // Counters stored by an older firmware: 8 bytes shorter, same version
+  std::vector<uint8_t> &blob = m.kv["cs_counters"];
+  uint32_t size = cs_section_size(CFG_SEC_COUNTERS);
+  blob.resize(blob.size() - 8);
+  CsHeader h;
+  memcpy(&h, blob.data(), sizeof(h));
+  h.size = (uint16_t)(size - 8);
+  h.crc = crc16(blob.data() + sizeof(h), h.size);
+  memcpy(blob.data(), &h, sizeof(h));
+
+  // RBAC stored with another version
+  std::vector<uint8_t> &rb = m.kv["cs_rbac"];
+  rb[3] = (uint8_t)(cs_sections[CFG_SEC_RBAC].version + 1);
+
+  // UI blob with a flipped payload bit
+  m.kv["cs_ui"][sizeof(CsHeader) + 10] ^= 0x01;
+
+  ConfigStore s2;
+  cs_init(&s2, &ops);
+  memset(&loaded, 0, sizeof(loaded));
+  CsLoadResult res[CFG_SEC_COUNT];
+  for (int id = 0; id < CFG_SEC_COUNT; id++) {
+    res[id] = cs_load(&s2, &loaded, (ConfigSectionId)id, &defaults);
+  }
+  CHECK(res[CFG_SEC_COUNTERS] == CS_RESIZED, "counters %s", cs_result_name(res[CFG_SEC_COUNTERS]));
+  CHECK(res[CFG_SEC_RBAC] == CS_VERSION, "rbac %s", cs_result_name(res[CFG_SEC_RBAC]));
+  CHECK(res[CFG_SEC_UI] == CS_CORRUPT, "ui %s", cs_result_name(res[CFG_SEC_UI]));
+  CHECK(res[CFG_SEC_NETWORK] == CS_LOADED && res[CFG_SEC_SYSTEM] == CS_LOADED, "others");
+
+  // Counters: stored prefix kept, last 8 bytes (end of counter_quad) from defaults
+  const CsRange *last = &cs_sections[CFG_SEC_COUNTERS].ranges[1];
+  CHECK(memcmp(&loaded.counters, &cfg.counters, sizeof(cfg.counters)) == 0, "counters lost");
+  CHECK(memcmp((uint8_t *)&loaded + last->offset + last->len - 8,
+               (uint8_t *)&defaults + last->offset + last->len - 8, 8) == 0, "tail not defaulted");
+  CHECK(memcmp(&loaded.rbac, &defaults.rbac, sizeof(defaults.rbac)) == 0, "rbac not reset");
+  CHECK(memcmp(loaded.dashboard_card_tabs, defaults.dashboard_card_tabs,
+               sizeof(defaults.dashboard_card_tabs)) == 0, "ui not reset");
+  CHECK(memcmp(&loaded.network, &cfg.network, sizeof(cfg.network)) == 0, "network lost");
+
+  // Only the three repaired sections are rewritten
+  CHECK(cs_save(&s2, &loaded, CS_ALL) == 3, "repair save wrote %u", s2.stats.written);
+}
+
+static void test_lazy_and_interrupted(void)
+{
+  printf("== sections left out of a save, interrupted first save\n");
+  MemStore m;
+  CsStoreOps ops = make_ops(&m);
+  ConfigStore s;
+  cs_init(&s, &ops);
+  fill_random(&cfg);
+  cs_save(&s, &cfg, CS_ALL);
+
+  // UI not loaded yet: RAM holds defaults, which must not reach flash
+  ConfigStore s2;
+  cs_init(&s2, &ops);
+  memset(&loaded, 0, sizeof(loaded));
+  for (int id = 0; id < CFG_SEC_COUNT; id++) {
+    if (id != CFG_SEC_UI) cs_load(&s2, &loaded, (ConfigSectionId)id, &defaults);
+  }
+  CHECK(!(s2.loaded & CS_BIT(CFG_SEC_UI)), "ui marked loaded");
+  loaded.module_flags ^= 0xFF;
+  CHECK(cs_save(&s2, &loaded, s2.loaded) == 1, "lazy save");
+  cs_load(&s2, &loaded, CFG_SEC_UI, &defaults);
+  CHECK(memcmp(loaded.dashboard_card_order, cfg.dashboard_card_order,
+               sizeof(cfg.dashboard_card_order)) == 0, "ui overwritten while not loaded");
+
+  // Conversion interrupted after k sections: never a "complete" layout
+  for (int k = 0; k < CFG_SEC_COUNT; k++) {
+    MemStore m2;
+    CsStoreOps ops2 = make_ops(&m2);
+    ConfigStore s3;
+    cs_init(&s3, &ops2);
+    m2.fail_after = k;
+    CHECK(cs_save(&s3, &cfg, CS_ALL) == -1, "k=%d: failure not reported", k);
+    CHECK(!cs_present(&s3), "k=%d: partial layout looks complete", k);
+  }
+}
+
+static void test_gather_apply(void)
+{
+  printf("== gather/apply outside the store (backup), copy\n");
+  static uint8_t payload[CS_MAX_SECTION_SIZE];
+  fill_random(&cfg);
+  fill_random(&defaults);
+  memset(&loaded, 0, sizeof(loaded));
+  for (int id = 0; id < CFG_SEC_COUNT; id++) {
+    ConfigSectionId sid = (ConfigSectionId)id;
+    cs_gather(&cfg, sid, payload);
+    CHECK(cs_apply(&loaded, sid, cs_sections[id].version, payload, cs_section_size(sid),
+                   &defaults) == CS_LOADED, "apply %d", id);
+  }
+  CHECK(same_config(&cfg, &loaded), "gather/apply round trip differs");
+
+  // Other version: untouched; shorter: tail from defaults
+  PersistConfig before = loaded;
+  cs_gather(&defaults, CFG_SEC_RBAC, payload);
+  CHECK(cs_apply(&loaded, CFG_SEC_RBAC, (uint8_t)(cs_sections[CFG_SEC_RBAC].version + 1),
+                 payload, cs_section_size(CFG_SEC_RBAC), &defaults) == CS_VERSION, "version");
+  CHECK(same_config(&before, &loaded), "version mismatch modified cfg");
+  cs_gather(&cfg, CFG_SEC_NETWORK, payload);
+  CHECK(cs_apply(&loaded, CFG_SEC_NETWORK, cs_sections[CFG_SEC_NETWORK].version, payload, 4,
+                 &defaults) == CS_RESIZED, "short payload");
+  CHECK(memcmp(&loaded.ntp, &defaults.ntp, sizeof(defaults.ntp)) == 0, "short tail not defaulted");
+
+  // Copy only the masked sections
+  memcpy(&loaded, &cfg, sizeof(cfg));
+  cs_copy(&loaded, &defaults, CS_BIT(CFG_SEC_UI) | CS_BIT(CFG_SEC_PERSIST));
+  CHECK(memcmp(&loaded.persist_regs, &defaults.persist_regs, sizeof(defaults.persist_regs)) == 0,
+        "persist not copied");
+  CHECK(memcmp(&loaded.network, &cfg.network, sizeof(cfg.network)) == 0 &&
+        memcmp(loaded.hostname, cfg.hostname, sizeof(cfg.hostname)) == 0, "unmasked section copied");
+}
+
+int main(void)
+{
+  srand(7);
+  memset(&defaults, 0, sizeof(defaults));
+  test_tiling();
+  test_round_trip_and_delta();
+  test_layout_changes();
+  test_lazy_and_interrupted();
+  test_gather_apply();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file edge_ring_test.cpp
+ * @brief Host test for the lock-free edge timestamp ring (FEAT-156)
+ *
+ * Covers in-order drain, independent consumers, overrun (lost count),
+ * head wrap at 2^32, partial reads and a real producer thread racing a
+ * consumer (timestamps must come out strictly consecutive or be reported
+ * as lost — never torn or duplicated).
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <thread>
+#include <atomic>
+#include "edge_ring.h"
+#include "host_test.h"
+
+static void test_init(void)
+{
+  printf("== init rejects non power-of-two\n");
+  static uint32_t buf[16];
+  EdgeRing r = {};
+  CHECK(!edge_ring_init(&r, buf, 12), "size 12 accepted");
+  CHECK(!edge_ring_init(&r, NULL, 16), "NULL accepted");
+  CHECK(edge_ring_init(&r, buf, 16), "size 16 rejected");
+  CHECK(edge_ring_head(&r) == 0 && edge_ring_tail(&r) == 0, "not empty");
+}
+
+static void test_drain_and_consumers(void)
+{
+  printf("== in-order drain, two independent cursors\n");
+  static uint32_t buf[16];
+  EdgeRing r = {};
+  edge_ring_init(&r, buf, 16);
+  for (uint32_t i = 0; i < 10; i++) edge_ring_push(&r, 1000 + i);
+
+  uint32_t a = 0, b = 0, lost = 0, out[16];
+  uint32_t n = edge_ring_read(&r, &a, out, 4, &lost);
+  CHECK(n == 4 && out[0] == 1000 && out[3] == 1003 && a == 4, "partial n=%u a=%u", n, a);
+  n = edge_ring_read(&r, &a, out, 16, &lost);
+  CHECK(n == 6 && out[0] == 1004 && out[5] == 1009 && a == 10, "rest n=%u a=%u", n, a);
+  n = edge_ring_read(&r, &a, out, 16, &lost);
+  CHECK(n == 0 && a == 10, "empty n=%u", n);
+
+  n = edge_ring_read(&r, &b, out, 16, &lost);
+  CHECK(n == 10 && out[0] == 1000 && b == 10, "second consumer n=%u", n);
+  CHECK(lost == 0, "lost %u", lost);
+}
+
+static void test_overrun(void)
+{
+  printf("== consumer falls behind\n");
+  static uint32_t buf[8];
+  EdgeRing r = {};
+  edge_ring_init(&r, buf, 8);
+  for (uint32_t i = 0; i < 20; i++) edge_ring_push(&r, i);
+
+  uint32_t cur = 0, lost = 0, out[8];
+  uint32_t n = edge_ring_read(&r, &cur, out, 8, &lost);
+  CHECK(lost == 12, "lost %u", lost);
+  CHECK(n == 8 && out[0] == 12 && out[7] == 19 && cur == 20, "n=%u first=%u cur=%u", n, out[0], cur);
+  CHECK(edge_ring_tail(&r) == 12, "tail %u", edge_ring_tail(&r));
+
+  // Cursor from the future (ring re-initialised): restarts at head
+  cur = 1000;
+  n = edge_ring_read(&r, &cur, out, 8, &lost);
+  CHECK(n == 0 && cur == 20, "stale cursor n=%u cur=%u", n, cur);
+}
+
+static void test_head_wrap(void)
+{
+  printf("== head wraps at 2^32\n");
+  static uint32_t buf[8];
+  EdgeRing r = {};
+  edge_ring_init(&r, buf, 8);
+  r.head = 0xFFFFFFFCu;
+  uint32_t cur = r.head, lost = 0, out[8];
+  for (uint32_t i = 0; i < 6; i++) edge_ring_push(&r, 500 + i);
+  uint32_t n = edge_ring_read(&r, &cur, out, 8, &lost);
+  CHECK(n == 6 && out[0] == 500 && out[5] == 505 && cur == 2 && lost == 0,
+        "n=%u cur=%u lost=%u", n, cur, lost);
+}
+
+static void test_concurrent(void)
+{
+  printf("== producer thread vs consumer\n");
+  static uint32_t buf[64];
+  EdgeRing r = {};
+  edge_ring_init(&r, buf, 64);
+  const uint32_t total = 2000000;
+  std::atomic<bool> done(false);
+
+  std::thread producer([&]() {
+    for (uint32_t i = 1; i <= total; i++) {
+      edge_ring_push(&r, i);
+      if ((i & 31) == 0) std::this_thread::yield();  // Let the consumer in on 1 core
+    }
+    done = true;
+  });
+
+  uint32_t cur = 0, lost = 0, got = 0, last = 0, bad = 0, out[16];
+  for (;;) {
+    bool finished = done;
+    uint32_t before = lost;
+    uint32_t n = edge_ring_read(&r, &cur, out, 16, &lost);
+    for (uint32_t i = 0; i < n; i++) {
+      // Values are 1..total in push order: each must be the previous one
+      // plus the edges reported lost in between
+      uint32_t expect = last + 1 + (i == 0 ? lost - before : 0);
+      if (out[i] != expect) bad++;
+      last = out[i];
+    }
+    got += n;
+    if (finished && n == 0) break;
+  }
+  producer.join();
+
+  printf("   read %u, lost %u\n", got, lost);
+  CHECK(bad == 0, "%u out-of-sequence timestamps", bad);
+  CHECK(got + lost == total, "read %u + lost %u != %u", got, lost, total);
+}
+
+int main(void)
+{
+  test_init();
+  test_drain_and_consumers();
+  test_overrun();
+  test_head_wrap();
+  test_concurrent();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file flash_emu.h
+ * @brief File-backed NOR flash emulator for host tests
+ *
+ * Maps a regular file (MAP_SHARED), so the "flash" outlives the process and
+ * a remount really starts from what is on disk. NOR rules are enforced:
+ * erase sets a sector to 0xFF, write can only clear bits — an attempt to set
+ * a programmed 0 back to 1 is counted as a violation (and not applied).
+ *
+ * Power cuts: budget is the number of bytes that may still be programmed
+ * (an erase costs sector / 64). When it runs out the operation stops half
+ * way — a write leaves a programmed prefix, an erase an erased prefix (or
+ * suffix, erase_from_end) — and every later operation fails until
+ * flash_emu_power_cycle().
+ */
+
+#ifndef FLASH_EMU_H
+#define FLASH_EMU_H
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+typedef struct {
+  int fd;
+  uint8_t *mem;
+  uint32_t size;
+  uint32_t sector_size;
+  long budget;              // Bytes left before the power cut, < 0 = unlimited
+  bool erase_from_end;      // Interrupted erases clear the tail first
+  bool dead;                // Power is off: every operation fails
+  uint32_t violations;      // Writes that needed a 0 → 1 transition
+  uint32_t writes;
+  uint32_t erases;
+  uint32_t sector_erases[64];
+} FlashEmu;
+
+static inline bool flash_emu_open(FlashEmu *f, const char *path, uint32_t size,
+                                  uint32_t sector_size, bool fresh)
+{
+  memset(f, 0, sizeof(*f));
+  f->fd = open(path, O_RDWR | O_CREAT | (fresh ? O_TRUNC : 0), 0600);
+  if (f->fd < 0) return false;
+  if (ftruncate(f->fd, size) != 0) return false;
+  void *m = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, f->fd, 0);
+  if (m == MAP_FAILED) return false;
+  f->mem = (uint8_t *)m;
+  f->size = size;
+  f->sector_size = sector_size;
+  f->budget = -1;
+  if (fresh) memset(f->mem, 0xFF, size);
+  return true;
+}
+
+static inline void flash_emu_close(FlashEmu *f)
+{
+  if (f->mem) {
+    msync(f->mem, f->size, MS_SYNC);
+    munmap(f->mem, f->size);
+  }
+  if (f->fd >= 0) close(f->fd);
+  f->mem = NULL;
+  f->fd = -1;
+}
+
+static inline void flash_emu_power_cycle(FlashEmu *f)
+{
+  f->dead = false;
+  f->budget = -1;
+}
+
+static inline bool flash_emu_read(void *ctx, uint32_t addr, void *buf, uint32_t len)
+{
+  FlashEmu *f = (FlashEmu *)ctx;
+  if (f->dead || addr + len > f->size) return false;
+  memcpy(buf, f->mem + addr, len);
+  return true;
+}
+
+static inline bool flash_emu_write(void *ctx, uint32_t addr, const void *buf, uint32_t len)
+{
+  FlashEmu *f = (FlashEmu *)ctx;
+  if (f->dead || addr + len > f->size) return false;
+  const uint8_t *src = (const uint8_t *)buf;
+  f->writes++;
+  for (uint32_t i = 0; i < len; i++) {
+    if (f->budget == 0) {
+      f->dead = true;
+      return false;
+    }
+    if (f->budget > 0) f->budget--;
+    uint8_t cur = f->mem[addr + i];
+    if ((cur & src[i]) != src[i]) f->violations++;
+    f->mem[addr + i] = cur & src[i];
+  }
+  return true;
+}
+
+static inline bool flash_emu_erase(void *ctx, uint32_t addr)
+{
+  FlashEmu *f = (FlashEmu *)ctx;
+  if (f->dead || addr % f->sector_size != 0 || addr + f->sector_size > f->size) return false;
+  uint32_t cost = f->sector_size / 64;
+  if (f->budget >= 0 && (uint32_t)f->budget < cost) {
+    uint32_t done = (uint32_t)f->budget * 64;
+    if (f->erase_from_end) {
+      memset(f->mem + addr + f->sector_size - done, 0xFF, done);
+    } else {
+      memset(f->mem + addr, 0xFF, done);
+    }
+    f->budget = 0;
+    f->dead = true;
+    return false;
+  }
+  if (f->budget > 0) f->budget -= cost;
+  memset(f->mem + addr, 0xFF, f->sector_size);
+  f->erases++;
+  uint32_t s = addr / f->sector_size;
+  if (s < 64) f->sector_erases[s]++;
+  return true;
+}
+
+#endif // FLASH_EMU_H
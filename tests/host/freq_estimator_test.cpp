@@ -0,0 +1,182 @@
+/**
+ * @file freq_estimator_test.cpp
+ * @brief Host test for the reciprocal frequency estimator (FEAT-154)
+ *
+ * Feeds synthetic edge streams (exact and loop-sampled timestamps, jitter,
+ * micros() wrap, stop/timeout) through freq_est_update() the same way
+ * counter_frequency_update() does: one call per main loop pass.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "freq_estimator.h"
+#include "host_test.h"
+
+typedef struct {
+  double   hz;            // Input frequency
+  double   jitter_us;     // +/- uniform edge jitter
+  uint32_t loop_us;       // Main loop period (estimator call interval)
+  bool     exact_edges;   // true: ISR timestamps, false: count sampled per loop
+  uint32_t start_us;      // Initial micros() value (wrap tests)
+  double   duration_s;
+} Stream;
+
+typedef struct {
+  uint32_t freq_mhz;
+  uint8_t  method;
+  uint32_t updates;       // Measurements closed
+  double   max_err;       // Max relative error over closed measurements (after warm-up)
+} Result;
+
+// Simulate: edges at start + k/hz (+ jitter), estimator called every loop_us
+static Result run_stream(const Stream *s, const FreqEstConfig *cfg)
+{
+  FreqEstimator st;
+  freq_est_reset(&st, 0);
+
+  Result r = {0, 0, 0, 0.0};
+  double period_us = 1e6 / s->hz;
+  double next_edge = period_us * 0.37;  // Arbitrary phase
+  uint32_t edge_count = 0;
+  uint32_t edge_us = s->start_us;
+  uint64_t total_us = (uint64_t)(s->duration_s * 1e6);
+  uint32_t seen_count = 0;
+  uint32_t seen_us = s->start_us;
+
+  for (uint64_t t = 0; t <= total_us; t += s->loop_us) {
+    // Deliver all edges up to t
+    while (next_edge <= (double)t) {
+      double j = s->jitter_us * (2.0 * rand() / RAND_MAX - 1.0);
+      edge_count++;
+      edge_us = s->start_us + (uint32_t)(uint64_t)(next_edge + j);
+      next_edge += period_us;
+    }
+    uint32_t now = s->start_us + (uint32_t)t;
+    // Sampled mode: a count change is only seen (and stamped) at loop time
+    if (!s->exact_edges && edge_count != seen_count) {
+      seen_count = edge_count;
+      seen_us = now;
+    }
+    uint32_t stamp = s->exact_edges ? edge_us : seen_us;
+
+    if (freq_est_update(&st, cfg, edge_count, stamp, now)) {
+      r.updates++;
+      double err = fabs(st.freq_mhz / 1000.0 - s->hz) / s->hz;
+      if (r.updates > 1 && err > r.max_err) r.max_err = err;
+    }
+  }
+  r.freq_mhz = st.freq_mhz;
+  r.method = st.method;
+  return r;
+}
+
+static void test_low_rate_period(void)
+{
+  printf("== 0.5 Hz flow meter, exact edges\n");
+  FreqEstConfig cfg = {100000, 10000000};
+  Stream s = {0.5, 0.0, 1000, true, 0, 20.0};
+  Result r = run_stream(&s, &cfg);
+  printf("   %.4f Hz, %u updates, max err %.2e\n", r.freq_mhz / 1000.0, r.updates, r.max_err);
+  CHECK(r.method == FREQ_EST_PERIOD || r.method == FREQ_EST_DECAY, "method %u", r.method);
+  CHECK(r.updates >= 8, "expected one update per period, got %u", r.updates);
+  CHECK(r.max_err < 1e-4, "error %.2e", r.max_err);
+}
+
+static void test_fractional_hz(void)
+{
+  printf("== 2.5 Hz: gate method would read 2 or 3\n");
+  FreqEstConfig cfg = {100000, 10000000};
+  Stream s = {2.5, 0.0, 1000, true, 0, 10.0};
+  Result r = run_stream(&s, &cfg);
+  printf("   %.4f Hz\n", r.freq_mhz / 1000.0);
+  CHECK(r.max_err < 1e-4, "error %.2e", r.max_err);
+}
+
+static void test_high_rate_gate(void)
+{
+  printf("== 10 kHz, exact edges, 100 ms gate\n");
+  FreqEstConfig cfg = {100000, 10000000};
+  Stream s = {10000.0, 0.0, 1000, true, 0, 2.0};
+  Result r = run_stream(&s, &cfg);
+  printf("   %.3f Hz, %u updates, max err %.2e\n", r.freq_mhz / 1000.0, r.updates, r.max_err);
+  CHECK(r.method == FREQ_EST_GATE, "method %u", r.method);
+  CHECK(r.updates >= 18, "expected ~10 updates/s, got %u", r.updates);
+  CHECK(r.max_err < 2e-5, "error %.2e", r.max_err);
+}
+
+static void test_jitter(void)
+{
+  printf("== 1234.5 Hz with +/-5 us edge jitter\n");
+  FreqEstConfig cfg = {100000, 10000000};
+  Stream s = {1234.5, 5.0, 1000, true, 0, 3.0};
+  Result r = run_stream(&s, &cfg);
+  printf("   %.3f Hz, max err %.2e\n", r.freq_mhz / 1000.0, r.max_err);
+  CHECK(r.max_err < 2e-4, "error %.2e", r.max_err);
+}
+
+static void test_sampled(void)
+{
+  printf("== 3.7 Hz, count sampled every 10 ms loop, 1 s gate\n");
+  FreqEstConfig cfg = {1000000, 10000000};
+  Stream s = {3.7, 0.0, 10000, false, 0, 20.0};
+  Result r = run_stream(&s, &cfg);
+  printf("   %.4f Hz, max err %.2e\n", r.freq_mhz / 1000.0, r.max_err);
+  // Error bounded by loop period / gate span (~10 ms / ~1 s)
+  CHECK(r.max_err < 0.02, "error %.2e", r.max_err);
+}
+
+static void test_wrap(void)
+{
+  printf("== 50 Hz across micros() wrap\n");
+  FreqEstConfig cfg = {100000, 10000000};
+  Stream s = {50.0, 0.0, 1000, true, 0xFFFFFFFFu - 1500000u, 4.0};
+  Result r = run_stream(&s, &cfg);
+  printf("   %.4f Hz, max err %.2e\n", r.freq_mhz / 1000.0, r.max_err);
+  CHECK(r.max_err < 1e-4, "error %.2e", r.max_err);
+}
+
+static void test_stop_decay_timeout(void)
+{
+  printf("== 10 Hz then input stops\n");
+  FreqEstConfig cfg = {100000, 5000000};
+  FreqEstimator st;
+  freq_est_reset(&st, 0);
+
+  uint32_t count = 0, edge_us = 0;
+  for (uint32_t t = 0; t <= 2000000; t += 1000) {
+    if (t % 100000 == 0 && t > 0) { count++; edge_us = t; }
+    freq_est_update(&st, &cfg, count, edge_us, t);
+  }
+  CHECK(llabs((long long)st.freq_mhz - 10000) <= 1, "steady %u mHz", st.freq_mhz);
+
+  // 1 s after last edge: estimate must be <= 1 Hz (period is at least 1 s)
+  freq_est_update(&st, &cfg, count, edge_us, edge_us + 1000000);
+  CHECK(st.freq_mhz <= 1000 && st.method == FREQ_EST_DECAY, "decay %u mHz method %u",
+        st.freq_mhz, st.method);
+
+  freq_est_update(&st, &cfg, count, edge_us, edge_us + 5000000);
+  CHECK(st.freq_mhz == 0 && st.method == FREQ_EST_NONE, "timeout %u mHz", st.freq_mhz);
+
+  // Restart: first edge only re-arms, second edge measures
+  CHECK(!freq_est_update(&st, &cfg, count + 1, edge_us + 6000000, edge_us + 6000000), "re-arm");
+  CHECK(freq_est_update(&st, &cfg, count + 2, edge_us + 6500000, edge_us + 6500000), "measure");
+  CHECK(st.freq_mhz == 2000, "restart %u mHz", st.freq_mhz);
+}
+
+int main(void)
+{
+  srand(1);
+  test_low_rate_period();
+  test_fractional_hz();
+  test_high_rate_gate();
+  test_jitter();
+  test_sampled();
+  test_wrap();
+  test_stop_decay_timeout();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
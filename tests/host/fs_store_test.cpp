@@ -0,0 +1,222 @@
+/**
+ * @file fs_store_test.cpp
+ * @brief Host test for the file store with atomic replace (FEAT-172)
+ *
+ * Runs the store against a temporary directory. Covers streamed and whole
+ * file round trips, replace keeps the old content until the commit, abort
+ * and write errors leave the target untouched, a reset before the rename
+ * (stale .tmp cleaned up by fs_store_recover), name/root validation, the
+ * one-time import from another directory (migration) and the throughput
+ * counters. Prints measured read/write throughput for this host.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "fs_store.h"
+#include "host_test.h"
+
+static uint32_t host_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+static char root[64];
+static char spiffs[64];
+
+// Content of a file in the store, as a string (empty if missing)
+static const char *content(const char *name) {
+  static char buf[256];
+  buf[0] = '\0';
+  FsReader r;
+  if (!fs_read_open(&r, name)) return buf;
+  uint32_t n = fs_read(&r, buf, sizeof(buf) - 1);
+  buf[n] = '\0';
+  fs_read_close(&r);
+  return buf;
+}
+
+static bool host_file_exists(const char *dir, const char *name) {
+  char path[160];
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  struct stat st;
+  return stat(path, &st) == 0;
+}
+
+static void host_write(const char *dir, const char *name, const void *data, size_t len) {
+  char path[160];
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  FILE *f = fopen(path, "wb");
+  if (f) {
+    fwrite(data, 1, len, f);
+    fclose(f);
+  }
+}
+
+static void test_init(void) {
+  printf("== init and names\n");
+  CHECK(!fs_store_init("/nonexistent/fs_store_test", host_us), "missing root rejected");
+  CHECK(!fs_store_ready(), "not ready");
+  CHECK(!fs_write_file("/a", "x", 1), "no writes without root");
+  CHECK(!fs_store_init("/tmp/this/root/path/is/longer/than/the/limit", host_us), "long root rejected");
+  CHECK(fs_store_init(root, host_us), "init %s", root);
+  CHECK(!fs_write_file("no_slash", "x", 1), "name without / rejected");
+  CHECK(!fs_write_file("/a_name_that_is_much_too_long_for_the_store.dat", "x", 1), "long name rejected");
+  CHECK(fs_size("/missing") == -1, "size of missing file");
+  CHECK(fs_remove("/missing"), "removing a missing file is ok");
+}
+
+static void test_round_trip(void) {
+  printf("== round trip and replace\n");
+  CHECK(fs_write_file("/logic_0.dat", "first", 5), "write");
+  CHECK(fs_size("/logic_0.dat") == 5, "size %d", (int)fs_size("/logic_0.dat"));
+  CHECK(!strcmp(content("/logic_0.dat"), "first"), "content '%s'", content("/logic_0.dat"));
+
+  // Streamed replace: old content visible until the commit
+  FsWriter w;
+  CHECK(fs_write_open(&w, "/logic_0.dat"), "open");
+  fs_write(&w, "second", 6);
+  CHECK(!strcmp(content("/logic_0.dat"), "first"), "old content during write");
+  fs_write(&w, " version", 8);
+  CHECK(fs_write_commit(&w), "commit");
+  CHECK(!strcmp(content("/logic_0.dat"), "second version"), "new content '%s'", content("/logic_0.dat"));
+  CHECK(!host_file_exists(root, "logic_0.dat.tmp"), "no temp file after commit");
+
+  // Empty file is a valid file
+  CHECK(fs_write_file("/empty", "", 0) && fs_size("/empty") == 0, "empty file");
+
+  CHECK(fs_remove("/logic_0.dat") && !fs_exists("/logic_0.dat"), "remove");
+}
+
+static void test_abort(void) {
+  printf("== abort, write error, reset before rename\n");
+  fs_write_file("/logic_1.dat", "keep", 4);
+  uint32_t aborts = fs_store_stats()->aborts;
+
+  FsWriter w;
+  fs_write_open(&w, "/logic_1.dat");
+  fs_write(&w, "discard", 7);
+  fs_write_abort(&w);
+  CHECK(!strcmp(content("/logic_1.dat"), "keep"), "abort keeps old content");
+  CHECK(!host_file_exists(root, "logic_1.dat.tmp"), "abort removes temp");
+  CHECK(fs_store_stats()->aborts == aborts + 1, "abort counted");
+
+  // A write error poisons the commit
+  uint32_t errors = fs_store_stats()->errors;
+  fs_write_open(&w, "/logic_1.dat");
+  fs_write(&w, "part", 4);
+  w.err = true;
+  CHECK(!fs_write(&w, "more", 4), "write after error refused");
+  CHECK(!fs_write_commit(&w), "commit after error fails");
+  CHECK(!strcmp(content("/logic_1.dat"), "keep"), "failed commit keeps old content");
+  CHECK(!host_file_exists(root, "logic_1.dat.tmp"), "failed commit removes temp");
+  CHECK(fs_store_stats()->errors == errors + 1, "error counted");
+
+  // Reset between write and rename: the temp file is left behind
+  fs_write_open(&w, "/logic_1.dat");
+  fs_write(&w, "half", 4);
+  fflush(w.f);
+  fclose(w.f);  // "reset": no commit
+  CHECK(host_file_exists(root, "logic_1.dat.tmp"), "stale temp present");
+  fs_store_init(root, host_us);  // Next boot
+  CHECK(fs_store_recover() == 1, "one stale temp removed");
+  CHECK(fs_store_stats()->stale_tmp == 1, "stale temp counted");
+  CHECK(!strcmp(content("/logic_1.dat"), "keep"), "old content after reset");
+  CHECK(fs_store_recover() == 0, "nothing left to recover");
+}
+
+static void test_import(void) {
+  printf("== one-time import (migration)\n");
+  char src[2000];
+  for (size_t i = 0; i < sizeof(src); i++) src[i] = (char)('A' + i % 26);
+  host_write(spiffs, "logic_0.dat", src, sizeof(src));
+  host_write(spiffs, "logic_2.dat", "prog2", 5);
+  host_write(spiffs, "logic_2.bc", "\x01\x02\x03", 3);
+  host_write(spiffs, "junk.tmp", "x", 1);
+  char sub[96];
+  snprintf(sub, sizeof(sub), "%s/subdir", spiffs);
+  mkdir(sub, 0700);
+
+  FsImport imp;
+  CHECK(fs_import_collect(&imp, spiffs), "collect");
+  CHECK(imp.count == 3, "files %u", imp.count);
+  CHECK(imp.bytes == sizeof(src) + 5 + 3, "bytes %u", (unsigned)imp.bytes);
+  CHECK(fs_import_write(&imp) == 3, "all written");
+  fs_import_free(&imp);
+  CHECK(imp.count == 0, "freed");
+
+  CHECK(fs_size("/logic_0.dat") == (int32_t)sizeof(src), "large file size");
+  FsReader r;
+  char back[sizeof(src)];
+  fs_read_open(&r, "/logic_0.dat");
+  CHECK(fs_read(&r, back, sizeof(back)) == sizeof(back) && !memcmp(back, src, sizeof(src)), "large file content");
+  fs_read_close(&r);
+  CHECK(!strcmp(content("/logic_2.dat"), "prog2"), "small file content");
+  CHECK(fs_size("/logic_2.bc") == 3, "binary file");
+  CHECK(!fs_exists("/junk.tmp"), "temp files not imported");
+
+  CHECK(!fs_import_collect(&imp, "/nonexistent/spiffs"), "missing source dir");
+  CHECK(imp.count == 0, "nothing kept");
+
+  // Too many files: nothing is kept (caller must not format the source)
+  for (int i = 0; i < FS_IMPORT_MAX_FILES + 1; i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "f%02d", i);
+    host_write(spiffs, name, "y", 1);
+  }
+  CHECK(!fs_import_collect(&imp, spiffs), "too many files refused");
+  CHECK(imp.count == 0, "nothing kept after refusal");
+}
+
+static void test_throughput(void) {
+  printf("== throughput\n");
+  static uint8_t buf[16 * 1024];
+  for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(i * 7);
+  fs_store_init(root, host_us);
+
+  const int files = 32;
+  for (int i = 0; i < files; i++) fs_write_file("/bench.bin", buf, sizeof(buf));
+  for (int i = 0; i < files; i++) {
+    FsReader r;
+    fs_read_open(&r, "/bench.bin");
+    while (fs_read(&r, buf, 4096) == 4096) {}
+    fs_read_close(&r);
+  }
+  const FsStats *s = fs_store_stats();
+  CHECK(s->commits == (uint32_t)files, "commits %u", (unsigned)s->commits);
+  CHECK(s->write_bytes == files * sizeof(buf), "write bytes %u", (unsigned)s->write_bytes);
+  CHECK(s->reads == (uint32_t)files && s->read_bytes == files * sizeof(buf), "read bytes %u", (unsigned)s->read_bytes);
+  printf("  write %u KB/s (incl. fsync + rename), read %u KB/s\n",
+         (unsigned)fs_kb_per_s(s->write_bytes, s->write_us),
+         (unsigned)fs_kb_per_s(s->read_bytes, s->read_us));
+  CHECK(fs_kb_per_s(1024, 1000000) == 1, "1 KB/s");
+  CHECK(fs_kb_per_s(123, 0) == 0, "no time measured");
+}
+
+int main(void) {
+  snprintf(root, sizeof(root), "/tmp/fsst_XXXXXX");
+  snprintf(spiffs, sizeof(spiffs), "/tmp/fssp_XXXXXX");
+  if (!mkdtemp(root) || !mkdtemp(spiffs)) {
+    printf("cannot create temp dirs\n");
+    return 1;
+  }
+
+  test_init();
+  test_round_trip();
+  test_abort();
+  test_import();
+  test_throughput();
+
+  char cmd[160];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s %s", root, spiffs);
+  if (system(cmd) != 0) printf("  (temp dirs not removed)\n");
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+/**
+ * @file gpio_plan_test.cpp
+ * @brief Host test for the precomputed GPIO mapping plan (FEAT-161)
+ *
+ * Builds random var_maps[] tables (duplicates, unset registers, counter and
+ * timer owned entries, virtual and invalid pins) and checks that one plan
+ * pass gives exactly the discrete inputs and pin levels of the per-pin loop
+ * it replaces, then times both on a full 32-entry table. Pins in interrupt
+ * mode (FEAT-163) must drop out of the polled runs and be listed as irq
+ * inputs; applying those at the pin level gives the same result.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gpio_plan.h"
+#include "host_test.h"
+
+#define MAPS 32
+
+static uint8_t di_plan[DISCRETE_INPUTS_SIZE];
+
+static void store_di(uint8_t byte, uint8_t mask, uint8_t bits)
+{
+  di_plan[byte] = (uint8_t)((di_plan[byte] & ~mask) | bits);
+}
+
+/* ---- Reference: the per-pin loop gpio_mapping used before the plan ---- */
+
+static uint8_t ref_read(uint64_t image, uint8_t pin)
+{
+  uint8_t bit = gpio_plan_pin_bit(pin, false);
+  return (bit == 0xFF) ? 0 : (uint8_t)((image >> bit) & 1);
+}
+
+static void ref_inputs(const VariableMapping *maps, uint8_t count, uint64_t image, uint8_t *di)
+{
+  for (uint8_t i = 0; i < count; i++) {
+    const VariableMapping *m = &maps[i];
+    if (m->source_type != MAPPING_SOURCE_GPIO) continue;
+    if (m->associated_counter != 0xff || m->associated_timer != 0xff) continue;
+    if (!m->is_input || m->input_reg == 65535) continue;
+    if (m->input_reg >= DISCRETE_INPUTS_SIZE * 8) continue;
+    uint8_t v = ref_read(image, m->gpio_pin);
+    if (v) di[m->input_reg / 8] |= (uint8_t)(1u << (m->input_reg % 8));
+    else di[m->input_reg / 8] &= (uint8_t)~(1u << (m->input_reg % 8));
+  }
+}
+
+// Returns the written pins in *written, their levels in the result
+static uint64_t ref_outputs(const VariableMapping *maps, uint8_t count, const uint8_t *coils,
+                            uint64_t *written)
+{
+  uint64_t out = 0;
+  *written = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    const VariableMapping *m = &maps[i];
+    if (m->source_type != MAPPING_SOURCE_GPIO) continue;
+    if (m->associated_counter != 0xff || m->associated_timer != 0xff) continue;
+    if (m->is_input || m->coil_reg == 65535) continue;
+    uint8_t bit = gpio_plan_pin_bit(m->gpio_pin, true);
+    if (bit == 0xFF) continue;
+    uint8_t v = (m->coil_reg < COILS_SIZE * 8) ? (coils[m->coil_reg / 8] >> (m->coil_reg % 8)) & 1 : 0;
+    *written |= 1ULL << bit;
+    if (v) out |= 1ULL << bit;
+    else out &= ~(1ULL << bit);
+  }
+  return out;
+}
+
+/* ---- Random tables ---- */
+
+static uint8_t rand_pin(void)
+{
+  switch (rand() % 6) {
+    case 0:  return VGPIO_SR_INPUT_BASE + rand() % (VGPIO_SR_INPUT_COUNT + 1);
+    case 1:  return VGPIO_SR_OUTPUT_BASE + rand() % (VGPIO_SR_OUTPUT_COUNT + 1);
+    case 2:  return (uint8_t)(rand() % 256);
+    default: return (uint8_t)(rand() % 40);
+  }
+}
+
+static uint16_t rand_reg(void)
+{
+  switch (rand() % 8) {
+    case 0:  return 65535;
+    case 1:  return (uint16_t)(250 + rand() % 20);   // Around the table end
+    case 2:  return (uint16_t)(rand() % 256);
+    default: return (uint16_t)(rand() % 16);        // Dense: duplicates and runs
+  }
+}
+
+static void rand_maps(VariableMapping *maps, uint8_t count)
+{
+  memset(maps, 0, sizeof(VariableMapping) * count);
+  for (uint8_t i = 0; i < count; i++) {
+    VariableMapping *m = &maps[i];
+    m->source_type = (rand() % 8) ? MAPPING_SOURCE_GPIO : MAPPING_SOURCE_ST_VAR;
+    m->gpio_pin = rand_pin();
+    m->associated_counter = (rand() % 10) ? 0xff : 1;
+    m->associated_timer = (rand() % 10) ? 0xff : 2;
+    m->is_input = rand() % 2;
+    m->input_reg = m->is_input ? rand_reg() : 65535;
+    m->coil_reg = m->is_input ? 65535 : rand_reg();
+  }
+}
+
+static uint64_t rand64(void)
+{
+  uint64_t v = 0;
+  for (int k = 0; k < 4; k++) v = (v << 16) ^ (uint64_t)(rand() & 0xFFFF);
+  return v & ~(1ULL << GPIO_PLAN_ZERO_BIT);
+}
+
+// What the pin interrupt handler does: store the pin level in its DI bits
+static void apply_irq_inputs(const gpio_plan_t *plan, uint64_t image)
+{
+  for (uint8_t i = 0; i < plan->irq_input_count; i++) {
+    const gpio_plan_irq_t *q = &plan->irq_inputs[i];
+    uint8_t bits = ((image >> q->pin) & 1) ? q->mask : 0;
+    store_di(q->byte, q->mask, bits);
+  }
+}
+
+static void test_random(void)
+{
+  printf("== random tables: plan vs per-pin loop\n");
+  srand(11);
+  VariableMapping maps[MAPS];
+  gpio_plan_t plan;
+  long in_bad = 0, out_bad = 0, irq_bad = 0, rounds = 20000;
+
+  for (long r = 0; r < rounds; r++) {
+    uint8_t count = (uint8_t)(rand() % (MAPS + 1));
+    rand_maps(maps, count);
+    uint64_t irq_pins = (rand() % 2) ? rand64() : 0;
+    gpio_plan_build(&plan, maps, count, irq_pins);
+    if ((plan.in_mask & plan.irq_mask) != 0 || (plan.irq_mask & ~(irq_pins & GPIO_PLAN_PORT_MASK)) != 0) {
+      irq_bad++;
+    }
+
+    for (int k = 0; k < 4; k++) {
+      uint64_t image = rand64();
+      uint8_t di_ref[DISCRETE_INPUTS_SIZE];
+      for (int b = 0; b < DISCRETE_INPUTS_SIZE; b++) di_ref[b] = di_plan[b] = (uint8_t)rand();
+      ref_inputs(maps, count, image, di_ref);
+      gpio_plan_scatter_inputs(&plan, image, store_di);
+      apply_irq_inputs(&plan, image);
+      if (memcmp(di_ref, di_plan, sizeof(di_ref)) != 0) in_bad++;
+
+      uint8_t coils[COILS_SIZE];
+      for (int b = 0; b < COILS_SIZE; b++) coils[b] = (uint8_t)rand();
+      uint64_t written;
+      uint64_t ref = ref_outputs(maps, count, coils, &written);
+      uint64_t out = gpio_plan_gather_outputs(&plan, coils);
+      if (written != plan.out_mask || ((out ^ ref) & written) != 0) out_bad++;
+    }
+  }
+  CHECK(in_bad == 0, "%ld input mismatches", in_bad);
+  CHECK(out_bad == 0, "%ld output mismatches", out_bad);
+  CHECK(irq_bad == 0, "%ld tables with interrupt pins left in the polled runs", irq_bad);
+}
+
+static void test_irq_split(void)
+{
+  printf("== interrupt pins leave the polled runs\n");
+  VariableMapping maps[4];
+  memset(maps, 0, sizeof(maps));
+  // GPIO 4 -> DI 0, GPIO 5 -> DI 1, GPIO 4 -> DI 9 (one pin, two inputs)
+  const uint8_t pins[3] = {4, 5, 4};
+  const uint16_t dis[3] = {0, 1, 9};
+  for (uint8_t i = 0; i < 3; i++) {
+    maps[i] = (VariableMapping){ MAPPING_SOURCE_GPIO, pins[i], 0xff, 0xff,
+                                 0xff, 0, 1, 1, 0, dis[i], 65535, 1 };
+  }
+  gpio_plan_t plan;
+  gpio_plan_build(&plan, maps, 3, (1ULL << 4) | (1ULL << 60));
+  CHECK(plan.irq_input_count == 2 && plan.irq_mask == (1ULL << 4), "irq %u mask %llx",
+        plan.irq_input_count, (unsigned long long)plan.irq_mask);
+  CHECK(plan.irq_inputs[0].byte == 0 && plan.irq_inputs[0].mask == 0x01 &&
+        plan.irq_inputs[1].byte == 1 && plan.irq_inputs[1].mask == 0x02, "irq inputs");
+  CHECK(plan.in_run_count == 1 && plan.in_mask == (1ULL << 5), "polled runs %u mask %llx",
+        plan.in_run_count, (unsigned long long)plan.in_mask);
+  CHECK(plan.gpio_inputs == 3, "inputs %u", plan.gpio_inputs);
+}
+
+static void test_runs(void)
+{
+  printf("== contiguous mappings collapse into one run\n");
+  VariableMapping maps[16];
+  memset(maps, 0, sizeof(maps));
+  for (uint8_t i = 0; i < 8; i++) {
+    // SR inputs IN1-IN8 -> DI 0-7, coils 8-15 -> relays CH1-CH8
+    maps[i] = (VariableMapping){ MAPPING_SOURCE_GPIO, (uint8_t)(VGPIO_SR_INPUT_BASE + i), 0xff, 0xff,
+                                 0xff, 0, 1, 1, 0, (uint16_t)i, 65535, 1 };
+    maps[8 + i] = (VariableMapping){ MAPPING_SOURCE_GPIO, (uint8_t)(VGPIO_SR_OUTPUT_BASE + i), 0xff, 0xff,
+                                     0xff, 0, 0, 0, 1, 65535, (uint16_t)(8 + i), 1 };
+  }
+  gpio_plan_t plan;
+  gpio_plan_build(&plan, maps, 16, 0);
+  CHECK(plan.in_run_count == 1 && plan.in_runs[0].mask == 0xFF, "in runs %u", plan.in_run_count);
+  CHECK(plan.out_run_count == 1 && plan.out_runs[0].mask == 0xFF, "out runs %u", plan.out_run_count);
+  CHECK(plan.gpio_inputs == 8 && plan.gpio_outputs == 8, "counts %u/%u",
+        plan.gpio_inputs, plan.gpio_outputs);
+  CHECK(plan.in_mask == 0xFFULL << GPIO_PLAN_SR_IN_BIT, "in_mask %llx",
+        (unsigned long long)plan.in_mask);
+}
+
+static void test_timing(void)
+{
+  printf("== timing, 32 mappings\n");
+  srand(3);
+  VariableMapping maps[MAPS];
+  rand_maps(maps, MAPS);
+  for (uint8_t i = 0; i < MAPS; i++) {
+    maps[i].source_type = MAPPING_SOURCE_GPIO;
+    maps[i].associated_counter = maps[i].associated_timer = 0xff;
+  }
+  gpio_plan_t plan;
+  gpio_plan_build(&plan, maps, MAPS, 0);
+
+  const long n = 2000000;
+  uint8_t coils[COILS_SIZE] = {0x5A, 0xA5};
+  uint8_t di_ref[DISCRETE_INPUTS_SIZE] = {0};
+  volatile uint64_t sink = 0;
+
+  clock_t c0 = clock();
+  for (long i = 0; i < n; i++) {
+    uint64_t written;
+    ref_inputs(maps, MAPS, (uint64_t)i * 0x9E3779B97F4A7C15ULL, di_ref);
+    sink += ref_outputs(maps, MAPS, coils, &written);
+  }
+  double t_ref = (double)(clock() - c0) / CLOCKS_PER_SEC;
+
+  c0 = clock();
+  for (long i = 0; i < n; i++) {
+    gpio_plan_scatter_inputs(&plan, (uint64_t)i * 0x9E3779B97F4A7C15ULL, store_di);
+    sink += gpio_plan_gather_outputs(&plan, coils);
+  }
+  double t_plan = (double)(clock() - c0) / CLOCKS_PER_SEC;
+
+  printf("   per-pin %.1f ns/cycle, plan %.1f ns/cycle (%u in runs, %u out runs)\n",
+         t_ref * 1e9 / n, t_plan * 1e9 / n, plan.in_run_count, plan.out_run_count);
+  (void)sink;
+}
+
+int main(void)
+{
+  test_random();
+  test_runs();
+  test_irq_split();
+  test_timing();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
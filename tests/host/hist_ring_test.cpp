@@ -0,0 +1,265 @@
+/**
+ * @file hist_ring_test.cpp
+ * @brief Host test for the historian ring and downsampling tiers (FEAT-173)
+ *
+ * Round trip of raw samples across block boundaries, extreme deltas,
+ * eviction of the oldest blocks, a gap (missed samples) and clock jitter,
+ * range filtering, min/max/avg tier buckets, the memory split between
+ * tiers, corrupt blocks and the bytes per sample of a slowly changing
+ * register (printed).
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hist_ring.h"
+#include "host_test.h"
+
+#define MAX_RECS  20000
+
+typedef struct {
+  uint32_t n;
+  uint64_t t[MAX_RECS];
+  int64_t  v[MAX_RECS][HIST_FIELDS_MAX];
+  uint32_t stop_after;  // 0 = never
+} Collect;
+
+static bool collect_fn(void *ctx, uint64_t t_ms, const int64_t *v) {
+  Collect *c = (Collect *)ctx;
+  if (c->n < MAX_RECS) {
+    c->t[c->n] = t_ms;
+    memcpy(c->v[c->n], v, sizeof(c->v[0]));
+  }
+  c->n++;
+  return c->stop_after == 0 || c->n < c->stop_after;
+}
+
+// Decode every block of a series in seq order; -1 on a corrupt block
+static int32_t read_series(const HistSeries *s, uint64_t from, uint64_t to, Collect *c) {
+  memset(c, 0, sizeof(*c));
+  int32_t total = 0;
+  for (uint32_t seq = hist_series_tail(s); seq != s->next_seq; seq++) {
+    const uint8_t *b = hist_series_block(s, seq);
+    if (!b) return -1;
+    int32_t n = hist_block_decode(b, s->fields, s->period_ms, from, to, collect_fn, c);
+    if (n < 0) return -1;
+    total += n;
+  }
+  return total;
+}
+
+static Collect col;
+
+int main(void) {
+  printf("== raw round trip across blocks\n");
+  {
+    static uint8_t mem[64 * HIST_BLOCK_SIZE];
+    HistSeries s;
+    CHECK(hist_series_init(&s, mem, sizeof(mem), 1, 1000), "init");
+    int64_t vals[500];
+    for (int i = 0; i < 500; i++) {
+      vals[i] = (i * 37) % 1000 - 200;
+      hist_series_append(&s, 5000 + (uint64_t)i * 1000, &vals[i]);
+    }
+    CHECK(s.blocks > 1, "500 samples should span blocks (got %u)", s.blocks);
+    CHECK(s.evicted == 0, "nothing evicted");
+    int32_t n = read_series(&s, 0, UINT64_MAX, &col);
+    CHECK(n == 500, "decoded %d of 500", n);
+    bool same = true;
+    for (int i = 0; i < 500 && i < n; i++) {
+      if (col.t[i] != 5000 + (uint64_t)i * 1000 || col.v[i][0] != vals[i]) same = false;
+    }
+    CHECK(same, "values/times differ after round trip");
+  }
+
+  printf("== extreme deltas\n");
+  {
+    static uint8_t mem[8 * HIST_BLOCK_SIZE];
+    HistSeries s;
+    hist_series_init(&s, mem, sizeof(mem), 1, 100);
+    int64_t vals[] = { 0, INT64_MAX, INT64_MIN, -1, 1, INT64_MIN, INT64_MAX, 65535, 0 };
+    int cnt = (int)(sizeof(vals) / sizeof(vals[0]));
+    for (int i = 0; i < cnt; i++) hist_series_append(&s, (uint64_t)i * 100, &vals[i]);
+    int32_t n = read_series(&s, 0, UINT64_MAX, &col);
+    CHECK(n == cnt, "decoded %d of %d", n, cnt);
+    for (int i = 0; i < cnt && i < n; i++) {
+      CHECK(col.v[i][0] == vals[i], "value %d: %lld != %lld", i, (long long)col.v[i][0], (long long)vals[i]);
+    }
+  }
+
+  printf("== eviction keeps the newest samples\n");
+  {
+    static uint8_t mem[4 * HIST_BLOCK_SIZE];
+    HistSeries s;
+    hist_series_init(&s, mem, sizeof(mem), 1, 10);
+    for (int i = 0; i < 5000; i++) {
+      int64_t v = i;  // Delta 1: one byte per record
+      hist_series_append(&s, (uint64_t)i * 10, &v);
+    }
+    CHECK(s.blocks == 4, "ring full (%u blocks)", s.blocks);
+    CHECK(s.evicted > 0, "blocks evicted");
+    CHECK(hist_series_block(&s, hist_series_tail(&s) - 1) == NULL, "evicted block still reachable");
+    CHECK(hist_series_block(&s, s.next_seq) == NULL, "future block reachable");
+    int32_t n = read_series(&s, 0, UINT64_MAX, &col);
+    CHECK(n > 300 && n <= 4 * HIST_BLOCK_PAYLOAD, "kept %d records", n);
+    CHECK(n > 0 && col.v[n - 1][0] == 4999 && col.t[n - 1] == 49990, "newest sample last");
+    bool contiguous = true;
+    for (int i = 1; i < n; i++) {
+      if (col.v[i][0] != col.v[i - 1][0] + 1 || col.t[i] != col.t[i - 1] + 10) contiguous = false;
+    }
+    CHECK(contiguous, "kept samples not contiguous");
+  }
+
+  printf("== gaps and jitter\n");
+  {
+    static uint8_t mem[16 * HIST_BLOCK_SIZE];
+    HistSeries s;
+    hist_series_init(&s, mem, sizeof(mem), 1, 1000);
+    int64_t v = 7;
+    // Jitter below half a period stays in the block, times snap to the slot
+    hist_series_append(&s, 10000, &v);
+    hist_series_append(&s, 11400, &v);
+    hist_series_append(&s, 11600 + 400, &v);
+    CHECK(s.blocks == 1, "jitter opened a block (%u)", s.blocks);
+    // Missed samples: new block at the real time
+    hist_series_append(&s, 20000, &v);
+    CHECK(s.blocks == 2, "gap did not open a block (%u)", s.blocks);
+    // Clock step backwards (NTP): new block too
+    hist_series_append(&s, 3000, &v);
+    CHECK(s.blocks == 3, "clock step did not open a block (%u)", s.blocks);
+    int32_t n = read_series(&s, 0, UINT64_MAX, &col);
+    CHECK(n == 5, "decoded %d of 5", n);
+    CHECK(col.t[1] == 11000 && col.t[2] == 12000, "jittered times not snapped (%llu, %llu)",
+          (unsigned long long)col.t[1], (unsigned long long)col.t[2]);
+    CHECK(col.t[3] == 20000 && col.t[4] == 3000, "block start times wrong");
+  }
+
+  printf("== range filter and early stop\n");
+  {
+    static uint8_t mem[32 * HIST_BLOCK_SIZE];
+    HistSeries s;
+    hist_series_init(&s, mem, sizeof(mem), 1, 1000);
+    for (int i = 0; i < 1000; i++) {
+      int64_t v = i % 50;
+      hist_series_append(&s, (uint64_t)i * 1000, &v);
+    }
+    int32_t n = read_series(&s, 100000, 199000, &col);
+    CHECK(n == 100, "range returned %d of 100", n);
+    CHECK(n > 0 && col.t[0] == 100000 && col.t[n - 1] == 199000, "range edges wrong");
+    CHECK(read_series(&s, 2000000, UINT64_MAX, &col) == 0, "range after the data not empty");
+
+    HistBlockInfo info;
+    const uint8_t *b = hist_series_block(&s, hist_series_tail(&s));
+    CHECK(hist_block_info(b, &info) && info.t0 == 0 && info.count > 1, "block header");
+    CHECK(hist_block_end(&info, 1000) == (uint64_t)(info.count - 1) * 1000, "block end time");
+    memset(&col, 0, sizeof(col));
+    col.stop_after = 3;
+    CHECK(hist_block_decode(b, 1, 1000, 0, UINT64_MAX, collect_fn, &col) == 3, "callback stop ignored");
+  }
+
+  printf("== tiers: min/max/avg buckets\n");
+  {
+    static uint8_t mem[60 * HIST_BLOCK_SIZE];
+    HistPoint p;
+    CHECK(hist_point_init(&p, mem, sizeof(mem), 1000), "point init");
+    for (int t = HIST_TIER_1M; t < HIST_TIER_COUNT; t++) {
+      CHECK(p.tier[t].mem != NULL && p.tier[t].nblocks == 10, "tier %d gets a sixth (%u)", t, p.tier[t].nblocks);
+    }
+    CHECK(p.tier[HIST_TIER_RAW].nblocks == 30, "raw gets the rest (%u)", p.tier[HIST_TIER_RAW].nblocks);
+
+    // 1 sample/s for 3 minutes: minute m holds m*100 + (0..59)
+    for (int i = 0; i < 180; i++) {
+      int64_t v = (i / 60) * 100 + (i % 60);
+      hist_point_sample(&p, (uint64_t)i * 1000, v);
+    }
+    int32_t n = read_series(&p.tier[HIST_TIER_1M], 0, UINT64_MAX, &col);
+    CHECK(n == 2, "2 closed 1 min buckets, got %d (running bucket not written)", n);
+    for (int m = 0; m < 2 && m < n; m++) {
+      CHECK(col.t[m] == (uint64_t)m * 60000, "bucket %d start %llu", m, (unsigned long long)col.t[m]);
+      CHECK(col.v[m][0] == m * 100 && col.v[m][1] == m * 100 + 59, "bucket %d min/max", m);
+      CHECK(col.v[m][2] == m * 100 + 30, "bucket %d avg %lld (29.5 rounds to 30)", m, (long long)col.v[m][2]);
+    }
+    CHECK(read_series(&p.tier[HIST_TIER_10M], 0, UINT64_MAX, &col) == 0, "10 min bucket still running");
+
+    // Negative average rounds to nearest too
+    HistPoint q;
+    hist_point_init(&q, mem, sizeof(mem), 1000);
+    hist_point_sample(&q, 0, -1);
+    hist_point_sample(&q, 1000, -2);
+    hist_point_sample(&q, 60000, 0);
+    n = read_series(&q.tier[HIST_TIER_1M], 0, UINT64_MAX, &col);
+    CHECK(n == 1 && col.v[0][2] == -2, "avg of -1,-2 = %lld", n ? (long long)col.v[0][2] : 0LL);
+  }
+
+  printf("== tiers not longer than the interval are off\n");
+  {
+    static uint8_t mem[60 * HIST_BLOCK_SIZE];
+    HistPoint p;
+    CHECK(hist_point_init(&p, mem, sizeof(mem), 60000), "point init");
+    CHECK(p.tier[HIST_TIER_1M].mem == NULL, "1 min tier on for a 1 min interval");
+    CHECK(p.tier[HIST_TIER_10M].mem != NULL && p.tier[HIST_TIER_1H].mem != NULL, "longer tiers off");
+    CHECK(p.tier[HIST_TIER_RAW].nblocks == 40, "raw takes the unused share (%u)", p.tier[HIST_TIER_RAW].nblocks);
+    hist_point_sample(&p, 0, 1);  // Must not touch the disabled tier
+
+    static uint8_t small[HIST_BLOCK_SIZE];
+    CHECK(!hist_point_init(&p, small, sizeof(small), 1000), "1 block accepted");
+    HistSeries s;
+    CHECK(!hist_series_init(&s, mem, sizeof(mem), 1, 0), "period 0 accepted");
+    int64_t v = 1;
+    hist_series_append(&s, 0, &v);  // Off series ignores appends
+    CHECK(s.records == 0, "off series recorded");
+  }
+
+  printf("== corrupt blocks\n");
+  {
+    static uint8_t mem[4 * HIST_BLOCK_SIZE];
+    HistSeries s;
+    hist_series_init(&s, mem, sizeof(mem), 1, 1000);
+    for (int i = 0; i < 10; i++) {
+      int64_t v = 1000 + i * 300;
+      hist_series_append(&s, (uint64_t)i * 1000, &v);
+    }
+    uint8_t b[HIST_BLOCK_SIZE];
+    memcpy(b, hist_series_block(&s, 0), sizeof(b));
+    CHECK(hist_block_decode(b, 1, 1000, 0, UINT64_MAX, collect_fn, &col) == 10, "intact block");
+
+    uint8_t bad[HIST_BLOCK_SIZE];
+    memcpy(bad, b, sizeof(bad));
+    hist_put_be16(bad + 14, HIST_BLOCK_PAYLOAD + 1);
+    CHECK(hist_block_decode(bad, 1, 1000, 0, UINT64_MAX, collect_fn, &col) < 0, "used > payload");
+    memcpy(bad, b, sizeof(bad));
+    hist_put_be16(bad + 12, 11);
+    CHECK(hist_block_decode(bad, 1, 1000, 0, UINT64_MAX, collect_fn, &col) < 0, "count too high");
+    memcpy(bad, b, sizeof(bad));
+    hist_put_be16(bad + 12, 9);
+    CHECK(hist_block_decode(bad, 1, 1000, 0, UINT64_MAX, collect_fn, &col) < 0, "count too low");
+    memcpy(bad, b, sizeof(bad));
+    memset(bad + HIST_BLOCK_HDR_SIZE, 0xFF, HIST_BLOCK_PAYLOAD);
+    CHECK(hist_block_decode(bad, 1, 1000, 0, UINT64_MAX, collect_fn, &col) < 0, "unterminated varint");
+    CHECK(hist_block_decode(b, 0, 1000, 0, UINT64_MAX, collect_fn, &col) < 0, "0 fields");
+  }
+
+  printf("== bytes per sample (slowly changing register)\n");
+  {
+    static uint8_t mem[256 * HIST_BLOCK_SIZE];
+    HistSeries s;
+    hist_series_init(&s, mem, sizeof(mem), 1, 1000);
+    srand(1);
+    int64_t v = 2150;  // e.g. 21.50 degC
+    uint32_t samples = 0;
+    while (s.blocks < s.nblocks) {
+      v += rand() % 5 - 2;
+      hist_series_append(&s, (uint64_t)samples * 1000, &v);
+      samples++;
+    }
+    double bps = (double)(s.blocks * HIST_BLOCK_SIZE) / samples;
+    printf("  %u samples in %u blocks: %.2f bytes/sample (%.1f h at 1 s in 32 KB)\n",
+           samples, s.blocks, bps, 32768.0 / bps / 3600.0);
+    CHECK(bps < 1.5, "%.2f bytes/sample", bps);
+  }
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
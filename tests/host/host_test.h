@@ -0,0 +1,27 @@
+/**
+ * @file host_test.h
+ * @brief Shared check macro for the host tests
+ *
+ * CHECK(cond, fmt, ...) prints file:line and the formatted message when cond
+ * is false and counts it in failures; main() reports the count at the end.
+ * Each test is a single translation unit, so the counter is file-static.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      failures++; \
+    } \
+  } while (0)
+
+#endif // HOST_TEST_H
@@ -0,0 +1,275 @@
+/**
+ * @file persist_queue_test.cpp
+ * @brief Host test for the persist writer job queue (FEAT-165)
+ *
+ * Covers FIFO order across keys, coalescing of a pending key (newest
+ * snapshot wins, place in the queue kept, callbacks merged), resubmit while
+ * a job is being written, and capacity limits. A threaded run mirrors the
+ * writer task with std::mutex: a fast producer saves continuously while a
+ * slow "flash" consumer writes; every callback must fire exactly once and
+ * the last snapshot per key must be on "flash" at the end.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "persist_queue.h"
+#include "host_test.h"
+
+static bool exec_nop(uint16_t key, void *data, uint32_t len)
+{
+  (void)key; (void)data; (void)len;
+  return true;
+}
+
+static uint32_t *make_data(uint32_t v)
+{
+  uint32_t *p = (uint32_t *)malloc(sizeof(uint32_t));
+  *p = v;
+  return p;
+}
+
+static int cb_hits[8];
+
+static void count_cb(bool ok, void *ctx)
+{
+  if (ok) cb_hits[(intptr_t)ctx]++;
+}
+
+static void test_fifo_and_coalesce(void)
+{
+  printf("== FIFO order, coalescing keeps place and newest data\n");
+  PersistQueue q;
+  pq_init(&q);
+  void *old = NULL;
+
+  CHECK(pq_submit(&q, 0x100, exec_nop, make_data(1), 4, NULL, NULL, &old) == PQ_QUEUED, "A");
+  CHECK(pq_submit(&q, 0x200, exec_nop, make_data(2), 4, NULL, NULL, &old) == PQ_QUEUED, "B");
+  CHECK(pq_submit(&q, 0x300, exec_nop, make_data(3), 4, NULL, NULL, &old) == PQ_QUEUED, "C");
+
+  old = NULL;
+  CHECK(pq_submit(&q, 0x100, exec_nop, make_data(11), 4, NULL, NULL, &old) == PQ_COALESCED,
+        "A again not coalesced");
+  CHECK(old && *(uint32_t *)old == 1, "old snapshot not handed back");
+  free(old);
+  CHECK(pq_pending(&q) == 3, "pending %u", pq_pending(&q));
+  CHECK(pq_is_pending(&q, 0x200) && !pq_is_pending(&q, 0x400), "is_pending");
+
+  PqJob job;
+  uint16_t order[3];
+  uint32_t values[3];
+  for (int i = 0; i < 3; i++) {
+    CHECK(pq_take(&q, &job), "take %d", i);
+    order[i] = job.key;
+    values[i] = *(uint32_t *)job.data;
+    if (job.key == 0x100) CHECK(job.submits == 2, "A carried %u submits", job.submits);
+    free(job.data);
+  }
+  CHECK(order[0] == 0x100 && order[1] == 0x200 && order[2] == 0x300,
+        "order %x %x %x", order[0], order[1], order[2]);
+  CHECK(values[0] == 11, "A wrote %u, not newest", values[0]);
+  CHECK(!pq_take(&q, &job), "take from empty queue");
+  CHECK(q.submitted == 4 && q.coalesced == 1, "stats %u/%u", q.submitted, q.coalesced);
+}
+
+static void test_callbacks(void)
+{
+  printf("== callbacks merged, limit per job\n");
+  PersistQueue q;
+  pq_init(&q);
+  memset(cb_hits, 0, sizeof(cb_hits));
+  void *old = NULL;
+
+  for (intptr_t i = 0; i < PQ_MAX_CALLBACKS; i++) {
+    PqSubmitResult r = pq_submit(&q, 0x100, exec_nop, make_data((uint32_t)i), 4,
+                                 count_cb, (void *)i, &old);
+    CHECK(r == (i == 0 ? PQ_QUEUED : PQ_COALESCED), "submit %ld", (long)i);
+    if (r == PQ_COALESCED) free(old);
+  }
+  uint32_t *extra = make_data(99);
+  CHECK(pq_submit(&q, 0x100, exec_nop, extra, 4, count_cb, (void *)7, &old) == PQ_FULL,
+        "callback list overflow accepted");
+  free(extra);
+  // Without a callback the snapshot can still be replaced
+  old = NULL;
+  CHECK(pq_submit(&q, 0x100, exec_nop, make_data(42), 4, NULL, NULL, &old) == PQ_COALESCED,
+        "callback-less submit rejected");
+  free(old);
+
+  PqJob job;
+  CHECK(pq_take(&q, &job) && job.cb_count == PQ_MAX_CALLBACKS, "cb_count %u", job.cb_count);
+  CHECK(*(uint32_t *)job.data == 42, "data %u", *(uint32_t *)job.data);
+  for (uint8_t i = 0; i < job.cb_count; i++) job.cbs[i].fn(true, job.cbs[i].ctx);
+  free(job.data);
+  for (int i = 0; i < PQ_MAX_CALLBACKS; i++) CHECK(cb_hits[i] == 1, "cb %d hits %d", i, cb_hits[i]);
+  CHECK(cb_hits[7] == 0, "rejected callback called");
+}
+
+static void test_busy_and_capacity(void)
+{
+  printf("== resubmit while writing, queue capacity\n");
+  PersistQueue q;
+  pq_init(&q);
+  void *old = NULL;
+
+  pq_submit(&q, 0x100, exec_nop, make_data(1), 4, NULL, NULL, &old);
+  PqJob busy;
+  pq_take(&q, &busy);   // Being written now
+  CHECK(pq_submit(&q, 0x100, exec_nop, make_data(2), 4, NULL, NULL, &old) == PQ_QUEUED,
+        "resubmit during write coalesced into the running job");
+  PqJob next;
+  CHECK(pq_take(&q, &next) && *(uint32_t *)next.data == 2, "second write missing");
+  free(busy.data);
+  free(next.data);
+
+  for (uint16_t k = 0; k < PQ_MAX_JOBS; k++) {
+    CHECK(pq_submit(&q, 0x400 | k, exec_nop, make_data(k), 4, NULL, NULL, &old) == PQ_QUEUED,
+          "key %u", k);
+  }
+  uint32_t *extra = make_data(0);
+  CHECK(pq_submit(&q, 0x0500, exec_nop, extra, 4, NULL, NULL, &old) == PQ_FULL, "overfull");
+  free(extra);
+  CHECK(pq_submit(&q, 0x0403, exec_nop, make_data(33), 4, NULL, NULL, &old) == PQ_COALESCED,
+        "full queue must still coalesce");
+  free(old);
+
+  // Free-running submission numbers: order survives the wrap
+  PqJob job;
+  while (pq_take(&q, &job)) free(job.data);
+  q.next_order = 0xFFFFFFFEu;
+  for (uint16_t k = 0; k < 4; k++) pq_submit(&q, 0x600 | k, exec_nop, make_data(k), 4, NULL, NULL, &old);
+  for (uint16_t k = 0; k < 4; k++) {
+    CHECK(pq_take(&q, &job) && job.key == (0x600 | k), "wrap order %u: %x", k, job.key);
+    free(job.data);
+  }
+}
+
+/* ----------------------------------------------------------------------------
+ * Threaded writer, same locking as persist_writer.cpp
+ * -------------------------------------------------------------------------- */
+
+#define SIM_KEYS    4
+#define SIM_SAVES   20000
+
+static std::mutex sim_mutex;
+static std::condition_variable sim_wake;
+static uint32_t sim_flash[SIM_KEYS];
+static uint32_t sim_writes;
+static uint32_t sim_cb_calls[SIM_SAVES];
+
+static bool sim_exec(uint16_t key, void *data, uint32_t len)
+{
+  (void)len;
+  std::this_thread::sleep_for(std::chrono::microseconds(200));   // "Flash"
+  sim_flash[key & 0xFF] = *(uint32_t *)data;
+  sim_writes++;
+  return true;
+}
+
+static void sim_cb(bool ok, void *ctx)
+{
+  if (ok) __atomic_add_fetch(&sim_cb_calls[(intptr_t)ctx], 1, __ATOMIC_RELAXED);
+}
+
+static void test_threaded(void)
+{
+  printf("== threaded: fast producer, slow writer\n");
+  PersistQueue q;
+  pq_init(&q);
+  bool stop = false;
+  bool busy = false;
+
+  std::thread writer([&] {
+    for (;;) {
+      PqJob job;
+      {
+        std::unique_lock<std::mutex> lock(sim_mutex);
+        sim_wake.wait(lock, [&] { return stop || pq_pending(&q) > 0; });
+        if (!pq_take(&q, &job)) return;
+        busy = true;
+      }
+      bool ok = job.exec(job.key, job.data, job.len);
+      free(job.data);
+      {
+        std::lock_guard<std::mutex> lock(sim_mutex);
+        busy = false;
+      }
+      for (uint8_t i = 0; i < job.cb_count; i++) job.cbs[i].fn(ok, job.cbs[i].ctx);
+    }
+  });
+
+  uint32_t last[SIM_KEYS] = {0};
+  uint32_t rejected = 0;
+  double max_us = 0;
+  for (intptr_t n = 0; n < SIM_SAVES; n++) {
+    uint16_t key = (uint16_t)(0x100 | (rand() % SIM_KEYS));
+    uint32_t *snap = make_data((uint32_t)n + 1);
+    void *old = NULL;
+    bool with_cb = (n % 128) == 0;   // Waiters (HTTP saves) are rare
+    if (!with_cb) sim_cb_calls[n] = 1;
+    auto t0 = std::chrono::steady_clock::now();
+    PqSubmitResult r;
+    {
+      std::lock_guard<std::mutex> lock(sim_mutex);
+      r = pq_submit(&q, key, sim_exec, snap, 4, with_cb ? sim_cb : NULL, (void *)n, &old);
+    }
+    sim_wake.notify_one();
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    if (us > max_us) max_us = us;
+    if (r == PQ_FULL) {
+      free(snap);
+      rejected++;
+      if (with_cb) sim_cb_calls[n] = 1;   // Caller learns synchronously
+    } else {
+      last[key & 0xFF] = (uint32_t)n + 1;
+      free(old);
+    }
+    if ((n & 63) == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+
+  // Flush: wait until idle
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(sim_mutex);
+      if (pq_pending(&q) == 0 && !busy) break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    stop = true;
+  }
+  sim_wake.notify_one();
+  writer.join();
+
+  uint32_t wrong_cb = 0;
+  for (uint32_t n = 0; n < SIM_SAVES; n++) {
+    if (sim_cb_calls[n] != 1) wrong_cb++;
+  }
+  printf("   %u saves -> %u flash writes (%u coalesced, %u rejected), max submit %.1f us\n",
+         SIM_SAVES, sim_writes, q.coalesced, rejected, max_us);
+  CHECK(wrong_cb == 0, "%u callbacks not called exactly once", wrong_cb);
+  for (int k = 0; k < SIM_KEYS; k++) {
+    CHECK(sim_flash[k] == last[k], "key %d: flash %u, last save %u", k, sim_flash[k], last[k]);
+  }
+  CHECK(sim_writes < SIM_SAVES / 4, "coalescing ineffective: %u writes", sim_writes);
+  CHECK(rejected < SIM_SAVES / 100, "%u saves rejected", rejected);
+}
+
+int main(void)
+{
+  srand(1);
+  test_fifo_and_coalesce();
+  test_callbacks();
+  test_busy_and_capacity();
+  test_threaded();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file quad_decoder_test.cpp
+ * @brief Host test for quadrature decoding and velocity (FEAT-157)
+ *
+ * Runs synthetic A/B sequences through the same channel rules the PCNT unit
+ * is programmed with (quad_decoder_rules), then checks the velocity filter
+ * against constant speed, a direction change and a step.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "quad_decoder.h"
+#include "host_test.h"
+
+// Gray sequence, A leading B: bit 0 = A, bit 1 = B
+static const uint8_t FWD[4] = {0x0, 0x1, 0x3, 0x2};
+
+// Run `steps` quadrature states forward (steps > 0) or backward from state
+// index *phase, return the accumulated count
+static long run_steps(const QuadChannelRule *rules, uint8_t ch, int *phase, long steps)
+{
+  long count = 0;
+  int dir = steps >= 0 ? 1 : -1;
+  for (long i = 0; i < labs(steps); i++) {
+    uint8_t prev = FWD[*phase & 3];
+    *phase = (*phase + dir) & 3;
+    count += quad_decoder_step(rules, ch, prev, FWD[*phase]);
+  }
+  return count;
+}
+
+static void test_multipliers(void)
+{
+  printf("== x1/x2/x4 counts per cycle, both directions\n");
+  const uint8_t modes[3] = {1, 2, 4};
+  for (int m = 0; m < 3; m++) {
+    QuadChannelRule rules[2];
+    uint8_t ch = quad_decoder_rules(modes[m], rules);
+    CHECK(ch == (modes[m] == 4 ? 2 : 1), "x%u channels %u", modes[m], ch);
+
+    int phase = 0;
+    long fwd = run_steps(rules, ch, &phase, 4 * 100);   // 100 cycles forward
+    long back = run_steps(rules, ch, &phase, -4 * 100); // and back
+    printf("   x%u: +%ld / %ld\n", modes[m], fwd, back);
+    CHECK(fwd == 100L * modes[m], "x%u forward %ld", modes[m], fwd);
+    CHECK(back == -100L * modes[m], "x%u backward %ld", modes[m], back);
+  }
+
+  QuadChannelRule rules[2];
+  CHECK(quad_decoder_rules(3, rules) == 0, "x3 accepted");
+}
+
+static void test_dither(void)
+{
+  printf("== dither on one edge does not drift\n");
+  const uint8_t modes[3] = {1, 2, 4};
+  for (int m = 0; m < 3; m++) {
+    QuadChannelRule rules[2];
+    uint8_t ch = quad_decoder_rules(modes[m], rules);
+    // Vibration around every phase: step forward and back 1000 times
+    for (int start = 0; start < 4; start++) {
+      int phase = start;
+      long total = 0;
+      for (int i = 0; i < 1000; i++) {
+        total += run_steps(rules, ch, &phase, 1);
+        total += run_steps(rules, ch, &phase, -1);
+      }
+      CHECK(total == 0 && phase == start, "x%u phase %d drift %ld", modes[m], start, total);
+    }
+  }
+}
+
+static void test_random_walk(void)
+{
+  printf("== random walk: x4 count equals net steps\n");
+  QuadChannelRule rules[2];
+  uint8_t ch = quad_decoder_rules(4, rules);
+  int phase = 0;
+  long net = 0, count = 0;
+  for (int i = 0; i < 100000; i++) {
+    long s = (rand() & 1) ? 1 : -1;
+    net += s;
+    count += run_steps(rules, ch, &phase, s);
+  }
+  CHECK(count == net, "count %ld net %ld", count, net);
+
+  // Illegal double transition is ignored
+  CHECK(quad_decoder_step(rules, ch, 0x0, 0x3) == 0, "double step counted");
+}
+
+static void test_velocity_constant(void)
+{
+  printf("== velocity: 1234 counts/s, 10 ms samples\n");
+  QuadVelocityConfig cfg = {10000, 0};
+  QuadVelocity v;
+  quad_velocity_reset(&v);
+  double pos = 0;
+  for (uint32_t t = 0; t <= 2000000; t += 1000) {
+    pos = 1234.0 * t / 1e6;
+    quad_velocity_update(&v, &cfg, (int64_t)pos, t);
+  }
+  int32_t cps = quad_velocity_get(&v);
+  printf("   %d counts/s\n", cps);
+  CHECK(abs(cps - 1234) <= 100, "unfiltered %d", cps);  // 1 count quantisation per 10 ms
+
+  cfg.tau_us = 200000;
+  quad_velocity_reset(&v);
+  for (uint32_t t = 0xFFFFFFFFu - 500000u, i = 0; i <= 2000; t += 1000, i++) {
+    pos = 1234.0 * i / 1000.0;
+    quad_velocity_update(&v, &cfg, (int64_t)pos, t);
+  }
+  cps = quad_velocity_get(&v);
+  printf("   %d counts/s filtered across micros() wrap\n", cps);
+  CHECK(abs(cps - 1234) <= 5, "filtered %d", cps);
+}
+
+static void test_velocity_reverse_and_step(void)
+{
+  printf("== velocity: reversal and step response (tau 100 ms)\n");
+  QuadVelocityConfig cfg = {1000, 100000};
+  QuadVelocity v;
+  quad_velocity_reset(&v);
+  int64_t pos = 0;
+  uint32_t t = 0;
+  for (; t < 1000000; t += 1000) { pos += 5; quad_velocity_update(&v, &cfg, pos, t); }
+  CHECK(abs(quad_velocity_get(&v) - 5000) <= 1, "forward %d", quad_velocity_get(&v));
+
+  for (; t < 2000000; t += 1000) { pos -= 5; quad_velocity_update(&v, &cfg, pos, t); }
+  CHECK(abs(quad_velocity_get(&v) + 5000) <= 1, "reverse %d", quad_velocity_get(&v));
+
+  // Stop: after one time constant ~63 % of the way to 0
+  for (uint32_t end = t + 100000; t < end; t += 1000) quad_velocity_update(&v, &cfg, pos, t);
+  int32_t c = quad_velocity_get(&v);
+  printf("   %d counts/s one tau after stop\n", c);
+  CHECK(c < -1500 && c > -2100, "tau response %d", c);
+
+  for (uint32_t end = t + 1000000; t < end; t += 1000) quad_velocity_update(&v, &cfg, pos, t);
+  CHECK(quad_velocity_get(&v) == 0, "settled %d", quad_velocity_get(&v));
+}
+
+int main(void)
+{
+  srand(1);
+  test_multipliers();
+  test_dither();
+  test_random_walk();
+  test_velocity_constant();
+  test_velocity_reverse_and_step();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file retain_store_test.cpp
+ * @brief Host test for the warm-restart retention area (FEAT-171)
+ *
+ * Round trip of a snapshot, alternating slots, a reset in the middle of a
+ * snapshot (falls back to the previous one), power-on garbage, a snapshot
+ * of another layout, a corrupt payload byte, sections that do not fit and
+ * a malformed section list.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "retain_store.h"
+#include "host_test.h"
+
+#define AREA_SIZE   1024
+#define LAYOUT      0x00010001u
+
+// Same convention as esp_rom_crc32_le(): start with 0, chainable
+static uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *buf++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+static uint8_t area[AREA_SIZE];
+
+// Snapshot with a register section (value base) and an odd sized section
+static void write_snapshot(RetainStore *s, uint16_t base) {
+  rs_begin(s);
+  uint16_t *regs = (uint16_t *)rs_section(s, 1, 0, 16 * sizeof(uint16_t));
+  for (int i = 0; regs && i < 16; i++) regs[i] = (uint16_t)(base + i);
+  uint8_t *odd = rs_section(s, 2, 7, 3);
+  if (odd) memcpy(odd, "abc", 3);
+  rs_commit(s);
+}
+
+// First register value of the newest snapshot, -1 if none
+static int latest_base(RetainStore *s) {
+  uint32_t len = 0, pos = 0;
+  const uint8_t *data = rs_latest(s, &len, NULL);
+  if (!data) return -1;
+  RsSection sec;
+  const uint8_t *payload;
+  while (rs_next(data, len, &pos, &sec, &payload)) {
+    if (sec.type == 1 && sec.len == 32) {
+      uint16_t v;
+      memcpy(&v, payload, sizeof(v));
+      return v;
+    }
+  }
+  return -1;
+}
+
+static void test_round_trip(void) {
+  printf("== round trip\n");
+  RetainStore s;
+  memset(area, 0, sizeof(area));
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  uint32_t len;
+  CHECK(rs_latest(&s, &len, NULL) == NULL, "empty area has no snapshot");
+
+  write_snapshot(&s, 100);
+
+  // Fresh attach, as after the reset
+  RetainStore r;
+  rs_init(&r, area, sizeof(area), LAYOUT, crc32_le);
+  uint32_t seq = 0, pos = 0;
+  const uint8_t *data = rs_latest(&r, &len, &seq);
+  CHECK(data != NULL, "snapshot found");
+  CHECK(seq == 1, "seq %u", (unsigned)seq);
+  RsSection sec;
+  const uint8_t *payload;
+  CHECK(rs_next(data, len, &pos, &sec, &payload), "first section");
+  CHECK(sec.type == 1 && sec.id == 0 && sec.len == 32, "first header");
+  uint16_t regs[16];
+  memcpy(regs, payload, sizeof(regs));
+  bool ok = true;
+  for (int i = 0; i < 16; i++) ok = ok && regs[i] == 100 + i;
+  CHECK(ok, "register values");
+  CHECK(rs_next(data, len, &pos, &sec, &payload), "second section");
+  CHECK(sec.type == 2 && sec.id == 7 && sec.len == 3 && !memcmp(payload, "abc", 3), "odd section");
+  CHECK(((uintptr_t)payload & 3) == 0, "payload aligned");
+  CHECK(!rs_next(data, len, &pos, &sec, &payload), "end of list");
+}
+
+static void test_alternating(void) {
+  printf("== alternating slots\n");
+  RetainStore s;
+  memset(area, 0, sizeof(area));
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  for (int n = 1; n <= 5; n++) {
+    write_snapshot(&s, (uint16_t)(n * 10));
+    CHECK(latest_base(&s) == n * 10, "snapshot %d is newest (%d)", n, latest_base(&s));
+  }
+  // Both slots valid: the newer seq wins no matter which slot
+  RetainStore r;
+  rs_init(&r, area, sizeof(area), LAYOUT, crc32_le);
+  uint32_t len, seq;
+  CHECK(rs_latest(&r, &len, &seq) && seq == 5, "seq after reattach %u", (unsigned)seq);
+  write_snapshot(&r, 60);
+  CHECK(latest_base(&r) == 60, "continues after reattach");
+  CHECK(rs_latest(&r, &len, &seq) && seq == 6, "seq continues %u", (unsigned)seq);
+}
+
+static void test_torn_write(void) {
+  printf("== reset during a snapshot\n");
+  RetainStore s;
+  memset(area, 0, sizeof(area));
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  write_snapshot(&s, 10);
+  write_snapshot(&s, 20);
+
+  // Reset after some sections, before the commit
+  rs_begin(&s);
+  uint16_t *regs = (uint16_t *)rs_section(&s, 1, 0, 32);
+  for (int i = 0; i < 16; i++) regs[i] = 999;
+
+  RetainStore r;
+  rs_init(&r, area, sizeof(area), LAYOUT, crc32_le);
+  CHECK(latest_base(&r) == 20, "previous snapshot survives (%d)", latest_base(&r));
+
+  // Reset right after rs_begin: the header of the target slot is gone already
+  write_snapshot(&r, 30);
+  rs_begin(&r);
+  RetainStore q;
+  rs_init(&q, area, sizeof(area), LAYOUT, crc32_le);
+  CHECK(latest_base(&q) == 30, "newest survives an empty begin (%d)", latest_base(&q));
+}
+
+static void test_rejected(void) {
+  printf("== power-on garbage, other layout, corruption\n");
+  RetainStore s;
+  srand(1234);
+  for (size_t i = 0; i < sizeof(area); i++) area[i] = (uint8_t)rand();
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  uint32_t len;
+  CHECK(rs_latest(&s, &len, NULL) == NULL, "garbage rejected");
+
+  // A snapshot in garbage memory works and is found
+  write_snapshot(&s, 40);
+  CHECK(latest_base(&s) == 40, "snapshot over garbage");
+
+  RetainStore other;
+  rs_init(&other, area, sizeof(area), LAYOUT + 1, crc32_le);
+  CHECK(rs_latest(&other, &len, NULL) == NULL, "other layout rejected");
+
+  // Flip a payload byte of the only snapshot
+  memset(area, 0, sizeof(area));
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  write_snapshot(&s, 50);
+  area[sizeof(RsSlotHeader) + sizeof(RsSection) + 5] ^= 0x01;
+  CHECK(rs_latest(&s, &len, NULL) == NULL, "corrupt payload rejected");
+
+  // Header field (seq) changed without the header CRC
+  memset(area, 0, sizeof(area));
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  write_snapshot(&s, 50);
+  ((RsSlotHeader *)area)->seq += 10;
+  CHECK(rs_latest(&s, &len, NULL) == NULL, "corrupt header rejected");
+
+  // rs_clear forgets everything
+  memset(area, 0, sizeof(area));
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  write_snapshot(&s, 60);
+  write_snapshot(&s, 70);
+  rs_clear(&s);
+  CHECK(rs_latest(&s, &len, NULL) == NULL, "cleared");
+}
+
+static void test_overflow(void) {
+  printf("== sections that do not fit\n");
+  RetainStore s;
+  memset(area, 0, sizeof(area));
+  rs_init(&s, area, sizeof(area), LAYOUT, crc32_le);
+  uint32_t room = s.slot_size - sizeof(RsSlotHeader);
+
+  rs_begin(&s);
+  CHECK(rs_section(&s, 1, 0, 32) != NULL, "small section");
+  CHECK(rs_section(&s, 3, 0, (uint16_t)room) == NULL, "too large section refused");
+  CHECK(rs_section(&s, 4, 0, 8) != NULL, "later small section still fits");
+  CHECK(s.dropped == 1, "dropped %u", (unsigned)s.dropped);
+  uint32_t written = rs_commit(&s);
+  CHECK(written == 2 * sizeof(RsSection) + 32 + 8, "written %u", (unsigned)written);
+
+  // Exactly full
+  rs_begin(&s);
+  CHECK(rs_section(&s, 5, 0, (uint16_t)(room - sizeof(RsSection))) != NULL, "exact fit");
+  CHECK(rs_section(&s, 6, 0, 0) == NULL, "nothing after full");
+  rs_commit(&s);
+  uint32_t len;
+  CHECK(rs_latest(&s, &len, NULL) && len == room, "full snapshot valid (len %u)", (unsigned)len);
+
+  CHECK(rs_section(&s, 1, 0, 4) == NULL, "no section without begin");
+  CHECK(rs_commit(&s) == 0, "no commit without begin");
+}
+
+static void test_malformed(void) {
+  printf("== malformed section list\n");
+  uint8_t data[16];
+  RsSection sec = {1, 0, 40};   // Claims more than there is
+  memcpy(data, &sec, sizeof(sec));
+  uint32_t pos = 0;
+  const uint8_t *payload;
+  RsSection out;
+  CHECK(!rs_next(data, sizeof(data), &pos, &out, &payload), "overlong section stops iteration");
+  pos = 0;
+  CHECK(!rs_next(data, 2, &pos, &out, &payload), "short header stops iteration");
+}
+
+int main(void) {
+  test_round_trip();
+  test_alternating();
+  test_torn_write();
+  test_rejected();
+  test_overflow();
+  test_malformed();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
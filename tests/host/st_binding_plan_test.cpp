@@ -0,0 +1,312 @@
+/**
+ * @file st_binding_plan_test.cpp
+ * @brief Host test for the precompiled ST binding copy list (FEAT-162)
+ *
+ * Random var_maps[] tables over four programs (uncompiled programs, unknown
+ * variables, every type, DI/coil/HR sources, word counts, registers at and
+ * past the table end, side-effect registers) are run through the old
+ * per-binding loop and through the compiled lists; variables, registers
+ * and the side-effect setter calls must match. Then both are timed.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "st_binding_plan.h"
+#include "host_test.h"
+
+#define PROGS 4
+#define MAPS  32
+
+/* ---- Emulated register file and programs ---- */
+
+static uint16_t holding[HOLDING_REGS_SIZE];
+static uint8_t coils[COILS_SIZE];
+static uint8_t discrete[DISCRETE_INPUTS_SIZE];
+
+typedef struct {
+  bool compiled;
+  uint8_t var_count;
+  st_datatype_t types[32];
+  st_value_t vars[32];
+} fake_prog_t;
+
+static fake_prog_t progs[PROGS];
+
+// Side-effect HR writes in call order
+static uint32_t effects[4 * MAPS];
+static int effect_count;
+
+static bool hr_plain(uint16_t addr)
+{
+  return addr < ST_LOGIC_CONTROL_REG_BASE || addr > ST_LOGIC_EXEC_INTERVAL_RW_REG + 1;
+}
+
+static void set_holding(uint16_t addr, uint16_t value)
+{
+  if (addr >= HOLDING_REGS_SIZE) return;
+  holding[addr] = value;
+  if (!hr_plain(addr) && effect_count < 4 * MAPS) effects[effect_count++] = ((uint32_t)addr << 16) | value;
+}
+
+static void set_coil(uint16_t idx, uint8_t value)
+{
+  if (idx >= COILS_SIZE * 8) return;
+  if (value) coils[idx / 8] |= (uint8_t)(1u << (idx % 8));
+  else coils[idx / 8] &= (uint8_t)~(1u << (idx % 8));
+}
+
+static uint16_t get_holding(uint16_t addr) { return addr < HOLDING_REGS_SIZE ? holding[addr] : 0; }
+static uint8_t get_coil(uint16_t i) { return i < COILS_SIZE * 8 ? (coils[i / 8] >> (i % 8)) & 1 : 0; }
+static uint8_t get_di(uint16_t i) { return i < DISCRETE_INPUTS_SIZE * 8 ? (discrete[i / 8] >> (i % 8)) & 1 : 0; }
+
+static fake_prog_t* live_prog(uint8_t id, uint8_t var)
+{
+  if (id >= PROGS || !progs[id].compiled || var >= progs[id].var_count) return NULL;
+  return &progs[id];
+}
+
+static st_value_t* resolve_var(uint8_t id, uint8_t var, st_datatype_t *type)
+{
+  fake_prog_t *p = live_prog(id, var);
+  if (!p) return NULL;
+  *type = p->types[var];
+  return &p->vars[var];
+}
+
+/* ---- Reference: the per-binding loop gpio_mapping used before the plan ---- */
+
+static void ref_inputs(const VariableMapping *maps, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++) {
+    const VariableMapping *map = &maps[i];
+    if (map->source_type != MAPPING_SOURCE_ST_VAR || !map->is_input) continue;
+    fake_prog_t *p = live_prog(map->st_program_id, map->st_var_index);
+    if (!p || map->input_reg == 65535) continue;
+
+    uint8_t word_count = (map->word_count > 0) ? map->word_count : 1;
+    if (map->input_type == 1) {
+      if (map->input_reg >= DISCRETE_INPUTS_SIZE * 8) continue;
+    } else if (map->input_type == 2) {
+      if (map->input_reg >= COILS_SIZE * 8) continue;
+    } else {
+      if (map->input_reg + word_count > HOLDING_REGS_SIZE) continue;
+    }
+
+    st_value_t *v = &p->vars[map->st_var_index];
+    st_datatype_t t = p->types[map->st_var_index];
+    if (t == ST_TYPE_BOOL) {
+      uint16_t r;
+      if (map->input_type == 1) r = get_di(map->input_reg);
+      else if (map->input_type == 2) r = get_coil(map->input_reg);
+      else r = get_holding(map->input_reg);
+      v->bool_val = (r != 0);
+    } else if (t == ST_TYPE_INT) {
+      v->int_val = (int16_t)get_holding(map->input_reg);
+    } else if (t == ST_TYPE_DINT) {
+      v->dint_val = ((int32_t)get_holding(map->input_reg + 1) << 16) | get_holding(map->input_reg);
+    } else if (t == ST_TYPE_DWORD) {
+      v->dword_val = ((uint32_t)get_holding(map->input_reg + 1) << 16) | get_holding(map->input_reg);
+    } else if (t == ST_TYPE_REAL) {
+      uint32_t bits = ((uint32_t)get_holding(map->input_reg + 1) << 16) | get_holding(map->input_reg);
+      memcpy(&v->real_val, &bits, sizeof(float));
+    }
+  }
+}
+
+static void ref_outputs(const VariableMapping *maps, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++) {
+    const VariableMapping *map = &maps[i];
+    if (map->source_type != MAPPING_SOURCE_ST_VAR || map->is_input) continue;
+    fake_prog_t *p = live_prog(map->st_program_id, map->st_var_index);
+    if (!p || map->coil_reg == 65535) continue;
+
+    st_value_t *v = &p->vars[map->st_var_index];
+    st_datatype_t t = p->types[map->st_var_index];
+    if (map->output_type == 1) {
+      set_coil(map->coil_reg, (t == ST_TYPE_BOOL) ? v->bool_val : (v->int_val != 0));
+    } else if (t == ST_TYPE_BOOL) {
+      set_holding(map->coil_reg, v->bool_val ? 1 : 0);
+    } else if (t == ST_TYPE_INT) {
+      set_holding(map->coil_reg, (uint16_t)v->int_val);
+    } else if (t == ST_TYPE_DINT || t == ST_TYPE_DWORD || t == ST_TYPE_REAL) {
+      uint32_t bits;
+      memcpy(&bits, &v->dword_val, sizeof(bits));
+      set_holding(map->coil_reg, (uint16_t)(bits & 0xFFFF));
+      set_holding(map->coil_reg + 1, (uint16_t)(bits >> 16));
+    }
+  }
+}
+
+/* ---- Random state ---- */
+
+static void rand_bytes(void *p, size_t n)
+{
+  uint8_t *b = (uint8_t *)p;
+  for (size_t i = 0; i < n; i++) b[i] = (uint8_t)rand();
+}
+
+static void rand_progs(void)
+{
+  for (int p = 0; p < PROGS; p++) {
+    progs[p].compiled = (rand() % 5) != 0;
+    progs[p].var_count = (uint8_t)(rand() % 33);
+    for (int v = 0; v < 32; v++) progs[p].types[v] = (st_datatype_t)(rand() % 7);
+    for (int v = 0; v < 32; v++) {
+      // Bool variables hold only 0/1 in their first byte, like the VM
+      rand_bytes(&progs[p].vars[v], sizeof(st_value_t));
+      if (progs[p].types[v] == ST_TYPE_BOOL) progs[p].vars[v].bool_val = rand() & 1;
+    }
+  }
+}
+
+static uint16_t rand_reg(void)
+{
+  switch (rand() % 8) {
+    case 0:  return 65535;
+    case 1:  return (uint16_t)(HOLDING_REGS_SIZE - 2 + rand() % 4);    // Table end
+    case 2:  return (uint16_t)(ST_LOGIC_CONTROL_REG_BASE - 1 + rand() % 40);  // Side effects
+    case 3:  return (uint16_t)(rand() % 300);
+    default: return (uint16_t)(rand() % 64);
+  }
+}
+
+static void rand_maps(VariableMapping *maps, uint8_t count)
+{
+  memset(maps, 0, sizeof(VariableMapping) * count);
+  for (uint8_t i = 0; i < count; i++) {
+    VariableMapping *m = &maps[i];
+    m->source_type = (rand() % 8) ? MAPPING_SOURCE_ST_VAR : MAPPING_SOURCE_GPIO;
+    m->st_program_id = (uint8_t)(rand() % (PROGS + 1));
+    m->st_var_index = (uint8_t)(rand() % 34);
+    m->is_input = rand() % 2;
+    m->input_type = (uint8_t)(rand() % 3);
+    m->output_type = (uint8_t)(rand() % 2);
+    m->input_reg = m->is_input ? rand_reg() : 65535;
+    m->coil_reg = m->is_input ? 65535 : rand_reg();
+    m->word_count = (uint8_t)(rand() % 3);
+  }
+}
+
+static const st_bind_target_t target = { holding, coils, discrete, resolve_var, hr_plain };
+static const st_bind_io_t io = { set_coil, set_holding };
+
+static void test_random(void)
+{
+  printf("== random bindings: compiled lists vs per-binding loop\n");
+  srand(5);
+  VariableMapping maps[MAPS];
+  static st_binding_plan_t plan;
+  static fake_prog_t progs_ref[PROGS];
+  static uint16_t holding_ref[HOLDING_REGS_SIZE];
+  static uint8_t coils_ref[COILS_SIZE];
+  static uint32_t effects_ref[4 * MAPS];
+  long in_bad = 0, out_bad = 0, fx_bad = 0, entries = 0, setters = 0;
+
+  for (long r = 0; r < 20000; r++) {
+    uint8_t count = (uint8_t)(rand() % (MAPS + 1));
+    rand_progs();
+    rand_maps(maps, count);
+    rand_bytes(holding, sizeof(holding));
+    rand_bytes(coils, sizeof(coils));
+    rand_bytes(discrete, sizeof(discrete));
+
+    st_binding_plan_build(&plan, maps, count, &target);
+    entries += plan.in_count + plan.out_count;
+    setters += plan.setter_count;
+
+    // Reference pass first; keep the start state for the plan pass
+    memcpy(holding_ref, holding, sizeof(holding));
+    memcpy(coils_ref, coils, sizeof(coils));
+    fake_prog_t saved[PROGS];
+    memcpy(saved, progs, sizeof(progs));
+    ref_inputs(maps, count);
+    ref_outputs(maps, count);
+    int n_ref = effect_count;
+    memcpy(effects_ref, effects, sizeof(effects));
+    memcpy(progs_ref, progs, sizeof(progs));
+    uint16_t holding_after[HOLDING_REGS_SIZE];
+    uint8_t coils_after[COILS_SIZE];
+    memcpy(holding_after, holding, sizeof(holding));
+    memcpy(coils_after, coils, sizeof(coils));
+
+    // Plan pass from the same start
+    memcpy(progs, saved, sizeof(progs));
+    memcpy(holding, holding_ref, sizeof(holding));
+    memcpy(coils, coils_ref, sizeof(coils));
+    effect_count = 0;
+    st_binding_plan_run_inputs(&plan);
+    st_binding_plan_run_outputs(&plan, &io);
+
+    if (memcmp(progs, progs_ref, sizeof(progs)) != 0) in_bad++;
+    if (memcmp(holding, holding_after, sizeof(holding)) != 0 ||
+        memcmp(coils, coils_after, sizeof(coils)) != 0) out_bad++;
+    if (effect_count != n_ref || memcmp(effects, effects_ref, sizeof(uint32_t) * n_ref) != 0) fx_bad++;
+    effect_count = 0;
+  }
+  printf("   %ld entries compiled, %ld via setter\n", entries, setters);
+  CHECK(in_bad == 0, "%ld variable mismatches", in_bad);
+  CHECK(out_bad == 0, "%ld register mismatches", out_bad);
+  CHECK(fx_bad == 0, "%ld side-effect call mismatches", fx_bad);
+}
+
+static void test_timing(void)
+{
+  printf("== timing, 32 live bindings (mixed types)\n");
+  srand(9);
+  for (int p = 0; p < PROGS; p++) {
+    progs[p].compiled = true;
+    progs[p].var_count = 32;
+    for (int v = 0; v < 32; v++) progs[p].types[v] = (st_datatype_t)(v % 5);
+  }
+  VariableMapping maps[MAPS];
+  memset(maps, 0, sizeof(maps));
+  for (uint8_t i = 0; i < MAPS; i++) {
+    VariableMapping *m = &maps[i];
+    m->source_type = MAPPING_SOURCE_ST_VAR;
+    m->st_program_id = i % PROGS;
+    m->st_var_index = i;
+    m->is_input = i % 2;
+    m->input_type = (i % 4 == 0) ? 1 : 0;
+    m->output_type = (i % 6 == 1) ? 1 : 0;
+    m->word_count = 2;
+    m->input_reg = m->is_input ? (uint16_t)(i * 2) : 65535;
+    m->coil_reg = m->is_input ? 65535 : (uint16_t)(100 + i * 2);
+  }
+  static st_binding_plan_t plan;
+  st_binding_plan_build(&plan, maps, MAPS, &target);
+
+  const long n = 1000000;
+  clock_t c0 = clock();
+  for (long i = 0; i < n; i++) {
+    holding[0] = (uint16_t)i;
+    ref_inputs(maps, MAPS);
+    ref_outputs(maps, MAPS);
+  }
+  double t_ref = (double)(clock() - c0) / CLOCKS_PER_SEC;
+
+  c0 = clock();
+  for (long i = 0; i < n; i++) {
+    holding[0] = (uint16_t)i;
+    st_binding_plan_run_inputs(&plan);
+    st_binding_plan_run_outputs(&plan, &io);
+  }
+  double t_plan = (double)(clock() - c0) / CLOCKS_PER_SEC;
+
+  printf("   per-binding %.1f ns/cycle, plan %.1f ns/cycle (%u in, %u out)\n",
+         t_ref * 1e9 / n, t_plan * 1e9 / n, plan.in_count, plan.out_count);
+  CHECK(plan.in_count + plan.out_count == MAPS, "%u entries", plan.in_count + plan.out_count);
+}
+
+int main(void)
+{
+  test_random();
+  test_timing();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file st_timer_wheel_test.cpp
+ * @brief Host test for the ST timer wheel (FEAT-159)
+ *
+ * Schedules and cancels random deadlines (1 ms to days, across the millis()
+ * wrap) and advances in random steps, checking against a brute-force list
+ * that every deadline fires in the first advance that reaches it — never
+ * earlier, never missed — and that a long idle gap is skipped cheaply.
+ * A wheel whose first cycle comes at millis() >= 2^31 must still run.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "st_timer_wheel.h"
+#include "host_test.h"
+
+#define NODES 200
+
+static uint32_t rand32(void)
+{
+  return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+// Random delay with every level of the wheel represented
+static uint32_t rand_delay(void)
+{
+  switch (rand() % 5) {
+    case 0:  return rand() % 20;
+    case 1:  return rand() % 5000;
+    case 2:  return rand() % 600000;
+    case 3:  return rand32() % 100000000u;
+    default: return rand32() & 0x7FFFFFFFu;
+  }
+}
+
+static void run_random(uint32_t start, long rounds, uint32_t max_step)
+{
+  static st_wheel_node_t nodes[NODES];
+  static uint8_t ref_pending[NODES];
+  static uint32_t ref_expires[NODES];
+  st_timer_wheel_t w;
+  st_wheel_init(&w, nodes, NODES, start);
+  memset(ref_pending, 0, sizeof(ref_pending));
+
+  uint32_t now = start;
+  long fired = 0, early = 0, missed = 0, wrong_state = 0;
+
+  for (long r = 0; r < rounds; r++) {
+    // A few random operations per round
+    for (int k = 0; k < 3; k++) {
+      uint16_t id = rand() % NODES;
+      if (rand() % 4 == 0) {
+        st_wheel_cancel(&w, id);
+        ref_pending[id] = 0;
+      } else {
+        uint32_t exp = now + rand_delay();
+        st_wheel_schedule(&w, id, exp);
+        if (exp == now) {
+          if (!st_wheel_take_fired(&w, id)) missed++;
+          ref_pending[id] = 0;
+        } else {
+          ref_pending[id] = 1;
+          ref_expires[id] = exp;
+        }
+      }
+    }
+
+    uint32_t step = (rand() % 8 == 0) ? rand32() % max_step : rand() % 50;
+    now += step;
+    st_wheel_advance(&w, now);
+
+    for (uint16_t id = 0; id < NODES; id++) {
+      bool due = ref_pending[id] && (int32_t)(now - ref_expires[id]) >= 0;
+      if (due) {
+        if (st_wheel_take_fired(&w, id)) fired++;
+        else missed++;
+        ref_pending[id] = 0;
+      } else if (ref_pending[id]) {
+        if (nodes[id].state == ST_WHEEL_FIRED) early++;
+        else if (nodes[id].state != ST_WHEEL_PENDING) wrong_state++;
+      }
+    }
+  }
+
+  uint16_t pending = 0;
+  for (uint16_t id = 0; id < NODES; id++) pending += ref_pending[id];
+  printf("   %ld fired, %u pending at end\n", fired, pending);
+  CHECK(early == 0, "%ld fired early", early);
+  CHECK(missed == 0, "%ld missed", missed);
+  CHECK(wrong_state == 0, "%ld in wrong state", wrong_state);
+  CHECK(w.pending == pending, "wheel pending %u, reference %u", w.pending, pending);
+}
+
+static void test_random(void)
+{
+  printf("== random schedule/cancel/advance vs brute force\n");
+  srand(7);
+  run_random(0, 200000, 1u << 20);
+  printf("== same across the millis() wrap\n");
+  run_random(0xFFFFFFFFu - 100000u, 200000, 1u << 16);
+}
+
+static void test_exact_tick(void)
+{
+  printf("== 1 ms advances: each deadline fires on its own tick\n");
+  static st_wheel_node_t nodes[64];
+  st_timer_wheel_t w;
+  st_wheel_init(&w, nodes, 64, 1000);
+  for (uint16_t i = 0; i < 64; i++) st_wheel_schedule(&w, i, 1000 + 1 + i * 97);
+
+  long wrong = 0;
+  for (uint32_t t = 1001; t <= 1000 + 64 * 97; t++) {
+    st_wheel_advance(&w, t);
+    for (uint16_t i = 0; i < 64; i++) {
+      if (st_wheel_take_fired(&w, i) && t != 1000 + 1 + i * 97u) wrong++;
+    }
+  }
+  CHECK(wrong == 0, "%ld fired on the wrong tick", wrong);
+  CHECK(w.pending == 0 && w.fired_total == 64, "pending %u fired %u", w.pending, w.fired_total);
+}
+
+static void test_reschedule_and_gap(void)
+{
+  printf("== reschedule, cancel, 20-day gap\n");
+  static st_wheel_node_t nodes[4];
+  st_timer_wheel_t w;
+  st_wheel_init(&w, nodes, 4, 0);
+
+  st_wheel_schedule(&w, 0, 100);
+  st_wheel_schedule(&w, 0, 50);        // Moved earlier
+  st_wheel_schedule(&w, 1, 60);
+  st_wheel_cancel(&w, 1);
+  st_wheel_advance(&w, 49);
+  CHECK(nodes[0].state == ST_WHEEL_PENDING, "fired before 50");
+  st_wheel_advance(&w, 50);
+  CHECK(st_wheel_take_fired(&w, 0), "not fired at 50");
+  CHECK(!st_wheel_take_fired(&w, 1), "cancelled node fired");
+  CHECK(!st_wheel_take_fired(&w, 0), "fired twice");
+
+  // Deadline 20 days out, advanced in one call: only level boundaries are
+  // visited, so this is quick even though 1.7e9 ticks pass
+  uint32_t far = 50u + 20u * 86400000u;
+  st_wheel_schedule(&w, 2, far);
+  clock_t c0 = clock();
+  st_wheel_advance(&w, far - 1);
+  CHECK(nodes[2].state == ST_WHEEL_PENDING, "20-day timer fired early");
+  st_wheel_advance(&w, far + 5);
+  double ms = (double)(clock() - c0) * 1000.0 / CLOCKS_PER_SEC;
+  printf("   20-day advance took %.3f ms\n", ms);
+  CHECK(st_wheel_take_fired(&w, 2), "20-day timer missed");
+  CHECK(ms < 50.0, "gap advance too slow (%.1f ms)", ms);
+}
+
+// Fresh wheel (now = 0) whose first cycle is at millis() >= 2^31, and an
+// idle program picked up again more than 24.8 days later
+static void test_late_start(void)
+{
+  printf("== first cycle at 0x90000000, idle > 2^31 ms\n");
+  static st_wheel_node_t nodes[1];
+  st_timer_wheel_t w;
+  st_wheel_init(&w, nodes, 1, 0);
+
+  uint32_t t = 0x90000000u;
+  st_wheel_advance(&w, t);
+  CHECK(w.now == t, "wheel did not follow the clock (now %08x)", (unsigned)w.now);
+  st_wheel_schedule(&w, 0, t + 100);
+  st_wheel_advance(&w, t + 99);
+  CHECK(nodes[0].state == ST_WHEEL_PENDING, "+100 ms timer fired early");
+  st_wheel_advance(&w, t + 100);
+  CHECK(st_wheel_take_fired(&w, 0), "+100 ms timer missed");
+
+  t += 100 + 0x90000000u;
+  st_wheel_advance(&w, t);
+  st_wheel_schedule(&w, 0, t + 100);
+  st_wheel_advance(&w, t + 100);
+  CHECK(st_wheel_take_fired(&w, 0), "+100 ms timer missed after long idle");
+}
+
+int main(void)
+{
+  test_random();
+  test_exact_tick();
+  test_reschedule_and_gap();
+  test_late_start();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+/**
+ * @file st_xip_image_test.cpp
+ * @brief Host test for execute-in-place bytecode images (FEAT-167)
+ *
+ * Writes images into slots of the file-backed NOR flash emulator
+ * (flash_emu.h) and attaches them straight from the mapped file, remapped
+ * at another address between runs to check that images are position
+ * independent. Covers round trips with and without a function registry,
+ * rejection of stale/foreign/corrupt images, slot capacity, and power cuts
+ * during a slot rewrite: afterwards the slot must hold no image, the old
+ * one (rejected for the new source) or the complete new one — never
+ * something that passes the checks but differs.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "st_xip_image.h"
+#include "st_bytecode_persist.h"
+#include "flash_emu.h"
+#include "host_test.h"
+
+#define FLASH_PATH   "st_xip_image_test.bin"
+#define SECTOR       4096
+#define PART_SIZE    (64 * 1024)
+#define SLOT_SIZE    (PART_SIZE / ST_XIP_SLOTS)
+
+static st_bytecode_program_t prog, loaded;
+static st_function_registry_t reg, loaded_reg;
+static uint8_t img[SLOT_SIZE];
+
+static void make_program(st_bytecode_program_t *bc, uint16_t instr_count, uint8_t vars, bool funcs)
+{
+  memset(bc, 0, sizeof(*bc));
+  bc->instructions = (st_bytecode_instr_t *)malloc(instr_count * sizeof(st_bytecode_instr_t));
+  for (uint16_t i = 0; i < instr_count; i++) {
+    bc->instructions[i].opcode = (st_opcode_t)(rand() % 64);
+    bc->instructions[i].arg.dword_arg = (uint32_t)rand();
+  }
+  bc->instr_count = instr_count;
+  bc->instr_capacity = instr_count;
+  bc->var_count = vars;
+  for (uint8_t v = 0; v < vars; v++) {
+    snprintf(bc->var_names[v], sizeof(bc->var_names[v]), "var_%u", v);
+    bc->var_types[v] = (st_datatype_t)(v % 4);
+    bc->var_export_flags[v] = v & 1;
+    bc->var_initial[v].dint_val = rand();
+    bc->variables[v].dint_val = rand();            // Runtime state: not stored
+  }
+  bc->exported_var_count = vars / 2;
+  snprintf(bc->name, sizeof(bc->name), "Logic%u", instr_count);
+  bc->func_registry = NULL;
+  if (funcs) {
+    memset(&reg, 0, sizeof(reg));
+    reg.builtin_count = 2;
+    reg.user_count = 3;
+    for (uint8_t f = 0; f < 5; f++) {
+      snprintf(reg.functions[f].name, sizeof(reg.functions[f].name), "FN_%u", f);
+      reg.functions[f].param_count = f;
+      reg.functions[f].bytecode_addr = (uint16_t)(f * 10);
+      reg.functions[f].bytecode_size = 7;
+      reg.functions[f].is_function_block = f == 4;
+    }
+    reg.fb_instance_count = 1;                     // Runtime state: not stored
+    bc->func_registry = &reg;
+  }
+}
+
+static bool same_program(const st_bytecode_program_t *a, const st_bytecode_program_t *b)
+{
+  if (a->instr_count != b->instr_count || a->var_count != b->var_count ||
+      a->exported_var_count != b->exported_var_count || strcmp(a->name, b->name) != 0) {
+    return false;
+  }
+  if (memcmp(a->instructions, b->instructions, a->instr_count * sizeof(st_bytecode_instr_t)) != 0) {
+    return false;
+  }
+  for (uint8_t v = 0; v < a->var_count; v++) {
+    if (strcmp(a->var_names[v], b->var_names[v]) != 0 || a->var_types[v] != b->var_types[v] ||
+        a->var_export_flags[v] != b->var_export_flags[v] ||
+        a->var_initial[v].dint_val != b->var_initial[v].dint_val ||
+        b->variables[v].dint_val != b->var_initial[v].dint_val) {
+      return false;
+    }
+  }
+  if (!a->func_registry != !b->func_registry) return false;
+  if (a->func_registry) {
+    const st_function_registry_t *ra = a->func_registry, *rb = b->func_registry;
+    if (ra->user_count != rb->user_count || ra->builtin_count != rb->builtin_count ||
+        rb->fb_instance_count != 0 ||
+        memcmp(ra->functions, rb->functions,
+               (ra->user_count + ra->builtin_count) * sizeof(st_function_entry_t)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static StxFlashOps make_ops(FlashEmu *f)
+{
+  StxFlashOps ops = { f, SECTOR, flash_emu_write, flash_emu_erase };
+  return ops;
+}
+
+/* ----------------------------------------------------------------------------
+ * Tests
+ * -------------------------------------------------------------------------- */
+
+static void test_round_trip(void)
+{
+  printf("== round trip from mapped flash, remapped elsewhere\n");
+  FlashEmu f;
+  CHECK(flash_emu_open(&f, FLASH_PATH, PART_SIZE, SECTOR, true), "open");
+  StxFlashOps ops = make_ops(&f);
+
+  const uint32_t crc[2] = { 0x11111111, 0x22222222 };
+  st_bytecode_program_t progs[2];
+  st_function_registry_t regs[2];
+  for (int p = 0; p < 2; p++) {
+    make_program(&progs[p], p ? 1200 : 37, p ? 32 : 5, p == 1);
+    if (progs[p].func_registry) {
+      regs[p] = reg;
+      progs[p].func_registry = &regs[p];
+    }
+    uint32_t len = st_xip_build(&progs[p], crc[p], img, sizeof(img));
+    CHECK(len == st_xip_image_size(&progs[p]), "build size %u", len);
+    CHECK(st_xip_write(&ops, (uint32_t)(p + 1) * SLOT_SIZE, SLOT_SIZE, img, len), "write %d", p);
+    printf("   %u instr, %u vars, %u funcs -> %u bytes\n", progs[p].instr_count,
+           progs[p].var_count, st_xip_func_count(img), len);
+  }
+  CHECK(f.violations == 0, "%u NOR violations", f.violations);
+  flash_emu_close(&f);
+
+  // Map the file again (other address) and run from it
+  for (int round = 0; round < 2; round++) {
+    void *pad = round ? malloc(1 << 20) : NULL;    // Shift the next mapping
+    CHECK(flash_emu_open(&f, FLASH_PATH, PART_SIZE, SECTOR, false), "reopen");
+    for (int p = 0; p < 2; p++) {
+      const uint8_t *slot = f.mem + (p + 1) * SLOT_SIZE;
+      CHECK(st_xip_check(slot, SLOT_SIZE, crc[p]) == ST_XIP_OK, "check %d", p);
+      memset(&loaded, 0xA5, sizeof(loaded));
+      st_xip_attach(slot, &loaded, st_xip_func_count(slot) ? &loaded_reg : NULL);
+      CHECK(loaded.instr_in_flash == 1, "not marked in flash");
+      CHECK((const uint8_t *)loaded.instructions >= slot &&
+            (const uint8_t *)loaded.instructions < slot + SLOT_SIZE, "instructions copied");
+      CHECK(((uintptr_t)loaded.instructions & 7) == 0, "instructions not 8-byte aligned");
+      CHECK(same_program(&progs[p], &loaded), "program %d differs", p);
+    }
+    CHECK(st_xip_check(f.mem, SLOT_SIZE, crc[0]) == ST_XIP_EMPTY, "erased slot");
+    flash_emu_close(&f);
+    free(pad);
+  }
+  for (int p = 0; p < 2; p++) free(progs[p].instructions);
+}
+
+static void test_rejects(void)
+{
+  printf("== stale, foreign and corrupt images\n");
+  make_program(&prog, 300, 8, true);
+  uint32_t len = st_xip_build(&prog, 0xCAFE, img, sizeof(img));
+  st_xip_header_t h;
+
+  CHECK(st_xip_check(img, len, 0xBEEF) == ST_XIP_SOURCE, "source change not detected");
+  CHECK(st_xip_check(img, len - 1, 0xCAFE) == ST_XIP_CORRUPT, "truncated slot");
+
+  memcpy(&h, img, sizeof(h));
+  h.version++;
+  memcpy(img, &h, sizeof(h));
+  CHECK(st_xip_check(img, len, 0xCAFE) == ST_XIP_VERSION, "compiler version");
+  h.version--;
+  h.instr_size++;
+  memcpy(img, &h, sizeof(h));
+  CHECK(st_xip_check(img, len, 0xCAFE) == ST_XIP_VERSION, "instruction layout");
+  h.instr_size--;
+  h.var_count++;
+  memcpy(img, &h, sizeof(h));
+  CHECK(st_xip_check(img, len, 0xCAFE) == ST_XIP_CORRUPT, "counts vs offsets");
+  h.var_count--;
+  memcpy(img, &h, sizeof(h));
+  CHECK(st_xip_check(img, len, 0xCAFE) == ST_XIP_OK, "restored header");
+
+  uint32_t bad = 0;
+  for (uint32_t i = sizeof(h); i < len; i += 7) {
+    img[i] ^= 0x10;
+    if (st_xip_check(img, len, 0xCAFE) != ST_XIP_CORRUPT) bad++;
+    img[i] ^= 0x10;
+  }
+  CHECK(bad == 0, "%u payload bit flips accepted", bad);
+
+  CHECK(st_xip_build(&prog, 0xCAFE, img, len - 1) == 0, "build into short buffer");
+  free(prog.instructions);
+
+  // Slot capacity: 16 KB holds ~1800 instructions with full variable and function tables
+  uint16_t n = (SLOT_SIZE - 2048) / sizeof(st_bytecode_instr_t);
+  make_program(&prog, n, 32, true);
+  CHECK(st_xip_image_size(&prog) <= SLOT_SIZE, "%u instr do not fit", n);
+  free(prog.instructions);
+  make_program(&prog, SLOT_SIZE / sizeof(st_bytecode_instr_t), 1, false);
+  len = st_xip_image_size(&prog);
+  CHECK(len > SLOT_SIZE, "oversized image fits");
+  static uint8_t big[2 * SLOT_SIZE];
+  st_xip_build(&prog, 1, big, sizeof(big));
+  FlashEmu f;
+  flash_emu_open(&f, FLASH_PATH, PART_SIZE, SECTOR, true);
+  StxFlashOps ops = make_ops(&f);
+  CHECK(!st_xip_write(&ops, 0, SLOT_SIZE, big, len), "oversized image written");
+  CHECK(f.erases == 0, "oversized image erased the slot");
+  flash_emu_close(&f);
+  free(prog.instructions);
+  printf("   slot %u bytes: %u+ instructions\n", SLOT_SIZE, n);
+}
+
+static void test_power_cut(void)
+{
+  printf("== power cut while rewriting a slot\n");
+  st_bytecode_program_t old_prog;
+  make_program(&old_prog, 900, 20, false);
+  make_program(&prog, 1100, 24, true);
+  static uint8_t old_img[SLOT_SIZE];
+  uint32_t old_len = st_xip_build(&old_prog, 1, old_img, sizeof(old_img));
+  uint32_t len = st_xip_build(&prog, 2, img, sizeof(img));
+
+  uint32_t empty = 0, stale = 0, done = 0, cuts = 0;
+  for (long budget = 0; budget < (long)len + 512; budget += 97) {
+    FlashEmu f;
+    flash_emu_open(&f, FLASH_PATH, PART_SIZE, SECTOR, true);
+    StxFlashOps ops = make_ops(&f);
+    st_xip_write(&ops, SLOT_SIZE, SLOT_SIZE, old_img, old_len);
+
+    f.budget = budget;
+    f.erase_from_end = (budget / 97) & 1;
+    bool ok = st_xip_write(&ops, SLOT_SIZE, SLOT_SIZE, img, len);
+    flash_emu_power_cycle(&f);
+    cuts += ok ? 0 : 1;
+
+    const uint8_t *slot = f.mem + SLOT_SIZE;
+    st_xip_result_t r_new = st_xip_check(slot, SLOT_SIZE, 2);
+    st_xip_result_t r_old = st_xip_check(slot, SLOT_SIZE, 1);
+    if (r_new == ST_XIP_OK) {
+      st_xip_attach(slot, &loaded, &loaded_reg);
+      CHECK(same_program(&prog, &loaded), "budget %ld: new image differs", budget);
+      done++;
+    } else {
+      CHECK(ok == false, "budget %ld: completed write not readable", budget);
+      // Cut before the first erase: the old image is intact and still
+      // rejected for the new source, so the program is recompiled
+      if (r_old == ST_XIP_OK) stale++; else empty++;
+    }
+    CHECK(f.violations == 0, "budget %ld: %u NOR violations", budget, f.violations);
+    flash_emu_close(&f);
+  }
+  CHECK(cuts > 0 && done > 0, "cuts %u, completed %u", cuts, done);
+  printf("   %u cuts: %u slots empty, %u old image, %u complete\n", cuts, empty, stale, done);
+  free(old_prog.instructions);
+  free(prog.instructions);
+}
+
+int main(void)
+{
+  srand(11);
+  test_round_trip();
+  test_rejects();
+  test_power_cut();
+  remove(FLASH_PATH);
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
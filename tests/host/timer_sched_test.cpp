@@ -0,0 +1,136 @@
+/**
+ * @file timer_sched_test.cpp
+ * @brief Host test for the timer phase sequencer (FEAT-158)
+ *
+ * Drives timer_sched the way the esp_timer callback does: fire at the
+ * deadline plus a random latency, check that edges never drift, that
+ * zero-duration phases are skipped, and that a starved callback resyncs
+ * instead of bursting through missed cycles.
+ *
+ * Build & run:  make -C tests/host run
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "timer_sched.h"
+#include "host_test.h"
+
+static TimerSchedPlan astable(uint32_t on_us, uint32_t off_us)
+{
+  TimerSchedPlan p = {};
+  p.phases = 2;
+  p.repeat = 1;
+  p.level[0] = 1;
+  p.level[1] = 0;
+  p.end_level = TIMER_SCHED_LEAVE;
+  p.dur_us[0] = on_us;
+  p.dur_us[1] = off_us;
+  return p;
+}
+
+static void test_astable_no_drift(void)
+{
+  printf("== astable 700/300 us, callback latency 0-250 us\n");
+  TimerSchedPlan plan = astable(700, 300);
+  TimerSchedState s = {};
+  int64_t t0 = 5000;
+  timer_sched_start(&plan, &s, t0);
+  CHECK(s.level == 1 && s.deadline_us == t0 + 700, "start level %u deadline %lld",
+        s.level, (long long)s.deadline_us);
+
+  long edges = 0, bad = 0;
+  int64_t worst_late = 0;
+  for (int i = 0; i < 20000; i++) {
+    int64_t due = s.deadline_us;
+    int64_t now = due + (rand() % 251);
+    uint8_t prev = s.level;
+    uint8_t steps = timer_sched_expire(&plan, &s, now);
+    if (steps != 1 || s.level == prev) bad++;
+    if (now - due > worst_late) worst_late = now - due;
+    edges++;
+  }
+  // 20000 edges = 10000 periods of 1000 us, regardless of latency
+  printf("   %ld edges, worst latency %lld us, next deadline %lld\n",
+         edges, (long long)worst_late, (long long)s.deadline_us);
+  CHECK(bad == 0, "%ld edges with wrong step/level", bad);
+  CHECK(s.deadline_us == t0 + 10000LL * 1000 + 700, "drift: deadline %lld", (long long)s.deadline_us);
+  CHECK(s.late_resyncs == 0, "resyncs %u", s.late_resyncs);
+}
+
+static void test_early_call(void)
+{
+  printf("== callback before the deadline does nothing\n");
+  TimerSchedPlan plan = astable(100, 100);
+  TimerSchedState s = {};
+  timer_sched_start(&plan, &s, 0);
+  CHECK(timer_sched_expire(&plan, &s, 99) == 0 && s.level == 1, "fired early");
+  CHECK(timer_sched_expire(&plan, &s, 100) == 1 && s.level == 0, "missed deadline");
+}
+
+static void test_one_shot(void)
+{
+  printf("== one-shot 3 phases, zero-duration phase skipped\n");
+  TimerSchedPlan p = {};
+  p.phases = 3;
+  p.level[0] = 1; p.level[1] = 0; p.level[2] = 1;
+  p.end_level = TIMER_SCHED_LEAVE;
+  p.dur_us[0] = 2000; p.dur_us[1] = 0; p.dur_us[2] = 3000;
+  TimerSchedState s = {};
+  timer_sched_start(&p, &s, 0);
+  CHECK(s.level == 1 && s.phase == 0, "phase %u level %u", s.phase, s.level);
+  uint8_t n = timer_sched_expire(&p, &s, 2000);
+  CHECK(n == 2 && s.phase == 2 && s.level == 1 && s.deadline_us == 5000,
+        "n=%u phase %u level %u deadline %lld", n, s.phase, s.level, (long long)s.deadline_us);
+  timer_sched_expire(&p, &s, 5000);
+  CHECK(!s.running && s.level == 1, "not finished (running %u)", s.running);
+  CHECK(timer_sched_expire(&p, &s, 9000) == 0, "fired after finish");
+
+  // All phases zero: finishes inside start()
+  p.dur_us[0] = p.dur_us[2] = 0;
+  timer_sched_start(&p, &s, 100);
+  CHECK(!s.running && s.level == 1, "zero plan still running");
+}
+
+static void test_monostable_retrigger(void)
+{
+  printf("== monostable pulse, retrigger extends, end level\n");
+  TimerSchedPlan p = {};
+  p.phases = 1;
+  p.level[0] = 1;
+  p.end_level = 0;
+  p.dur_us[0] = 1500;
+  TimerSchedState s = {};
+  timer_sched_start(&p, &s, 0);
+  timer_sched_start(&p, &s, 1000);  // Retrigger mid-pulse
+  CHECK(timer_sched_expire(&p, &s, 1600) == 0 && s.level == 1, "ended at first deadline");
+  timer_sched_expire(&p, &s, 2500);
+  CHECK(!s.running && s.level == 0, "running %u level %u", s.running, s.level);
+}
+
+static void test_starved(void)
+{
+  printf("== starved callback resyncs instead of bursting\n");
+  TimerSchedPlan plan = astable(200, 200);
+  TimerSchedState s = {};
+  timer_sched_start(&plan, &s, 0);
+  uint8_t n = timer_sched_expire(&plan, &s, 200 + 10000);  // 25 periods late
+  CHECK(n == 1 && s.late_resyncs == 1, "n=%u resyncs %u", n, s.late_resyncs);
+  CHECK(s.deadline_us == 10200 + 200, "deadline %lld", (long long)s.deadline_us);
+
+  // Repeating plan with no duration is refused
+  TimerSchedPlan zero = astable(0, 0);
+  CHECK(timer_sched_start(&zero, &s, 0) == 0 && !s.running, "zero astable running");
+}
+
+int main(void)
+{
+  srand(1);
+  test_astable_no_drift();
+  test_early_call();
+  test_one_shot();
+  test_monostable_retrigger();
+  test_starved();
+
+  printf("%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}